@@ -0,0 +1,120 @@
+#pragma once
+
+#include "common.h"
+#include "AirTime.h"
+#include "OTA.h"
+
+/*
+ * The LR1121 air rates. The time on air and sensitivity of each come from its modulation, see
+ * AirTime.h. Included after the LR1121 register definitions, by common.cpp and test_airtime.
+ */
+
+static constexpr uint8_t lr1121CrDen(uint8_t cr)
+{
+    return cr == LR11XX_RADIO_LORA_CR_LI_4_8 ? 8 : cr > LR11XX_RADIO_LORA_CR_4_8 ? cr : cr + 4;
+}
+
+static constexpr bool lr1121CrLongInterleave(uint8_t cr)
+{
+    return cr > LR11XX_RADIO_LORA_CR_4_8;
+}
+
+static constexpr uint32_t lr1121BwHz(uint8_t bw)
+{
+    return bw == LR11XX_RADIO_LORA_BW_800 ? 812500 : bw == LR11XX_RADIO_LORA_BW_400 ? 406250 : bw == LR11XX_RADIO_LORA_BW_200 ? 203125
+        : bw == LR11XX_RADIO_LORA_BW_500 ? 500000 : bw == LR11XX_RADIO_LORA_BW_250 ? 250000 : 125000;
+}
+
+constexpr expresslrs_mod_settings_s ExpressLRS_AirRateConfig[] = {
+    {0,  RADIO_TYPE_LR1121_GFSK_900,  RATE_FSK_900_1000HZ_8CH,  LR11XX_RADIO_GFSK_BITRATE_300k, LR11XX_RADIO_GFSK_BW_467000, LR11XX_RADIO_GFSK_FDEV_100k, 16, LR11XX_RADIO_GFSK_BITRATE_300k, LR11XX_RADIO_GFSK_BW_467000, LR11XX_RADIO_GFSK_FDEV_100k, 16, TLM_RATIO_1_128, 2,  1000, OTA8_PACKET_SIZE, 1},
+    {1,  RADIO_TYPE_LR1121_LORA_900,  RATE_LORA_900_250HZ,      LR11XX_RADIO_LORA_BW_500,       LR11XX_RADIO_LORA_SF5,       LR11XX_RADIO_LORA_CR_4_8,     8, LR11XX_RADIO_LORA_BW_500,       LR11XX_RADIO_LORA_SF5,       LR11XX_RADIO_LORA_CR_4_8,     8, TLM_RATIO_1_64,  4,  4000, OTA4_PACKET_SIZE, 1},
+    {2,  RADIO_TYPE_LR1121_LORA_900,  RATE_LORA_900_200HZ_8CH,  LR11XX_RADIO_LORA_BW_500,       LR11XX_RADIO_LORA_SF5,       LR11XX_RADIO_LORA_CR_4_7,     8, LR11XX_RADIO_LORA_BW_500,       LR11XX_RADIO_LORA_SF5,       LR11XX_RADIO_LORA_CR_4_7,     8, TLM_RATIO_1_64,  4,  5000, OTA8_PACKET_SIZE, 1},
+    {3,  RADIO_TYPE_LR1121_LORA_900,  RATE_LORA_900_200HZ,      LR11XX_RADIO_LORA_BW_500,       LR11XX_RADIO_LORA_SF6,       LR11XX_RADIO_LORA_CR_4_7,     8, LR11XX_RADIO_LORA_BW_500,       LR11XX_RADIO_LORA_SF6,       LR11XX_RADIO_LORA_CR_4_7,     8, TLM_RATIO_1_64,  4,  5000, OTA4_PACKET_SIZE, 1},
+    {4,  RADIO_TYPE_LR1121_LORA_900,  RATE_LORA_900_100HZ_8CH,  LR11XX_RADIO_LORA_BW_500,       LR11XX_RADIO_LORA_SF6,       LR11XX_RADIO_LORA_CR_4_8,     8, LR11XX_RADIO_LORA_BW_500,       LR11XX_RADIO_LORA_SF6,       LR11XX_RADIO_LORA_CR_4_8,     8, TLM_RATIO_1_32,  4, 10000, OTA8_PACKET_SIZE, 1},
+    {5,  RADIO_TYPE_LR1121_LORA_900,  RATE_LORA_900_100HZ,      LR11XX_RADIO_LORA_BW_500,       LR11XX_RADIO_LORA_SF7,       LR11XX_RADIO_LORA_CR_4_7,     8, LR11XX_RADIO_LORA_BW_500,       LR11XX_RADIO_LORA_SF7,       LR11XX_RADIO_LORA_CR_4_7,     8, TLM_RATIO_1_32,  4, 10000, OTA4_PACKET_SIZE, 1},
+    {6,  RADIO_TYPE_LR1121_LORA_900,  RATE_LORA_900_50HZ,       LR11XX_RADIO_LORA_BW_500,       LR11XX_RADIO_LORA_SF8,       LR11XX_RADIO_LORA_CR_4_7,    10, LR11XX_RADIO_LORA_BW_500,       LR11XX_RADIO_LORA_SF8,       LR11XX_RADIO_LORA_CR_4_7,    10, TLM_RATIO_1_16,  4, 20000, OTA4_PACKET_SIZE, 1},
+    {7,  RADIO_TYPE_LR1121_LORA_900,  RATE_LORA_900_25HZ,       LR11XX_RADIO_LORA_BW_500,       LR11XX_RADIO_LORA_SF9,       LR11XX_RADIO_LORA_CR_4_7,    10, LR11XX_RADIO_LORA_BW_500,       LR11XX_RADIO_LORA_SF9,       LR11XX_RADIO_LORA_CR_4_7,    10, TLM_RATIO_1_8,   2, 40000, OTA4_PACKET_SIZE, 1},
+    {8,  RADIO_TYPE_LR1121_LORA_900,  RATE_LORA_900_50HZ_DVDA,  LR11XX_RADIO_LORA_BW_500,       LR11XX_RADIO_LORA_SF6,       LR11XX_RADIO_LORA_CR_4_7,     8, LR11XX_RADIO_LORA_BW_500,       LR11XX_RADIO_LORA_SF6,       LR11XX_RADIO_LORA_CR_4_7,     8, TLM_RATIO_1_64,  2,  5000, OTA4_PACKET_SIZE, 4},
+    {9,  RADIO_TYPE_LR1121_GFSK_2G4,  RATE_FSK_2G4_1000HZ,      LR11XX_RADIO_GFSK_BITRATE_300k, LR11XX_RADIO_GFSK_BW_467000, LR11XX_RADIO_GFSK_FDEV_100k, 16, LR11XX_RADIO_GFSK_BITRATE_300k, LR11XX_RADIO_GFSK_BW_467000, LR11XX_RADIO_GFSK_FDEV_100k, 16, TLM_RATIO_1_128, 2,  1000, OTA4_PACKET_SIZE, 1},
+    {10, RADIO_TYPE_LR1121_GFSK_2G4,  RATE_FSK_2G4_500HZ_DVDA,  LR11XX_RADIO_GFSK_BITRATE_300k, LR11XX_RADIO_GFSK_BW_467000, LR11XX_RADIO_GFSK_FDEV_100k, 16, LR11XX_RADIO_GFSK_BITRATE_300k, LR11XX_RADIO_GFSK_BW_467000, LR11XX_RADIO_GFSK_FDEV_100k, 16, TLM_RATIO_1_128, 2,  1000, OTA4_PACKET_SIZE, 2},
+    {11, RADIO_TYPE_LR1121_GFSK_2G4,  RATE_FSK_2G4_250HZ_DVDA,  LR11XX_RADIO_GFSK_BITRATE_300k, LR11XX_RADIO_GFSK_BW_467000, LR11XX_RADIO_GFSK_FDEV_100k, 16, LR11XX_RADIO_GFSK_BITRATE_300k, LR11XX_RADIO_GFSK_BW_467000, LR11XX_RADIO_GFSK_FDEV_100k, 16, TLM_RATIO_1_128, 2,  1000, OTA4_PACKET_SIZE, 4},
+    {12, RADIO_TYPE_LR1121_LORA_2G4,  RATE_LORA_2G4_500HZ,      LR11XX_RADIO_LORA_BW_800,       LR11XX_RADIO_LORA_SF5,       LR11XX_RADIO_LORA_CR_LI_4_6, 12, LR11XX_RADIO_LORA_BW_800,       LR11XX_RADIO_LORA_SF5,       LR11XX_RADIO_LORA_CR_LI_4_6, 12, TLM_RATIO_1_128, 4,  2000, OTA4_PACKET_SIZE, 1},
+    {13, RADIO_TYPE_LR1121_LORA_2G4,  RATE_LORA_2G4_333HZ_8CH,  LR11XX_RADIO_LORA_BW_800,       LR11XX_RADIO_LORA_SF5,       LR11XX_RADIO_LORA_CR_LI_4_8, 12, LR11XX_RADIO_LORA_BW_800,       LR11XX_RADIO_LORA_SF5,       LR11XX_RADIO_LORA_CR_LI_4_8, 12, TLM_RATIO_1_128, 4,  3003, OTA8_PACKET_SIZE, 1},
+    {14, RADIO_TYPE_LR1121_LORA_2G4,  RATE_LORA_2G4_250HZ,      LR11XX_RADIO_LORA_BW_800,       LR11XX_RADIO_LORA_SF6,       LR11XX_RADIO_LORA_CR_LI_4_8, 14, LR11XX_RADIO_LORA_BW_800,       LR11XX_RADIO_LORA_SF6,       LR11XX_RADIO_LORA_CR_LI_4_8, 14, TLM_RATIO_1_64,  4,  4000, OTA4_PACKET_SIZE, 1},
+    {15, RADIO_TYPE_LR1121_LORA_2G4,  RATE_LORA_2G4_150HZ,      LR11XX_RADIO_LORA_BW_800,       LR11XX_RADIO_LORA_SF7,       LR11XX_RADIO_LORA_CR_LI_4_8, 12, LR11XX_RADIO_LORA_BW_800,       LR11XX_RADIO_LORA_SF7,       LR11XX_RADIO_LORA_CR_LI_4_8, 12, TLM_RATIO_1_32,  4,  6666, OTA4_PACKET_SIZE, 1},
+    {16, RADIO_TYPE_LR1121_LORA_2G4,  RATE_LORA_2G4_100HZ_8CH,  LR11XX_RADIO_LORA_BW_800,       LR11XX_RADIO_LORA_SF7,       LR11XX_RADIO_LORA_CR_LI_4_8, 12, LR11XX_RADIO_LORA_BW_800,       LR11XX_RADIO_LORA_SF7,       LR11XX_RADIO_LORA_CR_LI_4_8, 12, TLM_RATIO_1_32,  4, 10000, OTA8_PACKET_SIZE, 1},
+    {17, RADIO_TYPE_LR1121_LORA_2G4,  RATE_LORA_2G4_50HZ,       LR11XX_RADIO_LORA_BW_800,       LR11XX_RADIO_LORA_SF8,       LR11XX_RADIO_LORA_CR_LI_4_8, 12, LR11XX_RADIO_LORA_BW_800,       LR11XX_RADIO_LORA_SF8,       LR11XX_RADIO_LORA_CR_LI_4_8, 12, TLM_RATIO_1_16,  2, 20000, OTA4_PACKET_SIZE, 1},
+    {18, RADIO_TYPE_LR1121_LORA_DUAL, RATE_LORA_DUAL_150HZ,     LR11XX_RADIO_LORA_BW_500,       LR11XX_RADIO_LORA_SF6,       LR11XX_RADIO_LORA_CR_4_8,    12, LR11XX_RADIO_LORA_BW_800,       LR11XX_RADIO_LORA_SF7,       LR11XX_RADIO_LORA_CR_LI_4_6, 12, TLM_RATIO_1_32,  4,  6666, OTA4_PACKET_SIZE, 1},
+    {19, RADIO_TYPE_LR1121_LORA_DUAL, RATE_LORA_DUAL_100HZ_8CH, LR11XX_RADIO_LORA_BW_500,       LR11XX_RADIO_LORA_SF6,       LR11XX_RADIO_LORA_CR_4_8,    18, LR11XX_RADIO_LORA_BW_800,       LR11XX_RADIO_LORA_SF7,       LR11XX_RADIO_LORA_CR_LI_4_8, 14, TLM_RATIO_1_32,  4, 10000, OTA8_PACKET_SIZE, 1}};
+
+static constexpr uint32_t lr1121LongerOf(uint32_t a, uint32_t b)
+{
+    return a > b ? a : b;
+}
+
+static constexpr uint32_t lr1121LoRaToaUs(uint8_t sf, uint8_t bw, uint8_t cr, uint8_t preamble, uint8_t payloadLen)
+{
+    return AirTimeLoRaUs(AIRTIME_LORA_SX126X, sf, lr1121BwHz(bw), lr1121CrDen(cr), lr1121CrLongInterleave(cr), preamble, payloadLen);
+}
+
+// LoRa modes only, the GFSK ones are measured. Dual band sends on both radios at once.
+static constexpr uint32_t AirRateToaUs(uint8_t index)
+{
+    return ExpressLRS_AirRateConfig[index].radio_type != RADIO_TYPE_LR1121_LORA_DUAL
+        ? lr1121LoRaToaUs(ExpressLRS_AirRateConfig[index].sf, ExpressLRS_AirRateConfig[index].bw, ExpressLRS_AirRateConfig[index].cr,
+            ExpressLRS_AirRateConfig[index].PreambleLen, ExpressLRS_AirRateConfig[index].PayloadLength)
+        : lr1121LongerOf(
+            lr1121LoRaToaUs(ExpressLRS_AirRateConfig[index].sf, ExpressLRS_AirRateConfig[index].bw, ExpressLRS_AirRateConfig[index].cr,
+                ExpressLRS_AirRateConfig[index].PreambleLen, ExpressLRS_AirRateConfig[index].PayloadLength),
+            lr1121LoRaToaUs(ExpressLRS_AirRateConfig[index].sf2, ExpressLRS_AirRateConfig[index].bw2, ExpressLRS_AirRateConfig[index].cr2,
+                ExpressLRS_AirRateConfig[index].PreambleLen2, ExpressLRS_AirRateConfig[index].PayloadLength));
+}
+
+static constexpr double lr1121LoRaSensitivityDbm(uint8_t sf, uint8_t bw)
+{
+    return LoRaSensitivityDbm(sf, lr1121BwHz(bw), lr1121BwHz(bw) > 500000 ? AIRTIME_NOISE_FIGURE_2G4_DB : AIRTIME_NOISE_FIGURE_DB);
+}
+
+static constexpr double lr1121WorseOf(double a, double b)
+{
+    return a > b ? a : b;
+}
+
+// Only LoRa has a model here, the GFSK ones are measured and get the thermal noise floor. Dual band
+// is only as good as the worse of its two bands.
+static constexpr double AirRateSensitivityLimitDbm(uint8_t index)
+{
+    return (ExpressLRS_AirRateConfig[index].radio_type == RADIO_TYPE_LR1121_GFSK_900 || ExpressLRS_AirRateConfig[index].radio_type == RADIO_TYPE_LR1121_GFSK_2G4)
+        ? -174.0
+        : ExpressLRS_AirRateConfig[index].radio_type != RADIO_TYPE_LR1121_LORA_DUAL
+        ? lr1121LoRaSensitivityDbm(ExpressLRS_AirRateConfig[index].sf, ExpressLRS_AirRateConfig[index].bw)
+        : lr1121WorseOf(lr1121LoRaSensitivityDbm(ExpressLRS_AirRateConfig[index].sf, ExpressLRS_AirRateConfig[index].bw),
+            lr1121LoRaSensitivityDbm(ExpressLRS_AirRateConfig[index].sf2, ExpressLRS_AirRateConfig[index].bw2));
+}
+
+static constexpr int16_t AirRateSensitivityDbm(uint8_t index)
+{
+    return AirTimeSensitivityDbm(AirRateSensitivityLimitDbm(index));
+}
+
+constexpr expresslrs_rf_pref_params_s ExpressLRS_AirRateRFperf[] = {
+    {0,  -101,   658, 2500, 2500,   3,  5000, DYNPOWER_SNR_THRESH_NONE, DYNPOWER_SNR_THRESH_NONE},
+    {1,  AirRateSensitivityDbm(1), AirRateToaUs(1), 3500, 2500, 600,  5000, SNR_SCALE( 1), SNR_SCALE(3.0)}, // These SNR_SCALE values all need to be checked!
+    {2,  AirRateSensitivityDbm(2), AirRateToaUs(2), 3500, 2500, 600,  5000, SNR_SCALE( 1), SNR_SCALE(3.0)},
+    {3,  AirRateSensitivityDbm(3), AirRateToaUs(3), 3000, 2500, 600,  5000, SNR_SCALE( 1), SNR_SCALE(3.0)},
+    {4,  AirRateSensitivityDbm(4), AirRateToaUs(4), 3500, 2500, 600,  5000, SNR_SCALE( 1), SNR_SCALE(3.0)},
+    {5,  AirRateSensitivityDbm(5), AirRateToaUs(5), 3500, 2500, 600,  5000, SNR_SCALE( 1), SNR_SCALE(2.5)},
+    {6,  AirRateSensitivityDbm(6), AirRateToaUs(6), 4000, 2500, 600,  5000, SNR_SCALE(-1), SNR_SCALE(1.5)},
+    {7,  AirRateSensitivityDbm(7), AirRateToaUs(7), 6000, 4000, 600,  5000, SNR_SCALE(-3), SNR_SCALE(0.5)},
+    {8,  AirRateSensitivityDbm(8), AirRateToaUs(8), 3000, 2500, 600,  5000, SNR_SCALE( 1), SNR_SCALE(3.0)},
+    {9,  -103,   690, 2500, 2500,   3,  5000, DYNPOWER_SNR_THRESH_NONE, DYNPOWER_SNR_THRESH_NONE},
+    {10, -103,   690, 2500, 2500,   3,  5000, DYNPOWER_SNR_THRESH_NONE, DYNPOWER_SNR_THRESH_NONE},
+    {11, -103,   690, 2500, 2500,   3,  5000, DYNPOWER_SNR_THRESH_NONE, DYNPOWER_SNR_THRESH_NONE},
+    {12, AirRateSensitivityDbm(12), AirRateToaUs(12), 2500, 2500,   3,  5000, SNR_SCALE( 5), SNR_SCALE(9.5)},
+    {13, AirRateSensitivityDbm(13), AirRateToaUs(13), 2500, 2500,   4,  5000, SNR_SCALE( 5), SNR_SCALE(9.5)},
+    {14, AirRateSensitivityDbm(14), AirRateToaUs(14), 3000, 2500,   6,  5000, SNR_SCALE( 3), SNR_SCALE(9.5)},
+    {15, AirRateSensitivityDbm(15), AirRateToaUs(15), 3500, 2500,  10,  5000, SNR_SCALE( 0), SNR_SCALE(8.5)},
+    {16, AirRateSensitivityDbm(16), AirRateToaUs(16), 3500, 2500,  11,  5000, SNR_SCALE( 0), SNR_SCALE(8.5)},
+    {17, AirRateSensitivityDbm(17), AirRateToaUs(17), 4000, 2500,   0,  5000, SNR_SCALE(-1), SNR_SCALE(6.5)},
+    {18, AirRateSensitivityDbm(18), AirRateToaUs(18), 3500, 2500,  10,  5000, SNR_SCALE( 0), SNR_SCALE(8.5)},
+    {19, AirRateSensitivityDbm(19), AirRateToaUs(19), 3500, 2500,  11,  5000, SNR_SCALE( 0), SNR_SCALE(8.5)}};
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "common.h"
+#include "AirTime.h"
+#include "OTA.h"
+
+/*
+ * The SX127x air rates. The time on air and sensitivity of each come from its modulation, see
+ * AirTime.h. Included after the SX127x register definitions, by common.cpp and test_airtime.
+ */
+
+static constexpr uint8_t sx127xCrDen(uint8_t cr)
+{
+    return cr == SX127x_CR_4_5 ? 5 : cr == SX127x_CR_4_6 ? 6 : cr == SX127x_CR_4_7 ? 7 : 8;
+}
+
+static constexpr uint32_t sx127xBwHz(uint8_t bw)
+{
+    return bw == SX127x_BW_125_00_KHZ ? 125000 : bw == SX127x_BW_250_00_KHZ ? 250000 : 500000;
+}
+
+constexpr expresslrs_mod_settings_s ExpressLRS_AirRateConfig[] = {
+    {0, RADIO_TYPE_SX127x_LORA, RATE_LORA_900_200HZ,     SX127x_BW_500_00_KHZ, SX127x_SF_6, SX127x_CR_4_7,  8, TLM_RATIO_1_64, 4,  5000, OTA4_PACKET_SIZE, 1},
+    {1, RADIO_TYPE_SX127x_LORA, RATE_LORA_900_100HZ_8CH, SX127x_BW_500_00_KHZ, SX127x_SF_6, SX127x_CR_4_8,  8, TLM_RATIO_1_32, 4, 10000, OTA8_PACKET_SIZE, 1},
+    {2, RADIO_TYPE_SX127x_LORA, RATE_LORA_900_100HZ,     SX127x_BW_500_00_KHZ, SX127x_SF_7, SX127x_CR_4_7,  8, TLM_RATIO_1_32, 4, 10000, OTA4_PACKET_SIZE, 1},
+    {3, RADIO_TYPE_SX127x_LORA, RATE_LORA_900_50HZ,      SX127x_BW_500_00_KHZ, SX127x_SF_8, SX127x_CR_4_7, 10, TLM_RATIO_1_16, 4, 20000, OTA4_PACKET_SIZE, 1},
+    {4, RADIO_TYPE_SX127x_LORA, RATE_LORA_900_25HZ,      SX127x_BW_500_00_KHZ, SX127x_SF_9, SX127x_CR_4_7, 10, TLM_RATIO_1_8,  2, 40000, OTA4_PACKET_SIZE, 1},
+    {5, RADIO_TYPE_SX127x_LORA, RATE_LORA_900_50HZ_DVDA, SX127x_BW_500_00_KHZ, SX127x_SF_6, SX127x_CR_4_7,  8, TLM_RATIO_1_64, 2,  5000, OTA4_PACKET_SIZE, 4}};
+
+static constexpr uint32_t AirRateToaUs(uint8_t index)
+{
+    return AirTimeLoRaUs(AIRTIME_LORA_SX127X, ExpressLRS_AirRateConfig[index].sf >> 4, sx127xBwHz(ExpressLRS_AirRateConfig[index].bw),
+        sx127xCrDen(ExpressLRS_AirRateConfig[index].cr), false, ExpressLRS_AirRateConfig[index].PreambleLen, ExpressLRS_AirRateConfig[index].PayloadLength);
+}
+
+static constexpr double AirRateSensitivityLimitDbm(uint8_t index)
+{
+    return LoRaSensitivityDbm(ExpressLRS_AirRateConfig[index].sf >> 4, sx127xBwHz(ExpressLRS_AirRateConfig[index].bw), AIRTIME_NOISE_FIGURE_DB);
+}
+
+static constexpr int16_t AirRateSensitivityDbm(uint8_t index)
+{
+    return AirTimeSensitivityDbm(AirRateSensitivityLimitDbm(index));
+}
+
+constexpr expresslrs_rf_pref_params_s ExpressLRS_AirRateRFperf[] = {
+    {0, AirRateSensitivityDbm(0), AirRateToaUs(0), 3000, 2500, 600, 5000, SNR_SCALE( 1), SNR_SCALE(3.0)},
+    {1, AirRateSensitivityDbm(1), AirRateToaUs(1), 3500, 2500, 600, 5000, SNR_SCALE( 1), SNR_SCALE(3.0)},
+    {2, AirRateSensitivityDbm(2), AirRateToaUs(2), 3500, 2500, 600, 5000, SNR_SCALE( 1), SNR_SCALE(2.5)},
+    {3, AirRateSensitivityDbm(3), AirRateToaUs(3), 4000, 2500, 600, 5000, SNR_SCALE(-1), SNR_SCALE(1.5)},
+    {4, AirRateSensitivityDbm(4), AirRateToaUs(4), 6000, 4000, 600, 5000, SNR_SCALE(-3), SNR_SCALE(0.5)},
+    {5, AirRateSensitivityDbm(5), AirRateToaUs(5), 3000, 2500, 600, 5000, SNR_SCALE( 1), SNR_SCALE(3.0)}};
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "common.h"
+#include "AirTime.h"
+#include "OTA.h"
+
+/*
+ * The SX128x air rates. The time on air and sensitivity of each come from its modulation, see
+ * AirTime.h. Included after the SX128x register definitions, by common.cpp and test_airtime.
+ */
+
+static constexpr uint8_t sx1280CrDen(uint8_t cr)
+{
+    return cr == SX1280_LORA_CR_LI_4_8 ? 8 : cr > SX1280_LORA_CR_4_8 ? cr : cr + 4;
+}
+
+static constexpr uint32_t sx1280BwHz(uint8_t bw)
+{
+    return bw == SX1280_LORA_BW_1600 ? 1625000 : bw == SX1280_LORA_BW_0800 ? 812500 : bw == SX1280_LORA_BW_0400 ? 406250 : 203125;
+}
+
+static constexpr uint32_t sx1280FlrcBitrate(uint8_t br)
+{
+    return br == SX1280_FLRC_BR_1_300_BW_1_2 ? 1300000 : br == SX1280_FLRC_BR_1_000_BW_1_2 ? 1000000
+        : br == SX1280_FLRC_BR_0_650_BW_0_6 ? 650000 : br == SX1280_FLRC_BR_0_520_BW_0_6 ? 520000
+        : br == SX1280_FLRC_BR_0_325_BW_0_3 ? 325000 : 260000;
+}
+
+constexpr expresslrs_mod_settings_s ExpressLRS_AirRateConfig[] = {
+    {0, RADIO_TYPE_SX128x_FLRC, RATE_FLRC_2G4_1000HZ,     SX1280_FLRC_BR_0_650_BW_0_6, SX1280_FLRC_BT_1, SX1280_FLRC_CR_1_2,    32, TLM_RATIO_1_128, 2,  1000, OTA4_PACKET_SIZE, 1},
+    {1, RADIO_TYPE_SX128x_FLRC, RATE_FLRC_2G4_500HZ,      SX1280_FLRC_BR_0_650_BW_0_6, SX1280_FLRC_BT_1, SX1280_FLRC_CR_1_2,    32, TLM_RATIO_1_128, 2,  2000, OTA4_PACKET_SIZE, 1},
+    {2, RADIO_TYPE_SX128x_FLRC, RATE_FLRC_2G4_500HZ_DVDA, SX1280_FLRC_BR_0_650_BW_0_6, SX1280_FLRC_BT_1, SX1280_FLRC_CR_1_2,    32, TLM_RATIO_1_128, 2,  1000, OTA4_PACKET_SIZE, 2},
+    {3, RADIO_TYPE_SX128x_FLRC, RATE_FLRC_2G4_250HZ_DVDA, SX1280_FLRC_BR_0_650_BW_0_6, SX1280_FLRC_BT_1, SX1280_FLRC_CR_1_2,    32, TLM_RATIO_1_128, 2,  1000, OTA4_PACKET_SIZE, 4},
+    {4, RADIO_TYPE_SX128x_LORA, RATE_LORA_2G4_500HZ,      SX1280_LORA_BW_0800,         SX1280_LORA_SF5,  SX1280_LORA_CR_LI_4_6, 12, TLM_RATIO_1_128, 4,  2000, OTA4_PACKET_SIZE, 1},
+    {5, RADIO_TYPE_SX128x_LORA, RATE_LORA_2G4_333HZ_8CH,  SX1280_LORA_BW_0800,         SX1280_LORA_SF5,  SX1280_LORA_CR_LI_4_8, 12, TLM_RATIO_1_128, 4,  3003, OTA8_PACKET_SIZE, 1},
+    {6, RADIO_TYPE_SX128x_LORA, RATE_LORA_2G4_250HZ,      SX1280_LORA_BW_0800,         SX1280_LORA_SF6,  SX1280_LORA_CR_LI_4_8, 14, TLM_RATIO_1_64,  4,  4000, OTA4_PACKET_SIZE, 1},
+    {7, RADIO_TYPE_SX128x_LORA, RATE_LORA_2G4_150HZ,      SX1280_LORA_BW_0800,         SX1280_LORA_SF7,  SX1280_LORA_CR_LI_4_8, 12, TLM_RATIO_1_32,  4,  6666, OTA4_PACKET_SIZE, 1},
+    {8, RADIO_TYPE_SX128x_LORA, RATE_LORA_2G4_100HZ_8CH,  SX1280_LORA_BW_0800,         SX1280_LORA_SF7,  SX1280_LORA_CR_LI_4_8, 12, TLM_RATIO_1_32,  4, 10000, OTA8_PACKET_SIZE, 1},
+    {9, RADIO_TYPE_SX128x_LORA, RATE_LORA_2G4_50HZ,       SX1280_LORA_BW_0800,         SX1280_LORA_SF8,  SX1280_LORA_CR_LI_4_8, 12, TLM_RATIO_1_16,  2, 20000, OTA4_PACKET_SIZE, 1}};
+
+// FLRC keeps the bitrate in bw, the BT in sf and its own coding rate in cr
+static constexpr uint32_t AirRateToaUs(uint8_t index)
+{
+    return ExpressLRS_AirRateConfig[index].radio_type == RADIO_TYPE_SX128x_FLRC
+        ? AirTimeFlrcUs(sx1280FlrcBitrate(ExpressLRS_AirRateConfig[index].bw),
+            ExpressLRS_AirRateConfig[index].cr == SX1280_FLRC_CR_1_2 ? 1 : 3,
+            ExpressLRS_AirRateConfig[index].cr == SX1280_FLRC_CR_1_2 ? 2 : ExpressLRS_AirRateConfig[index].cr == SX1280_FLRC_CR_3_4 ? 4 : 3,
+            ExpressLRS_AirRateConfig[index].PreambleLen, ExpressLRS_AirRateConfig[index].PayloadLength, 3)
+        : AirTimeLoRaUs(AIRTIME_LORA_SX126X, ExpressLRS_AirRateConfig[index].sf >> 4, sx1280BwHz(ExpressLRS_AirRateConfig[index].bw),
+            sx1280CrDen(ExpressLRS_AirRateConfig[index].cr), ExpressLRS_AirRateConfig[index].cr > SX1280_LORA_CR_4_8,
+            ExpressLRS_AirRateConfig[index].PreambleLen, ExpressLRS_AirRateConfig[index].PayloadLength);
+}
+
+static constexpr double AirRateSensitivityLimitDbm(uint8_t index)
+{
+    return ExpressLRS_AirRateConfig[index].radio_type == RADIO_TYPE_SX128x_FLRC
+        ? FlrcSensitivityDbm(sx1280FlrcBitrate(ExpressLRS_AirRateConfig[index].bw), AIRTIME_NOISE_FIGURE_2G4_DB)
+        : LoRaSensitivityDbm(ExpressLRS_AirRateConfig[index].sf >> 4, sx1280BwHz(ExpressLRS_AirRateConfig[index].bw), AIRTIME_NOISE_FIGURE_2G4_DB);
+}
+
+static constexpr int16_t AirRateSensitivityDbm(uint8_t index)
+{
+    return AirTimeSensitivityDbm(AirRateSensitivityLimitDbm(index));
+}
+
+constexpr expresslrs_rf_pref_params_s ExpressLRS_AirRateRFperf[] = {
+    {0, AirRateSensitivityDbm(0), AirRateToaUs(0), 2500, 2500,  3, 5000, DYNPOWER_SNR_THRESH_NONE, DYNPOWER_SNR_THRESH_NONE},
+    {1, AirRateSensitivityDbm(1), AirRateToaUs(1), 2500, 2500,  3, 5000, DYNPOWER_SNR_THRESH_NONE, DYNPOWER_SNR_THRESH_NONE},
+    {2, AirRateSensitivityDbm(2), AirRateToaUs(2), 2500, 2500,  3, 5000, DYNPOWER_SNR_THRESH_NONE, DYNPOWER_SNR_THRESH_NONE},
+    {3, AirRateSensitivityDbm(3), AirRateToaUs(3), 2500, 2500,  3, 5000, DYNPOWER_SNR_THRESH_NONE, DYNPOWER_SNR_THRESH_NONE},
+    {4, AirRateSensitivityDbm(4), AirRateToaUs(4), 2500, 2500,  3, 5000, SNR_SCALE( 5), SNR_SCALE(9.5)},
+    {5, AirRateSensitivityDbm(5), AirRateToaUs(5), 2500, 2500,  4, 5000, SNR_SCALE( 5), SNR_SCALE(9.5)},
+    {6, AirRateSensitivityDbm(6), AirRateToaUs(6), 3000, 2500,  6, 5000, SNR_SCALE( 3), SNR_SCALE(9.5)},
+    {7, AirRateSensitivityDbm(7), AirRateToaUs(7), 3500, 2500, 10, 5000, SNR_SCALE( 0), SNR_SCALE(8.5)},
+    {8, AirRateSensitivityDbm(8), AirRateToaUs(8), 3500, 2500, 11, 5000, SNR_SCALE( 0), SNR_SCALE(8.5)},
+    {9, AirRateSensitivityDbm(9), AirRateToaUs(9), 4000, 2500,  0, 5000, SNR_SCALE(-1), SNR_SCALE(6.5)}};
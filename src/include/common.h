@@ -310,9 +310,11 @@ extern SX1280Driver Radio;
 #endif
 #endif // UNIT_TEST
 
-expresslrs_mod_settings_s *get_elrs_airRateConfig(uint8_t index);
-expresslrs_rf_pref_params_s *get_elrs_RFperfParams(uint8_t index);
+const expresslrs_mod_settings_s *get_elrs_airRateConfig(uint8_t index);
+const expresslrs_rf_pref_params_s *get_elrs_RFperfParams(uint8_t index);
 uint8_t get_elrs_HandsetRate_max(uint8_t rateIndex, uint32_t minInterval);
+// An announced rate switch only changes the LoRa modulation and the interval, see Radio.SetModulation()
+bool isRateSwitchCompatible(uint8_t fromIndex, uint8_t toIndex);
 
 uint8_t TLMratioEnumToValue(expresslrs_tlm_ratio_e const enumval);
 uint8_t TLMBurstMaxForRateRatio(uint16_t const rateHz, uint8_t const ratioDiv);
@@ -323,8 +325,8 @@ extern bool connectionHasModelMatch;
 extern bool teamraceHasModelMatch;
 extern bool InBindingMode;
 extern uint8_t ExpressLRS_currTlmDenom;
-extern expresslrs_mod_settings_s *ExpressLRS_currAirRate_Modparams;
-extern expresslrs_rf_pref_params_s *ExpressLRS_currAirRate_RFperfParams;
+extern const expresslrs_mod_settings_s *ExpressLRS_currAirRate_Modparams;
+extern const expresslrs_rf_pref_params_s *ExpressLRS_currAirRate_RFperfParams;
 extern uint32_t ChannelData[CRSF_NUM_CHANNELS]; // Current state of channels, CRSF format
 
 extern connectionState_e connectionState;
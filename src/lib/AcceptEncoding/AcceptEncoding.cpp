@@ -0,0 +1,100 @@
+#include "AcceptEncoding.h"
+
+#include <string.h>
+#include <strings.h>
+
+static bool isSpace(const char c)
+{
+    return c == ' ' || c == '\t';
+}
+
+// Trim the spaces around [start, end)
+static void trim(const char *&start, const char *&end)
+{
+    while (start < end && isSpace(*start))
+        start++;
+    while (end > start && isSpace(end[-1]))
+        end--;
+}
+
+// A qvalue is "0" or "1" with up to 3 decimals (RFC 9110), anything else is malformed
+static bool qvalueOverZero(const char *start, const char *end, bool &overZero)
+{
+    if (start == end || (*start != '0' && *start != '1'))
+        return false;
+
+    const bool one = *start++ == '1';
+    overZero = one;
+    if (start == end)
+        return true;
+    if (*start++ != '.' || end - start > 3)
+        return false;
+
+    for (; start < end; start++)
+    {
+        if (*start < '0' || *start > '9' || (one && *start != '0'))
+            return false;
+        overZero |= *start != '0';
+    }
+    return true;
+}
+
+// The parameters of a coding, [start, end) is what follows its name
+static bool codingAccepted(const char *start, const char *end)
+{
+    while (start < end)
+    {
+        // skip the ';' in front of the parameter
+        start++;
+        const char *paramEnd = (const char *)memchr(start, ';', end - start);
+        if (paramEnd == nullptr)
+            paramEnd = end;
+
+        const char *equals = (const char *)memchr(start, '=', paramEnd - start);
+        if (equals != nullptr)
+        {
+            const char *name = start;
+            const char *nameEnd = equals;
+            trim(name, nameEnd);
+            if (nameEnd - name == 1 && (*name == 'q' || *name == 'Q'))
+            {
+                const char *value = equals + 1;
+                const char *valueEnd = paramEnd;
+                trim(value, valueEnd);
+                bool overZero;
+                return qvalueOverZero(value, valueEnd, overZero) && overZero;
+            }
+        }
+        start = paramEnd;
+    }
+
+    return true;
+}
+
+bool acceptsBrotli(const char *acceptEncoding)
+{
+    const char *coding = acceptEncoding;
+
+    while (coding != nullptr && *coding != '\0')
+    {
+        const char *codingEnd = strchr(coding, ',');
+        if (codingEnd == nullptr)
+            codingEnd = coding + strlen(coding);
+
+        const char *name = coding;
+        const char *nameEnd = (const char *)memchr(coding, ';', codingEnd - coding);
+        if (nameEnd == nullptr)
+            nameEnd = codingEnd;
+        const char *params = nameEnd;
+        trim(name, nameEnd);
+
+        if (nameEnd - name == 2 && strncasecmp(name, "br", 2) == 0)
+        {
+            return codingAccepted(params, codingEnd);
+        }
+
+        coding = *codingEnd == ',' ? codingEnd + 1 : codingEnd;
+    }
+
+    return false;
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+/*
+ * Reads the Accept-Encoding header of a request for the web UI.
+ *
+ * The header is a list of codings, each with optional parameters, e.g. "gzip, deflate, br;q=0.5".
+ * A coding is only accepted if it is listed by its own name (case insensitive) and its qvalue, if
+ * given, is over 0. A malformed qvalue does not accept it, the gzip copy of an asset can always be
+ * sent instead. If a coding is listed more than once the first one counts, "*" is not looked at.
+ *
+ * python/web_assets.py accepts_brotli() does the same for the test server, keep the two in step.
+ */
+
+bool acceptsBrotli(const char *acceptEncoding);
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * Compile time time-on-air and link budget calculator for the air rate tables.
+ *
+ * Everything here is constexpr (C++11, so single expression functions) and works on plain numbers,
+ * the radio drivers' register values are decoded next to the tables. Packets are sent the way
+ * ExpressLRS sends them: LoRa with an implicit header and no CRC, FLRC with a fixed length and the
+ * CRC done by the radio.
+ */
+
+// Time between the end of a packet and the timer tick of the next one needed for the radio to turn
+// around and the ISRs to run
+#define AIRTIME_TURNAROUND_US 250
+// Receiver noise figures for the sensitivity, typical of the Semtech datasheets
+#define AIRTIME_NOISE_FIGURE_DB 6           // sub-GHz
+#define AIRTIME_NOISE_FIGURE_2G4_DB 10      // 2.4GHz
+// SNR in the bitrate's bandwidth FLRC demodulates at with its coding
+#define AIRTIME_FLRC_SNR_DB 2
+
+// LoRa time-on-air formula of the chip generation
+typedef enum : uint8_t {
+    AIRTIME_LORA_SX127X,    // SX127x
+    AIRTIME_LORA_SX126X,    // SX126x, SX128x and LR11xx
+} airtimeLoRaFamily_e;
+
+namespace AirTime
+{
+    constexpr uint64_t divCeil(uint64_t num, uint64_t den)
+    {
+        return (num + den - 1) / den;
+    }
+
+    // Symbol time at or above 16.38ms needs the low data rate optimisation
+    constexpr bool lowDataRate(uint8_t sf, uint32_t bwHz)
+    {
+        return ((uint64_t)1000000 << sf) / bwHz >= 16384;
+    }
+
+    // Quarter symbols of preamble, including the sync word and start of frame
+    constexpr uint32_t preambleQuarters(airtimeLoRaFamily_e family, uint8_t sf, uint8_t preamble)
+    {
+        return 4 * preamble + ((family == AIRTIME_LORA_SX126X && sf < 7) ? 25 : 17);
+    }
+
+    // Payload bits that go in the coded blocks after the first 8 symbols
+    constexpr int32_t payloadBits(airtimeLoRaFamily_e family, uint8_t sf, uint8_t payloadLen)
+    {
+        return 8 * payloadLen - 4 * sf + ((family == AIRTIME_LORA_SX126X && sf < 7) ? 0 : 8);
+    }
+
+    constexpr uint32_t payloadSymbols(airtimeLoRaFamily_e family, uint8_t sf, uint32_t bwHz, uint8_t crDen, uint8_t payloadLen)
+    {
+        return 8 + (payloadBits(family, sf, payloadLen) <= 0 ? 0 :
+            divCeil(payloadBits(family, sf, payloadLen), 4 * (sf - (lowDataRate(sf, bwHz) ? 2 : 0))) * crDen);
+    }
+
+    // Long interleaving codes the whole payload at once, two symbols of overhead
+    constexpr uint32_t payloadSymbolsLI(uint8_t sf, uint8_t crDen, uint8_t payloadLen)
+    {
+        return 2 + divCeil(8 * payloadLen * crDen, 4 * sf);
+    }
+
+    constexpr double log10Mantissa(double y)
+    {
+        // 2 * atanh(y) / ln(10) with y = (m - 1) / (m + 1) <= 1/3 for m in [1, 2)
+        return 2.0 * (y + y * y * y / 3 + y * y * y * y * y / 5 + y * y * y * y * y * y * y / 7
+            + y * y * y * y * y * y * y * y * y / 9) / 2.302585092994046;
+    }
+
+    constexpr double log10Approx(double x)
+    {
+        return x >= 2.0 ? 0.3010299956639812 + log10Approx(x / 2) : log10Mantissa((x - 1) / (x + 1));
+    }
+} // namespace AirTime
+
+/**
+ * LoRa packet time on air
+ * @param crDen coding rate denominator, 5 to 8 for 4/5 to 4/8
+ * @param longInterleave long interleaved coding rate (SX128x and LR11xx 2.4GHz)
+ * @param preamble preamble length in symbols
+ * @return microseconds, rounded up
+ */
+constexpr uint32_t AirTimeLoRaUs(airtimeLoRaFamily_e family, uint8_t sf, uint32_t bwHz, uint8_t crDen,
+                                 bool longInterleave, uint8_t preamble, uint8_t payloadLen)
+{
+    // Long interleaving has the SF7+ preamble for every SF
+    return AirTime::divCeil(
+        ((uint64_t)(AirTime::preambleQuarters(longInterleave ? AIRTIME_LORA_SX127X : family, sf, preamble)
+            + 4 * (longInterleave ? AirTime::payloadSymbolsLI(sf, crDen, payloadLen)
+                                  : AirTime::payloadSymbols(family, sf, bwHz, crDen, payloadLen))) * 1000000) << sf,
+        4ULL * bwHz);
+}
+
+/**
+ * FLRC (SX128x) packet time on air: preamble and 32 bit sync word, then the payload, the CRC and 6
+ * tail bits coded at crNum/crDen
+ * @return microseconds, rounded up
+ */
+constexpr uint32_t AirTimeFlrcUs(uint32_t bitrate, uint8_t crNum, uint8_t crDen, uint8_t preambleBits,
+                                 uint8_t payloadLen, uint8_t crcLen)
+{
+    return AirTime::divCeil(
+        (uint64_t)(preambleBits + 32 + ((8 * (payloadLen + crcLen) + (crNum != crDen ? 6 : 0)) * crDen + crNum - 1) / crNum) * 1000000,
+        bitrate);
+}
+
+// Shortest packet interval for a packet of this time on air
+constexpr uint32_t AirTimeMinIntervalUs(uint32_t toaUs)
+{
+    return toaUs + AIRTIME_TURNAROUND_US;
+}
+
+/**
+ * Theoretical LoRa sensitivity: thermal noise in the bandwidth, plus the receiver noise figure,
+ * plus the (negative) SNR the spreading factor demodulates at
+ * @return dBm
+ */
+constexpr double LoRaSensitivityDbm(uint8_t sf, uint32_t bwHz, double noiseFigureDb)
+{
+    return -174.0 + 10.0 * AirTime::log10Approx(bwHz) + noiseFigureDb - 2.5 * (sf - 4);
+}
+
+/**
+ * Theoretical FLRC (SX128x) sensitivity: thermal noise in the bitrate, plus the receiver noise
+ * figure, plus the SNR it demodulates at
+ * @return dBm
+ */
+constexpr double FlrcSensitivityDbm(uint32_t bitrate, double noiseFigureDb)
+{
+    return -174.0 + 10.0 * AirTime::log10Approx(bitrate) + noiseFigureDb + AIRTIME_FLRC_SNR_DB;
+}
+
+// A sensitivity as the tables hold it, in whole dBm and never better than the one given
+constexpr int16_t AirTimeSensitivityDbm(double dbm)
+{
+    return (int16_t)dbm;
+}
@@ -669,6 +669,10 @@ void anti_jamming_switch_init(void)
 
     memset(switch_buf, 0, ctx_size);
 
+    /* A fresh switch starts disabled, forget the state of any previous one */
+    g_anti_jam_enabled = 0u;
+    g_switch_prev_enabled = 0u;
+
     g_aj_switch_ctx = aj_switch_init(switch_buf, ctx_size);
     if (!g_aj_switch_ctx) {
         printf("[ANTIJAM] aj_switch_init failed\n");
@@ -722,6 +726,12 @@ void anti_jamming_get_report(aj_report_t* out)
     aj_get_report(g_aj_ctx, out);
 }
 
+/* Switch context owned by the integration layer, NULL until anti_jamming_switch_init() */
+aj_switch_ctx_t* anti_jamming_get_switch(void)
+{
+    return g_aj_switch_ctx;
+}
+
 /* Optional helper to explicitly trigger a synced hop from code (manual API) */
 void anti_jamming_force_synced_hop(void)
 {
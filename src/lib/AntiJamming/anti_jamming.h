@@ -135,6 +135,8 @@ void anti_jamming_register_packet(uint8_t good, aj_timestamp_ms_t time_ms);
 void anti_jamming_register_external_jam(aj_timestamp_ms_t time_ms);
 void anti_jamming_get_report(aj_report_t* out);
 void anti_jamming_force_synced_hop(void);
+/* Switch driving the enable flag (CH5) and mode (CH7), NULL until anti_jamming_switch_init() */
+struct aj_switch_ctx_s* anti_jamming_get_switch(void);
 
 
 #ifdef __cplusplus
@@ -175,7 +175,7 @@ void checkBackpackUpdate()
 
 static void BackpackWiFiToMSPOut(const uint16_t command)
 {
-    mspPacket_t packet;
+    mspPacketBuffer_t<1> packet;
     packet.reset();
     packet.makeCommand();
     packet.function = command;
@@ -186,7 +186,7 @@ static void BackpackWiFiToMSPOut(const uint16_t command)
 
 static void BackpackHTFlagToMSPOut(const uint8_t arg)
 {
-    mspPacket_t packet;
+    mspPacketBuffer_t<1> packet;
     packet.reset();
     packet.makeCommand();
     packet.function = MSP_ELRS_BACKPACK_SET_HEAD_TRACKING;
@@ -214,7 +214,7 @@ static void BackpackDvrRecordingStateMSPOut(bool recordingState)
         delay = GetDvrDelaySeconds(config.GetDvrStopDelay());
     }
 
-    mspPacket_t packet;
+    mspPacketBuffer_t<3> packet;
     packet.reset();
     packet.makeCommand();
     packet.function = MSP_ELRS_BACKPACK_SET_RECORDING_STATE;
@@ -227,7 +227,7 @@ static void BackpackDvrRecordingStateMSPOut(bool recordingState)
 
 static void BackpackBinding()
 {
-    mspPacket_t packet;
+    mspPacketBuffer_t<UID_LEN> packet;
     packet.reset();
     packet.makeCommand();
     packet.function = MSP_ELRS_BIND;
@@ -326,7 +326,7 @@ void sendCRSFTelemetryToBackpack(const uint8_t *data)
         return;
     }
 
-    mspPacket_t packet;
+    mspPacketBuffer_t<CRSF_MAX_PACKET_LEN> packet;
     packet.reset();
     packet.makeCommand();
     packet.function = MSP_ELRS_BACKPACK_CRSF_TLM;
@@ -361,7 +361,7 @@ void sendMAVLinkTelemetryToBackpack(const uint8_t *data)
 static void sendConfigToBackpack()
 {
     // Send any config values to the tx-backpack, as one key/value pair per MSP msg
-    mspPacket_t packet;
+    mspPacketBuffer_t<2> packet;
     packet.reset();
     packet.makeCommand();
     packet.function = MSP_ELRS_BACKPACK_CONFIG;
@@ -404,7 +404,7 @@ static int timeout()
     {
         lastVersionTryTime = millis();
         versionRequestTries++;
-        mspPacket_t out;
+        mspPacket_t out; // no payload
         out.reset();
         out.makeCommand();
         out.function = MSP_ELRS_GET_BACKPACK_VERSION;
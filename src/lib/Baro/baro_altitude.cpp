@@ -0,0 +1,78 @@
+#include "baro_altitude.h"
+
+// Standard atmosphere altitude (cm) = 4433000 * (1 - (p / 1013250dPa) ^ 0.1903)
+// at p = (ALTITUDE_LUT_FIRST + i) << ALTITUDE_LUT_SHIFT dPa
+#define ALTITUDE_LUT_SHIFT 12
+#define ALTITUDE_LUT_FIRST 61
+static const int32_t altitudeLut[] = {
+    1036824, 1026298, 1015910, 1005654, 995526, 985525, 975645, 965884, 956238, 946705,
+    937282, 927965, 918753, 909642, 900631, 891716, 882895, 874167, 865529, 856980,
+    848516, 840136, 831839, 823623, 815485, 807424, 799439, 791528, 783689, 775921,
+    768223, 760593, 753030, 745533, 738099, 730729, 723421, 716174, 708986, 701856,
+    694785, 687769, 680809, 673904, 667052, 660253, 653506, 646809, 640163, 633565,
+    627016, 620515, 614060, 607652, 601289, 594970, 588696, 582465, 576276, 570129,
+    564024, 557960, 551935, 545950, 540004, 534097, 528227, 522394, 516599, 510839,
+    505116, 499427, 493774, 488154, 482569, 477017, 471498, 466011, 460557, 455134,
+    449743, 444382, 439052, 433752, 428482, 423241, 418029, 412845, 407690, 402563,
+    397464, 392391, 387346, 382327, 377335, 372369, 367428, 362513, 357623, 352757,
+    347917, 343100, 338308, 333539, 328794, 324072, 319373, 314697, 310043, 305412,
+    300802, 296214, 291648, 287103, 282580, 278077, 273594, 269133, 264691, 260270,
+    255868, 251486, 247124, 242780, 238456, 234151, 229864, 225596, 221346, 217115,
+    212901, 208706, 204527, 200367, 196224, 192097, 187988, 183896, 179821, 175762,
+    171719, 167693, 163682, 159688, 155710, 151747, 147800, 143868, 139951, 136050,
+    132164, 128292, 124436, 120593, 116766, 112953, 109154, 105369, 101598, 97841,
+    94098, 90369, 86653, 82951, 79262, 75586, 71924, 68274, 64638, 61014,
+    57403, 53805, 50219, 46645, 43084, 39536, 35999, 32474, 28962, 25461,
+    21972, 18495, 15029, 11575, 8133, 4701, 1281, -2128, -5525, -8912,
+    -12288, -15652, -19007, -22350, -25683, -29005, -32316, -35618, -38908, -42189,
+    -45459, -48720, -51970, -55210, -58440, -61661, -64872, -68073, -71264, -74445,
+    -77618, -80780, -83934, -87078, -90212, -93338, -96454, -99561, -102659, -105749,
+    -108829,};
+static const uint32_t ALTITUDE_LUT_LAST = ALTITUDE_LUT_FIRST + sizeof(altitudeLut) / sizeof(altitudeLut[0]) - 1;
+
+int32_t baroPressureToAltitude(uint32_t pressuredPa)
+{
+    const uint32_t index = pressuredPa >> ALTITUDE_LUT_SHIFT;
+    if (index < ALTITUDE_LUT_FIRST)
+        return altitudeLut[0];
+    if (index >= ALTITUDE_LUT_LAST)
+        return altitudeLut[ALTITUDE_LUT_LAST - ALTITUDE_LUT_FIRST];
+
+    const int32_t lo = altitudeLut[index - ALTITUDE_LUT_FIRST];
+    const int32_t hi = altitudeLut[index - ALTITUDE_LUT_FIRST + 1];
+    const int32_t frac = pressuredPa & ((1 << ALTITUDE_LUT_SHIFT) - 1);
+    // The steepest step is ~10600cm, the product stays well within int32
+    return lo + (((hi - lo) * frac) >> ALTITUDE_LUT_SHIFT);
+}
+
+void BaroAltitudeFilter::update(int32_t altitude_cm, uint32_t now_ms)
+{
+    const uint32_t dT_ms = now_ms - m_lastUpdate;
+    if (!m_valid || dT_ms > MAX_INTERVAL_MS)
+    {
+        m_altitude = altitude_cm * (1 << FRAC_BITS);
+        m_velocity = 0;
+        m_lastUpdate = now_ms;
+        m_valid = true;
+        return;
+    }
+    if (dT_ms == 0)
+        return;
+    m_lastUpdate = now_ms;
+
+    // Predict where the altitude should be now, then correct both states by the residual
+    const int32_t predicted = m_altitude + (int32_t)((int64_t)m_velocity * dT_ms / 1000);
+    const int32_t residual = altitude_cm * (1 << FRAC_BITS) - predicted;
+    m_altitude = predicted + (int32_t)(((int64_t)residual * m_alpha) >> 16);
+    m_velocity += (int32_t)((int64_t)residual * m_beta * 1000 / ((int64_t)dT_ms << 16));
+}
+
+int16_t BaroAltitudeFilter::getVerticalSpeed() const
+{
+    const int32_t vspd = m_velocity >> FRAC_BITS;
+    if (vspd > INT16_MAX)
+        return INT16_MAX;
+    if (vspd < INT16_MIN)
+        return INT16_MIN;
+    return vspd;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * @brief: Return altitude in cm from pressure in deci-Pascals (standard atmosphere)
+ * Uses a lookup table with linear interpolation instead of pow(), pressures outside
+ * of 250-1150hPa are clamped to the ends of the table.
+ **/
+int32_t baroPressureToAltitude(uint32_t pressuredPa);
+
+/**
+ * Alpha-beta filter estimating altitude and vertical speed from raw baro altitudes,
+ * all fixed point so it is cheap on targets without an FPU.
+ *
+ * alpha sets how much of each altitude residual is taken into the altitude estimate and
+ * beta how much goes to the vertical speed, both as fractions of 65536. Lower is smoother
+ * but slower to follow climbs and descents.
+ */
+class BaroAltitudeFilter
+{
+public:
+    static const uint16_t ALPHA_DEFAULT = 11796;  // 0.18
+    static const uint16_t BETA_DEFAULT = 655;     // 0.01
+
+    BaroAltitudeFilter(uint16_t alpha = ALPHA_DEFAULT, uint16_t beta = BETA_DEFAULT)
+        : m_alpha(alpha), m_beta(beta) { reset(); }
+
+    void reset() { m_valid = false; }
+    // Add a raw altitude (cm) measured at now (ms)
+    void update(int32_t altitude_cm, uint32_t now_ms);
+
+    bool isValid() const { return m_valid; }
+    // Filtered altitude (cm)
+    int32_t getAltitude() const { return m_altitude >> FRAC_BITS; }
+    // Filtered vertical speed (cm/s)
+    int16_t getVerticalSpeed() const;
+
+private:
+    static const uint8_t FRAC_BITS = 8;
+    // Longest gap between samples that is still filtered, after that the filter starts over
+    static const uint32_t MAX_INTERVAL_MS = 1000;
+
+    uint16_t m_alpha;
+    uint16_t m_beta;
+    bool m_valid;
+    uint32_t m_lastUpdate;
+    int32_t m_altitude;     // cm << FRAC_BITS
+    int32_t m_velocity;     // cm/s << FRAC_BITS
+};
@@ -1,3 +1,4 @@
+#if !defined(UNIT_TEST)
 #include "baro_bmp280.h"
 #include <Arduino.h>
 #include "logging.h"
@@ -104,3 +105,4 @@ bool BMP280::detect()
 
     return false;
 }
+#endif
@@ -1,3 +1,4 @@
+#if !defined(UNIT_TEST)
 #include <Wire.h>
 
 /****
@@ -165,3 +166,4 @@ bool SPL06::detect()
     readRegister(SPL06_CHIP_ID_REG, &chipid, sizeof(chipid));
     return chipid == SPL06_DEFAULT_CHIP_ID;
 }
+#endif
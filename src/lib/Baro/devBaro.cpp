@@ -4,6 +4,7 @@
 #if defined(TARGET_RX)
 
 #include "CRSFRouter.h"
+#include "baro_altitude.h"
 #include "baro_bmp280.h"
 #include "baro_spl06.h"
 #include "logging.h"
@@ -11,6 +12,9 @@
 //#include "baro_bmp085.h"
 
 #define BARO_STARTUP_INTERVAL       100
+#if !defined(BARO_TELEMETRY_INTERVAL)
+#define BARO_TELEMETRY_INTERVAL     100
+#endif
 
 /* Shameful externs */
 extern Telemetry telemetry;
@@ -18,6 +22,8 @@ extern Telemetry telemetry;
 /* Local statics */
 static BaroBase *baro;
 static eBaroReadState BaroReadState;
+static BaroAltitudeFilter altitudeFilter;
+static bool altitudeUpdated;
 
 extern bool i2c_enabled;
 
@@ -65,25 +71,15 @@ static int Baro_Init()
     return BARO_STARTUP_INTERVAL;
 }
 
-static void Baro_PublishPressure(uint32_t pressuredPa)
+static void Baro_PublishAltitude()
 {
-    static int32_t last_altitude_cm;
-    static int16_t verticalspd_smoothed;
-    int32_t altitude_cm = baro->pressureToAltitude(pressuredPa);
-    int32_t altitude_diff_cm = altitude_cm - last_altitude_cm;
-    last_altitude_cm = altitude_cm;
-
-    static uint32_t last_publish_ms;
-    uint32_t now = millis();
-    uint32_t dT_ms = now - last_publish_ms;
-    last_publish_ms = now;
-
-    //DBGLN("%udPa %dcm", pressuredPa, altitude_cm);
+    const int32_t altitude_cm = altitudeFilter.getAltitude();
+    //DBGLN("%dcm %dcm/s", altitude_cm, altitudeFilter.getVerticalSpeed());
 
     if (baro->getAltitudeHome() == BaroBase::ALTITUDE_INVALID)
     {
         baro->setAltitudeHome(altitude_cm);
-        // skip sending the first reading because the VSpd will be bonkers
+        // skip sending the first reading, it is the reference for the ones after
         return;
     }
 
@@ -104,10 +100,7 @@ static void Baro_PublishPressure(uint32_t pressuredPa)
     crsfBaro.p.altitude = htobe16(crsfBaro.p.altitude);
 
     // Item: VSpd
-    int16_t vspd = altitude_diff_cm * 1000 / (int32_t)dT_ms;
-    verticalspd_smoothed = (verticalspd_smoothed * 3 + vspd) / 4; // Simple smoothing
-    crsfBaro.p.verticalspd = htobe16(verticalspd_smoothed);
-    //DBGLN("diff=%d smooth=%d dT=%u", altitude_diff_cm, verticalspd_smoothed, dT_ms);
+    crsfBaro.p.verticalspd = htobe16(altitudeFilter.getVerticalSpeed());
 
     // if no external vario is connected output internal Vspd on CRSF_FRAMETYPE_BARO_ALTITUDE packet
     if (!telemetry.GetCrsfBaroSensorDetected())
@@ -117,6 +110,13 @@ static void Baro_PublishPressure(uint32_t pressuredPa)
     }
 }
 
+static void Baro_AddPressure(uint32_t pressuredPa)
+{
+    // Every reading goes through the filter, BaroTelemetry_device sends the result
+    altitudeFilter.update(baro->pressureToAltitude(pressuredPa), millis());
+    altitudeUpdated = true;
+}
+
 static bool initialize()
 {
     return Baro_Detect();
@@ -125,6 +125,8 @@ static bool initialize()
 static int start()
 {
     BaroReadState = brsUninitialized;
+    altitudeFilter.reset();
+    altitudeUpdated = false;
     return BARO_STARTUP_INTERVAL;
 }
 
@@ -167,7 +169,7 @@ static int timeout()
                 uint32_t press = baro->getPressure();
                 if (press == BaroBase::PRESSURE_INVALID)
                     return DURATION_IMMEDIATELY;
-                Baro_PublishPressure(press);
+                Baro_AddPressure(press);
             }
             // fallthrough
 
@@ -194,4 +196,41 @@ device_t Baro_device = {
     .subscribe = EVENT_NONE
 };
 
+/***
+ * Telemetry is sent on its own timer at BARO_TELEMETRY_INTERVAL so the rate does not
+ * depend on how long the sensor takes to convert, or on the read state machine
+ */
+static bool telemetryInitialize()
+{
+    // Baro_device must be initialized first
+    return baro != nullptr;
+}
+
+static int telemetryStart()
+{
+    return BARO_TELEMETRY_INTERVAL;
+}
+
+static int telemetryTimeout()
+{
+    if (connectionState >= MODE_STATES)
+        return DURATION_NEVER;
+
+    // Only send once there is a reading that has not been sent yet
+    if (altitudeUpdated && altitudeFilter.isValid())
+    {
+        altitudeUpdated = false;
+        Baro_PublishAltitude();
+    }
+    return BARO_TELEMETRY_INTERVAL;
+}
+
+device_t BaroTelemetry_device = {
+    .initialize = telemetryInitialize,
+    .start = telemetryStart,
+    .event = nullptr,
+    .timeout = telemetryTimeout,
+    .subscribe = EVENT_NONE
+};
+
 #endif
\ No newline at end of file
@@ -15,3 +15,4 @@ enum eBaroReadState : uint8_t
 };
 
 extern device_t Baro_device;
+extern device_t BaroTelemetry_device;
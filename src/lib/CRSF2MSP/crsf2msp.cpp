@@ -4,17 +4,41 @@
 
 CROSSFIRE2MSP::CROSSFIRE2MSP()
 {
+    dropped = 0;
     reset();
 }
 
+CROSSFIRE2MSP::~CROSSFIRE2MSP()
+{
+    releaseBuffer();
+}
+
+void CROSSFIRE2MSP::releaseBuffer()
+{
+    mspBufferPool.release(outBuffer);
+    outBuffer = nullptr;
+}
+
 void CROSSFIRE2MSP::reset()
 {
+    // Abandons any frame in progress and returns its pool block
+    releaseBuffer();
     pktLen = 0;
     idx = 0;
     frameComplete = false;
+    streaming = false;
     MSPvers = MSP_FRAME_UNKNOWN;
 }
 
+void CROSSFIRE2MSP::drop()
+{
+    // A streamed frame that is cut short has already had its first chunks pushed,
+    // the MSP client discards the truncated frame when its checksum fails
+    DBGLN("Dropping MSP frame of %u bytes", pktLen);
+    dropped++;
+    reset();
+}
+
 void CROSSFIRE2MSP::parse(const uint8_t *data)
 {
     uint8_t CRSFpayloadLen = data[CRSF_FRAME_PAYLOAD_LEN_IDX] - CRSF_EXT_FRAME_PAYLOAD_LEN_SIZE_OFFSET;
@@ -35,16 +59,39 @@ void CROSSFIRE2MSP::parse(const uint8_t *data)
         return;
     }
 
+    uint8_t header[3];
     if (newFrame) // If it's a new frame then out a header on first
     {
-        idx = 3; // skip the header start wiring at offset 3.
+        reset();
         MSPvers = getVersion(data);
+        pktLen = getFrameLen(data, MSPvers);
+        // +3 header, +1 checksum
+        streaming = pktLen + 4 > mspBufferPool.blockSize;
+        if (!streaming)
+        {
+            outBuffer = mspBufferPool.acquire();
+            if (outBuffer == nullptr)
+            {
+                drop();
+                return;
+            }
+        }
+        idx = 3; // skip the header start wiring at offset 3.
+        checksum = 0;
         src = data[CRSF_MSP_SRC_OFFSET];
         dest = data[CRSF_MSP_DEST_OFFSET];
-        outBuffer[0] = '$';
-        outBuffer[1] = (MSPvers == MSP_FRAME_V1 || MSPvers == MSP_FRAME_V1_JUMBO) ? 'M' : 'X';
-        outBuffer[2] = error ? '!' : getHeaderDir(data);
-        pktLen = getFrameLen(data, MSPvers);
+        header[0] = '$';
+        header[1] = (MSPvers == MSP_FRAME_V1 || MSPvers == MSP_FRAME_V1_JUMBO) ? 'M' : 'X';
+        header[2] = error ? '!' : getHeaderDir(data);
+        if (!streaming)
+        {
+            memcpy(outBuffer, header, sizeof(header));
+        }
+    }
+    else if (idx == 0 || frameComplete)
+    {
+        // continuation of a frame we did not see the start of, or have already completed
+        return;
     }
 
     // process the chunk of MSP frame
@@ -53,20 +100,55 @@ void CROSSFIRE2MSP::parse(const uint8_t *data)
     // the solution is to use the minimum of the two lengths
     uint32_t frameLen = pktLen - (idx - 3);
     uint32_t minLen = frameLen < CRSFpayloadLen ? frameLen : CRSFpayloadLen;
-    memcpy(&outBuffer[idx], &data[CRSF_MSP_FRAME_OFFSET], minLen); // chunk of MSP data
-    idx += minLen;
+    const uint8_t *chunk = &data[CRSF_MSP_FRAME_OFFSET];
+    checksum = updateChecksum(checksum, chunk, minLen, MSPvers);
+    bool lastChunk = idx + minLen - 3 == pktLen; // -3 because the header isn't counted
 
-    if (idx - 3 == pktLen) // we have a complete MSP frame, -3 because the header isn't counted
+    if (streaming)
     {
-        // we need to append the MSP checksum
-        outBuffer[idx] = getChecksum(outBuffer + 3, pktLen, MSPvers); // +3 because the header isn't in checksum
-        frameComplete = true;
-
+        // the header goes out with the first chunk and the checksum with the last
+        const uint32_t segmentLen = (newFrame ? sizeof(header) : 0) + minLen + (lastChunk ? 1 : 0);
+        if (!FIFOout.available(segmentLen + 2))
+        {
+            drop();
+            return;
+        }
         FIFOout.lock();
-        FIFOout.pushSize(idx + 1);
-        FIFOout.pushBytes(outBuffer, idx + 1);
+        FIFOout.pushSize(segmentLen);
+        if (newFrame)
+        {
+            FIFOout.pushBytes(header, sizeof(header));
+        }
+        FIFOout.pushBytes(chunk, minLen);
+        if (lastChunk)
+        {
+            FIFOout.push(checksum);
+        }
         FIFOout.unlock();
+        idx += minLen;
     }
+    else
+    {
+        memcpy(&outBuffer[idx], chunk, minLen); // chunk of MSP data
+        idx += minLen;
+        if (lastChunk)
+        {
+            // we need to append the MSP checksum
+            outBuffer[idx] = checksum;
+            if (!FIFOout.available(idx + 1 + 2))
+            {
+                drop();
+                return;
+            }
+            FIFOout.lock();
+            FIFOout.pushSize(idx + 1);
+            FIFOout.pushBytes(outBuffer, idx + 1);
+            FIFOout.unlock();
+            releaseBuffer();
+        }
+    }
+
+    frameComplete = lastChunk;
 }
 
 bool CROSSFIRE2MSP::isNewFrame(const uint8_t *data)
@@ -116,10 +198,8 @@ MSPframeType_e CROSSFIRE2MSP::getVersion(const uint8_t *data)
     return MSPvers;
 }
 
-uint8_t CROSSFIRE2MSP::getChecksum(const uint8_t *data, const uint32_t len, MSPframeType_e mspVersion)
+uint8_t CROSSFIRE2MSP::updateChecksum(uint8_t checkSum, const uint8_t *data, const uint32_t len, MSPframeType_e mspVersion)
 {
-    uint8_t checkSum = 0;
-
     if (mspVersion == MSP_FRAME_V1 || mspVersion == MSP_FRAME_V1_JUMBO)
     {
         for (uint32_t i = 0; i < len; i++)
@@ -130,7 +210,7 @@ uint8_t CROSSFIRE2MSP::getChecksum(const uint8_t *data, const uint32_t len, MSPf
     }
     else if (mspVersion == MSP_FRAME_V2)
     {
-        checkSum = crsfRouter.crsf_crc.calc(data, len);
+        checkSum = crsfRouter.crsf_crc.calc(data, len, checkSum);
     }
     else
     {
@@ -188,11 +268,6 @@ bool CROSSFIRE2MSP::isFrameReady()
     return frameComplete;
 }
 
-const uint8_t *CROSSFIRE2MSP::getFrame()
-{
-    return outBuffer;
-}
-
 uint32_t CROSSFIRE2MSP::getFrameLen()
 {
     return idx + 1; // include the last byte (crc)
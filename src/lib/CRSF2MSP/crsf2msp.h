@@ -3,17 +3,24 @@
 #include <cstdint>
 #include "FIFO.h"
 #include "crsfmsp_common.h"
+#include "msppool.h"
 #include "crc.h"
 #include "logging.h"
 
 /*  Takes a CRSF(MSP) frame and converts it to raw MSP frame
     adding the MSP header and checksum. Handles chunked MSP messages.
+    A frame that fits in a block from mspBufferPool is reassembled there while
+    chunks are arriving and pushed to FIFOout whole, the block is only held
+    until the frame completes or is abandoned.
+    Larger frames are streamed, each chunk is pushed to FIFOout as its own
+    size prefixed segment as it arrives (header with the first, checksum with the last).
+    FIFOout is a byte stream of segments, the consumer must not assume one segment is one frame.
 */
 
 class CROSSFIRE2MSP
 {
 private:
-    uint8_t outBuffer[MSP_FRAME_MAX_LEN];
+    uint8_t *outBuffer = nullptr;
     uint32_t pktLen; // packet length of the incomming msp frame
     uint32_t idx;    // number of bytes received in the current msp frame
     uint8_t seqNumberPrev;
@@ -21,6 +28,9 @@ private:
     uint8_t src;            // source of the msp frame (from CRSF ext header)
     uint8_t dest;           // destination of the msp frame (from CRSF ext header)
     MSPframeType_e MSPvers; // need to store the MSP version since it can only be inferred from the first frame
+    uint8_t checksum;       // running checksum of the MSP frame received so far
+    bool streaming;         // frame is too big for a pool block and goes out chunk by chunk
+    uint32_t dropped;       // frames abandoned because there was no block or FIFOout space
 
     bool isNewFrame(const uint8_t *data);
     bool isError(const uint8_t *data);
@@ -28,16 +38,19 @@ private:
     uint8_t getSeqNumber(const uint8_t *data);
     MSPframeType_e getVersion(const uint8_t *data);
     uint8_t getHeaderDir(const uint8_t *data);
-    uint8_t getChecksum(const uint8_t *data, const uint32_t packetLen, MSPframeType_e mspVersion);
+    uint8_t updateChecksum(uint8_t checkSum, const uint8_t *data, uint32_t len, MSPframeType_e mspVersion);
     uint32_t getFrameLen(const uint8_t *data, MSPframeType_e mspVersion);
+    void releaseBuffer();
+    void drop();
 
 public:
     CROSSFIRE2MSP();
+    ~CROSSFIRE2MSP();
     FIFO<MSP_FRAME_MAX_LEN> FIFOout;
     void parse(const uint8_t *data); // accept crsf frame input
     bool isFrameReady();
-    const uint8_t *getFrame();
     uint32_t getFrameLen();
+    uint32_t getDroppedCount() const { return dropped; }
     void reset();
     uint8_t getSrc();
     uint8_t getDest();
@@ -160,8 +160,15 @@ void MSP2CROSSFIRE::parse(const uint8_t *data, uint32_t frameLen, uint8_t src, u
     MSPframeType_e mspVersion = getVersion(data);
     uint32_t MSPpayloadLen = getPayloadLen(data, mspVersion);
     uint32_t MSPframeLen = getFrameLen(MSPpayloadLen, mspVersion);
-    uint8_t numChunks = (MSPframeLen / CRSF_MSP_MAX_BYTES_PER_CHUNK) + 1; // gotta count the first chunk!
-    uint8_t chunkRemainder = MSPframeLen % CRSF_MSP_MAX_BYTES_PER_CHUNK;
+    // round up, a frame that is an exact multiple of the chunk size does not need an empty trailing chunk
+    uint32_t numChunks = (MSPframeLen + CRSF_MSP_MAX_BYTES_PER_CHUNK - 1) / CRSF_MSP_MAX_BYTES_PER_CHUNK;
+
+    // Every chunk adds the 7 byte header and the crc, the frame is only queued if all of it fits
+    if (!FIFOout.available(MSPframeLen + numChunks * (CRSF_MSP_LEN_TO_ENCAP_FRAME_OFFSET + 1)))
+    {
+        DBGLN("No room to queue MSP frame of %u bytes", MSPframeLen);
+        return;
+    }
 
     uint8_t header[7];
     // first element has to be size of the fifo chunk (can't be bigger than CRSF_MAX_PACKET_LEN)
@@ -175,7 +182,7 @@ void MSP2CROSSFIRE::parse(const uint8_t *data, uint32_t frameLen, uint8_t src, u
 
     setVersion(header[6], mspVersion);
 
-    for (uint8_t i = 0; i < numChunks; i++)
+    for (uint32_t i = 0; i < numChunks; i++)
     {
         setSeqNumber(header[6], (seqNum++ & 0b1111));
         setNewFrame(header[6], (i == 0 ? true : false)); // if first chunk then set to true, else false
@@ -184,7 +191,7 @@ void MSP2CROSSFIRE::parse(const uint8_t *data, uint32_t frameLen, uint8_t src, u
         uint32_t startIdx = (i * CRSF_MSP_MAX_BYTES_PER_CHUNK) + 3; // we don't xmit the MSP header
         uint8_t CRSFpktLen;                                         // TOTAL length of the CRSF packet, (what the FIFO cares about)
 
-        CRSFpktLen = (i == (numChunks - 1)) ? chunkRemainder : (CRSF_MSP_MAX_BYTES_PER_CHUNK);
+        CRSFpktLen = (i == (numChunks - 1)) ? MSPframeLen - (i * CRSF_MSP_MAX_BYTES_PER_CHUNK) : (CRSF_MSP_MAX_BYTES_PER_CHUNK);
 
         header[0] = CRSFpktLen + CRSF_EXT_FRAME_PAYLOAD_LEN_SIZE_OFFSET + 2;
         header[2] = CRSFpktLen + CRSF_EXT_FRAME_PAYLOAD_LEN_SIZE_OFFSET;
@@ -28,7 +28,7 @@ private:
 
 public:
     MSP2CROSSFIRE();
-    FIFO<MSP_FRAME_MAX_LEN> FIFOout;
+    FIFO<MSP2CRSF_FIFO_LEN> FIFOout;
     void parse(const uint8_t *data, uint32_t frameLen, uint8_t src = CRSF_ADDRESS_CRSF_RECEIVER, uint8_t dest = CRSF_ADDRESS_FLIGHT_CONTROLLER);
     bool validate(const uint8_t *data, uint32_t expectLen);
 };
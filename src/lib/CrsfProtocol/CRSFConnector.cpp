@@ -7,13 +7,13 @@ void CRSFConnector::addDevice(const crsf_addr_e device_id)
 {
     if (device_id != 0)
     {
-        devices.insert(device_id);
+        devices[device_id / 32] |= 1U << (device_id % 32);
     }
 }
 
 bool CRSFConnector::forwardsTo(const crsf_addr_e device_id)
 {
-    return devices.find(device_id) != devices.end();
+    return devices[device_id / 32] & (1U << (device_id % 32));
 }
 
 void CRSFConnector::debugCRSF(const char *str, const crsf_header_t *message)
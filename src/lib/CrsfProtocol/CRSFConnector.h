@@ -3,8 +3,6 @@
 
 #include "crsf_protocol.h"
 
-#include <set>
-
 /**
  * @class CRSFConnector
  *
@@ -72,7 +70,7 @@ public:
     static void debugCRSF(const char * str, const crsf_header_t * message);
 
 private:
-    std::set<crsf_addr_e> devices;
+    uint32_t devices[256 / 32] = {};   // bit per CRSF address
 };
 
 #endif //CRSF_CONNECTOR_H
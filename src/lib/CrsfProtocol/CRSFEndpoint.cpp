@@ -78,6 +78,7 @@ void CRSFEndpoint::filterOptions(selectionParameter *parameter, const uint8_t mi
         pwr++;
     }
     *out = '\0';
+    parameter->common.generation++;
 }
 
 static uint8_t selectionOptionMax(const char *strOptions)
@@ -216,27 +217,29 @@ uint8_t *CRSFEndpoint::folderParameterToArray(const folderParameter *parameter,
     return childParameters;
 }
 
-uint8_t CRSFEndpoint::sendParameter(const crsf_addr_e origin, const bool isElrs, const crsf_frame_type_e frameType, const uint8_t fieldChunk, const propertiesCommon *parameter)
+/**
+ * @brief Serializes the parameter into paramImage, for sendParameter to copy the chunks from.
+ *
+ * @return false if the parameter type can not be sent
+ */
+bool CRSFEndpoint::serializeParameter(const bool isElrs, const propertiesCommon *parameter)
 {
     const uint8_t dataType = parameter->type & CRSF_FIELD_TYPE_MASK;
 
-    // 256 max payload + (FieldID + ChunksRemain + Parent + Type)
     // Chunk 1: (FieldID + ChunksRemain + Parent + Type) + fieldChunk0 data
     // Chunk 2-N: (FieldID + ChunksRemain) + fieldChunk1 data
-    uint8_t chunkBuffer[256 + 4];
     // Start the field payload at 2 to leave room for (FieldID + ChunksRemain)
-    chunkBuffer[2] = parameter->parent;
-    chunkBuffer[3] = dataType;
+    paramImage[2] = parameter->parent;
+    paramImage[3] = dataType;
     // Set the hidden flag
-    chunkBuffer[3] |= parameter->type & CRSF_FIELD_HIDDEN ? 0x80 : 0;
+    paramImage[3] |= parameter->type & CRSF_FIELD_HIDDEN ? 0x80 : 0;
     if (isElrs)
     {
-        chunkBuffer[3] |= parameter->type & CRSF_FIELD_ELRS_HIDDEN ? 0x80 : 0;
+        paramImage[3] |= parameter->type & CRSF_FIELD_ELRS_HIDDEN ? 0x80 : 0;
     }
-    uint8_t paramInformation[CRSF_MAX_PACKET_LEN];
 
-    // Copy the name to the buffer starting at chunkBuffer[4]
-    uint8_t *chunkStart = (uint8_t *)stpcpy((char *)&chunkBuffer[4], parameter->name) + 1;
+    // Copy the name to the buffer starting at paramImage[4]
+    uint8_t *chunkStart = (uint8_t *)stpcpy((char *)&paramImage[4], parameter->name) + 1;
     uint8_t *dataEnd;
 
     switch (dataType)
@@ -262,18 +265,37 @@ uint8_t CRSFEndpoint::sendParameter(const crsf_addr_e origin, const bool isElrs,
     case CRSF_FOLDER:
         // re-fetch the folder name, because folderStructToArray will decide whether
         // to return the fixed name or dynamic name.
-        dataEnd = folderParameterToArray((folderParameter *)parameter, &chunkBuffer[4]);
+        dataEnd = folderParameterToArray((folderParameter *)parameter, &paramImage[4]);
         break;
     case CRSF_FLOAT:
     case CRSF_OUT_OF_RANGE:
     default:
-        return 0;
+        paramImageId = 0xFF;
+        return false;
     }
 
     // dataEnd points to the end of the last string
     // -2 bytes chunk header: FieldId, ChunksRemain
     // +1 for the null on the last string
-    const uint8_t dataSize = (dataEnd - chunkBuffer) - 2 + 1;
+    paramImageSize = (dataEnd - paramImage) - 2 + 1;
+    paramImageId = parameter->id;
+    paramImageGeneration = parameter->generation;
+    paramImageElrs = isElrs;
+    return true;
+}
+
+uint8_t CRSFEndpoint::sendParameter(const crsf_addr_e origin, const bool isElrs, const crsf_frame_type_e frameType, const uint8_t fieldChunk, const propertiesCommon *parameter)
+{
+    // A read starts with the first chunk, so the values are always fresh. The rest of the chunks
+    // come from the same image unless the parameter has changed since.
+    if (fieldChunk == 0 || parameter->id != paramImageId || parameter->generation != paramImageGeneration || isElrs != paramImageElrs)
+    {
+        if (!serializeParameter(isElrs, parameter))
+        {
+            return 0;
+        }
+    }
+
     // Maximum number of chunked bytes that can be sent in one response
     // 6 bytes CRSF header/CRC: Dest, Len, Type, ExtSrc, ExtDst, CRC
     // 2 bytes chunk header: FieldId, ChunksRemain
@@ -281,15 +303,19 @@ uint8_t CRSFEndpoint::sendParameter(const crsf_addr_e origin, const bool isElrs,
     // this is for slow baud-rates to the handset
     const uint8_t chunkMax = crsfRouter.getConnectorMaxPacketSize(origin) - 6 - 2;
     // How many chunks needed to send this field (rounded up)
-    const uint8_t chunkCnt = (dataSize + chunkMax - 1) / chunkMax;
+    const uint8_t chunkCnt = (paramImageSize + chunkMax - 1) / chunkMax;
+    if (fieldChunk >= chunkCnt)
+    {
+        return 0;
+    }
     // Data left to send is adjustedSize - chunks sent already
-    const uint8_t chunkSize = std::min((uint8_t)(dataSize - (fieldChunk * chunkMax)), chunkMax);
+    const uint8_t chunkSize = std::min((uint8_t)(paramImageSize - (fieldChunk * chunkMax)), chunkMax);
 
-    // Move chunkStart back 2 bytes to add (FieldId + ChunksRemain) to each packet
-    chunkStart = &chunkBuffer[fieldChunk * chunkMax];
-    chunkStart[0] = parameter->id;                 // FieldId
-    chunkStart[1] = chunkCnt - (fieldChunk + 1); // ChunksRemain
-    memcpy(paramInformation + sizeof(crsf_ext_header_t), chunkStart, chunkSize + 2);
+    uint8_t paramInformation[CRSF_MAX_PACKET_LEN];
+    uint8_t *chunk = paramInformation + sizeof(crsf_ext_header_t);
+    chunk[0] = parameter->id;                 // FieldId
+    chunk[1] = chunkCnt - (fieldChunk + 1); // ChunksRemain
+    memcpy(&chunk[2], &paramImage[2 + fieldChunk * chunkMax], chunkSize);
     crsfRouter.SetExtendedHeaderAndCrc((crsf_ext_header_t *)paramInformation, frameType, CRSF_EXT_FRAME_SIZE(chunkSize + 2), origin, device_id);
     crsfRouter.deliverMessage(nullptr, (crsf_header_t *)paramInformation);
     return chunkCnt - (fieldChunk + 1);
@@ -312,10 +338,29 @@ void CRSFEndpoint::sendCommandResponse(commandParameter *cmd, const commandStep_
 {
     cmd->step = step;
     cmd->info = message;
+    cmd->common.generation++;
     nextStatusChunk = 0;
     pushResponseChunk(cmd, false);
 }
 
+#if defined(DEBUG_ISR_PROFILE)
+void CRSFEndpoint::registerProfileFolder(CRSFProfileFolder &profile)
+{
+    registerParameter(&profile.folder);
+    for (uint8_t i = 0; i < profile.probeCount; i++)
+    {
+        registerParameter(&profile.probes[i], nullptr, profile.folder.common.id);
+    }
+    registerParameter(&profile.reset, [this, &profile](propertiesCommon *item, uint8_t arg) {
+        if (arg == lcsClick)
+        {
+            Profiler::reset();
+        }
+        sendCommandResponse(&profile.reset, arg < lcsCancel ? lcsExecuting : lcsIdle, arg < lcsCancel ? "Resetting..." : STR_EMPTYSPACE);
+    }, profile.folder.common.id);
+}
+#endif
+
 void CRSFEndpoint::registerParameter(void *definition, const parameterHandlerCallback &callback, const uint8_t parent)
 {
     // On the first call we initialise the root folder
@@ -354,6 +399,8 @@ void CRSFEndpoint::parameterUpdateReq(const crsf_addr_e origin, const bool isElr
             else
             {
                 paramCallbacks[parameterIndex](parameter, parameterArg);
+                // The callback may have changed the value without a setter
+                parameter->generation++;
             }
         }
         break;
@@ -374,6 +421,7 @@ void CRSFEndpoint::parameterUpdateReq(const crsf_addr_e origin, const bool isElr
             {
                 field->step = lcsIdle;
                 field->info = "";
+                field->common.generation++;
             }
             sendParameter(origin, isElrs, CRSF_FRAMETYPE_PARAMETER_SETTINGS_ENTRY, parameterArg, &field->common);
         }
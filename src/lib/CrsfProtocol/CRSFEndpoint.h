@@ -2,6 +2,7 @@
 #define CRSF_ENDPOINT_H
 
 #include "CRSFParameters.h"
+#include "CRSFProfileFolder.h"
 
 #define MAX_CRSF_PARAMETERS 64
 
@@ -103,6 +104,15 @@ protected:
      */
     void sendCommandResponse(commandParameter *cmd, commandStep_e step, const char *message);
 
+#if defined(DEBUG_ISR_PROFILE)
+    /**
+     * Registers the ISR profile folder, its probe rows and the reset command.
+     *
+     * @param profile The folder, which must outlive the endpoint
+     */
+    void registerProfileFolder(CRSFProfileFolder &profile);
+#endif
+
     /**
      * Filters a set of selectable options within a provided range and modifies
      * the input string in place.
@@ -128,7 +138,7 @@ protected:
      * @param parameter Pointer to the selection parameter structure to modify
      * @param newValue The new value to set
      */
-    static void setTextSelectionValue(selectionParameter *parameter, const uint8_t newValue) { parameter->value = newValue; }
+    static void setTextSelectionValue(selectionParameter *parameter, const uint8_t newValue) { parameter->value = newValue; parameter->common.generation++; }
 
     /**
      * Sets an unsigned 8-bit integer value in a CRSF parameter structure.
@@ -136,7 +146,7 @@ protected:
      * @param parameter Pointer to the int8Parameter structure to modify
      * @param newValue The new unsigned 8-bit value to set
      */
-    static void setUint8Value(int8Parameter *parameter, const uint8_t newValue) { parameter->properties.u.value = newValue; }
+    static void setUint8Value(int8Parameter *parameter, const uint8_t newValue) { parameter->properties.u.value = newValue; parameter->common.generation++; }
 
     /**
      * Sets a signed 8-bit integer value in a CRSF parameter structure.
@@ -144,7 +154,7 @@ protected:
      * @param parameter Pointer to the int8Parameter structure to modify
      * @param newValue The new signed 8-bit value to set
      */
-    static void setInt8Value(int8Parameter *parameter, const int8_t newValue) { parameter->properties.s.value = newValue; }
+    static void setInt8Value(int8Parameter *parameter, const int8_t newValue) { parameter->properties.s.value = newValue; parameter->common.generation++; }
 
     /**
      * Sets an unsigned 16-bit integer value in a CRSF parameter structure.
@@ -153,7 +163,7 @@ protected:
      * @param parameter Pointer to the int16Parameter structure to modify
      * @param newValue The new unsigned 16-bit value to set
      */
-    static void setUint16Value(int16Parameter *parameter, const uint16_t newValue) { parameter->properties.u.value = htobe16(newValue); }
+    static void setUint16Value(int16Parameter *parameter, const uint16_t newValue) { parameter->properties.u.value = htobe16(newValue); parameter->common.generation++; }
 
     /**
      * Sets a signed 16-bit integer value in a CRSF parameter structure.
@@ -162,7 +172,7 @@ protected:
      * @param parameter Pointer to the int16Parameter structure to modify
      * @param newValue The new signed 16-bit value to set
      */
-    static void setInt16Value(int16Parameter *parameter, const int16_t newValue) { parameter->properties.u.value = htobe16((uint16_t)newValue); }
+    static void setInt16Value(int16Parameter *parameter, const int16_t newValue) { parameter->properties.u.value = htobe16((uint16_t)newValue); parameter->common.generation++; }
 
     /**
      * Sets a float value in a CRSF parameter structure.
@@ -171,7 +181,7 @@ protected:
      * @param parameter Pointer to the floatParameter structure to modify
      * @param newValue The new value to set as a 32-bit integer
      */
-    static void setFloatValue(floatParameter *parameter, const int32_t newValue) { parameter->properties.value = htobe32((uint32_t)newValue); }
+    static void setFloatValue(floatParameter *parameter, const int32_t newValue) { parameter->properties.value = htobe32((uint32_t)newValue); parameter->common.generation++; }
 
     /**
      * Sets a string value in a CRSF parameter structure.
@@ -179,7 +189,7 @@ protected:
      * @param parameter Pointer to the stringParameter structure to modify
      * @param newValue The new string value to set
      */
-    static void setStringValue(stringParameter *parameter, const char *newValue) { parameter->value = newValue; }
+    static void setStringValue(stringParameter *parameter, const char *newValue) { parameter->value = newValue; parameter->common.generation++; }
 
 private:
     crsf_addr_e device_id;
@@ -193,6 +203,14 @@ private:
     uint8_t lastParameter = 0;
     uint8_t nextStatusChunk = 0;
 
+    // Serialized image of the last parameter read, the chunks after the first are copied from it.
+    // Starts at paramImage[2] to leave room for (FieldID + ChunksRemain), 256 max payload.
+    uint8_t paramImage[256 + 4];
+    uint8_t paramImageSize = 0;
+    uint8_t paramImageId = 0xFF;
+    uint8_t paramImageGeneration = 0;
+    bool paramImageElrs = false;
+
     static uint8_t *textSelectionParameterToArray(const selectionParameter *parameter, uint8_t *next);
     static uint8_t *commandParameterToArray(const commandParameter *parameter, uint8_t *next);
     static uint8_t *int8ParameterToArray(const int8Parameter *parameter, uint8_t *next);
@@ -200,6 +218,7 @@ private:
     static uint8_t *stringParameterToArray(const stringParameter *parameter, uint8_t *next);
     uint8_t *folderParameterToArray(const folderParameter *parameter, uint8_t *next) const;
 
+    bool serializeParameter(bool isElrs, const propertiesCommon *parameter);
     uint8_t sendParameter(crsf_addr_e origin, bool isElrs, crsf_frame_type_e frameType, uint8_t fieldChunk, const propertiesCommon *parameter);
     void pushResponseChunk(commandParameter *cmd, bool isElrs);
 };
@@ -12,6 +12,7 @@ struct propertiesCommon
     crsf_value_type_e type;
     uint8_t id;     // Sequential id assigned by enumeration
     uint8_t parent; // id of parent folder
+    uint8_t generation; // bumped when the parameter changes, invalidates its cached serialization
 } PACKED;
 
 struct selectionParameter
@@ -119,10 +120,12 @@ struct elrsStatusParameter
 #define LUA_FIELD_HIDE(fld)                                                                  \
     {                                                                                        \
         fld.common.type = (crsf_value_type_e)((uint8_t)fld.common.type | CRSF_FIELD_HIDDEN); \
+        fld.common.generation++;                                                             \
     }
 #define LUA_FIELD_SHOW(fld)                                                                   \
     {                                                                                         \
         fld.common.type = (crsf_value_type_e)((uint8_t)fld.common.type & ~CRSF_FIELD_HIDDEN); \
+        fld.common.generation++;                                                              \
     }
 #define LUA_FIELD_VISIBLE(fld, cond) \
     {                                \
@@ -0,0 +1,24 @@
+#if defined(DEBUG_ISR_PROFILE)
+
+#include "CRSFProfileFolder.h"
+
+CRSFProfileFolder::CRSFProfileFolder(const profileProbe_e *probeIds, const uint8_t probeCount)
+    : probeIds(probeIds), probeCount(probeCount < PROFILE_PROBE_COUNT ? probeCount : PROFILE_PROBE_COUNT)
+{
+    for (uint8_t i = 0; i < this->probeCount; i++)
+    {
+        probes[i].common.name = Profiler::name(probeIds[i]);
+        probes[i].common.type = CRSF_INFO;
+        probes[i].value = strings[i];
+    }
+}
+
+void CRSFProfileFolder::update()
+{
+    for (uint8_t i = 0; i < probeCount; i++)
+    {
+        Profiler::format(probeIds[i], strings[i], sizeof(strings[i]));
+    }
+}
+
+#endif
@@ -0,0 +1,38 @@
+#pragma once
+
+#if defined(DEBUG_ISR_PROFILE)
+
+#include "CRSFParameters.h"
+#include "profiler.h"
+
+/*
+ * The "ISR Profile" Lua folder, a row with the min/mean/max of each of the given probes and a
+ * command to reset them. An endpoint registers it with CRSFEndpoint::registerProfileFolder() and
+ * calls update() from its updateParameters() to refresh the rows.
+ */
+class CRSFProfileFolder
+{
+public:
+    CRSFProfileFolder(const profileProbe_e *probeIds, uint8_t probeCount);
+
+    void update();
+
+private:
+    friend class CRSFEndpoint;
+
+    folderParameter folder = {
+        {"ISR Profile", CRSF_FOLDER},
+    };
+    stringParameter probes[PROFILE_PROBE_COUNT] {};
+    char strings[PROFILE_PROBE_COUNT][24] {};
+    commandParameter reset = {
+        {"Reset Stats", CRSF_COMMAND},
+        lcsIdle, // step
+        STR_EMPTYSPACE
+    };
+
+    const profileProbe_e *probeIds;
+    const uint8_t probeCount;
+};
+
+#endif
@@ -1,12 +1,16 @@
 #include "CRSFRouter.h"
 
+#include "logging.h"
 #include "msptypes.h"
 
 elrsLinkStatistics_t linkStats {};
 
 void CRSFRouter::addConnector(CRSFConnector *connector)
 {
-    connectors.insert(connector);
+    if (!connectors.insert(connector))
+    {
+        ERRLN("Too many CRSF connectors");
+    }
 }
 
 void CRSFRouter::removeConnector(CRSFConnector *connector)
@@ -16,7 +20,10 @@ void CRSFRouter::removeConnector(CRSFConnector *connector)
 
 void CRSFRouter::addEndpoint(CRSFEndpoint *endpoint)
 {
-    endpoints.insert(endpoint);
+    if (!endpoints.insert(endpoint))
+    {
+        ERRLN("Too many CRSF endpoints");
+    }
 }
 
 void CRSFRouter::processMessage(CRSFConnector *connector, const crsf_header_t *message) const
@@ -130,7 +137,7 @@ void CRSFRouter::SetMspV2Request(uint8_t *frame, const uint16_t function, const
 
 void CRSFRouter::AddMspMessage(const mspPacket_t *packet, const uint8_t destination, const uint8_t origin)
 {
-    if (packet->payloadSize > ENCAPSULATED_MSP_MAX_PAYLOAD_SIZE)
+    if (packet->payloadSize > ENCAPSULATED_MSP_MAX_PAYLOAD_SIZE || packet->writeError)
     {
         return;
     }
@@ -151,10 +158,7 @@ void CRSFRouter::AddMspMessage(const mspPacket_t *packet, const uint8_t destinat
     outBuffer[7] = packet->function;    // packet->cmd
 
     // Copy packet payload into outBuffer
-    for (uint16_t i = 0; i < packet->payloadSize; ++i)
-    {
-        outBuffer[8 + i] = packet->payload[i];
-    }
+    memcpy(&outBuffer[8], packet->payload, packet->payloadSize);
 
     // Encapsulated MSP crc
     outBuffer[totalBufferLen - 2] = CalcCRCMsp(&outBuffer[6], packet->payloadSize + 2);
@@ -4,9 +4,11 @@
 #include "CRSFConnector.h"
 #include "CRSFEndpoint.h"
 #include "crc.h"
+#include "fixed_set.h"
 #include "msp.h"
 
-#include <vector>
+#define CRSF_MAX_CONNECTORS 8
+#define CRSF_MAX_ENDPOINTS 8
 
 class CRSFRouter final
 {
@@ -130,8 +132,8 @@ public:
     GENERIC_CRC8 crsf_crc = GENERIC_CRC8(CRSF_CRC_POLY);
 
 private:
-    std::set<CRSFConnector *> connectors;
-    std::set<CRSFEndpoint *> endpoints;
+    FixedSet<CRSFConnector *, CRSF_MAX_CONNECTORS> connectors;
+    FixedSet<CRSFEndpoint *, CRSF_MAX_ENDPOINTS> endpoints;
 };
 
 // The global instance of the endpoint
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "targets.h"
+
+#define DELTA_MD5_LEN 16
+
+#if defined(TARGET_NATIVE)
+/*
+ * Minimal MD5 (RFC 1321) for the native build, the targets use the MD5Builder from the core.
+ */
+class DeltaMD5
+{
+public:
+    void begin();
+    void add(const uint8_t *data, uint32_t len);
+    void calculate();
+    void getBytes(uint8_t *out) const;
+
+private:
+    uint32_t m_state[4];
+    uint64_t m_count;
+    uint8_t m_buffer[64];
+    uint8_t m_digest[DELTA_MD5_LEN];
+
+    void transform(const uint8_t *block);
+};
+#else
+#include <MD5Builder.h>
+
+class DeltaMD5 : public MD5Builder
+{
+public:
+    void add(const uint8_t *data, uint32_t len) { MD5Builder::add(const_cast<uint8_t *>(data), len); }
+};
+#endif
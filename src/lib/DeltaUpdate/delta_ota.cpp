@@ -0,0 +1,62 @@
+#if !defined(UNIT_TEST)
+
+#include "delta_ota.h"
+#include "logging.h"
+
+#if defined(PLATFORM_ESP32)
+#include <Update.h>
+#include <esp_ota_ops.h>
+#else
+#include <Updater.h>
+#endif
+
+RunningFirmwareSource::RunningFirmwareSource()
+{
+#if defined(PLATFORM_ESP32)
+    const esp_partition_t *running = esp_ota_get_running_partition();
+    m_base = running ? running->address : 0;
+    m_size = running ? running->size : 0;
+#else
+    // ESP8266 sketch is always at 0, the update is staged in the free space above it
+    m_base = 0;
+    m_size = ESP.getSketchSize() + ESP.getFreeSketchSpace();
+#endif
+}
+
+bool RunningFirmwareSource::read(uint32_t offset, uint8_t *data, uint32_t len)
+{
+    // flashRead needs a word aligned address, length and buffer
+    WORD_ALIGNED_ATTR uint8_t aligned[DELTA_BUFFER_SIZE + 8];
+    while (len > 0)
+    {
+        const uint32_t address = m_base + offset;
+        const uint32_t lead = address & 3;
+        const uint32_t n = len < DELTA_BUFFER_SIZE ? len : DELTA_BUFFER_SIZE;
+        if (!ESP.flashRead(address - lead, (uint32_t *)aligned, (lead + n + 3) & ~3))
+        {
+            return false;
+        }
+        memcpy(data, &aligned[lead], n);
+        data += n;
+        offset += n;
+        len -= n;
+    }
+    return true;
+}
+
+bool UpdateSink::begin(uint32_t size)
+{
+    if (!Update.begin(size, U_FLASH))
+    {
+        Update.printError(LOGGING_UART);
+        return false;
+    }
+    return true;
+}
+
+bool UpdateSink::write(const uint8_t *data, uint32_t len)
+{
+    return Update.write(const_cast<uint8_t *>(data), len) == len;
+}
+
+#endif
@@ -0,0 +1,26 @@
+#pragma once
+
+#if !defined(UNIT_TEST)
+#include "delta_patch.h"
+
+// The running firmware, including the options/hardware trailer appended by the configurator
+class RunningFirmwareSource : public DeltaSource
+{
+public:
+    RunningFirmwareSource();
+    uint32_t size() override { return m_size; }
+    bool read(uint32_t offset, uint8_t *data, uint32_t len) override;
+
+private:
+    uint32_t m_base;
+    uint32_t m_size;
+};
+
+// The Arduino Update class, which writes to the inactive OTA partition
+class UpdateSink : public DeltaSink
+{
+public:
+    bool begin(uint32_t size) override;
+    bool write(const uint8_t *data, uint32_t len) override;
+};
+#endif
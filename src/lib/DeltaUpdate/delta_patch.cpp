@@ -0,0 +1,406 @@
+#include "delta_patch.h"
+
+#include "logging.h"
+#include <string.h>
+
+static uint32_t getU32(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+bool DeltaPatcher::isDelta(const uint8_t *data, const uint32_t len)
+{
+    return len >= DELTA_MAGIC_LEN && memcmp(data, DELTA_MAGIC, DELTA_MAGIC_LEN) == 0;
+}
+
+const char *DeltaPatcher::statusText(const deltaStatus_e status)
+{
+    switch (status)
+    {
+    case DELTA_IN_PROGRESS:
+        return "Incomplete patch";
+    case DELTA_OK:
+        return "OK";
+    case DELTA_ERR_FORMAT:
+        return "Invalid patch file";
+    case DELTA_ERR_SOURCE:
+        return "Patch was made for different firmware than is running";
+    case DELTA_ERR_READ:
+        return "Failed to read the running firmware";
+    case DELTA_ERR_WRITE:
+        return "Failed to write the new firmware";
+    case DELTA_ERR_SIZE:
+        return "Patched firmware has the wrong size";
+    default:
+        return "Patched firmware failed verification";
+    }
+}
+
+deltaStatus_e DeltaPatcher::fail(const deltaStatus_e status)
+{
+    DBGLN("Delta update failed: %s", statusText(status));
+    m_status = status;
+    return m_status;
+}
+
+/**
+ * Accumulate a LEB128 varint into m_varint, returns true when the last byte has been received
+ */
+bool DeltaPatcher::readVarint(const uint8_t c)
+{
+    m_varint |= (uint32_t)(c & 0x7F) << m_varintShift;
+    m_varintShift += 7;
+    if (c & 0x80)
+    {
+        if (m_varintShift > 28)
+        {
+            fail(DELTA_ERR_FORMAT);
+        }
+        return false;
+    }
+    m_varintShift = 0;
+    return true;
+}
+
+bool DeltaPatcher::parseHeader()
+{
+    if (!isDelta(m_header, m_headerLen))
+    {
+        fail(DELTA_ERR_FORMAT);
+        return false;
+    }
+
+    const uint8_t *p = m_header + DELTA_MAGIC_LEN;
+    m_sourceSize = getU32(p);
+    p += 4 + DELTA_MD5_LEN;
+    m_targetSize = getU32(p);
+    p += 4;
+    memcpy(m_targetMD5, p, DELTA_MD5_LEN);
+
+    if (!verifySource())
+    {
+        return false;
+    }
+
+    if (!m_sink.begin(m_targetSize))
+    {
+        fail(DELTA_ERR_WRITE);
+        return false;
+    }
+    m_md5.begin();
+    return true;
+}
+
+bool DeltaPatcher::verifySource()
+{
+    if (m_sourceSize > m_source.size())
+    {
+        fail(DELTA_ERR_SOURCE);
+        return false;
+    }
+
+    // m_srcBuf is free until the first op
+    DeltaMD5 md5;
+    md5.begin();
+    for (uint32_t pos = 0; pos < m_sourceSize; pos += DELTA_BUFFER_SIZE)
+    {
+        const uint32_t len = (m_sourceSize - pos) < DELTA_BUFFER_SIZE ? (m_sourceSize - pos) : DELTA_BUFFER_SIZE;
+        if (!m_source.read(pos, m_srcBuf, len))
+        {
+            fail(DELTA_ERR_READ);
+            return false;
+        }
+        md5.add(m_srcBuf, len);
+    }
+    md5.calculate();
+
+    uint8_t digest[DELTA_MD5_LEN];
+    md5.getBytes(digest);
+    if (memcmp(digest, m_header + DELTA_MAGIC_LEN + 4, DELTA_MD5_LEN) != 0)
+    {
+        fail(DELTA_ERR_SOURCE);
+        return false;
+    }
+    return true;
+}
+
+bool DeltaPatcher::flush()
+{
+    if (m_outLen == 0)
+    {
+        return true;
+    }
+    m_md5.add(m_outBuf, m_outLen);
+    if (!m_sink.write(m_outBuf, m_outLen))
+    {
+        fail(DELTA_ERR_WRITE);
+        return false;
+    }
+    m_outLen = 0;
+    return true;
+}
+
+bool DeltaPatcher::output(const uint8_t *data, uint32_t len)
+{
+    if (m_written + len > m_targetSize)
+    {
+        fail(DELTA_ERR_SIZE);
+        return false;
+    }
+    m_written += len;
+
+    while (len > 0)
+    {
+        const uint32_t space = DELTA_BUFFER_SIZE - m_outLen;
+        const uint32_t n = space < len ? space : len;
+        memcpy(&m_outBuf[m_outLen], data, n);
+        m_outLen += n;
+        data += n;
+        len -= n;
+        if (m_outLen == DELTA_BUFFER_SIZE && !flush())
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool DeltaPatcher::sourceAvailable(const uint32_t len)
+{
+    if (m_srcPos > m_sourceSize || len > m_sourceSize - m_srcPos)
+    {
+        fail(DELTA_ERR_FORMAT);
+        return false;
+    }
+    return true;
+}
+
+bool DeltaPatcher::copySource(uint32_t len)
+{
+    while (len > 0)
+    {
+        const uint32_t n = len < DELTA_BUFFER_SIZE ? len : DELTA_BUFFER_SIZE;
+        if (!sourceAvailable(n))
+        {
+            return false;
+        }
+        if (!m_source.read(m_srcPos, m_srcBuf, n))
+        {
+            fail(DELTA_ERR_READ);
+            return false;
+        }
+        if (!output(m_srcBuf, n))
+        {
+            return false;
+        }
+        m_srcPos += n;
+        len -= n;
+    }
+    return true;
+}
+
+bool DeltaPatcher::finish()
+{
+    if (!flush())
+    {
+        return false;
+    }
+    if (m_written != m_targetSize)
+    {
+        fail(DELTA_ERR_SIZE);
+        return false;
+    }
+
+    m_md5.calculate();
+    uint8_t digest[DELTA_MD5_LEN];
+    m_md5.getBytes(digest);
+    if (memcmp(digest, m_targetMD5, DELTA_MD5_LEN) != 0)
+    {
+        fail(DELTA_ERR_HASH);
+        return false;
+    }
+
+    m_status = DELTA_OK;
+    return true;
+}
+
+deltaStatus_e DeltaPatcher::write(const uint8_t *data, uint32_t len)
+{
+    while (len > 0 && m_status == DELTA_IN_PROGRESS)
+    {
+        switch (m_state)
+        {
+        case ST_HEADER:
+        {
+            const uint32_t missing = DELTA_HEADER_LEN - m_headerLen;
+            const uint32_t n = missing < len ? missing : len;
+            memcpy(&m_header[m_headerLen], data, n);
+            m_headerLen += n;
+            data += n;
+            len -= n;
+            if (m_headerLen == DELTA_HEADER_LEN && parseHeader())
+            {
+                m_state = ST_OP;
+            }
+            break;
+        }
+
+        case ST_OP:
+            m_varint = 0;
+            m_varintShift = 0;
+            switch (*data)
+            {
+            case 'A':
+                m_state = ST_ADD_OFFSET;
+                break;
+            case 'I':
+                m_state = ST_INSERT_LENGTH;
+                break;
+            case 'E':
+                m_state = ST_DONE;
+                finish();
+                break;
+            default:
+                fail(DELTA_ERR_FORMAT);
+                break;
+            }
+            data++;
+            len--;
+            break;
+
+        case ST_ADD_OFFSET:
+            if (readVarint(*data))
+            {
+                // zigzag decode, relative to the end of the previous 'A' op
+                const int32_t offset = (int32_t)(m_varint >> 1) ^ -(int32_t)(m_varint & 1);
+                m_srcPos += offset;
+                m_varint = 0;
+                m_state = ST_ADD_LENGTH;
+            }
+            data++;
+            len--;
+            break;
+
+        case ST_ADD_LENGTH:
+            if (readVarint(*data))
+            {
+                m_opRemaining = m_varint;
+                m_varint = 0;
+                m_state = m_opRemaining ? ST_ADD_SKIP : ST_OP;
+            }
+            data++;
+            len--;
+            break;
+
+        case ST_ADD_SKIP:
+            if (readVarint(*data))
+            {
+                if (m_varint > m_opRemaining)
+                {
+                    fail(DELTA_ERR_FORMAT);
+                    break;
+                }
+                m_opRemaining -= m_varint;
+                if (!copySource(m_varint))
+                {
+                    break;
+                }
+                m_varint = 0;
+                m_state = ST_ADD_COUNT;
+            }
+            data++;
+            len--;
+            break;
+
+        case ST_ADD_COUNT:
+            if (readVarint(*data))
+            {
+                if (m_varint > m_opRemaining)
+                {
+                    fail(DELTA_ERR_FORMAT);
+                    break;
+                }
+                m_runRemaining = m_varint;
+                m_opRemaining -= m_varint;
+                m_varint = 0;
+                if (m_runRemaining)
+                {
+                    m_state = ST_ADD_DIFF;
+                }
+                else
+                {
+                    m_state = m_opRemaining ? ST_ADD_SKIP : ST_OP;
+                }
+            }
+            data++;
+            len--;
+            break;
+
+        case ST_ADD_DIFF:
+        {
+            uint32_t n = m_runRemaining < len ? m_runRemaining : len;
+            n = n < DELTA_BUFFER_SIZE ? n : DELTA_BUFFER_SIZE;
+            if (!sourceAvailable(n))
+            {
+                break;
+            }
+            if (!m_source.read(m_srcPos, m_srcBuf, n))
+            {
+                fail(DELTA_ERR_READ);
+                break;
+            }
+            for (uint32_t i = 0; i < n; i++)
+            {
+                m_srcBuf[i] += data[i];
+            }
+            if (!output(m_srcBuf, n))
+            {
+                break;
+            }
+            m_srcPos += n;
+            m_runRemaining -= n;
+            data += n;
+            len -= n;
+            if (m_runRemaining == 0)
+            {
+                m_state = m_opRemaining ? ST_ADD_SKIP : ST_OP;
+            }
+            break;
+        }
+
+        case ST_INSERT_LENGTH:
+            if (readVarint(*data))
+            {
+                m_runRemaining = m_varint;
+                m_varint = 0;
+                m_state = m_runRemaining ? ST_INSERT_DATA : ST_OP;
+            }
+            data++;
+            len--;
+            break;
+
+        case ST_INSERT_DATA:
+        {
+            const uint32_t n = m_runRemaining < len ? m_runRemaining : len;
+            if (!output(data, n))
+            {
+                break;
+            }
+            m_runRemaining -= n;
+            data += n;
+            len -= n;
+            if (m_runRemaining == 0)
+            {
+                m_state = ST_OP;
+            }
+            break;
+        }
+
+        case ST_DONE:
+            // padding after the end of the patch is ignored
+            len = 0;
+            break;
+        }
+    }
+    return m_status;
+}
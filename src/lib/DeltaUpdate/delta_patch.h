@@ -0,0 +1,131 @@
+#pragma once
+
+#include "targets.h"
+#include "delta_md5.h"
+
+/*
+ * Streaming applier for binary delta firmware updates (generated by python/delta_patch.py).
+ *
+ * Patch layout, all integers little endian:
+ *   "ELRSDLT1"
+ *   u32 source size, u8[16] source MD5
+ *   u32 target size, u8[16] target MD5
+ *   ops...
+ *
+ * Ops, varints are LEB128 and signed varints are zigzag encoded:
+ *   'A' svarint source offset relative to the end of the previous 'A' op, varint length,
+ *       then (varint skip, varint count, count bytes) groups until length bytes are covered.
+ *       Skipped bytes are copied from the source, the others are source + byte (mod 256).
+ *   'I' varint length, length bytes copied to the output.
+ *   'E' end of patch.
+ *
+ * The patch can be fed in chunks of any size. RAM use is bounded by the two small staging
+ * buffers, the source is read and the output is written as the patch is processed.
+ * The output MD5 is checked against the header when 'E' is reached, the caller must only make
+ * the new image bootable if write() returns DELTA_OK.
+ */
+
+#define DELTA_MAGIC "ELRSDLT1"
+#define DELTA_MAGIC_LEN 8
+#define DELTA_HEADER_LEN (DELTA_MAGIC_LEN + 4 + DELTA_MD5_LEN + 4 + DELTA_MD5_LEN)
+
+#define DELTA_BUFFER_SIZE 256
+
+// The image the patch was made against, normally the running firmware
+class DeltaSource
+{
+public:
+    virtual ~DeltaSource() = default;
+    virtual uint32_t size() = 0;
+    virtual bool read(uint32_t offset, uint8_t *data, uint32_t len) = 0;
+};
+
+// Where the patched image is written, normally the inactive OTA partition
+class DeltaSink
+{
+public:
+    virtual ~DeltaSink() = default;
+    virtual bool begin(uint32_t size) = 0;
+    virtual bool write(const uint8_t *data, uint32_t len) = 0;
+};
+
+typedef enum : uint8_t {
+    DELTA_IN_PROGRESS,
+    DELTA_OK,
+    DELTA_ERR_FORMAT,           // bad magic or malformed op
+    DELTA_ERR_SOURCE,           // patch was not made against this firmware
+    DELTA_ERR_READ,
+    DELTA_ERR_WRITE,
+    DELTA_ERR_SIZE,             // output does not match the target size
+    DELTA_ERR_HASH              // output does not match the target MD5
+} deltaStatus_e;
+
+class DeltaPatcher
+{
+public:
+    DeltaPatcher(DeltaSource &source, DeltaSink &sink) : m_source(source), m_sink(sink) {}
+
+    static bool isDelta(const uint8_t *data, uint32_t len);
+    static const char *statusText(deltaStatus_e status);
+
+    /**
+     * @brief Process the next chunk of the patch
+     * @return DELTA_IN_PROGRESS until the end of the patch, then DELTA_OK or an error.
+     * Once an error is returned all further data is ignored.
+     */
+    deltaStatus_e write(const uint8_t *data, uint32_t len);
+
+    deltaStatus_e status() const { return m_status; }
+    uint32_t targetSize() const { return m_targetSize; }
+    uint32_t written() const { return m_written; }
+
+private:
+    enum state_e : uint8_t {
+        ST_HEADER,
+        ST_OP,
+        ST_ADD_OFFSET,
+        ST_ADD_LENGTH,
+        ST_ADD_SKIP,
+        ST_ADD_COUNT,
+        ST_ADD_DIFF,
+        ST_INSERT_LENGTH,
+        ST_INSERT_DATA,
+        ST_DONE
+    };
+
+    DeltaSource &m_source;
+    DeltaSink &m_sink;
+    DeltaMD5 m_md5;
+
+    deltaStatus_e m_status = DELTA_IN_PROGRESS;
+    state_e m_state = ST_HEADER;
+
+    uint8_t m_header[DELTA_HEADER_LEN];
+    uint8_t m_headerLen = 0;
+    uint32_t m_sourceSize = 0;
+    uint32_t m_targetSize = 0;
+    uint8_t m_targetMD5[DELTA_MD5_LEN];
+
+    // varint being decoded
+    uint32_t m_varint = 0;
+    uint8_t m_varintShift = 0;
+
+    uint32_t m_srcPos = 0;      // next source byte used by an 'A' op
+    uint32_t m_opRemaining = 0; // bytes of the current op still to be output
+    uint32_t m_runRemaining = 0;// bytes of the current diff or insert run
+    uint32_t m_written = 0;
+
+    uint8_t m_srcBuf[DELTA_BUFFER_SIZE];
+    uint8_t m_outBuf[DELTA_BUFFER_SIZE];
+    uint16_t m_outLen = 0;
+
+    deltaStatus_e fail(deltaStatus_e status);
+    bool readVarint(uint8_t c);
+    bool parseHeader();
+    bool verifySource();
+    bool output(const uint8_t *data, uint32_t len);
+    bool flush();
+    bool sourceAvailable(uint32_t len);
+    bool copySource(uint32_t len);
+    bool finish();
+};
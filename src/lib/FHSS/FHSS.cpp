@@ -254,14 +254,8 @@ uint32_t FHSSHopNextSynced(uint8_t radio_id)
     if (radio_id == FHSS_RADIO_1)
     {
         FHSSusePrimaryFreqBand = true;
-#if defined(RADIO_SX127X)
-        return FHSSconfig->freq_start + 
-               (freq_spread * current_seq_idx / FREQ_SPREAD_SCALE) - 
-               FreqCorrection;
-#else
         return FHSSconfig->freq_start + 
                (freq_spread * current_seq_idx / FREQ_SPREAD_SCALE);
-#endif
     }
     else if (radio_id == FHSS_RADIO_2)
     {
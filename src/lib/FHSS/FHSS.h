@@ -52,7 +52,8 @@ extern volatile uint8_t FHSSptrSynced;
 }
 #endif
 
-// Keep compatibility for all radios — required by HandleFreqCorr() in rx_main.cpp
+// Each radio's own frequency correction, set by HandleFreqCorr() in rx_main.cpp. The frequencies
+// here are the TX's, the RX takes the radio's correction off when it tunes the radio.
 extern int32_t FreqCorrection;
 extern int32_t FreqCorrection_2;
 
@@ -147,12 +148,7 @@ static inline uint32_t FHSSgetInitialFreq()
 {
     if (FHSSusePrimaryFreqBand)
     {
-#if defined(RADIO_SX127X)
-        return FHSSconfig->freq_start + (sync_channel * freq_spread / FREQ_SPREAD_SCALE) - FreqCorrection;
-#else
-        /* LR1121/SX128X: FreqCorrection not used */
         return FHSSconfig->freq_start + (sync_channel * freq_spread / FREQ_SPREAD_SCALE);
-#endif
     }
     else
     {
@@ -166,6 +162,23 @@ static inline uint8_t FHSSgetCurrIndex()
     return FHSSptr;
 }
 
+// Channel the sequence is on
+static inline uint8_t FHSSgetCurrChannel()
+{
+    return FHSSusePrimaryFreqBand ? FHSSsequence[FHSSptr] : FHSSsequence_DualBand[FHSSptr];
+}
+
+// Channel the other radio is on in Gemini mode, the same as FHSSgetGeminiFreq()
+static inline uint8_t FHSSgetCurrGeminiChannel()
+{
+    if (FHSSuseDualBand)
+    {
+        return FHSSsequence_DualBand[FHSSptr];
+    }
+    const uint32_t numfhss = FHSSgetChannelCount();
+    return (FHSSgetCurrChannel() + (numfhss / 2)) % numfhss;
+}
+
 // Is the current frequency the sync frequency
 static inline uint8_t FHSSonSyncChannel()
 {
@@ -195,11 +208,7 @@ static inline uint32_t FHSSgetNextFreq()
 
     if (FHSSusePrimaryFreqBand)
     {
-#if defined(RADIO_SX127X)
-        return FHSSconfig->freq_start + (freq_spread * FHSSsequence[FHSSptr] / FREQ_SPREAD_SCALE) - FreqCorrection;
-#else
         return FHSSconfig->freq_start + (freq_spread * FHSSsequence[FHSSptr] / FREQ_SPREAD_SCALE);
-#endif
     }
     else
     {
@@ -228,11 +237,7 @@ static inline uint32_t FHSSGeminiFreq(uint8_t FHSSsequenceIdx)
 
     if (FHSSusePrimaryFreqBand)
     {
-#if defined(RADIO_SX127X)
-        freq = FHSSconfig->freq_start + (freq_spread * offSetIdx / FREQ_SPREAD_SCALE) - FreqCorrection_2;
-#else
         freq = FHSSconfig->freq_start + (freq_spread * offSetIdx / FREQ_SPREAD_SCALE);
-#endif
     }
     else
     {
@@ -262,6 +267,23 @@ static inline uint32_t FHSSgetGeminiFreq()
     }
 }
 
+// Channel of FHSSgetInitialFreq(), the sync channel
+static inline uint8_t FHSSgetInitialChannel()
+{
+    return FHSSusePrimaryFreqBand ? sync_channel : sync_channel_DualBand;
+}
+
+// Channel of FHSSgetInitialGeminiFreq()
+static inline uint8_t FHSSgetInitialGeminiChannel()
+{
+    if (FHSSuseDualBand)
+    {
+        return sync_channel_DualBand;
+    }
+    const uint32_t numfhss = FHSSgetChannelCount();
+    return (FHSSgetInitialChannel() + (numfhss / 2)) % numfhss;
+}
+
 static inline uint32_t FHSSgetInitialGeminiFreq()
 {
     if (FHSSuseDualBand)
@@ -0,0 +1,220 @@
+#include "FirmwareScanner.h"
+
+#include <string.h>
+
+// Prefix of the target_name string in options.cpp
+static const uint8_t TARGET_MAGIC[] = {0xBE, 0xEF, 0xCA, 0xFE};
+static constexpr uint8_t TARGET_MAGIC_LEN = sizeof(TARGET_MAGIC);
+// KMP failure function of TARGET_MAGIC, length of the longest proper prefix that is also a suffix of TARGET_MAGIC[0..i]
+static const uint8_t TARGET_MAGIC_FAIL[TARGET_MAGIC_LEN] = {0, 0, 0, 0};
+
+static constexpr uint8_t ESP_IMAGE_MAGIC = 0xE9;
+static constexpr uint8_t GZIP_MAGIC = 0x1F;
+
+void FirmwareScanner::reset()
+{
+    m_pos = 0;
+    m_compressed = false;
+
+    m_magicMatched = 0;
+    m_capturing = false;
+    m_captureLen = 0;
+    m_captureOverflow = false;
+    m_targetName[0] = '\0';
+    m_targetMatched = false;
+
+    m_layoutState = LAYOUT_IMAGE_HEADER;
+    m_isEsp8266 = false;
+    m_segments = 0;
+    m_recordPos = 0;
+    m_recordLen = 0;
+    m_firmwareEnd = FIRMWARE_OFFSET_UNKNOWN;
+
+    m_hasOptions = false;
+    m_hasHardware = false;
+    memset(m_productName, 0, sizeof(m_productName));
+    memset(m_deviceName, 0, sizeof(m_deviceName));
+}
+
+void FirmwareScanner::scan(const uint8_t *data, uint32_t len)
+{
+    if (len == 0)
+    {
+        return;
+    }
+    if (m_pos == 0 && data[0] == GZIP_MAGIC)
+    {
+        m_compressed = true;
+    }
+    if (!m_compressed)
+    {
+        scanLayout(data, len);
+        scanTrailer(data, len);
+        scanSignature(data, len);
+    }
+    m_pos += len;
+}
+
+void FirmwareScanner::captureName(const uint8_t c)
+{
+    if (c == '\0')
+    {
+        m_capturing = false;
+        if (m_captureOverflow)
+        {
+            return;
+        }
+        m_capture[m_captureLen] = '\0';
+        if (strcmp(m_capture, m_expected) == 0)
+        {
+            m_targetMatched = true;
+        }
+        if (m_targetName[0] == '\0')
+        {
+            memcpy(m_targetName, m_capture, m_captureLen + 1);
+        }
+    }
+    else if (c < ' ' || c > '~')
+    {
+        // not a name, just the magic bytes by chance
+        m_capturing = false;
+    }
+    else if (m_captureLen < FIRMWARE_TARGET_NAME_MAX)
+    {
+        m_capture[m_captureLen++] = c;
+    }
+    else
+    {
+        m_captureOverflow = true;
+    }
+}
+
+void FirmwareScanner::scanSignature(const uint8_t *data, uint32_t len)
+{
+    const uint8_t *end = data + len;
+    while (data < end)
+    {
+        if (m_magicMatched == 0 && !m_capturing)
+        {
+            // nothing in progress, skip straight to the next possible start of the magic
+            data = (const uint8_t *)memchr(data, TARGET_MAGIC[0], end - data);
+            if (data == nullptr)
+            {
+                return;
+            }
+        }
+
+        const uint8_t c = *data++;
+        if (m_capturing)
+        {
+            captureName(c);
+        }
+
+        while (m_magicMatched > 0 && c != TARGET_MAGIC[m_magicMatched])
+        {
+            m_magicMatched = TARGET_MAGIC_FAIL[m_magicMatched - 1];
+        }
+        if (c == TARGET_MAGIC[m_magicMatched])
+        {
+            m_magicMatched++;
+        }
+        if (m_magicMatched == TARGET_MAGIC_LEN)
+        {
+            m_magicMatched = TARGET_MAGIC_FAIL[TARGET_MAGIC_LEN - 1];
+            m_capturing = true;
+            m_captureLen = 0;
+            m_captureOverflow = false;
+        }
+    }
+}
+
+/**
+ * Collect the 8 byte records at m_recordPos, the same walk as findFirmwareEnd() in UnifiedConfiguration.py
+ */
+void FirmwareScanner::scanLayout(const uint8_t *data, uint32_t len)
+{
+    while (m_layoutState != LAYOUT_DONE)
+    {
+        const uint32_t next = m_recordPos + m_recordLen;
+        if (next >= m_pos + len)
+        {
+            return;
+        }
+        const uint32_t offset = next - m_pos;
+        const uint32_t n = (uint32_t)(sizeof(m_record) - m_recordLen) < len - offset ? (uint32_t)(sizeof(m_record) - m_recordLen) : len - offset;
+        memcpy(&m_record[m_recordLen], &data[offset], n);
+        m_recordLen += n;
+        if (m_recordLen == sizeof(m_record))
+        {
+            m_recordLen = 0;
+            parseRecord();
+        }
+    }
+}
+
+void FirmwareScanner::parseRecord()
+{
+    if (m_layoutState == LAYOUT_IMAGE_HEADER)
+    {
+        if (m_record[0] != ESP_IMAGE_MAGIC)
+        {
+            m_layoutState = LAYOUT_DONE;
+            return;
+        }
+        m_segments = m_record[1];
+        if (m_recordPos == 0 && m_segments == 2)
+        {
+            // ESP8266 images start with the 2 segment boot stub, the application image is at 0x1000
+            m_isEsp8266 = true;
+            m_recordPos = 0x1000;
+            return;
+        }
+        // the ESP32 image header is followed by a 16 byte extended header
+        m_recordPos = m_isEsp8266 ? m_recordPos + sizeof(m_record) : 24;
+        m_layoutState = LAYOUT_SEGMENT;
+    }
+    else
+    {
+        const uint32_t size = m_record[4] | (m_record[5] << 8) | (m_record[6] << 16) | ((uint32_t)m_record[7] << 24);
+        m_recordPos += sizeof(m_record) + size;
+        m_segments--;
+    }
+
+    if (m_segments == 0)
+    {
+        // checksum byte padded to 16, then the SHA256 on ESP32
+        m_firmwareEnd = ((m_recordPos + 16) & ~15) + (m_isEsp8266 ? 0 : 32);
+        m_layoutState = LAYOUT_DONE;
+    }
+}
+
+static void copyRegion(char *dst, uint32_t regionStart, uint32_t regionLen, const uint8_t *data, uint32_t dataStart, uint32_t len)
+{
+    const uint32_t start = regionStart > dataStart ? regionStart : dataStart;
+    const uint32_t end = (regionStart + regionLen) < (dataStart + len) ? (regionStart + regionLen) : (dataStart + len);
+    if (start < end)
+    {
+        memcpy(&dst[start - regionStart], &data[start - dataStart], end - start);
+    }
+}
+
+void FirmwareScanner::scanTrailer(const uint8_t *data, uint32_t len)
+{
+    if (m_firmwareEnd == FIRMWARE_OFFSET_UNKNOWN || m_pos > hardwareOffset())
+    {
+        return;
+    }
+    copyRegion(m_productName, m_firmwareEnd, ELRSOPTS_PRODUCTNAME_SIZE, data, m_pos, len);
+    copyRegion(m_deviceName, m_firmwareEnd + ELRSOPTS_PRODUCTNAME_SIZE, ELRSOPTS_DEVICENAME_SIZE, data, m_pos, len);
+
+    const uint32_t options = optionsOffset();
+    if (options >= m_pos && options < m_pos + len)
+    {
+        m_hasOptions = data[options - m_pos] == '{';
+    }
+    const uint32_t hardware = hardwareOffset();
+    if (hardware >= m_pos && hardware < m_pos + len)
+    {
+        m_hasHardware = data[hardware - m_pos] == '{';
+    }
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "targets.h"
+#include "options.h"
+
+/*
+ * Single pass scanner for firmware images as they are uploaded.
+ *
+ * Finds the target name strings ("\xBE\xEF\xCA\xFE" NAME "\0", see options.cpp) using KMP so
+ * matches are found across chunk boundaries and inside overlapping prefixes, and walks the ESP
+ * image header segments to locate the end of the firmware. The configurator appends the product
+ * name, device name, options JSON and hardware JSON there (see UnifiedConfiguration.py).
+ *
+ * All state is in fixed size members, no heap is used.
+ */
+
+#define FIRMWARE_TARGET_NAME_MAX 64
+#define FIRMWARE_OFFSET_UNKNOWN 0xFFFFFFFF
+
+class FirmwareScanner
+{
+public:
+    /**
+     * @param expectedTarget target name (without the magic prefix) to look for
+     */
+    explicit FirmwareScanner(const char *expectedTarget) : m_expected(expectedTarget) { reset(); }
+
+    void reset();
+    void scan(const uint8_t *data, uint32_t len);
+
+    uint32_t size() const { return m_pos; }
+    // gzip compressed ESP8266 image, the contents cannot be scanned
+    bool isCompressed() const { return m_compressed; }
+    // the expected target name was found in the image
+    bool targetMatched() const { return m_targetMatched; }
+    // first target name found in the image, empty if none
+    const char *targetName() const { return m_targetName; }
+
+    // Offsets in the image, FIRMWARE_OFFSET_UNKNOWN until the image header has been parsed
+    uint32_t firmwareEnd() const { return m_firmwareEnd; }
+    uint32_t optionsOffset() const { return offsetFromEnd(ELRSOPTS_PRODUCTNAME_SIZE + ELRSOPTS_DEVICENAME_SIZE); }
+    uint32_t hardwareOffset() const { return offsetFromEnd(ELRSOPTS_PRODUCTNAME_SIZE + ELRSOPTS_DEVICENAME_SIZE + ELRSOPTS_OPTIONS_SIZE); }
+    // options/hardware JSON is present (the configurator fills missing blocks with zeros)
+    bool hasOptions() const { return m_hasOptions; }
+    bool hasHardware() const { return m_hasHardware; }
+
+    const char *productName() const { return m_productName; }
+    const char *deviceName() const { return m_deviceName; }
+
+private:
+    const char *m_expected;
+    uint32_t m_pos;
+    bool m_compressed;
+
+    // target name signature
+    uint8_t m_magicMatched;
+    bool m_capturing;
+    uint8_t m_captureLen;
+    bool m_captureOverflow;
+    char m_capture[FIRMWARE_TARGET_NAME_MAX + 1];
+    char m_targetName[FIRMWARE_TARGET_NAME_MAX + 1];
+    bool m_targetMatched;
+
+    // image header walk, one 8 byte record (image header or segment header) at a time
+    enum : uint8_t {
+        LAYOUT_IMAGE_HEADER,
+        LAYOUT_SEGMENT,
+        LAYOUT_DONE
+    } m_layoutState;
+    bool m_isEsp8266;
+    uint8_t m_segments;
+    uint32_t m_recordPos;
+    uint8_t m_record[8];
+    uint8_t m_recordLen;
+    uint32_t m_firmwareEnd;
+
+    bool m_hasOptions;
+    bool m_hasHardware;
+    char m_productName[ELRSOPTS_PRODUCTNAME_SIZE + 1];
+    char m_deviceName[ELRSOPTS_DEVICENAME_SIZE + 1];
+
+    uint32_t offsetFromEnd(uint32_t offset) const
+    {
+        return m_firmwareEnd == FIRMWARE_OFFSET_UNKNOWN ? FIRMWARE_OFFSET_UNKNOWN : m_firmwareEnd + offset;
+    }
+    void scanSignature(const uint8_t *data, uint32_t len);
+    void captureName(uint8_t c);
+    void scanLayout(const uint8_t *data, uint32_t len);
+    void parseRecord();
+    void scanTrailer(const uint8_t *data, uint32_t len);
+};
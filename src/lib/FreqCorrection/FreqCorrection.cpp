@@ -0,0 +1,42 @@
+#include "FreqCorrection.h"
+
+#define CORRECTION_Q 8
+
+const freqCorrectionConfig_t FreqCorrectionDefaultConfig = {
+    64,     // gainQ8, a quarter of the error, the SX127x FEI is noisy on weak packets
+    8,      // maxStep, about 500Hz on the SX127x
+};
+
+FreqCorrector::FreqCorrector(int32_t limit, const freqCorrectionConfig_t &config)
+    : m_config(config), m_limitQ8(limit << CORRECTION_Q), m_correctionQ8(0)
+{
+}
+
+int32_t ICACHE_RAM_ATTR FreqCorrector::update(int32_t error)
+{
+    const int32_t maxStepQ8 = (int32_t)m_config.maxStep << CORRECTION_Q;
+    int32_t step = error * m_config.gainQ8;
+    if (step > maxStepQ8)
+        step = maxStepQ8;
+    else if (step < -maxStepQ8)
+        step = -maxStepQ8;
+
+    m_correctionQ8 += step;
+    if (m_correctionQ8 > m_limitQ8)
+        m_correctionQ8 = m_limitQ8;
+    else if (m_correctionQ8 < -m_limitQ8)
+        m_correctionQ8 = -m_limitQ8;
+
+    return correction();
+}
+
+int32_t ICACHE_RAM_ATTR FreqCorrector::correction() const
+{
+    // Round to nearest
+    return (m_correctionQ8 + (1 << (CORRECTION_Q - 1))) >> CORRECTION_Q;
+}
+
+bool FreqCorrector::atLimit() const
+{
+    return m_correctionQ8 == m_limitQ8 || m_correctionQ8 == -m_limitQ8;
+}
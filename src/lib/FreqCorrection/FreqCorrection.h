@@ -0,0 +1,47 @@
+#pragma once
+
+#include "targets.h"
+#include <stdint.h>
+
+/*
+ * Tracks the frequency offset of one radio's crystal against the TX's.
+ *
+ * Each packet received the radio's frequency error is given in FREQ_STEP units, with the sign
+ * such that adding it to the correction moves the radio toward the TX. A part of the error, the
+ * gain, is added to the correction, but never more than maxStep on one packet so a bad estimate
+ * from a weak packet can not throw it far. The correction is kept in 1/256 FREQ_STEP so the small
+ * gains still move it, and held within +-limit.
+ *
+ * A receiver with two radios has one of these for each, the crystals are not the same and do not
+ * drift the same with temperature.
+ *
+ * Chips that only give the direction of the error give +-1 and the correction walks a fraction
+ * of a step per packet toward the TX.
+ *
+ * It runs in the RX ISR so it is all integer. There is no hardware access.
+ */
+
+typedef struct {
+    uint16_t gainQ8;    // fraction of the error added per packet, /256
+    uint16_t maxStep;   // most the correction moves on one packet, FREQ_STEP units
+} freqCorrectionConfig_t;
+
+extern const freqCorrectionConfig_t FreqCorrectionDefaultConfig;
+
+class FreqCorrector
+{
+public:
+    explicit FreqCorrector(int32_t limit, const freqCorrectionConfig_t &config = FreqCorrectionDefaultConfig);
+
+    void reset() { m_correctionQ8 = 0; }
+    // One packet's frequency error, returns the new correction
+    int32_t update(int32_t error);
+    // Correction to take off the radio's frequency, FREQ_STEP units
+    int32_t correction() const;
+    bool atLimit() const;
+
+private:
+    freqCorrectionConfig_t m_config;
+    int32_t m_limitQ8;
+    int32_t m_correctionQ8;
+};
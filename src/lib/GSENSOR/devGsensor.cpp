@@ -1,3 +1,4 @@
+#if !defined(UNIT_TEST)
 #include "targets.h"
 #include "common.h"
 
@@ -12,19 +13,33 @@
 
 Gsensor gsensor;
 
-static int system_quiet_state = GSENSOR_SYSTEM_STATE_MOVING;
-static int system_quiet_pre_state = GSENSOR_SYSTEM_STATE_MOVING;
-
 #define GSENSOR_DURATION    10
-#define GSENSOR_SYSTEM_IDLE_INTERVAL 1000U
 
 #define MULTIPLE_BUMP_INTERVAL 400U
 #define BUMP_COMMAND_IDLE_TIME 10000U
 
+static void motionEvent(Motion_Event_t event)
+{
+    //When system is idle, set power to minimum
+    if (config.GetMotionMode() != 1)
+    {
+        return;
+    }
+    if (event == MOTION_EVENT_STILL && !handset->IsArmed())
+    {
+        POWERMGNT::setPower(MinPower);
+    }
+    if (event == MOTION_EVENT_MOVING && POWERMGNT::currPower() < (PowerLevels_e)config.GetPower())
+    {
+        POWERMGNT::setPower((PowerLevels_e)config.GetPower());
+    }
+}
+
 static bool initialize()
 {
     if (OPT_HAS_GSENSOR)
     {
+        gsensor.setEventCallback(motionEvent);
         return gsensor.init();
     }
     return false;
@@ -37,27 +52,12 @@ static int start()
 
 static int timeout()
 {
-    static unsigned long lastIdleCheckMs = 0;
+    static unsigned long lastSampleMs = 0;
     unsigned long now = millis();
-    if (now - lastIdleCheckMs > GSENSOR_SYSTEM_IDLE_INTERVAL)
+    if (now - lastSampleMs >= GSENSOR_SAMPLE_INTERVAL)
     {
         gsensor.handle();
-
-        system_quiet_state = gsensor.getSystemState();
-        //When system is idle, set power to minimum
-        if(config.GetMotionMode() == 1)
-        {
-            if((system_quiet_state == GSENSOR_SYSTEM_STATE_QUIET) && (system_quiet_pre_state == GSENSOR_SYSTEM_STATE_MOVING) && !handset->IsArmed())
-            {
-                POWERMGNT::setPower(MinPower);
-            }
-            if((system_quiet_state == GSENSOR_SYSTEM_STATE_MOVING) && (system_quiet_pre_state == GSENSOR_SYSTEM_STATE_QUIET) && POWERMGNT::currPower() < (PowerLevels_e)config.GetPower())
-            {
-                POWERMGNT::setPower((PowerLevels_e)config.GetPower());
-            }
-        }
-        system_quiet_pre_state = system_quiet_state;
-        lastIdleCheckMs = now;
+        lastSampleMs = now;
     }
     return GSENSOR_DURATION;
 }
@@ -68,3 +68,4 @@ device_t Gsensor_device = {
     .event = NULL,
     .timeout = timeout
 };
+#endif
@@ -9,20 +9,6 @@ STK8xxx stk8xxx;
 
 int gensor_status = GSENSOR_STATUS_FAIL;
 
-#define DATA_SAMPLE_LENGTH  20
-#define QUIET_VARIANCE_THRESHOLD    0.0002f
-#define QUIET_AVERAGE_THRESHOLD     0.04f
-
-#define FLIPPED_ACTION_THRESHOLD  0.2f
-
-static float x_buffer[DATA_SAMPLE_LENGTH] = {0};
-static float y_buffer[DATA_SAMPLE_LENGTH] = {0};
-static float z_buffer[DATA_SAMPLE_LENGTH] = {0};
-static int sample_counter = 0;
-float x_average = 0;
-float y_average = 0;
-float z_average = 0;
-
 static bool interrupt = false;
 
 #ifdef HAS_SMART_FAN
@@ -65,35 +51,9 @@ bool Gsensor::init()
         }
     }
 
-    system_state = GSENSOR_SYSTEM_STATE_MOVING;
-    is_flipped = false;
     return true;
 }
 
-float get_data_average(float *data, int length)
-{
-    float average = 0;
-    for(int i=0;i<length;i++)
-    {
-        average += *(data+i);
-    }
-    average = average / length;
-    return average;
-}
-
-float get_data_variance(float average, float *data, int length)
-{
-    float variance = 0;
-    for(int i=0;i<length;i++)
-    {
-        float temp = *(data+i) - average;
-        temp = temp * temp;
-        variance += temp;
-    }
-    variance = variance / length;
-    return variance;
-}
-
 bool Gsensor::hasTriggered(unsigned long now)
 {
     static unsigned long lastTriggeredMs = 0;
@@ -129,53 +89,7 @@ void Gsensor::handle()
         }
     }
 #endif
-    if(z > FLIPPED_ACTION_THRESHOLD)
-    {
-        is_flipped = true;
-    }
-    else
-    {
-        is_flipped = false;
-    }
-    if(system_state == GSENSOR_SYSTEM_STATE_QUIET)
-    {
-        x = abs(x - x_average);
-        y = abs(y - y_average);
-        z = abs(z - z_average);
-        if((x > QUIET_AVERAGE_THRESHOLD) || (y > QUIET_AVERAGE_THRESHOLD) ||
-            (z > QUIET_AVERAGE_THRESHOLD))
-        {
-            system_state = GSENSOR_SYSTEM_STATE_MOVING;
-        }
-    }
-    else
-    {
-        x_buffer[sample_counter] = x;
-        y_buffer[sample_counter] = y;
-        z_buffer[sample_counter] = z;
-
-        if(sample_counter == DATA_SAMPLE_LENGTH -1)
-        {
-            sample_counter = 0;
-            x_average = get_data_average(x_buffer, DATA_SAMPLE_LENGTH);
-            y_average = get_data_average(y_buffer, DATA_SAMPLE_LENGTH);
-            z_average = get_data_average(z_buffer, DATA_SAMPLE_LENGTH);
-
-            float x_variance = get_data_variance(x_average, x_buffer, DATA_SAMPLE_LENGTH);
-            float y_variance = get_data_variance(y_average, y_buffer, DATA_SAMPLE_LENGTH);
-            float z_variance = get_data_variance(z_average, z_buffer, DATA_SAMPLE_LENGTH);
-
-            if((x_variance < QUIET_VARIANCE_THRESHOLD) && (y_variance < QUIET_VARIANCE_THRESHOLD) &&
-                (z_variance < QUIET_VARIANCE_THRESHOLD))
-            {
-                system_state = GSENSOR_SYSTEM_STATE_QUIET;
-            }
-        }
-        else
-        {
-            sample_counter++;
-        }
-    }
+    motion.update(x * 1000, y * 1000, z * 1000);
 }
 
 void Gsensor::getGSensorData(float *X_DataOut, float *Y_DataOut, float *Z_DataOut)
@@ -196,11 +110,16 @@ void Gsensor::getGSensorData(float *X_DataOut, float *Y_DataOut, float *Z_DataOu
 
 int Gsensor::getSystemState()
 {
-    return system_state;
+    return motion.isStill() ? GSENSOR_SYSTEM_STATE_QUIET : GSENSOR_SYSTEM_STATE_MOVING;
 }
 
 bool Gsensor::isFlipped()
 {
-    return is_flipped;
+    return motion.isFlipped();
+}
+
+void Gsensor::setEventCallback(MotionDetector::EventCallback callback)
+{
+    motion.setEventCallback(callback);
 }
 #endif
@@ -1,5 +1,10 @@
 #pragma once
 
+#include "motion_detector.h"
+
+#define GSENSOR_SAMPLE_INTERVAL 100U    // ms
+#define GSENSOR_STILL_WINDOW    200     // samples, 20s without movement before the system is quiet
+
 typedef enum
 {
     GSENSOR_STATUS_FAIL = 0,
@@ -16,13 +21,14 @@ typedef enum
 class Gsensor
 {
 private:
-    int system_state;
-    bool is_flipped;
+    MotionDetector motion;
 public:
+    Gsensor() : motion(GSENSOR_STILL_WINDOW) {}
     bool init();
     void handle();
     bool hasTriggered(unsigned long now);
     void getGSensorData(float *X_DataOut, float *Y_DataOut, float *Z_DataOut);
     int getSystemState();
     bool isFlipped();
+    void setEventCallback(MotionDetector::EventCallback callback);
 };
@@ -0,0 +1,111 @@
+#include "motion_detector.h"
+
+#include <stdlib.h>
+
+void MotionAxisStats::reset(uint8_t window)
+{
+    m_window = window;
+    m_count = 0;
+    m_head = 0;
+    m_sum = 0;
+    m_sumSq = 0;
+}
+
+void MotionAxisStats::add(int16_t mg)
+{
+    if (m_count == m_window)
+    {
+        // drop the oldest sample from the sums
+        const int16_t oldest = m_samples[m_head];
+        m_sum -= oldest;
+        m_sumSq -= (int32_t)oldest * oldest;
+    }
+    else
+    {
+        m_count++;
+    }
+    m_samples[m_head] = mg;
+    m_head = (m_head + 1) % m_window;
+    m_sum += mg;
+    m_sumSq += (int32_t)mg * mg;
+}
+
+int16_t MotionAxisStats::getMean() const
+{
+    if (m_count == 0)
+        return 0;
+    return m_sum / m_count;
+}
+
+uint32_t MotionAxisStats::getVariance() const
+{
+    if (m_count == 0)
+        return 0;
+    // (n * sum(x^2) - sum(x)^2) / n^2, exact in integers
+    const int64_t n = m_count;
+    return (n * (int64_t)m_sumSq - (int64_t)m_sum * m_sum) / (n * n);
+}
+
+void MotionDetector::setWindow(uint8_t window)
+{
+    if (window == 0)
+        window = 1;
+    m_window = window;
+    m_still = false;
+    m_flipped = false;
+    resetStats();
+}
+
+void MotionDetector::resetStats()
+{
+    for (uint8_t i = 0; i < 3; i++)
+        m_axis[i].reset(m_window);
+}
+
+void MotionDetector::notify(Motion_Event_t event)
+{
+    if (m_callback)
+        m_callback(event);
+}
+
+void MotionDetector::update(int16_t x, int16_t y, int16_t z)
+{
+    const bool flipped = z > MOTION_FLIPPED_THRESHOLD;
+    if (flipped != m_flipped)
+    {
+        m_flipped = flipped;
+        notify(flipped ? MOTION_EVENT_FLIPPED : MOTION_EVENT_UPRIGHT);
+    }
+
+    const int16_t sample[3] = {x, y, z};
+    if (m_still)
+    {
+        for (uint8_t i = 0; i < 3; i++)
+        {
+            if (abs(sample[i] - m_stillPosition[i]) > MOTION_MOVING_THRESHOLD)
+            {
+                // needs a full window of new samples before it can be still again
+                m_still = false;
+                resetStats();
+                notify(MOTION_EVENT_MOVING);
+                break;
+            }
+        }
+    }
+
+    for (uint8_t i = 0; i < 3; i++)
+        m_axis[i].add(sample[i]);
+
+    if (!m_still && m_axis[0].isFull())
+    {
+        for (uint8_t i = 0; i < 3; i++)
+        {
+            if (m_axis[i].getVariance() >= MOTION_STILL_VARIANCE)
+                return;
+        }
+        m_still = true;
+        for (uint8_t i = 0; i < 3; i++)
+            m_stillPosition[i] = m_axis[i].getMean();
+        notify(MOTION_EVENT_STILL);
+    }
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <stdint.h>
+
+#define MOTION_WINDOW_MAX           255
+#define MOTION_STILL_VARIANCE       200     // mg^2, all axes must be below for the whole window
+#define MOTION_MOVING_THRESHOLD     40      // mg, any axis away from the still position
+#define MOTION_FLIPPED_THRESHOLD    200     // mg on the z axis
+
+typedef enum
+{
+    MOTION_EVENT_STILL,     // no movement for a full window
+    MOTION_EVENT_MOVING,    // moved after being still
+    MOTION_EVENT_FLIPPED,
+    MOTION_EVENT_UPRIGHT
+} Motion_Event_t;
+
+/**
+ * Mean and variance of one axis over the last `window` samples.
+ * Keeps integer running sums so each sample is O(1) and nothing drifts.
+ */
+class MotionAxisStats
+{
+public:
+    void reset(uint8_t window);
+    void add(int16_t mg);
+
+    bool isFull() const { return m_count == m_window; }
+    int16_t getMean() const;
+    uint32_t getVariance() const;   // mg^2
+
+private:
+    int16_t m_samples[MOTION_WINDOW_MAX];
+    uint8_t m_window;
+    uint8_t m_count;
+    uint8_t m_head;
+    int32_t m_sum;
+    uint64_t m_sumSq;
+};
+
+/**
+ * Classifies accelerometer samples (mg) as still/moving and flipped/upright,
+ * calling the event callback on every change.
+ */
+class MotionDetector
+{
+public:
+    typedef void (*EventCallback)(Motion_Event_t event);
+
+    explicit MotionDetector(uint8_t window) : m_callback(nullptr) { setWindow(window); }
+
+    void setWindow(uint8_t window);
+    void setEventCallback(EventCallback callback) { m_callback = callback; }
+    void update(int16_t x, int16_t y, int16_t z);
+
+    bool isStill() const { return m_still; }
+    bool isFlipped() const { return m_flipped; }
+    const MotionAxisStats &getAxis(uint8_t axis) const { return m_axis[axis]; }
+
+private:
+    MotionAxisStats m_axis[3];
+    uint8_t m_window;
+    bool m_still;
+    bool m_flipped;
+    int16_t m_stillPosition[3];
+    EventCallback m_callback;
+
+    void resetStats();
+    void notify(Motion_Event_t event);
+};
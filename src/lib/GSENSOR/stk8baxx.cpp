@@ -1,3 +1,4 @@
+#if !defined(UNIT_TEST)
 #include "targets.h"
 
 #include <Wire.h>
@@ -261,3 +262,4 @@ void STK8xxx::STK8xxx_Getregister_data(float *X_DataOut, float *Y_DataOut, float
         *Z_DataOut = (float) z / STK8xxx_Get_Sensitivity();
 	}
 }
+#endif
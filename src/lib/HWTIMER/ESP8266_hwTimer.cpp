@@ -14,7 +14,6 @@ volatile int32_t hwTimer::FreqOffset = 0;
 // Internal implementation specific variables
 static uint32_t NextTimeout;
 
-#define HWTIMER_TICKS_PER_US 5
 #define HWTIMER_PRESCALER (clockCyclesPerMicrosecond() / HWTIMER_TICKS_PER_US)
 
 void hwTimer::init(void (*callbackTick)(), void (*callbackTock)())
@@ -58,9 +57,9 @@ void ICACHE_RAM_ATTR hwTimer::resume()
     }
 }
 
-void hwTimer::updateInterval(uint32_t newTimerInterval)
+void ICACHE_RAM_ATTR hwTimer::updateInterval(uint32_t newTimerInterval)
 {
-    // timer should not be running when updateInterval() is called
+    // timer should not be running when updateInterval() is called, or this is the timer callback
     HWtimerInterval = newTimerInterval * (HWTIMER_TICKS_PER_US * HWTIMER_PRESCALER);
 }
 
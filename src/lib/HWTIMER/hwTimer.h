@@ -9,6 +9,13 @@
 #define TimerIntervalUSDefault 20000
 #endif
 
+// Resolution of the timer, the frequency offset is in ticks
+#if defined(PLATFORM_ESP32) && !defined(TARGET_RX)
+#define HWTIMER_TICKS_PER_US 1
+#else
+#define HWTIMER_TICKS_PER_US 5
+#endif
+
 /**
  * @brief Hardware abstraction for the hardware timer to provide precise timing
  *
@@ -52,7 +59,8 @@ public:
     /**
      * @brief Change the interval between callbacks.
      * The time between tick and tock is half the provided interval.
-     * The timer should not be running when updateInterval() is called.
+     * The timer should not be running when updateInterval() is called, except from the timer
+     * callback for an announced rate switch, where the new interval starts with the next tick.
      *
      * @param time in microseconds for a full tick/tock.
      */
@@ -73,6 +81,11 @@ public:
      */
     static ICACHE_RAM_ATTR void inline decFreqOffset() { FreqOffset--; }
 
+    /**
+     * @brief Set the frequency offset, in ticks added to each half interval
+     */
+    static ICACHE_RAM_ATTR void inline setFreqOffset(int32_t offset) { FreqOffset = offset; }
+
     /**
      * @brief Get the frequency offset
      */
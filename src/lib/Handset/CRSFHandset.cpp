@@ -4,6 +4,7 @@
 #include "CRSFEndpoint.h"
 #include "CRSFRouter.h"
 #include "FIFO.h"
+#include "HandsetBaud.h"
 #include "helpers.h"
 #include "logging.h"
 
@@ -40,8 +41,11 @@ static constexpr int32_t OpenTXsyncOffsetSafeMargin = 1000; // 100us
 
 /// UART Handling ///
 static const int32_t TxToHandsetBauds[] = {400000, 115200, 5250000, 3750000, 1870000, 921600, 2250000};
-uint8_t CRSFHandset::UARTcurrentBaudIdx = 6;   // only used for baud-cycling, initialized to the end so the next one we try is the first in the list
 uint32_t CRSFHandset::UARTrequestedBaud = 5250000;
+#if !defined(PLATFORM_ESP32)
+// Only used without the ESP32's hardware autobaud, initialized to the end so the next one we try is the first in the list
+static HandsetBaud baudDetect(TxToHandsetBauds, ARRAY_SIZE(TxToHandsetBauds), ARRAY_SIZE(TxToHandsetBauds) - 1);
+#endif
 
 // for the UART wdt, every 1000ms we change bauds when connect is lost
 static constexpr int UARTwdtInterval = 1000;
@@ -78,9 +82,19 @@ void CRSFHandset::Begin()
     // Invert RX/TX (not done, connection is full duplex uninverted)
     //USC0(UART0) |= BIT(UCRXI) | BIT(UCTXI);
     // No log message because this is our only UART
+    // Time the sync bytes until the handset is found
+    baudDetect.begin(clockCyclesPerMicrosecond());
+    attachInterrupt(digitalPinToInterrupt(GPIO_PIN_RCSIGNAL_RX), syncEdgeISR, FALLING);
 #endif
 }
 
+#if defined(PLATFORM_ESP8266)
+void ICACHE_RAM_ATTR CRSFHandset::syncEdgeISR()
+{
+    baudDetect.fallingEdge(ESP.getCycleCount());
+}
+#endif
+
 void CRSFHandset::End()
 {
     uint32_t startTime = millis();
@@ -206,9 +220,27 @@ bool CRSFHandset::ProcessPacket()
     {
         controllerConnected = true;
         DBGLN("CRSF UART Connected");
+#if defined(PLATFORM_ESP8266)
+        detachInterrupt(digitalPinToInterrupt(GPIO_PIN_RCSIGNAL_RX));
+        baudDetect.connected();
+#endif
+        rcFrameLastRecv = 0;
         if (connected) connected();
     }
 
+    if (inBuffer[2] == CRSF_FRAMETYPE_RC_CHANNELS_PACKED)
+    {
+        // Filtered interval and mean deviation, 1/16 of each new value
+        const uint32_t interval = (dataLastRecv - rcFrameLastRecv) << 4;
+        if (rcFrameLastRecv != 0)
+        {
+            const uint32_t deviation = interval > rcFrameInterval ? interval - rcFrameInterval : rcFrameInterval - interval;
+            rcFrameInterval = rcFrameInterval == 0 ? interval : rcFrameInterval + ((int32_t)(interval - rcFrameInterval) >> 4);
+            rcFrameJitter = rcFrameJitter + ((int32_t)(deviation - rcFrameJitter) >> 4);
+        }
+        rcFrameLastRecv = dataLastRecv;
+    }
+
     crsfRouter.processMessage(this, (crsf_header_t *)&inBuffer);
 
     return true;
@@ -427,6 +459,17 @@ int CRSFHandset::getMinPacketInterval() const
     return 1;   // 1-million Hz!
 }
 
+void CRSFHandset::getStats(crsfHandsetStats_t *stats) const
+{
+    stats->baud = UARTrequestedBaud;
+    stats->baudChanges = UARTbaudChanges;
+    stats->frameIntervalUs = rcFrameInterval >> 4;
+    stats->frameJitterUs = rcFrameJitter >> 4;
+    stats->syncOffset = OpenTXsyncOffset;
+    stats->goodFrames = GoodPktsCountResult;
+    stats->badCrcFrames = BadPktsCountResult;
+}
+
 void ICACHE_RAM_ATTR CRSFHandset::adjustMaxPacketSize()
 {
     const int LUA_CHUNK_QUERY_SIZE = 26;
@@ -539,8 +582,8 @@ uint32_t CRSFHandset::autobaud()
 }
 #else
 uint32_t CRSFHandset::autobaud() {
-    UARTcurrentBaudIdx = (UARTcurrentBaudIdx + 1) % ARRAY_SIZE(TxToHandsetBauds);
-    return TxToHandsetBauds[UARTcurrentBaudIdx];
+    // The baud the sync bytes were measured at, else the next one in the list
+    return baudDetect.next();
 }
 #endif
 
@@ -554,7 +597,10 @@ bool CRSFHandset::UARTwdt()
         // If no packets or more bad than good packets, rate cycle/autobaud the UART but
         // do not adjust the parameters while in wifi mode. If a firmware is being
         // uploaded, it will cause tons of serial errors during the flash writes
-        if ((connectionState != wifiUpdate) && (BadPktsCount >= GoodPktsCount || !controllerConnected))
+        const bool badInterval = BadPktsCount >= GoodPktsCount || !controllerConnected;
+        UARTwdtBadIntervals = badInterval ? std::min(UARTwdtBadIntervals + 1, 2) : 0;
+        // Keep a working baud through one bad interval, a glitch on the line should not lose the handset
+        if ((connectionState != wifiUpdate) && badInterval && (!controllerConnected || UARTwdtBadIntervals >= 2))
         {
             DBGLN("Too many bad UART RX packets!");
 
@@ -563,12 +609,16 @@ bool CRSFHandset::UARTwdt()
                 DBGLN("CRSF UART Disconnected");
                 if (disconnected) disconnected();
                 controllerConnected = false;
+#if defined(PLATFORM_ESP8266)
+                attachInterrupt(digitalPinToInterrupt(GPIO_PIN_RCSIGNAL_RX), syncEdgeISR, FALLING);
+#endif
             }
 
             UARTrequestedBaud = autobaud();
             if (UARTrequestedBaud != 0)
             {
                 DBGLN("UART WDT: Switch to: %d baud", UARTrequestedBaud);
+                UARTbaudChanges++;
 
                 adjustMaxPacketSize();
 
@@ -584,11 +634,6 @@ bool CRSFHandset::UARTwdt()
             }
             retval = true;
         }
-#ifdef DEBUG_OPENTX_SYNC
-        if (abs((int)((1000000 / (ExpressLRS_currAirRate_Modparams->interval * ExpressLRS_currAirRate_Modparams->numOfSends)) - (int)GoodPktsCount)) > 1)
-#endif
-            DBGLN("UART STATS Bad:Good = %u:%u", BadPktsCount, GoodPktsCount);
-
         UARTwdtLastChecked = now;
         if (retval)
         {
@@ -598,6 +643,16 @@ bool CRSFHandset::UARTwdt()
 
         GoodPktsCountResult = GoodPktsCount;
         BadPktsCountResult = BadPktsCount;
+#ifdef DEBUG_OPENTX_SYNC
+        if (abs((int)((1000000 / (ExpressLRS_currAirRate_Modparams->interval * ExpressLRS_currAirRate_Modparams->numOfSends)) - (int)GoodPktsCount)) > 1)
+#endif
+        {
+            crsfHandsetStats_t stats;
+            getStats(&stats);
+            DBGLN("UART STATS Bad:Good = %u:%u, %u baud (%u changes), interval %uus jitter %uus, sync offset %d",
+                stats.badCrcFrames, stats.goodFrames, stats.baud, stats.baudChanges,
+                stats.frameIntervalUs, stats.frameJitterUs, stats.syncOffset);
+        }
         BadPktsCount = 0;
         GoodPktsCount = 0;
     }
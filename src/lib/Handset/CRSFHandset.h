@@ -15,6 +15,16 @@
 #include "driver/uart.h"
 #endif
 
+typedef struct {
+    uint32_t baud;              // UART baud to the handset
+    uint16_t baudChanges;       // times the baud has been switched looking for the handset
+    uint32_t frameIntervalUs;   // mean time between RC frames from the handset
+    uint32_t frameJitterUs;     // mean deviation of the RC frame interval from its mean
+    int32_t syncOffset;         // OpenTX sync offset, 0.1us, RC frame arrival to the following OTA packet
+    uint32_t goodFrames;        // frames with a good CRC in the last UART watchdog interval
+    uint32_t badCrcFrames;      // frames with a bad CRC in the last UART watchdog interval
+} crsfHandsetStats_t;
+
 class CRSFHandset final : public Handset, public CRSFConnector
 {
 
@@ -34,11 +44,20 @@ public:
     void handleOutput(uint32_t receivedBytes);
 
     void setPacketInterval(int32_t PacketInterval) override;
+    /**
+     * Measures how long before the OTA packet the RC frame from the handset arrived, averaged over
+     * 20ms of packets. sendSyncPacketToTX() sends it to OpenTX/EdgeTX, which moves its mixer so the
+     * frames arrive a safe margin before the packet. A frame that is a whole interval late or
+     * missing starts the average again.
+     */
     void JustSentRFpacket() override;
 
     uint8_t GetMaxPacketBytes() const override { return maxPacketBytes; }
     int getMinPacketInterval() const override;
 
+    // Statistics for the link to the handset
+    void getStats(crsfHandsetStats_t *stats) const;
+
 private:
     uint8_t inBuffer[CRSF_MAX_PACKET_LEN] = {};
 
@@ -58,8 +77,14 @@ private:
     uint32_t UARTwdtLastChecked = 0;
     uint8_t maxPacketBytes = CRSF_MAX_PACKET_LEN;
     uint8_t maxPeriodBytes = CRSF_MAX_PACKET_LEN;
+    uint8_t UARTwdtBadIntervals = 0;
+    uint16_t UARTbaudChanges = 0;
+
+    /// RC frame timing, << 4 ///
+    uint32_t rcFrameLastRecv = 0;
+    uint32_t rcFrameInterval = 0;
+    uint32_t rcFrameJitter = 0;
 
-    static uint8_t UARTcurrentBaudIdx;
     static uint32_t UARTrequestedBaud;
 
     static Stream *PortSecondary; // A second UART used to mirror telemetry out on the TX, not read from
@@ -76,6 +101,9 @@ private:
     bool ProcessPacket();
     bool UARTwdt();
     uint32_t autobaud();
+#if defined(PLATFORM_ESP8266)
+    static void syncEdgeISR();
+#endif
     void flush_port_input();
 };
 
@@ -0,0 +1,99 @@
+#include "HandsetBaud.h"
+
+HandsetBaud::HandsetBaud(const int32_t *bauds, uint8_t count, uint8_t start)
+    : m_bauds(bauds), m_count(count > HANDSET_BAUD_MAX_RATES ? HANDSET_BAUD_MAX_RATES : count),
+      m_current(start), m_idleTicks(0), m_failed(0), m_currentMeasured(false), m_lastEdge(0), m_syncStart(0), m_syncStarted(false),
+      m_candidate(HANDSET_BAUD_NONE), m_votes(0)
+{
+}
+
+void HandsetBaud::begin(uint16_t ticksPerUs)
+{
+    // Worked out here so the ISR does not have to divide
+    for (uint8_t i = 0; i < m_count; i++)
+    {
+        const bool timeable = HANDSET_BAUD_SYNC_BITS * 1000000ULL >= HANDSET_BAUD_MIN_SYNC_US * (uint64_t)m_bauds[i];
+        m_syncTicks[i] = timeable ? HANDSET_BAUD_SYNC_BITS * 1000000ULL * ticksPerUs / m_bauds[i] : 0;
+    }
+    m_idleTicks = HANDSET_BAUD_IDLE_US * ticksPerUs;
+    // The first edge counts as coming after the line was idle
+    m_lastEdge = 0 - m_idleTicks;
+    m_syncStarted = false;
+    m_votes = 0;
+}
+
+uint8_t ICACHE_RAM_ATTR HandsetBaud::nearest(uint32_t syncTicks) const
+{
+    for (uint8_t i = 0; i < m_count; i++)
+    {
+        const uint32_t expected = m_syncTicks[i];
+        if (expected == 0)
+            continue;
+        const uint32_t error = syncTicks > expected ? syncTicks - expected : expected - syncTicks;
+        // The bauds are further apart than twice the tolerance, at most one can match
+        if (error * 100 <= expected * HANDSET_BAUD_TOLERANCE_PCT)
+            return i;
+    }
+    return HANDSET_BAUD_NONE;
+}
+
+void ICACHE_RAM_ATTR HandsetBaud::fallingEdge(uint32_t now)
+{
+    const uint32_t sinceLast = now - m_lastEdge;
+    m_lastEdge = now;
+
+    // The first edge after the line has been idle is the start bit of a sync byte
+    if (sinceLast >= m_idleTicks)
+    {
+        m_syncStart = now;
+        m_syncStarted = true;
+        return;
+    }
+    if (!m_syncStarted)
+        return;
+    m_syncStarted = false;
+
+    const uint8_t baud = nearest(now - m_syncStart);
+    if (baud == HANDSET_BAUD_NONE)
+    {
+        m_votes = 0;
+    }
+    else if (baud == m_candidate)
+    {
+        if (m_votes < HANDSET_BAUD_VOTES)
+            m_votes++;
+    }
+    else
+    {
+        m_candidate = baud;
+        m_votes = 1;
+    }
+}
+
+uint32_t HandsetBaud::measured() const
+{
+    return m_votes >= HANDSET_BAUD_VOTES ? m_bauds[m_candidate] : 0;
+}
+
+uint32_t HandsetBaud::next()
+{
+    const bool agreed = m_votes >= HANDSET_BAUD_VOTES;
+    // Lost sync at a baud the sync bytes pointed to, they are not to be trusted for it
+    if (m_currentMeasured || (agreed && m_candidate == m_current))
+        m_failed |= 1 << m_current;
+
+    m_currentMeasured = agreed && !(m_failed & (1 << m_candidate));
+    if (m_currentMeasured)
+        m_current = m_candidate;
+    else
+        m_current = (m_current + 1) % m_count;
+    // Measure again at the new baud, so a stale measurement is not used twice
+    m_votes = 0;
+    return m_bauds[m_current];
+}
+
+void HandsetBaud::connected()
+{
+    m_failed = 0;
+    m_currentMeasured = false;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "targets.h"
+#include <stdint.h>
+
+/*
+ * Picks the baud rate for the UART to the handset when the TX has lost sync with it.
+ *
+ * Every CRSF frame from the handset starts with a sync byte, 0xC8 or 0xEE, after the line has been
+ * idle since the last frame. Sent LSB first after the start bit these are 0000 1 and 00 111 0, so
+ * the first two falling edges of a frame are 5 bit times apart for either of them. That time gives
+ * the baud whatever the UART is set to. Measurements that agree on the same baud several times in
+ * a row are taken, anything else (noise, a missed edge) starts the count again.
+ *
+ * Only bauds whose sync byte is at least HANDSET_BAUD_MIN_SYNC_US long are measured. The edge
+ * interrupt takes a few us to come in and to run, a shorter gap than that is not timed reliably
+ * and those bauds are only ever found by cycling. Of the CRSF bauds only 115200 and 400000 are
+ * measured, the faster ones take as long to find as they did before.
+ *
+ * Without a measurement it falls back to cycling through the list like before. A measured baud
+ * that has been tried and did not work is not switched to again until the handset is connected,
+ * so a bad measurement (noise, an inverted line) cannot keep it from cycling.
+ *
+ * There is no hardware access, it is given the time of each falling edge on the line, in ticks of
+ * whatever clock the caller has (the CPU cycle counter on the ESP8266).
+ */
+
+#define HANDSET_BAUD_MAX_RATES 8
+#define HANDSET_BAUD_SYNC_BITS 5            // bit times between the first two falling edges of a sync byte
+#define HANDSET_BAUD_IDLE_US 200            // longer than a byte at the slowest baud, the line is between frames
+#define HANDSET_BAUD_TOLERANCE_PCT 8        // a measurement within this of a baud counts towards it
+#define HANDSET_BAUD_VOTES 3                // measurements in a row that must agree
+#define HANDSET_BAUD_MIN_SYNC_US 10         // shortest sync byte the edge interrupt can time, 400000 baud and slower
+#define HANDSET_BAUD_NONE 0xff
+
+class HandsetBaud
+{
+public:
+    /**
+     * @param bauds the bauds to choose between, not copied. Up to HANDSET_BAUD_MAX_RATES are used.
+     * @param start index of the baud the UART starts at
+     */
+    HandsetBaud(const int32_t *bauds, uint8_t count, uint8_t start);
+
+    // Set the resolution of the edge times, before the first edge
+    void begin(uint16_t ticksPerUs);
+
+    // A falling edge on the UART RX line, the time in ticks may wrap
+    void fallingEdge(uint32_t now);
+
+    // The baud the UART should try next, having lost sync at the current one
+    uint32_t next();
+
+    // The handset is talking at the current baud, measured bauds that failed can be tried again
+    void connected();
+
+    // The baud the sync bytes agree on, 0 if they do not yet
+    uint32_t measured() const;
+
+private:
+    const int32_t *m_bauds;
+    uint8_t m_count;
+    uint8_t m_current;      // index in use by the UART
+    uint32_t m_idleTicks;
+    uint32_t m_syncTicks[HANDSET_BAUD_MAX_RATES];   // expected sync byte time at each baud, 0 if too short to time
+    uint8_t m_failed;       // bit per index, measured bauds that did not work
+    bool m_currentMeasured; // m_current was switched to from a measurement
+
+    // Sync byte measurement, written from the edge ISR
+    volatile uint32_t m_lastEdge;
+    volatile uint32_t m_syncStart;
+    volatile bool m_syncStarted;
+    volatile uint8_t m_candidate;
+    volatile uint8_t m_votes;
+
+    uint8_t nearest(uint32_t syncTicks) const;
+};
@@ -0,0 +1,314 @@
+#include "HoTTSensors.h"
+
+#include "CRSFRouter.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#define HOTT_FIELD(packet, member) offsetof(packet, member)
+
+//
+// Sensor map, every received HoTT frame is decoded in a single pass over the entries for its device.
+// New sensors or fields only need entries here (and a CRSF frame if not covered yet).
+//
+static const hottSensorMap_t sensorMap[] = {
+    // Vario: preferred source of altitude and climb rate
+    {VARIO, HOTT_FIELD(VarioPacket_t, altitude), HOTT_U16, HOTT_ALTITUDE, 0, 500, 10},
+    {VARIO, HOTT_FIELD(VarioPacket_t, mPerSec), HOTT_U16, HOTT_VSPD, 0, HOTT_VSPD_OFFSET, 1},
+
+    // GPS
+    {GPS, HOTT_FIELD(GPSPacket_t, altitude), HOTT_U16, HOTT_ALTITUDE, 1, 500, 10},
+    {GPS, HOTT_FIELD(GPSPacket_t, mPerSec), HOTT_U16, HOTT_VSPD, 1, HOTT_VSPD_OFFSET, 1},
+    {GPS, HOTT_FIELD(GPSPacket_t, latNS), HOTT_COORD, HOTT_LATITUDE, 0, 0, 1},
+    {GPS, HOTT_FIELD(GPSPacket_t, lonEW), HOTT_COORD, HOTT_LONGITUDE, 0, 0, 1},
+    {GPS, HOTT_FIELD(GPSPacket_t, speed), HOTT_U16, HOTT_GROUNDSPEED, 0, 0, 10},
+    {GPS, HOTT_FIELD(GPSPacket_t, direction), HOTT_U8, HOTT_HEADING, 0, 0, 2},
+    {GPS, HOTT_FIELD(GPSPacket_t, satellites), HOTT_U8, HOTT_SATELLITES, 0, 0, 1},
+    {GPS, HOTT_FIELD(GPSPacket_t, mslAltitude), HOTT_U16, HOTT_MSL_ALTITUDE, 0, 0, 1},
+
+    // EAM: preferred source of battery and motor data
+    {EAM, HOTT_FIELD(ElectricAirPacket_t, altitude), HOTT_U16, HOTT_ALTITUDE, 2, 500, 10},
+    {EAM, HOTT_FIELD(ElectricAirPacket_t, mPerSec), HOTT_U16, HOTT_VSPD, 2, HOTT_VSPD_OFFSET, 1},
+    {EAM, HOTT_FIELD(ElectricAirPacket_t, mainVoltage), HOTT_U16, HOTT_VOLTAGE, 0, 0, 1},
+    {EAM, HOTT_FIELD(ElectricAirPacket_t, current), HOTT_U16, HOTT_CURRENT, 0, 0, 1},
+    {EAM, HOTT_FIELD(ElectricAirPacket_t, capacity), HOTT_U16, HOTT_CAPACITY, 0, 0, 10},
+    {EAM, HOTT_FIELD(ElectricAirPacket_t, speed), HOTT_U16, HOTT_AIRSPEED, 0, 0, HOTT_SPEED_SCALE_EAM},
+    {EAM, HOTT_FIELD(ElectricAirPacket_t, rpm), HOTT_U16, HOTT_RPM_FIRST, 0, 0, HOTT_RPM_SCALE},
+    {EAM, HOTT_FIELD(ElectricAirPacket_t, temp1), HOTT_U8, HOTT_TEMP_FIRST, 0, HOTT_TEMP_OFFSET, HOTT_TEMP_SCALE},
+    {EAM, HOTT_FIELD(ElectricAirPacket_t, temp2), HOTT_U8, (hottValue_e)(HOTT_TEMP_FIRST + 1), 0, HOTT_TEMP_OFFSET, HOTT_TEMP_SCALE},
+    {EAM, HOTT_FIELD(ElectricAirPacket_t, cellL) + 0, HOTT_U8, (hottValue_e)(HOTT_CELL_FIRST + 0), 0, 0, HOTT_CELL_SCALE},
+    {EAM, HOTT_FIELD(ElectricAirPacket_t, cellL) + 1, HOTT_U8, (hottValue_e)(HOTT_CELL_FIRST + 1), 0, 0, HOTT_CELL_SCALE},
+    {EAM, HOTT_FIELD(ElectricAirPacket_t, cellL) + 2, HOTT_U8, (hottValue_e)(HOTT_CELL_FIRST + 2), 0, 0, HOTT_CELL_SCALE},
+    {EAM, HOTT_FIELD(ElectricAirPacket_t, cellL) + 3, HOTT_U8, (hottValue_e)(HOTT_CELL_FIRST + 3), 0, 0, HOTT_CELL_SCALE},
+    {EAM, HOTT_FIELD(ElectricAirPacket_t, cellL) + 4, HOTT_U8, (hottValue_e)(HOTT_CELL_FIRST + 4), 0, 0, HOTT_CELL_SCALE},
+    {EAM, HOTT_FIELD(ElectricAirPacket_t, cellL) + 5, HOTT_U8, (hottValue_e)(HOTT_CELL_FIRST + 5), 0, 0, HOTT_CELL_SCALE},
+    {EAM, HOTT_FIELD(ElectricAirPacket_t, cellL) + 6, HOTT_U8, (hottValue_e)(HOTT_CELL_FIRST + 6), 0, 0, HOTT_CELL_SCALE},
+    {EAM, HOTT_FIELD(ElectricAirPacket_t, cellH) + 0, HOTT_U8, (hottValue_e)(HOTT_CELL_FIRST + 7), 0, 0, HOTT_CELL_SCALE},
+    {EAM, HOTT_FIELD(ElectricAirPacket_t, cellH) + 1, HOTT_U8, (hottValue_e)(HOTT_CELL_FIRST + 8), 0, 0, HOTT_CELL_SCALE},
+    {EAM, HOTT_FIELD(ElectricAirPacket_t, cellH) + 2, HOTT_U8, (hottValue_e)(HOTT_CELL_FIRST + 9), 0, 0, HOTT_CELL_SCALE},
+    {EAM, HOTT_FIELD(ElectricAirPacket_t, cellH) + 3, HOTT_U8, (hottValue_e)(HOTT_CELL_FIRST + 10), 0, 0, HOTT_CELL_SCALE},
+    {EAM, HOTT_FIELD(ElectricAirPacket_t, cellH) + 4, HOTT_U8, (hottValue_e)(HOTT_CELL_FIRST + 11), 0, 0, HOTT_CELL_SCALE},
+    {EAM, HOTT_FIELD(ElectricAirPacket_t, cellH) + 5, HOTT_U8, (hottValue_e)(HOTT_CELL_FIRST + 12), 0, 0, HOTT_CELL_SCALE},
+    {EAM, HOTT_FIELD(ElectricAirPacket_t, cellH) + 6, HOTT_U8, (hottValue_e)(HOTT_CELL_FIRST + 13), 0, 0, HOTT_CELL_SCALE},
+    {EAM, HOTT_FIELD(ElectricAirPacket_t, battVoltage1), HOTT_U16, HOTT_VOLT_FIRST, 0, 0, HOTT_VOLT_SCALE},
+    {EAM, HOTT_FIELD(ElectricAirPacket_t, battVoltage2), HOTT_U16, (hottValue_e)(HOTT_VOLT_FIRST + 1), 0, 0, HOTT_VOLT_SCALE},
+    {EAM, HOTT_FIELD(ElectricAirPacket_t, mainVoltage), HOTT_U16, (hottValue_e)(HOTT_VOLT_FIRST + 2), 0, 0, HOTT_VOLT_SCALE},
+
+    // GAM
+    {GAM, HOTT_FIELD(GeneralAirPacket_t, altitude), HOTT_U16, HOTT_ALTITUDE, 3, 500, 10},
+    {GAM, HOTT_FIELD(GeneralAirPacket_t, mPerSec), HOTT_U16, HOTT_VSPD, 3, HOTT_VSPD_OFFSET, 1},
+    {GAM, HOTT_FIELD(GeneralAirPacket_t, inputVoltage), HOTT_U16, HOTT_VOLTAGE, 1, 0, 1},
+    {GAM, HOTT_FIELD(GeneralAirPacket_t, current), HOTT_U16, HOTT_CURRENT, 1, 0, 1},
+    {GAM, HOTT_FIELD(GeneralAirPacket_t, capacity), HOTT_U16, HOTT_CAPACITY, 1, 0, 10},
+    {GAM, HOTT_FIELD(GeneralAirPacket_t, fuelScale), HOTT_U8, HOTT_REMAINING, 0, 0, 1},
+    {GAM, HOTT_FIELD(GeneralAirPacket_t, speed), HOTT_U16, HOTT_AIRSPEED, 2, 0, HOTT_SPEED_SCALE_GAM},
+    {GAM, HOTT_FIELD(GeneralAirPacket_t, rpm1), HOTT_U16, HOTT_RPM_FIRST, 2, 0, HOTT_RPM_SCALE},
+    {GAM, HOTT_FIELD(GeneralAirPacket_t, rpm2), HOTT_U16, (hottValue_e)(HOTT_RPM_FIRST + 1), 2, 0, HOTT_RPM_SCALE},
+    {GAM, HOTT_FIELD(GeneralAirPacket_t, temperature1), HOTT_U8, HOTT_TEMP_FIRST, 2, HOTT_TEMP_OFFSET, HOTT_TEMP_SCALE},
+    {GAM, HOTT_FIELD(GeneralAirPacket_t, temperature2), HOTT_U8, (hottValue_e)(HOTT_TEMP_FIRST + 1), 2, HOTT_TEMP_OFFSET, HOTT_TEMP_SCALE},
+    {GAM, HOTT_FIELD(GeneralAirPacket_t, voltageCell1), HOTT_U8, (hottValue_e)(HOTT_CELL_FIRST + 0), 2, 0, HOTT_CELL_SCALE},
+    {GAM, HOTT_FIELD(GeneralAirPacket_t, voltageCell2), HOTT_U8, (hottValue_e)(HOTT_CELL_FIRST + 1), 2, 0, HOTT_CELL_SCALE},
+    {GAM, HOTT_FIELD(GeneralAirPacket_t, voltageCell3), HOTT_U8, (hottValue_e)(HOTT_CELL_FIRST + 2), 2, 0, HOTT_CELL_SCALE},
+    {GAM, HOTT_FIELD(GeneralAirPacket_t, voltageCell4), HOTT_U8, (hottValue_e)(HOTT_CELL_FIRST + 3), 2, 0, HOTT_CELL_SCALE},
+    {GAM, HOTT_FIELD(GeneralAirPacket_t, voltageCell5), HOTT_U8, (hottValue_e)(HOTT_CELL_FIRST + 4), 2, 0, HOTT_CELL_SCALE},
+    {GAM, HOTT_FIELD(GeneralAirPacket_t, voltageCell6), HOTT_U8, (hottValue_e)(HOTT_CELL_FIRST + 5), 2, 0, HOTT_CELL_SCALE},
+    {GAM, HOTT_FIELD(GeneralAirPacket_t, battery1), HOTT_U16, HOTT_VOLT_FIRST, 2, 0, HOTT_VOLT_SCALE},
+    {GAM, HOTT_FIELD(GeneralAirPacket_t, battery2), HOTT_U16, (hottValue_e)(HOTT_VOLT_FIRST + 1), 2, 0, HOTT_VOLT_SCALE},
+    {GAM, HOTT_FIELD(GeneralAirPacket_t, inputVoltage), HOTT_U16, (hottValue_e)(HOTT_VOLT_FIRST + 2), 2, 0, HOTT_VOLT_SCALE},
+
+    // ESC
+    {ESC, HOTT_FIELD(AirESCPacket_t, inputVoltage), HOTT_U16, HOTT_VOLTAGE, 2, 0, 1},
+    {ESC, HOTT_FIELD(AirESCPacket_t, current), HOTT_U16, HOTT_CURRENT, 2, 0, 1},
+    {ESC, HOTT_FIELD(AirESCPacket_t, capacity), HOTT_U16, HOTT_CAPACITY, 2, 0, 10},
+    {ESC, HOTT_FIELD(AirESCPacket_t, speed), HOTT_U16, HOTT_AIRSPEED, 1, 0, HOTT_SPEED_SCALE_EAM},
+    {ESC, HOTT_FIELD(AirESCPacket_t, rpm), HOTT_U16, HOTT_RPM_FIRST, 1, 0, HOTT_RPM_SCALE},
+    {ESC, HOTT_FIELD(AirESCPacket_t, rpmMax), HOTT_U16, (hottValue_e)(HOTT_RPM_FIRST + 1), 1, 0, HOTT_RPM_SCALE},
+    {ESC, HOTT_FIELD(AirESCPacket_t, escTemp), HOTT_U8, HOTT_TEMP_FIRST, 1, HOTT_TEMP_OFFSET, HOTT_TEMP_SCALE},
+    {ESC, HOTT_FIELD(AirESCPacket_t, becTemp), HOTT_U8, (hottValue_e)(HOTT_TEMP_FIRST + 1), 1, HOTT_TEMP_OFFSET, HOTT_TEMP_SCALE},
+    {ESC, HOTT_FIELD(AirESCPacket_t, motorTemp), HOTT_U8, (hottValue_e)(HOTT_TEMP_FIRST + 2), 1, HOTT_TEMP_OFFSET, HOTT_TEMP_SCALE},
+    {ESC, HOTT_FIELD(AirESCPacket_t, pumpTemp), HOTT_U8, (hottValue_e)(HOTT_TEMP_FIRST + 3), 1, HOTT_TEMP_OFFSET, HOTT_TEMP_SCALE},
+    {ESC, HOTT_FIELD(AirESCPacket_t, auxTemp), HOTT_U8, (hottValue_e)(HOTT_TEMP_FIRST + 4), 1, HOTT_TEMP_OFFSET, HOTT_TEMP_SCALE},
+    {ESC, HOTT_FIELD(AirESCPacket_t, inputVoltage), HOTT_U16, HOTT_VOLT_FIRST, 1, 0, HOTT_VOLT_SCALE},
+    {ESC, HOTT_FIELD(AirESCPacket_t, becVoltage), HOTT_U8, (hottValue_e)(HOTT_VOLT_FIRST + 1), 1, 0, HOTT_VOLT_SCALE},
+};
+
+HoTTSensors::HoTTSensors()
+{
+    memset(valueSource, HOTT_NO_SOURCE, sizeof(valueSource));
+    memset(valueRank, HOTT_NO_SOURCE, sizeof(valueRank));
+}
+
+void HoTTSensors::decodeFrame(const uint8_t deviceIdx, const uint8_t *frame)
+{
+    for (const auto &map : sensorMap)
+    {
+        if (map.device == deviceIdx)
+        {
+            decodeField(map, frame);
+        }
+    }
+}
+
+void HoTTSensors::decodeField(const hottSensorMap_t &map, const uint8_t *frame)
+{
+    // a value already provided by a better ranked device is left alone
+    if (map.rank > valueRank[map.value])
+    {
+        return;
+    }
+
+    const uint8_t *field = &frame[map.offset];
+    int32_t value;
+
+    switch (map.field)
+    {
+    case HOTT_U8:
+        value = field[0];
+        break;
+    case HOTT_U16:
+        value = field[0] | (field[1] << 8);
+        break;
+    default:
+        value = decodeCoordinate(field);
+        break;
+    }
+
+    values[map.value] = (value - map.bias) * map.scale;
+    valueSource[map.value] = map.device;
+    valueRank[map.value] = map.rank;
+}
+
+int32_t HoTTSensors::decodeCoordinate(const uint8_t *field)
+{
+    // e.g. N48D39'0988'' is sent as 0, 4839, 988
+    const uint16_t degMin = field[1] | (field[2] << 8);
+    const uint16_t sec = field[3] | (field[4] << 8);
+
+    uint8_t deg = degMin / DegMinScale;
+
+    int32_t coord = deg * DegScale +
+                    ((degMin - (deg * DegMinScale)) * MinScale) / MinDivide +
+                    (sec * SecScale) / MinDivide;
+
+    if (field[0] != 0)
+    {
+        coord = -coord;
+    }
+
+    return coord;
+}
+
+uint8_t HoTTSensors::buildCRSFframe(hottCrsfFrame_e frame, uint8_t *buffer)
+{
+    crsf_header_t *header = (crsf_header_t *)buffer;
+    uint8_t *payload = buffer + sizeof(crsf_header_t);
+    crsf_frame_type_e type;
+    uint8_t payloadSize;
+
+    switch (frame)
+    {
+    case HOTT_CRSF_VARIO:
+    {
+        // HoTT stand alone Vario or GPS/Vario or EAM or GAM
+        if (valueSource[HOTT_ALTITUDE] == HOTT_NO_SOURCE)
+            return 0;
+
+        crsf_sensor_baro_vario_t *baro = (crsf_sensor_baro_vario_t *)payload;
+        baro->altitude = htobe16(values[HOTT_ALTITUDE] + 10000); // ELRS 10000 = 0.0m
+        baro->verticalspd = htobe16(values[HOTT_VSPD]);
+        type = CRSF_FRAMETYPE_BARO_ALTITUDE;
+        payloadSize = sizeof(crsf_sensor_baro_vario_t);
+        break;
+    }
+
+    case HOTT_CRSF_GPS:
+    {
+        // HoTT combined GPS/Vario
+        if (valueSource[HOTT_LATITUDE] == HOTT_NO_SOURCE)
+            return 0;
+
+        uint16_t heading = values[HOTT_HEADING];
+        if (heading > 180)
+        {
+            heading -= 360;
+        }
+
+        crsf_sensor_gps_t *gps = (crsf_sensor_gps_t *)payload;
+        memset(gps, 0, sizeof(crsf_sensor_gps_t));
+        gps->latitude = htobe32(values[HOTT_LATITUDE]);
+        gps->longitude = htobe32(values[HOTT_LONGITUDE]);
+        gps->groundspeed = htobe16(values[HOTT_GROUNDSPEED]);
+        gps->gps_heading = htobe16(heading * 100);
+        gps->altitude = htobe16(values[HOTT_MSL_ALTITUDE] + 1000); // CRSF: 0m = 1000
+        gps->satellites_in_use = values[HOTT_SATELLITES];
+        type = CRSF_FRAMETYPE_GPS;
+        payloadSize = sizeof(crsf_sensor_gps_t);
+        break;
+    }
+
+    case HOTT_CRSF_BATTERY:
+    {
+        // HoTT GAM, EAM, ESC
+        if (valueSource[HOTT_VOLTAGE] == HOTT_NO_SOURCE)
+            return 0;
+
+        crsf_sensor_battery_t *batt = (crsf_sensor_battery_t *)payload;
+        batt->voltage = htobe16(values[HOTT_VOLTAGE]);
+        batt->current = htobe16(values[HOTT_CURRENT]);
+        batt->capacity = htobe24(values[HOTT_CAPACITY]);
+        batt->remaining = values[HOTT_REMAINING];
+        type = CRSF_FRAMETYPE_BATTERY_SENSOR;
+        payloadSize = sizeof(crsf_sensor_battery_t);
+        break;
+    }
+
+    case HOTT_CRSF_RPM:
+        if (valueSource[HOTT_RPM_FIRST] == HOTT_NO_SOURCE)
+            return 0;
+
+        payload[0] = valueSource[HOTT_RPM_FIRST];
+        type = CRSF_FRAMETYPE_RPM;
+        payloadSize = 1 + packValues(payload + 1, HOTT_RPM_FIRST, HOTT_RPM_LAST, 3);
+        break;
+
+    case HOTT_CRSF_TEMP:
+        if (valueSource[HOTT_TEMP_FIRST] == HOTT_NO_SOURCE)
+            return 0;
+
+        payload[0] = valueSource[HOTT_TEMP_FIRST];
+        type = CRSF_FRAMETYPE_TEMP;
+        payloadSize = 1 + packValues(payload + 1, HOTT_TEMP_FIRST, HOTT_TEMP_LAST, 2);
+        break;
+
+    case HOTT_CRSF_CELLS:
+        if (valueSource[HOTT_CELL_FIRST] == HOTT_NO_SOURCE)
+            return 0;
+
+        payload[0] = valueSource[HOTT_CELL_FIRST];
+        type = CRSF_FRAMETYPE_CELLS;
+        payloadSize = 1 + packValues(payload + 1, HOTT_CELL_FIRST, HOTT_CELL_LAST, 2);
+        break;
+
+    case HOTT_CRSF_VOLT:
+        if (valueSource[HOTT_VOLT_FIRST] == HOTT_NO_SOURCE)
+            return 0;
+
+        // voltages are sent as cells with the source id offset by 128
+        payload[0] = 128 + valueSource[HOTT_VOLT_FIRST];
+        type = CRSF_FRAMETYPE_CELLS;
+        payloadSize = 1 + packValues(payload + 1, HOTT_VOLT_FIRST, HOTT_VOLT_LAST, 2);
+        break;
+
+    case HOTT_CRSF_AIRSPEED:
+    {
+        if (valueSource[HOTT_AIRSPEED] == HOTT_NO_SOURCE)
+            return 0;
+
+        crsf_sensor_airspeed_t *airspeed = (crsf_sensor_airspeed_t *)payload;
+        airspeed->speed = htobe16(values[HOTT_AIRSPEED]);
+        type = CRSF_FRAMETYPE_AIRSPEED;
+        payloadSize = sizeof(crsf_sensor_airspeed_t);
+        break;
+    }
+
+    default:
+        return 0;
+    }
+
+    crsfRouter.SetHeaderAndCrc(header, type, CRSF_FRAME_SIZE(payloadSize), CRSF_ADDRESS_RADIO_TRANSMITTER);
+
+    return CRSF_FRAME_SIZE(payloadSize);
+}
+
+// Pack the big endian values first..last that come from the same device as first, returns the bytes written
+uint8_t HoTTSensors::packValues(uint8_t *payload, hottValue_e first, hottValue_e last, uint8_t width)
+{
+    uint8_t len = 0;
+
+    for (uint8_t v = first; v <= last && valueSource[v] == valueSource[first]; v++)
+    {
+        const int32_t value = values[v];
+
+        for (int8_t shift = (width - 1) * 8; shift >= 0; shift -= 8)
+        {
+            payload[len++] = value >> shift;
+        }
+    }
+
+    return len;
+}
+
+uint32_t HoTTSensors::htobe24(uint32_t val)
+{
+#if (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+    return val;
+#else
+    uint8_t *ptrByte = (uint8_t *)&val;
+
+    uint8_t swp = ptrByte[0];
+    ptrByte[0] = ptrByte[2];
+    ptrByte[2] = swp;
+
+    return val;
+#endif
+}
@@ -0,0 +1,195 @@
+#include "JsonWriter.h"
+
+#include <string.h>
+
+JsonWriter::JsonWriter(char *buffer, size_t len, size_t skip)
+    : m_buffer(buffer), m_len(len), m_skip(skip), m_pos(0), m_empty(0), m_depth(0), m_afterKey(false)
+{
+}
+
+void JsonWriter::put(char c)
+{
+    if (m_pos >= m_skip && m_pos < m_skip + m_len)
+        m_buffer[m_pos - m_skip] = c;
+    m_pos++;
+}
+
+void JsonWriter::put(const char *s, size_t len)
+{
+    // Copy the part of s that lands in the window
+    const size_t end = m_pos + len;
+    const size_t from = m_pos > m_skip ? m_pos : m_skip;
+    const size_t to = end < m_skip + m_len ? end : m_skip + m_len;
+    if (from < to)
+        memcpy(&m_buffer[from - m_skip], &s[from - m_pos], to - from);
+    m_pos = end;
+}
+
+void JsonWriter::separator()
+{
+    if (m_afterKey)
+    {
+        m_afterKey = false;
+        return;
+    }
+    if (m_depth == 0)
+        return;
+    const uint16_t bit = 1 << (m_depth - 1);
+    if (m_empty & bit)
+        m_empty &= ~bit;
+    else
+        put(',');
+}
+
+void JsonWriter::begin(char c)
+{
+    separator();
+    put(c);
+    m_depth++;
+    m_empty |= 1 << (m_depth - 1);
+}
+
+void JsonWriter::end(char c)
+{
+    put(c);
+    if (m_depth > 0)
+        m_depth--;
+}
+
+void JsonWriter::beginObject()
+{
+    begin('{');
+}
+
+void JsonWriter::endObject()
+{
+    end('}');
+}
+
+void JsonWriter::beginArray()
+{
+    begin('[');
+}
+
+void JsonWriter::endArray()
+{
+    end(']');
+}
+
+void JsonWriter::key(const char *name)
+{
+    separator();
+    putString(name, strlen(name));
+    put(':');
+    m_afterKey = true;
+}
+
+void JsonWriter::putString(const char *s, size_t len)
+{
+    static const char hex[] = "0123456789abcdef";
+    put('"');
+    size_t run = 0;     // characters that do not need escaping are copied in runs
+    for (size_t i = 0; i < len; i++)
+    {
+        const char c = s[i];
+        const char *escape = nullptr;
+        switch (c)
+        {
+        case '"': escape = "\\\""; break;
+        case '\\': escape = "\\\\"; break;
+        case '\b': escape = "\\b"; break;
+        case '\f': escape = "\\f"; break;
+        case '\n': escape = "\\n"; break;
+        case '\r': escape = "\\r"; break;
+        case '\t': escape = "\\t"; break;
+        default:
+            if ((uint8_t)c >= 0x20)
+            {
+                run++;
+                continue;
+            }
+        }
+        put(&s[i - run], run);
+        run = 0;
+        if (escape)
+        {
+            put(escape, 2);
+        }
+        else
+        {
+            const char unicode[6] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xF]};
+            put(unicode, sizeof(unicode));
+        }
+    }
+    put(&s[len - run], run);
+    put('"');
+}
+
+void JsonWriter::value(const char *s)
+{
+    if (s == nullptr)
+    {
+        null();
+        return;
+    }
+    value(s, strlen(s));
+}
+
+void JsonWriter::value(const char *s, size_t len)
+{
+    separator();
+    putString(s, len);
+}
+
+void JsonWriter::value(bool b)
+{
+    separator();
+    if (b)
+        put("true", 4);
+    else
+        put("false", 5);
+}
+
+void JsonWriter::putNumber(unsigned long u)
+{
+    char digits[20];
+    uint8_t n = 0;
+    do
+    {
+        digits[sizeof(digits) - 1 - n++] = '0' + u % 10;
+        u /= 10;
+    } while (u != 0);
+    put(&digits[sizeof(digits) - n], n);
+}
+
+void JsonWriter::value(long i)
+{
+    separator();
+    if (i < 0)
+    {
+        put('-');
+        putNumber((unsigned long)0 - (unsigned long)i);
+    }
+    else
+    {
+        putNumber(i);
+    }
+}
+
+void JsonWriter::value(unsigned long u)
+{
+    separator();
+    putNumber(u);
+}
+
+void JsonWriter::null()
+{
+    separator();
+    put("null", 4);
+}
+
+void JsonWriter::raw(const char *json)
+{
+    separator();
+    put(json, strlen(json));
+}
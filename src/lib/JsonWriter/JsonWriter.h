@@ -0,0 +1,78 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Streaming JSON writer for chunked web responses.
+ *
+ * The output is written straight into a caller supplied buffer, no document is built and no heap
+ * is used. Only the part of the output from `skip` to `skip + len` is kept, so a chunked response
+ * can run the same generator again for every chunk, skipping what has already been sent. The
+ * data being serialized must not change between the chunks of one response.
+ *
+ * Commas and the key/value separators are added automatically:
+ *
+ *   json.beginObject();
+ *   json.member("name", name);
+ *   json.key("list"); json.beginArray(); json.value(1); json.value(2); json.endArray();
+ *   json.endObject();
+ */
+
+#define JSON_WRITER_MAX_DEPTH 16   // nesting levels of objects and arrays
+
+class JsonWriter
+{
+public:
+    JsonWriter(char *buffer, size_t len, size_t skip = 0);
+
+    void beginObject();
+    void endObject();
+    void beginArray();
+    void endArray();
+
+    // Object member name, followed by a value or a begin
+    void key(const char *name);
+
+    void value(const char *s);
+    void value(const char *s, size_t len);  // s does not need to be NUL terminated
+    void value(bool b);
+    void value(int i) { value((long)i); }
+    void value(unsigned int u) { value((unsigned long)u); }
+    void value(long i);
+    void value(unsigned long u);
+    void null();
+    // Value that is already serialized JSON
+    void raw(const char *json);
+
+    template<typename T>
+    void member(const char *name, T v)
+    {
+        key(name);
+        value(v);
+    }
+
+    // Bytes written to the buffer
+    size_t length() const { return m_pos > m_skip ? (m_pos - m_skip > m_len ? m_len : m_pos - m_skip) : 0; }
+    // Bytes of output generated, whether they fit in the buffer or not
+    size_t total() const { return m_pos; }
+    // The buffer is full, the rest of the output will be discarded
+    bool full() const { return m_pos >= m_skip + m_len; }
+
+private:
+    char *m_buffer;
+    size_t m_len;
+    size_t m_skip;
+    size_t m_pos;
+    uint16_t m_empty;   // bit per nesting level, set until the first element is written
+    uint8_t m_depth;
+    bool m_afterKey;
+
+    void put(char c);
+    void put(const char *s, size_t len);
+    void putString(const char *s, size_t len);
+    void putNumber(unsigned long u);
+    void separator();
+    void begin(char c);
+    void end(char c);
+};
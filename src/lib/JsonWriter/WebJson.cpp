@@ -0,0 +1,43 @@
+#include "WebJson.h"
+
+#include <string.h>
+
+void writeTargetJson(JsonWriter &json, const web_target_info_t &info)
+{
+    json.beginObject();
+    json.member("target", info.target);
+    json.member("version", info.version);
+    json.member("product_name", info.productName);
+    json.member("lua_name", info.luaName);
+    json.member("reg_domain", info.regDomain);
+    json.member("git-commit", info.gitCommit);
+    json.member("module-type", info.moduleType);
+    json.member("radio-type", info.radioType);
+    json.member("has-sub-ghz", info.hasSubGHz);
+    json.endObject();
+}
+
+void writeNetworksJson(JsonWriter &json, uint8_t count, WebSsidGetter getSsid)
+{
+    json.beginArray();
+    for (uint8_t i = 0; i < count; i++)
+    {
+        uint8_t len;
+        const char *ssid = getSsid(i, len);
+        if (len == 0)
+            continue;
+
+        // Access points with the same SSID are listed once, comparing against the earlier results
+        // instead of keeping a set keeps the memory use fixed
+        bool duplicate = false;
+        for (uint8_t j = 0; j < i && !duplicate; j++)
+        {
+            uint8_t otherLen;
+            const char *other = getSsid(j, otherLen);
+            duplicate = otherLen == len && memcmp(other, ssid, len) == 0;
+        }
+        if (!duplicate)
+            json.value(ssid, len);
+    }
+    json.endArray();
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "JsonWriter.h"
+
+/*
+ * Serializers for the web UI JSON that do not depend on the firmware globals,
+ * so they can be tested natively.
+ */
+
+typedef struct {
+    const char *target;
+    const char *version;
+    const char *productName;
+    const char *luaName;
+    const char *regDomain;
+    const char *gitCommit;
+    const char *moduleType;     // "TX" or "RX"
+    const char *radioType;      // "SX128X", "SX127X" or "LR1121"
+    bool hasSubGHz;
+} web_target_info_t;
+
+// Returns scan result index's SSID and its length, it does not need to be NUL terminated
+typedef const char *(*WebSsidGetter)(uint8_t index, uint8_t &len);
+
+// /target
+void writeTargetJson(JsonWriter &json, const web_target_info_t &info);
+// /networks.json, an array of the unique non-empty SSIDs in scan order
+void writeNetworksJson(JsonWriter &json, uint8_t count, WebSsidGetter getSsid);
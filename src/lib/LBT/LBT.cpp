@@ -4,8 +4,13 @@
 #include "LBT.h"
 #include "POWERMGNT.h"
 #include "config.h"
+#include "FHSS.h"
 
 LQCALC<100> LBTSuccessCalc;
+LbtAuditLog LbtAudit;
+static LbtThreshold lbtThreshold;
+static uint8_t radioChannel[LBT_MAX_RADIOS];
+static uint8_t lbtRadioType = 0xFF;
 static uint32_t rxStartTime;
 
 #if !defined(LBT_RSSI_THRESHOLD_OFFSET_DB)
@@ -77,6 +82,37 @@ void LbtEnableIfRequired()
     LbtIsEnabled = LbtIsEnabled && (ExpressLRS_currAirRate_Modparams->radio_type == RADIO_TYPE_LR1121_LORA_2G4 || ExpressLRS_currAirRate_Modparams->radio_type == RADIO_TYPE_LR1121_GFSK_2G4 || ExpressLRS_currAirRate_Modparams->radio_type == RADIO_TYPE_LR1121_LORA_DUAL);
 #endif
     validRSSIdelayUs = SpreadingFactorToRSSIvalidDelayUs(ExpressLRS_currAirRate_Modparams->sf, ExpressLRS_currAirRate_Modparams->radio_type);
+
+    // The RSSI reads differently with the bandwidth
+    if (ExpressLRS_currAirRate_Modparams->radio_type != lbtRadioType)
+    {
+        lbtRadioType = ExpressLRS_currAirRate_Modparams->radio_type;
+        lbtThreshold.reset();
+    }
+}
+
+void ICACHE_RAM_ATTR LbtSetChannels(uint8_t radio1Channel, uint8_t radio2Channel)
+{
+  radioChannel[0] = radio1Channel;
+  radioChannel[1] = radio2Channel;
+}
+
+void LbtSetInitialChannels(bool gemini)
+{
+  LbtSetChannels(FHSSgetInitialChannel(), gemini ? FHSSgetInitialGeminiChannel() : FHSSgetInitialChannel());
+}
+
+static bool ICACHE_RAM_ATTR LbtRadioIsClear(SX12XX_Radio_Number_t radio, int8_t rssi, int8_t limit)
+{
+  const uint8_t radioIndex = radio == SX12XX_Radio_2 ? 1 : 0;
+  const uint8_t channel = radioChannel[radioIndex];
+  const int8_t threshold = lbtThreshold.threshold(channel, limit);
+  const lbtResult_e result = lbtThreshold.check(radioIndex, channel, rssi, limit);
+  if (result != LBT_CLEAR)
+  {
+    LbtAudit.add(millis(), result, radioIndex, channel, rssi, threshold);
+  }
+  return result != LBT_BUSY;
 }
 
 static int8_t ICACHE_RAM_ATTR PowerEnumToLBTLimit(PowerLevels_e txPower, uint8_t radio_type)
@@ -184,23 +220,24 @@ SX12XX_Radio_Number_t ICACHE_RAM_ATTR LbtChannelIsClear(SX12XX_Radio_Number_t ra
   int8_t rssiInst1 = -128;
   int8_t rssiInst2 = -128;
   SX12XX_Radio_Number_t clearChannelsMask = SX12XX_Radio_NONE;
+  // The regulatory limit, lbtThreshold lowers it to the noise floor of each channel
   const int8_t rssiCutOff = PowerEnumToLBTLimit(POWERMGNT::currPower(), ExpressLRS_currAirRate_Modparams->radio_type);
 
-#if defined(RADIO_LR1121)
   Radio.StartRssiInst(radioNumber);
-#endif
   if (radioNumber & SX12XX_Radio_1)
   {
     // If using dualband, radio1 is always SubGHz and no CCA is required.
-    // Leave rssiInst1=-128 so it always passes.
-    if (ExpressLRS_currAirRate_Modparams->radio_type != RADIO_TYPE_LR1121_LORA_DUAL)
+    if (ExpressLRS_currAirRate_Modparams->radio_type == RADIO_TYPE_LR1121_LORA_DUAL)
     {
-        rssiInst1 = Radio.GetRssiInst(SX12XX_Radio_1);
+        clearChannelsMask |= SX12XX_Radio_1;
     }
-
-    if(rssiInst1 < rssiCutOff)
+    else
     {
-        clearChannelsMask |= SX12XX_Radio_1;
+        rssiInst1 = Radio.GetRssiInst(SX12XX_Radio_1);
+        if (LbtRadioIsClear(SX12XX_Radio_1, rssiInst1, rssiCutOff))
+        {
+            clearChannelsMask |= SX12XX_Radio_1;
+        }
     }
   }
 
@@ -208,7 +245,7 @@ SX12XX_Radio_Number_t ICACHE_RAM_ATTR LbtChannelIsClear(SX12XX_Radio_Number_t ra
   {
     rssiInst2 = Radio.GetRssiInst(SX12XX_Radio_2);
 
-    if(rssiInst2 < rssiCutOff)
+    if (LbtRadioIsClear(SX12XX_Radio_2, rssiInst2, rssiCutOff))
     {
         clearChannelsMask |= SX12XX_Radio_2;
     }
@@ -3,16 +3,24 @@
 
 #if defined(Regulatory_Domain_EU_CE_2400)
 #include "LQCALC.h"
+#include "LbtThreshold.h"
 
 extern LQCALC<100> LBTSuccessCalc;
+extern LbtAuditLog LbtAudit;
 extern bool LbtIsEnabled;
 
 void LbtEnableIfRequired();
 void ICACHE_RAM_ATTR LbtCcaTimerStart();
+// FHSS channels the radios are on, for their noise floors
+void ICACHE_RAM_ATTR LbtSetChannels(uint8_t radio1Channel, uint8_t radio2Channel);
+// The radios have been put on the sync channel (radio 2 on its Gemini pair if gemini), before the first hop
+void LbtSetInitialChannels(bool gemini);
 SX12XX_Radio_Number_t ICACHE_RAM_ATTR LbtChannelIsClear(SX12XX_Radio_Number_t radioNumber);
 #else
 static constexpr bool LbtIsEnabled = false;
 static inline void LbtEnableIfRequired() {}
 static inline void LbtCcaTimerStart() {}
+static inline void LbtSetChannels(uint8_t radio1Channel, uint8_t radio2Channel) {}
+static inline void LbtSetInitialChannels(bool gemini) {}
 static inline SX12XX_Radio_Number_t LbtChannelIsClear(SX12XX_Radio_Number_t radioNumber) { return radioNumber; }
 #endif
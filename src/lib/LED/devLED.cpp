@@ -1,3 +1,4 @@
+#if !defined(UNIT_TEST)
 #include "targets.h"
 #include "common.h"
 #include "devLED.h"
@@ -228,3 +229,4 @@ device_t LED_device = {
     .timeout = timeout,
     .subscribe = EVENT_CONNECTION_CHANGED | EVENT_ENTER_BIND_MODE | EVENT_EXIT_BIND_MODE
 };
+#endif
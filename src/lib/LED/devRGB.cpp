@@ -1,3 +1,4 @@
+#if !defined(UNIT_TEST)
 #include "targets.h"
 #include "common.h"
 #include "devLED.h"
@@ -8,6 +9,8 @@
 
 #include "crsf_protocol.h"
 #include "POWERMGNT.h"
+#include "arena.h"
+#include "led_animation.h"
 
 static uint8_t pixelCount;
 static uint8_t *statusLEDs;
@@ -17,6 +20,9 @@ static uint8_t vtxLEDcount;
 static uint8_t *bootLEDs;
 static uint8_t bootLEDcount;
 
+static uint32_t statusColor;
+static bool pixelsDirty;
+
 #if defined(PLATFORM_ESP32)
 #include "esp32rgb.h"
 static ESP32S3LedDriverGRB *stripgrb;
@@ -52,6 +58,8 @@ void WS281Binit()
         striprgb->ClearTo(RgbColor(0), 0, pixelCount-1);
         striprgb->Show();
     }
+    statusColor = 0;
+    pixelsDirty = false;
 }
 
 void WS281BsetLED(int index, uint32_t color)
@@ -64,10 +72,18 @@ void WS281BsetLED(int index, uint32_t color)
     {
         striprgb->SetPixelColor(index, RgbColor(color >> 16, color >> 8, color));
     }
+    pixelsDirty = true;
 }
 
 void WS281BsetLED(uint32_t color)
 {
+    // Sending to the strip takes 30us per LED, only do it if something changed
+    if (color == statusColor && !pixelsDirty)
+    {
+        return;
+    }
+    statusColor = color;
+    pixelsDirty = false;
     for (int i=0 ; i<statusLEDcount ; i++)
     {
         if (OPT_WS2812_IS_GRB)
@@ -89,139 +105,6 @@ void WS281BsetLED(uint32_t color)
     }
 }
 
-typedef struct {
-    uint8_t h, s, v;
-} blinkyColor_t;
-
-uint32_t HsvToRgb(const blinkyColor_t &blinkyColor)
-{
-    uint8_t region, remainder, p, q, t;
-
-    if (blinkyColor.s == 0)
-    {
-        return blinkyColor.v << 16 | blinkyColor.v << 8 | blinkyColor.v;
-    }
-
-    region = blinkyColor.h / 43;
-    remainder = (blinkyColor.h - (region * 43)) * 6;
-
-    p = (blinkyColor.v * (255 - blinkyColor.s)) >> 8;
-    q = (blinkyColor.v * (255 - ((blinkyColor.s * remainder) >> 8))) >> 8;
-    t = (blinkyColor.v * (255 - ((blinkyColor.s * (255 - remainder)) >> 8))) >> 8;
-
-    switch (region)
-    {
-        case 0:
-            return blinkyColor.v << 16 | t << 8 | p;
-        case 1:
-            return q << 16 | blinkyColor.v << 8 | p;
-        case 2:
-            return p << 16 | blinkyColor.v << 8 | t;
-        case 3:
-            return p << 16 | q << 8 | blinkyColor.v;
-        case 4:
-            return t << 16 | p << 8 | blinkyColor.v;
-        default:
-            return blinkyColor.v << 16 | p << 8 | q;
-    }
-}
-
-void brightnessFadeLED(blinkyColor_t &blinkyColor, uint8_t start, uint8_t end)
-{
-    static uint8_t lightness = 0;
-    static int8_t dir = 1;
-
-    if (lightness <= start)
-    {
-        lightness = start;
-        dir = 1;
-    }
-    else if (lightness >= end)
-    {
-        lightness = end;
-        dir = -1;
-    }
-
-    lightness += dir;
-
-    blinkyColor.v = lightness;
-    WS281BsetLED(HsvToRgb(blinkyColor));
-}
-
-void hueFadeLED(blinkyColor_t &blinkyColor, uint16_t start, uint16_t end, uint8_t lightness, uint8_t count)
-{
-    static bool hueMode = true;
-
-    if (!hueMode)
-    {
-        blinkyColor.v--;
-        if (blinkyColor.v == 0)
-        {
-            hueMode = true;
-        }
-        WS281BsetLED(HsvToRgb(blinkyColor));
-    }
-    else
-    {
-        static uint16_t hue = 0;
-        static int8_t dir = 1;
-        if (start < end)
-        {
-            if (hue <= start)
-            {
-                hue = start;
-                dir = 1;
-            }
-            else if (hue >= end)
-            {
-                hue = end;
-                dir = -1;
-            }
-        }
-        else
-        {
-            if (hue >= start)
-            {
-                hue = start;
-                dir = -1;
-            }
-            else if (hue <= end)
-            {
-                hue = end;
-                dir = 1;
-            }
-        }
-
-        blinkyColor.h = hue % 256;
-        blinkyColor.v = lightness;
-        WS281BsetLED(HsvToRgb(blinkyColor));
-        hue += dir;
-        if (count != 0 && hue == start)
-        {
-            static uint8_t counter = 0;
-            counter++;
-            if (counter >= count)
-            {
-                counter = 0;
-                hueMode = false;
-            }
-        }
-    }
-}
-
-uint16_t flashLED(blinkyColor_t &blinkyColor, uint8_t onLightness, uint8_t offLightness, const uint8_t durations[], uint8_t durationCounts)
-{
-    static int counter = 0;
-
-    blinkyColor.v = counter % 2 == 0 ? onLightness : offLightness;
-    WS281BsetLED(HsvToRgb(blinkyColor));
-    if (counter >= durationCounts)
-    {
-        counter = 0;
-    }
-    return durations[counter++] * 10;
-}
-
 uint32_t toRGB(uint8_t c)
 {
   uint32_t r = c & 0xE0 ;
@@ -252,32 +135,111 @@ static enum {
     NORMAL = 1
 } blinkyState;
 
-constexpr uint8_t LEDSEQ_RADIO_FAILED[] = {  10, 10 }; // 100ms on, 100ms off (fast blink)
-constexpr uint8_t LEDSEQ_DISCONNECTED[] = { 50, 50 };  // 500ms on, 500ms off
-constexpr uint8_t LEDSEQ_NO_CROSSFIRE[] = {  10, 100 }; // 1 blink, 1s pause (one blink/s)
-constexpr uint8_t LEDSEQ_BINDING[] = { 10, 10, 10, 100 };   // 2x 100ms blink, 1s pause
-constexpr uint8_t LEDSEQ_MODEL_MISMATCH[] = { 10, 10, 10, 10, 10, 100 };   // 3x 100ms blink, 1s pause
-constexpr uint8_t LEDSEQ_UPDATE[] = { 20, 5, 5, 5, 5, 40 };   // 200ms on, 2x 50ms off/on, 400ms off
+// Keyframe brightness is perceived brightness, gamma corrected when shown
+#define LED_ON 224  // 75% of full power
+
+#define FLASH_ON(hue, ms) { hue, 255, LED_ON, 0, ms }
+#define FLASH_OFF(hue, ms) { hue, 255, 0, 0, ms }
+
+static constexpr ledKeyframe_t LEDSEQ_RADIO_FAILED[] = { FLASH_ON(0, 100), FLASH_OFF(0, 100) };    // fast blink
+static constexpr ledKeyframe_t LEDSEQ_DISCONNECTED[] = { FLASH_ON(10, 500), FLASH_OFF(10, 500) };
+static constexpr ledKeyframe_t LEDSEQ_NO_CROSSFIRE[] = { FLASH_ON(10, 100), FLASH_OFF(10, 1000) }; // one blink/s
+static constexpr ledKeyframe_t LEDSEQ_BINDING[] = {    // 2x 100ms blink, 1s pause
+    FLASH_ON(10, 100), FLASH_OFF(10, 100), FLASH_ON(10, 100), FLASH_OFF(10, 1000)
+};
+static constexpr ledKeyframe_t LEDSEQ_MODEL_MISMATCH[] = { // 3x 100ms blink, 1s pause
+    FLASH_ON(10, 100), FLASH_OFF(10, 100), FLASH_ON(10, 100), FLASH_OFF(10, 100), FLASH_ON(10, 100), FLASH_OFF(10, 1000)
+};
+static constexpr ledKeyframe_t LEDSEQ_UPDATE[] = {     // 200ms on, 2x 50ms off/on, 400ms off
+    FLASH_ON(172, 200), FLASH_OFF(172, 50), FLASH_ON(172, 50), FLASH_OFF(172, 50), FLASH_ON(172, 50), FLASH_OFF(172, 400)
+};
+static constexpr ledKeyframe_t LEDSEQ_BREATHE[] = {    // air rate colour fading in and out
+    { 0, 255, 136, LED_KEYFRAME_FADE | LED_KEYFRAME_BASE_HUE, 3200 },
+    { 0, 255, 0, LED_KEYFRAME_FADE | LED_KEYFRAME_BASE_HUE, 3200 }
+};
+static constexpr ledKeyframe_t LEDSEQ_WIFI_UPDATE[] = {    // Yellow->Green cross-fade
+    { 85, 255, 186, 0, 0 },
+    { 55, 255, 186, LED_KEYFRAME_FADE, 150 }, { 85, 255, 186, LED_KEYFRAME_FADE, 150 },
+    { 55, 255, 186, LED_KEYFRAME_FADE, 150 }, { 85, 255, 186, LED_KEYFRAME_FADE, 150 },
+    { 85, 255, 0, LED_KEYFRAME_FADE, 640 }
+};
+static constexpr ledKeyframe_t LEDSEQ_BLE_JOYSTICK[] = {   // Blue cross-fade
+    { 170, 255, 186, 0, 0 },
+    { 200, 255, 186, LED_KEYFRAME_FADE, 150 }, { 170, 255, 186, LED_KEYFRAME_FADE, 150 },
+    { 200, 255, 186, LED_KEYFRAME_FADE, 150 }, { 170, 255, 186, LED_KEYFRAME_FADE, 150 },
+    { 170, 255, 0, LED_KEYFRAME_FADE, 640 }
+};
+static constexpr ledKeyframe_t LEDSEQ_STARTUP[] = {
+    { 0, 255, 186, 0, 0 },
+    { 255, 255, 186, LED_KEYFRAME_FADE, 3000 },
+    { 255, 255, 0, LED_KEYFRAME_FADE, 300 }
+};
+
+static const ledEffect_t EFFECT_RADIO_FAILED = LED_EFFECT(LEDSEQ_RADIO_FAILED, true);
+static const ledEffect_t EFFECT_DISCONNECTED = LED_EFFECT(LEDSEQ_DISCONNECTED, true);
+static const ledEffect_t EFFECT_NO_CROSSFIRE = LED_EFFECT(LEDSEQ_NO_CROSSFIRE, true);
+static const ledEffect_t EFFECT_BINDING = LED_EFFECT(LEDSEQ_BINDING, true);
+static const ledEffect_t EFFECT_MODEL_MISMATCH = LED_EFFECT(LEDSEQ_MODEL_MISMATCH, true);
+static const ledEffect_t EFFECT_UPDATE = LED_EFFECT(LEDSEQ_UPDATE, true);
+static const ledEffect_t EFFECT_BREATHE = LED_EFFECT(LEDSEQ_BREATHE, true);
+static const ledEffect_t EFFECT_WIFI_UPDATE = LED_EFFECT(LEDSEQ_WIFI_UPDATE, true);
+static const ledEffect_t EFFECT_BLE_JOYSTICK = LED_EFFECT(LEDSEQ_BLE_JOYSTICK, true);
+static const ledEffect_t EFFECT_STARTUP = LED_EFFECT(LEDSEQ_STARTUP, false);
 
 #define NORMAL_UPDATE_INTERVAL 50
+#define STARTUP_LED_OFFSET 188  // ms, 16 steps of hue around the rainbow
 
-static blinkyColor_t blinkyColor;
+static LedAnimation animation;
+static const ledEffect_t *currentEffect;
+static blinkyColor_t currentColor;
+
+static int animationUpdate()
+{
+    const uint32_t now = millis();
+    animation.update(now);
+    WS281BsetLED(animation.getColor());
+    const uint16_t next = animation.nextUpdate(now);
+    return next == LED_ANIMATION_IDLE ? DURATION_NEVER : next;
+}
+
+static int playEffect(const ledEffect_t &effect, uint8_t baseHue = 0)
+{
+    // Only restart when it changes, so events don't restart the pattern
+    if (currentEffect != &effect || currentColor.h != baseHue)
+    {
+        currentEffect = &effect;
+        currentColor.h = baseHue;
+        animation.start(effect, baseHue, millis());
+    }
+    return animationUpdate();
+}
+
+static int showColor(uint8_t hue, uint8_t lightness)
+{
+    if (currentEffect != nullptr || currentColor.h != hue || currentColor.v != lightness)
+    {
+        currentEffect = nullptr;
+        currentColor.h = hue;
+        currentColor.v = lightness;
+        animation.setColor(currentColor, millis());
+    }
+    return animationUpdate();
+}
 
-static int blinkyUpdate() {
-    static constexpr uint8_t hueStepValue = 1;
-    static constexpr uint8_t lightnessStep = 5;
+static int blinkyUpdate()
+{
+    const uint32_t now = millis();
+    const bool changed = animation.update(now);
 
     if (pixelCount == 1)
     {
-        WS281BsetLED(HsvToRgb(blinkyColor));
+        WS281BsetLED(animation.getColor());
     }
-    else
+    else if (changed || !animation.isDone())
     {
-        blinkyColor_t c = blinkyColor;
         for (int i=0 ; i<bootLEDcount ; i++)
         {
-            c.h += 16;
-            auto color = HsvToRgb(c);
+            auto color = animation.getColorAt(now, (i + 1) * STARTUP_LED_OFFSET);
             if (OPT_WS2812_IS_GRB)
             {
                 stripgrb->SetPixelColor(bootLEDs[i], RgbColor(color >> 16, color >> 8, color));
@@ -296,40 +258,37 @@ static int blinkyUpdate() {
             striprgb->Show();
         }
     }
-    if ((int)blinkyColor.h + hueStepValue > 255) {
-        if ((int)blinkyColor.v - lightnessStep < 0) {
-            blinkyState = NORMAL;
-            if (pixelCount != 1)
-            {
-                if (OPT_WS2812_IS_GRB)
-                {
-                    stripgrb->ClearTo(RgbColor(0), 0, pixelCount-1);
-                }
-                else
-                {
-                    striprgb->ClearTo(RgbColor(0), 0, pixelCount-1);
-                }
-            }
-            #if defined(TARGET_TX)
-            setButtonColors(config.GetButtonActions(0)->val.color, config.GetButtonActions(1)->val.color);
-            #endif
+    if (animation.isDone()) {
+        blinkyState = NORMAL;
+        if (pixelCount != 1)
+        {
             if (OPT_WS2812_IS_GRB)
             {
-                stripgrb->Show();
+                stripgrb->ClearTo(RgbColor(0), 0, pixelCount-1);
             }
             else
             {
-                striprgb->Show();
+                striprgb->ClearTo(RgbColor(0), 0, pixelCount-1);
             }
-            return NORMAL_UPDATE_INTERVAL;
+            statusColor = 0;
         }
-        blinkyColor.v -= lightnessStep;
-    } else {
-        blinkyColor.h += hueStepValue;
+        #if defined(TARGET_TX)
+        setButtonColors(config.GetButtonActions(0)->val.color, config.GetButtonActions(1)->val.color);
+        #endif
+        if (OPT_WS2812_IS_GRB)
+        {
+            stripgrb->Show();
+        }
+        else
+        {
+            striprgb->Show();
+        }
+        pixelsDirty = false;
+        return NORMAL_UPDATE_INTERVAL;
     }
-    return 3000/(256/hueStepValue);
+    // the other boot LEDs are ahead of the first, so keep ticking through its holds
+    return pixelCount == 1 ? animation.nextUpdate(now) : LED_ANIMATION_TICK;
 }
-
 static bool initialize()
 {
     if (GPIO_PIN_LED_WS2812 != UNDEF_PIN)
@@ -338,13 +297,13 @@ static bool initialize()
         statusLEDcount = WS2812_STATUS_LEDS_COUNT;
         if (statusLEDcount == 0)
         {
-            statusLEDs = new uint8_t[1];
+            statusLEDs = newSetupArray<uint8_t>(1);
             statusLEDs[0] = 0;
             statusLEDcount = 1;
         }
         else
         {
-            statusLEDs = new uint8_t[statusLEDcount];
+            statusLEDs = newSetupArray<uint8_t>(statusLEDcount);
             for (int i=0 ; i<statusLEDcount ; i++)
             {
                 statusLEDs[i] = WS2812_STATUS_LEDS[i];
@@ -353,7 +312,7 @@ static bool initialize()
         }
 
         vtxLEDcount = WS2812_VTX_STATUS_LEDS_COUNT;
-        vtxStatusLEDs = new uint8_t[vtxLEDcount];
+        vtxStatusLEDs = newSetupArray<uint8_t>(vtxLEDcount);
         for (int i=0 ; i<vtxLEDcount ; i++)
         {
             vtxStatusLEDs[i] = WS2812_VTX_STATUS_LEDS[i];
@@ -368,7 +327,7 @@ static bool initialize()
         }
         else
         {
-            bootLEDs = new uint8_t[bootLEDcount];
+            bootLEDs = newSetupArray<uint8_t>(bootLEDcount);
             for (int i=0 ; i<bootLEDcount ; i++)
             {
                 bootLEDs[i] = WS2812_BOOT_LEDS[i];
@@ -376,9 +335,7 @@ static bool initialize()
             }
         }
         WS281Binit();
-        blinkyColor.h = 0;
-        blinkyColor.s = 255;
-        blinkyColor.v = 128;
+        currentColor.s = 255;
     }
     return GPIO_PIN_LED_WS2812 != UNDEF_PIN;
 }
@@ -403,60 +360,50 @@ static int timeout()
 {
     if (blinkyState == STARTUP && connectionState < FAILURE_STATES)
     {
+        if (currentEffect != &EFFECT_STARTUP)
+        {
+            currentEffect = &EFFECT_STARTUP;
+            animation.start(EFFECT_STARTUP, 0, millis());
+        }
         return blinkyUpdate();
     }
 #if defined(TARGET_RX)
     if (InBindingMode)
     {
-        blinkyColor.h = 10;
-        return flashLED(blinkyColor, 192, 0, LEDSEQ_BINDING, sizeof(LEDSEQ_BINDING));
+        return playEffect(EFFECT_BINDING);
     }
 #endif
+    const uint8_t rateHue = ExpressLRS_currAirRate_Modparams->index * 256 / RATE_MAX;
     switch (connectionState)
     {
     case connected:
 #if defined(TARGET_RX)
         if (!connectionHasModelMatch || !teamraceHasModelMatch)
         {
-            blinkyColor.h = 10;
-            return flashLED(blinkyColor, 192, 0, LEDSEQ_MODEL_MISMATCH, sizeof(LEDSEQ_MODEL_MISMATCH));
+            return playEffect(EFFECT_MODEL_MISMATCH);
         }
 #endif
         // Set the color and we're done!
-        blinkyColor.h = ExpressLRS_currAirRate_Modparams->index * 256 / RATE_MAX;
-        blinkyColor.v = fmap(POWERMGNT::currPower(), 0, PWR_COUNT-1, 10, 128);
-        WS281BsetLED(HsvToRgb(blinkyColor));
-        return DURATION_NEVER;
+        return showColor(rateHue, fmap(POWERMGNT::currPower(), 0, PWR_COUNT-1, 59, 186));
     case tentative:
         // Set the color and we're done!
-        blinkyColor.h = ExpressLRS_currAirRate_Modparams->index * 256 / RATE_MAX;
-        blinkyColor.v = fmap(POWERMGNT::currPower(), 0, PWR_COUNT-1, 10, 50);
-        WS281BsetLED(HsvToRgb(blinkyColor));
-        return DURATION_NEVER;
+        return showColor(rateHue, fmap(POWERMGNT::currPower(), 0, PWR_COUNT-1, 59, 122));
     case disconnected:
 #if defined(TARGET_RX)
-        blinkyColor.h = 10;
-        return flashLED(blinkyColor, 192, 0, LEDSEQ_DISCONNECTED, sizeof(LEDSEQ_DISCONNECTED));
+        return playEffect(EFFECT_DISCONNECTED);
 #else
-        blinkyColor.h = ExpressLRS_currAirRate_Modparams->index * 256 / RATE_MAX;
-        brightnessFadeLED(blinkyColor, 0, 64);
-        return NORMAL_UPDATE_INTERVAL;
+        return playEffect(EFFECT_BREATHE, rateHue);
 #endif
     case wifiUpdate:
-        hueFadeLED(blinkyColor, 85, 85-30, 128, 2);      // Yellow->Green cross-fade
-        return 5;
+        return playEffect(EFFECT_WIFI_UPDATE);
     case serialUpdate:
-        blinkyColor.h = 172;
-        return flashLED(blinkyColor, 192, 0, LEDSEQ_UPDATE, sizeof(LEDSEQ_UPDATE));
+        return playEffect(EFFECT_UPDATE);
     case bleJoystick:
-        hueFadeLED(blinkyColor, 170, 170+30, 128, 2);    // Blue cross-fade
-        return 5;
+        return playEffect(EFFECT_BLE_JOYSTICK);
     case radioFailed:
-        blinkyColor.h = 0;
-        return flashLED(blinkyColor, 192, 0, LEDSEQ_RADIO_FAILED, sizeof(LEDSEQ_RADIO_FAILED));
+        return playEffect(EFFECT_RADIO_FAILED);
     case noCrossfire:
-        blinkyColor.h = 10;
-        return flashLED(blinkyColor, 192, 0, LEDSEQ_NO_CROSSFIRE, sizeof(LEDSEQ_NO_CROSSFIRE));
+        return playEffect(EFFECT_NO_CROSSFIRE);
     default:
         return DURATION_NEVER;
     }
@@ -469,3 +416,4 @@ device_t RGB_device = {
     .timeout = timeout,
     .subscribe = EVENT_CONNECTION_CHANGED | EVENT_ENTER_BIND_MODE | EVENT_EXIT_BIND_MODE
 };
+#endif
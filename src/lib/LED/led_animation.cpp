@@ -0,0 +1,231 @@
+#include "led_animation.h"
+
+#include <stdlib.h>
+
+// out = 255 * (in / 255) ^ 2.2
+static const uint8_t gammaLut[256] = {
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   1,
+      1,   1,   1,   1,   1,   1,   1,   1,   1,   2,   2,   2,   2,   2,   2,   2,
+      3,   3,   3,   3,   3,   4,   4,   4,   4,   5,   5,   5,   5,   6,   6,   6,
+      6,   7,   7,   7,   8,   8,   8,   9,   9,   9,  10,  10,  11,  11,  11,  12,
+     12,  13,  13,  13,  14,  14,  15,  15,  16,  16,  17,  17,  18,  18,  19,  19,
+     20,  20,  21,  22,  22,  23,  23,  24,  25,  25,  26,  26,  27,  28,  28,  29,
+     30,  30,  31,  32,  33,  33,  34,  35,  35,  36,  37,  38,  39,  39,  40,  41,
+     42,  43,  43,  44,  45,  46,  47,  48,  49,  49,  50,  51,  52,  53,  54,  55,
+     56,  57,  58,  59,  60,  61,  62,  63,  64,  65,  66,  67,  68,  69,  70,  71,
+     73,  74,  75,  76,  77,  78,  79,  81,  82,  83,  84,  85,  87,  88,  89,  90,
+     91,  93,  94,  95,  97,  98,  99, 100, 102, 103, 105, 106, 107, 109, 110, 111,
+    113, 114, 116, 117, 119, 120, 121, 123, 124, 126, 127, 129, 130, 132, 133, 135,
+    137, 138, 140, 141, 143, 145, 146, 148, 149, 151, 153, 154, 156, 158, 159, 161,
+    163, 165, 166, 168, 170, 172, 173, 175, 177, 179, 181, 182, 184, 186, 188, 190,
+    192, 194, 196, 197, 199, 201, 203, 205, 207, 209, 211, 213, 215, 217, 219, 221,
+    223, 225, 227, 229, 231, 234, 236, 238, 240, 242, 244, 246, 248, 251, 253, 255
+};
+
+uint32_t HsvToRgb(const blinkyColor_t &blinkyColor)
+{
+    uint8_t region, remainder, p, q, t;
+
+    if (blinkyColor.s == 0)
+    {
+        return blinkyColor.v << 16 | blinkyColor.v << 8 | blinkyColor.v;
+    }
+
+    region = blinkyColor.h / 43;
+    remainder = (blinkyColor.h - (region * 43)) * 6;
+
+    p = (blinkyColor.v * (255 - blinkyColor.s)) >> 8;
+    q = (blinkyColor.v * (255 - ((blinkyColor.s * remainder) >> 8))) >> 8;
+    t = (blinkyColor.v * (255 - ((blinkyColor.s * (255 - remainder)) >> 8))) >> 8;
+
+    switch (region)
+    {
+        case 0:
+            return blinkyColor.v << 16 | t << 8 | p;
+        case 1:
+            return q << 16 | blinkyColor.v << 8 | p;
+        case 2:
+            return p << 16 | blinkyColor.v << 8 | t;
+        case 3:
+            return p << 16 | q << 8 | blinkyColor.v;
+        case 4:
+            return t << 16 | p << 8 | blinkyColor.v;
+        default:
+            return blinkyColor.v << 16 | p << 8 | q;
+    }
+}
+
+uint32_t GammaCorrect(uint32_t rgb)
+{
+    return (uint32_t)gammaLut[(rgb >> 16) & 0xFF] << 16 | (uint32_t)gammaLut[(rgb >> 8) & 0xFF] << 8 | gammaLut[rgb & 0xFF];
+}
+
+void LedAnimation::addStep(const blinkyColor_t &color, bool fade, uint16_t duration)
+{
+    if (m_count == LED_ANIMATION_MAX_STEPS)
+        return;
+    const uint32_t rgb = HsvToRgb(color);
+    ledStep_t &step = m_steps[m_count++];
+    step.r = rgb >> 16;
+    step.g = rgb >> 8;
+    step.b = rgb;
+    step.fade = fade;
+    step.duration = duration;
+    m_total += duration;
+}
+
+void LedAnimation::start(const ledEffect_t &effect, uint8_t baseHue, uint32_t now)
+{
+    m_count = 0;
+    m_total = 0;
+    m_loop = effect.loop;
+
+    blinkyColor_t prev;
+    const ledKeyframe_t &first = effect.keyframes[effect.loop ? effect.count - 1 : 0];
+    prev.h = first.flags & LED_KEYFRAME_BASE_HUE ? baseHue : first.h;
+    prev.s = first.s;
+    prev.v = effect.loop ? first.v : 0;
+
+    for (uint8_t i = 0; i < effect.count; i++)
+    {
+        const ledKeyframe_t &keyframe = effect.keyframes[i];
+        blinkyColor_t color = {keyframe.flags & LED_KEYFRAME_BASE_HUE ? baseHue : keyframe.h, keyframe.s, keyframe.v};
+        if (keyframe.flags & LED_KEYFRAME_FADE)
+        {
+            // The hue of black does not matter, only fade the brightness
+            if (prev.v == 0)
+                prev.h = color.h;
+            else if (color.v == 0)
+                color.h = prev.h;
+
+            // A straight line in RGB between two hues cuts across the colour wheel. Each sixth of the
+            // wheel is a straight line though, so split hue fades where they go round a corner.
+            const int16_t dh = color.h - prev.h;
+            const int16_t ds = color.s - prev.s;
+            const int16_t dv = color.v - prev.v;
+            int16_t hue = prev.h;
+            uint16_t elapsed = 0;
+            do
+            {
+                int16_t next = dh > 0 ? (hue / 43 + 1) * 43 : hue > 0 ? (hue - 1) / 43 * 43 : 0;
+                if (dh == 0 || (dh > 0 && next > color.h) || (dh < 0 && next < color.h))
+                    next = color.h;
+                const int16_t part = dh == 0 ? 1 : next - prev.h;
+                const int16_t whole = dh == 0 ? 1 : dh;
+                const blinkyColor_t mid = {
+                    (uint8_t)next,
+                    (uint8_t)(prev.s + ds * part / whole),
+                    (uint8_t)(prev.v + dv * part / whole)};
+                const uint16_t end = (int32_t)keyframe.duration * part / whole;
+                addStep(mid, true, end - elapsed);
+                elapsed = end;
+                hue = next;
+            } while (hue != color.h);
+        }
+        else
+        {
+            addStep(color, false, keyframe.duration);
+        }
+        prev = color;
+    }
+
+    if (m_total == 0)
+        m_loop = false;
+    m_start = now;
+    m_stepStart = now;
+    m_step = 0;
+    m_done = false;
+}
+
+void LedAnimation::setColor(const blinkyColor_t &color, uint32_t now)
+{
+    m_count = 0;
+    m_total = 0;
+    m_loop = false;
+    addStep(color, false, 0);
+    m_start = now;
+    m_stepStart = now;
+    m_step = 0;
+    m_done = false;
+}
+
+uint32_t LedAnimation::interpolate(uint8_t step, uint32_t elapsed) const
+{
+    const ledStep_t &to = m_steps[step];
+    if (!to.fade || elapsed >= to.duration)
+        return to.r << 16 | to.g << 8 | to.b;
+
+    static const ledStep_t black = {0, 0, 0, false, 0};
+    const ledStep_t &from = step > 0 ? m_steps[step - 1] : m_loop ? m_steps[m_count - 1] : black;
+    const uint8_t r = from.r + ((int32_t)to.r - from.r) * (int32_t)elapsed / to.duration;
+    const uint8_t g = from.g + ((int32_t)to.g - from.g) * (int32_t)elapsed / to.duration;
+    const uint8_t b = from.b + ((int32_t)to.b - from.b) * (int32_t)elapsed / to.duration;
+    return r << 16 | g << 8 | b;
+}
+
+bool LedAnimation::update(uint32_t now)
+{
+    if (m_count == 0)
+        return false;
+
+    uint32_t elapsed = now - m_stepStart;
+    if (!m_done)
+    {
+        if (m_loop && elapsed >= m_total)
+        {
+            // Late by whole loops, skip them
+            const uint32_t skip = elapsed - elapsed % m_total;
+            elapsed -= skip;
+            m_stepStart += skip;
+        }
+        while (elapsed >= m_steps[m_step].duration)
+        {
+            if (m_step == m_count - 1 && !m_loop)
+            {
+                m_done = true;
+                break;
+            }
+            elapsed -= m_steps[m_step].duration;
+            m_stepStart += m_steps[m_step].duration;
+            m_step = (m_step + 1) % m_count;
+        }
+    }
+
+    const uint32_t color = GammaCorrect(interpolate(m_step, elapsed));
+    const bool changed = color != m_lastColor;
+    m_lastColor = color;
+    return changed;
+}
+
+uint32_t LedAnimation::colorAt(uint32_t elapsed) const
+{
+    if (m_loop)
+        elapsed %= m_total;
+    for (uint8_t step = 0; step < m_count; step++)
+    {
+        if (elapsed < m_steps[step].duration)
+            return GammaCorrect(interpolate(step, elapsed));
+        elapsed -= m_steps[step].duration;
+    }
+    return GammaCorrect(interpolate(m_count - 1, UINT32_MAX));
+}
+
+uint32_t LedAnimation::getColorAt(uint32_t now, uint16_t ahead) const
+{
+    if (m_count == 0)
+        return 0;
+    return colorAt(now - m_start + ahead);
+}
+
+uint16_t LedAnimation::nextUpdate(uint32_t now) const
+{
+    if (m_done || m_count == 0)
+        return LED_ANIMATION_IDLE;
+
+    const ledStep_t &step = m_steps[m_step];
+    const uint32_t elapsed = now - m_stepStart;
+    const uint16_t remaining = elapsed < step.duration ? step.duration - elapsed : 0;
+    if (step.fade && remaining > LED_ANIMATION_TICK)
+        return LED_ANIMATION_TICK;
+    return remaining;
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * Keyframe animations for the RGB status LEDs.
+ *
+ * An effect is a table of HSV keyframes. When an effect is started it is compiled into a short
+ * table of RGB steps (hue fades are split at the corners of the colour wheel so they still go
+ * around it), so each tick is a single linear interpolation and a gamma table lookup.
+ * Keyframe brightness is perceived brightness, the gamma correction makes fades look even.
+ */
+
+#define LED_KEYFRAME_FADE       (1 << 0)    // fade from the previous keyframe over duration, otherwise hold for duration
+#define LED_KEYFRAME_BASE_HUE   (1 << 1)    // use the hue passed to start() instead of h
+
+#define LED_ANIMATION_TICK      20          // ms between updates while fading
+#define LED_ANIMATION_MAX_STEPS 48
+#define LED_ANIMATION_IDLE      0xFFFF      // nextUpdate() when the colour will not change again
+
+typedef struct {
+    uint8_t h, s, v;
+} blinkyColor_t;
+
+typedef struct {
+    uint8_t h, s, v;
+    uint8_t flags;
+    uint16_t duration;  // ms
+} ledKeyframe_t;
+
+typedef struct {
+    const ledKeyframe_t *keyframes;
+    uint8_t count;
+    bool loop;
+} ledEffect_t;
+
+#define LED_EFFECT(keyframes, loop) { keyframes, sizeof(keyframes) / sizeof(keyframes[0]), loop }
+
+uint32_t HsvToRgb(const blinkyColor_t &blinkyColor);
+uint32_t GammaCorrect(uint32_t rgb);
+
+class LedAnimation
+{
+public:
+    LedAnimation() : m_count(0), m_total(0), m_start(0), m_step(0), m_stepStart(0), m_done(true), m_lastColor(0) {}
+
+    // Compile the effect and start playing it from now
+    void start(const ledEffect_t &effect, uint8_t baseHue, uint32_t now);
+    // Show a fixed colour
+    void setColor(const blinkyColor_t &color, uint32_t now);
+
+    // Advance to now, returns true if the colour is different from the last update
+    bool update(uint32_t now);
+    // Gamma corrected 0xRRGGBB as of the last update
+    uint32_t getColor() const { return m_lastColor; }
+    // Gamma corrected colour ahead ms further into the effect than now, for other LEDs in a chase
+    uint32_t getColorAt(uint32_t now, uint16_t ahead) const;
+    // ms until the colour changes again, LED_ANIMATION_IDLE if it never will
+    uint16_t nextUpdate(uint32_t now) const;
+    bool isDone() const { return m_done; }
+
+private:
+    typedef struct {
+        uint8_t r, g, b;
+        bool fade;
+        uint16_t duration;
+    } ledStep_t;
+
+    ledStep_t m_steps[LED_ANIMATION_MAX_STEPS];
+    uint8_t m_count;
+    bool m_loop;
+    uint32_t m_total;
+    uint32_t m_start;
+
+    uint8_t m_step;
+    uint32_t m_stepStart;
+    bool m_done;
+    uint32_t m_lastColor;
+
+    void addStep(const blinkyColor_t &color, bool fade, uint16_t duration);
+    uint32_t interpolate(uint8_t step, uint32_t elapsed) const;
+    uint32_t colorAt(uint32_t elapsed) const;
+};
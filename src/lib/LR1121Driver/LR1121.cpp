@@ -7,9 +7,120 @@
 #include <SPIEx.h>
 
 #define LR1121_FIRMWARE_TYPE 0xF3
+#define LR1121_FIRMWARE_IMAGE_ID 0xE79ABD5A     // lr1121ImageId() of lr11xx_firmware_image 0xF30104, see test_lr1121_update
+#define LR1121_UPDATE_PROGRESS_FILE "/lr1121-update.bin"
+#define LR11XX_CMD_STATUS_OK 2                  // stat1 command status when the command worked
+
+static_assert(sizeof(lr11xx_firmware_image) == LR11XX_FIRMWARE_IMAGE_SIZE * 4, "LR1121 firmware image is not the size it claims");
+static_assert(LR11XX_FIRMWARE_VERSION == 0x0104, "LR1121 firmware image is not the version LR1121_FIRMWARE_IMAGE_ID is for");
 
 LR1121Hal hal;
 LR1121Driver *LR1121Driver::instance = NULL;
+static_assert(SX12xxDriverCheck<LR1121Driver>::value, "LR1121Driver does not have the whole radio interface");
+
+// The LR1121's bootloader commands, for LR1121Update
+class LR1121BootloaderHal : public LR1121Bootloader
+{
+public:
+    explicit LR1121BootloaderHal(const SX12XX_Radio_Number_t radioNumber) : radioNumber(radioNumber) {}
+
+    firmware_version_t getVersion() override
+    {
+        return LR1121Driver::instance->GetFirmwareVersion(radioNumber);
+    }
+
+    void enterBootloader() override
+    {
+        DBGLN("Reboot 1121 to bootloader mode");
+        uint8_t mode = 3;
+        hal.WriteCommand(LR11XX_SYSTEM_REBOOT_OC, &mode, 1, radioNumber);
+        waitOnBusy(10);
+    }
+
+    bool erase() override
+    {
+        DBGLN("Erasing");
+        hal.WriteCommand(LR11XX_BL_ERASE_FLASH_OC, radioNumber);
+        waitOnBusy(100);
+        return commandOk();
+    }
+
+    bool writeBlock(const uint32_t offset, const uint8_t *data, const uint16_t size) override
+    {
+        packet[0] = (uint8_t)(LR11XX_BL_WRITE_FLASH_ENCRYPTED_OC >> 8);
+        packet[1] = (uint8_t)(LR11XX_BL_WRITE_FLASH_ENCRYPTED_OC);
+        packet[2] = (uint8_t)(offset >> 24);
+        packet[3] = (uint8_t)(offset >> 16);
+        packet[4] = (uint8_t)(offset >> 8);
+        packet[5] = (uint8_t)(offset);
+        memcpy(packet + 6, data, size);
+
+        // Have to do this the OLD way, so we can pump out more than 64 bytes in one message
+        const int nss = radioNumber == SX12XX_Radio_1 ? GPIO_PIN_NSS : GPIO_PIN_NSS_2;
+        hal.WaitOnBusy(radioNumber);
+        SPIEx.setHwCs(false);
+        pinMode(nss, OUTPUT);
+        digitalWrite(nss, LOW);
+        SPIEx.transferBytes(packet, nullptr, 6 + size);
+        digitalWrite(nss, HIGH);
+        SPIEx.setHwCs(true);
+        if (GPIO_PIN_NSS_2 != UNDEF_PIN)
+        {
+            spiAttachSS(SPIEx.bus(), 1, GPIO_PIN_NSS_2);
+        }
+
+        waitOnBusy(1);
+        return commandOk();
+    }
+
+    void reboot() override
+    {
+        DBGLN("Reboot LR1121");
+        uint8_t buf = 0;
+        hal.WriteCommand(LR11XX_BL_REBOOT_OC, &buf, 1, radioNumber);
+        waitOnBusy(1);
+    }
+
+    bool loadProgress(lr1121UpdateProgress_t &progress) override
+    {
+        File file = SPIFFS.open(LR1121_UPDATE_PROGRESS_FILE, "r");
+        const bool found = file && file.read((uint8_t *)&progress, sizeof(progress)) == sizeof(progress);
+        file.close();
+        return found;
+    }
+
+    void saveProgress(const lr1121UpdateProgress_t &progress) override
+    {
+        if (progress.imageId == 0)
+        {
+            SPIFFS.remove(LR1121_UPDATE_PROGRESS_FILE);
+            return;
+        }
+        File file = SPIFFS.open(LR1121_UPDATE_PROGRESS_FILE, "w");
+        file.write((const uint8_t *)&progress, sizeof(progress));
+        file.close();
+    }
+
+private:
+    const SX12XX_Radio_Number_t radioNumber;
+    WORD_ALIGNED_ATTR uint8_t packet[6 + LR1121_UPDATE_BLOCK_SIZE];
+
+    void waitOnBusy(const uint32_t delayMs)
+    {
+        while (!hal.WaitOnBusy(radioNumber))
+        {
+            delay(delayMs);
+        }
+    }
+
+    // The status of the last command is clocked out with the opcode of the next
+    bool commandOk()
+    {
+        uint8_t status[6] = {(uint8_t)(LR11XX_BL_GET_STATUS_OC >> 8), (uint8_t)LR11XX_BL_GET_STATUS_OC};
+        hal.ReadCommand(status, sizeof(status), radioNumber);
+        return ((status[0] >> 1) & 0x07) == LR11XX_CMD_STATUS_OK;
+    }
+};
 
 //DEBUG_LR1121_OTA_TIMING
 
@@ -36,36 +147,22 @@ void LR1121Driver::End()
 
 bool LR1121Driver::CheckVersion(const SX12XX_Radio_Number_t radioNumber)
 {
-    firmware_version_t version = GetFirmwareVersion(radioNumber);
-    if (!SPIFFS.exists("/lr1121.txt") && (version.type != LR1121_FIRMWARE_TYPE || version.version != LR11XX_FIRMWARE_VERSION))
+    const firmware_version_t version = GetFirmwareVersion(radioNumber);
+    // A radio left in the bootloader by an update that did not finish is always upgraded
+    if (version.type == LR1121_BOOTLOADER_TYPE ||
+        (!SPIFFS.exists("/lr1121.txt") && (version.type != LR1121_FIRMWARE_TYPE || version.version != LR11XX_FIRMWARE_VERSION)))
     {
         DBGLN("Upgrading radio #%d", radioNumber);
-        // do upgrade
-        if (BeginUpdate(radioNumber, sizeof(lr11xx_firmware_image)) != 0) return false;
-        uint8_t dest[256];
-        for (int pos = 0 ; pos < sizeof(lr11xx_firmware_image) / 4 ; pos += 64)
-        {
-            uint32_t size = 256;
-            if (pos + 63 > sizeof(lr11xx_firmware_image) / 4) size = sizeof(lr11xx_firmware_image) % 256;
-            memcpy(dest, lr11xx_firmware_image + pos, size);
-
-            for (size_t i = 0; i < size; i += 4)
-            {
-                const auto ptr = (uint32_t *)&dest[i];
-                *ptr = __builtin_bswap32(*ptr);
-            }
-            WriteUpdateBytes(dest, size);
-        }
-
-        if (EndUpdate() != 0) return false;
-
-        // re-check version
-        version = GetFirmwareVersion(radioNumber);
-        if (version.type != LR1121_FIRMWARE_TYPE && version.version != LR11XX_FIRMWARE_VERSION)
+        LR1121BootloaderHal bootloader(radioNumber);
+        LR1121Update update(bootloader);
+        const firmware_version_t expected = {0, LR1121_FIRMWARE_TYPE, LR11XX_FIRMWARE_VERSION};
+        const lr1121UpdateResult_e result = update.flash(lr11xx_firmware_image, LR11XX_FIRMWARE_IMAGE_SIZE, LR1121_FIRMWARE_IMAGE_ID, expected);
+        if (result != LR1121_UPDATE_OK)
         {
-            DBGLN("LR1121 #%d failed to be detected or upgraded.", radioNumber);
+            DBGLN("LR1121 #%d failed to be upgraded: %s", radioNumber, LR1121Update::errorString(result));
             return false;
         }
+        DBGLN("LR1121 #%d upgraded, %u blocks written", radioNumber, update.blocksWritten());
     }
     DBGLN("LR1121 #%d Ready", radioNumber);
     return true;
@@ -276,7 +373,29 @@ void LR1121Driver::SetDioAsRfSwitch()
     hal.WriteCommand(LR11XX_SYSTEM_SET_DIO_AS_RF_SWITCH_OC, switchbuf, sizeof(switchbuf), SX12XX_Radio_All);
 }
 
-void LR1121Driver::CorrectRegisterForSF6(uint8_t sf, SX12XX_Radio_Number_t radioNumber)
+/***
+ * @brief: Change the LoRa modulation and preamble without a full Config(), the packet type,
+ * band, payload length and IQ stay as they are so this can be called from the timer ISR.
+ ***/
+void ICACHE_RAM_ATTR LR1121Driver::SetModulation(uint8_t bw, uint8_t sf, uint8_t cr, uint8_t PreambleLength, SX12XX_Radio_Number_t radioNumber)
+{
+    if (useFSK)
+        return;
+
+    // IQinverted is always STANDARD for 900
+    const bool isSubGHz = (radioNumber & SX12XX_Radio_1) ? radio1isSubGHz : radio2isSubGHz;
+    const lr11xx_radio_lora_iq_t inverted = (IQinverted && !isSubGHz) ? LR11XX_RADIO_LORA_IQ_INVERTED : LR11XX_RADIO_LORA_IQ_STANDARD;
+
+    SetMode(LR1121_MODE_STDBY_RC, radioNumber);
+    ConfigModParamsLoRa(bw, sf, cr, radioNumber);
+#if defined(DEBUG_FREQ_CORRECTION)
+    SetPacketParamsLoRa(PreambleLength, LR1121_LORA_PACKET_VARIABLE_LENGTH, PayloadLength, inverted, radioNumber);
+#else
+    SetPacketParamsLoRa(PreambleLength, LR1121_LORA_PACKET_FIXED_LENGTH, PayloadLength, inverted, radioNumber);
+#endif
+}
+
+void ICACHE_RAM_ATTR LR1121Driver::CorrectRegisterForSF6(uint8_t sf, SX12XX_Radio_Number_t radioNumber)
 {
     // 8.3.1 SetModulationParams
     // - SF6 can be made compatible with the SX127x family in implicit mode via a register setting.
@@ -465,7 +584,7 @@ void LR1121Driver::SetMode(lr11xx_RadioOperatingModes_t OPmode, SX12XX_Radio_Num
     }
 }
 
-void LR1121Driver::ConfigModParamsLoRa(uint8_t bw, uint8_t sf, uint8_t cr, SX12XX_Radio_Number_t radioNumber)
+void ICACHE_RAM_ATTR LR1121Driver::ConfigModParamsLoRa(uint8_t bw, uint8_t sf, uint8_t cr, SX12XX_Radio_Number_t radioNumber)
 {
     // 8.3.1 SetModulationParams
     uint8_t buf[4];
@@ -485,7 +604,7 @@ void LR1121Driver::ConfigModParamsLoRa(uint8_t bw, uint8_t sf, uint8_t cr, SX12X
     }
 }
 
-void LR1121Driver::SetPacketParamsLoRa(uint8_t PreambleLength, lr11xx_RadioLoRaPacketLengthsModes_t HeaderType,
+void ICACHE_RAM_ATTR LR1121Driver::SetPacketParamsLoRa(uint8_t PreambleLength, lr11xx_RadioLoRaPacketLengthsModes_t HeaderType,
                                        uint8_t PayloadLength, uint8_t InvertIQ, SX12XX_Radio_Number_t radioNumber)
 {
     // 8.3.2 SetPacketParams
@@ -817,14 +936,9 @@ void ICACHE_RAM_ATTR LR1121Driver::IsrCallback(SX12XX_Radio_Number_t radioNumber
 }
 
 struct lr1121UpdateState_s {
-    size_t expectedFilesize;
-    size_t totalSize;
-    SX12XX_Radio_Number_t updatingRadio;
-    size_t left_over;
-    struct {
-        uint8_t header[6];
-        uint8_t buffer[256];
-    } __attribute__((packed)) packet;
+    explicit lr1121UpdateState_s(const SX12XX_Radio_Number_t radioNumber) : bootloader(radioNumber), update(bootloader) {}
+    LR1121BootloaderHal bootloader;
+    LR1121Update update;
 };
 
 static lr1121UpdateState_s *lr1121UpdateState;
@@ -843,133 +957,33 @@ firmware_version_t LR1121Driver::GetFirmwareVersion(const SX12XX_Radio_Number_t
     };
 }
 
-int LR1121Driver::BeginUpdate(const SX12XX_Radio_Number_t radioNumber, const uint32_t expectedSize)
+lr1121UpdateResult_e LR1121Driver::BeginUpdate(const SX12XX_Radio_Number_t radioNumber, const uint32_t expectedSize)
 {
-    lr1121UpdateState = new lr1121UpdateState_s;
-    lr1121UpdateState->expectedFilesize = expectedSize;
-    lr1121UpdateState->updatingRadio = radioNumber;
-    lr1121UpdateState->totalSize = 0;
-    lr1121UpdateState->left_over = 0;
-
-    // Reboot to BL mode
-    DBGLN("Reboot 1121 to bootloader mode");
-    uint8_t mode = 3;
-    hal.WriteCommand(LR11XX_SYSTEM_REBOOT_OC, &mode, 1, radioNumber);
-    while(!hal.WaitOnBusy(radioNumber))
-    {
-        DBGLN("Waiting...");
-        delay(10);
-    }
-
-    // Ensure we're in BL mode
-    DBGLN("Ensure BL mode");
-    const firmware_version_t version = GetFirmwareVersion(radioNumber, LR11XX_BL_GET_VERSION_OC);
-    if (version.type != 0xDF)
-    {
-        DBGLN("%x", version);
-        return -1;  // Not in bootloader mode
-    }
-
-    // Erase flash
-    DBGLN("Erasing");
-    hal.WriteCommand(LR11XX_BL_ERASE_FLASH_OC, radioNumber);
-    while(!hal.WaitOnBusy(radioNumber))
-    {
-        DBGLN("Waiting...");
-        delay(100);
-    }
-    DBGLN("Erased");
-
-    lr1121UpdateState->left_over = 0;
-    SPIEx.setHwCs(false);
-
-    pinMode(radioNumber == SX12XX_Radio_1 ? GPIO_PIN_NSS : GPIO_PIN_NSS_2, OUTPUT);
-    digitalWrite(radioNumber == SX12XX_Radio_1 ? GPIO_PIN_NSS : GPIO_PIN_NSS_2, HIGH);
-    return 0;
-}
-
-static void writeBytes(const uint8_t *data, const uint32_t data_size) {
-    lr1121UpdateState->packet.header[0] = (uint8_t)(LR11XX_BL_WRITE_FLASH_ENCRYPTED_OC >> 8);
-    lr1121UpdateState->packet.header[1] = (uint8_t)(LR11XX_BL_WRITE_FLASH_ENCRYPTED_OC);
-    lr1121UpdateState->packet.header[2] = (uint8_t)(lr1121UpdateState->totalSize >> 24);
-    lr1121UpdateState->packet.header[3] = (uint8_t)(lr1121UpdateState->totalSize >> 16);
-    lr1121UpdateState->packet.header[4] = (uint8_t)(lr1121UpdateState->totalSize >> 8);
-    lr1121UpdateState->packet.header[5] = (uint8_t)(lr1121UpdateState->totalSize);
-
-    uint32_t write_size = lr1121UpdateState->left_over;
-    if (data != nullptr)
-    {
-        DBGLN("Left %d, new %d", lr1121UpdateState->left_over, data_size);
-        memcpy(lr1121UpdateState->packet.buffer + lr1121UpdateState->left_over, data, data_size);
-        write_size += data_size;
-    }
-    DBGLN("Flashing %d at %x", write_size, lr1121UpdateState->totalSize);
-
-    // Have to do this the OLD way, so we can pump out more than 64 bytes in one message
-    digitalWrite(lr1121UpdateState->updatingRadio == SX12XX_Radio_1 ? GPIO_PIN_NSS : GPIO_PIN_NSS_2, LOW);
-    SPIEx.transferBytes(lr1121UpdateState->packet.header, nullptr, 6 + write_size);
-    digitalWrite(lr1121UpdateState->updatingRadio == SX12XX_Radio_1 ? GPIO_PIN_NSS : GPIO_PIN_NSS_2, HIGH);
-
-    while (!hal.WaitOnBusy(lr1121UpdateState->updatingRadio))
-    {
-        delay(1);
-    }
-    lr1121UpdateState->totalSize += write_size;
-    lr1121UpdateState->left_over = 0;
-    DBGLN("Flashed");
+    delete lr1121UpdateState;
+    lr1121UpdateState = new lr1121UpdateState_s(radioNumber);
+    const lr1121UpdateResult_e result = lr1121UpdateState->update.begin(expectedSize);
+    DBGLN("Begin update: %s", LR1121Update::errorString(result));
+    return result;
 }
 
-int LR1121Driver::WriteUpdateBytes(const uint8_t *bytes, uint32_t size)
+lr1121UpdateResult_e LR1121Driver::WriteUpdateBytes(const uint8_t *bytes, const uint32_t size)
 {
-    while (size >= 256 - lr1121UpdateState->left_over)
+    if (lr1121UpdateState == nullptr)
     {
-        const uint32_t chunk_size = size > 256 - lr1121UpdateState->left_over ? 256 - lr1121UpdateState->left_over : size;
-        writeBytes(bytes, chunk_size);
-        size -= chunk_size;
-        bytes += chunk_size;
+        return LR1121_UPDATE_NOT_STARTED;
     }
-    memcpy(lr1121UpdateState->packet.buffer + lr1121UpdateState->left_over, bytes, size);
-    lr1121UpdateState->left_over += size;
-    DBGLN("Left-over %d", lr1121UpdateState->left_over);
-    return 0;
+    return lr1121UpdateState->update.write(bytes, size);
 }
 
-int LR1121Driver::EndUpdate()
+lr1121UpdateResult_e LR1121Driver::EndUpdate()
 {
-    int retCode = 0;
-    writeBytes(nullptr, 0);
-
-    SPIEx.setHwCs(true);
-    if (GPIO_PIN_NSS_2 != UNDEF_PIN)
-    {
-        spiAttachSS(SPIEx.bus(), 1, GPIO_PIN_NSS_2);
-    }
-
-    if (lr1121UpdateState->totalSize == lr1121UpdateState->expectedFilesize)
-    {
-        DBGLN("Reboot LR1121");
-        uint8_t buf = 0;
-        hal.WriteCommand(LR11XX_BL_REBOOT_OC, &buf, 1, lr1121UpdateState->updatingRadio);
-        while(!hal.WaitOnBusy(lr1121UpdateState->updatingRadio))
-        {
-            delay(1);
-        }
-
-        DBGLN("Check not in BL mode");
-        const firmware_version_t version = GetFirmwareVersion(lr1121UpdateState->updatingRadio, LR11XX_SYSTEM_GET_VERSION_OC);
-        DBGLN("Hardware %x", version.hardware >> 24);
-        DBGLN("Type %x", version.type);
-        DBGLN("Firmware %x", version.version & 0xFFFF);
-        delete lr1121UpdateState;
-        lr1121UpdateState = nullptr;
-        retCode = version.type == 0xDF ? -2 : 0; // still in bootloader mode?
-    }
-    else
+    if (lr1121UpdateState == nullptr)
     {
-        DBGLN("Finished expected %d, total %d", lr1121UpdateState->expectedFilesize, lr1121UpdateState->totalSize);
-        retCode = -1; // Not enough bytes uploaded
+        return LR1121_UPDATE_NOT_STARTED;
     }
+    const lr1121UpdateResult_e result = lr1121UpdateState->update.end();
+    DBGLN("End update: %s", LR1121Update::errorString(result));
     delete lr1121UpdateState;
     lr1121UpdateState = nullptr;
-    return retCode;
+    return result;
 }
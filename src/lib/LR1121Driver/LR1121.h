@@ -3,6 +3,7 @@
 #include "targets.h"
 #include "SX12xxDriverCommon.h"
 #include "LR1121_Regs.h"
+#include "LR1121Update.h"
 
 #ifdef PLATFORM_ESP8266
 #include <cstdint>
@@ -10,13 +11,6 @@
 
 #define RADIO_SNR_SCALE 4
 
-typedef struct
-{
-    uint8_t hardware;
-    uint8_t type;
-    uint16_t version;
-} __attribute__((packed)) firmware_version_t;
-
 class LR1121Driver: public SX12xxDriverCommon
 {
 public:
@@ -30,14 +24,20 @@ public:
     void Config(uint8_t bw, uint8_t sf, uint8_t cr, uint32_t freq,
                 uint8_t PreambleLength, bool InvertIQ, uint8_t PayloadLength, bool setFSKModulation,
                 uint8_t fskSyncWord1, uint8_t fskSyncWord2, SX12XX_Radio_Number_t radioNumber = SX12XX_Radio_All);
+    // LoRa only, change the modulation of an announced rate switch in place, from the timer ISR
+    void SetModulation(uint8_t bw, uint8_t sf, uint8_t cr, uint8_t PreambleLength, SX12XX_Radio_Number_t radioNumber);
     void SetFrequencyReg(uint32_t freq, SX12XX_Radio_Number_t radioNumber, bool doRx = false, uint32_t rxTime = 0);
     void SetOutputPower(int8_t power, bool isSubGHz = true);
     void startCWTest(uint32_t freq, SX12XX_Radio_Number_t radioNumber);
+    void cwRepeat(SX12XX_Radio_Number_t radioNumber) {} // the CW carries on until the mode changes
 
 
     bool GetFrequencyErrorbool(SX12XX_Radio_Number_t radioNumber);
+    // Only the direction is known, one FREQ_STEP that way
+    int32_t GetFrequencyError(SX12XX_Radio_Number_t radioNumber) { return GetFrequencyErrorbool(radioNumber) ? -1 : 1; }
     // bool FrequencyErrorAvailable() const { return modeSupportsFei && (LastPacketSNRRaw > 0); }
     bool FrequencyErrorAvailable() const { return false; }
+    void SetPPMoffsetReg(int32_t offset, SX12XX_Radio_Number_t radioNumber) {} // the demodulator follows the frequency
 
     void TXnb(uint8_t *data, bool sendGeminiBuffer, uint8_t * dataGemini, SX12XX_Radio_Number_t radioNumber);
     void RXnb();
@@ -52,9 +52,9 @@ public:
 
     // Firmware update methods
     firmware_version_t GetFirmwareVersion(SX12XX_Radio_Number_t radioNumber, uint16_t command = LR11XX_SYSTEM_GET_VERSION_OC);
-    int BeginUpdate(SX12XX_Radio_Number_t radioNumber, uint32_t expectedSize);
-    int WriteUpdateBytes(const uint8_t *bytes, uint32_t size);
-    int EndUpdate();
+    lr1121UpdateResult_e BeginUpdate(SX12XX_Radio_Number_t radioNumber, uint32_t expectedSize);
+    lr1121UpdateResult_e WriteUpdateBytes(const uint8_t *bytes, uint32_t size);
+    lr1121UpdateResult_e EndUpdate();
 
 private:
     // constant used for no power change pending
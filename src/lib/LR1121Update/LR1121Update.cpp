@@ -0,0 +1,198 @@
+#include "LR1121Update.h"
+#include <string.h>
+
+#define CRC32_INIT 0xFFFFFFFF
+
+// Plain CRC-32 without a table, it runs once per block
+static uint32_t crc32(uint32_t crc, const uint8_t *data, uint16_t len)
+{
+    while (len--)
+    {
+        crc ^= *data++;
+        for (uint8_t bit = 0; bit < 8; bit++)
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+    }
+    return crc;
+}
+
+LR1121Update::LR1121Update(LR1121Bootloader &bootloader)
+    : m_bootloader(bootloader), m_result(LR1121_UPDATE_NOT_STARTED), m_started(false), m_size(0),
+      m_imageId(0), m_received(0), m_block(0), m_blocksWritten(0), m_resumeBlocks(0), m_resumeCrc(0),
+      m_crc(CRC32_INIT), m_fill(0)
+{
+}
+
+lr1121UpdateResult_e LR1121Update::begin(uint32_t size, uint32_t imageId)
+{
+    m_started = true;
+    m_result = LR1121_UPDATE_OK;
+    m_size = size;
+    m_imageId = imageId;
+    m_received = 0;
+    m_block = 0;
+    m_blocksWritten = 0;
+    m_resumeBlocks = 0;
+    m_crc = CRC32_INIT;
+    m_fill = 0;
+
+    // The flash is written a word at a time
+    if (size == 0 || size % 4 != 0)
+        return m_result = LR1121_UPDATE_SIZE_MISMATCH;
+
+    // Already in the bootloader when an earlier update did not finish
+    const bool inBootloader = m_bootloader.getVersion().type == LR1121_BOOTLOADER_TYPE;
+    if (!inBootloader)
+    {
+        m_bootloader.enterBootloader();
+        if (m_bootloader.getVersion().type != LR1121_BOOTLOADER_TYPE)
+            return m_result = LR1121_UPDATE_NO_BOOTLOADER;
+    }
+
+    lr1121UpdateProgress_t progress;
+    if (inBootloader && imageId != 0 && m_bootloader.loadProgress(progress) &&
+        progress.imageId == imageId && progress.size == size &&
+        progress.blocks != 0 && (uint32_t)progress.blocks * LR1121_UPDATE_BLOCK_SIZE < size)
+    {
+        // The CRC is checked when the same blocks have been seen again
+        m_resumeBlocks = progress.blocks;
+        m_resumeCrc = progress.crc;
+        return m_result;
+    }
+
+    if (!m_bootloader.erase())
+        return m_result = LR1121_UPDATE_ERASE_FAILED;
+    // Nothing in flash to resume from now
+    saveProgress();
+    return m_result;
+}
+
+lr1121UpdateResult_e LR1121Update::write(const uint8_t *bytes, uint32_t size)
+{
+    if (!m_started)
+        return LR1121_UPDATE_NOT_STARTED;
+    if (m_result == LR1121_UPDATE_OK && size > m_size - m_received)
+        m_result = LR1121_UPDATE_SIZE_MISMATCH;
+
+    while (size != 0 && m_result == LR1121_UPDATE_OK)
+    {
+        const uint16_t chunk = size < (uint32_t)(LR1121_UPDATE_BLOCK_SIZE - m_fill) ? size : LR1121_UPDATE_BLOCK_SIZE - m_fill;
+        memcpy(m_buffer + m_fill, bytes, chunk);
+        m_fill += chunk;
+        m_received += chunk;
+        bytes += chunk;
+        size -= chunk;
+        if (m_fill == LR1121_UPDATE_BLOCK_SIZE)
+            flushBlock();
+    }
+    return m_result;
+}
+
+lr1121UpdateResult_e LR1121Update::end(const firmware_version_t *expected)
+{
+    if (!m_started)
+        return LR1121_UPDATE_NOT_STARTED;
+    m_started = false;
+
+    if (m_result == LR1121_UPDATE_OK && m_fill != 0)
+        flushBlock();
+    if (m_result != LR1121_UPDATE_OK)
+        return m_result;
+    if (m_received != m_size)
+        return m_result = LR1121_UPDATE_SIZE_MISMATCH;
+
+    // The bootloader checks the image as it boots, and stays put if it is not right
+    m_bootloader.reboot();
+    const firmware_version_t version = m_bootloader.getVersion();
+    if (version.type == LR1121_BOOTLOADER_TYPE)
+        return m_result = LR1121_UPDATE_REJECTED;
+    if (expected != nullptr && (version.type != expected->type || version.version != expected->version))
+        return m_result = LR1121_UPDATE_WRONG_VERSION;
+
+    const lr1121UpdateProgress_t done = {};
+    m_bootloader.saveProgress(done);
+    return m_result;
+}
+
+lr1121UpdateResult_e LR1121Update::flash(const uint32_t *image, uint32_t words, uint32_t imageId, const firmware_version_t &expected)
+{
+    lr1121UpdateResult_e result = LR1121_UPDATE_OK;
+    for (uint8_t pass = 0; pass < 2; pass++)
+    {
+        if (pass != 0)
+        {
+            // Forget the progress so the second go starts from an erased flash
+            const lr1121UpdateProgress_t none = {};
+            m_bootloader.saveProgress(none);
+        }
+
+        result = begin(words * 4, imageId);
+        for (uint32_t i = 0; i < words && result == LR1121_UPDATE_OK; i++)
+        {
+            // The radio takes the words MSB first
+            const uint8_t bytes[4] = {
+                (uint8_t)(image[i] >> 24), (uint8_t)(image[i] >> 16), (uint8_t)(image[i] >> 8), (uint8_t)image[i]
+            };
+            result = write(bytes, sizeof(bytes));
+        }
+        result = end(&expected);
+
+        // Only a resumed update is worth another go
+        if (result == LR1121_UPDATE_OK || !resumed())
+            break;
+    }
+    return result;
+}
+
+void LR1121Update::flushBlock()
+{
+    if (m_block >= m_resumeBlocks)
+    {
+        // The blocks skipped over must be the ones the saved progress was for
+        if (m_resumeBlocks != 0 && m_block == m_resumeBlocks && m_crc != m_resumeCrc)
+        {
+            m_result = LR1121_UPDATE_RESUME_MISMATCH;
+            return;
+        }
+
+        const uint32_t offset = (uint32_t)m_block * LR1121_UPDATE_BLOCK_SIZE;
+        uint8_t attempts = 1;
+        while (!m_bootloader.writeBlock(offset, m_buffer, m_fill))
+        {
+            if (attempts++ == LR1121_UPDATE_BLOCK_RETRIES)
+            {
+                m_result = LR1121_UPDATE_WRITE_FAILED;
+                return;
+            }
+        }
+        m_blocksWritten++;
+    }
+
+    m_crc = crc32(m_crc, m_buffer, m_fill);
+    m_block++;
+    m_fill = 0;
+    if (m_block > m_resumeBlocks && m_block % LR1121_UPDATE_PROGRESS_BLOCKS == 0)
+        saveProgress();
+}
+
+void LR1121Update::saveProgress()
+{
+    const lr1121UpdateProgress_t progress = {m_imageId, m_size, m_block, m_crc};
+    m_bootloader.saveProgress(progress);
+}
+
+const char *LR1121Update::errorString(lr1121UpdateResult_e result)
+{
+    switch (result)
+    {
+    case LR1121_UPDATE_OK: return "Update complete";
+    case LR1121_UPDATE_NOT_STARTED: return "Update not started";
+    case LR1121_UPDATE_NO_BOOTLOADER: return "Radio did not enter the bootloader";
+    case LR1121_UPDATE_ERASE_FAILED: return "Flash erase failed";
+    case LR1121_UPDATE_WRITE_FAILED: return "Flash write failed";
+    case LR1121_UPDATE_RESUME_MISMATCH: return "Interrupted update does not match the image";
+    case LR1121_UPDATE_SIZE_MISMATCH: return "Not the expected amount of data";
+    case LR1121_UPDATE_REJECTED: return "Image rejected by the radio";
+    case LR1121_UPDATE_WRONG_VERSION: return "Radio is not running the new version";
+    }
+    return "Unknown error";
+}
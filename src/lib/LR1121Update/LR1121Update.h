@@ -0,0 +1,131 @@
+#pragma once
+
+#include "targets.h"
+#include <stdint.h>
+
+/*
+ * Writes a transceiver image into the LR1121 flash through its bootloader.
+ *
+ * The image goes in blocks of LR1121_UPDATE_BLOCK_SIZE. After each block the bootloader's status
+ * is read back, a block it rejects is sent again up to LR1121_UPDATE_BLOCK_RETRIES times. The
+ * bootloader has no way to read the flash back, it checks the whole image when it reboots, so
+ * the end of an update is verified by rebooting and reading the version that is running. A radio
+ * that is still in the bootloader did not accept the image.
+ *
+ * A power loss part way through leaves the radio in the bootloader with part of the image in
+ * flash. For an image with an id (the embedded one) the blocks that were written are saved every
+ * LR1121_UPDATE_PROGRESS_BLOCKS, with a CRC of their contents. When the radio is found still in
+ * the bootloader the update carries on from there without erasing, as long as the same image
+ * gives the same CRC up to that block. Anything that goes wrong after resuming is retried once
+ * from an erased flash.
+ *
+ * There is no hardware access, the radio is reached through an LR1121Bootloader.
+ */
+
+#define LR1121_UPDATE_BLOCK_SIZE 256        // bytes in a WriteFlashEncrypted command
+#define LR1121_UPDATE_BLOCK_RETRIES 3       // writes of a block before giving up on it
+#define LR1121_UPDATE_PROGRESS_BLOCKS 8     // blocks between saves of the progress
+#define LR1121_BOOTLOADER_TYPE 0xDF         // firmware type reported by the bootloader
+
+typedef struct
+{
+    uint8_t hardware;
+    uint8_t type;
+    uint16_t version;
+} __attribute__((packed)) firmware_version_t;
+
+typedef struct {
+    uint32_t imageId;
+    uint32_t size;      // bytes in the image
+    uint16_t blocks;    // blocks written and accepted
+    uint32_t crc;       // CRC-32 of those blocks
+} lr1121UpdateProgress_t;
+
+enum lr1121UpdateResult_e : uint8_t
+{
+    LR1121_UPDATE_OK,
+    LR1121_UPDATE_NOT_STARTED,      // no begin, or the update has already ended
+    LR1121_UPDATE_NO_BOOTLOADER,    // the radio did not reboot into the bootloader
+    LR1121_UPDATE_ERASE_FAILED,
+    LR1121_UPDATE_WRITE_FAILED,     // a block was rejected on every retry
+    LR1121_UPDATE_RESUME_MISMATCH,  // the blocks in flash are not this image's
+    LR1121_UPDATE_SIZE_MISMATCH,    // more or fewer bytes than expected, or not whole words
+    LR1121_UPDATE_REJECTED,         // still in the bootloader after reboot, the image did not verify
+    LR1121_UPDATE_WRONG_VERSION,    // running, but not the version that was written
+};
+
+// What the update needs from the radio
+class LR1121Bootloader
+{
+public:
+    // The running firmware, the type is LR1121_BOOTLOADER_TYPE in the bootloader
+    virtual firmware_version_t getVersion() = 0;
+    virtual void enterBootloader() = 0;
+    // Returns true if the bootloader reports the command as done
+    virtual bool erase() = 0;
+    virtual bool writeBlock(uint32_t offset, const uint8_t *data, uint16_t size) = 0;
+    // Leave the bootloader and run the image in flash
+    virtual void reboot() = 0;
+
+    // Storage for the progress that survives a power loss, without it there is no resume
+    virtual bool loadProgress(lr1121UpdateProgress_t &progress) { return false; }
+    virtual void saveProgress(const lr1121UpdateProgress_t &progress) {}
+};
+
+/**
+ * Id of an image, the native test checks it against the one the driver was released with. Every
+ * word is weighted by its position so a truncated, reordered or changed image has a different id.
+ */
+constexpr uint32_t lr1121ImageId(const uint32_t *image, uint32_t first, uint32_t count)
+{
+    return count == 0 ? 0
+         : count == 1 ? image[first] * (2 * first + 1)
+         : lr1121ImageId(image, first, count / 2) + lr1121ImageId(image, first + count / 2, count - count / 2);
+}
+
+class LR1121Update
+{
+public:
+    explicit LR1121Update(LR1121Bootloader &bootloader);
+
+    /**
+     * Get the radio into the bootloader, and erase it unless resuming
+     * @param size bytes that will be written
+     * @param imageId the image's id, 0 if it has none and can not be resumed
+     */
+    lr1121UpdateResult_e begin(uint32_t size, uint32_t imageId = 0);
+    // The next bytes of the image, in the order the radio wants them. Errors stick until end.
+    lr1121UpdateResult_e write(const uint8_t *bytes, uint32_t size);
+    // Write what is left and reboot into the image, checking it is running expected if given
+    lr1121UpdateResult_e end(const firmware_version_t *expected = nullptr);
+
+    /**
+     * The whole update for an image in memory, as 32 bit words. Resumes an update that was cut
+     * short, and starts again from an erased flash once if that fails.
+     */
+    lr1121UpdateResult_e flash(const uint32_t *image, uint32_t words, uint32_t imageId, const firmware_version_t &expected);
+
+    // Blocks sent to the radio since begin, resumed blocks are not sent
+    uint16_t blocksWritten() const { return m_blocksWritten; }
+    bool resumed() const { return m_resumeBlocks != 0; }
+
+    static const char *errorString(lr1121UpdateResult_e result);
+
+private:
+    LR1121Bootloader &m_bootloader;
+    lr1121UpdateResult_e m_result;
+    bool m_started;
+    uint32_t m_size;
+    uint32_t m_imageId;
+    uint32_t m_received;
+    uint16_t m_block;           // index of the block being filled
+    uint16_t m_blocksWritten;
+    uint16_t m_resumeBlocks;    // blocks already in flash, not sent again
+    uint32_t m_resumeCrc;
+    uint32_t m_crc;             // CRC-32 of the blocks before m_block
+    uint16_t m_fill;
+    uint8_t m_buffer[LR1121_UPDATE_BLOCK_SIZE];
+
+    void flushBlock();
+    void saveProgress();
+};
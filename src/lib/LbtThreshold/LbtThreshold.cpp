@@ -0,0 +1,110 @@
+#include "LbtThreshold.h"
+
+#define FLOOR_Q 8
+
+const lbtThresholdConfig_t LbtThresholdDefaultConfig = {
+    10,     // marginDb, readings further over the floor are another transmitter
+    1,      // fallShift
+    6,      // riseShift, a busy channel takes about 64 readings to move the floor
+    8,      // minReadings
+    3,      // maxDeferrals
+};
+
+LbtThreshold::LbtThreshold(const lbtThresholdConfig_t &config)
+    : m_config(config)
+{
+    reset();
+}
+
+void LbtThreshold::reset()
+{
+    for (uint8_t ch = 0; ch < LBT_MAX_CHANNELS; ch++)
+    {
+        m_floorQ8[ch] = 0;
+        m_readings[ch] = 0;
+        for (uint8_t radio = 0; radio < LBT_MAX_RADIOS; radio++)
+            m_deferrals[radio][ch] = 0;
+    }
+}
+
+int8_t ICACHE_RAM_ATTR LbtThreshold::noiseFloor(uint8_t channel) const
+{
+    channel %= LBT_MAX_CHANNELS;
+    if (m_readings[channel] < m_config.minReadings)
+        return LBT_NO_FLOOR;
+    return (m_floorQ8[channel] + (1 << (FLOOR_Q - 1))) >> FLOOR_Q;
+}
+
+int8_t ICACHE_RAM_ATTR LbtThreshold::threshold(uint8_t channel, int8_t limit) const
+{
+    const int8_t floor = noiseFloor(channel);
+    if (floor == LBT_NO_FLOOR)
+        return limit;
+    const int16_t adaptive = floor + m_config.marginDb;
+    return adaptive < limit ? adaptive : limit;
+}
+
+lbtResult_e ICACHE_RAM_ATTR LbtThreshold::check(uint8_t radio, uint8_t channel, int8_t rssi, int8_t limit)
+{
+    const int8_t cutOff = threshold(channel, limit);
+
+    channel %= LBT_MAX_CHANNELS;
+    uint8_t &deferrals = m_deferrals[radio % LBT_MAX_RADIOS][channel];
+    const int16_t rssiQ8 = rssi * (1 << FLOOR_Q);
+    if (m_readings[channel] == 0)
+        m_floorQ8[channel] = rssiQ8;
+    else if (rssiQ8 < m_floorQ8[channel])
+        m_floorQ8[channel] -= (m_floorQ8[channel] - rssiQ8) >> m_config.fallShift;
+    else
+        m_floorQ8[channel] += (rssiQ8 - m_floorQ8[channel]) >> m_config.riseShift;
+    if (m_readings[channel] < m_config.minReadings)
+        m_readings[channel]++;
+
+    if (rssi < cutOff)
+    {
+        deferrals = 0;
+        return LBT_CLEAR;
+    }
+    // Only the adaptive part of the threshold can be overridden
+    if (rssi >= limit)
+        return LBT_BUSY;
+    if (deferrals < m_config.maxDeferrals)
+    {
+        deferrals++;
+        return LBT_BUSY;
+    }
+    deferrals = 0;
+    return LBT_FORCED;
+}
+
+void LbtAuditLog::clear()
+{
+    m_head = 0;
+    m_count = 0;
+    m_deferred = 0;
+    m_forced = 0;
+}
+
+void ICACHE_RAM_ATTR LbtAuditLog::add(uint32_t timeMs, lbtResult_e result, uint8_t radio, uint8_t channel, int8_t rssi, int8_t threshold)
+{
+    lbtAuditEntry_t &entry = m_entries[m_head];
+    entry.timeMs = timeMs;
+    entry.result = result;
+    entry.radio = radio;
+    entry.channel = channel;
+    entry.rssi = rssi;
+    entry.threshold = threshold;
+    m_head = (m_head + 1) % LBT_AUDIT_SIZE;
+    if (m_count < LBT_AUDIT_SIZE)
+        m_count++;
+
+    if (result == LBT_FORCED)
+        m_forced++;
+    else
+        m_deferred++;
+}
+
+const lbtAuditEntry_t &LbtAuditLog::get(uint8_t index) const
+{
+    return m_entries[(m_head + LBT_AUDIT_SIZE - m_count + index) % LBT_AUDIT_SIZE];
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "targets.h"
+#include <stdint.h>
+
+/*
+ * Clear channel assessment threshold for LBT that follows the noise floor of each channel.
+ *
+ * EN 300 328 gives a threshold for the TX power, the regulatory limit. A channel with a reading
+ * at or over it is busy, always. Under it, the noise floor of the channel is estimated from the
+ * readings taken on it: readings under the floor pull it down quickly, readings over it (other
+ * users, our own telemetry) pull it up slowly so it stays at the quiet level. Once a channel has
+ * enough readings its threshold is the floor plus a margin, capped at the regulatory limit, so
+ * a weak transmission on a quiet channel is heard even though it is under the limit.
+ *
+ * A channel that is over the adaptive threshold but under the regulatory limit is deferred a few
+ * times in a row, after that the TX goes out anyway as the regulation allows. So a floor that
+ * has been estimated too low can not block the link. The deferrals are counted for each radio
+ * and channel, a clear reading on one does not reset the count of another.
+ *
+ * LbtAuditLog keeps the last deferred and forced transmissions, with what the CCA saw, for
+ * compliance review.
+ *
+ * There is no radio access here, LBT.cpp takes the readings.
+ */
+
+#define LBT_MAX_CHANNELS 80     // the most FHSS channels of a 2.4GHz domain
+#define LBT_MAX_RADIOS 2
+#define LBT_AUDIT_SIZE 32
+#define LBT_NO_FLOOR -128       // noiseFloor() of a channel without enough readings
+
+typedef enum : uint8_t {
+    LBT_CLEAR,
+    LBT_BUSY,       // do not transmit
+    LBT_FORCED,     // over the adaptive threshold but under the regulatory limit, transmit
+} lbtResult_e;
+
+typedef struct {
+    uint8_t marginDb;           // threshold above the noise floor
+    uint8_t fallShift;          // floor moves 2^-n of the way to a reading under it
+    uint8_t riseShift;          // and to a reading over it
+    uint8_t minReadings;        // on a channel before its floor is used
+    uint8_t maxDeferrals;       // in a row under the regulatory limit before forcing
+} lbtThresholdConfig_t;
+
+extern const lbtThresholdConfig_t LbtThresholdDefaultConfig;
+
+class LbtThreshold
+{
+public:
+    explicit LbtThreshold(const lbtThresholdConfig_t &config = LbtThresholdDefaultConfig);
+
+    // Forget the noise floors, when the band or bandwidth changes
+    void reset();
+
+    /**
+     * Assess one instant RSSI reading and add it to the channel's noise floor
+     * @param radio 0 or 1, the radio that took the reading
+     * @param limit regulatory threshold for the TX power, dBm
+     */
+    lbtResult_e check(uint8_t radio, uint8_t channel, int8_t rssi, int8_t limit);
+
+    // Threshold a reading on the channel has to be under to be clear, dBm
+    int8_t threshold(uint8_t channel, int8_t limit) const;
+    int8_t noiseFloor(uint8_t channel) const;
+
+private:
+    lbtThresholdConfig_t m_config;
+    int16_t m_floorQ8[LBT_MAX_CHANNELS];    // dBm << 8
+    uint8_t m_readings[LBT_MAX_CHANNELS];   // up to minReadings
+    uint8_t m_deferrals[LBT_MAX_RADIOS][LBT_MAX_CHANNELS];  // in a row under the regulatory limit
+};
+
+typedef struct {
+    uint32_t timeMs;
+    lbtResult_e result;         // LBT_BUSY or LBT_FORCED
+    uint8_t radio;
+    uint8_t channel;
+    int8_t rssi;
+    int8_t threshold;
+} lbtAuditEntry_t;
+
+class LbtAuditLog
+{
+public:
+    LbtAuditLog() { clear(); }
+
+    void clear();
+    void add(uint32_t timeMs, lbtResult_e result, uint8_t radio, uint8_t channel, int8_t rssi, int8_t threshold);
+
+    // Entries held, get(0) is the oldest
+    uint8_t count() const { return m_count; }
+    const lbtAuditEntry_t &get(uint8_t index) const;
+    // Since the last clear, including the entries that have been overwritten
+    uint32_t deferred() const { return m_deferred; }
+    uint32_t forced() const { return m_forced; }
+
+private:
+    lbtAuditEntry_t m_entries[LBT_AUDIT_SIZE];
+    uint8_t m_head;     // next to write
+    uint8_t m_count;
+    uint32_t m_deferred;
+    uint32_t m_forced;
+};
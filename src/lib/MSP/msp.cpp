@@ -17,11 +17,41 @@ Offset: Usage:         In CRC:  Comment:
 n+8     checksum                uint8, (n= payload size), crc8_dvb_s2 checksum
 ========================================== */
 
+mspBufferPool_t mspBufferPool;
+
+static GENERIC_CRC8 &crc8_dvb_s2_instance()
+{
+    static GENERIC_CRC8 instance(0xD5);
+    return instance;
+}
+
 // CRC helper function.
 uint8_t crc8_dvb_s2(uint8_t crc, unsigned char a)
 {
-    static GENERIC_CRC8 crc8_dvb_s2_instance(0xD5);
-    return crc8_dvb_s2_instance.calc(crc ^ a);
+    return crc8_dvb_s2_instance().calc(crc ^ a);
+}
+
+MSP::~MSP()
+{
+    releasePayload();
+}
+
+void
+MSP::releasePayload()
+{
+    mspBufferPool.release(m_packet.payload);
+    m_packet.payload = nullptr;
+    m_packet.payloadCapacity = 0;
+}
+
+void
+MSP::flushChunk()
+{
+    const uint16_t len = m_offset - m_chunkStart;
+    if (len) {
+        m_chunkHandler(&m_packet, m_chunkStart, m_packet.payload, len);
+        m_chunkStart = m_offset;
+    }
 }
 
 bool
@@ -54,9 +84,13 @@ MSP::processReceivedByte(uint8_t c)
 
             // Start of a new packet
             // reset the packet, offset iterator, and CRC
+            releasePayload();
             m_packet.reset();
             m_offset = 0;
+            m_chunkStart = 0;
             m_crc = 0;
+            m_streaming = false;
+            m_discard = false;
 
             switch (c) {
                 case '<':
@@ -73,49 +107,98 @@ MSP::processReceivedByte(uint8_t c)
             break;
 
         case MSP_HEADER_V2_NATIVE:
-            // Read bytes until we have a full header
-            m_inputBuffer[m_offset++] = c;
+            // Decode the little endian header fields as the bytes arrive
             m_crc = crc8_dvb_s2(m_crc, c);
+            switch (m_offset++) {
+                case 0:
+                    m_packet.flags = c;
+                    break;
+                case 1:
+                    m_packet.function = c;
+                    break;
+                case 2:
+                    m_packet.function |= (uint16_t)c << 8;
+                    break;
+                case 3:
+                    m_packet.payloadSize = c;
+                    break;
+                default:
+                    m_packet.payloadSize |= (uint16_t)c << 8;
+                    break;
+            }
 
             // If we've received the correct amount of bytes for a full header
             if (m_offset == sizeof(mspHeaderV2_t)) {
-                // Copy header values into packet
-                mspHeaderV2_t* header = (mspHeaderV2_t*)&m_inputBuffer[0];
-                m_packet.payloadSize = header->payloadSize;
-                m_packet.function = header->function;
-                m_packet.flags = header->flags;
                 // reset the offset iterator for re-use in payload below
                 m_offset = 0;
-				if (m_packet.payloadSize == 0)
-                	m_inputState = MSP_CHECKSUM_V2_NATIVE;
-				else
-                	m_inputState = MSP_PAYLOAD_V2_NATIVE;
+                if (m_packet.payloadSize == 0) {
+                    m_inputState = MSP_CHECKSUM_V2_NATIVE;
+                    break;
+                }
+
+                m_packet.payload = mspBufferPool.acquire();
+                m_packet.payloadCapacity = m_packet.payload ? mspBufferPool.blockSize : 0;
+                if (m_packet.payloadSize > m_packet.payloadCapacity) {
+                    // Too big for a block (or no block free), stream it out or skip over it
+                    m_streaming = m_packet.payload && m_chunkHandler;
+                    m_discard = !m_streaming;
+                    if (m_discard) {
+                        releasePayload();
+                    }
+                }
+                m_inputState = MSP_PAYLOAD_V2_NATIVE;
             }
             break;
 
         case MSP_PAYLOAD_V2_NATIVE:
             // Read bytes until we reach payloadSize
-            m_packet.payload[m_offset++] = c;
             m_crc = crc8_dvb_s2(m_crc, c);
+            if (!m_discard) {
+                m_packet.payload[m_offset - m_chunkStart] = c;
+            }
+            m_offset++;
+
+            if (m_streaming && m_offset - m_chunkStart == m_packet.payloadCapacity) {
+                flushChunk();
+            }
 
             // If we've received the correct amount of bytes for payload
             if (m_offset == m_packet.payloadSize) {
+                if (m_streaming) {
+                    flushChunk();
+                }
                 // Then we're up to the CRC
                 m_inputState = MSP_CHECKSUM_V2_NATIVE;
             }
             break;
 
         case MSP_CHECKSUM_V2_NATIVE:
+            if (m_crc != c) {
+                DBGLN("CRC failure on MSP packet - Got %d expected %d", c, m_crc);
+            }
+
+            if (m_streaming) {
+                // Streamed packets are complete once the handler knows whether the checksum matched
+                m_packet.readError = m_crc != c;
+                m_chunkHandler(&m_packet, m_packet.payloadSize, nullptr, 0);
+                releasePayload();
+                m_inputState = MSP_IDLE;
+            }
+            else if (m_discard) {
+                DBGLN("Dropped MSP packet with %u byte payload", m_packet.payloadSize);
+                m_dropped++;
+                m_inputState = MSP_IDLE;
+            }
             // Assert that the checksums match
-            if (m_crc == c) {
+            else if (m_crc == c) {
                 m_inputState = MSP_COMMAND_RECEIVED;
             }
             else {
-                DBGLN("CRC failure on MSP packet - Got %d expected %d", c, m_crc);
+                releasePayload();
                 m_inputState = MSP_IDLE;
             }
             break;
-        
+
         default:
             m_inputState = MSP_IDLE;
             break;
@@ -140,12 +223,13 @@ void
 MSP::markPacketReceived()
 {
     // Set input state to idle, ready to receive the next packet
-    // The current packet data will be discarded internally
+    // The current packet data will be discarded and its payload block returned to the pool
+    releasePayload();
     m_inputState = MSP_IDLE;
 }
 
 bool
-MSP::sendPacket(mspPacket_t* packet, Stream* port)
+MSP::sendPacket(const mspPacket_t* packet, Stream* port)
 {
     // Sanity check the packet before sending
     if (packet->type != MSP_PACKET_COMMAND && packet->type != MSP_PACKET_RESPONSE) {
@@ -157,42 +241,32 @@ MSP::sendPacket(mspPacket_t* packet, Stream* port)
         // Response packet with no payload
         return false;
     }
-    
-    // Write out the framing chars
-    port->write('$');
-    port->write('X');
-
-    // Write out the packet type
-    if (packet->type == MSP_PACKET_COMMAND) {
-        port->write('<');
-    }
-    else if (packet->type == MSP_PACKET_RESPONSE) {
-        port->write('>');
+
+    if (packet->writeError) {
+        // The payload was truncated when it was built
+        return false;
     }
 
-    // Subsequent bytes are contained in the crc
-    uint8_t crc = 0;
+    // Framing chars, packet type and the header are written in one go
+    uint8_t headerBuffer[3 + sizeof(mspHeaderV2_t)];
+    headerBuffer[0] = '$';
+    headerBuffer[1] = 'X';
+    headerBuffer[2] = packet->type == MSP_PACKET_COMMAND ? '<' : '>';
 
     // Pack header struct into buffer
-    uint8_t headerBuffer[5];
-    mspHeaderV2_t* header = (mspHeaderV2_t*)&headerBuffer[0];
+    mspHeaderV2_t* header = (mspHeaderV2_t*)&headerBuffer[3];
     header->flags = packet->flags;
     header->function = packet->function;
     header->payloadSize = packet->payloadSize;
 
-    // Write out the header buffer, adding each byte to the crc
-    for (uint8_t i = 0; i < sizeof(mspHeaderV2_t); ++i) {
-        port->write(headerBuffer[i]);
-        crc = crc8_dvb_s2(crc, headerBuffer[i]);
-    }
+    // Subsequent bytes are contained in the crc
+    uint8_t crc = crc8_dvb_s2_instance().calc(&headerBuffer[3], sizeof(mspHeaderV2_t), 0);
+    crc = crc8_dvb_s2_instance().calc(packet->payload, packet->payloadSize, crc);
 
-    // Write out the payload, adding each byte to the crc
-    for (uint16_t i = 0; i < packet->payloadSize; ++i) {
-        port->write(packet->payload[i]);
-        crc = crc8_dvb_s2(crc, packet->payload[i]);
+    port->write(headerBuffer, sizeof(headerBuffer));
+    if (packet->payloadSize) {
+        port->write(packet->payload, packet->payloadSize);
     }
-
-    // Write out the crc
     port->write(crc);
 
     return true;
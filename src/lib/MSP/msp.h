@@ -1,10 +1,10 @@
 #pragma once
 
 #include "targets.h"
+#include "msppool.h"
 
-// TODO: MSP_PORT_INBUF_SIZE should be changed to
-// dynamically allocate array length based on the payload size
-// Hardcoding payload size to 64 bytes for now, to match CRSF TLM
+// Payload capacity of packets built locally with mspPacketBuffer_t when the caller
+// does not need a specific size, matches CRSF TLM
 #define MSP_PORT_INBUF_SIZE 64
 
 #define CHECK_PACKET_PARSING() \
@@ -36,14 +36,33 @@ typedef struct __attribute__((packed)) {
     uint16_t payloadSize;
 } mspHeaderV2_t;
 
-typedef struct {
+/**
+ * An MSP packet header plus a span over its payload.
+ *
+ * The packet does not own the payload storage, `payload` points either at a block from
+ * the shared mspBufferPool (received packets) or at the storage of an mspPacketBuffer_t
+ * (packets built for sending).
+ */
+typedef struct mspPacket_s {
     mspPacketType_e type;
     uint8_t         flags;
     uint16_t        function;
     uint16_t        payloadSize;
-    uint8_t         payload[MSP_PORT_INBUF_SIZE];
+    uint8_t         *payload;
+    uint16_t        payloadCapacity;
     uint16_t        payloadReadIterator;
     bool            readError;
+    bool            writeError;
+
+    mspPacket_s() : payload(nullptr), payloadCapacity(0)
+    {
+        reset();
+    }
+
+    mspPacket_s(uint8_t *storage, const uint16_t capacity) : payload(storage), payloadCapacity(capacity)
+    {
+        reset();
+    }
 
     void reset()
     {
@@ -53,10 +72,17 @@ typedef struct {
         payloadSize = 0;
         payloadReadIterator = 0;
         readError = false;
+        writeError = false;
     }
 
     void addByte(uint8_t b)
     {
+        if (payloadSize >= payloadCapacity) {
+            // We are trying to write beyond the end of the payload storage
+            writeError = true;
+            return;
+        }
+
         payload[payloadSize++] = b;
     }
 
@@ -82,20 +108,60 @@ typedef struct {
     }
 } mspPacket_t;
 
+/**
+ * An mspPacket_t with its own payload storage of N bytes, for building packets to send.
+ */
+template <uint16_t N = MSP_PORT_INBUF_SIZE>
+struct mspPacketBuffer_t : public mspPacket_t
+{
+    mspPacketBuffer_t() : mspPacket_t(storage, N) {}
+
+    // Copying would leave the span pointing at the other packet's storage
+    mspPacketBuffer_t(const mspPacketBuffer_t &) = delete;
+    mspPacketBuffer_t &operator=(const mspPacketBuffer_t &) = delete;
+
+private:
+    uint8_t storage[N];
+};
+
+/**
+ * Called for packets whose payload is larger than a pool block. The payload is passed in
+ * order as block sized chunks as it arrives, `offset` is the position of `data` within the
+ * payload. The end of the payload is signalled by a call with len == 0 once the checksum has
+ * been received, if packet->readError is set the checksum failed and the chunks must be discarded.
+ */
+typedef void (*mspPayloadChunkHandler)(const mspPacket_t *packet, uint16_t offset, const uint8_t *data, uint16_t len);
+
 /////////////////////////////////////////////////
 
 class MSP
 {
 public:
+    ~MSP();
+
     bool            processReceivedByte(uint8_t c);
     mspPacket_t*    getReceivedPacket();
     void            markPacketReceived();
-    static bool     sendPacket(mspPacket_t* packet, Stream* port);
+    static bool     sendPacket(const mspPacket_t* packet, Stream* port);
+
+    /**
+     * Set the handler that receives payloads too large for a single pool block.
+     * Without a handler such packets are consumed and dropped.
+     */
+    void            setPayloadChunkHandler(mspPayloadChunkHandler handler) { m_chunkHandler = handler; }
+    uint32_t        getDroppedCount() const { return m_dropped; }
 
 private:
-    mspState_e  m_inputState;
-    uint16_t    m_offset;
-    uint8_t     m_inputBuffer[MSP_PORT_INBUF_SIZE];
+    mspState_e  m_inputState = MSP_IDLE;
+    uint16_t    m_offset = 0;       // bytes received of the current header field or payload
+    uint16_t    m_chunkStart = 0;   // payload offset of the first byte in the payload block
     mspPacket_t m_packet;
-    uint8_t     m_crc;
+    uint8_t     m_crc = 0;
+    bool        m_streaming = false;
+    bool        m_discard = false;
+    uint32_t    m_dropped = 0;
+    mspPayloadChunkHandler m_chunkHandler = nullptr;
+
+    void        releasePayload();
+    void        flushChunk();
 };
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "targets.h"
+
+// Frames that do not fit in a block are streamed by the MSP parser and CROSSFIRE2MSP
+#if !defined(MSP_POOL_BLOCK_SIZE)
+#define MSP_POOL_BLOCK_SIZE 512
+#endif
+// One block for the MSP serial parser and one for CRSF->MSP reassembly, each only held while a frame is in flight
+#if !defined(MSP_POOL_BLOCK_COUNT)
+#define MSP_POOL_BLOCK_COUNT 2
+#endif
+
+/**
+ * @brief Fixed size block allocator shared by the MSP parser and the CRSF<->MSP transcoders.
+ *
+ * Payload storage is only held while a frame is being received or processed, instead of every
+ * parser and packet carrying its own worst-case buffer.
+ * Not thread safe, blocks must be acquired and released from the main loop.
+ *
+ * @tparam BLOCK_SIZE size of each block in bytes
+ * @tparam BLOCK_COUNT number of blocks in the pool (max 32)
+ */
+template <uint16_t BLOCK_SIZE, uint8_t BLOCK_COUNT>
+class MSPBufferPool
+{
+public:
+    static constexpr uint16_t blockSize = BLOCK_SIZE;
+
+    /**
+     * @brief Take a free block from the pool
+     * @return pointer to BLOCK_SIZE bytes, or nullptr if all the blocks are in use
+     */
+    uint8_t *acquire()
+    {
+        for (uint8_t i = 0; i < BLOCK_COUNT; i++)
+        {
+            if ((inUse & (1UL << i)) == 0)
+            {
+                inUse |= (1UL << i);
+                return blocks[i];
+            }
+        }
+        exhausted++;
+        return nullptr;
+    }
+
+    /**
+     * @brief Return a block to the pool, releasing nullptr or a block not from this pool is ignored
+     */
+    void release(const uint8_t *block)
+    {
+        for (uint8_t i = 0; i < BLOCK_COUNT; i++)
+        {
+            if (block == blocks[i])
+            {
+                inUse &= ~(1UL << i);
+                return;
+            }
+        }
+    }
+
+    uint8_t available() const
+    {
+        uint8_t count = 0;
+        for (uint8_t i = 0; i < BLOCK_COUNT; i++)
+        {
+            if ((inUse & (1UL << i)) == 0)
+                count++;
+        }
+        return count;
+    }
+
+    /**
+     * @brief number of times acquire() has failed because the pool was empty
+     */
+    uint32_t exhaustedCount() const { return exhausted; }
+
+private:
+    WORD_ALIGNED_ATTR uint8_t blocks[BLOCK_COUNT][BLOCK_SIZE];
+    uint32_t inUse = 0;
+    uint32_t exhausted = 0;
+};
+
+typedef MSPBufferPool<MSP_POOL_BLOCK_SIZE, MSP_POOL_BLOCK_COUNT> mspBufferPool_t;
+extern mspBufferPool_t mspBufferPool;
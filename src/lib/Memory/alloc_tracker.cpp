@@ -0,0 +1,104 @@
+#include "alloc_tracker.h"
+
+#if defined(ALLOC_TRACKER)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <new>
+
+static bool setupComplete;
+static uint32_t allocations;
+static uint32_t bytes;
+
+static void printAllocation(size_t size)
+{
+    fprintf(stderr, "AllocTracker: heap allocation of %u bytes after setup\n", (unsigned)size);
+}
+
+static AllocTracker::Reporter reporter = printAllocation;
+
+void AllocTracker::markSetupComplete()
+{
+    setupComplete = true;
+}
+
+void AllocTracker::reset()
+{
+    setupComplete = false;
+    allocations = 0;
+    bytes = 0;
+}
+
+uint32_t AllocTracker::steadyStateAllocations()
+{
+    return allocations;
+}
+
+uint32_t AllocTracker::steadyStateBytes()
+{
+    return bytes;
+}
+
+void AllocTracker::setReporter(Reporter r)
+{
+    reporter = r ? r : printAllocation;
+}
+
+static void *trackedAlloc(size_t size)
+{
+    if (setupComplete)
+    {
+        allocations++;
+        bytes += size;
+        // the reporter must not allocate or this will recurse
+        setupComplete = false;
+        reporter(size);
+        setupComplete = true;
+    }
+    return malloc(size ? size : 1);
+}
+
+void *operator new(size_t size)
+{
+    void *p = trackedAlloc(size);
+    if (p == nullptr)
+        throw std::bad_alloc();
+    return p;
+}
+
+void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept
+{
+    return trackedAlloc(size);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept
+{
+    return trackedAlloc(size);
+}
+
+void operator delete(void *p) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void *p, size_t) noexcept
+{
+    free(p);
+}
+
+#endif
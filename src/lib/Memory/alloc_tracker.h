@@ -0,0 +1,32 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Native builds with ALLOC_TRACKER defined replace the global operator new/delete to count
+ * heap allocations. Once setup is complete every further allocation is reported, so tests can
+ * assert that the runtime paths do not allocate. Other builds compile the calls to nothing.
+ */
+
+namespace AllocTracker
+{
+    typedef void (*Reporter)(size_t size);
+
+#if defined(ALLOC_TRACKER)
+    // Report and count every allocation from now on
+    void markSetupComplete();
+    // Back to setup, clears the counts
+    void reset();
+    uint32_t steadyStateAllocations();
+    uint32_t steadyStateBytes();
+    // Called for every allocation after setup, the default prints it to stderr
+    void setReporter(Reporter reporter);
+#else
+    inline void markSetupComplete() {}
+    inline void reset() {}
+    inline uint32_t steadyStateAllocations() { return 0; }
+    inline uint32_t steadyStateBytes() { return 0; }
+    inline void setReporter(Reporter) {}
+#endif
+}
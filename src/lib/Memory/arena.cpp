@@ -0,0 +1,14 @@
+#include "arena.h"
+
+static StaticArena<SETUP_ARENA_SIZE> setupArenaStorage;
+Arena &setupArena = setupArenaStorage;
+
+void *Arena::alloc(size_t size, size_t align)
+{
+    const uintptr_t base = (uintptr_t)m_buffer;
+    const uintptr_t start = (base + m_used + align - 1) & ~(uintptr_t)(align - 1);
+    if (start + size > base + m_size)
+        return nullptr;
+    m_used = start + size - base;
+    return (void *)start;
+}
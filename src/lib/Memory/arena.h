@@ -0,0 +1,66 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <new>
+#include <utility>
+
+#define SETUP_ARENA_SIZE 256
+
+/**
+ * Bump allocator for objects that are created during setup and live until reboot.
+ * There is no per-allocation overhead and nothing is ever freed individually.
+ */
+class Arena
+{
+public:
+    Arena(uint8_t *buffer, size_t size) : m_buffer(buffer), m_size(size), m_used(0) {}
+
+    // Returns nullptr if there is not enough space left
+    void *alloc(size_t size, size_t align = alignof(max_align_t));
+
+    template <typename T, typename... Args>
+    T *create(Args &&...args)
+    {
+        void *p = alloc(sizeof(T), alignof(T));
+        return p ? new (p) T(std::forward<Args>(args)...) : nullptr;
+    }
+
+    // Value initialised (zeroed for plain types)
+    template <typename T>
+    T *createArray(size_t count)
+    {
+        void *p = alloc(sizeof(T) * count, alignof(T));
+        return p ? new (p) T[count]() : nullptr;
+    }
+
+    // Frees everything, only for arenas whose objects are known to be gone
+    void reset() { m_used = 0; }
+    size_t used() const { return m_used; }
+    size_t capacity() const { return m_size; }
+
+private:
+    uint8_t *m_buffer;
+    size_t m_size;
+    size_t m_used;
+};
+
+template <size_t N>
+class StaticArena : public Arena
+{
+public:
+    StaticArena() : Arena(m_storage, N) {}
+
+private:
+    alignas(max_align_t) uint8_t m_storage[N];
+};
+
+extern Arena &setupArena;
+
+// Array that lives until reboot, from the setup arena or the heap once that is full
+template <typename T>
+T *newSetupArray(size_t count)
+{
+    T *p = setupArena.createArray<T>(count);
+    return p ? p : new T[count]();
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <stddef.h>
+
+/**
+ * Set of up to N values in an array, for the small sets of pointers/ids that used std::set.
+ * Iterates in insertion order. Lookups are linear, which is faster than a tree at these sizes.
+ */
+template <typename T, size_t N>
+class FixedSet
+{
+public:
+    FixedSet() : m_count(0) {}
+
+    // Returns false if the set is full, adding a value that is already in the set succeeds
+    bool insert(const T &value)
+    {
+        if (contains(value))
+            return true;
+        if (m_count == N)
+            return false;
+        m_values[m_count++] = value;
+        return true;
+    }
+
+    void erase(const T &value)
+    {
+        for (size_t i = 0; i < m_count; i++)
+        {
+            if (m_values[i] == value)
+            {
+                for (size_t j = i + 1; j < m_count; j++)
+                    m_values[j - 1] = m_values[j];
+                m_count--;
+                return;
+            }
+        }
+    }
+
+    bool contains(const T &value) const
+    {
+        for (size_t i = 0; i < m_count; i++)
+        {
+            if (m_values[i] == value)
+                return true;
+        }
+        return false;
+    }
+
+    void clear() { m_count = 0; }
+    size_t size() const { return m_count; }
+    bool empty() const { return m_count == 0; }
+    static constexpr size_t capacity() { return N; }
+
+    const T *begin() const { return &m_values[0]; }
+    const T *end() const { return &m_values[m_count]; }
+
+private:
+    T m_values[N];
+    size_t m_count;
+};
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <new>
+#include <utility>
+
+/*
+ * Fixed size storage for objects that are created and destroyed at runtime, so those paths
+ * do not use (and fragment) the heap. Allocation fails by returning nullptr when full.
+ */
+
+// Largest sizeof() of the types, for sizing an ObjectSlot that holds any of them
+template <typename T, typename... Ts>
+struct MaxSizeOf
+{
+    static constexpr size_t value = sizeof(T) > MaxSizeOf<Ts...>::value ? sizeof(T) : MaxSizeOf<Ts...>::value;
+};
+
+template <typename T>
+struct MaxSizeOf<T>
+{
+    static constexpr size_t value = sizeof(T);
+};
+
+/**
+ * Up to N objects of type T with a free list through the unused entries.
+ */
+template <typename T, size_t N>
+class ObjectPool
+{
+public:
+    ObjectPool() : m_free(nullptr), m_used(0)
+    {
+        for (size_t i = N; i > 0; i--)
+        {
+            Node *node = &m_nodes[i - 1];
+            node->next = m_free;
+            m_free = node;
+        }
+    }
+
+    template <typename... Args>
+    T *create(Args &&...args)
+    {
+        if (m_free == nullptr)
+            return nullptr;
+        Node *node = m_free;
+        m_free = node->next;
+        m_used++;
+        return new (node->storage) T(std::forward<Args>(args)...);
+    }
+
+    void destroy(T *obj)
+    {
+        if (obj == nullptr)
+            return;
+        obj->~T();
+        Node *node = reinterpret_cast<Node *>(obj);
+        node->next = m_free;
+        m_free = node;
+        m_used--;
+    }
+
+    bool owns(const T *obj) const
+    {
+        const Node *node = reinterpret_cast<const Node *>(obj);
+        return node >= &m_nodes[0] && node < &m_nodes[N];
+    }
+
+    size_t used() const { return m_used; }
+    static constexpr size_t capacity() { return N; }
+
+private:
+    union Node {
+        Node *next;
+        alignas(T) uint8_t storage[sizeof(T)];
+    };
+    Node m_nodes[N];
+    Node *m_free;
+    size_t m_used;
+};
+
+/**
+ * Storage for one object of Base or any class derived from it up to Size bytes, replacing
+ * `delete p; p = new Derived(...)` where the object is swapped at runtime.
+ */
+template <typename Base, size_t Size>
+class ObjectSlot
+{
+public:
+    ObjectSlot() : m_obj(nullptr) {}
+    ~ObjectSlot() { destroy(); }
+
+    // Destroys the current object and creates a T in its place
+    template <typename T, typename... Args>
+    T *create(Args &&...args)
+    {
+        static_assert(sizeof(T) <= Size, "ObjectSlot is too small for this type");
+        static_assert(alignof(T) <= alignof(max_align_t), "ObjectSlot is not aligned for this type");
+        destroy();
+        T *obj = new (m_storage) T(std::forward<Args>(args)...);
+        m_obj = obj;
+        return obj;
+    }
+
+    void destroy()
+    {
+        if (m_obj != nullptr)
+        {
+            m_obj->~Base();
+            m_obj = nullptr;
+        }
+    }
+
+    Base *get() const { return m_obj; }
+
+private:
+    alignas(max_align_t) uint8_t m_storage[Size];
+    Base *m_obj;
+};
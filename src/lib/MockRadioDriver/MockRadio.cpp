@@ -0,0 +1,319 @@
+#include "MockRadio.h"
+#include <string.h>
+#include <stdlib.h>
+
+static_assert(SX12xxDriverCheck<MockRadioDriver>::value, "MockRadioDriver does not have the whole radio interface");
+
+const mockRadioConfig_t MockRadioDefaultConfig = {
+    5,      // commandBusyUs
+    50,     // modeBusyUs, about what an SX1280 takes to go from FS to TX
+    80,     // txDelayUs, PA ramp and the first preamble symbol
+    1000,   // timeOnAirUs, set it for the rate
+    20,     // irqLatencyUs
+    -108,   // sensitivityDbm
+    1000,   // captureRange, about 200kHz on an SX1280
+};
+
+uint32_t MockRadioDriver::s_now;
+uint8_t MockRadioDriver::s_pathLossDb = 80;
+MockRadioDriver *MockRadioDriver::s_radios[MOCK_RADIO_MAX];
+
+MockRadioDriver::MockRadioDriver(const mockRadioConfig_t &config)
+    : SX12xxDriverCommon(), txPowerDbm(10), ppmOffset(0), lastFreqError(0), busyWaitUs(0),
+      packetsSent(0), packetsReceived(0), crcErrors(0), m_config(config), m_mode(MOCK_RADIO_SLEEP),
+      m_freqOffset(0), m_busyUntil(0), m_rxSince(0), m_txStart(0), m_txEnd(0), m_txOnAir(false),
+      m_txDonePending(false), m_txDoneAt(0), m_rxDonePending(false), m_rxDoneAt(0),
+      m_rxStatus(SX12XX_RX_OK), m_rxRssi(MOCK_RADIO_NOISE_FLOOR_DBM), m_rxFreqError(0)
+{
+    currFreq = 0;
+    PayloadLength = 0;
+    IQinverted = false;
+    processingPacketRadio = SX12XX_Radio_1;
+    lastSuccessfulPacketRadio = SX12XX_Radio_1;
+    transmittingRadio = SX12XX_Radio_1;
+    LastPacketRSSI = 0;
+    LastPacketRSSI2 = 0;
+    LastPacketSNRRaw = 0;
+    FuzzySNRThreshold = 0;
+}
+
+MockRadioDriver::~MockRadioDriver()
+{
+    End();
+}
+
+bool MockRadioDriver::Begin(uint32_t minimumFrequency, uint32_t maximumFrequency)
+{
+    for (MockRadioDriver *&radio : s_radios)
+    {
+        if (radio == nullptr || radio == this)
+        {
+            radio = this;
+            m_txOnAir = false;
+            m_txDonePending = false;
+            m_rxDonePending = false;
+            setMode(MOCK_RADIO_STANDBY);
+            return true;
+        }
+    }
+    return false;
+}
+
+void MockRadioDriver::End()
+{
+    for (MockRadioDriver *&radio : s_radios)
+    {
+        if (radio == this)
+            radio = nullptr;
+    }
+    m_mode = MOCK_RADIO_SLEEP;
+    m_txOnAir = false;
+    m_txDonePending = false;
+    m_rxDonePending = false;
+    RemoveCallbacks();
+}
+
+void MockRadioDriver::Config(uint8_t bw, uint8_t sf, uint8_t cr, uint32_t freq,
+                             uint8_t PreambleLength, bool InvertIQ, uint8_t PayloadLength,
+                             SX12XX_Radio_Number_t radioNumber)
+{
+    setMode(MOCK_RADIO_STANDBY);
+    command(m_config.commandBusyUs);
+    currFreq = freq;
+    IQinverted = InvertIQ;
+    this->PayloadLength = PayloadLength;
+}
+
+void MockRadioDriver::SetModulation(uint8_t bw, uint8_t sf, uint8_t cr, uint8_t PreambleLength, SX12XX_Radio_Number_t radioNumber)
+{
+    // The air only checks the frequency, IQ and payload length, which this does not change
+    setMode(MOCK_RADIO_STANDBY);
+    command(m_config.commandBusyUs);
+}
+
+void MockRadioDriver::SetFrequencyReg(uint32_t freq, SX12XX_Radio_Number_t radioNumber, bool doRx)
+{
+    command(m_config.commandBusyUs);
+    currFreq = freq;
+    // The receiver has to find the preamble again
+    m_rxSince = m_busyUntil;
+    if (doRx)
+        setMode(MOCK_RADIO_RX);
+}
+
+void MockRadioDriver::SetOutputPower(int8_t power)
+{
+    command(m_config.commandBusyUs);
+    txPowerDbm = power;
+}
+
+void MockRadioDriver::startCWTest(uint32_t freq, SX12XX_Radio_Number_t radioNumber)
+{
+    command(m_config.commandBusyUs);
+    currFreq = freq;
+    setMode(MOCK_RADIO_CW);
+}
+
+void MockRadioDriver::TXnb(uint8_t *data, bool sendGeminiBuffer, uint8_t *dataGemini, SX12XX_Radio_Number_t radioNumber)
+{
+    transmittingRadio = radioNumber;
+
+    // A TX that has not finished has timed out, as on the chips
+    if (m_mode == MOCK_RADIO_TX)
+    {
+        setMode(MOCK_RADIO_FS);
+        TXdoneCallback();
+        return;
+    }
+    if (radioNumber == SX12XX_Radio_NONE)
+    {
+        setMode(MOCK_RADIO_FS);
+        return;
+    }
+
+    memcpy(m_txData, data, PayloadLength);
+    setMode(MOCK_RADIO_TX);
+    m_txStart = m_busyUntil + m_config.txDelayUs;
+    m_txEnd = m_txStart + m_config.timeOnAirUs;
+    m_txOnAir = true;
+}
+
+void MockRadioDriver::RXnb()
+{
+    setMode(MOCK_RADIO_RX);
+}
+
+int8_t MockRadioDriver::GetRssiInst(SX12XX_Radio_Number_t radioNumber)
+{
+    command(m_config.commandBusyUs);
+    int8_t rssi = MOCK_RADIO_NOISE_FLOOR_DBM;
+    for (const MockRadioDriver *other : s_radios)
+    {
+        if (other == nullptr || other == this || abs(other->actualFreq() - actualFreq()) > m_config.captureRange)
+            continue;
+        const bool onAir = other->m_mode == MOCK_RADIO_CW ||
+            (other->m_txOnAir && (int32_t)(s_now - other->m_txStart) >= 0);
+        if (onAir && other->txPowerDbm - s_pathLossDb > rssi)
+            rssi = other->txPowerDbm - s_pathLossDb;
+    }
+    return rssi;
+}
+
+void MockRadioDriver::GetLastPacketStats()
+{
+    int32_t snr = m_rxRssi - MOCK_RADIO_NOISE_FLOOR_DBM;
+    if (snr > MOCK_RADIO_SNR_MAX_DB)
+        snr = MOCK_RADIO_SNR_MAX_DB;
+    if (snr < -MOCK_RADIO_SNR_MAX_DB)
+        snr = -MOCK_RADIO_SNR_MAX_DB;
+    LastPacketRSSI = m_rxRssi;
+    LastPacketSNRRaw = snr * RADIO_SNR_SCALE;
+    lastSuccessfulPacketRadio = processingPacketRadio;
+}
+
+void MockRadioDriver::CheckForSecondPacket()
+{
+    // One radio
+    gotRadio[0] = true;
+    gotRadio[1] = false;
+    hasSecondRadioGotData = false;
+}
+
+void MockRadioDriver::advance(uint32_t us)
+{
+    const uint32_t end = s_now + us;
+    while (true)
+    {
+        // The next event in the time left, events at the same time in the order of the radios
+        MockRadioDriver *next = nullptr;
+        uint32_t nextIn = end - s_now;
+        for (MockRadioDriver *radio : s_radios)
+        {
+            uint32_t at;
+            if (radio != nullptr && radio->nextEvent(at) && at - s_now <= nextIn && (next == nullptr || at - s_now < nextIn))
+            {
+                next = radio;
+                nextIn = at - s_now;
+            }
+        }
+        if (next == nullptr)
+        {
+            s_now = end;
+            return;
+        }
+        s_now += nextIn;
+        next->runEvents(s_now);
+    }
+}
+
+uint32_t MockRadioDriver::command(uint16_t busyUs)
+{
+    // The MCU spins on BUSY before it can send the command
+    uint32_t start = s_now;
+    if (isBusy())
+    {
+        busyWaitUs += m_busyUntil - s_now;
+        start = m_busyUntil;
+    }
+    m_busyUntil = start + busyUs;
+    return start;
+}
+
+void MockRadioDriver::setMode(mockRadioMode_e mode)
+{
+    command(m_config.modeBusyUs);
+    if (mode != MOCK_RADIO_TX)
+        m_txOnAir = false;
+    if (mode == MOCK_RADIO_RX && m_mode != MOCK_RADIO_RX)
+        m_rxSince = m_busyUntil;
+    m_mode = mode;
+}
+
+bool MockRadioDriver::nextEvent(uint32_t &at) const
+{
+    bool found = false;
+    const uint32_t times[] = {m_txEnd, m_txDoneAt, m_rxDoneAt};
+    const bool pending[] = {m_txOnAir, m_txDonePending, m_rxDonePending};
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        if (pending[i] && (!found || times[i] - s_now < at - s_now))
+        {
+            at = times[i];
+            found = true;
+        }
+    }
+    return found;
+}
+
+void MockRadioDriver::runEvents(uint32_t at)
+{
+    if (m_txOnAir && m_txEnd == at)
+        endOfPacket();
+
+    if (m_txDonePending && m_txDoneAt == at)
+    {
+        m_txDonePending = false;
+        TXdoneCallback();
+    }
+
+    if (m_rxDonePending && m_rxDoneAt == at)
+    {
+        m_rxDonePending = false;
+        processingPacketRadio = SX12XX_Radio_1;
+        if (m_rxStatus == SX12XX_RX_OK)
+            memcpy(RXdataBuffer, m_rxData, PayloadLength);
+        lastFreqError = m_rxFreqError;
+        RXdoneCallback(m_rxStatus);
+    }
+}
+
+void MockRadioDriver::endOfPacket()
+{
+    // The chips drop back to FS after a TX
+    m_txOnAir = false;
+    m_mode = MOCK_RADIO_FS;
+    packetsSent++;
+    m_txDonePending = true;
+    m_txDoneAt = s_now + m_config.irqLatencyUs;
+
+    for (MockRadioDriver *radio : s_radios)
+    {
+        if (radio != nullptr && radio != this)
+            radio->receive(*this);
+    }
+}
+
+void MockRadioDriver::receive(const MockRadioDriver &from)
+{
+    // Listening from before the preamble, with the same settings
+    if (m_mode != MOCK_RADIO_RX || (int32_t)(from.m_txStart - m_rxSince) < 0 ||
+        IQinverted != from.IQinverted || PayloadLength != from.PayloadLength)
+        return;
+    const int32_t freqError = actualFreq() - from.actualFreq();
+    const int8_t rssi = from.txPowerDbm - s_pathLossDb;
+    if (abs(freqError) > m_config.captureRange || rssi < m_config.sensitivityDbm)
+        return;
+
+    // Anything else on the air at the same time spoils it
+    rx_status status = SX12XX_RX_OK;
+    for (const MockRadioDriver *other : s_radios)
+    {
+        if (other == nullptr || other == this || other == &from || abs(other->actualFreq() - actualFreq()) > m_config.captureRange)
+            continue;
+        const bool sent = other->m_txOnAir || other->packetsSent != 0;
+        const bool overlaps = (int32_t)(other->m_txStart - from.m_txEnd) < 0 && (int32_t)(other->m_txEnd - from.m_txStart) > 0;
+        if (other->m_mode == MOCK_RADIO_CW || (sent && overlaps))
+            status = SX12XX_RX_CRC_FAIL;
+    }
+
+    memcpy(m_rxData, from.m_txData, PayloadLength);
+    m_rxStatus = status;
+    m_rxRssi = rssi;
+    m_rxFreqError = freqError;
+    m_rxDonePending = true;
+    m_rxDoneAt = s_now + m_config.irqLatencyUs;
+    if (status == SX12XX_RX_OK)
+        packetsReceived++;
+    else
+        crcErrors++;
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+#include "SX12xxDriverCommon.h"
+
+/*
+ * A radio driver with no radio, for running the link code in native tests.
+ *
+ * It has the same methods as the chip drivers (see SX12xxDriverCheck). All the MockRadioDrivers
+ * that have been begun share one simulated air and one simulated clock, which only moves when
+ * advance() is called. A packet sent by one is received by every other one that was in RX on the
+ * same frequency, IQ and payload length from before the packet started, strong enough after the
+ * path loss, and within the capture range of its frequency. Packets that overlap on the air are
+ * received with a CRC error.
+ *
+ * The timing follows the chips: every command keeps BUSY high for a while and a command sent
+ * while BUSY is high waits for it, which is added up in busyWaitUs. A TX goes on the air
+ * txDelayUs after its command and lasts timeOnAirUs, the TX done and RX done IRQs come
+ * irqLatencyUs after the end of the packet. The callbacks are called from advance(), as the ISR
+ * would call them.
+ *
+ * Frequencies are in frequency register steps, as currFreq is. Each radio can have a crystal
+ * offset in the same steps, which the receiver sees as a frequency error.
+ */
+
+#ifndef RADIO_SNR_SCALE
+#define RADIO_SNR_SCALE 4
+#endif
+
+#define MOCK_RADIO_MAX 4
+#define MOCK_RADIO_NOISE_FLOOR_DBM -110     // instant RSSI with nothing on the air
+#define MOCK_RADIO_SNR_MAX_DB 31            // the most that fits in LastPacketSNRRaw
+
+typedef enum : uint8_t {
+    MOCK_RADIO_SLEEP,
+    MOCK_RADIO_STANDBY,
+    MOCK_RADIO_FS,
+    MOCK_RADIO_TX,
+    MOCK_RADIO_RX,
+    MOCK_RADIO_CW,
+} mockRadioMode_e;
+
+typedef struct {
+    uint16_t commandBusyUs;     // BUSY after a command that does not change the mode
+    uint16_t modeBusyUs;        // BUSY after a change of mode
+    uint16_t txDelayUs;         // from the TX command to the packet going on the air
+    uint16_t timeOnAirUs;
+    uint16_t irqLatencyUs;      // from the end of the packet to the IRQ
+    int8_t sensitivityDbm;      // weakest packet that is received
+    uint16_t captureRange;      // largest frequency error a packet is received with
+} mockRadioConfig_t;
+
+extern const mockRadioConfig_t MockRadioDefaultConfig;
+
+class MockRadioDriver : public SX12xxDriverCommon
+{
+public:
+    explicit MockRadioDriver(const mockRadioConfig_t &config = MockRadioDefaultConfig);
+    ~MockRadioDriver();
+
+    ////////////////The radio interface/////////////
+    bool Begin(uint32_t minimumFrequency, uint32_t maximumFrequency);
+    void End();
+    void SetTxIdleMode() { setMode(MOCK_RADIO_FS); }
+    void Config(uint8_t bw, uint8_t sf, uint8_t cr, uint32_t freq,
+                uint8_t PreambleLength, bool InvertIQ, uint8_t PayloadLength,
+                SX12XX_Radio_Number_t radioNumber = SX12XX_Radio_All);
+    void SetModulation(uint8_t bw, uint8_t sf, uint8_t cr, uint8_t PreambleLength, SX12XX_Radio_Number_t radioNumber);
+    void SetFrequencyReg(uint32_t freq, SX12XX_Radio_Number_t radioNumber, bool doRx = false);
+    void SetOutputPower(int8_t power);
+    void startCWTest(uint32_t freq, SX12XX_Radio_Number_t radioNumber);
+    void cwRepeat(SX12XX_Radio_Number_t radioNumber) {}
+
+    bool FrequencyErrorAvailable() const { return LastPacketSNRRaw > 0; }
+    // The receiver less the transmitter, FreqCorrection goes up by it to take the receiver down
+    int32_t GetFrequencyError(SX12XX_Radio_Number_t radioNumber) { return lastFreqError; }
+    // True if the receiver is below the transmitter, the FreqCorrection has to go down
+    bool GetFrequencyErrorbool(SX12XX_Radio_Number_t radioNumber) { return lastFreqError < 0; }
+    void SetPPMoffsetReg(int32_t offset, SX12XX_Radio_Number_t radioNumber) { ppmOffset = offset; }
+
+    void TXnb(uint8_t *data, bool sendGeminiBuffer, uint8_t *dataGemini, SX12XX_Radio_Number_t radioNumber);
+    void RXnb();
+
+    void StartRssiInst(SX12XX_Radio_Number_t radioNumber) { command(m_config.commandBusyUs); }
+    int8_t GetRssiInst(SX12XX_Radio_Number_t radioNumber);
+    void GetLastPacketStats();
+    void CheckForSecondPacket();
+
+    ////////////////The simulation/////////////
+    // Run the air for us, calling the callbacks of the IRQs that come in that time
+    static void advance(uint32_t us);
+    static uint32_t now() { return s_now; }
+    static void setPathLoss(uint8_t dB) { s_pathLossDb = dB; }
+
+    void setFrequencyOffset(int32_t offset) { m_freqOffset = offset; }
+    void setTimeOnAir(uint16_t us) { m_config.timeOnAirUs = us; }
+    bool isBusy() const { return (int32_t)(m_busyUntil - s_now) > 0; }
+    mockRadioMode_e mode() const { return m_mode; }
+
+    int8_t txPowerDbm;
+    int32_t ppmOffset;          // last SetPPMoffsetReg
+    int32_t lastFreqError;      // of the last packet received
+    uint32_t busyWaitUs;        // time spent waiting for BUSY to go low
+    uint32_t packetsSent;
+    uint32_t packetsReceived;
+    uint32_t crcErrors;
+
+private:
+    static uint32_t s_now;
+    static uint8_t s_pathLossDb;
+    static MockRadioDriver *s_radios[MOCK_RADIO_MAX];
+
+    mockRadioConfig_t m_config;
+    mockRadioMode_e m_mode;
+    int32_t m_freqOffset;
+    uint32_t m_busyUntil;
+    uint32_t m_rxSince;         // listening on this frequency since
+    // The last packet sent
+    uint32_t m_txStart;
+    uint32_t m_txEnd;
+    bool m_txOnAir;
+    uint8_t m_txData[RXBuffSize];
+    // IRQs still to come
+    bool m_txDonePending;
+    uint32_t m_txDoneAt;
+    bool m_rxDonePending;
+    uint32_t m_rxDoneAt;
+    rx_status m_rxStatus;
+    uint8_t m_rxData[RXBuffSize];
+    int8_t m_rxRssi;
+    int32_t m_rxFreqError;
+
+    uint32_t command(uint16_t busyUs);
+    void setMode(mockRadioMode_e mode);
+    int32_t actualFreq() const { return (int32_t)currFreq + m_freqOffset; }
+    bool nextEvent(uint32_t &at) const;
+    void runEvents(uint32_t at);
+    void endOfPacket();
+    void receive(const MockRadioDriver &from);
+};
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "targets.h"
+
+/*
+ * Binary copy of the hardware layout, written by UnifiedConfiguration.py after the hardware JSON.
+ *
+ * Header, then one int32 for every nameType in enum order (INT/COUNT as int, BOOL as 0/1,
+ * FLOAT as its IEEE bits, ARRAY as an index into the pool or -1), then the pool of int16 array
+ * values. The values can be copied straight into the hardware table. The schema is the CRC32
+ * of the field table so a configurator with a different table is ignored and the JSON is used.
+ */
+
+#define HARDWARE_LAYOUT_MAGIC 0x57484C45 // "ELHW"
+#define HARDWARE_LAYOUT_VERSION 1
+
+typedef struct {
+    uint32_t magic;
+    uint8_t version;
+    uint8_t fieldCount;
+    uint16_t poolCount;     // number of int16 in the pool
+    uint32_t schema;
+    uint32_t crc;           // CRC32 of the values and the pool
+} __attribute__((packed)) hardwareLayoutHeader_t;
+
+typedef enum {
+    INT,
+    BOOL,
+    FLOAT,
+    ARRAY,
+    COUNT
+} datatype_t;
+
+typedef struct {
+    const nameType position;
+    const char *name;
+    const datatype_t type;
+} hardwareField_t;
+
+// The hardware JSON fields, in nameType order
+extern const hardwareField_t hardwareFields[HARDWARE_LAST];
+
+uint32_t hardwareLayout_Crc32(const void *data, size_t len, uint32_t crc = 0);
+
+// CRC32 of the field names and types, must match schema() in python/hardware_layout.py
+uint32_t hardwareLayout_Schema();
+
+/**
+ * @brief Check the header of a layout is for this field table
+ * @return the size of the values and the pool after the header, or 0 if it can not be used
+ */
+size_t hardwareLayout_CheckHeader(const hardwareLayoutHeader_t &header, uint8_t fieldCount, uint32_t schema);
+
+/**
+ * @brief Check the layout in blob is complete, uncorrupted and made for this field table
+ * @return the total size of the layout, or 0 if it can not be used
+ */
+size_t hardwareLayout_Check(const uint8_t *blob, size_t len, uint8_t fieldCount, uint32_t schema);
@@ -78,6 +78,7 @@ void saveOptions(Stream &stream, bool customised)
     doc["tlm-interval"] = firmwareOptions.tlm_report_interval;
     doc["fan-runtime"] = firmwareOptions.fan_min_runtime;
     doc["unlock-higher-power"] = firmwareOptions.unlock_higher_power;
+    doc["rate-adapt"] = firmwareOptions.rate_adapt;
     doc["airport-uart-baud"] = firmwareOptions.uart_baud;
     #else
     doc["rcvr-uart-baud"] = firmwareOptions.uart_baud;
@@ -94,6 +95,7 @@ void saveOptions(Stream &stream, bool customised)
 
 void saveOptions()
 {
+    firmwareOptions.customised = true;
     File options = SPIFFS.open("/options.json", "w");
     saveOptions(options, true);
     options.close();
@@ -180,6 +182,7 @@ static void options_LoadFromFlashOrFile(EspFlashStream &strmFlash)
     firmwareOptions.tlm_report_interval = doc["tlm-interval"] | 240U;
     firmwareOptions.fan_min_runtime = doc["fan-runtime"] | 30U;
     firmwareOptions.unlock_higher_power = doc["unlock-higher-power"] | false;
+    firmwareOptions.rate_adapt = doc["rate-adapt"] | false;
     #if defined(USE_AIRPORT_AT_BAUD)
     firmwareOptions.uart_baud = doc["airport-uart-baud"] | USE_AIRPORT_AT_BAUD;
     firmwareOptions.is_airport = doc["is-airport"] | true;
@@ -200,9 +203,10 @@ static void options_LoadFromFlashOrFile(EspFlashStream &strmFlash)
     #endif
     firmwareOptions.domain = doc["domain"] | 0;
     firmwareOptions.flash_discriminator = doc["flash-discriminator"] | 0U;
+    firmwareOptions.customised = doc["customised"] | false;
 
     builtinOptions.clear();
-    saveOptions(builtinOptions, doc["customised"] | false);
+    saveOptions(builtinOptions, firmwareOptions.customised);
 }
 
 /**
@@ -283,7 +287,8 @@ bool options_init()
         ELRSOPTS_PRODUCTNAME_SIZE +
         ELRSOPTS_DEVICENAME_SIZE +
         ELRSOPTS_OPTIONS_SIZE +
-        ELRSOPTS_HARDWARE_SIZE;
+        ELRSOPTS_HARDWARE_SIZE +
+        ELRSOPTS_LAYOUT_SIZE;
 
     debugFreeInitLogger();
 
@@ -24,6 +24,7 @@ typedef struct _options {
     uint8_t     domain;         // depends on radio chip
     uint8_t     hasUID;
     uint8_t     uid[6];         // MY_UID derived from MY_BINDING_PHRASE
+    uint8_t     customised;     // the options were saved from the web UI, overriding the flashed ones
     uint32_t    flash_discriminator;    // Discriminator value used to determine if the device has been reflashed and therefore
                                         // the SPIFSS settings are obsolete and the flashed settings should be used in preference
     uint32_t    fan_min_runtime;
@@ -39,18 +40,21 @@ typedef struct _options {
 #endif
 #if defined(TARGET_TX) || defined(UNIT_TEST)
     uint32_t    tlm_report_interval;
-    bool        _unused1:1;
+    bool        rate_adapt:1;
     bool        unlock_higher_power:1;
     bool        is_airport:1;
     uint32_t    uart_baud;              // only use for airport
 #endif
 } __attribute__((packed)) firmware_options_t;
 
-// Layout is PRODUCTNAME DEVICENAME OPTIONS HARDWARE
+// Layout is PRODUCTNAME DEVICENAME OPTIONS HARDWARE LAYOUT [LOGO]
 constexpr size_t ELRSOPTS_PRODUCTNAME_SIZE = 128;
 constexpr size_t ELRSOPTS_DEVICENAME_SIZE = 16;
 constexpr size_t ELRSOPTS_OPTIONS_SIZE = 512;
 constexpr size_t ELRSOPTS_HARDWARE_SIZE = 2048;
+// Binary copy of the hardware layout, see HardwareLayout.h. The slot is always there
+// (zero filled when there is no copy) so the logo is at a fixed offset
+constexpr size_t ELRSOPTS_LAYOUT_SIZE = 1024;
 
 extern firmware_options_t firmwareOptions;
 extern bool options_init();
@@ -36,11 +36,21 @@ typedef struct {
             newTlmRatio:3,
             geminiMode:1,
             otaProtocol:2,
-            free:1;
+            rateSwitch:1;   // rfRateEnum is a change announced for OtaRateSwitchNonce(nonce)
     uint8_t UID4;
     uint8_t UID5;
 } PACKED OTA_Sync_s;
 
+// An announced rate change takes effect on both ends at the end of the block of nonces it is
+// announced in, which is also an FHSS hop boundary for every rate
+#define OTA_RATE_SWITCH_BLOCK 64
+#define OTA_RATE_SWITCH_NONE 0xff
+
+inline uint8_t OtaRateSwitchNonce(uint8_t nonce)
+{
+    return (nonce | (OTA_RATE_SWITCH_BLOCK - 1)) + 1;
+}
+
 typedef struct {
     uint8_t uplink_RSSI_1:7,
             antenna:1;
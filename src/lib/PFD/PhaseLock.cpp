@@ -0,0 +1,182 @@
+#include "PhaseLock.h"
+
+// Largest crystal error the frequency estimate starts out allowing for
+#define PHASELOCK_MAX_PPM 100
+
+#define PHASE_Q 4
+#define FREQ_Q 12
+
+const phaseLockConfig_t PhaseLockDefaultConfig = {
+    true,   // kalman
+    5,      // ticksPerUs, the RX hwTimer on ESP32 and ESP8266
+    1,      // kpShiftAcquire, half the offset as before
+    2,      // kpShiftTrack
+    6,      // kiShift, critically damped with kpShiftTrack 2
+    2,      // kfShift
+    16,     // measurementVar, 4us of timestamp jitter
+    64,     // phaseVarQ8, 0.25us^2
+    17,     // freqVarQ24, 1e-6 (us/period)^2
+};
+
+// Divide by 2^shift rounding to nearest
+static inline int32_t roundShift(int64_t value, uint8_t shift)
+{
+    return shift == 0 ? value : (value + ((int64_t)1 << (shift - 1))) >> shift;
+}
+
+PhaseLock::PhaseLock()
+    : m_config(PhaseLockDefaultConfig), m_intervalUs(0), m_maxPhaseShift(0)
+{
+    reset();
+}
+
+void PhaseLock::begin(uint32_t intervalUs, const phaseLockConfig_t &config)
+{
+    m_config = config;
+    m_intervalUs = intervalUs;
+    // Same limit as hwTimer::phaseShift()
+    m_maxPhaseShift = intervalUs / 4;
+    reset();
+}
+
+void PhaseLock::reset()
+{
+    m_phaseShift = 0;
+    m_freqOffset = 0;
+    m_freqQ8 = 0;
+    m_lastOffset = 0;
+    m_phase = 0;
+    m_freq = 0;
+    m_freqTarget = 0;
+    // The first sample can be anywhere in the phase shift range, and the crystal up to
+    // PHASELOCK_MAX_PPM out
+    m_p00 = ((int64_t)m_maxPhaseShift * m_maxPhaseShift) << (2 * PHASE_Q);
+    m_p01 = 0;
+    // Squared after scaling, the square of the interval in ppm^2 << 24 does not fit above ~7ms
+    const int64_t maxFreq = ((int64_t)m_intervalUs * PHASELOCK_MAX_PPM << FREQ_Q) / 1000000;
+    m_p11 = maxFreq * maxFreq;
+}
+
+/**
+ * The crystal error is the same in ppm at any interval, so what is held per period scales with
+ * the interval, and the variances with its square. The phase is in us and stays as it is.
+ */
+void ICACHE_RAM_ATTR PhaseLock::setInterval(uint32_t intervalUs)
+{
+    const uint32_t from = m_intervalUs;
+    if (from == 0)
+    {
+        begin(intervalUs, m_config);
+        return;
+    }
+    if (intervalUs == from)
+        return;
+
+    m_freqOffset = (int64_t)m_freqOffset * intervalUs / from;
+    m_freqQ8 = (int64_t)m_freqQ8 * intervalUs / from;
+    m_freq = (int64_t)m_freq * intervalUs / from;
+    m_freqTarget = (int64_t)m_freqTarget * intervalUs / from;
+    m_p01 = m_p01 * intervalUs / from;
+    m_p11 = m_p11 * intervalUs / from * intervalUs / from;
+
+    m_intervalUs = intervalUs;
+    m_maxPhaseShift = intervalUs / 4;
+    setPhaseShift(m_phaseShift);
+}
+
+int32_t PhaseLock::phaseError() const
+{
+    return m_config.kalman ? roundShift(m_phase, PHASE_Q) : m_lastOffset;
+}
+
+void ICACHE_RAM_ATTR PhaseLock::setPhaseShift(int32_t shift)
+{
+    if (shift > m_maxPhaseShift)
+        shift = m_maxPhaseShift;
+    else if (shift < -m_maxPhaseShift)
+        shift = -m_maxPhaseShift;
+    m_phaseShift = shift;
+}
+
+/**
+ * Move the state on by one period. The phase error grows by the frequency error not corrected
+ * and shrinks by the phase shift made at the end of the last period.
+ */
+void ICACHE_RAM_ATTR PhaseLock::predict()
+{
+    const uint8_t shift = FREQ_Q - PHASE_Q;
+    m_phase += roundShift(m_freq, shift) - (m_phaseShift << PHASE_Q);
+    m_p00 += ((2 * m_p01) >> shift) + (m_p11 >> (2 * shift)) + m_config.phaseVarQ8;
+    m_p01 += m_p11 >> shift;
+    m_p11 += m_config.freqVarQ24;
+}
+
+void ICACHE_RAM_ATTR PhaseLock::correct(int32_t offsetUs)
+{
+    // Anything further out than a phase shift can fix is not this TX's timing
+    if (offsetUs > 2 * m_maxPhaseShift)
+        offsetUs = 2 * m_maxPhaseShift;
+    else if (offsetUs < -2 * m_maxPhaseShift)
+        offsetUs = -2 * m_maxPhaseShift;
+
+    const int64_t innovation = ((int64_t)offsetUs << PHASE_Q) - m_phase;
+    const int64_t r = (int64_t)m_config.measurementVar << (2 * PHASE_Q);
+    const int64_t s = m_p00 + r;
+    m_phase += m_p00 * innovation / s;
+    m_freq += m_p01 * innovation / s;
+    m_p11 -= m_p01 * m_p01 / s;
+    m_p00 = m_p00 * r / s;
+    m_p01 = m_p01 * r / s;
+}
+
+void ICACHE_RAM_ATTR PhaseLock::control(bool tracking)
+{
+    const uint8_t kpShift = tracking ? m_config.kpShiftTrack : m_config.kpShiftAcquire;
+    setPhaseShift(roundShift(m_phase, PHASE_Q + kpShift));
+
+    if (!tracking)
+        return;
+
+    // The hwTimer only takes whole ticks, the target keeps moving until the next tick is
+    // reached so the offset dithers between the two ticks either side of the right value
+    m_freqTarget += roundShift(m_freq, m_config.kfShift);
+    const int32_t ticks = roundShift((int64_t)m_freqTarget * m_config.ticksPerUs, FREQ_Q + 1);
+    // A tick per half period is 2/ticksPerUs us per period
+    m_freq -= ((ticks - m_freqOffset) << (FREQ_Q + 1)) / m_config.ticksPerUs;
+    m_freqOffset = ticks;
+}
+
+void ICACHE_RAM_ATTR PhaseLock::update(int32_t offsetUs, bool tracking)
+{
+    if (m_config.kalman)
+    {
+        predict();
+        correct(offsetUs);
+        control(tracking);
+        return;
+    }
+
+    m_lastOffset = offsetUs;
+    const uint8_t kpShift = tracking ? m_config.kpShiftTrack : m_config.kpShiftAcquire;
+    setPhaseShift(offsetUs >> kpShift);
+    if (tracking)
+    {
+        // us per period of frequency for each us of error, in ticks per half period << 8
+        m_freqQ8 += (offsetUs * m_config.ticksPerUs * 128) >> m_config.kiShift;
+        m_freqOffset = roundShift(m_freqQ8, 8);
+    }
+}
+
+void ICACHE_RAM_ATTR PhaseLock::missed(bool tracking)
+{
+    if (m_config.kalman)
+    {
+        // Keep correcting what the estimate says the error has become
+        predict();
+        control(tracking);
+        return;
+    }
+
+    // Nothing new to act on
+    m_phaseShift = 0;
+}
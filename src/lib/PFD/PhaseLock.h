@@ -0,0 +1,89 @@
+#pragma once
+
+#include "targets.h"
+#include <stdint.h>
+
+/*
+ * Phase lock loop that keeps the RX timer's tock aligned with the TX's packets.
+ *
+ * Each packet period it is given the PFD offset (the time the packet arrived less the time of
+ * the tock, in us) or told that no packet arrived. It returns the phase shift for this period and
+ * the frequency offset for the hwTimer. The loop is a PI controller: the phase shift is the
+ * proportional part, the frequency offset integrates the error so the RX timer runs at the TX's
+ * rate and the phase stays put between packets.
+ *
+ * With the Kalman estimator the controller acts on estimates of the phase error and of the
+ * remaining frequency error instead of the raw offsets. The estimator predicts through lost
+ * packets, so the loop keeps correcting the drift it knows about while there are no samples, and
+ * weighs the next sample by how uncertain the prediction has become.
+ *
+ * While acquiring only the phase is corrected, with a higher gain. Tracking adds the frequency.
+ *
+ * It runs in the timer ISR so it is all integer, the ESP32 can not use the FPU in an ISR.
+ */
+
+typedef struct {
+    bool kalman;            // use the Kalman estimator, else PI on the raw offsets
+    uint8_t ticksPerUs;     // hwTimer ticks per us, the frequency offset is in ticks per half period
+    uint8_t kpShiftAcquire; // phase gain 2^-n while acquiring
+    uint8_t kpShiftTrack;   // phase gain 2^-n while tracking
+    uint8_t kiShift;        // PI: frequency gain 2^-n, us per period per us of phase error
+    uint8_t kfShift;        // Kalman: fraction 2^-n of the estimated frequency error removed per period
+    uint16_t measurementVar;    // Kalman: variance of the PFD offset, us^2
+    uint16_t phaseVarQ8;        // Kalman: phase noise added per period, us^2 / 2^8
+    uint16_t freqVarQ24;        // Kalman: frequency wander per period, (us/period)^2 / 2^24
+} phaseLockConfig_t;
+
+extern const phaseLockConfig_t PhaseLockDefaultConfig;
+
+class PhaseLock
+{
+public:
+    PhaseLock();
+
+    // Start from no knowledge of the phase or frequency, for a new packet interval
+    void begin(uint32_t intervalUs, const phaseLockConfig_t &config = PhaseLockDefaultConfig);
+    // Forget the phase and frequency, keeps the interval and config
+    void reset();
+    // A new packet interval on the same link, the crystal error is kept and scaled to it
+    void setInterval(uint32_t intervalUs);
+
+    /**
+     * One packet period with a PFD offset
+     * @param tracking correct the frequency as well as the phase
+     */
+    void update(int32_t offsetUs, bool tracking);
+    // One packet period without a packet
+    void missed(bool tracking);
+
+    // Phase shift to apply this period, us
+    int32_t phaseShift() const { return m_phaseShift; }
+    // Frequency offset for the hwTimer, ticks per half period
+    int32_t freqOffset() const { return m_freqOffset; }
+    // Estimated phase error (the last offset without the Kalman estimator), us
+    int32_t phaseError() const;
+    // Variance of the Kalman frequency estimate, (us per period)^2 << 24
+    int64_t freqVariance() const { return m_p11; }
+
+private:
+    phaseLockConfig_t m_config;
+    uint32_t m_intervalUs;
+    int32_t m_maxPhaseShift;
+    int32_t m_phaseShift;
+    int32_t m_freqOffset;
+    int32_t m_freqQ8;       // PI integrator, ticks per half period << 8
+    int32_t m_lastOffset;
+    // Kalman state: phase error in us << 4, frequency error in us per period << 12
+    int32_t m_phase;
+    int32_t m_freq;
+    int32_t m_freqTarget;   // frequency correction wanted, us per period << 12
+    // and its covariance, scaled to match: << 8, << 16, << 24
+    int64_t m_p00;
+    int64_t m_p01;
+    int64_t m_p11;
+
+    void predict();
+    void correct(int32_t offsetUs);
+    void control(bool tracking);
+    void setPhaseShift(int32_t shift);
+};
@@ -0,0 +1,67 @@
+#include "profiler.h"
+
+#if defined(DEBUG_ISR_PROFILE)
+#include <stdio.h>
+
+namespace Profiler
+{
+    ProfileProbeStats probes[PROFILE_PROBE_COUNT];
+    uint32_t intervalUs = 0;
+    uint32_t cyclesPerUs = 1;
+
+    static const char *const probeNames[PROFILE_PROBE_COUNT] = {
+        "Tick",
+        "Tock",
+        "SendRC",
+        "RXdone",
+        "TXdone",
+    };
+
+    void init()
+    {
+#if defined(TARGET_NATIVE)
+        cyclesPerUs = 1;
+#else
+        cyclesPerUs = clockCyclesPerMicrosecond();
+#endif
+        reset();
+    }
+
+    void reset()
+    {
+        for (uint8_t i = 0; i < PROFILE_PROBE_COUNT; ++i)
+            probes[i].reset();
+    }
+
+    void setInterval(const uint32_t interval)
+    {
+        // A new packet rate makes the previous worst cases meaningless
+        if (interval != intervalUs)
+        {
+            intervalUs = interval;
+            reset();
+        }
+    }
+
+    const char *name(const profileProbe_e probe)
+    {
+        return probe < PROFILE_PROBE_COUNT ? probeNames[probe] : "";
+    }
+
+    char *format(const profileProbe_e probe, char *buf, const uint8_t len)
+    {
+        const ProfileProbeStats &stats = probes[probe];
+        if (stats.count() == 0)
+        {
+            snprintf(buf, len, "-");
+        }
+        else
+        {
+            snprintf(buf, len, "%u/%u/%uus %u%%",
+                (unsigned)stats.min(), (unsigned)stats.mean(), (unsigned)stats.max(),
+                (unsigned)stats.maxPercentOf(intervalUs));
+        }
+        return buf;
+    }
+}
+#endif
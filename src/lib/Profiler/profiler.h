@@ -0,0 +1,137 @@
+#pragma once
+
+#include "targets.h"
+#include <stdint.h>
+
+/**
+ * Execution time statistics for a single ISR or callback.
+ *
+ * Samples are in microseconds. The minimum, maximum, mean and a power of two
+ * histogram are kept so the worst case can be compared to the packet interval.
+ * add() is safe to call from an ISR, readers in the main loop may see a sample
+ * that is partially applied, which is acceptable for diagnostics.
+ */
+class ProfileProbeStats
+{
+public:
+    // Bucket 0 holds samples below BUCKET0_US, bucket n holds samples below BUCKET0_US << n
+    // and the last bucket holds everything that did not fit in the others
+    static constexpr uint8_t BUCKETS = 8;
+    static constexpr uint32_t BUCKET0_US = 8;
+
+    ProfileProbeStats()
+    {
+        reset();
+    }
+
+    void reset()
+    {
+        m_count = 0;
+        m_min = UINT32_MAX;
+        m_max = 0;
+        m_sum = 0;
+        for (uint8_t i = 0; i < BUCKETS; ++i)
+            m_histogram[i] = 0;
+    }
+
+    void ICACHE_RAM_ATTR add(const uint32_t us)
+    {
+        ++m_count;
+        m_sum += us;
+        if (us < m_min)
+            m_min = us;
+        if (us > m_max)
+            m_max = us;
+
+        uint8_t bucket = 0;
+        uint32_t limit = BUCKET0_US;
+        while (bucket < BUCKETS - 1 && us >= limit)
+        {
+            ++bucket;
+            limit <<= 1;
+        }
+        ++m_histogram[bucket];
+    }
+
+    uint32_t count() const { return m_count; }
+    uint32_t min() const { return m_count ? m_min : 0; }
+    uint32_t max() const { return m_max; }
+    uint32_t mean() const { return m_count ? (uint32_t)(m_sum / m_count) : 0; }
+    uint32_t bucket(const uint8_t idx) const { return idx < BUCKETS ? m_histogram[idx] : 0; }
+
+    /* Worst case execution time as a percentage of intervalUs, 0 if the interval is unknown */
+    uint32_t maxPercentOf(const uint32_t intervalUs) const
+    {
+        return intervalUs ? (m_max * 100U) / intervalUs : 0;
+    }
+
+private:
+    uint32_t m_count;
+    uint32_t m_min;
+    uint32_t m_max;
+    uint64_t m_sum;
+    uint32_t m_histogram[BUCKETS];
+};
+
+enum profileProbe_e : uint8_t
+{
+    PROFILE_TIMER_TICK,     // RX HWtimerCallbackTick
+    PROFILE_TIMER_TOCK,     // RX HWtimerCallbackTock, TX timerCallback
+    PROFILE_SEND_RC,        // TX SendRCdataToRF
+    PROFILE_RX_DONE,        // RXdoneISR
+    PROFILE_TX_DONE,        // TXdoneISR
+    PROFILE_PROBE_COUNT
+};
+
+#if defined(DEBUG_ISR_PROFILE)
+
+namespace Profiler
+{
+    extern ProfileProbeStats probes[PROFILE_PROBE_COUNT];
+    extern uint32_t intervalUs;
+    extern uint32_t cyclesPerUs;
+
+    /* Must be called before any probe fires to latch the CPU clock used to convert cycles to us */
+    void init();
+    void reset();
+    void setInterval(uint32_t interval);
+    const char *name(profileProbe_e probe);
+    /* Format "min/mean/max us (pct%)" for display on a handset, returns buf */
+    char *format(profileProbe_e probe, char *buf, uint8_t len);
+
+    static inline uint32_t ICACHE_RAM_ATTR timestamp()
+    {
+#if defined(TARGET_NATIVE)
+        return micros();
+#else
+        return ESP.getCycleCount();
+#endif
+    }
+}
+
+/* Measures the lifetime of the enclosing scope and adds it to the probe's statistics */
+class ProfileScope
+{
+public:
+    explicit ICACHE_RAM_ATTR ProfileScope(const profileProbe_e probe)
+        : m_probe(probe), m_start(Profiler::timestamp()) {}
+
+    ICACHE_RAM_ATTR ~ProfileScope()
+    {
+        const uint32_t elapsed = Profiler::timestamp() - m_start;
+        Profiler::probes[m_probe].add(elapsed / Profiler::cyclesPerUs);
+    }
+
+private:
+    const profileProbe_e m_probe;
+    const uint32_t m_start;
+};
+
+#define PROFILE_INIT() Profiler::init()
+#define PROFILE_SCOPE(probe) ProfileScope profileScope_##probe(probe)
+#define PROFILE_SET_INTERVAL(interval) Profiler::setInterval(interval)
+#else
+#define PROFILE_INIT()
+#define PROFILE_SCOPE(probe)
+#define PROFILE_SET_INTERVAL(interval)
+#endif
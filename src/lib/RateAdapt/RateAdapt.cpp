@@ -0,0 +1,138 @@
+#include "RateAdapt.h"
+
+#include <string.h>
+
+const rateAdaptConfig_t RateAdaptDefaultConfig = {
+    70,     // lqDown
+    95,     // lqUp
+    6,      // rssiMarginDown
+    15,     // rssiMarginUp
+    8,      // snrMarginUp, 2dB at RADIO_SNR_SCALE 4
+    3,      // samplesDown
+    10,     // samplesUp
+    1000,   // holdDownMs
+    5000,   // holdUpMs
+    3,      // maxBackoff
+};
+
+RateAdaptPolicy::RateAdaptPolicy()
+    : m_config(RateAdaptDefaultConfig), m_count(0), m_level(0), m_good(0), m_poor(0), m_backoff(0),
+      m_lastChange(0), m_lastUp(false)
+{
+}
+
+void RateAdaptPolicy::begin(const rateAdaptRate_t *rates, uint8_t count, uint32_t now, const rateAdaptConfig_t &config)
+{
+    if (count > RATE_ADAPT_MAX_RATES)
+        count = RATE_ADAPT_MAX_RATES;
+    memcpy(m_rates, rates, count * sizeof(rateAdaptRate_t));
+    m_config = config;
+    m_count = count;
+    m_level = 0;
+    m_good = 0;
+    m_poor = 0;
+    m_backoff = 0;
+    m_lastChange = now;
+    m_lastUp = false;
+}
+
+const rateAdaptRate_t &RateAdaptPolicy::rateAt(uint8_t level) const
+{
+    return m_rates[level < m_count ? level : m_count - 1];
+}
+
+uint8_t RateAdaptPolicy::rateIndex() const
+{
+    return rateAt(m_level).index;
+}
+
+uint8_t RateAdaptPolicy::tlmShift() const
+{
+    return m_level < m_count ? 0 : m_level - m_count + 1;
+}
+
+bool RateAdaptPolicy::isPoor(const rateAdaptSample_t &sample) const
+{
+    const rateAdaptRate_t &rate = rateAt(m_level);
+    if (sample.lq < m_config.lqDown)
+        return true;
+    if (sample.rssi < rate.sensitivity + m_config.rssiMarginDown)
+        return true;
+    return rate.snrThreshold != RATE_ADAPT_SNR_NONE && sample.snr < rate.snrThreshold;
+}
+
+bool RateAdaptPolicy::isGood(const rateAdaptSample_t &sample) const
+{
+    if (m_level == 0)
+        return false;
+    // The rate one step up, which is the current rate when coming back from a slower telemetry ratio
+    const rateAdaptRate_t &faster = rateAt(m_level - 1);
+    if (sample.lq < m_config.lqUp)
+        return false;
+    if (sample.rssi < faster.sensitivity + m_config.rssiMarginUp)
+        return false;
+    return faster.snrThreshold == RATE_ADAPT_SNR_NONE || sample.snr >= faster.snrThreshold + m_config.snrMarginUp;
+}
+
+void RateAdaptPolicy::stepTo(uint32_t now, uint8_t level)
+{
+    if (level > m_level && m_lastUp && now - m_lastChange < ((uint32_t)m_config.holdUpMs << m_backoff))
+    {
+        // Stepping back down soon after the last step up, wait longer before trying again
+        if (m_backoff < m_config.maxBackoff)
+            m_backoff++;
+    }
+    m_lastUp = level < m_level;
+    m_level = level;
+    m_lastChange = now;
+    m_good = 0;
+    m_poor = 0;
+}
+
+bool RateAdaptPolicy::update(uint32_t now, const rateAdaptSample_t &sample)
+{
+    if (m_count == 0)
+        return false;
+
+    // Staying put for the longest hold time shows the link has settled, forget earlier failed up steps
+    if (m_backoff != 0 && now - m_lastChange >= ((uint32_t)m_config.holdUpMs << m_config.maxBackoff))
+        m_backoff = 0;
+
+    if (isPoor(sample))
+    {
+        m_good = 0;
+        if (m_poor < 255)
+            m_poor++;
+    }
+    else if (isGood(sample))
+    {
+        m_poor = 0;
+        if (m_good < 255)
+            m_good++;
+    }
+    else
+    {
+        // Between the thresholds, both runs have to start again
+        m_good = 0;
+        m_poor = 0;
+    }
+
+    const uint32_t held = now - m_lastChange;
+    if (m_poor >= m_config.samplesDown && held >= m_config.holdDownMs && m_level < m_count - 1 + RATE_ADAPT_MAX_TLM_SHIFT)
+    {
+        stepTo(now, m_level + 1);
+        return true;
+    }
+    if (m_good >= m_config.samplesUp && held >= ((uint32_t)m_config.holdUpMs << m_backoff))
+    {
+        stepTo(now, m_level - 1);
+        return true;
+    }
+    return false;
+}
+
+bool RateAdaptPolicy::missed(uint32_t now)
+{
+    const rateAdaptSample_t lost = {0, -128, RATE_ADAPT_SNR_NONE};
+    return update(now, lost);
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * Closed loop air rate adaptation policy for the TX.
+ *
+ * The policy walks a ladder of rates ordered fastest first, stepping towards the more robust
+ * rates when the uplink LQ, RSSI or SNR margin is poor and back up when there is margin to
+ * spare on the faster rate. Below the most robust rate the ladder continues with slower
+ * telemetry ratios, which hands more slots to the uplink.
+ *
+ * Hysteresis comes from separate up/down thresholds, a number of consecutive samples before a
+ * step and a hold time after each step. An up step that has to be undone quickly doubles the
+ * hold time before the next up step, so a link on the edge does not keep bouncing.
+ *
+ * There is no hardware access, it is fed link statistics and returns the rate to use.
+ */
+
+#define RATE_ADAPT_MAX_RATES 8
+#define RATE_ADAPT_MAX_TLM_SHIFT 2      // number of telemetry ratio halvings below the most robust rate
+#define RATE_ADAPT_SNR_NONE -127        // rate has no SNR threshold, same as DYNPOWER_SNR_THRESH_NONE
+
+typedef struct {
+    uint8_t index;          // ExpressLRS_AirRateConfig index
+    int16_t sensitivity;    // dBm, expected RX sensitivity
+    int8_t snrThreshold;    // scaled SNR below which the link has no margin, or RATE_ADAPT_SNR_NONE
+} rateAdaptRate_t;
+
+typedef struct {
+    uint8_t lq;             // uplink LQ %
+    int8_t rssi;            // uplink RSSI dBm of the active antenna
+    int8_t snr;             // uplink SNR, scaled
+} rateAdaptSample_t;
+
+typedef struct {
+    uint8_t lqDown;         // step down below this LQ
+    uint8_t lqUp;           // step up only at or above this LQ
+    uint8_t rssiMarginDown; // step down when RSSI is less than this above the current rate's sensitivity
+    uint8_t rssiMarginUp;   // step up when RSSI is at least this above the faster rate's sensitivity
+    uint8_t snrMarginUp;    // scaled SNR above the faster rate's threshold needed to step up
+    uint8_t samplesDown;    // consecutive poor samples before stepping down
+    uint8_t samplesUp;      // consecutive good samples before stepping up
+    uint16_t holdDownMs;    // minimum time on a rate before stepping down
+    uint16_t holdUpMs;      // minimum time on a rate before stepping up
+    uint8_t maxBackoff;     // holdUpMs is doubled up to this many times by failed up steps
+} rateAdaptConfig_t;
+
+extern const rateAdaptConfig_t RateAdaptDefaultConfig;
+
+class RateAdaptPolicy
+{
+public:
+    RateAdaptPolicy();
+
+    /**
+     * Start (or restart) on a ladder of rates, fastest first, at rates[0].
+     * The ladder is copied, up to RATE_ADAPT_MAX_RATES entries are used.
+     */
+    void begin(const rateAdaptRate_t *rates, uint8_t count, uint32_t now,
+               const rateAdaptConfig_t &config = RateAdaptDefaultConfig);
+
+    /**
+     * Feed one link statistics report.
+     * @return true if rateIndex() or tlmShift() changed
+     */
+    bool update(uint32_t now, const rateAdaptSample_t &sample);
+
+    // A link statistics report was due and did not arrive, counts as a poor sample
+    bool missed(uint32_t now);
+
+    // ExpressLRS_AirRateConfig index of the rate to use
+    uint8_t rateIndex() const;
+    // Number of times to halve the standard telemetry ratio
+    uint8_t tlmShift() const;
+    // Position on the ladder, 0 is the fastest rate
+    uint8_t level() const { return m_level; }
+    bool active() const { return m_count != 0; }
+
+private:
+    rateAdaptRate_t m_rates[RATE_ADAPT_MAX_RATES];
+    rateAdaptConfig_t m_config;
+    uint8_t m_count;
+    uint8_t m_level;
+    uint8_t m_good;
+    uint8_t m_poor;
+    uint8_t m_backoff;
+    uint32_t m_lastChange;
+    bool m_lastUp;          // the last change was a step up
+
+    const rateAdaptRate_t &rateAt(uint8_t level) const;
+    bool isPoor(const rateAdaptSample_t &sample) const;
+    bool isGood(const rateAdaptSample_t &sample) const;
+    void stepTo(uint32_t now, uint8_t level);
+};
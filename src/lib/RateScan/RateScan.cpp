@@ -0,0 +1,76 @@
+#include "RateScan.h"
+
+#include <string.h>
+
+RateScan::RateScan()
+    : m_done(0), m_count(0), m_pos(0), m_dualRadio(false)
+{
+}
+
+void RateScan::begin(const uint8_t *groups, uint8_t count, uint8_t start, bool dualRadio)
+{
+    if (count > RATE_SCAN_MAX_RATES)
+        count = RATE_SCAN_MAX_RATES;
+    memcpy(m_groups, groups, count);
+    m_count = count;
+    m_pos = count ? start % count : 0;
+    m_done = 0;
+    m_dualRadio = dualRadio;
+}
+
+/**
+ * First rate at or after `from` that has not had its turn, in `group` or in any group if
+ * group is RATE_SCAN_NONE
+ */
+uint8_t RateScan::find(uint8_t from, uint8_t group) const
+{
+    for (uint8_t i = 0; i < m_count; i++)
+    {
+        const uint8_t rate = (from + i) % m_count;
+        if (m_groups[rate] == RATE_SCAN_NONE || (m_done & (1UL << rate)))
+            continue;
+        if (group == RATE_SCAN_NONE || m_groups[rate] == group)
+            return rate;
+    }
+    return RATE_SCAN_NONE;
+}
+
+uint8_t RateScan::next(uint8_t &rate2)
+{
+    rate2 = RATE_SCAN_NONE;
+
+    uint8_t rate1 = find(m_pos, RATE_SCAN_NONE);
+    if (rate1 == RATE_SCAN_NONE)
+    {
+        // Sweep complete, start the next one from where this one got to
+        m_done = 0;
+        rate1 = find(m_pos, RATE_SCAN_NONE);
+        if (rate1 == RATE_SCAN_NONE)
+            return RATE_SCAN_NONE;
+    }
+    m_done |= 1UL << rate1;
+    m_pos = (rate1 + 1) % m_count;
+
+    if (m_dualRadio && m_groups[rate1] != RATE_SCAN_SOLO)
+    {
+        rate2 = find(m_pos, m_groups[rate1]);
+        if (rate2 != RATE_SCAN_NONE)
+            m_done |= 1UL << rate2;
+    }
+
+    return rate1;
+}
+
+uint8_t RateScan::turnsPerSweep() const
+{
+    RateScan sweep = *this;
+    sweep.m_done = 0;
+    uint8_t turns = 0;
+    uint8_t rate2;
+    while (sweep.find(sweep.m_pos, RATE_SCAN_NONE) != RATE_SCAN_NONE)
+    {
+        sweep.next(rate2);
+        turns++;
+    }
+    return turns;
+}
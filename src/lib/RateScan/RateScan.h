@@ -0,0 +1,51 @@
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * Order in which a disconnected receiver listens for the TX on the air rates.
+ *
+ * With one radio every rate gets a turn of its own. With two radios the second radio listens on
+ * another rate during the same turn, so a sweep over all the rates takes about half as long. The
+ * two radios share the packet buffer, the payload length and the band, so only rates in the same
+ * group are paired. A rate that needs both radios (dual band) is never paired.
+ *
+ * There is no hardware access, it only hands out ExpressLRS_AirRateConfig indexes.
+ */
+
+#define RATE_SCAN_MAX_RATES 32
+#define RATE_SCAN_NONE 0xff     // no rate, or a group for a rate that is skipped
+#define RATE_SCAN_SOLO 0xfe     // group for a rate that uses both radios
+
+class RateScan
+{
+public:
+    RateScan();
+
+    /**
+     * Start a sweep at rate `start`.
+     * @param groups group of each rate, rates of the same group can be paired. RATE_SCAN_NONE to skip
+     *               the rate, RATE_SCAN_SOLO if it can not be paired. Copied, up to RATE_SCAN_MAX_RATES.
+     * @param dualRadio pair rates for the second radio
+     */
+    void begin(const uint8_t *groups, uint8_t count, uint8_t start, bool dualRadio);
+
+    /**
+     * Rates to listen on for the next turn. Starts a new sweep when every rate has had its turn.
+     * @param rate2 set to the rate for the second radio, or RATE_SCAN_NONE if it listens on rate1
+     * @return the rate for the first radio, RATE_SCAN_NONE if there are no rates to scan
+     */
+    uint8_t next(uint8_t &rate2);
+
+    // Turns a full sweep takes
+    uint8_t turnsPerSweep() const;
+
+private:
+    uint8_t m_groups[RATE_SCAN_MAX_RATES];
+    uint32_t m_done;        // bit per rate that has had its turn in this sweep
+    uint8_t m_count;
+    uint8_t m_pos;
+    bool m_dualRadio;
+
+    uint8_t find(uint8_t from, uint8_t group) const;
+};
@@ -7,6 +7,7 @@
 #include "CRSFRouter.h"
 #include "XBMStrings.h" // Contains all the ELRS logos and animations for the UI
 #include "common.h"
+#include "dirtytiles.h"
 #include "logging.h"
 #include "options.h"
 
@@ -15,6 +16,8 @@ extern WiFiMode_t wifiMode;
 
 // OLED specific header files.
 U8G2 *u8g2;
+// Drawing only goes to the u8g2 buffer, flush() sends the tiles that changed
+static DirtyTiles dirtyTiles;
 
 static void helperDrawImage(menu_item_t menu);
 static void drawCentered(u8g2_int_t y, const char *str)
@@ -34,6 +37,7 @@ void OLEDDisplay::init()
 
     u8g2->begin();
     u8g2->clearBuffer();
+    dirtyTiles.begin(u8g2->getBufferTileWidth(), u8g2->getBufferTileHeight());
 }
 
 void OLEDDisplay::doScreenBackLight(screen_backlight_t state)
@@ -46,6 +50,7 @@ void OLEDDisplay::doScreenBackLight(screen_backlight_t state)
     {
         u8g2->clearDisplay();
         u8g2->setPowerSave(true);
+        dirtyTiles.invalidate();
     }
     else
     {
@@ -58,6 +63,21 @@ void OLEDDisplay::printScreenshot()
     u8g2->writeBufferXBM(*TxBackpack);
 }
 
+static void pushArea(uint8_t tx, uint8_t ty, uint8_t tw, uint8_t th)
+{
+    u8g2->updateDisplayArea(tx, ty, tw, th);
+}
+
+void OLEDDisplay::flush()
+{
+    dirtyTiles.push(u8g2->getBufferPtr(), pushArea);
+}
+
+uint32_t OLEDDisplay::getBytesPushed()
+{
+    return dirtyTiles.getBytesPushed();
+}
+
 void OLEDDisplay::displaySplashScreen()
 {
     u8g2->clearBuffer();
@@ -84,7 +104,6 @@ void OLEDDisplay::displaySplashScreen()
         u8g2->setFont(u8g2_font_profont10_mr);
         drawCentered(60, buffer);
     }
-    u8g2->sendBuffer();
 }
 
 void OLEDDisplay::displayIdleScreen(uint8_t changed, uint8_t rate_index, uint8_t power_index, uint8_t ratio_index, uint8_t motion_index, uint8_t fan_index, bool dynamic, uint8_t running_power_index, uint8_t temperature, message_index_t message_index)
@@ -125,7 +144,6 @@ void OLEDDisplay::displayIdleScreen(uint8_t changed, uint8_t rate_index, uint8_t
         u8g2->drawStr(0, 27, "Ver: ");
         u8g2->drawStr(38, 27, version);
     }
-    u8g2->sendBuffer();
 }
 
 void OLEDDisplay::displayMainMenu(menu_item_t menu)
@@ -143,7 +161,6 @@ void OLEDDisplay::displayMainMenu(menu_item_t menu)
         u8g2->drawStr(0,50, main_menu_strings[menu][1]);
     }
     helperDrawImage(menu);
-    u8g2->sendBuffer();
 }
 
 void OLEDDisplay::displayValue(menu_item_t menu, uint8_t value_index)
@@ -167,7 +184,6 @@ void OLEDDisplay::displayValue(menu_item_t menu, uint8_t value_index)
         u8g2->drawStr(0,56, "CONFIRM");
     }
     helperDrawImage(menu);
-    u8g2->sendBuffer();
 }
 
 void OLEDDisplay::displayBLEConfirm()
@@ -187,7 +203,6 @@ void OLEDDisplay::displayBLEConfirm()
         u8g2->drawStr(0,29, "PRESS TO START");
         u8g2->drawStr(0,59, "BLE JOYSTICK");
     }
-    u8g2->sendBuffer();
 }
 
 void OLEDDisplay::displayBLEStatus()
@@ -209,7 +224,6 @@ void OLEDDisplay::displayBLEStatus()
         u8g2->drawStr(0,33, "GAMEPAD");
         u8g2->drawStr(0,63, "RUNNING");
     }
-    u8g2->sendBuffer();
 }
 
 void OLEDDisplay::displayWiFiConfirm()
@@ -229,7 +243,6 @@ void OLEDDisplay::displayWiFiConfirm()
         u8g2->drawStr(0,29, "PRESS TO ENTER");
         u8g2->drawStr(0,59, "WIFI UPDATE");
     }
-    u8g2->sendBuffer();
 }
 
 void OLEDDisplay::displayWiFiStatus()
@@ -267,7 +280,6 @@ void OLEDDisplay::displayWiFiStatus()
             u8g2->drawStr(0,63, wifi_ap_address);
         }
     }
-    u8g2->sendBuffer();
 }
 
 void OLEDDisplay::displayBindConfirm()
@@ -286,7 +298,6 @@ void OLEDDisplay::displayBindConfirm()
         u8g2->drawStr(0,29, "PRESS TO SEND");
         u8g2->drawStr(0,59, "BIND REQUEST");
     }
-    u8g2->sendBuffer();
 }
 
 void OLEDDisplay::displayBindStatus()
@@ -302,7 +313,6 @@ void OLEDDisplay::displayBindStatus()
     {
         drawCentered(29, "BINDING...");
     }
-    u8g2->sendBuffer();
 }
 
 void OLEDDisplay::displayRunning()
@@ -318,7 +328,6 @@ void OLEDDisplay::displayRunning()
     {
         drawCentered(29, "RUNNING...");
     }
-    u8g2->sendBuffer();
 }
 
 void OLEDDisplay::displaySending()
@@ -334,10 +343,9 @@ void OLEDDisplay::displaySending()
     {
         drawCentered(29, "SENDING...");
     }
-    u8g2->sendBuffer();
 }
 
-void OLEDDisplay::displayLinkstats()
+void OLEDDisplay::displayLinkstats(bool init)
 {
     constexpr int16_t LINKSTATS_COL_FIRST   = 0;
     constexpr int16_t LINKSTATS_COL_SECOND  = 32;
@@ -389,7 +397,6 @@ void OLEDDisplay::displayLinkstats()
         u8g2->print(linkStats.active_antenna);
     }
 
-    u8g2->sendBuffer();
 }
 
 // helpers
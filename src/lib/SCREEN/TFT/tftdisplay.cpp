@@ -122,6 +122,26 @@ constexpr uint16_t elrs_banner_bgColor[] = {
 
 static Arduino_DataBus *bus;
 static Arduino_GFX *gfx;
+// Pixel data sent to the screen (16 bits per pixel), drawing goes straight to the screen so there is nothing to flush.
+// Text and icons are drawn inside an area that has just been filled, which counts them
+static uint32_t bytesPushed = 0;
+
+static void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
+{
+    gfx->fillRect(x, y, w, h, color);
+    bytesPushed += w * h * 2;
+}
+
+static void fillScreen(uint16_t color)
+{
+    fillRect(0, 0, SCREEN_X, SCREEN_Y, color);
+}
+
+static void drawRGBBitmap(int16_t x, int16_t y, const uint16_t *bitmap, int16_t w, int16_t h)
+{
+    gfx->draw16bitRGBBitmap(x, y, bitmap, w, h);
+    bytesPushed += w * h * 2;
+}
 
 void TFTDisplay::init()
 {
@@ -149,11 +169,20 @@ void TFTDisplay::printScreenshot()
     DBGLN("Unimplemented");
 }
 
+void TFTDisplay::flush()
+{
+}
+
+uint32_t TFTDisplay::getBytesPushed()
+{
+    return bytesPushed;
+}
+
 static void displayFontCenter(uint32_t font_start_x, uint32_t font_end_x, uint32_t font_start_y,
                                             int font_size, const GFXfont& font, String font_string,
                                             uint16_t fgColor, uint16_t bgColor)
 {
-    gfx->fillRect(font_start_x, font_start_y, font_end_x - font_start_x, font_size, bgColor);
+    fillRect(font_start_x, font_start_y, font_end_x - font_start_x, font_size, bgColor);
     gfx->setFont(&font);
 
     int16_t x, y;
@@ -169,16 +198,16 @@ static void displayFontCenter(uint32_t font_start_x, uint32_t font_end_x, uint32
 
 void TFTDisplay::displaySplashScreen()
 {
-    gfx->fillScreen(WHITE);
+    fillScreen(WHITE);
 
     size_t sz = INIT_PAGE_LOGO_X * INIT_PAGE_LOGO_Y;
     uint16_t image[sz];
     if (spi_flash_read(logo_image, image, sz * 2) == ESP_OK)
     {
-        gfx->draw16bitRGBBitmap(0, 0, image, INIT_PAGE_LOGO_X, INIT_PAGE_LOGO_Y);
+        drawRGBBitmap(0, 0, image, INIT_PAGE_LOGO_X, INIT_PAGE_LOGO_Y);
     }
 
-    gfx->fillRect(SCREEN_FONT_GAP, INIT_PAGE_FONT_START_Y - INIT_PAGE_FONT_PADDING,
+    fillRect(SCREEN_FONT_GAP, INIT_PAGE_FONT_START_Y - INIT_PAGE_FONT_PADDING,
                     SCREEN_X - SCREEN_FONT_GAP*2, SCREEN_NORMAL_FONT_SIZE + INIT_PAGE_FONT_PADDING*2, BLACK);
 
     char buffer[50];
@@ -193,13 +222,13 @@ void TFTDisplay::displayIdleScreen(uint8_t changed, uint8_t rate_index, uint8_t
     if (changed == CHANGED_ALL)
     {
         // Everything has changed! So clear the right side
-        gfx->fillRect(SCREEN_X/2, 0, SCREEN_X/2, SCREEN_Y, WHITE);
+        fillRect(SCREEN_X/2, 0, SCREEN_X/2, SCREEN_Y, WHITE);
     }
 
     if (changed & CHANGED_TEMP)
     {
         // Left side logo, version, and temp
-        gfx->fillRect(0, 0, SCREEN_X/2, SCREEN_Y, elrs_banner_bgColor[message_index]);
+        fillRect(0, 0, SCREEN_X/2, SCREEN_Y, elrs_banner_bgColor[message_index]);
         gfx->drawBitmap(IDLE_PAGE_START_X, IDLE_PAGE_START_Y, elrs_banner_bmp, SCREEN_LARGE_ICON_SIZE, SCREEN_LARGE_ICON_SIZE,
                         WHITE);
 
@@ -259,9 +288,9 @@ void TFTDisplay::displayIdleScreen(uint8_t changed, uint8_t rate_index, uint8_t
 
 void TFTDisplay::displayMainMenu(menu_item_t menu)
 {
-    gfx->fillScreen(WHITE);
+    fillScreen(WHITE);
 
-    gfx->draw16bitRGBBitmap(MAIN_PAGE_ICON_START_X, MAIN_PAGE_ICON_START_Y, main_menu_icons[menu], SCREEN_LARGE_ICON_SIZE, SCREEN_LARGE_ICON_SIZE);
+    drawRGBBitmap(MAIN_PAGE_ICON_START_X, MAIN_PAGE_ICON_START_Y, main_menu_icons[menu], SCREEN_LARGE_ICON_SIZE, SCREEN_LARGE_ICON_SIZE);
     displayFontCenter(MAIN_PAGE_WORD_START_X, SCREEN_X, MAIN_PAGE_WORD_START_Y1,  SCREEN_NORMAL_FONT_SIZE, SCREEN_NORMAL_FONT,
         main_menu_strings[menu][0], BLACK, WHITE);
     displayFontCenter(MAIN_PAGE_WORD_START_X, SCREEN_X, MAIN_PAGE_WORD_START_Y2,  SCREEN_NORMAL_FONT_SIZE, SCREEN_NORMAL_FONT,
@@ -270,7 +299,7 @@ void TFTDisplay::displayMainMenu(menu_item_t menu)
 
 void TFTDisplay::displayValue(menu_item_t menu, uint8_t value_index)
 {
-    gfx->fillScreen(WHITE);
+    fillScreen(WHITE);
 
     String val = String(getValue(menu, value_index));
     val.replace("!+", "\xA0");
@@ -284,9 +313,9 @@ void TFTDisplay::displayValue(menu_item_t menu, uint8_t value_index)
 
 void TFTDisplay::displayBLEConfirm()
 {
-    gfx->fillScreen(WHITE);
+    fillScreen(WHITE);
 
-    gfx->draw16bitRGBBitmap(SUB_PAGE_ICON_START_X, SUB_PAGE_ICON_START_Y, elrs_joystick, SCREEN_LARGE_ICON_SIZE, SCREEN_LARGE_ICON_SIZE);
+    drawRGBBitmap(SUB_PAGE_ICON_START_X, SUB_PAGE_ICON_START_Y, elrs_joystick, SCREEN_LARGE_ICON_SIZE, SCREEN_LARGE_ICON_SIZE);
     displayFontCenter(SUB_PAGE_WORD_START_X, SCREEN_X, SUB_PAGE_WORD_START_Y1,  SCREEN_NORMAL_FONT_SIZE, SCREEN_NORMAL_FONT,
                         "PRESS TO", BLACK, WHITE);
     displayFontCenter(SUB_PAGE_WORD_START_X, SCREEN_X, SUB_PAGE_WORD_START_Y2,  SCREEN_NORMAL_FONT_SIZE, SCREEN_NORMAL_FONT,
@@ -297,9 +326,9 @@ void TFTDisplay::displayBLEConfirm()
 
 void TFTDisplay::displayBLEStatus()
 {
-    gfx->fillScreen(WHITE);
+    fillScreen(WHITE);
 
-    gfx->draw16bitRGBBitmap(SUB_PAGE_ICON_START_X, SUB_PAGE_ICON_START_Y, elrs_joystick, SCREEN_LARGE_ICON_SIZE, SCREEN_LARGE_ICON_SIZE);
+    drawRGBBitmap(SUB_PAGE_ICON_START_X, SUB_PAGE_ICON_START_Y, elrs_joystick, SCREEN_LARGE_ICON_SIZE, SCREEN_LARGE_ICON_SIZE);
     displayFontCenter(SUB_PAGE_WORD_START_X, SCREEN_X, SUB_PAGE_WORD_START_Y1,  SCREEN_NORMAL_FONT_SIZE, SCREEN_NORMAL_FONT,
                         "BLE", BLACK, WHITE);
     displayFontCenter(SUB_PAGE_WORD_START_X, SCREEN_X, SUB_PAGE_WORD_START_Y2,  SCREEN_NORMAL_FONT_SIZE, SCREEN_NORMAL_FONT,
@@ -310,9 +339,9 @@ void TFTDisplay::displayBLEStatus()
 
 void TFTDisplay::displayWiFiConfirm()
 {
-    gfx->fillScreen(WHITE);
+    fillScreen(WHITE);
 
-    gfx->draw16bitRGBBitmap(SUB_PAGE_ICON_START_X, SUB_PAGE_ICON_START_Y, elrs_wifimode, SCREEN_LARGE_ICON_SIZE, SCREEN_LARGE_ICON_SIZE);
+    drawRGBBitmap(SUB_PAGE_ICON_START_X, SUB_PAGE_ICON_START_Y, elrs_wifimode, SCREEN_LARGE_ICON_SIZE, SCREEN_LARGE_ICON_SIZE);
     displayFontCenter(SUB_PAGE_WORD_START_X, SCREEN_X, SUB_PAGE_WORD_START_Y1,  SCREEN_NORMAL_FONT_SIZE, SCREEN_NORMAL_FONT,
                         "PRESS TO", BLACK, WHITE);
     displayFontCenter(SUB_PAGE_WORD_START_X, SCREEN_X, SUB_PAGE_WORD_START_Y2,  SCREEN_NORMAL_FONT_SIZE, SCREEN_NORMAL_FONT,
@@ -323,9 +352,9 @@ void TFTDisplay::displayWiFiConfirm()
 
 void TFTDisplay::displayWiFiStatus()
 {
-    gfx->fillScreen(WHITE);
+    fillScreen(WHITE);
 
-    gfx->draw16bitRGBBitmap(SUB_PAGE_ICON_START_X, SUB_PAGE_ICON_START_Y, elrs_wifimode, SCREEN_LARGE_ICON_SIZE, SCREEN_LARGE_ICON_SIZE);
+    drawRGBBitmap(SUB_PAGE_ICON_START_X, SUB_PAGE_ICON_START_Y, elrs_wifimode, SCREEN_LARGE_ICON_SIZE, SCREEN_LARGE_ICON_SIZE);
     if (wifiMode == WIFI_STA) {
         String host_msg = String(wifi_hostname) + ".local";
         displayFontCenter(SUB_PAGE_WORD_START_X, SCREEN_X, SUB_PAGE_WORD_START_Y1,  SCREEN_NORMAL_FONT_SIZE, SCREEN_NORMAL_FONT,
@@ -348,9 +377,9 @@ void TFTDisplay::displayWiFiStatus()
 
 void TFTDisplay::displayBindConfirm()
 {
-    gfx->fillScreen(WHITE);
+    fillScreen(WHITE);
 
-    gfx->draw16bitRGBBitmap(SUB_PAGE_ICON_START_X, SUB_PAGE_ICON_START_Y, elrs_bind, SCREEN_LARGE_ICON_SIZE, SCREEN_LARGE_ICON_SIZE);
+    drawRGBBitmap(SUB_PAGE_ICON_START_X, SUB_PAGE_ICON_START_Y, elrs_bind, SCREEN_LARGE_ICON_SIZE, SCREEN_LARGE_ICON_SIZE);
     displayFontCenter(SUB_PAGE_WORD_START_X, SCREEN_X, SUB_PAGE_WORD_START_Y1,  SCREEN_NORMAL_FONT_SIZE, SCREEN_NORMAL_FONT,
                         "PRESS TO", BLACK, WHITE);
     displayFontCenter(SUB_PAGE_WORD_START_X, SCREEN_X, SUB_PAGE_WORD_START_Y2,  SCREEN_NORMAL_FONT_SIZE, SCREEN_NORMAL_FONT,
@@ -361,7 +390,7 @@ void TFTDisplay::displayBindConfirm()
 
 void TFTDisplay::displayBindStatus()
 {
-    gfx->fillScreen(WHITE);
+    fillScreen(WHITE);
 
     displayFontCenter(SUB_PAGE_BINDING_WORD_START_X, SCREEN_X, SUB_PAGE_BINDING_WORD_START_Y,  SCREEN_LARGE_FONT_SIZE, SCREEN_LARGE_FONT,
                         "BINDING...", BLACK, WHITE);
@@ -369,7 +398,7 @@ void TFTDisplay::displayBindStatus()
 
 void TFTDisplay::displayRunning()
 {
-    gfx->fillScreen(WHITE);
+    fillScreen(WHITE);
 
     displayFontCenter(SUB_PAGE_BINDING_WORD_START_X, SCREEN_X, SUB_PAGE_BINDING_WORD_START_Y,  SCREEN_LARGE_FONT_SIZE, SCREEN_LARGE_FONT,
                         "RUNNING...", BLACK, WHITE);
@@ -377,13 +406,29 @@ void TFTDisplay::displayRunning()
 
 void TFTDisplay::displaySending()
 {
-    gfx->fillScreen(WHITE);
+    fillScreen(WHITE);
 
     displayFontCenter(SUB_PAGE_BINDING_WORD_START_X, SCREEN_X, SUB_PAGE_BINDING_WORD_START_Y,  SCREEN_LARGE_FONT_SIZE, SCREEN_LARGE_FONT,
                         "SENDING...", BLACK, WHITE);
 }
 
-void TFTDisplay::displayLinkstats()
+#define LINKSTATS_VALUE_LEN 12
+
+static void drawLinkstatsValue(int16_t x, int16_t y, int16_t w, const char *value, char *last)
+{
+    if (strcmp(value, last) == 0)
+    {
+        return;
+    }
+    strlcpy(last, value, LINKSTATS_VALUE_LEN);
+
+    // Clear the old value and draw the new one, y is the baseline of the text
+    fillRect(x, y - SCREEN_SMALL_FONT_SIZE - 2, w, SCREEN_SMALL_FONT_SIZE + 4, WHITE);
+    gfx->setCursor(x, y);
+    gfx->print(value);
+}
+
+void TFTDisplay::displayLinkstats(bool init)
 {
     constexpr int16_t LINKSTATS_COL_FIRST   = 0;
     constexpr int16_t LINKSTATS_COL_SECOND  = 30;
@@ -395,52 +440,65 @@ void TFTDisplay::displayLinkstats()
     constexpr int16_t LINKSTATS_ROW_FOURTH  = 55;
     constexpr int16_t LINKSTATS_ROW_FIFTH   = 70;
 
-    gfx->fillScreen(WHITE);
+    // The values last drawn, only the ones that changed are redrawn
+    static char uplinkLQ[LINKSTATS_VALUE_LEN];
+    static char uplinkRSSI[LINKSTATS_VALUE_LEN];
+    static char uplinkSNR[LINKSTATS_VALUE_LEN];
+    static char antenna[LINKSTATS_VALUE_LEN];
+    static char downlinkLQ[LINKSTATS_VALUE_LEN];
+    static char downlinkRSSI[LINKSTATS_VALUE_LEN];
+    static char downlinkSNR[LINKSTATS_VALUE_LEN];
+
     gfx->setFont(&SCREEN_SMALL_FONT);
     gfx->setTextColor(BLACK, WHITE);
 
-    gfx->setCursor(LINKSTATS_COL_FIRST, LINKSTATS_ROW_SECOND);
-    gfx->print("LQ");
-    gfx->setCursor(LINKSTATS_COL_FIRST, LINKSTATS_ROW_THIRD);
-    gfx->print("RSSI");
-    gfx->setCursor(LINKSTATS_COL_FIRST, LINKSTATS_ROW_FOURTH);
-    gfx->print("SNR");
-    gfx->setCursor(LINKSTATS_COL_FIRST, LINKSTATS_ROW_FIFTH);
-    gfx->print("Ant");
-
-    // Uplink Linkstats
-    gfx->setCursor(LINKSTATS_COL_SECOND, LINKSTATS_ROW_FIRST);
-    gfx->print("Uplink");
-    gfx->setCursor(LINKSTATS_COL_SECOND, LINKSTATS_ROW_SECOND);
-    gfx->print(linkStats.uplink_Link_quality);
-    gfx->setCursor(LINKSTATS_COL_SECOND, LINKSTATS_ROW_THIRD);
-    gfx->print((int8_t)linkStats.uplink_RSSI_1);
-    if (linkStats.uplink_RSSI_2 != 0)
+    if (init)
     {
-        gfx->print('/');
-        gfx->print((int8_t)linkStats.uplink_RSSI_2);
+        fillScreen(WHITE);
+        uplinkLQ[0] = uplinkRSSI[0] = uplinkSNR[0] = antenna[0] = '\0';
+        downlinkLQ[0] = downlinkRSSI[0] = downlinkSNR[0] = '\0';
+
+        gfx->setCursor(LINKSTATS_COL_FIRST, LINKSTATS_ROW_SECOND);
+        gfx->print("LQ");
+        gfx->setCursor(LINKSTATS_COL_FIRST, LINKSTATS_ROW_THIRD);
+        gfx->print("RSSI");
+        gfx->setCursor(LINKSTATS_COL_FIRST, LINKSTATS_ROW_FOURTH);
+        gfx->print("SNR");
+        gfx->setCursor(LINKSTATS_COL_FIRST, LINKSTATS_ROW_FIFTH);
+        gfx->print("Ant");
+        gfx->setCursor(LINKSTATS_COL_SECOND, LINKSTATS_ROW_FIRST);
+        gfx->print("Uplink");
+        gfx->setCursor(LINKSTATS_COL_THIRD, LINKSTATS_ROW_FIRST);
+        gfx->print("Downlink");
     }
 
-    gfx->setCursor(LINKSTATS_COL_SECOND, LINKSTATS_ROW_FOURTH);
-    gfx->print(linkStats.uplink_SNR);
-    gfx->setCursor(LINKSTATS_COL_SECOND, LINKSTATS_ROW_FIFTH);
-    gfx->print(linkStats.active_antenna);
+    char value[LINKSTATS_VALUE_LEN];
+    constexpr int16_t SECOND_W = LINKSTATS_COL_THIRD - LINKSTATS_COL_SECOND;
+    constexpr int16_t THIRD_W = SCREEN_X - LINKSTATS_COL_THIRD;
+
+    // Uplink Linkstats
+    snprintf(value, sizeof(value), "%u", linkStats.uplink_Link_quality);
+    drawLinkstatsValue(LINKSTATS_COL_SECOND, LINKSTATS_ROW_SECOND, SECOND_W, value, uplinkLQ);
+    if (linkStats.uplink_RSSI_2 != 0)
+        snprintf(value, sizeof(value), "%d/%d", (int8_t)linkStats.uplink_RSSI_1, (int8_t)linkStats.uplink_RSSI_2);
+    else
+        snprintf(value, sizeof(value), "%d", (int8_t)linkStats.uplink_RSSI_1);
+    drawLinkstatsValue(LINKSTATS_COL_SECOND, LINKSTATS_ROW_THIRD, SECOND_W, value, uplinkRSSI);
+    snprintf(value, sizeof(value), "%d", linkStats.uplink_SNR);
+    drawLinkstatsValue(LINKSTATS_COL_SECOND, LINKSTATS_ROW_FOURTH, SECOND_W, value, uplinkSNR);
+    snprintf(value, sizeof(value), "%u", linkStats.active_antenna);
+    drawLinkstatsValue(LINKSTATS_COL_SECOND, LINKSTATS_ROW_FIFTH, SECOND_W, value, antenna);
 
     // Downlink Linkstats
-    gfx->setCursor(LINKSTATS_COL_THIRD, LINKSTATS_ROW_FIRST);
-    gfx->print("Downlink");
-    gfx->setCursor(LINKSTATS_COL_THIRD, LINKSTATS_ROW_SECOND);
-    gfx->print(linkStats.downlink_Link_quality);
-    gfx->setCursor(LINKSTATS_COL_THIRD, LINKSTATS_ROW_THIRD);
-    gfx->print((int8_t)linkStats.downlink_RSSI_1);
+    snprintf(value, sizeof(value), "%u", linkStats.downlink_Link_quality);
+    drawLinkstatsValue(LINKSTATS_COL_THIRD, LINKSTATS_ROW_SECOND, THIRD_W, value, downlinkLQ);
     if (isDualRadio())
-    {
-        gfx->print('/');
-        gfx->print((int8_t)linkStats.downlink_RSSI_2);
-    }
-
-    gfx->setCursor(LINKSTATS_COL_THIRD, LINKSTATS_ROW_FOURTH);
-    gfx->print(linkStats.downlink_SNR);
+        snprintf(value, sizeof(value), "%d/%d", (int8_t)linkStats.downlink_RSSI_1, (int8_t)linkStats.downlink_RSSI_2);
+    else
+        snprintf(value, sizeof(value), "%d", (int8_t)linkStats.downlink_RSSI_1);
+    drawLinkstatsValue(LINKSTATS_COL_THIRD, LINKSTATS_ROW_THIRD, THIRD_W, value, downlinkRSSI);
+    snprintf(value, sizeof(value), "%d", linkStats.downlink_SNR);
+    drawLinkstatsValue(LINKSTATS_COL_THIRD, LINKSTATS_ROW_FOURTH, THIRD_W, value, downlinkSNR);
 }
 
 #endif
@@ -26,10 +26,32 @@ static bool is_screen_flipped = false;
 static bool is_pre_screen_flipped = false;
 
 #define SCREEN_DURATION 20
+// Minimum time between sending frames to the screen, so I2C/SPI transfers don't starve the radio and UART
+#if !defined(SCREEN_FRAME_INTERVAL)
+#define SCREEN_FRAME_INTERVAL 50
+#endif
 
 extern void jumpToWifiRunning();
 extern void jumpToBleRunning();
 
+static uint32_t lastFlushMs = 0;
+
+static void flushScreen(uint32_t now)
+{
+    if (now - lastFlushMs < SCREEN_FRAME_INTERVAL)
+    {
+        return;
+    }
+    lastFlushMs = now;
+    const uint32_t before = display->getBytesPushed();
+    display->flush();
+    const uint32_t pushed = display->getBytesPushed() - before;
+    if (pushed)
+    {
+        DBGVLN("Screen sent %u bytes, %u total", pushed, display->getBytesPushed());
+    }
+}
+
 static bool jumpToBandSelect = false;
 static bool jumpToChannelSelect = false;
 
@@ -129,6 +151,7 @@ static int handle(void)
     {
         state_machine.handleEvent(now, EVENT_TIMEOUT);
     }
+    flushScreen(now);
 
     return SCREEN_DURATION;
 }
@@ -0,0 +1,79 @@
+#include "dirtytiles.h"
+
+#include <string.h>
+
+#define TILE_BYTES 8
+
+void DirtyTiles::begin(uint8_t tileWidth, uint8_t tileHeight)
+{
+    m_tileWidth = tileWidth;
+    m_tileHeight = tileHeight;
+    m_bytesPushed = 0;
+    invalidate();
+}
+
+uint16_t DirtyTiles::push(const uint8_t *buffer, PushArea pushArea)
+{
+    const uint16_t rowBytes = m_tileWidth * TILE_BYTES;
+    uint16_t pushed = 0;
+
+    if (m_invalid)
+    {
+        m_invalid = false;
+        pushed = rowBytes * m_tileHeight;
+        memcpy(m_shadow, buffer, pushed);
+        pushArea(0, 0, m_tileWidth, m_tileHeight);
+        m_bytesPushed += pushed;
+        return pushed;
+    }
+
+    // The area waiting to be sent, extended downwards while the rows change over the same span
+    uint8_t areaX = 0;
+    uint8_t areaY = 0;
+    uint8_t areaW = 0;
+    uint8_t areaH = 0;
+    for (uint8_t ty = 0; ty < m_tileHeight; ty++)
+    {
+        const uint8_t *row = &buffer[ty * rowBytes];
+        uint8_t *shadow = &m_shadow[ty * rowBytes];
+        int16_t first = -1;
+        int16_t last = -1;
+        for (uint8_t tx = 0; tx < m_tileWidth; tx++)
+        {
+            if (memcmp(&row[tx * TILE_BYTES], &shadow[tx * TILE_BYTES], TILE_BYTES) != 0)
+            {
+                if (first < 0)
+                    first = tx;
+                last = tx;
+            }
+        }
+        if (first < 0)
+        {
+            continue;
+        }
+
+        const uint8_t w = last - first + 1;
+        memcpy(&shadow[first * TILE_BYTES], &row[first * TILE_BYTES], w * TILE_BYTES);
+        pushed += w * TILE_BYTES;
+        if (areaH != 0 && areaX == first && areaW == w && areaY + areaH == ty)
+        {
+            areaH++;
+            continue;
+        }
+        if (areaH != 0)
+        {
+            pushArea(areaX, areaY, areaW, areaH);
+        }
+        areaX = first;
+        areaY = ty;
+        areaW = w;
+        areaH = 1;
+    }
+    if (areaH != 0)
+    {
+        pushArea(areaX, areaY, areaW, areaH);
+    }
+
+    m_bytesPushed += pushed;
+    return pushed;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <stdint.h>
+
+// Largest supported screen, 128x64 monochrome
+#define DIRTY_TILES_BUFFER_SIZE (128 * 64 / 8)
+
+/*
+ * Tracks which 8x8 tiles of a u8g2 style full frame buffer changed since they were last sent
+ * to the screen, so only those need to go over I2C/SPI.
+ *
+ * The buffer is laid out in rows of tiles, each tile being 8 bytes of one vertical column of
+ * 8 pixels each. Changed tiles are sent as one area per tile row spanning the first to the
+ * last changed tile, and rows with the same span are merged into one area.
+ */
+class DirtyTiles
+{
+public:
+    // Send the tiles in the area to the screen, in tiles
+    typedef void (*PushArea)(uint8_t tx, uint8_t ty, uint8_t tw, uint8_t th);
+
+    void begin(uint8_t tileWidth, uint8_t tileHeight);
+    // The screen contents are unknown (cleared or powered down), send everything next time
+    void invalidate() { m_invalid = true; }
+    // Send the changed parts of buffer, returns the number of bytes sent
+    uint16_t push(const uint8_t *buffer, PushArea pushArea);
+
+    uint32_t getBytesPushed() const { return m_bytesPushed; }
+
+private:
+    uint8_t m_shadow[DIRTY_TILES_BUFFER_SIZE];
+    uint8_t m_tileWidth;
+    uint8_t m_tileHeight;
+    bool m_invalid;
+    uint32_t m_bytesPushed;
+};
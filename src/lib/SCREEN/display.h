@@ -34,6 +34,10 @@ public:
     virtual void init() = 0;
     virtual void doScreenBackLight(screen_backlight_t state) = 0;
     virtual void printScreenshot() = 0;
+    // Send whatever was drawn since the last flush to the screen
+    virtual void flush() = 0;
+    // Total bytes of pixel data sent to the screen
+    virtual uint32_t getBytesPushed() = 0;
 
     virtual void displaySplashScreen() = 0;
     virtual void displayIdleScreen(uint8_t changed, uint8_t rate_index, uint8_t power_index, uint8_t ratio_index, uint8_t motion_index, uint8_t fan_index, bool dynamic, uint8_t running_power_index, uint8_t temperature, message_index_t message_index) = 0;
@@ -47,7 +51,7 @@ public:
     virtual void displayWiFiStatus() = 0;
     virtual void displayRunning() = 0;
     virtual void displaySending() = 0;
-    virtual void displayLinkstats() = 0;
+    virtual void displayLinkstats(bool init) = 0;
 
     int getValueCount(menu_item_t menu);
     const char *getValue(menu_item_t menu, uint8_t value_index);
@@ -1,3 +1,4 @@
+#if !defined(UNIT_TEST)
 #include "OLED/oleddisplay.h"
 #include "TFT/tftdisplay.h"
 
@@ -454,7 +455,7 @@ static void executeBind(bool init)
 // Linkstats
 static void displayLinkstats(bool init)
 {
-    display->displayLinkstats();
+    display->displayLinkstats(init);
 }
 
 //-------------------------------------------------------------------
@@ -662,3 +663,4 @@ void jumpToBleRunning()
     state_machine.jumpTo(main_menu_fsm, STATE_JOYSTICK);
     state_machine.jumpTo(ble_menu_fsm, STATE_BLE_EXECUTE);
 }
+#endif
@@ -4,6 +4,7 @@
 
 SX127xHal hal;
 SX127xDriver *SX127xDriver::instance = NULL;
+static_assert(SX12xxDriverCheck<SX127xDriver>::value, "SX127xDriver does not have the whole radio interface");
 
 RFAMP_hal RFAMP;
 
@@ -166,7 +167,7 @@ void SX127xDriver::ConfigLoraDefaults()
   SetPreambleLength(SX127X_PREAMBLE_LENGTH_LSB);
 }
 
-void SX127xDriver::SetBandwidthCodingRate(SX127x_Bandwidth bw, SX127x_CodingRate cr)
+void ICACHE_RAM_ATTR SX127xDriver::SetBandwidthCodingRate(SX127x_Bandwidth bw, SX127x_CodingRate cr)
 {
   if ((currBW != bw) || (currCR != cr))
   {
@@ -215,7 +216,7 @@ void SX127xDriver::SetBandwidthCodingRate(SX127x_Bandwidth bw, SX127x_CodingRate
   }
 }
 
-void SX127xDriver::SetCRCMode(bool on)
+void ICACHE_RAM_ATTR SX127xDriver::SetCRCMode(bool on)
 {
   if(on)
   {
@@ -298,7 +299,7 @@ void ICACHE_RAM_ATTR SX127xDriver::CommitOutputPower()
   hal.writeRegister(SX127X_REG_PA_CONFIG, pwrCurrent, SX12XX_Radio_All);
 }
 
-void SX127xDriver::SetPreambleLength(uint8_t PreambleLen)
+void ICACHE_RAM_ATTR SX127xDriver::SetPreambleLength(uint8_t PreambleLen)
 {
   if (currPreambleLen != PreambleLen)
   {
@@ -307,7 +308,7 @@ void SX127xDriver::SetPreambleLength(uint8_t PreambleLen)
   }
 }
 
-void SX127xDriver::SetSpreadingFactor(SX127x_SpreadingFactor sf)
+void ICACHE_RAM_ATTR SX127xDriver::SetSpreadingFactor(SX127x_SpreadingFactor sf)
 {
   if (currSF != sf)
   {
@@ -578,6 +579,15 @@ void SX127xDriver::Config(uint8_t bw, uint8_t sf, uint8_t cr, uint32_t freq, uin
   SetFrequencyReg(freq, SX12XX_Radio_All);
 }
 
+void ICACHE_RAM_ATTR SX127xDriver::SetModulation(uint8_t bw, uint8_t sf, uint8_t cr, uint8_t preambleLen, SX12XX_Radio_Number_t radioNumber)
+{
+  // The modem registers can only be written in standby, the rest of Config() does not change
+  SetMode(SX127x_OPMODE_STANDBY, SX12XX_Radio_All);
+  SetPreambleLength(preambleLen);
+  SetSpreadingFactor((SX127x_SpreadingFactor)sf);
+  SetBandwidthCodingRate((SX127x_Bandwidth)bw, (SX127x_CodingRate)cr);
+}
+
 uint32_t ICACHE_RAM_ATTR SX127xDriver::GetCurrBandwidth()
 {
   switch (currBW)
@@ -592,21 +602,6 @@ uint32_t ICACHE_RAM_ATTR SX127xDriver::GetCurrBandwidth()
   return -1;
 }
 
-uint32_t ICACHE_RAM_ATTR SX127xDriver::GetCurrBandwidthNormalisedShifted() // this is basically just used for speedier calc of the freq offset, pre compiled for 32mhz xtal
-{
-
-  switch (currBW)
-  {
-  case SX127x_BW_125_00_KHZ:
-    return 64;
-  case SX127x_BW_250_00_KHZ:
-    return 32;
-  case SX127x_BW_500_00_KHZ:
-    return 16;
-  }
-  return -1;
-}
-
 /**
  * Set the PPMcorrection register to adjust data rate to frequency error
  * @param offset is in Hz or FREQ_STEP (FREQ_HZ_TO_REG_VAL) units, whichever
@@ -623,25 +618,40 @@ bool ICACHE_RAM_ATTR SX127xDriver::GetFrequencyErrorbool(SX12XX_Radio_Number_t r
   return (hal.readRegister(SX127X_REG_FEI_MSB, radioNumber) & 0b1000) >> 3; // returns true if pos freq error, neg if false
 }
 
-int32_t ICACHE_RAM_ATTR SX127xDriver::GetFrequencyError()
+/**
+ * Frequency error of the last packet, in FREQ_STEP units. Negative when the radio has to go
+ * up in frequency, the sign GetFrequencyErrorbool() gives, so it can be added to FreqCorrection.
+ */
+int32_t ICACHE_RAM_ATTR SX127xDriver::GetFrequencyError(SX12XX_Radio_Number_t radioNumber)
 {
-
   WORD_ALIGNED_ATTR uint8_t reg[3] = {0x0, 0x0, 0x0};
-  hal.readRegister(SX127X_REG_FEI_MSB, reg, sizeof(reg), processingPacketRadio);
+  hal.readRegister(SX127X_REG_FEI_MSB, reg, sizeof(reg), radioNumber);
 
-  uint32_t RegFei = ((reg[0] & 0b0111) << 16) + (reg[1] << 8) + reg[2];
-
-  int32_t intFreqError = RegFei;
-
-  if ((reg[0] & 0b1000) >> 3)
+  int32_t fei = ((reg[0] & 0b0111) << 16) + (reg[1] << 8) + reg[2];
+  if (reg[0] & 0b1000)
   {
-    intFreqError -= 524288; // Sign bit is on
+    fei -= 524288; // Sign bit is on
   }
 
-  int32_t fErrorHZ = (intFreqError >> 3) * (SX127xDriver::GetCurrBandwidthNormalisedShifted()); // bit shift hackery so we don't have to use floaty bois; the >> 3 is intentional and is a simplification of the formula on page 114 of sx1276 datasheet
-  fErrorHZ >>= 4;
+  // The error in Hz is FEI * 2^24 / Fxtal * BW / 500kHz (page 114 of the sx1276 datasheet), in
+  // FREQ_STEP (Fxtal / 2^19) that is FEI * BW / 500kHz * 2^43 / Fxtal^2. For the 32MHz crystal
+  // 2^43 / Fxtal^2 is 563 / 2^16 to within 0.01%, with BW in quarters of 500kHz it all fits in
+  // 32 bits: 2^19 * 563 * 4 < 2^31.
+  int32_t bwQuarters;
+  switch (currBW)
+  {
+  case SX127x_BW_125_00_KHZ:
+    bwQuarters = 1;
+    break;
+  case SX127x_BW_250_00_KHZ:
+    bwQuarters = 2;
+    break;
+  default:
+    bwQuarters = 4;
+    break;
+  }
 
-  return fErrorHZ;
+  return (fei * 563 * bwQuarters + (1 << 17)) >> 18;
 }
 
 uint8_t ICACHE_RAM_ATTR SX127xDriver::UnsignedGetLastPacketRSSI(SX12XX_Radio_Number_t radioNumber)
@@ -30,6 +30,8 @@ public:
     void Config(uint8_t bw, uint8_t sf, uint8_t cr, uint32_t freq, uint8_t preambleLen, uint8_t syncWord, bool InvertIQ, uint8_t _PayloadLength);
     void Config(uint8_t bw, uint8_t sf, uint8_t cr, uint32_t freq, uint8_t preambleLen, bool InvertIQ, uint8_t _PayloadLength);
     void SetMode(SX127x_RadioOPmodes mode, SX12XX_Radio_Number_t radioNumber);
+    // Change the modulation of an announced rate switch in place, from the timer ISR. Both radios are always changed
+    void SetModulation(uint8_t bw, uint8_t sf, uint8_t cr, uint8_t preambleLen, SX12XX_Radio_Number_t radioNumber);
     void SetTxIdleMode() { SetMode(SX127x_OPMODE_STANDBY, SX12XX_Radio_All); } // set Idle mode used when switching from RX to TX
     void ConfigLoraDefaults();
 
@@ -44,12 +46,11 @@ public:
     void SetSpreadingFactor(SX127x_SpreadingFactor sf);
 
     uint32_t GetCurrBandwidth();
-    uint32_t GetCurrBandwidthNormalisedShifted();
 
     #define FREQ_STEP 61.03515625
     void SetFrequencyReg(uint32_t freq, SX12XX_Radio_Number_t radioNumber, bool doRx = false);
     bool FrequencyErrorAvailable() const { return true; }
-    int32_t GetFrequencyError();
+    int32_t GetFrequencyError(SX12XX_Radio_Number_t radioNumber);
     bool GetFrequencyErrorbool(SX12XX_Radio_Number_t radioNumber);
     void SetPPMoffsetReg(int32_t offset, SX12XX_Radio_Number_t radioNumber);
 
@@ -67,6 +68,8 @@ public:
     int8_t GetLastPacketRSSI(SX12XX_Radio_Number_t radioNumber);
     int8_t GetLastPacketSNRRaw(SX12XX_Radio_Number_t radioNumber);
     int8_t GetCurrRSSI(SX12XX_Radio_Number_t radioNumber);
+    void StartRssiInst(SX12XX_Radio_Number_t radioNumber) {} // the RSSI register is always current
+    int8_t GetRssiInst(SX12XX_Radio_Number_t radioNumber) { return GetCurrRSSI(radioNumber); }
     void GetLastPacketStats();
     void CheckForSecondPacket();
 
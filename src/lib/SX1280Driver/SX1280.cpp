@@ -7,6 +7,7 @@
 
 SX1280Hal hal;
 SX1280Driver *SX1280Driver::instance = NULL;
+static_assert(SX12xxDriverCheck<SX1280Driver>::value, "SX1280Driver does not have the whole radio interface");
 
 RFAMP_hal RFAMP;
 
@@ -145,37 +146,57 @@ void SX1280Driver::startCWTest(uint32_t freq, SX12XX_Radio_Number_t radioNumber)
 
 void SX1280Driver::Config(uint8_t bw, uint8_t sf, uint8_t cr, uint32_t regfreq,
                           uint8_t PreambleLength, bool InvertIQ, uint8_t _PayloadLength,
-                          uint32_t flrcSyncWord, uint16_t flrcCrcSeed, uint8_t flrc)
+                          uint32_t flrcSyncWord, uint16_t flrcCrcSeed, uint8_t flrc,
+                          SX12XX_Radio_Number_t radioNumber)
 {
     uint8_t const mode = (flrc) ? SX1280_PACKET_TYPE_FLRC : SX1280_PACKET_TYPE_LORA;
 
     PayloadLength = _PayloadLength;
     IQinverted = InvertIQ;
     packet_mode = mode;
-    SetMode(SX1280_MODE_STDBY_RC, SX12XX_Radio_All);
-    hal.WriteCommand(SX1280_RADIO_SET_PACKETTYPE, mode, SX12XX_Radio_All, 20);
+    SetMode(SX1280_MODE_STDBY_RC, radioNumber);
+    hal.WriteCommand(SX1280_RADIO_SET_PACKETTYPE, mode, radioNumber, 20);
     if (mode == SX1280_PACKET_TYPE_FLRC)
     {
         DBG("Config FLRC ");
-        ConfigModParamsFLRC(bw, cr, sf);
-        SetPacketParamsFLRC(SX1280_FLRC_PACKET_FIXED_LENGTH, PreambleLength, flrcSyncWord, flrcCrcSeed, cr);
+        ConfigModParamsFLRC(bw, cr, sf, radioNumber);
+        SetPacketParamsFLRC(SX1280_FLRC_PACKET_FIXED_LENGTH, PreambleLength, flrcSyncWord, flrcCrcSeed, cr, radioNumber);
     }
     else
     {
         DBG("Config LoRa ");
-        ConfigModParamsLoRa(bw, sf, cr);
+        ConfigModParamsLoRa(bw, sf, cr, radioNumber);
 #if defined(DEBUG_FREQ_CORRECTION)
         SX1280_RadioLoRaPacketLengthsModes_t packetLengthType = SX1280_LORA_PACKET_VARIABLE_LENGTH;
 #else
         SX1280_RadioLoRaPacketLengthsModes_t packetLengthType = SX1280_LORA_PACKET_FIXED_LENGTH;
 #endif
-        SetPacketParamsLoRa(PreambleLength, packetLengthType, InvertIQ);
+        SetPacketParamsLoRa(PreambleLength, packetLengthType, InvertIQ, radioNumber);
     }
-    SetFrequencyReg(regfreq, SX12XX_Radio_All);
+    SetFrequencyReg(regfreq, radioNumber);
 
     uint16_t dio1Mask = SX1280_IRQ_TX_DONE | SX1280_IRQ_RX_DONE;
     uint16_t irqMask  = SX1280_IRQ_TX_DONE | SX1280_IRQ_RX_DONE | SX1280_IRQ_SYNCWORD_VALID | SX1280_IRQ_SYNCWORD_ERROR | SX1280_IRQ_CRC_ERROR;
-    SetDioIrqParams(irqMask, dio1Mask);
+    SetDioIrqParams(irqMask, dio1Mask, SX1280_IRQ_RADIO_NONE, SX1280_IRQ_RADIO_NONE, radioNumber);
+}
+
+/***
+ * @brief: Change the LoRa modulation and preamble without a full Config(), the packet type,
+ * payload length and IQ stay as they are. STDBY_XOSC is only a short BUSY so this can be
+ * called from the timer ISR.
+ ***/
+void ICACHE_RAM_ATTR SX1280Driver::SetModulation(uint8_t bw, uint8_t sf, uint8_t cr, uint8_t PreambleLength, SX12XX_Radio_Number_t radioNumber)
+{
+    if (packet_mode != SX1280_PACKET_TYPE_LORA)
+        return;
+
+    SetMode(SX1280_MODE_STDBY_XOSC, radioNumber);
+    ConfigModParamsLoRa(bw, sf, cr, radioNumber);
+#if defined(DEBUG_FREQ_CORRECTION)
+    SetPacketParamsLoRa(PreambleLength, SX1280_LORA_PACKET_VARIABLE_LENGTH, IQinverted, radioNumber);
+#else
+    SetPacketParamsLoRa(PreambleLength, SX1280_LORA_PACKET_FIXED_LENGTH, IQinverted, radioNumber);
+#endif
 }
 
 /***
@@ -264,27 +285,27 @@ void SX1280Driver::SetMode(SX1280_RadioOperatingModes_t OPmode, SX12XX_Radio_Num
     currOpmode = OPmode;
 }
 
-void SX1280Driver::ConfigModParamsLoRa(uint8_t bw, uint8_t sf, uint8_t cr)
+void ICACHE_RAM_ATTR SX1280Driver::ConfigModParamsLoRa(uint8_t bw, uint8_t sf, uint8_t cr, SX12XX_Radio_Number_t radioNumber)
 {
     // Care must therefore be taken to ensure that modulation parameters are set using the command
     // SetModulationParam() only after defining the packet type SetPacketType() to be used
 
     WORD_ALIGNED_ATTR uint8_t rfparams[3] = {sf, bw, cr};
 
-    hal.WriteCommand(SX1280_RADIO_SET_MODULATIONPARAMS, rfparams, sizeof(rfparams), SX12XX_Radio_All, 25);
+    hal.WriteCommand(SX1280_RADIO_SET_MODULATIONPARAMS, rfparams, sizeof(rfparams), radioNumber, 25);
 
     switch (sf)
     {
     case SX1280_LORA_SF5:
     case SX1280_LORA_SF6:
-        hal.WriteRegister(SX1280_REG_SF_ADDITIONAL_CONFIG, 0x1E, SX12XX_Radio_All); // for SF5 or SF6
+        hal.WriteRegister(SX1280_REG_SF_ADDITIONAL_CONFIG, 0x1E, radioNumber); // for SF5 or SF6
         break;
     case SX1280_LORA_SF7:
     case SX1280_LORA_SF8:
-        hal.WriteRegister(SX1280_REG_SF_ADDITIONAL_CONFIG, 0x37, SX12XX_Radio_All); // for SF7 or SF8
+        hal.WriteRegister(SX1280_REG_SF_ADDITIONAL_CONFIG, 0x37, radioNumber); // for SF7 or SF8
         break;
     default:
-        hal.WriteRegister(SX1280_REG_SF_ADDITIONAL_CONFIG, 0x32, SX12XX_Radio_All); // for SF9, SF10, SF11, SF12
+        hal.WriteRegister(SX1280_REG_SF_ADDITIONAL_CONFIG, 0x32, radioNumber); // for SF9, SF10, SF11, SF12
     }
     // Datasheet in LoRa Operation says "After SetModulationParams command:
     // In all cases 0x1 must be written to the Frequency Error Compensation mode register 0x093C"
@@ -295,7 +316,7 @@ void SX1280Driver::ConfigModParamsLoRa(uint8_t bw, uint8_t sf, uint8_t cr)
     // hal.WriteRegister(SX1280_REG_FREQ_ERR_CORRECTION, 0x03, SX12XX_Radio_All);
 }
 
-void SX1280Driver::SetPacketParamsLoRa(uint8_t PreambleLength, SX1280_RadioLoRaPacketLengthsModes_t HeaderType, uint8_t InvertIQ)
+void ICACHE_RAM_ATTR SX1280Driver::SetPacketParamsLoRa(uint8_t PreambleLength, SX1280_RadioLoRaPacketLengthsModes_t HeaderType, uint8_t InvertIQ, SX12XX_Radio_Number_t radioNumber)
 {
     uint8_t buf[7];
 
@@ -307,23 +328,24 @@ void SX1280Driver::SetPacketParamsLoRa(uint8_t PreambleLength, SX1280_RadioLoRaP
     buf[5] = 0x00;
     buf[6] = 0x00;
 
-    hal.WriteCommand(SX1280_RADIO_SET_PACKETPARAMS, buf, sizeof(buf), SX12XX_Radio_All, 20);
+    hal.WriteCommand(SX1280_RADIO_SET_PACKETPARAMS, buf, sizeof(buf), radioNumber, 20);
 
     // FEI only triggers in Lora mode when the header is present :(
     modeSupportsFei = HeaderType == SX1280_LORA_PACKET_VARIABLE_LENGTH;
 }
 
-void SX1280Driver::ConfigModParamsFLRC(uint8_t bw, uint8_t cr, uint8_t bt)
+void SX1280Driver::ConfigModParamsFLRC(uint8_t bw, uint8_t cr, uint8_t bt, SX12XX_Radio_Number_t radioNumber)
 {
     WORD_ALIGNED_ATTR uint8_t rfparams[3] = {bw, cr, bt};
-    hal.WriteCommand(SX1280_RADIO_SET_MODULATIONPARAMS, rfparams, sizeof(rfparams), SX12XX_Radio_All, 110);
+    hal.WriteCommand(SX1280_RADIO_SET_MODULATIONPARAMS, rfparams, sizeof(rfparams), radioNumber, 110);
 }
 
 void SX1280Driver::SetPacketParamsFLRC(uint8_t HeaderType,
                                        uint8_t PreambleLength,
                                        uint32_t syncWord,
                                        uint16_t crcSeed,
-                                       uint8_t cr)
+                                       uint8_t cr,
+                                       SX12XX_Radio_Number_t radioNumber)
 {
     if (PreambleLength < 8)
         PreambleLength = 8;
@@ -337,12 +359,12 @@ void SX1280Driver::SetPacketParamsFLRC(uint8_t HeaderType,
     buf[4] = PayloadLength;                     // PayloadLength
     buf[5] = SX1280_FLRC_CRC_3_BYTE;            // CrcLength
     buf[6] = 0x08;                              // Must be whitening disabled
-    hal.WriteCommand(SX1280_RADIO_SET_PACKETPARAMS, buf, sizeof(buf), SX12XX_Radio_All, 30);
+    hal.WriteCommand(SX1280_RADIO_SET_PACKETPARAMS, buf, sizeof(buf), radioNumber, 30);
 
     // CRC seed (use dedicated cipher)
     buf[0] = (uint8_t)(crcSeed >> 8);
     buf[1] = (uint8_t)crcSeed;
-    hal.WriteRegister(SX1280_REG_FLRC_CRC_SEED, buf, 2, SX12XX_Radio_All);
+    hal.WriteRegister(SX1280_REG_FLRC_CRC_SEED, buf, 2, radioNumber);
 
     // Set SyncWord1
     buf[0] = (uint8_t)(syncWord >> 24);
@@ -363,7 +385,7 @@ void SX1280Driver::SetPacketParamsFLRC(uint8_t HeaderType,
             buf[3] |= 0x80; // 0x80 or 0x40 would work
     }
 
-    hal.WriteRegister(SX1280_REG_FLRC_SYNC_WORD, buf, 4, SX12XX_Radio_All);
+    hal.WriteRegister(SX1280_REG_FLRC_SYNC_WORD, buf, 4, radioNumber);
 
     // FEI only works in Lora and Ranging mode
     modeSupportsFei = false;
@@ -396,7 +418,7 @@ void SX1280Driver::SetFIFOaddr(uint8_t txBaseAddr, uint8_t rxBaseAddr)
     hal.WriteCommand(SX1280_RADIO_SET_BUFFERBASEADDRESS, buf, sizeof(buf), SX12XX_Radio_All);
 }
 
-void SX1280Driver::SetDioIrqParams(uint16_t irqMask, uint16_t dio1Mask, uint16_t dio2Mask, uint16_t dio3Mask)
+void SX1280Driver::SetDioIrqParams(uint16_t irqMask, uint16_t dio1Mask, uint16_t dio2Mask, uint16_t dio3Mask, SX12XX_Radio_Number_t radioNumber)
 {
     uint8_t buf[8];
 
@@ -409,7 +431,7 @@ void SX1280Driver::SetDioIrqParams(uint16_t irqMask, uint16_t dio1Mask, uint16_t
     buf[6] = (uint8_t)((dio3Mask >> 8) & 0x00FF);
     buf[7] = (uint8_t)(dio3Mask & 0x00FF);
 
-    hal.WriteCommand(SX1280_RADIO_SET_DIOIRQPARAMS, buf, sizeof(buf), SX12XX_Radio_All);
+    hal.WriteCommand(SX1280_RADIO_SET_DIOIRQPARAMS, buf, sizeof(buf), radioNumber);
 }
 
 uint16_t ICACHE_RAM_ATTR SX1280Driver::GetIrqStatus(SX12XX_Radio_Number_t radioNumber)
@@ -23,14 +23,21 @@ public:
     void SetTxIdleMode() { SetMode(SX1280_MODE_FS, SX12XX_Radio_All); }; // set Idle mode used when switching from RX to TX
     void Config(uint8_t bw, uint8_t sf, uint8_t cr, uint32_t freq,
                 uint8_t PreambleLength, bool InvertIQ, uint8_t PayloadLength,
-                uint32_t flrcSyncWord=0, uint16_t flrcCrcSeed=0, uint8_t flrc=0);
+                uint32_t flrcSyncWord=0, uint16_t flrcCrcSeed=0, uint8_t flrc=0,
+                SX12XX_Radio_Number_t radioNumber = SX12XX_Radio_All);
+    // LoRa only, change the modulation of an announced rate switch in place, from the timer ISR
+    void SetModulation(uint8_t bw, uint8_t sf, uint8_t cr, uint8_t PreambleLength, SX12XX_Radio_Number_t radioNumber);
     void SetFrequencyReg(uint32_t freq, SX12XX_Radio_Number_t radioNumber, bool doRx = false);
     void SetOutputPower(int8_t power);
     void startCWTest(uint32_t freq, SX12XX_Radio_Number_t radioNumber);
+    void cwRepeat(SX12XX_Radio_Number_t radioNumber) {} // the CW carries on until the mode changes
 
 
     bool GetFrequencyErrorbool(SX12XX_Radio_Number_t radioNumber);
+    // Only the direction is known, one FREQ_STEP that way
+    int32_t GetFrequencyError(SX12XX_Radio_Number_t radioNumber) { return GetFrequencyErrorbool(radioNumber) ? -1 : 1; }
     bool FrequencyErrorAvailable() const { return modeSupportsFei && (LastPacketSNRRaw > 0); }
+    void SetPPMoffsetReg(int32_t offset, SX12XX_Radio_Number_t radioNumber) {} // the demodulator follows the frequency
 
     void TXnb(uint8_t * data, bool sendGeminiBuffer, uint8_t * dataGemini, SX12XX_Radio_Number_t radioNumber);
     void RXnb();
@@ -41,6 +48,7 @@ public:
     void GetStatus(SX12XX_Radio_Number_t radioNumber);
 
     uint8_t GetRxBufferAddr(SX12XX_Radio_Number_t radioNumber);
+    void StartRssiInst(SX12XX_Radio_Number_t radioNumber) {} // GetRssiInst reads it straight away
     int8_t GetRssiInst(SX12XX_Radio_Number_t radioNumber);
     void GetLastPacketStats();
     void CheckForSecondPacket();
@@ -61,21 +69,23 @@ private:
     void SetFIFOaddr(uint8_t txBaseAddr, uint8_t rxBaseAddr);
 
     // LoRa functions
-    void ConfigModParamsLoRa(uint8_t bw, uint8_t sf, uint8_t cr);
+    void ConfigModParamsLoRa(uint8_t bw, uint8_t sf, uint8_t cr, SX12XX_Radio_Number_t radioNumber);
     void SetPacketParamsLoRa(uint8_t PreambleLength, SX1280_RadioLoRaPacketLengthsModes_t HeaderType,
-                             uint8_t InvertIQ);
+                             uint8_t InvertIQ, SX12XX_Radio_Number_t radioNumber);
     // FLRC functions
-    void ConfigModParamsFLRC(uint8_t bw, uint8_t cr, uint8_t bt=SX1280_FLRC_BT_0_5);
+    void ConfigModParamsFLRC(uint8_t bw, uint8_t cr, uint8_t bt, SX12XX_Radio_Number_t radioNumber);
     void SetPacketParamsFLRC(uint8_t HeaderType,
                              uint8_t PreambleLength,
                              uint32_t syncWord,
                              uint16_t crcSeed,
-                             uint8_t cr);
+                             uint8_t cr,
+                             SX12XX_Radio_Number_t radioNumber);
 
     void SetDioIrqParams(uint16_t irqMask,
                          uint16_t dio1Mask=SX1280_IRQ_RADIO_NONE,
                          uint16_t dio2Mask=SX1280_IRQ_RADIO_NONE,
-                         uint16_t dio3Mask=SX1280_IRQ_RADIO_NONE);
+                         uint16_t dio3Mask=SX1280_IRQ_RADIO_NONE,
+                         SX12XX_Radio_Number_t radioNumber=SX12XX_Radio_All);
 
     static void IsrCallback_1();
     static void IsrCallback_2();
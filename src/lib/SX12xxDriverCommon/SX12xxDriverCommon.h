@@ -1,6 +1,7 @@
 #pragma once
 
 #include <targets.h>
+#include <type_traits>
 #include "FEC.h"
 
 typedef uint8_t SX12XX_Radio_Number_t;
@@ -125,4 +126,43 @@ protected:
             return (int8_t)((lower_value * (16 - transition_value) + average_value * transition_value) >> 8);
         }
     }
-};
\ No newline at end of file
+};
+
+/**
+ * The radio interface: what the rest of the firmware calls on Radio, which every driver (and the
+ * MockRadioDriver used by the native tests) has under the same names. Methods a chip has no use
+ * for are there and do nothing, so rx_main and tx_main do not need to know which chip it is.
+ *
+ * Radio is the driver of the chip the target is built for, not a base class pointer. Most of
+ * these run in ISRs, where a virtual call would go through a vtable in flash. Config() is left
+ * out, its modulation parameters differ between the chips.
+ */
+template <typename Driver>
+struct SX12xxDriverCheck
+{
+    static constexpr bool value =
+        // Setup
+        std::is_member_function_pointer<decltype(&Driver::Begin)>::value &&
+        std::is_member_function_pointer<decltype(&Driver::End)>::value &&
+        std::is_member_function_pointer<decltype(&Driver::SetTxIdleMode)>::value &&
+        std::is_member_function_pointer<decltype(&Driver::SetModulation)>::value &&
+        std::is_member_function_pointer<decltype(&Driver::SetFrequencyReg)>::value &&
+        std::is_member_function_pointer<decltype(&Driver::SetOutputPower)>::value &&
+        // TX and RX, the IRQs come back through TXdoneCallback and RXdoneCallback
+        std::is_member_function_pointer<decltype(&Driver::TXnb)>::value &&
+        std::is_member_function_pointer<decltype(&Driver::RXnb)>::value &&
+        std::is_member_function_pointer<decltype(&Driver::CheckForSecondPacket)>::value &&
+        // RSSI and SNR
+        std::is_member_function_pointer<decltype(&Driver::GetLastPacketStats)>::value &&
+        std::is_member_function_pointer<decltype(&Driver::StartRssiInst)>::value &&
+        std::is_member_function_pointer<decltype(&Driver::GetRssiInst)>::value &&
+        // Frequency error
+        std::is_member_function_pointer<decltype(&Driver::FrequencyErrorAvailable)>::value &&
+        std::is_member_function_pointer<decltype(&Driver::GetFrequencyError)>::value &&
+        std::is_member_function_pointer<decltype(&Driver::GetFrequencyErrorbool)>::value &&
+        std::is_member_function_pointer<decltype(&Driver::SetPPMoffsetReg)>::value &&
+        // CW test
+        std::is_member_function_pointer<decltype(&Driver::startCWTest)>::value &&
+        std::is_member_function_pointer<decltype(&Driver::cwRepeat)>::value &&
+        std::is_base_of<SX12xxDriverCommon, Driver>::value;
+};
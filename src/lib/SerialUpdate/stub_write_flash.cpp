@@ -14,6 +14,10 @@
 #include "soc_support.h"
 #include "stub_flasher.h"
 #include "targets.h"
+#include "delta_ota.h"
+#include "FirmwareScanner.h"
+#include "options.h"
+#include "logging.h"
 
 #include <Update.h>
 
@@ -29,6 +33,11 @@ static struct
     bool in_flash_mode;
     /* number of output bytes remaining to write */
     uint32_t remaining;
+    /* size passed to flash_begin, Update is started by the first data block */
+    uint32_t total_size;
+    bool update_started;
+    /* set when the data is a delta patch against the running firmware */
+    DeltaPatcher *delta;
     /* last error generated by a data packet */
     esp_command_error last_error;
 
@@ -43,6 +52,19 @@ static struct
     uint32_t remaining_compressed;
 } fs;
 
+static FirmwareScanner scanner((const char *)&target_name[4]);
+
+// Scans the image on its way to Update
+static class ScanningUpdateSink : public UpdateSink
+{
+public:
+    bool write(const uint8_t *data, uint32_t len) override
+    {
+        scanner.scan(data, len);
+        return UpdateSink::write(data, len);
+    }
+} updateSink;
+
 bool is_in_flash_mode(void)
 {
     return fs.in_flash_mode;
@@ -68,9 +90,13 @@ esp_command_error handle_flash_begin(uint32_t total_size, uint32_t offset)
 {
     fs.in_flash_mode = true;
     fs.remaining = total_size;
+    fs.total_size = total_size;
+    fs.update_started = false;
+    delete fs.delta;
+    fs.delta = nullptr;
+    scanner.reset();
     if (total_size != 0)
     {
-        Update.begin(total_size);
         fs.last_buf = static_cast<uint8_t *>(malloc(32768));
         fs.md5.begin();
     }
@@ -103,7 +129,29 @@ void handle_flash_data(uint8_t *data_buf, uint32_t length)
     memcpy(fs.last_buf, data_buf, length);
     fs.last_length = length;
     fs.remaining -= length;
-    Update.write(data_buf, length);
+
+    if (!fs.update_started)
+    {
+        static RunningFirmwareSource deltaSource;
+        fs.update_started = true;
+        if (DeltaPatcher::isDelta(data_buf, length))
+        {
+            // Update.begin() is called with the patched size from the patch header
+            fs.delta = new DeltaPatcher(deltaSource, updateSink);
+        }
+        else
+        {
+            Update.begin(fs.total_size);
+        }
+    }
+    if (fs.delta)
+    {
+        fs.delta->write(data_buf, length);
+    }
+    else
+    {
+        updateSink.write(data_buf, length);
+    }
 
     fs.last_error = ESP_UPDATE_OK;
 }
@@ -176,6 +224,26 @@ esp_command_error handle_flash_end(void)
 
     fs.in_flash_mode = false;
 
+    if (fs.delta)
+    {
+        // Never switch to a patched image that did not verify
+        const bool patched = fs.delta->status() == DELTA_OK;
+        delete fs.delta;
+        fs.delta = nullptr;
+        if (!patched)
+        {
+            Update.abort();
+            return ESP_BAD_DATA_CHECKSUM;
+        }
+    }
+
+    if (!scanner.isCompressed() && !scanner.targetMatched() && scanner.targetName()[0] != '\0')
+    {
+        // Firmware for a different target, only a warning as esptool has no way to confirm
+        // like the web UI does and cross target flashes through passthrough are legitimate
+        DBGLN("Warning: flashing firmware for target %s", scanner.targetName());
+    }
+
     if (!Update.end(true))
     {
         switch (Update.getError())
@@ -9,6 +9,7 @@
 
 DShotRMT::DShotRMT(gpio_num_t gpio, rmt_channel_t rmtChannel) : gpio_num(gpio), rmt_channel(rmtChannel) {
 	// ...create clean packet
+	build_nibble_items();
 	encode_dshot_to_rmt(DSHOT_NULL_PACKET);
 }
 
@@ -59,6 +60,7 @@ bool DShotRMT::begin(dshot_mode_t dshot_mode, bool is_bidirectional) {
 	// ...calc low signal timing
 	ticks_zero_low = (ticks_per_bit - ticks_zero_high);
 	ticks_one_low = (ticks_per_bit - ticks_one_high);
+	build_nibble_items();
 
 	rmt_config_t dshot_tx_rmt_config = {
 		.rmt_mode = RMT_MODE_TX,
@@ -101,91 +103,32 @@ bool DShotRMT::begin(dshot_mode_t dshot_mode, bool is_bidirectional) {
 
 // ...the config part is done, now the calculating and sending part
 void DShotRMT::send_dshot_value(uint16_t throttle_value, telemetric_request_t telemetric_request) {
-	dshot_packet_t dshot_rmt_packet = { };
-	
-	if (throttle_value == DSHOT_THROTTLE_MIN) {
-		dshot_rmt_packet.throttle_value = 0;
-	} else {
-		// ...packets are the same for bidirectional mode
-		dshot_rmt_packet.throttle_value = throttle_value;
-	}
-	dshot_rmt_packet.telemetric_request = telemetric_request;
-	dshot_rmt_packet.checksum = this->calc_dshot_chksum(dshot_rmt_packet);
-
-	output_rmt_data(dshot_rmt_packet);
-}
-
-rmt_item32_t* DShotRMT::encode_dshot_to_rmt(uint16_t parsed_packet) {
-    // ...is bidirecional mode activated
-    if (bidirectional) {
-        // ..."invert" the signal duration
-        for (int i = 0; i < DSHOT_PAUSE_BIT; i++, parsed_packet <<= 1) 	{
-		    if (parsed_packet & 0b1000000000000000) {
-			    // set one
-			    dshot_tx_rmt_item[i].duration0 = ticks_one_low;
-			    dshot_tx_rmt_item[i].duration1 = ticks_one_high;
-		    }
-		    else {
-			    // set zero
-			    dshot_tx_rmt_item[i].duration0 = ticks_zero_low;
-			    dshot_tx_rmt_item[i].duration1 = ticks_zero_high;
-		    }
-
-			dshot_tx_rmt_item[i].level0 = LOW;
-			dshot_tx_rmt_item[i].level1 = HIGH;
-        }
-    }
-
-    // ..."normal" DShot mode / "bidirectional" mode OFF
-    else {
-        for (int i = 0; i < DSHOT_PAUSE_BIT; i++, parsed_packet <<= 1) 	{
-		    if (parsed_packet & 0b1000000000000000) {
-			    // set one
-			    dshot_tx_rmt_item[i].duration0 = ticks_one_high;
-			    dshot_tx_rmt_item[i].duration1 = ticks_one_low;
-		    }
-		    else {
-			    // set zero
-			    dshot_tx_rmt_item[i].duration0 = ticks_zero_high;
-			    dshot_tx_rmt_item[i].duration1 = ticks_zero_low;
-		    }
-
-			dshot_tx_rmt_item[i].level0 = HIGH;
-			dshot_tx_rmt_item[i].level1 = LOW;
-        }
-    }
-
-	return dshot_tx_rmt_item;
+	// ...packets are the same for bidirectional mode, only the checksum is inverted
+	output_rmt_data(dshotFrame(throttle_value, telemetric_request == ENABLE_TELEMETRIC, bidirectional));
 }
 
-// ...just returns the checksum
-// DOES NOT APPEND CHECKSUM!!!
-uint16_t DShotRMT::calc_dshot_chksum(const dshot_packet_t& dshot_packet) {
-	// ...same initial 12bit data for bidirectional or "normal" mode
-	uint16_t packet = (dshot_packet.throttle_value << 1) | dshot_packet.telemetric_request;
-
+void DShotRMT::build_nibble_items() {
 	if (bidirectional) {
-		// ...calc the checksum "inverted" / bidirectional mode
-		return (~(packet ^ (packet >> 4) ^ (packet >> 8))) & 0x0F;
+		// ..."invert" the signal duration
+		dshotBuildNibbleTable(nibble_items, dshotRmtItem(ticks_zero_low, LOW, ticks_zero_high, HIGH),
+			dshotRmtItem(ticks_one_low, LOW, ticks_one_high, HIGH));
 	} else {
-		// ...calc the checksum "normal" mode
-		return (packet ^ (packet >> 4) ^ (packet >> 8)) & 0x0F;
+		dshotBuildNibbleTable(nibble_items, dshotRmtItem(ticks_zero_high, HIGH, ticks_zero_low, LOW),
+			dshotRmtItem(ticks_one_high, HIGH, ticks_one_low, LOW));
 	}
 }
 
-uint16_t DShotRMT::prepare_rmt_data(const dshot_packet_t& dshot_packet) {
-	auto chksum = calc_dshot_chksum(dshot_packet);
-
-    // ..."construct" the packet
-	uint16_t prepared_to_encode = (dshot_packet.throttle_value << 1) | dshot_packet.telemetric_request;
-	prepared_to_encode = (prepared_to_encode << 4) | chksum;
+rmt_item32_t* DShotRMT::encode_dshot_to_rmt(uint16_t parsed_packet) {
+	static_assert(sizeof(rmt_item32_t) == sizeof(uint32_t), "dshotRmtItem() is the layout of rmt_item32_t");
+	// ...four items at a time from the nibble table
+	dshotEncode(reinterpret_cast<uint32_t *>(dshot_tx_rmt_item), nibble_items, parsed_packet);
 
-	return prepared_to_encode;
+	return dshot_tx_rmt_item;
 }
 
 // ...finally output using ESP32 RMT
-void DShotRMT::output_rmt_data(const dshot_packet_t& dshot_packet) {
-	encode_dshot_to_rmt(prepare_rmt_data(dshot_packet));
+void DShotRMT::output_rmt_data(uint16_t parsed_packet) {
+	encode_dshot_to_rmt(parsed_packet);
 
 	rmt_tx_stop(rmt_channel);
 	rmt_fill_tx_items(rmt_channel, dshot_tx_rmt_item, DSHOT_PACKET_LENGTH, 0);
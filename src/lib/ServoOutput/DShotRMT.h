@@ -13,12 +13,11 @@
 
 // ...utilizing the IR Module library for generating the DShot signal
 #include <driver/rmt.h>
+#include "ServoPipeline.h"
 
 constexpr auto DSHOT_CLK_DIVIDER = 8; // ...slow down RMT clock to 0.1 microseconds / 100 nanoseconds per cycle
 constexpr auto DSHOT_PACKET_LENGTH = 18; // ...last packet is the pause followed by RMT end marker
 
-constexpr auto DSHOT_THROTTLE_MIN = 48;
-constexpr auto DSHOT_THROTTLE_MAX = 2047;
 constexpr auto DSHOT_NULL_PACKET = 0b0000000000000000;
 
 constexpr auto DSHOT_PAUSE = 21; // ...21bit is recommended, but to be sure
@@ -108,11 +107,12 @@ private:
 	uint16_t ticks_zero_low = 0;
 	uint16_t ticks_one_high = 0;
 	uint16_t ticks_one_low = 0;
+	// ...RMT items of each nibble of a frame, rebuilt when the mode changes
+	uint32_t nibble_items[16][4];
 
+	void build_nibble_items();
 	rmt_item32_t* encode_dshot_to_rmt(uint16_t parsed_packet);
-	uint16_t calc_dshot_chksum(const dshot_packet_t& dshot_packet);
-	uint16_t prepare_rmt_data(const dshot_packet_t& dshot_packet);
 
-	void output_rmt_data(const dshot_packet_t& dshot_packet);
+	void output_rmt_data(uint16_t parsed_packet);
 };
 #endif
\ No newline at end of file
@@ -0,0 +1,86 @@
+#include "ServoPipeline.h"
+
+// Failsafe positions are stored 0-1023 from this
+#define SERVO_FAILSAFE_MIN 988U
+
+static servoOutputKind_e kindOfMode(eServoOutputMode mode)
+{
+    switch (mode)
+    {
+    case som10KHzDuty:
+        return SERVO_OUT_DUTY;
+    case somOnOff:
+        return SERVO_OUT_ON_OFF;
+    case somDShot:
+        return SERVO_OUT_DSHOT;
+    default:
+        return mode >= somSerial ? SERVO_OUT_NONE : SERVO_OUT_PWM;
+    }
+}
+
+void servoOutputCompile(servoOutputDesc_t &desc, uint8_t inputChannel, eServoOutputMode mode,
+                        bool inverted, bool narrow, eServoOutputFailsafeMode failsafeMode, uint16_t failsafe)
+{
+    desc.kind = kindOfMode(mode);
+    desc.inputChannel = inputChannel;
+    desc.usShift = narrow ? 1 : 0;
+    desc.failsafeMode = failsafeMode;
+    // Flip the output around the mid-value if inverted, (1500 - us) + 1500
+    desc.invertFrom = inverted ? 3000U : 0;
+    // Failsafe values do not respect the inverted flag, they are absolute
+    desc.failsafeOutput = servoOutputFromUs(desc, failsafe + SERVO_FAILSAFE_MIN);
+    desc.stopOutput = servoOutputFromUs(desc, 0);
+}
+
+uint16_t ICACHE_RAM_ATTR servoOutputFromUs(const servoOutputDesc_t &desc, uint16_t us)
+{
+    switch (desc.kind)
+    {
+    case SERVO_OUT_PWM:
+        return us >> desc.usShift;
+    case SERVO_OUT_ON_OFF:
+        return us > 1500;
+    case SERVO_OUT_DUTY:
+        return constrain(us, 1000, 2000) - 1000;
+    case SERVO_OUT_DSHOT:
+        return fmap(constrain(us, 1000, 2000), 1000, 2000, DSHOT_THROTTLE_MIN, DSHOT_THROTTLE_MAX);
+    default:
+        return 0;
+    }
+}
+
+uint16_t ICACHE_RAM_ATTR dshotFrame(uint16_t throttle, bool telemetry, bool bidirectional)
+{
+    // DSHOT_THROTTLE_MIN is sent as 0, the motor stop command
+    if (throttle == DSHOT_THROTTLE_MIN)
+        throttle = 0;
+    const uint16_t packet = ((throttle & 0x7FF) << 1) | telemetry;
+    uint16_t checksum = packet ^ (packet >> 4) ^ (packet >> 8);
+    if (bidirectional)
+        checksum = ~checksum;
+    return (packet << 4) | (checksum & 0x0F);
+}
+
+void dshotBuildNibbleTable(uint32_t table[16][4], uint32_t zeroItem, uint32_t oneItem)
+{
+    for (uint8_t nibble = 0; nibble < 16; nibble++)
+    {
+        for (uint8_t bit = 0; bit < 4; bit++)
+        {
+            table[nibble][bit] = (nibble & (0x8 >> bit)) ? oneItem : zeroItem;
+        }
+    }
+}
+
+void ICACHE_RAM_ATTR dshotEncode(uint32_t items[DSHOT_FRAME_BITS], const uint32_t table[16][4], uint16_t frame)
+{
+    for (uint8_t n = 0; n < DSHOT_NIBBLES; n++, frame <<= 4)
+    {
+        const uint32_t *nibbleItems = table[frame >> 12];
+        uint32_t *out = &items[n * 4];
+        out[0] = nibbleItems[0];
+        out[1] = nibbleItems[1];
+        out[2] = nibbleItems[2];
+        out[3] = nibbleItems[3];
+    }
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "common.h"
+#include "crsf_protocol.h"
+#include <stdint.h>
+
+/*
+ * The output side of the servo pins, with the config taken out of the per packet path.
+ *
+ * Each output's config (input channel, mode, inverted, narrow, failsafe) is compiled into a flat
+ * servoOutputDesc_t when it changes. On every packet servoOutputFromCrsf() turns the channel
+ * value into what the output is written with: the pulse width for PWM, 0/1 for on/off, the
+ * duty for 10kHz and the throttle for DShot.
+ *
+ * DShot frames are put together with dshotFrame() and turned into RMT items a nibble at a time
+ * from a table built when the DShot mode is set, see dshotBuildNibbleTable().
+ *
+ * There is no hardware access here, devServoOutput and DShotRMT write the results.
+ */
+
+constexpr uint16_t DSHOT_THROTTLE_MIN = 48;
+constexpr uint16_t DSHOT_THROTTLE_MAX = 2047;
+#define DSHOT_FRAME_BITS 16
+#define DSHOT_NIBBLES (DSHOT_FRAME_BITS / 4)
+
+typedef enum : uint8_t {
+    SERVO_OUT_PWM,      // pulse width, us
+    SERVO_OUT_ON_OFF,   // 0 or 1
+    SERVO_OUT_DUTY,     // 0 to 1000 of the 10kHz period
+    SERVO_OUT_DSHOT,    // throttle, DSHOT_THROTTLE_MIN to DSHOT_THROTTLE_MAX
+    SERVO_OUT_NONE,     // the pin is serial, I2C or the like
+} servoOutputKind_e;
+
+typedef struct {
+    servoOutputKind_e kind;
+    uint8_t inputChannel;
+    uint8_t usShift;            // narrow pulses are half the width
+    eServoOutputFailsafeMode failsafeMode;
+    uint16_t invertFrom;        // 3000 flips the us around 1500, 0 leaves it
+    uint16_t failsafeOutput;    // for PWMFAILSAFE_SET_POSITION
+    uint16_t stopOutput;        // for PWMFAILSAFE_NO_PULSES
+} servoOutputDesc_t;
+
+void servoOutputCompile(servoOutputDesc_t &desc, uint8_t inputChannel, eServoOutputMode mode,
+                        bool inverted, bool narrow, eServoOutputFailsafeMode failsafeMode, uint16_t failsafe);
+
+// What the output is written with for a pulse of us
+uint16_t servoOutputFromUs(const servoOutputDesc_t &desc, uint16_t us);
+
+// The same for a CRSF channel value, the failsafe values do not go through here
+static inline uint16_t ICACHE_RAM_ATTR servoOutputFromCrsf(const servoOutputDesc_t &desc, uint16_t crsfVal)
+{
+    uint16_t us = CRSF_to_US(crsfVal);
+    if (desc.invertFrom)
+        us = desc.invertFrom - us;
+    return servoOutputFromUs(desc, us);
+}
+
+// The 16 bit frame: 11 bits of throttle (0 for DSHOT_THROTTLE_MIN), telemetry request, checksum
+uint16_t dshotFrame(uint16_t throttle, bool telemetry, bool bidirectional);
+
+// An RMT item in the layout of rmt_item32_t
+static inline constexpr uint32_t dshotRmtItem(uint16_t duration0, bool level0, uint16_t duration1, bool level1)
+{
+    return (uint32_t)duration0 | ((uint32_t)level0 << 15) | ((uint32_t)duration1 << 16) | ((uint32_t)level1 << 31);
+}
+
+// The four items of each nibble value, MSB first, from the items of a 0 and a 1 bit
+void dshotBuildNibbleTable(uint32_t table[16][4], uint32_t zeroItem, uint32_t oneItem);
+
+// The 16 items of a frame
+void dshotEncode(uint32_t items[DSHOT_FRAME_BITS], const uint32_t table[16][4], uint16_t frame);
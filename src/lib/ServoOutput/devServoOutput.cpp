@@ -6,8 +6,11 @@
 #include "crsf_protocol.h"
 #include "logging.h"
 #include "rxtx_intf.h"
+#include "ServoPipeline.h"
 
 static int8_t servoPins[PWM_MAX_CHANNELS];
+// Each channel's config compiled for the per packet path, rebuilt when it changes
+static servoOutputDesc_t servoOutputs[PWM_MAX_CHANNELS];
 static pwm_channel_t pwmChannels[PWM_MAX_CHANNELS];
 static uint16_t pwmChannelValues[PWM_MAX_CHANNELS];
 static bool initialized = false;
@@ -50,56 +53,66 @@ uint16_t servoOutputModeToFrequency(eServoOutputMode mode)
     }
 }
 
-static void servoWrite(uint8_t ch, uint16_t us)
+static void compileServoOutputs()
 {
-    const rx_config_pwm_t *chConfig = config.GetPwmChannel(ch);
+    for (int ch = 0 ; ch < GPIO_PIN_PWM_OUTPUTS_COUNT ; ++ch)
+    {
+        const rx_config_pwm_t *chConfig = config.GetPwmChannel(ch);
+        servoOutputCompile(servoOutputs[ch], chConfig->val.inputChannel, (eServoOutputMode)chConfig->val.mode,
+                           chConfig->val.inverted, chConfig->val.narrow,
+                           (eServoOutputFailsafeMode)chConfig->val.failsafeMode, chConfig->val.failsafe);
+    }
+}
+
+/**
+ * Write an output with a value from the pipeline, the pulse width, 0/1, duty or DShot throttle
+ */
+static void servoWrite(uint8_t ch, uint16_t value)
+{
+    const servoOutputDesc_t &desc = servoOutputs[ch];
 #if defined(PLATFORM_ESP32)
-    if ((eServoOutputMode)chConfig->val.mode == somDShot)
+    if (desc.kind == SERVO_OUT_DSHOT)
     {
-        // DBGLN("Writing DShot output: us: %u, ch: %d", us, ch);
+        // DBGLN("Writing DShot output: throttle: %u, ch: %d", value, ch);
         if (dshotInstances[ch])
         {
-            us = fmap(constrain(us, 1000, 2000), 1000, 2000, DSHOT_THROTTLE_MIN, DSHOT_THROTTLE_MAX); // Convert PWM signal in us to DShot value
-            dshotInstances[ch]->send_dshot_value(us);
+            dshotInstances[ch]->send_dshot_value(value);
         }
     }
     else
 #endif
-    if (servoPins[ch] != UNDEF_PIN && pwmChannelValues[ch] != us)
+    if (servoPins[ch] != UNDEF_PIN && pwmChannelValues[ch] != value)
     {
-        pwmChannelValues[ch] = us;
-        if ((eServoOutputMode)chConfig->val.mode == somOnOff)
+        pwmChannelValues[ch] = value;
+        if (desc.kind == SERVO_OUT_ON_OFF)
         {
-            digitalWrite(servoPins[ch], us > 1500);
+            digitalWrite(servoPins[ch], value);
         }
-        else if ((eServoOutputMode)chConfig->val.mode == som10KHzDuty)
+        else if (desc.kind == SERVO_OUT_DUTY)
         {
-            PWM.setDuty(pwmChannels[ch], constrain(us, 1000, 2000) - 1000);
+            PWM.setDuty(pwmChannels[ch], value);
         }
         else
         {
-            PWM.setMicroseconds(pwmChannels[ch], us / (chConfig->val.narrow + 1));
+            PWM.setMicroseconds(pwmChannels[ch], value);
         }
     }
 }
 
 static void servosFailsafe()
 {
-    constexpr unsigned SERVO_FAILSAFE_MIN = 988U;
     for (int ch = 0 ; ch < GPIO_PIN_PWM_OUTPUTS_COUNT ; ++ch)
     {
-        const rx_config_pwm_t *chConfig = config.GetPwmChannel(ch);
-        if (chConfig->val.failsafeMode == PWMFAILSAFE_SET_POSITION) {
-            // Note: Failsafe values do not respect the inverted flag, failsafe values are absolute
-            uint16_t us = chConfig->val.failsafe + SERVO_FAILSAFE_MIN;
+        const servoOutputDesc_t &desc = servoOutputs[ch];
+        if (desc.failsafeMode == PWMFAILSAFE_SET_POSITION) {
             // Always write the failsafe position even if the servo has never been started,
             // so all the servos go to their expected position
-            servoWrite(ch, us);
+            servoWrite(ch, desc.failsafeOutput);
         }
-        else if (chConfig->val.failsafeMode == PWMFAILSAFE_NO_PULSES) {
-            servoWrite(ch, 0);
+        else if (desc.failsafeMode == PWMFAILSAFE_NO_PULSES) {
+            servoWrite(ch, desc.stopOutput);
         }
-        else if (chConfig->val.failsafeMode == PWMFAILSAFE_LAST_POSITION) {
+        else if (desc.failsafeMode == PWMFAILSAFE_LAST_POSITION) {
             // do nothing
         }
     }
@@ -114,8 +127,8 @@ static void servosUpdate(unsigned long now)
         lastUpdate = now;
         for (int ch = 0 ; ch < GPIO_PIN_PWM_OUTPUTS_COUNT ; ++ch)
         {
-            const rx_config_pwm_t *chConfig = config.GetPwmChannel(ch);
-            const unsigned crsfVal = ChannelData[chConfig->val.inputChannel];
+            const servoOutputDesc_t &desc = servoOutputs[ch];
+            const unsigned crsfVal = ChannelData[desc.inputChannel];
             // crsfVal might 0 if this is a switch channel, and it has not been
             // received yet. Delay initializing the servo until the channel is valid
             if (crsfVal == 0)
@@ -123,14 +136,7 @@ static void servosUpdate(unsigned long now)
                 continue;
             }
 
-            uint16_t us = CRSF_to_US(crsfVal);
-            // Flip the output around the mid-value if inverted
-            // (1500 - usOutput) + 1500
-            if (chConfig->val.inverted)
-            {
-                us = 3000U - us;
-            }
-            servoWrite(ch, us);
+            servoWrite(ch, servoOutputFromCrsf(desc, crsfVal));
         } /* for each servo */
     }     /* if newChannelsAvailable */
 
@@ -151,6 +157,7 @@ static bool initialize()
         return false;
     }
 
+    compileServoOutputs();
 #if defined(PLATFORM_ESP32)
     uint8_t rmtCH = 0;
 #endif
@@ -210,6 +217,8 @@ static bool initialize()
 
 static int event()
 {
+    // Also called for EVENT_CONFIG_PWM_CHANGE
+    compileServoOutputs();
     if (connectionState == disconnected)
     {
         // Disconnected should come after failsafe on the RX,
@@ -269,7 +278,7 @@ device_t ServoOut_device = {
     .start = nullptr,
     .event = event,
     .timeout = timeout,
-    .subscribe = EVENT_CONNECTION_CHANGED
+    .subscribe = EVENT_CONNECTION_CHANGED | EVENT_CONFIG_PWM_CHANGE
 };
 
 #endif
@@ -70,7 +70,7 @@ void VtxPitmodeSwitchUpdate()
 
 static void eepromWriteToMSPOut()
 {
-    mspPacket_t packet;
+    mspPacket_t packet; // no payload
     packet.reset();
     packet.function = MSP_EEPROM_WRITE;
 
@@ -82,7 +82,7 @@ static void VtxConfigToMSPOut()
     DBGLN("Sending VtxConfig");
     uint8_t vtxIdx = (config.GetVtxBand()-1) * 8 + config.GetVtxChannel();
 
-    mspPacket_t packet;
+    mspPacketBuffer_t<4> packet;
     packet.reset();
     packet.makeCommand();
     packet.function = MSP_SET_VTX_CONFIG;
@@ -24,13 +24,13 @@
 #endif
 #include <DNSServer.h>
 
-#include <set>
 #include <StreamString.h>
 
 #include "ArduinoJson.h"
 #include "AsyncJson.h"
 #include <ESPAsyncWebServer.h>
 
+#include "AcceptEncoding.h"
 #include "common.h"
 #include "POWERMGNT.h"
 #include "FHSS.h"
@@ -38,7 +38,13 @@
 #include "logging.h"
 #include "options.h"
 #include "helpers.h"
+#include "profiler.h"
 #include "devButton.h"
+#include "delta_ota.h"
+#include "FirmwareScanner.h"
+#include "JsonWriter.h"
+#include "WebJson.h"
+#include "LBT.h"
 #if defined(TARGET_RX) && defined(PLATFORM_ESP32)
 #include "devVTXSPI.h"
 #endif
@@ -90,11 +96,21 @@ static constexpr uint32_t STALE_WIFI_SCAN = 20000;
 static uint32_t lastScanTimeMS = 0;
 
 static bool target_seen = false;
-static uint8_t target_pos = 0;
-static String target_found;
-static bool target_complete = false;
 static bool force_update = false;
-static uint32_t totalSize;
+static FirmwareScanner firmwareScanner((const char *)&target_name[4]);
+
+// Scans the image on its way to Update
+static class WebUpdateSink : public UpdateSink
+{
+public:
+  bool write(const uint8_t *data, uint32_t len) override;
+} updateSink;
+
+// Delta patch upload in progress, nullptr for a full image
+static struct deltaUpdate_s {
+  RunningFirmwareSource source;
+  DeltaPatcher patcher{source, updateSink};
+} *deltaUpdate = nullptr;
 
 void setWifiUpdateMode()
 {
@@ -143,32 +159,75 @@ static bool captivePortal(AsyncWebServerRequest *request)
   return false;
 }
 
+#if defined(WEB_CONTENT_BROTLI)
+#define WEB_CONTENT(name) (uint8_t *)name, sizeof(name), name##_ETAG, (uint8_t *)name##_BR, sizeof(name##_BR)
+#else
+#define WEB_CONTENT(name) (uint8_t *)name, sizeof(name), name##_ETAG, nullptr, 0
+#endif
+
+typedef struct {
+  const uint8_t* content;   // gzip
+  const size_t size;
+  const char *etag;
+  const uint8_t* brotli;    // optional
+  const size_t brotliSize;
+} web_content_t;
+
 static struct {
   const char *url;
   const char *contentType;
-  const uint8_t* content;
-  const size_t size;
+  const web_content_t content;
 } files[] = {
-  {"/scan.js", "text/javascript", (uint8_t *)SCAN_JS, sizeof(SCAN_JS)},
-  {"/mui.js", "text/javascript", (uint8_t *)MUI_JS, sizeof(MUI_JS)},
-  {"/elrs.css", "text/css", (uint8_t *)ELRS_CSS, sizeof(ELRS_CSS)},
-  {"/hardware.html", "text/html", (uint8_t *)HARDWARE_HTML, sizeof(HARDWARE_HTML)},
-  {"/hardware.js", "text/javascript", (uint8_t *)HARDWARE_JS, sizeof(HARDWARE_JS)},
-  {"/cw.html", "text/html", (uint8_t *)CW_HTML, sizeof(CW_HTML)},
-  {"/cw.js", "text/javascript", (uint8_t *)CW_JS, sizeof(CW_JS)},
+  {"/scan.js", "text/javascript", {WEB_CONTENT(SCAN_JS)}},
+  {"/mui.js", "text/javascript", {WEB_CONTENT(MUI_JS)}},
+  {"/elrs.css", "text/css", {WEB_CONTENT(ELRS_CSS)}},
+  {"/hardware.html", "text/html", {WEB_CONTENT(HARDWARE_HTML)}},
+  {"/hardware.js", "text/javascript", {WEB_CONTENT(HARDWARE_JS)}},
+  {"/cw.html", "text/html", {WEB_CONTENT(CW_HTML)}},
+  {"/cw.js", "text/javascript", {WEB_CONTENT(CW_JS)}},
 #if defined(RADIO_LR1121)
-  {"/lr1121.html", "text/html", (uint8_t *)LR1121_HTML, sizeof(LR1121_HTML)},
-  {"/lr1121.js", "text/javascript", (uint8_t *)LR1121_JS, sizeof(LR1121_JS)},
+  {"/lr1121.html", "text/html", {WEB_CONTENT(LR1121_HTML)}},
+  {"/lr1121.js", "text/javascript", {WEB_CONTENT(LR1121_JS)}},
 #endif
 };
 
+static const web_content_t indexContent = {WEB_CONTENT(INDEX_HTML)};
+static const web_content_t hardwareContent = {WEB_CONTENT(HARDWARE_HTML)};
+
+static void sendWebContent(AsyncWebServerRequest *request, const char *contentType, const web_content_t &content)
+{
+  // The pages refer to the other files as e.g. mui.js?v=<etag>, the browser can keep those forever.
+  // Anything else must be revalidated, which is a 304 with no body if it has not changed.
+  const String etag = String("\"") + content.etag + "\"";
+  const char *cacheControl = request->hasArg("v") && request->arg("v").equals(content.etag)
+    ? "public, max-age=31536000, immutable" : "no-cache";
+
+  AsyncWebServerResponse *response;
+  if (request->hasHeader("If-None-Match") && request->header("If-None-Match").indexOf(etag) >= 0)
+  {
+    response = request->beginResponse(304);
+  }
+  else if (content.brotli != nullptr && request->hasHeader("Accept-Encoding") && acceptsBrotli(request->header("Accept-Encoding").c_str()))
+  {
+    response = request->beginResponse(200, contentType, content.brotli, content.brotliSize);
+    response->addHeader("Content-Encoding", "br");
+  }
+  else
+  {
+    response = request->beginResponse(200, contentType, content.content, content.size);
+    response->addHeader("Content-Encoding", "gzip");
+  }
+  response->addHeader("ETag", etag);
+  response->addHeader("Cache-Control", cacheControl);
+  response->addHeader("Vary", "Accept-Encoding");
+  request->send(response);
+}
+
 static void WebUpdateSendContent(AsyncWebServerRequest *request)
 {
   for (auto & file : files) {
     if (request->url().equals(file.url)) {
-      AsyncWebServerResponse *response = request->beginResponse(200, file.contentType, file.content, file.size);
-      response->addHeader("Content-Encoding", "gzip");
-      request->send(response);
+      sendWebContent(request, file.contentType, file.content);
       return;
     }
   }
@@ -182,20 +241,14 @@ static void WebUpdateHandleRoot(AsyncWebServerRequest *request)
     return;
   }
   force_update = request->hasArg("force");
-  AsyncWebServerResponse *response;
   if (connectionState == hardwareUndefined)
   {
-    response = request->beginResponse(200, "text/html", (uint8_t*)HARDWARE_HTML, sizeof(HARDWARE_HTML));
+    sendWebContent(request, "text/html", hardwareContent);
   }
   else
   {
-    response = request->beginResponse(200, "text/html", (uint8_t*)INDEX_HTML, sizeof(INDEX_HTML));
+    sendWebContent(request, "text/html", indexContent);
   }
-  response->addHeader("Content-Encoding", "gzip");
-  response->addHeader("Cache-Control", "no-cache, no-store, must-revalidate");
-  response->addHeader("Pragma", "no-cache");
-  response->addHeader("Expires", "-1");
-  request->send(response);
 }
 
 static void putFile(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total)
@@ -264,7 +317,7 @@ static void UpdateSettings(AsyncWebServerRequest *request, JsonVariant &json)
   request->send(200);
 }
 
-static const char *GetConfigUidType(const JsonObject json)
+static const char *GetConfigUidType()
 {
 #if defined(TARGET_RX)
   if (config.GetBindStorage() == BINDSTORAGE_VOLATILE)
@@ -277,7 +330,7 @@ static const char *GetConfigUidType(const JsonObject json)
 #else
   if (firmwareOptions.hasUID)
   {
-    if (json["options"]["customised"] | false)
+    if (firmwareOptions.customised)
       return "Overridden";
     else
       return "Flashed";
@@ -286,21 +339,71 @@ static const char *GetConfigUidType(const JsonObject json)
 #endif
 }
 
-static void GetConfiguration(AsyncWebServerRequest *request)
+#if defined(DEBUG_ISR_PROFILE)
+typedef enum {
+  JSON_ENDPOINT_CONFIG,
+  JSON_ENDPOINT_NETWORKS,
+  JSON_ENDPOINT_TARGET,
+  JSON_ENDPOINT_COUNT
+} jsonEndpoint_e;
+
+static const char *jsonEndpointNames[JSON_ENDPOINT_COUNT] = {"config", "networks", "target"};
+
+static struct {
+  ProfileProbeStats chunkUs;  // time to generate each chunk
+  uint32_t bytes;             // size of the last response
+  uint32_t minFreeHeap;
+} jsonEndpointStats[JSON_ENDPOINT_COUNT];
+#else
+typedef uint8_t jsonEndpoint_e;
+#define JSON_ENDPOINT_CONFIG 0
+#define JSON_ENDPOINT_NETWORKS 1
+#define JSON_ENDPOINT_TARGET 2
+#endif
+
+/*
+ * Send the JSON from generate as a chunked response. generate is run again for every chunk and
+ * JsonWriter keeps only the part that fits in the chunk, so no document or String is built.
+ */
+static void sendJson(AsyncWebServerRequest *request, jsonEndpoint_e endpoint, std::function<void(JsonWriter &json)> generate)
 {
-  bool exportMode = request->hasArg("export");
-  auto *response = new AsyncJsonResponse();
-  JsonObject json = response->getRoot();
+  auto *response = request->beginChunkedResponse("application/json", [endpoint, generate](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+#if defined(DEBUG_ISR_PROFILE)
+    const uint32_t start = micros();
+#endif
+    JsonWriter json((char *)buffer, maxLen, index);
+    generate(json);
+#if defined(DEBUG_ISR_PROFILE)
+    auto &stats = jsonEndpointStats[endpoint];
+    stats.chunkUs.add(micros() - start);
+    stats.bytes = json.total();
+    if (stats.minFreeHeap == 0 || ESP.getFreeHeap() < stats.minFreeHeap)
+      stats.minFreeHeap = ESP.getFreeHeap();
+#endif
+    return json.length();
+  });
+  request->send(response);
+}
 
+static void WriteConfiguration(JsonWriter &json, bool exportMode)
+{
+  json.beginObject();
   if (!exportMode)
   {
-    JsonDocument options;
-    deserializeJson(options, getOptions());
-    json["options"] = options;
+    json.key("options");
+    if (getOptions().length() > 0)
+      json.raw(getOptions().c_str());
+    else
+      json.null();
   }
 
-  JsonArray uid = json["config"]["uid"].to<JsonArray>();
-  copyArray(UID, UID_LEN, uid);
+  json.key("config");
+  json.beginObject();
+  json.key("uid");
+  json.beginArray();
+  for (int i = 0; i < UID_LEN; i++)
+    json.value(UID[i]);
+  json.endArray();
 
 #if defined(TARGET_TX)
   int button_count = 0;
@@ -308,68 +411,99 @@ static void GetConfiguration(AsyncWebServerRequest *request)
     button_count = 1;
   if (GPIO_PIN_BUTTON2 != UNDEF_PIN)
     button_count = 2;
-  for (int button=0 ; button<button_count ; button++)
+  if (button_count > 0)
   {
-    const tx_button_color_t *buttonColor = config.GetButtonActions(button);
-    if (hardware_int(button == 0 ? HARDWARE_button_led_index : HARDWARE_button2_led_index) != -1) {
-      json["config"]["button-actions"][button]["color"] = buttonColor->val.color;
-    }
-    for (int pos=0 ; pos<button_GetActionCnt() ; pos++)
+    json.key("button-actions");
+    json.beginArray();
+    for (int button=0 ; button<button_count ; button++)
     {
-      json["config"]["button-actions"][button]["action"][pos]["is-long-press"] = buttonColor->val.actions[pos].pressType ? true : false;
-      json["config"]["button-actions"][button]["action"][pos]["count"] = buttonColor->val.actions[pos].count;
-      json["config"]["button-actions"][button]["action"][pos]["action"] = buttonColor->val.actions[pos].action;
+      const tx_button_color_t *buttonColor = config.GetButtonActions(button);
+      json.beginObject();
+      if (hardware_int(button == 0 ? HARDWARE_button_led_index : HARDWARE_button2_led_index) != -1) {
+        json.member("color", buttonColor->val.color);
+      }
+      json.key("action");
+      json.beginArray();
+      for (int pos=0 ; pos<button_GetActionCnt() ; pos++)
+      {
+        json.beginObject();
+        json.member("is-long-press", buttonColor->val.actions[pos].pressType ? true : false);
+        json.member("count", buttonColor->val.actions[pos].count);
+        json.member("action", buttonColor->val.actions[pos].action);
+        json.endObject();
+      }
+      json.endArray();
+      json.endObject();
     }
+    json.endArray();
   }
   if (exportMode)
   {
-    json["config"]["fan-mode"] = config.GetFanMode();
-    json["config"]["power-fan-threshold"] = config.GetPowerFanThreshold();
-
-    json["config"]["motion-mode"] = config.GetMotionMode();
-
-    json["config"]["vtx-admin"]["band"] = config.GetVtxBand();
-    json["config"]["vtx-admin"]["channel"] = config.GetVtxChannel();
-    json["config"]["vtx-admin"]["pitmode"] = config.GetVtxPitmode();
-    json["config"]["vtx-admin"]["power"] = config.GetVtxPower();
-    json["config"]["backpack"]["dvr-start-delay"] = config.GetDvrStartDelay();
-    json["config"]["backpack"]["dvr-stop-delay"] = config.GetDvrStopDelay();
-    json["config"]["backpack"]["dvr-aux-channel"] = config.GetDvrAux();
-
+    json.member("fan-mode", config.GetFanMode());
+    json.member("power-fan-threshold", config.GetPowerFanThreshold());
+
+    json.member("motion-mode", config.GetMotionMode());
+
+    json.key("vtx-admin");
+    json.beginObject();
+    json.member("band", config.GetVtxBand());
+    json.member("channel", config.GetVtxChannel());
+    json.member("pitmode", config.GetVtxPitmode());
+    json.member("power", config.GetVtxPower());
+    json.endObject();
+    json.key("backpack");
+    json.beginObject();
+    json.member("dvr-start-delay", config.GetDvrStartDelay());
+    json.member("dvr-stop-delay", config.GetDvrStopDelay());
+    json.member("dvr-aux-channel", config.GetDvrAux());
+    json.endObject();
+
+    json.key("model");
+    json.beginObject();
     for (int model = 0 ; model < CONFIG_TX_MODEL_CNT ; model++)
     {
       const model_config_t &modelConfig = config.GetModelConfig(model);
-      String strModel(model);
-      JsonObject modelJson = json["config"]["model"][strModel].to<JsonObject>();
-      modelJson["packet-rate"] = modelConfig.rate;
-      modelJson["telemetry-ratio"] = modelConfig.tlm;
-      modelJson["switch-mode"] = modelConfig.switchMode;
-      modelJson["power"]["max-power"] = modelConfig.power;
-      modelJson["power"]["dynamic-power"] = modelConfig.dynamicPower;
-      modelJson["power"]["boost-channel"] = modelConfig.boostChannel;
-      modelJson["model-match"] = modelConfig.modelMatch;
-      modelJson["tx-antenna"] = modelConfig.txAntenna;
+      char strModel[4];
+      itoa(model, strModel, 10);
+      json.key(strModel);
+      json.beginObject();
+      json.member("packet-rate", modelConfig.rate);
+      json.member("telemetry-ratio", modelConfig.tlm);
+      json.member("switch-mode", modelConfig.switchMode);
+      json.key("power");
+      json.beginObject();
+      json.member("max-power", modelConfig.power);
+      json.member("dynamic-power", modelConfig.dynamicPower);
+      json.member("boost-channel", modelConfig.boostChannel);
+      json.endObject();
+      json.member("model-match", modelConfig.modelMatch);
+      json.member("tx-antenna", modelConfig.txAntenna);
+      json.endObject();
     }
+    json.endObject();
   }
 #endif /* TARGET_TX */
 
   if (!exportMode)
   {
-    json["config"]["ssid"] = station_ssid;
-    json["config"]["mode"] = wifiMode == WIFI_STA ? "STA" : "AP";
+    json.member("ssid", station_ssid);
+    json.member("mode", wifiMode == WIFI_STA ? "STA" : "AP");
     #if defined(TARGET_RX)
-    json["config"]["serial-protocol"] = config.GetSerialProtocol();
+    json.member("serial-protocol", config.GetSerialProtocol());
 #if defined(PLATFORM_ESP32)
-    json["config"]["serial1-protocol"] = config.GetSerial1Protocol();
+    json.member("serial1-protocol", config.GetSerial1Protocol());
 #endif
-    json["config"]["sbus-failsafe"] = config.GetFailsafeMode();
-    json["config"]["modelid"] = config.GetModelId();
-    json["config"]["force-tlm"] = config.GetForceTlmOff();
-    json["config"]["vbind"] = config.GetBindStorage();
+    json.member("sbus-failsafe", config.GetFailsafeMode());
+    json.member("modelid", config.GetModelId());
+    json.member("force-tlm", config.GetForceTlmOff());
+    json.member("vbind", config.GetBindStorage());
+    json.key("pwm");
+    json.beginArray();
     for (int ch=0; ch<GPIO_PIN_PWM_OUTPUTS_COUNT; ++ch)
     {
-      json["config"]["pwm"][ch]["config"] = config.GetPwmChannel(ch)->raw;
-      json["config"]["pwm"][ch]["pin"] = GPIO_PIN_PWM_OUTPUTS[ch];
+      json.beginObject();
+      json.member("config", config.GetPwmChannel(ch)->raw);
+      json.member("pin", GPIO_PIN_PWM_OUTPUTS[ch]);
       uint8_t features = 0;
       auto pin = GPIO_PIN_PWM_OUTPUTS[ch];
       if (pin == U0TXD_GPIO_NUM) features |= 1;  // SerialTX supported
@@ -384,17 +518,26 @@ static void GetConfiguration(AsyncWebServerRequest *request)
       else if ((GPIO_PIN_SERIAL1_RX == UNDEF_PIN || GPIO_PIN_SERIAL1_TX == UNDEF_PIN) &&
                (!(features & 1) && !(features & 2))) features |= 96; // Both Serial1 RX/TX supported (on any pin if not already featured for Serial 1)
       #endif
-      json["config"]["pwm"][ch]["features"] = features;
+      json.member("features", features);
+      json.endObject();
     }
+    json.endArray();
     #endif
-    json["config"]["product_name"] = product_name;
-    json["config"]["lua_name"] = device_name;
-    json["config"]["reg_domain"] = FHSSgetRegulatoryDomain();
-    json["config"]["uidtype"] = GetConfigUidType(json);
+    json.member("product_name", product_name);
+    json.member("lua_name", device_name);
+    json.member("reg_domain", FHSSgetRegulatoryDomain());
+    json.member("uidtype", GetConfigUidType());
   }
+  json.endObject();
+  json.endObject();
+}
 
-  response->setLength();
-  request->send(response);
+static void GetConfiguration(AsyncWebServerRequest *request)
+{
+  const bool exportMode = request->hasArg("export");
+  sendJson(request, JSON_ENDPOINT_CONFIG, [exportMode](JsonWriter &json) {
+    WriteConfiguration(json, exportMode);
+  });
 }
 
 #if defined(TARGET_TX)
@@ -540,55 +683,124 @@ static void UpdateConfiguration(AsyncWebServerRequest *request, JsonVariant &jso
 
 static void WebUpdateGetTarget(AsyncWebServerRequest *request)
 {
-  JsonDocument json;
-  json["target"] = &target_name[4];
-  json["version"] = VERSION;
-  json["product_name"] = product_name;
-  json["lua_name"] = device_name;
-  json["reg_domain"] = FHSSgetRegulatoryDomain();
-  json["git-commit"] = commit;
+  sendJson(request, JSON_ENDPOINT_TARGET, [](JsonWriter &json) {
+    web_target_info_t info;
+    info.target = (const char *)&target_name[4];
+    info.version = VERSION;
+    info.productName = product_name;
+    info.luaName = device_name;
+    info.regDomain = FHSSgetRegulatoryDomain();
+    info.gitCommit = commit;
 #if defined(TARGET_TX)
-  json["module-type"] = "TX";
-#endif
-#if defined(TARGET_RX)
-  json["module-type"] = "RX";
+    info.moduleType = "TX";
+#else
+    info.moduleType = "RX";
 #endif
 #if defined(RADIO_SX128X)
-  json["radio-type"] = "SX128X";
-  json["has-sub-ghz"] = false;
-#endif
-#if defined(RADIO_SX127X)
-  json["radio-type"] = "SX127X";
-  json["has-sub-ghz"] = true;
+    info.radioType = "SX128X";
+    info.hasSubGHz = false;
+#elif defined(RADIO_SX127X)
+    info.radioType = "SX127X";
+    info.hasSubGHz = true;
+#elif defined(RADIO_LR1121)
+    info.radioType = "LR1121";
+    info.hasSubGHz = true;
 #endif
-#if defined(RADIO_LR1121)
-  json["radio-type"] = "LR1121";
-  json["has-sub-ghz"] = true;
+    writeTargetJson(json, info);
+  });
+}
+
+#if defined(DEBUG_ISR_PROFILE)
+static void WebUpdateGetProfile(AsyncWebServerRequest *request)
+{
+  // The radio timer is stopped in WiFi mode so this is a snapshot of the last connected session
+  JsonDocument json;
+  json["interval"] = Profiler::intervalUs;
+  json["bucket0"] = ProfileProbeStats::BUCKET0_US;
+  for (uint8_t i = 0; i < PROFILE_PROBE_COUNT; i++)
+  {
+    const profileProbe_e probe = (profileProbe_e)i;
+    const ProfileProbeStats &stats = Profiler::probes[probe];
+    if (stats.count() == 0)
+      continue;
+    JsonObject obj = json["probes"][Profiler::name(probe)].to<JsonObject>();
+    obj["count"] = stats.count();
+    obj["min"] = stats.min();
+    obj["mean"] = stats.mean();
+    obj["max"] = stats.max();
+    obj["max_pct"] = stats.maxPercentOf(Profiler::intervalUs);
+    JsonArray histogram = obj["histogram"].to<JsonArray>();
+    for (uint8_t b = 0; b < ProfileProbeStats::BUCKETS; b++)
+      histogram.add(stats.bucket(b));
+  }
+  for (uint8_t i = 0; i < JSON_ENDPOINT_COUNT; i++)
+  {
+    const auto &stats = jsonEndpointStats[i];
+    if (stats.chunkUs.count() == 0)
+      continue;
+    JsonObject obj = json["endpoints"][jsonEndpointNames[i]].to<JsonObject>();
+    obj["chunks"] = stats.chunkUs.count();
+    obj["chunk-mean-us"] = stats.chunkUs.mean();
+    obj["chunk-max-us"] = stats.chunkUs.max();
+    obj["bytes"] = stats.bytes;
+    obj["min-free-heap"] = stats.minFreeHeap;
+  }
+
+  AsyncResponseStream *response = request->beginResponseStream("application/json");
+  serializeJson(json, *response);
+  request->send(response);
+}
 #endif
 
+#if defined(Regulatory_Domain_EU_CE_2400)
+static void WebUpdateGetLbtAudit(AsyncWebServerRequest *request)
+{
+  // Deferred and forced transmissions for compliance review, newest last
+  JsonDocument json;
+  json["enabled"] = LbtIsEnabled;
+  json["success"] = LBTSuccessCalc.getLQ();
+  json["deferred"] = LbtAudit.deferred();
+  json["forced"] = LbtAudit.forced();
+  JsonArray entries = json["entries"].to<JsonArray>();
+  for (uint8_t i = 0; i < LbtAudit.count(); i++)
+  {
+    const lbtAuditEntry_t &entry = LbtAudit.get(i);
+    JsonObject obj = entries.add<JsonObject>();
+    obj["time"] = entry.timeMs;
+    obj["forced"] = entry.result == LBT_FORCED;
+    obj["radio"] = entry.radio + 1;
+    obj["channel"] = entry.channel;
+    obj["rssi"] = entry.rssi;
+    obj["threshold"] = entry.threshold;
+  }
+
   AsyncResponseStream *response = request->beginResponseStream("application/json");
   serializeJson(json, *response);
   request->send(response);
 }
+#endif
+
+// The SSID straight from the scan results, WiFi.SSID() would copy it into a String
+static const char *ScanResultSsid(uint8_t index, uint8_t &len)
+{
+#if defined(PLATFORM_ESP8266)
+  const bss_info *info = WiFi.getScanInfoByIndex(index);
+  len = info ? info->ssid_len : 0;
+#else
+  const wifi_ap_record_t *info = (wifi_ap_record_t *)WiFi.getScanInfoByIndex(index);
+  len = info ? strnlen((const char *)info->ssid, sizeof(info->ssid)) : 0;
+#endif
+  return info ? (const char *)info->ssid : nullptr;
+}
 
 static void WebUpdateSendNetworks(AsyncWebServerRequest *request)
 {
   int numNetworks = WiFi.scanComplete();
   if (numNetworks >= 0 && millis() - lastScanTimeMS < STALE_WIFI_SCAN) {
     DBGLN("Found %d networks", numNetworks);
-    std::set<String> vs;
-    String s="[";
-    for(int i=0 ; i<numNetworks ; i++) {
-      String w = WiFi.SSID(i);
-      DBGLN("found %s", w.c_str());
-      if (vs.find(w)==vs.end() && w.length()>0) {
-        if (!vs.empty()) s += ",";
-        s += "\"" + w + "\"";
-        vs.insert(w);
-      }
-    }
-    s+="]";
-    request->send(200, "application/json", s);
+    sendJson(request, JSON_ENDPOINT_NETWORKS, [numNetworks](JsonWriter &json) {
+      writeNetworksJson(json, numNetworks, ScanResultSsid);
+    });
   } else {
     if (WiFi.scanComplete() != WIFI_SCAN_RUNNING)
     {
@@ -689,9 +901,13 @@ static void corsPreflightResponse(AsyncWebServerRequest *request) {
 }
 
 static void WebUploadResponseHandler(AsyncWebServerRequest *request) {
-  if (target_seen || Update.hasError()) {
+  // A delta patch must have been applied and verified before the new image is allowed to boot
+  const bool deltaFailed = deltaUpdate && deltaUpdate->patcher.status() != DELTA_OK;
+  // compressed images cannot be checked
+  target_seen = target_seen || force_update || firmwareScanner.isCompressed() || firmwareScanner.targetMatched();
+  if (target_seen || Update.hasError() || deltaFailed) {
     String msg;
-    if (!Update.hasError() && Update.end()) {
+    if (!Update.hasError() && !deltaFailed && Update.end()) {
       DBGLN("Update complete, rebooting");
       msg = String("{\"status\": \"ok\", \"msg\": \"Update complete. ");
       #if defined(TARGET_RX)
@@ -702,7 +918,12 @@ static void WebUploadResponseHandler(AsyncWebServerRequest *request) {
       rebootTime = millis() + 200;
     } else {
       StreamString p = StreamString();
-      if (Update.hasError()) {
+      if (deltaFailed) {
+        p.print(DeltaPatcher::statusText(deltaUpdate->patcher.status()));
+        #if defined(PLATFORM_ESP32)
+          Update.abort();
+        #endif
+      } else if (Update.hasError()) {
         Update.printError(p);
       } else {
         p.println("Not enough data uploaded!");
@@ -714,10 +935,12 @@ static void WebUploadResponseHandler(AsyncWebServerRequest *request) {
     AsyncWebServerResponse *response = request->beginResponse(200, "application/json", msg);
     response->addHeader("Connection", "close");
     request->send(response);
+    delete deltaUpdate;
+    deltaUpdate = nullptr;
   } else {
     String message = String("{\"status\": \"mismatch\", \"msg\": \"<b>Current target:</b> ") + (const char *)&target_name[4] + ".<br>";
-    if (target_found.length() != 0) {
-      message += "<b>Uploaded image:</b> " + target_found + ".<br/>";
+    if (firmwareScanner.targetName()[0] != '\0') {
+      message += String("<b>Uploaded image:</b> ") + firmwareScanner.targetName() + ".<br/>";
     }
     message += "<br/>It looks like you are flashing firmware with a different name to the current  firmware.  This sometimes happens because the hardware was flashed from the factory with an early version that has a different name. Or it may have even changed between major releases.";
     message += "<br/><br/>Please double check you are uploading the correct target, then proceed with 'Flash Anyway'.\"}";
@@ -740,51 +963,36 @@ static void WebUploadDataHandler(AsyncWebServerRequest *request, const String& f
     DBGLN("Free space = %u", maxSketchSpace);
     UNUSED(maxSketchSpace); // for warning
     #endif
-    if (!Update.begin(filesize, U_FLASH)) { // pass the size provided
+    target_seen = false;
+    firmwareScanner.reset();
+    delete deltaUpdate;
+    deltaUpdate = nullptr;
+    if (DeltaPatcher::isDelta(data, len)) {
+      // Update.begin() is called with the patched size once the patch header has been checked
+      DBGLN("Delta update");
+      deltaUpdate = new deltaUpdate_s;
+    } else if (!Update.begin(filesize, U_FLASH)) { // pass the size provided
       Update.printError(LOGGING_UART);
     }
-    target_seen = false;
-    target_found.clear();
-    target_complete = false;
-    target_pos = 0;
-    totalSize = 0;
   }
   if (len) {
     DBGVLN("writing %d", len);
-    if (Update.write(data, len) == len) {
-      if (force_update || (totalSize == 0 && *data == 0x1F))
-        target_seen = true;
-      if (!target_seen) {
-        for (size_t i=0 ; i<len ;i++) {
-          if (!target_complete && (target_pos >= 4 || target_found.length() > 0)) {
-            if (target_pos == 4) {
-              target_found.clear();
-            }
-            if (data[i] == 0 || target_found.length() > 50) {
-              target_complete = true;
-            }
-            else {
-              target_found += (char)data[i];
-            }
-          }
-          if (data[i] == target_name[target_pos]) {
-            ++target_pos;
-            if (target_pos >= target_name_size) {
-              target_seen = true;
-            }
-          }
-          else {
-            target_pos = 0; // Startover
-          }
-        }
-      }
-      totalSize += len;
-    } else {
+    if (deltaUpdate) {
+      deltaUpdate->patcher.write(data, len);
+    } else if (!updateSink.write(data, len)) {
       DBGLN("write failed to write %d", len);
     }
   }
 }
 
+bool WebUpdateSink::write(const uint8_t *data, uint32_t len) {
+  if (!UpdateSink::write(data, len)) {
+    return false;
+  }
+  firmwareScanner.scan(data, len);
+  return true;
+}
+
 static void WebUploadForceUpdateHandler(AsyncWebServerRequest *request) {
   target_seen = true;
   if (request->arg("action").equals("confirm")) {
@@ -882,10 +1090,8 @@ static void HandleContinuousWave(AsyncWebServerRequest *request) {
     Radio.startCWTest(setSubGHz ? FHSSconfig->freq_center : FHSSconfigDualBand->freq_center, radio);
 #else
     Radio.startCWTest(FHSSconfig->freq_center, radio);
-#if defined(RADIO_SX127X)
-    deferExecutionMillis(50, [radio](){ Radio.cwRepeat(radio); });
-#endif
 #endif
+    deferExecutionMillis(50, [radio](){ Radio.cwRepeat(radio); });
   } else {
     int radios = (GPIO_PIN_NSS_2 == UNDEF_PIN) ? 1 : 2;
     request->send(200, "application/json", String("{\"radios\": ") + radios + ", \"center\": "+ FHSSconfig->freq_center +
@@ -1064,6 +1270,12 @@ static void startServices()
   server.on("/access", WebUpdateAccessPoint);
   server.on("/target", WebUpdateGetTarget);
   server.on("/firmware.bin", WebUpdateGetFirmware);
+  #if defined(DEBUG_ISR_PROFILE)
+    server.on("/profile.json", HTTP_GET, WebUpdateGetProfile);
+  #endif
+  #if defined(Regulatory_Domain_EU_CE_2400)
+    server.on("/lbt.json", HTTP_GET, WebUpdateGetLbtAudit);
+  #endif
 
   server.on("/update", HTTP_POST, WebUploadResponseHandler, WebUploadDataHandler);
   server.on("/update", HTTP_OPTIONS, corsPreflightResponse);
@@ -19,10 +19,10 @@ extern LR1121Hal hal;
 
 static void WebUploadLR1121ResponseHandler(AsyncWebServerRequest *request)
 {
-    const int uploadError = Radio.EndUpdate();
+    const lr1121UpdateResult_e uploadError = Radio.EndUpdate();
 
     String msg;
-    if (uploadError == 0)
+    if (uploadError == LR1121_UPDATE_OK)
     {
         msg = String(R"({"status": "ok", "msg": "Update complete. Refresh page to see new version information."})");
         // add tag file for lr1121 custom firmware
@@ -36,14 +36,8 @@ static void WebUploadLR1121ResponseHandler(AsyncWebServerRequest *request)
     else
     {
         StreamString p;
-        if (uploadError == -1)
-        {
-            p.print("Not enough data uploaded!");
-        }
-        else
-        {
-            p.print("Update failed, refresh and try again.");
-        }
+        p.print(LR1121Update::errorString(uploadError));
+        p.print(", refresh and try again.");
         DBGLN("Failed to upload firmware: %s", p.c_str());
         msg = String(R"({"status": "error", "msg": ")") + p + R"("})";
     }
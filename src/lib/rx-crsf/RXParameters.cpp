@@ -6,6 +6,7 @@
 #include "deferred.h"
 #include "devServoOutput.h"
 #include "helpers.h"
+#include "profiler.h"
 
 #define RX_HAS_SERIAL1 (GPIO_PIN_SERIAL1_TX != UNDEF_PIN || OPT_HAS_SERVO_OUTPUT)
 
@@ -178,6 +179,15 @@ static commandParameter luaSetFailsafe = {
 
 //---------------------------- Output Mapping -----------------------------
 
+#if defined(DEBUG_ISR_PROFILE)
+//---------------------------- ISR Profile -----------------------------
+
+static constexpr profileProbe_e luaProfileProbeIds[] = {PROFILE_TIMER_TICK, PROFILE_TIMER_TOCK, PROFILE_RX_DONE, PROFILE_TX_DONE};
+static CRSFProfileFolder luaProfile(luaProfileProbeIds, ARRAY_SIZE(luaProfileProbeIds));
+
+//---------------------------- ISR Profile -----------------------------
+#endif
+
 static selectionParameter luaBindStorage = {
     {"Bind Storage", CRSF_TEXT_SELECTION},
     0, // value
@@ -584,6 +594,10 @@ void RXEndpoint::registerParameters()
     sendCommandResponse(&luaBindMode, arg < 5 ? lcsExecuting : lcsIdle, arg < 5 ? "Entering..." : "");
   });
 
+#if defined(DEBUG_ISR_PROFILE)
+  registerProfileFolder(luaProfile);
+#endif
+
   registerParameter(&luaModelNumber);
   registerParameter(&luaELRSversion);
 }
@@ -656,5 +670,9 @@ void RXEndpoint::updateParameters()
     LUA_FIELD_HIDE(luaSourceSysId)
     LUA_FIELD_HIDE(luaTargetSysId)
   }
+
+#if defined(DEBUG_ISR_PROFILE)
+  luaProfile.update();
+#endif
 }
 #endif
\ No newline at end of file
@@ -8,6 +8,7 @@
 #include "config.h"
 #include "helpers.h"
 #include "msptypes.h"
+#include "profiler.h"
 
 uint8_t adjustSwitchModeForAirRate(OtaSwitchMode_e eSwitchMode, uint8_t packetSize);
 
@@ -319,6 +320,13 @@ static stringParameter luaBackpackVersion = {
 
 //---------------------------- BACKPACK ------------------
 
+#if defined(DEBUG_ISR_PROFILE)
+//---------------------------- ISR PROFILE ------------------
+static constexpr profileProbe_e luaProfileProbeIds[] = {PROFILE_TIMER_TOCK, PROFILE_SEND_RC, PROFILE_RX_DONE, PROFILE_TX_DONE};
+static CRSFProfileFolder luaProfile(luaProfileProbeIds, ARRAY_SIZE(luaProfileProbeIds));
+//---------------------------- ISR PROFILE ------------------
+#endif
+
 extern TxConfig config;
 extern void VtxTriggerSend();
 extern void ResetPower();
@@ -846,7 +854,7 @@ void TXModuleEndpoint::registerParameters()
         config.SetModelMatch(newModelMatch);
         if (connectionState == connected)
         {
-          mspPacket_t msp;
+          mspPacketBuffer_t<2> msp;
           msp.reset();
           msp.makeCommand();
           msp.function = MSP_SET_RX_CONFIG;
@@ -966,6 +974,10 @@ void TXModuleEndpoint::registerParameters()
     registerParameter(&luaBind, sendCallback);
   }
 
+#if defined(DEBUG_ISR_PROFILE)
+  registerProfileFolder(luaProfile);
+#endif
+
   registerParameter(&luaInfo);
   if (strlen(version) < 21) {
     strlcpy(version_domain, version, 21);
@@ -1050,5 +1062,8 @@ void TXModuleEndpoint::updateParameters()
     setTextSelectionValue(&luaBackpackTelemetry, config.GetBackpackDisable() ? 0 : config.GetBackpackTlmMode());
     setStringValue(&luaBackpackVersion, backpackVersion);
   }
+#if defined(DEBUG_ISR_PROFILE)
+  luaProfile.update();
+#endif
   updateFolderNames();
 }
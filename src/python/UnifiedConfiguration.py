@@ -7,6 +7,7 @@ import sys
 
 from external import jmespath
 from firmware import TXType
+import hardware_layout
 
 
 def findFirmwareEnd(f):
@@ -60,11 +61,19 @@ def appendToFirmware(firmware_file, product_name, lua_name, defines, config, lay
                         del hardware['led']
                 layout = (json.JSONEncoder().encode(hardware).encode() + (b'\0' * 2048))[0:2048]
                 firmware_file.write(layout)
+                # binary copy so the firmware does not have to parse the JSON at boot
+                binary = hardware_layout.encode(hardware)
+                if binary is None:
+                    sys.stderr.write('Hardware layout too large for the binary copy, the firmware will use the JSON\n')
+                    binary = b'\0' * hardware_layout.SLOT_SIZE
+                firmware_file.write(binary)
         except EnvironmentError:
             sys.stderr.write(f'Error opening file "{layout_file}"\n')
             exit(1)
     else:
         firmware_file.write(b'\0' * 2048)
+        firmware_file.write(b'\0' * hardware_layout.SLOT_SIZE)
+    # the logo always follows the binary layout slot, the firmware expects it at a fixed offset
     if config is not None and 'logo_file' in config:
         logo_file = f"hardware/logo/{config['logo_file']}"
         with open(logo_file, 'rb') as f:
@@ -63,6 +63,8 @@ def process_json_flag(define):
                 json_flags['airport-uart-baud'] = int(dequote(parts.group(2)))
     if define == "-DUNLOCK_HIGHER_POWER"  and not isRX:
         json_flags['unlock-higher-power'] = True
+    if define == "-DRATE_ADAPTATION"  and not isRX:
+        json_flags['rate-adapt'] = True
     if define == "-DLOCK_ON_FIRST_CONNECTION" and isRX:
         json_flags['lock-on-first-connection'] = True
 
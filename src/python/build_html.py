@@ -1,15 +1,14 @@
 Import("env")
 import os
 import re
-import io
 import tempfile
 import filecmp
 import shutil
-import gzip
 from external.minify import (html_minifier, rcssmin, rjsmin)
 from external.wheezy.template.engine import Engine
 from external.wheezy.template.ext.core import CoreExtension
 from external.wheezy.template.loader import FileLoader
+import web_assets
 
 
 def get_version(env):
@@ -18,16 +17,7 @@ def get_version(env):
 def build_version(out, env):
     out.write('const char *VERSION = "%s";\n\n' % get_version(env))
 
-def compress(data):
-    """Compress data in one shot and return the compressed string.
-    Optional argument is the compression level, in range of 0-9.
-    """
-    buf = io.BytesIO()
-    with gzip.GzipFile(fileobj=buf, mode='wb', compresslevel=9, mtime=0.0) as f:
-        f.write(data)
-    return buf.getvalue()
-
-def build_html(mainfile, var, out, env, isTX=False):
+def render(mainfile, env, isTX=False, etags={}):
     engine = Engine(
         loader=FileLoader(["html"]),
         extensions=[CoreExtension("@@")]
@@ -53,30 +43,60 @@ def build_html(mainfile, var, out, env, isTX=False):
             'is8285': is8285
         })
     if mainfile.endswith('.html'):
-        data = html_minifier.html_minify(data)
+        data = html_minifier.html_minify(web_assets.add_versions(data, etags))
     if mainfile.endswith('.css'):
         data = rcssmin.cssmin(data)
     if mainfile.endswith('.js'):
         data = rjsmin.jsmin(data)
+    return data.encode('utf-8')
+
+def write_array(out, var, data):
     out.write('static const char PROGMEM %s[] = {\n' % var)
-    out.write(','.join("0x{:02x}".format(c) for c in compress(data.encode('utf-8'))))
+    out.write(','.join("0x{:02x}".format(c) for c in data))
     out.write('\n};\n\n')
 
+def build_html(var, data, out, use_brotli):
+    write_array(out, var, web_assets.gzip_compress(data))
+    out.write('#define %s_ETAG "%s"\n\n' % (var, web_assets.etag(data)))
+    if use_brotli:
+        write_array(out, var + '_BR', web_assets.brotli_compress(data))
+
 def build_common(env, mainfile, isTX):
+    # Brotli copies take extra flash and browsers only ask for them over https, so they are opt-in
+    use_brotli = '-DWEB_BROTLI' in env['BUILD_FLAGS']
+    if use_brotli and web_assets.brotli is None:
+        print('WEB_BROTLI is set but the brotli module is not installed (pip install brotli), only gzip will be used')
+        use_brotli = False
+
+    # The scripts and stylesheets are built first so the pages can refer to them by version
+    assets = [
+        ("scan.js", "SCAN_JS", isTX),
+        ("mui.js", "MUI_JS", False),
+        ("elrs.css", "ELRS_CSS", False),
+        ("hardware.js", "HARDWARE_JS", False),
+        ("cw.js", "CW_JS", False),
+        ("lr1121.js", "LR1121_JS", False),
+    ]
+    pages = [
+        (mainfile, "INDEX_HTML", isTX),
+        ("hardware.html", "HARDWARE_HTML", isTX),
+        ("cw.html", "CW_HTML", False),
+        ("lr1121.html", "LR1121_HTML", False),
+    ]
+
     fd, path = tempfile.mkstemp()
     try:
         with os.fdopen(fd, 'w') as out:
             build_version(out, env)
-            build_html(mainfile, "INDEX_HTML", out, env, isTX)
-            build_html("scan.js", "SCAN_JS", out, env, isTX)
-            build_html("mui.js", "MUI_JS", out, env)
-            build_html("elrs.css", "ELRS_CSS", out, env)
-            build_html("hardware.html", "HARDWARE_HTML", out, env, isTX)
-            build_html("hardware.js", "HARDWARE_JS", out, env)
-            build_html("cw.html", "CW_HTML", out, env)
-            build_html("cw.js", "CW_JS", out, env)
-            build_html("lr1121.html", "LR1121_HTML", out, env)
-            build_html("lr1121.js", "LR1121_JS", out, env)
+            if use_brotli:
+                out.write('#define WEB_CONTENT_BROTLI 1\n\n')
+            etags = {}
+            for name, var, tx in assets:
+                data = render(name, env, tx)
+                etags[name] = web_assets.etag(data)
+                build_html(var, data, out, use_brotli)
+            for name, var, tx in pages:
+                build_html(var, render(name, env, tx, etags), out, use_brotli)
 
     finally:
         if not os.path.exists("include/WebContent.h") or not filecmp.cmp(path, "include/WebContent.h"):
@@ -0,0 +1,267 @@
+#!/usr/bin/env python3
+"""
+Create (or apply) a binary delta between two firmware images so an OTA update only has to send
+what changed relative to the firmware already running on the device.
+
+The patch format is documented in lib/DeltaUpdate/delta_patch.h. The device checks the MD5 of
+the running firmware before applying the patch and the MD5 of the result before switching to it,
+so the old image must be exactly the firmware.bin that was flashed on the device.
+
+    delta_patch.py old.bin new.bin firmware.delta
+    delta_patch.py --apply old.bin firmware.delta new.bin
+"""
+
+import argparse
+import gzip
+import hashlib
+import struct
+import sys
+
+MAGIC = b'ELRSDLT1'
+
+KEY_LEN = 16            # bytes hashed to find a match candidate
+INDEX_STEP = 4          # source positions indexed (firmware is mostly word aligned)
+MAX_CANDIDATES = 8      # candidates kept per key
+MIN_MATCH = 24          # shortest exact match worth an 'A' op
+WINDOW = 32             # approximate extension looks at the last WINDOW bytes...
+MAX_MISMATCH = 12       # ...and stops when more than this many differ
+MIN_SKIP = 3            # shorter runs of equal bytes are sent as zero diffs
+
+
+def load_image(filename):
+    """ Read a firmware image, unpacking ESP8266 compressed builds as they are stored unpacked """
+    with open(filename, 'rb') as f:
+        data = f.read()
+    if data[:2] == b'\x1f\x8b':
+        data = gzip.decompress(data)
+    return data
+
+
+def varint(value):
+    out = bytearray()
+    while True:
+        b = value & 0x7F
+        value >>= 7
+        if value:
+            out.append(b | 0x80)
+        else:
+            out.append(b)
+            return out
+
+
+def zigzag(value):
+    return (value << 1) if value >= 0 else ((-value << 1) - 1)
+
+
+def match_length(a, ai, b, bi):
+    """ Length of the exact match between a[ai:] and b[bi:] """
+    limit = min(len(a) - ai, len(b) - bi)
+    length = 0
+    step = 64
+    while length < limit:
+        n = min(step, limit - length)
+        if a[ai + length:ai + length + n] == b[bi + length:bi + length + n]:
+            length += n
+            step = min(step * 2, 4096)
+        else:
+            while a[ai + length] == b[bi + length]:
+                length += 1
+            break
+    return length
+
+
+def extend_match(src, s, tgt, t):
+    """
+    Extend an alignment past small differences (relocated addresses, changed constants),
+    returns the length up to the last matching byte before too many bytes differ
+    """
+    limit = min(len(src) - s, len(tgt) - t)
+    length = 0
+    best = 0
+    recent = []
+    mismatches = 0
+    while length < limit:
+        exact = match_length(src, s + length, tgt, t + length)
+        if exact:
+            length += exact
+            best = length
+            recent = []
+            mismatches = 0
+            continue
+        recent.append(length)
+        mismatches += 1
+        while recent and recent[0] <= length - WINDOW:
+            recent.pop(0)
+            mismatches -= 1
+        if mismatches > MAX_MISMATCH:
+            break
+        length += 1
+    return best
+
+
+def encode_add(src, s, tgt, t, length):
+    """ Sparse diff for an 'A' op: (skip, count, diff bytes) groups """
+    out = bytearray()
+    pos = 0
+    while pos < length:
+        skip = 0
+        while pos + skip < length and src[s + pos + skip] == tgt[t + pos + skip]:
+            skip += 1
+        pos += skip
+        count = 0
+        equal = 0
+        while pos + count + equal < length:
+            if src[s + pos + count + equal] == tgt[t + pos + count + equal]:
+                equal += 1
+                if equal >= MIN_SKIP:
+                    break
+            else:
+                count += equal + 1
+                equal = 0
+        out += varint(skip) + varint(count)
+        out += bytes((tgt[t + pos + i] - src[s + pos + i]) & 0xFF for i in range(count))
+        pos += count
+    return out
+
+
+def build_index(src):
+    index = {}
+    for i in range(0, len(src) - KEY_LEN + 1, INDEX_STEP):
+        candidates = index.setdefault(src[i:i + KEY_LEN], [])
+        if len(candidates) < MAX_CANDIDATES:
+            candidates.append(i)
+    return index
+
+
+def create_patch(src, tgt):
+    index = build_index(src)
+    ops = bytearray()
+    src_end = 0         # end of the previous 'A' op in the source
+    t = 0
+    literal = 0         # start of target bytes not covered by an op yet
+
+    def flush_literal(end):
+        if end > literal:
+            ops.extend(b'I' + varint(end - literal) + tgt[literal:end])
+
+    while t + KEY_LEN <= len(tgt):
+        best_len, best_src = 0, 0
+        candidates = list(index.get(tgt[t:t + KEY_LEN], ()))
+        # keep following the previous alignment if it still matches
+        follow = src_end + (t - literal)
+        if 0 <= follow < len(src):
+            candidates.insert(0, follow)
+        for s in candidates:
+            length = match_length(src, s, tgt, t)
+            if length > best_len:
+                best_len, best_src = length, s
+        if best_len < MIN_MATCH:
+            t += 1
+            continue
+
+        # grow backwards over literal bytes that still match
+        while t > literal and best_src > 0 and src[best_src - 1] == tgt[t - 1]:
+            t -= 1
+            best_src -= 1
+        length = extend_match(src, best_src, tgt, t)
+
+        flush_literal(t)
+        ops.extend(b'A' + varint(zigzag(best_src - src_end)) + varint(length))
+        ops.extend(encode_add(src, best_src, tgt, t, length))
+        src_end = best_src + length
+        t += length
+        literal = t
+
+    flush_literal(len(tgt))
+    ops.extend(b'E')
+
+    header = MAGIC
+    header += struct.pack('<I', len(src)) + hashlib.md5(src).digest()
+    header += struct.pack('<I', len(tgt)) + hashlib.md5(tgt).digest()
+    return header + bytes(ops)
+
+
+def read_varint(patch, pos):
+    value = 0
+    shift = 0
+    while True:
+        b = patch[pos]
+        pos += 1
+        value |= (b & 0x7F) << shift
+        shift += 7
+        if not b & 0x80:
+            return value, pos
+
+
+def apply_patch(src, patch):
+    """ Reference implementation of the device side, used to verify new patches """
+    if patch[:len(MAGIC)] != MAGIC:
+        raise ValueError('Not a delta patch')
+    pos = len(MAGIC)
+    src_size, = struct.unpack_from('<I', patch, pos)
+    src_md5 = patch[pos + 4:pos + 20]
+    tgt_size, = struct.unpack_from('<I', patch, pos + 20)
+    tgt_md5 = patch[pos + 24:pos + 40]
+    pos += 40
+    if src_size > len(src) or hashlib.md5(src[:src_size]).digest() != src_md5:
+        raise ValueError('Patch was made for a different source image')
+
+    out = bytearray()
+    src_pos = 0
+    while True:
+        op = patch[pos:pos + 1]
+        pos += 1
+        if op == b'A':
+            offset, pos = read_varint(patch, pos)
+            src_pos += (offset >> 1) ^ -(offset & 1)
+            length, pos = read_varint(patch, pos)
+            while length:
+                skip, pos = read_varint(patch, pos)
+                count, pos = read_varint(patch, pos)
+                out += src[src_pos:src_pos + skip]
+                src_pos += skip
+                out += bytes((src[src_pos + i] + patch[pos + i]) & 0xFF for i in range(count))
+                src_pos += count
+                pos += count
+                length -= skip + count
+        elif op == b'I':
+            length, pos = read_varint(patch, pos)
+            out += patch[pos:pos + length]
+            pos += length
+        elif op == b'E':
+            break
+        else:
+            raise ValueError('Invalid op at %d' % (pos - 1))
+
+    if len(out) != tgt_size or hashlib.md5(out).digest() != tgt_md5:
+        raise ValueError('Patched image failed verification')
+    return bytes(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Create a delta patch for OTA updates against the running firmware")
+    parser.add_argument('--apply', action='store_true', help="apply PATCH to OLD and write NEW instead of creating a patch")
+    parser.add_argument('old', help="firmware currently on the device")
+    parser.add_argument('files', nargs=2, metavar='FILE', help="NEW PATCH, or PATCH NEW with --apply")
+    args = parser.parse_args()
+
+    src = load_image(args.old)
+    if args.apply:
+        with open(args.files[0], 'rb') as f:
+            out = apply_patch(src, f.read())
+        with open(args.files[1], 'wb') as f:
+            f.write(out)
+        return
+
+    tgt = load_image(args.files[0])
+    patch = create_patch(src, tgt)
+    # never hand out a patch the device would reject
+    if apply_patch(src, patch) != tgt:
+        sys.exit('Patch verification failed')
+    with open(args.files[1], 'wb') as f:
+        f.write(patch)
+    print('Delta patch: %d bytes, %.1f%% of %d' % (len(patch), 100.0 * len(patch) / len(tgt), len(tgt)))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,167 @@
+"""
+Binary copy of the hardware layout, loaded by the firmware without parsing the JSON.
+See lib/OPTIONS/HardwareLayout.h for the format.
+"""
+
+import struct
+import zlib
+
+MAGIC = 0x57484C45  # "ELHW"
+VERSION = 1
+SLOT_SIZE = 1024    # ELRSOPTS_LAYOUT_SIZE
+
+INT, BOOL, FLOAT, ARRAY, COUNT = range(5)
+
+# Must be kept in the same order as fields[] in lib/OPTIONS/hardware.cpp, the firmware ignores
+# the binary layout if the schema does not match and uses the JSON instead
+FIELDS = [
+    ('serial_rx', INT),
+    ('serial_tx', INT),
+    ('serial1_rx', INT),
+    ('serial1_tx', INT),
+    ('radio_busy', INT),
+    ('radio_busy_2', INT),
+    ('radio_dio0', INT),
+    ('radio_dio0_2', INT),
+    ('radio_dio1', INT),
+    ('radio_dio1_2', INT),
+    ('radio_miso', INT),
+    ('radio_mosi', INT),
+    ('radio_nss', INT),
+    ('radio_nss_2', INT),
+    ('radio_rst', INT),
+    ('radio_rst_2', INT),
+    ('radio_sck', INT),
+    ('radio_dcdc', BOOL),
+    ('radio_rfo_hf', BOOL),
+    ('radio_rfsw_ctrl', ARRAY),
+    ('radio_rfsw_ctrl', COUNT),
+    ('ant_ctrl', INT),
+    ('ant_ctrl_compl', INT),
+    ('power_enable', INT),
+    ('power_apc2', INT),
+    ('power_rxen', INT),
+    ('power_txen', INT),
+    ('power_rxen_2', INT),
+    ('power_txen_2', INT),
+    ('power_lna_gain', INT),
+    ('power_min', INT),
+    ('power_high', INT),
+    ('power_max', INT),
+    ('power_default', INT),
+    ('power_pdet', INT),
+    ('power_pdet_intercept', FLOAT),
+    ('power_pdet_slope', FLOAT),
+    ('power_control', INT),
+    ('power_values', ARRAY),
+    ('power_values', COUNT),
+    ('power_values2', ARRAY),
+    ('power_values_dual', ARRAY),
+    ('power_values_dual', COUNT),
+    ('joystick', INT),
+    ('joystick_values', ARRAY),
+    ('five_way1', INT),
+    ('five_way2', INT),
+    ('five_way3', INT),
+    ('button', INT),
+    ('button_led_index', INT),
+    ('button2', INT),
+    ('button2_led_index', INT),
+    ('led', INT),
+    ('led_blue', INT),
+    ('led_blue_invert', BOOL),
+    ('led_green', INT),
+    ('led_green_invert', BOOL),
+    ('led_green_red', INT),
+    ('led_red', INT),
+    ('led_red_invert', BOOL),
+    ('led_red_green', INT),
+    ('led_rgb', INT),
+    ('led_rgb_isgrb', BOOL),
+    ('ledidx_rgb_status', ARRAY),
+    ('ledidx_rgb_status', COUNT),
+    ('ledidx_rgb_vtx', ARRAY),
+    ('ledidx_rgb_vtx', COUNT),
+    ('ledidx_rgb_boot', ARRAY),
+    ('ledidx_rgb_boot', COUNT),
+    ('screen_cs', INT),
+    ('screen_dc', INT),
+    ('screen_mosi', INT),
+    ('screen_rst', INT),
+    ('screen_sck', INT),
+    ('screen_sda', INT),
+    ('screen_type', INT),
+    ('screen_reversed', BOOL),
+    ('screen_bl', INT),
+    ('use_backpack', BOOL),
+    ('debug_backpack_baud', INT),
+    ('debug_backpack_rx', INT),
+    ('debug_backpack_tx', INT),
+    ('backpack_boot', INT),
+    ('backpack_en', INT),
+    ('passthrough_baud', INT),
+    ('i2c_scl', INT),
+    ('i2c_sda', INT),
+    ('misc_gsensor_int', INT),
+    ('misc_buzzer', INT),
+    ('misc_fan_en', INT),
+    ('misc_fan_pwm', INT),
+    ('misc_fan_tacho', INT),
+    ('misc_fan_speeds', ARRAY),
+    ('misc_fan_speeds', COUNT),
+    ('gsensor_stk8xxx', BOOL),
+    ('thermal_lm75a', BOOL),
+    ('pwm_outputs', ARRAY),
+    ('pwm_outputs', COUNT),
+    ('vbat', INT),
+    ('vbat_offset', INT),
+    ('vbat_scale', INT),
+    ('vbat_atten', INT),
+    ('vtx_amp_pwm', INT),
+    ('vtx_amp_vpd', INT),
+    ('vtx_amp_vref', INT),
+    ('vtx_nss', INT),
+    ('vtx_miso', INT),
+    ('vtx_mosi', INT),
+    ('vtx_sck', INT),
+    ('vtx_amp_vpd_25mW', ARRAY),
+    ('vtx_amp_vpd_100mW', ARRAY),
+    ('vtx_amp_pwm_25mW', ARRAY),
+    ('vtx_amp_pwm_100mW', ARRAY),
+]
+
+
+def schema():
+    crc = 0
+    for name, type in FIELDS:
+        crc = zlib.crc32(name.encode() + b'\0' + bytes([type]), crc)
+    return crc
+
+
+def encode(hardware):
+    """ Encode the hardware dict, returns None if it does not fit in the slot """
+    values = bytearray()
+    pool = []
+    for name, type in FIELDS:
+        value = hardware.get(name)
+        if type == INT:
+            values += struct.pack('<i', -1 if value is None else int(value))
+        elif type == BOOL:
+            values += struct.pack('<i', 1 if value else 0)
+        elif type == FLOAT:
+            values += struct.pack('<f', 0.0 if value is None else float(value))
+        elif type == ARRAY:
+            if value is None:
+                values += struct.pack('<i', -1)
+            else:
+                values += struct.pack('<i', len(pool))
+                pool.extend(int(v) for v in value)
+        elif type == COUNT:
+            values += struct.pack('<i', 0 if value is None else len(value))
+
+    payload = bytes(values) + struct.pack('<%dh' % len(pool), *pool)
+    header = struct.pack('<IBBHII', MAGIC, VERSION, len(FIELDS), len(pool), schema(), zlib.crc32(payload))
+    layout = header + payload
+    if len(layout) > SLOT_SIZE:
+        return None
+    return layout + b'\0' * (SLOT_SIZE - len(layout))
@@ -8,12 +8,17 @@ open http://localhost:8080/
 add the following query params for TX and/or 900Mhz testing
     isTX
     hasSubGHz
+
+The pages and assets are served compressed with ETags and Cache-Control like the
+firmware does, http://localhost:8080/cache-stats shows the number of requests, how
+many were answered with 304 Not Modified and the bytes sent (add ?reset to clear it).
 """
 
 from external.bottle import route, run, response, request
 from external.wheezy.template.engine import Engine
 from external.wheezy.template.ext.core import CoreExtension
 from external.wheezy.template.loader import FileLoader
+import web_assets
 
 net_counter = 0
 isTX = False
@@ -21,6 +26,8 @@ hasSubGHz = False
 is8285 = True
 chip = 'LR1121'
 
+cache_stats = {'requests': 0, 'not-modified': 0, 'bytes': 0}
+
 config = {
         "options": {
             "uid": [1,2,3,4,5,6],   # this is the 'flashed' UID and may be empty if using traditional binding on an RX.
@@ -29,6 +36,7 @@ config = {
             "no-sync-on-arm": False,
             "uart-inverted": True,
             "unlock-higher-power": False,
+            "rate-adapt": False,
             "is-airport": True,
             "rcvr-uart-baud": 400000,
             "rcvr-invert-tx": False,
@@ -135,6 +143,45 @@ def apply_template(mainfile):
         })
     return data
 
+def send_content(mainfile, content_type):
+    data = apply_template(mainfile)
+    if mainfile.endswith('.html'):
+        etags = {name: web_assets.etag(apply_template(name).encode('utf-8')) for name in web_assets.VERSIONED_ASSETS}
+        data = web_assets.add_versions(data, etags)
+    data = data.encode('utf-8')
+    tag = web_assets.etag(data)
+
+    response.content_type = content_type
+    response.set_header('ETag', '"%s"' % tag)
+    response.set_header('Vary', 'Accept-Encoding')
+    if request.query.get('v') == tag:
+        response.set_header('Cache-Control', web_assets.CACHE_IMMUTABLE)
+    else:
+        response.set_header('Cache-Control', web_assets.CACHE_REVALIDATE)
+
+    cache_stats['requests'] += 1
+    if web_assets.is_not_modified(request.get_header('If-None-Match'), tag):
+        cache_stats['not-modified'] += 1
+        response.status = 304
+        return b''
+    body = None
+    if web_assets.accepts_brotli(request.get_header('Accept-Encoding')):
+        body = web_assets.brotli_compress(data)
+        response.set_header('Content-Encoding', 'br')
+    if body is None:
+        body = web_assets.gzip_compress(data)
+        response.set_header('Content-Encoding', 'gzip')
+    cache_stats['bytes'] += len(body)
+    return body
+
+@route('/cache-stats')
+def get_cache_stats():
+    stats = dict(cache_stats)
+    if 'reset' in request.query:
+        for key in cache_stats:
+            cache_stats[key] = 0
+    return stats
+
 @route('/')
 def index():
     global net_counter, isTX, hasSubGHz, chip, is8285
@@ -143,46 +190,38 @@ def index():
     hasSubGHz = 'hasSubGHz' in request.query
     if 'chip' in request.query:
         chip = request.query['chip']
-    response.content_type = 'text/html; charset=latin9'
-    return apply_template('index.html')
+    return send_content('index.html', 'text/html; charset=latin9')
 
 @route('/elrs.css')
 def elrs():
-    response.content_type = 'text/css; charset=latin9'
-    return apply_template('elrs.css')
+    return send_content('elrs.css', 'text/css; charset=latin9')
 
 @route('/scan.js')
 def scan():
-    response.content_type = 'text/javascript; charset=latin9'
-    return apply_template('scan.js')
+    return send_content('scan.js', 'text/javascript; charset=latin9')
 
 @route('/mui.js')
 def mui():
-    response.content_type = 'text/javascript; charset=latin9'
-    return apply_template('mui.js')
+    return send_content('mui.js', 'text/javascript; charset=latin9')
 
 @route('/hardware.html')
 def hardware_html():
-    response.content_type = 'text/html; charset=latin9'
-    return apply_template('hardware.html')
+    return send_content('hardware.html', 'text/html; charset=latin9')
 
 @route('/hardware.js')
 def hardware_js():
-    response.content_type = 'text/javascript; charset=latin9'
-    return apply_template('hardware.js')
+    return send_content('hardware.js', 'text/javascript; charset=latin9')
 
 @route('/cw.html')
 def cw_html():
     global chip
     if 'chip' in request.query:
         chip = request.query['chip']
-    response.content_type = 'text/html; charset=latin9'
-    return apply_template('cw.html')
+    return send_content('cw.html', 'text/html; charset=latin9')
 
 @route('/cw.js')
 def cw_js():
-    response.content_type = 'text/javascript; charset=latin9'
-    return apply_template('cw.js')
+    return send_content('cw.js', 'text/javascript; charset=latin9')
 
 @route('/cw')
 def cw():
@@ -191,13 +230,11 @@ def cw():
 
 @route('/lr1121.html')
 def lr1121_html():
-    response.content_type = 'text/html; charset=latin9'
-    return apply_template('lr1121.html')
+    return send_content('lr1121.html', 'text/html; charset=latin9')
 
 @route('/lr1121.js')
 def lr1121_js():
-    response.content_type = 'text/javascript; charset=latin9'
-    return apply_template('lr1121.js')
+    return send_content('lr1121.js', 'text/javascript; charset=latin9')
 
 @route('/lr1121.json')
 def lr1121_json():
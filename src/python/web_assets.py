@@ -0,0 +1,72 @@
+"""
+Compression and cache validation for the web UI assets, shared by the firmware
+build (build_html.py) and the test server (serve_html.py)
+
+Every asset gets a strong ETag from the hash of its content. The pages refer to the
+scripts and stylesheets as e.g. "mui.js?v=<etag>", so a browser can keep those for
+good and only the page itself has to be revalidated (If-None-Match -> 304).
+"""
+
+import gzip
+import hashlib
+import io
+import re
+
+try:
+    import brotli
+except ImportError:
+    brotli = None
+
+# Assets referenced from the pages, these get the version added to their URL
+VERSIONED_ASSETS = ['elrs.css', 'mui.js', 'scan.js', 'hardware.js', 'cw.js', 'lr1121.js']
+
+CACHE_IMMUTABLE = 'public, max-age=31536000, immutable'
+CACHE_REVALIDATE = 'no-cache'
+
+# "0" or "1" with up to 3 decimals (RFC 9110)
+QVALUE = re.compile(r'0(\.[0-9]{0,3})?|1(\.0{0,3})?')
+
+def gzip_compress(data):
+    buf = io.BytesIO()
+    with gzip.GzipFile(fileobj=buf, mode='wb', compresslevel=9, mtime=0.0) as f:
+        f.write(data)
+    return buf.getvalue()
+
+def brotli_compress(data):
+    """Returns None if the brotli module is not installed"""
+    if brotli is None:
+        return None
+    return brotli.compress(data, mode=brotli.MODE_TEXT, quality=11)
+
+def etag(data):
+    return hashlib.sha256(data).hexdigest()[:16]
+
+def add_versions(page, etags):
+    """Add ?v=<etag> to the src/href of each asset in etags"""
+    def versioned(match):
+        name = match.group(2)
+        return '%s="%s?v=%s"' % (match.group(1), name, etags[name])
+    names = '|'.join(re.escape(name) for name in etags)
+    return re.sub(r'(src|href)="(%s)"' % names, versioned, page)
+
+def accepts_brotli(accept_encoding):
+    """True if the Accept-Encoding header allows br (browsers only offer it over https)
+
+    br has to be listed by name (case insensitive) with no qvalue or one over 0, a malformed
+    qvalue does not accept it. The first br listed counts, "*" is not looked at. This is what
+    acceptsBrotli() in lib/AcceptEncoding does on the device, keep the two in step.
+    """
+    for coding in (accept_encoding or '').split(','):
+        parts = coding.split(';')
+        if parts[0].strip(' \t').lower() != 'br':
+            continue
+        for param in parts[1:]:
+            name, equals, value = param.partition('=')
+            if equals and name.strip(' \t').lower() == 'q':
+                value = value.strip(' \t')
+                return QVALUE.fullmatch(value) is not None and float(value) > 0
+        return True
+    return False
+
+def is_not_modified(if_none_match, tag):
+    return if_none_match is not None and ('"%s"' % tag in if_none_match or if_none_match.strip() == '*')
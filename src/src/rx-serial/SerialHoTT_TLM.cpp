@@ -17,6 +17,9 @@
 
 #define DISCOVERY_TIMEOUT 30000 // 30s device discovery time
 
+#define HOTT_MAX_MISSED_POLLS 3 // detected devices not answering this many polls
+#define HOTT_STALE_POLL_CYCLES 8 // are only polled every n-th pass over the device list
+
 #define VARIO_MIN_CRSFRATE 1000 // CRSF telemetry packets will be sent if
 #define GPS_MIN_CRSFRATE 5000   // min rate timers in [ms] have expired
 #define BATT_MIN_CRSFRATE 5000  // or packet value has changed. Fastest to
@@ -31,6 +34,18 @@
 
 extern Telemetry telemetry;
 
+// Minimum CRSF send rate of each frame, indexed by hottCrsfFrame_e
+static const uint16_t crsfMinRate[HOTT_CRSF_FRAME_COUNT] = {
+    VARIO_MIN_CRSFRATE,
+    GPS_MIN_CRSFRATE,
+    BATT_MIN_CRSFRATE,
+    RPM_MIN_CRSFRATE,
+    TEMP_MIN_CRSFRATE,
+    CELLS_MIN_CRSFRATE,
+    VOLT_MIN_CRSFRATE,
+    AIRSPEED_MIN_CRSFRATE,
+};
+
 SerialHoTT_TLM::SerialHoTT_TLM(Stream &out, Stream &in, const int8_t serial1TXpin)
     : SerialIO(&out, &in)
 {
@@ -57,6 +72,7 @@ SerialHoTT_TLM::SerialHoTT_TLM(Stream &out, Stream &in, const int8_t serial1TXpi
     discoveryTimerStart = now;
 
     cmdSendState = HOTT_RECEIVING;
+    polledDevice = NOT_FOUND;
 }
 
 int SerialHoTT_TLM::getMaxSerialReadSize()
@@ -135,6 +151,13 @@ void SerialHoTT_TLM::scheduleDevicePolling(uint32_t now)
     {
         lastPoll = now;
 
+        // the previously polled device did not answer
+        if (polledDevice != NOT_FOUND && device[polledDevice].missedPolls < UINT8_MAX)
+        {
+            device[polledDevice].missedPolls++;
+        }
+        polledDevice = NOT_FOUND;
+
         // work out next device to be polled. All devices in discovery
         // mode, only detected devices in non-discovery mode)  
         nextDeviceID = NOT_FOUND;
@@ -144,11 +167,13 @@ void SerialHoTT_TLM::scheduleDevicePolling(uint32_t now)
             if (nextDevice == LAST_DEVICE)
             {
                 nextDevice = FIRST_DEVICE;
+                pollCycle++;
             }
 
-            if (device[nextDevice].present || discoveryMode)
+            if (shouldPoll(nextDevice))
             {
                 nextDeviceID = device[nextDevice].deviceID;
+                polledDevice = nextDevice;
 
                 nextDevice++;
                 
@@ -191,583 +216,105 @@ void SerialHoTT_TLM::scheduleDevicePolling(uint32_t now)
     }
 }
 
-void SerialHoTT_TLM::processFrame()
+bool SerialHoTT_TLM::shouldPoll(uint8_t deviceIdx)
 {
-    void *frameData = (void *)&hottBusFrame.payload;
-
-    // store received frame
-    switch (hottBusFrame.payload[DEVICE_INDEX])
+    if (discoveryMode)
     {
-    case SENSOR_ID_GPS_B:
-        device[GPS].present = true;
-        memcpy((void *)&gps, frameData, sizeof(gps));
-        break;
-
-    case SENSOR_ID_EAM_B:
-        device[EAM].present = true;
-        memcpy((void *)&eam, frameData, sizeof(eam));
-        break;
-
-    case SENSOR_ID_GAM_B:
-        device[GAM].present = true;
-        memcpy((void *)&gam, frameData, sizeof(gam));
-        break;
-
-    case SENSOR_ID_VARIO_B:
-        device[VARIO].present = true;
-        memcpy((void *)&vario, frameData, sizeof(vario));
-        break;
-
-    case SENSOR_ID_ESC_B:
-        device[ESC].present = true;
-        memcpy((void *)&esc, frameData, sizeof(esc));
-        break;
+        return true;
     }
-}
 
-uint8_t SerialHoTT_TLM::calcFrameCRC(uint8_t *buf)
-{
-    uint16_t sum = 0;
-
-    for (uint8_t i = 0; i < FRAME_SIZE - 1; i++)
+    if (!device[deviceIdx].present)
     {
-        sum += buf[i];
+        return false;
     }
 
-    return sum = sum & 0xff;
+    // a detected device that stopped answering costs a whole poll slot each time,
+    // keep checking for it now and then but give the slots to the answering devices
+    return device[deviceIdx].missedPolls < HOTT_MAX_MISSED_POLLS || pollCycle % HOTT_STALE_POLL_CYCLES == 0;
 }
 
-void SerialHoTT_TLM::scheduleCRSFtelemetry(uint32_t now)
+void SerialHoTT_TLM::processFrame()
 {
-    // HoTT stand alone Vario or GPS/Vario or EAM or GAM -> send vario packet
-    if (device[VARIO].present || device[GPS].present || device[GAM].present || device[EAM].present)
-    {
-        sendCRSFvario(now);
-    }
-
-    // HoTT combined GPS/Vario -> send GPS packet
-    if (device[GPS].present)
-    {
-        sendCRSFgps(now);
-    }
+    uint8_t deviceIdx = NOT_FOUND;
 
-    // HoTT GAM, EAM, ESC -> send battery, Rpm, Temp, Cells, Volt, Airspee packet
-    if (device[GAM].present || device[EAM].present || device[ESC].present)
+    for (uint8_t i = FIRST_DEVICE; i < LAST_DEVICE; i++)
     {
-        sendCRSFbattery(now);
-
-        HoTTDevices deviceToUse = GAM;
-
-        if (device[EAM].present)
+        if (device[i].deviceID == hottBusFrame.payload[DEVICE_INDEX])
         {
-            deviceToUse = EAM;
+            deviceIdx = i;
+            break;
         }
-        else if (device[ESC].present)
-        {
-            deviceToUse = ESC;
-        }
-
-        sendCRSFrpm(now, deviceToUse);
-        sendCRSFtemp(now, deviceToUse);
-        sendCRSFcells(now, deviceToUse);
-        sendCRSFvolt(now, deviceToUse);
-        sendCRSFairspeed(now, deviceToUse);
-    }
-}
-
-void SerialHoTT_TLM::sendCRSFvario(uint32_t now)
-{
-    // indicate external sensor is present
-    telemetry.SetCrsfBaroSensorDetected();
-
-    // prepare CRSF telemetry packet
-    CRSF_MK_FRAME_T(crsf_sensor_baro_vario_t) crsfBaro = {0};
-    crsfBaro.p.altitude = htobe16(getHoTTaltitude() * 10 + 5000); // Hott 500 = 0m, ELRS 10000 = 0.0m
-    crsfBaro.p.verticalspd = htobe16(getHoTTvv() - HOTT_VSPD_OFFSET);
-    crsfRouter.SetHeaderAndCrc((crsf_header_t *)&crsfBaro, CRSF_FRAMETYPE_BARO_ALTITUDE, CRSF_FRAME_SIZE(sizeof(crsf_sensor_baro_vario_t)), CRSF_ADDRESS_RADIO_TRANSMITTER);
-
-    // send packet only if min rate timer expired or values have changed
-    if ((now - lastVarioSent >= VARIO_MIN_CRSFRATE) || (lastVarioCRC != crsfBaro.crc))
-    {
-        lastVarioSent = now;
-        crsfRouter.deliverMessage(nullptr, &crsfBaro.h);
-    }
-
-    lastVarioCRC = crsfBaro.crc;
-}
-
-void SerialHoTT_TLM::sendCRSFgps(uint32_t now)
-{
-    // prepare CRSF telemetry packet
-    CRSF_MK_FRAME_T(crsf_sensor_gps_t) crsfGPS = {0};
-    crsfGPS.p.latitude = htobe32(getHoTTlatitude());
-    crsfGPS.p.longitude = htobe32(getHoTTlongitude());
-    crsfGPS.p.groundspeed = htobe16(getHoTTgroundspeed() * 10); // Hott 1 = 1 km/h, ELRS 1 = 0.1km/h
-    crsfGPS.p.gps_heading = htobe16(getHoTTheading() * 100);
-    crsfGPS.p.altitude = htobe16(getHoTTMSLaltitude() + 1000); // HoTT 1 = 1m, CRSF: 0m = 1000
-    crsfGPS.p.satellites_in_use = getHoTTsatellites();
-    crsfRouter.SetHeaderAndCrc((crsf_header_t *)&crsfGPS, CRSF_FRAMETYPE_GPS, CRSF_FRAME_SIZE(sizeof(crsf_sensor_gps_t)), CRSF_ADDRESS_RADIO_TRANSMITTER);
-
-    // send packet only if min rate timer expired or values have changed
-    if ((now - lastGPSSent >= GPS_MIN_CRSFRATE) || (lastGPSCRC != crsfGPS.crc))
-    {
-        lastGPSSent = now;
-        crsfRouter.deliverMessage(nullptr, &crsfGPS.h);
-    }
-
-    lastGPSCRC = crsfGPS.crc;
-}
-
-void SerialHoTT_TLM::sendCRSFbattery(uint32_t now)
-{
-    // indicate external sensor is present
-    telemetry.SetCrsfBatterySensorDetected();
-
-    // prepare CRSF telemetry packet
-    CRSF_MK_FRAME_T(crsf_sensor_battery_t) crsfBatt = {0};
-    crsfBatt.p.voltage = htobe16(getHoTTvoltage());
-    crsfBatt.p.current = htobe16(getHoTTcurrent());
-    crsfBatt.p.capacity = htobe24(getHoTTcapacity() * 10); // HoTT: 1 = 10mAh, CRSF: 1 ? 1 = 1mAh
-    crsfBatt.p.remaining = getHoTTremaining();
-    crsfRouter.SetHeaderAndCrc((crsf_header_t *)&crsfBatt, CRSF_FRAMETYPE_BATTERY_SENSOR, CRSF_FRAME_SIZE(sizeof(crsf_sensor_battery_t)), CRSF_ADDRESS_RADIO_TRANSMITTER);
-
-    // send packet only if min rate timer expired or values have changed
-    if ((now - lastBatterySent >= BATT_MIN_CRSFRATE) || (lastBatteryCRC != crsfBatt.crc))
-    {
-        lastBatterySent = now;
-        crsfRouter.deliverMessage(nullptr, &crsfBatt.h);
     }
 
-    lastBatteryCRC = crsfBatt.crc;
-}
-
-void SerialHoTT_TLM::sendCRSFrpm(uint32_t now, HoTTDevices device)
-{
-    // prepare CRSF telemetry packet
-    CRSF_MK_FRAME_T(crsf_sensor_rpm_t) crsfRpm = {0};
-
-    crsfRpm.p.source_id = device;
-
-    uint8_t payloadSize = 1 + 2 * 3;
-
-    if (device == EAM)
-    {
-        crsfRpm.p.rpm0 = htobe24(eam.rpm * HOTT_RPM_SCALE);
-
-        payloadSize = 1 + 3;
-    }
-    else if (device == GAM)
-    {
-        crsfRpm.p.rpm0 = htobe24(gam.rpm1 * HOTT_RPM_SCALE);
-        crsfRpm.p.rpm1 = htobe24(gam.rpm2 * HOTT_RPM_SCALE);
-    }
-    else if (device == ESC)
-    {
-        crsfRpm.p.rpm0 = htobe24(esc.rpm * HOTT_RPM_SCALE);
-        crsfRpm.p.rpm1 = htobe24(esc.rpmMax * HOTT_RPM_SCALE);
-    }
-
-    crsfRouter.SetHeaderAndCrc((crsf_header_t *)&crsfRpm, CRSF_FRAMETYPE_RPM, CRSF_FRAME_SIZE(payloadSize), CRSF_ADDRESS_RADIO_TRANSMITTER);
-
-    uint8_t crc = ((uint8_t *)&crsfRpm.p)[payloadSize];
-
-    // send packet only if min rate timer expired or values have changed
-    if ((now - lastRpmSent >= RPM_MIN_CRSFRATE) || (lastRpmCRC != crc))
+    if (deviceIdx == NOT_FOUND)
     {
-        lastRpmSent = now;
-
-        crsfRouter.deliverMessage(nullptr, &crsfRpm.h);
-    }
-
-    lastRpmCRC = crc;
-}
-
-void SerialHoTT_TLM::sendCRSFtemp(uint32_t now, HoTTDevices device)
-{
-    // prepare CRSF telemetry packet
-    CRSF_MK_FRAME_T(crsf_sensor_temp_t) crsfTemp = {0};
-
-    crsfTemp.p.source_id = device;
-
-    uint8_t payloadSize = 1 + 2 * 2;
-
-    if (device == EAM)
-    {
-        crsfTemp.p.temperature[0] = htobe16((eam.temp1 - HOTT_TEMP_OFFSET) * HOTT_TEMP_SCALE);  
-        crsfTemp.p.temperature[1] = htobe16((eam.temp2 - HOTT_TEMP_OFFSET) * HOTT_TEMP_SCALE);  
-    }
-    else if (device == GAM)
-    {
-        crsfTemp.p.temperature[0] = htobe16((gam.temperature1 - HOTT_TEMP_OFFSET) * HOTT_TEMP_SCALE);
-        crsfTemp.p.temperature[1] = htobe16((gam.temperature2 - HOTT_TEMP_OFFSET) * HOTT_TEMP_SCALE);
-    }
-    else if (device == ESC)
-    {
-        crsfTemp.p.temperature[0] = htobe16((esc.escTemp - HOTT_TEMP_OFFSET) * HOTT_TEMP_SCALE);
-        crsfTemp.p.temperature[1] = htobe16((esc.becTemp - HOTT_TEMP_OFFSET) * HOTT_TEMP_SCALE);
-        crsfTemp.p.temperature[2] = htobe16((esc.motorTemp - HOTT_TEMP_OFFSET) * HOTT_TEMP_SCALE);
-        crsfTemp.p.temperature[3] = htobe16((esc.pumpTemp - HOTT_TEMP_OFFSET) * HOTT_TEMP_SCALE);
-        crsfTemp.p.temperature[4] = htobe16((esc.auxTemp - HOTT_TEMP_OFFSET) * HOTT_TEMP_SCALE);
-
-        payloadSize = 1 + 2 * 5;
-    }
-
-    crsfRouter.SetHeaderAndCrc((crsf_header_t *)&crsfTemp, CRSF_FRAMETYPE_TEMP, CRSF_FRAME_SIZE(payloadSize), CRSF_ADDRESS_RADIO_TRANSMITTER);
-
-    uint8_t crc = ((uint8_t *)&crsfTemp.p)[payloadSize];
-
-    // send packet only if min rate timer expired or values have changed
-    if ((now - lastTempSent >= TEMP_MIN_CRSFRATE) || (lastTempCRC != crc))
-    {
-        lastTempSent = now;
-
-        crsfRouter.deliverMessage(nullptr, &crsfTemp.h);
-    }
-
-    lastTempCRC = crc;
-}
-
-void SerialHoTT_TLM::sendCRSFcells(uint32_t now, HoTTDevices device)
-{
-    if (device == ESC)
         return;
-
-    // prepare CRSF telemetry packet
-    CRSF_MK_FRAME_T(crsf_sensor_cells_t) crsfCells = {0};
-
-    crsfCells.p.source_id = device;
-
-    uint8_t payloadSize = 1 + 14 * 2;
-
-    if (device == EAM)
-    {
-        crsfCells.p.cell[0] = htobe16(eam.cellL[0] * HOTT_CELL_SCALE);
-        crsfCells.p.cell[1] = htobe16(eam.cellL[1] * HOTT_CELL_SCALE);
-        crsfCells.p.cell[2] = htobe16(eam.cellL[2] * HOTT_CELL_SCALE);
-        crsfCells.p.cell[3] = htobe16(eam.cellL[3] * HOTT_CELL_SCALE);
-        crsfCells.p.cell[4] = htobe16(eam.cellL[4] * HOTT_CELL_SCALE);
-        crsfCells.p.cell[4] = htobe16(eam.cellL[5] * HOTT_CELL_SCALE);
-        crsfCells.p.cell[6] = htobe16(eam.cellL[6] * HOTT_CELL_SCALE);
-
-        crsfCells.p.cell[7] = htobe16(eam.cellH[0] * HOTT_CELL_SCALE);
-        crsfCells.p.cell[8] = htobe16(eam.cellH[1] * HOTT_CELL_SCALE);
-        crsfCells.p.cell[9] = htobe16(eam.cellH[2] * HOTT_CELL_SCALE);
-        crsfCells.p.cell[10] = htobe16(eam.cellH[3] * HOTT_CELL_SCALE);
-        crsfCells.p.cell[11] = htobe16(eam.cellH[4] * HOTT_CELL_SCALE);
-        crsfCells.p.cell[12] = htobe16(eam.cellH[5] * HOTT_CELL_SCALE);
-        crsfCells.p.cell[13] = htobe16(eam.cellH[6] * HOTT_CELL_SCALE);
     }
-    else if (device == GAM)
-    {
-        crsfCells.p.cell[0] = htobe16(gam.voltageCell1 * HOTT_CELL_SCALE);
-        crsfCells.p.cell[1] = htobe16(gam.voltageCell2 * HOTT_CELL_SCALE);
-        crsfCells.p.cell[2] = htobe16(gam.voltageCell3 * HOTT_CELL_SCALE);
-        crsfCells.p.cell[3] = htobe16(gam.voltageCell4 * HOTT_CELL_SCALE);
-        crsfCells.p.cell[4] = htobe16(gam.voltageCell5 * HOTT_CELL_SCALE);
-        crsfCells.p.cell[5] = htobe16(gam.voltageCell6 * HOTT_CELL_SCALE);
-
-        payloadSize = 1 + 6 * 2;
-    }
-
-    crsfRouter.SetHeaderAndCrc((crsf_header_t *)&crsfCells, CRSF_FRAMETYPE_CELLS, CRSF_FRAME_SIZE(payloadSize), CRSF_ADDRESS_RADIO_TRANSMITTER);
-
-    uint8_t crc = ((uint8_t *)&crsfCells.p)[payloadSize];
-
-    // send packet only if min rate timer expired or values have changed
-    if ((now - lastCellsSent >= CELLS_MIN_CRSFRATE) || (lastCellsCRC != crc))
-    {
-        lastCellsSent = now;
-
-        crsfRouter.deliverMessage(nullptr, &crsfCells.h);
-    }
-
-    lastCellsCRC = crc;
-}
-
-void SerialHoTT_TLM::sendCRSFvolt(uint32_t now, HoTTDevices device)
-{
-    // prepare CRSF telemetry packet
-    CRSF_MK_FRAME_T(crsf_sensor_cells_t) crsfVolt = {0};
-
-    crsfVolt.p.source_id = 128 + device;
-
-    uint8_t payloadSize = 1 + 2 * 3;
-
-    if (device == EAM)
-    {
-        crsfVolt.p.cell[0] = htobe16(eam.battVoltage1 * HOTT_VOLT_SCALE);
-        crsfVolt.p.cell[1] = htobe16(eam.battVoltage2 * HOTT_VOLT_SCALE);
-        crsfVolt.p.cell[2] = htobe16(eam.mainVoltage * HOTT_VOLT_SCALE);
-    }
-    else if (device == GAM)
-    {
-        crsfVolt.p.cell[0] = htobe16(gam.battery1 * HOTT_VOLT_SCALE);
-        crsfVolt.p.cell[1] = htobe16(gam.battery2 * HOTT_VOLT_SCALE);
-        crsfVolt.p.cell[2] = htobe16(gam.inputVoltage * HOTT_VOLT_SCALE);
-    }
-    else if (device == ESC)
-    {
-        crsfVolt.p.cell[0] = htobe16(esc.inputVoltage * HOTT_VOLT_SCALE);
-        crsfVolt.p.cell[1] = htobe16(esc.becVoltage * HOTT_VOLT_SCALE);
-
-        payloadSize = 1 + 2 * 2;
-    }
-
-    crsfRouter.SetHeaderAndCrc((crsf_header_t *)&crsfVolt, CRSF_FRAMETYPE_CELLS, CRSF_FRAME_SIZE(payloadSize), CRSF_ADDRESS_RADIO_TRANSMITTER);
 
-    uint8_t crc = ((uint8_t *)&crsfVolt.p)[payloadSize];
-
-    // send packet only if min rate timer expired or values have changed
-    if ((now - lastVoltSent >= VOLT_MIN_CRSFRATE) || (lastVoltCRC != crc))
+    device[deviceIdx].present = true;
+    device[deviceIdx].missedPolls = 0;
+    if (deviceIdx == polledDevice)
     {
-        lastVoltSent = now;
-
-        crsfRouter.deliverMessage(nullptr, &crsfVolt.h);
+        polledDevice = NOT_FOUND;
     }
 
-    lastVoltCRC = crc;
+    sensors.decodeFrame(deviceIdx, hottBusFrame.payload);
+    valuesUpdated = true;
 }
 
-void SerialHoTT_TLM::sendCRSFairspeed(uint32_t now, HoTTDevices device)
-{
-    // prepare CRSF telemetry packet
-    CRSF_MK_FRAME_T(crsf_sensor_airspeed_t) crsfAirspeed = {0};
-
-    if (device == EAM)
-    {
-        crsfAirspeed.p.speed = htobe16(eam.speed * HOTT_SPEED_SCALE_EAM);
-    }
-    else if (device == GAM)
-    {
-        crsfAirspeed.p.speed = htobe16(gam.speed * HOTT_SPEED_SCALE_GAM);
-    }
-    else if (device == ESC)
-    {
-        crsfAirspeed.p.speed = htobe16(esc.speed * HOTT_SPEED_SCALE_EAM);
-    }
-
-    crsfRouter.SetHeaderAndCrc((crsf_header_t *)&crsfAirspeed, CRSF_FRAMETYPE_AIRSPEED, CRSF_FRAME_SIZE(sizeof(crsf_sensor_airspeed_t)), CRSF_ADDRESS_RADIO_TRANSMITTER);
-
-    // send packet only if min rate timer expired or values have changed
-    if ((now - lastAirspeedSent >= AIRSPEED_MIN_CRSFRATE) || (lastAirspeedCRC != crsfAirspeed.crc))
-    {
-        lastAirspeedSent = now;
-
-        crsfRouter.deliverMessage(nullptr, &crsfAirspeed.h);
-    }
-
-    lastAirspeedCRC = crsfAirspeed.crc;
-}
-
-// HoTT telemetry data getters
-uint16_t SerialHoTT_TLM::getHoTTvoltage()
-{
-    if (device[EAM].present)
-    {
-        return eam.mainVoltage;
-    }
-    else if (device[GAM].present)
-    {
-        return (gam.inputVoltage);
-    }
-    else if (device[ESC].present)
-    {
-        return esc.inputVoltage;
-    }
-
-    return 0;
-}
-
-uint16_t SerialHoTT_TLM::getHoTTcurrent()
-{
-    if (device[EAM].present)
-    {
-        return eam.current;
-    }
-    else if (device[GAM].present)
-    {
-        return gam.current;
-    }
-    else if (device[ESC].present)
-    {
-        return esc.current;
-    }
-    
-    return 0;
-}
-
-uint32_t SerialHoTT_TLM::getHoTTcapacity()
-{
-    if (device[EAM].present)
-    {
-        return eam.capacity;
-    }
-    else if (device[GAM].present)
-    {
-        return (gam.capacity);
-    }
-    else if (device[ESC].present)
-    {
-        return esc.capacity;
-    }
-
-    return 0;
-}
-
-int16_t SerialHoTT_TLM::getHoTTaltitude()
-{
-    if (device[VARIO].present)
-    {
-        return vario.altitude;
-    }
-    else if (device[GPS].present)
-    {
-        return gps.altitude;
-    }
-    else if (device[EAM].present)
-    {
-        return eam.altitude;
-    }
-    else if (device[GAM].present)
-    {
-        return gam.altitude;
-    }
-
-    return 0;
-}
-
-int16_t SerialHoTT_TLM::getHoTTvv()
-{
-    if (device[VARIO].present)
-    {
-        return (vario.mPerSec);
-    }
-    else if (device[GPS].present)
-    {
-        return (gps.mPerSec);
-    }
-    else if (device[EAM].present)
-    {
-        return (eam.mPerSec);
-    }
-    else if (device[GAM].present)
-    {
-        return (gam.mPerSec);
-    }
-
-    return 0;
-}
-
-uint8_t SerialHoTT_TLM::getHoTTremaining()
-{
-    if (device[GAM].present)
-    {
-        return gam.fuelScale;
-    }
-
-    return 0;
-}
-
-int32_t SerialHoTT_TLM::getHoTTlatitude()
-{
-    if (!device[GPS].present)
-    {
-        return 0;
-    }
-
-    uint8_t deg = gps.latDegMin / DegMinScale;
-
-    int32_t Lat = deg * DegScale +
-                  ((gps.latDegMin - (deg * DegMinScale)) * MinScale) / MinDivide +
-                  (gps.latSec * SecScale) / MinDivide;
-
-    if (gps.latNS != 0)
-    {
-        Lat = -Lat;
-    }
-
-    return (Lat);
-}
-
-int32_t SerialHoTT_TLM::getHoTTlongitude()
+uint8_t SerialHoTT_TLM::calcFrameCRC(uint8_t *buf)
 {
-    if (!device[GPS].present)
-    {
-        return 0;
-    }
-
-    uint8_t deg = gps.lonDegMin / DegMinScale;
-
-    int32_t Lon = deg * DegScale +
-                  ((gps.lonDegMin - (deg * DegMinScale)) * MinScale) / MinDivide +
-                  (gps.lonSec * SecScale) / MinDivide;
-
-    if (gps.lonEW != 0)
-        Lon = -Lon;
-
-    return Lon;
-}
+    uint16_t sum = 0;
 
-uint16_t SerialHoTT_TLM::getHoTTgroundspeed()
-{
-    if (device[GPS].present)
+    for (uint8_t i = 0; i < FRAME_SIZE - 1; i++)
     {
-        return gps.speed;
+        sum += buf[i];
     }
 
-    return 0;
+    return sum = sum & 0xff;
 }
 
-uint16_t SerialHoTT_TLM::getHoTTheading()
+void SerialHoTT_TLM::scheduleCRSFtelemetry(uint32_t now)
 {
-    if (!device[GPS].present)
-    {
-        return 0;
-    }
-
-    uint16_t heading = gps.direction * 2;
+    uint8_t buffer[CRSF_MAX_PACKET_LEN];
 
-    if (heading > 180)
+    for (uint8_t frame = 0; frame < HOTT_CRSF_FRAME_COUNT; frame++)
     {
-        heading -= 360;
-    }
+        // frames only need rebuilding if a HoTT frame was received or the min rate expired
+        const bool expired = now - lastSent[frame] >= crsfMinRate[frame];
+        if (!valuesUpdated && !expired)
+        {
+            continue;
+        }
 
-    return (heading);
-}
+        const uint8_t frameSize = sensors.buildCRSFframe((hottCrsfFrame_e)frame, buffer);
+        if (frameSize == 0)
+        {
+            continue;
+        }
 
-uint8_t SerialHoTT_TLM::getHoTTsatellites()
-{
-    if (device[GPS].present)
-    {
-        return gps.satellites;
-    }
+        // indicate external sensor is present
+        if (frame == HOTT_CRSF_VARIO)
+        {
+            telemetry.SetCrsfBaroSensorDetected();
+        }
+        else if (frame == HOTT_CRSF_BATTERY)
+        {
+            telemetry.SetCrsfBatterySensorDetected();
+        }
 
-    return 0;
-}
+        // send packet only if min rate timer expired or values have changed
+        const uint8_t crc = buffer[frameSize + CRSF_FRAME_NOT_COUNTED_BYTES - 1];
+        if (expired || lastCRC[frame] != crc)
+        {
+            lastSent[frame] = now;
+            crsfRouter.deliverMessage(nullptr, (crsf_header_t *)buffer);
+        }
 
-uint16_t SerialHoTT_TLM::getHoTTMSLaltitude()
-{
-    if (device[GPS].present)
-    {
-        return gps.mslAltitude;
+        lastCRC[frame] = crc;
     }
 
-    return 0;
-}
-
-uint32_t SerialHoTT_TLM::htobe24(uint32_t val)
-{
-#if (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
-    return val;
-#else
-    uint8_t *ptrByte = (uint8_t *)&val;
-
-    uint8_t swp = ptrByte[0];
-    ptrByte[0] = ptrByte[2];
-    ptrByte[2] = swp;
-
-    return val;
-#endif
+    valuesUpdated = false;
 }
 
 #endif
@@ -7,6 +7,7 @@
 #include "device.h"
 
 #define MAVLINK_RC_PACKET_INTERVAL 10
+#define MAVLINK_OUTPUT_CHUNK 64
 
 #define MAVLINK_COMM_NUM_BUFFERS 1
 #include "common/mavlink.h"
@@ -107,34 +108,34 @@ void SerialMavlink::sendQueuedData(uint32_t maxBytesToSend)
         _outputPort->write(buf, len);
     }
 
-    auto size = mavlinkOutputBuffer.size();
-    if (size == 0)
+    // Parse the queued bytes in fixed size chunks rather than one stack buffer sized by the queue
+    uint8_t apBuf[MAVLINK_OUTPUT_CHUNK];
+    uint16_t remaining = mavlinkOutputBuffer.size();
+    while (remaining != 0)
     {
-        // nothing to send
-        return;
-    }
-
-    uint8_t apBuf[size];
-    mavlinkOutputBuffer.lock();
-    mavlinkOutputBuffer.popBytes(apBuf, size);
-    mavlinkOutputBuffer.unlock();
+        const uint16_t size = std::min(remaining, (uint16_t)sizeof(apBuf));
+        remaining -= size;
+        mavlinkOutputBuffer.lock();
+        mavlinkOutputBuffer.popBytes(apBuf, size);
+        mavlinkOutputBuffer.unlock();
 
-    for (uint8_t i = 0; i < size; ++i)
-    {
-        uint8_t c = apBuf[i];
+        for (uint16_t i = 0; i < size; ++i)
+        {
+            uint8_t c = apBuf[i];
 
-        mavlink_message_t msg;
-        mavlink_status_t status;
+            mavlink_message_t msg;
+            mavlink_status_t status;
 
-        // Try parse a mavlink message
-        if (mavlink_frame_char(MAVLINK_COMM_0, c, &msg, &status))
-        {
-            // Message decoded successfully
+            // Try parse a mavlink message
+            if (mavlink_frame_char(MAVLINK_COMM_0, c, &msg, &status))
+            {
+                // Message decoded successfully
 
-            // Forward message to the UART
-            uint8_t buf[MAVLINK_MAX_PACKET_LEN];
-            uint16_t len = mavlink_msg_to_send_buffer(buf, &msg);
-            _outputPort->write(buf, len);
+                // Forward message to the UART
+                uint8_t buf[MAVLINK_MAX_PACKET_LEN];
+                uint16_t len = mavlink_msg_to_send_buffer(buf, &msg);
+                _outputPort->write(buf, len);
+            }
         }
     }
 }
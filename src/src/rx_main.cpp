@@ -12,11 +12,15 @@
 #include "CRSFParameters.h"
 #include "MeanAccumulator.h"
 #include "PFD.h"
+#include "PhaseLock.h"
+#include "RateScan.h"
 #include "dynpower.h"
+#include "FreqCorrection.h"
 #include "freqTable.h"
 #include "msp.h"
 #include "msptypes.h"
 #include "options.h"
+#include "profiler.h"
 
 #include "rx-serial/SerialIO.h"
 #include "rx-serial/SerialNOOP.h"
@@ -41,6 +45,8 @@
 #include "RXEndpoint.h"
 #include "RXOTAConnector.h"
 #include "rx-serial/devSerialIO.h"
+#include "alloc_tracker.h"
+#include "pool.h"
 
 #if defined(PLATFORM_ESP8266)
 #include <user_interface.h>
@@ -91,6 +97,7 @@ device_affinity_t ui_devices[] = {
   {&AnalogVbat_device, 0},
   {&ServoOut_device, 1},
   {&Baro_device, 0}, // must come after AnalogVbat_device to slow updates
+  {&BaroTelemetry_device, 0}, // must come after Baro_device
 #if defined(PLATFORM_ESP32) && !defined(PLATFORM_ESP32_C3)
   {&VTxSPI_device, 0},
   {&MSPVTx_device, 0}, // dependency on VTxSPI_device
@@ -102,6 +109,10 @@ uint8_t antenna = 0;    // which antenna is currently in use
 uint8_t geminiMode = 0;
 
 PFD PFDloop;
+PhaseLock phaseLock;
+// One for each radio, they have their own crystals
+static FreqCorrector freqCorrector1(FreqCorrectionMax);
+static FreqCorrector freqCorrector2(FreqCorrectionMax);
 Crc2Byte ota_crc;
 ELRS_EEPROM eeprom;
 RxConfig config;
@@ -128,9 +139,17 @@ uint32_t serialBaud;
     const Stream *serial1_protocol_tx = &(SERIAL1_PROTOCOL_TX);
 
     SerialIO *serial1IO = nullptr;
+    // The protocol is created in place, so changing it at runtime does not use the heap
+    static ObjectSlot<SerialIO, MaxSizeOf<SerialCRSF, SerialSBUS, SerialSUMD, SerialHoTT_TLM, SerialTramp,
+        SerialSmartAudio, SerialDisplayport, SerialGPS>::value> serial1Slot;
 #endif
 
 SerialIO *serialIO = nullptr;
+// SerialMavlink is not in the slot, its buffers would make every RX reserve about 2KB for it whatever
+// the protocol, so it is the one protocol still on the heap
+static ObjectSlot<SerialIO, MaxSizeOf<SerialNOOP, SerialAirPort, SerialSBUS, SerialSUMD,
+    SerialDisplayport, SerialGPS, SerialHoTT_TLM, SerialCRSF>::value> serialSlot;
+static NullStream nullLogger;
 
 #define SERIAL_PROTOCOL_RX Serial
 #define SERIAL1_PROTOCOL_RX Serial1
@@ -158,8 +177,17 @@ LPF LPF_UplinkRSSI0(5);  // track rssi per antenna
 LPF LPF_UplinkRSSI1(5);
 MeanAccumulator<int32_t, int8_t, -16> SnrMean;
 
-static uint8_t scanIndex;
+static RateScan rateScan;
+// Rate radio 2 listens on while scanning, when it is not the same as radio 1
+static volatile uint8_t rateScanRadio2 = RATE_SCAN_NONE;
+// Rate radio 2 heard a sync packet on, the loop moves both radios there
+static volatile uint8_t rateScanHit = RATE_SCAN_NONE;
+static_assert(RATE_MAX <= RATE_SCAN_MAX_RATES, "Too many rates to scan");
 uint8_t ExpressLRS_nextAirRateIndex;
+// Rate change announced by the TX, made without dropping the connection when the nonce gets there
+static volatile uint8_t rateSwitchIndex = OTA_RATE_SWITCH_NONE;
+static volatile uint8_t rateSwitchNonce;
+static volatile bool rateSwitchApplied;     // by the timer ISR, RateSwitchComplete() does the rest
 int8_t SwitchModePending;
 
 int32_t PfdPrevRawOffset;
@@ -347,13 +375,41 @@ void CheckInterferenceAndSwitch()
     }
 }
 
+/**
+ * The FHSS frequencies are the TX's. Each radio is tuned to them less its own FreqCorrection, the
+ * radios have their own crystals. Only the SX127x is tuned by it, the others leave it at 0.
+ */
+static uint32_t ICACHE_RAM_ATTR RadioFreq(uint32_t freq, SX12XX_Radio_Number_t radio)
+{
+#if defined(RADIO_SX127X)
+    return freq - (radio == SX12XX_Radio_2 ? FreqCorrection_2 : FreqCorrection);
+#else
+    return freq;
+#endif
+}
+
+static void ICACHE_RAM_ATTR SetRadioFreq(uint32_t freq, SX12XX_Radio_Number_t radio)
+{
+#if defined(RADIO_SX127X)
+    if (radio == SX12XX_Radio_All && isDualRadio())
+    {
+        Radio.SetFrequencyReg(RadioFreq(freq, SX12XX_Radio_1), SX12XX_Radio_1, false);
+        Radio.SetFrequencyReg(RadioFreq(freq, SX12XX_Radio_2), SX12XX_Radio_2, false);
+        return;
+    }
+#endif
+    Radio.SetFrequencyReg(RadioFreq(freq, radio), radio, false);
+}
+
 void SetRFLinkRate(uint8_t index, bool bindMode) // Set speed of RF link
 {
-    expresslrs_mod_settings_s *const ModParams = get_elrs_airRateConfig(index);
-    expresslrs_rf_pref_params_s *const RFperf = get_elrs_RFperfParams(index);
+    const expresslrs_mod_settings_s *const ModParams = get_elrs_airRateConfig(index);
+    const expresslrs_rf_pref_params_s *const RFperf = get_elrs_RFperfParams(index);
 
     // Binding always uses invertIQ
     bool invertIQ = bindMode || (UID[5] & 0x01);
+    // Both radios are set up for this rate
+    rateScanRadio2 = RATE_SCAN_NONE;
 
     uint32_t interval = ModParams->interval;
 #if defined(DEBUG_FREQ_CORRECTION) && defined(RADIO_SX128X)
@@ -361,11 +417,15 @@ void SetRFLinkRate(uint8_t index, bool bindMode) // Set speed of RF link
 #endif
 
     hwTimer::updateInterval(interval);
+    PROFILE_SET_INTERVAL(interval);
+    phaseLockConfig_t phaseLockConfig = PhaseLockDefaultConfig;
+    phaseLockConfig.ticksPerUs = HWTIMER_TICKS_PER_US;
+    phaseLock.begin(interval, phaseLockConfig);
 
     FHSSusePrimaryFreqBand = !(ModParams->radio_type == RADIO_TYPE_LR1121_LORA_2G4) && !(ModParams->radio_type == RADIO_TYPE_LR1121_GFSK_2G4);
     FHSSuseDualBand = ModParams->radio_type == RADIO_TYPE_LR1121_LORA_DUAL;
 
-    Radio.Config(ModParams->bw, ModParams->sf, ModParams->cr, FHSSgetInitialFreq(),
+    Radio.Config(ModParams->bw, ModParams->sf, ModParams->cr, RadioFreq(FHSSgetInitialFreq(), SX12XX_Radio_1),
                  ModParams->PreambleLen, invertIQ, ModParams->PayloadLength
 #if defined(RADIO_SX128X)
                  , uidMacSeedGet(), OtaCrcInitializer, (ModParams->radio_type == RADIO_TYPE_SX128x_FLRC)
@@ -390,8 +450,16 @@ void SetRFLinkRate(uint8_t index, bool bindMode) // Set speed of RF link
     checkGeminiMode();
     if (geminiMode)
     {
-        Radio.SetFrequencyReg(FHSSgetInitialGeminiFreq(), SX12XX_Radio_2, false);
+        SetRadioFreq(FHSSgetInitialGeminiFreq(), SX12XX_Radio_2);
+    }
+#if defined(RADIO_SX127X)
+    else if (isDualRadio())
+    {
+        // Config tuned both radios for radio 1's crystal
+        SetRadioFreq(FHSSgetInitialFreq(), SX12XX_Radio_2);
     }
+#endif
+    LbtSetInitialChannels(geminiMode);
 
     OtaUpdateSerializers(smWideOr8ch, ModParams->PayloadLength);
     MspReceiver.setMaxPackageIndex(ELRS_MSP_MAX_PACKAGES);
@@ -408,6 +476,74 @@ void SetRFLinkRate(uint8_t index, bool bindMode) // Set speed of RF link
     LbtEnableIfRequired();
 }
 
+/**
+ * Change to the announced rate at the start of the new nonce block, the TX does the same on this
+ * nonce. The FHSS starts again from the first (sync) channel.
+ *
+ * This is the part that has to happen on the nonce, from the timer ISR: the modulation, the timer
+ * interval and the FHSS. isRateSwitchCompatible() keeps the packet format, so the serializers stay
+ * as they are, and RateSwitchComplete() does the rest from the loop.
+ */
+static void ICACHE_RAM_ATTR ApplyRateSwitch()
+{
+    const expresslrs_mod_settings_s *const ModParams = get_elrs_airRateConfig(rateSwitchIndex);
+    uint32_t interval = ModParams->interval;
+#if defined(DEBUG_FREQ_CORRECTION) && defined(RADIO_SX128X)
+    interval = interval * 12 / 10; // increase the packet interval by 20% to allow adding packet header
+#endif
+    hwTimer::updateInterval(interval);
+    // Same crystal, keep what the phase lock has learned about it
+    phaseLock.setInterval(interval);
+
+#if defined(RADIO_LR1121)
+    if (FHSSuseDualBand)
+    {
+        Radio.SetModulation(ModParams->bw, ModParams->sf, ModParams->cr, ModParams->PreambleLen, SX12XX_Radio_1);
+        Radio.SetModulation(ModParams->bw2, ModParams->sf2, ModParams->cr2, ModParams->PreambleLen2, SX12XX_Radio_2);
+    }
+    else
+#endif
+    {
+        Radio.SetModulation(ModParams->bw, ModParams->sf, ModParams->cr, ModParams->PreambleLen, SX12XX_Radio_All);
+    }
+
+    SetRadioFreq(FHSSgetInitialFreq(), SX12XX_Radio_All);
+    if (geminiMode)
+    {
+        SetRadioFreq(FHSSgetInitialGeminiFreq(), SX12XX_Radio_2);
+    }
+    LbtSetInitialChannels(geminiMode);
+    FHSSsetCurrIndex(0);
+
+    ExpressLRS_currAirRate_Modparams = ModParams;
+    ExpressLRS_currAirRate_RFperfParams = get_elrs_RFperfParams(rateSwitchIndex);
+    ExpressLRS_nextAirRateIndex = rateSwitchIndex;
+    rateSwitchApplied = true;
+    rateSwitchIndex = OTA_RATE_SWITCH_NONE;
+    Radio.RXnb();
+}
+
+// The rest of an announced rate switch, from the loop
+static void RateSwitchComplete()
+{
+    if (!rateSwitchApplied)
+        return;
+    rateSwitchApplied = false;
+
+    const expresslrs_mod_settings_s *const ModParams = ExpressLRS_currAirRate_Modparams;
+    const expresslrs_rf_pref_params_s *const RFperf = ExpressLRS_currAirRate_RFperfParams;
+    DBGLN("rate switch %u", ModParams->index);
+    uint32_t interval = ModParams->interval;
+#if defined(DEBUG_FREQ_CORRECTION) && defined(RADIO_SX128X)
+    interval = interval * 12 / 10;
+#endif
+    PROFILE_SET_INTERVAL(interval);
+    Radio.FuzzySNRThreshold = (RFperf->DynpowerSnrThreshUp == DYNPOWER_SNR_THRESH_NONE) ? 0 : (RFperf->DynpowerSnrThreshDn - RFperf->DynpowerSnrThreshUp);
+    cycleInterval = ((uint32_t)11U * FHSSgetChannelCount() * ModParams->FHSShopInterval * interval) / (10U * 1000U);
+    telemBurstValid = false;
+    LbtEnableIfRequired();
+}
+
 static void ICACHE_RAM_ATTR HandleFHSS()
 {
     uint8_t modresultFHSS = OtaNonce % ExpressLRS_currAirRate_Modparams->FHSShopInterval;
@@ -422,20 +558,23 @@ static void ICACHE_RAM_ATTR HandleFHSS()
         if (((OtaNonce / ExpressLRS_currAirRate_Modparams->FHSShopInterval) % 2 == 0) || FHSSuseDualBand) // When in DualBand do not switch between radios.  The OTA modulation paramters and HighFreq/LowFreq Tx amps are set during Config.
 
         {
-            Radio.SetFrequencyReg(FHSSgetNextFreq(), SX12XX_Radio_1, false);
-            Radio.SetFrequencyReg(FHSSgetGeminiFreq(), SX12XX_Radio_2, false);
+            SetRadioFreq(FHSSgetNextFreq(), SX12XX_Radio_1);
+            SetRadioFreq(FHSSgetGeminiFreq(), SX12XX_Radio_2);
+            LbtSetChannels(FHSSgetCurrChannel(), FHSSgetCurrGeminiChannel());
         }
         else
         {
             // Write radio1 first. This optimises the SPI traffic order.
             uint32_t freqRadio2 = FHSSgetNextFreq();
-            Radio.SetFrequencyReg(FHSSgetGeminiFreq(), SX12XX_Radio_1, false);
-            Radio.SetFrequencyReg(freqRadio2, SX12XX_Radio_2, false);
+            SetRadioFreq(FHSSgetGeminiFreq(), SX12XX_Radio_1);
+            SetRadioFreq(freqRadio2, SX12XX_Radio_2);
+            LbtSetChannels(FHSSgetCurrGeminiChannel(), FHSSgetCurrChannel());
         }
     }
     else
     {
-        Radio.SetFrequencyReg(FHSSgetNextFreq(), SX12XX_Radio_All, false);
+        SetRadioFreq(FHSSgetNextFreq(), SX12XX_Radio_All);
+        LbtSetChannels(FHSSgetCurrChannel(), FHSSgetCurrChannel());
     }
 
 #if defined(RADIO_SX127X)
@@ -656,85 +795,44 @@ bool ICACHE_RAM_ATTR HandleSendTelemetryResponse()
     return true;
 }
 
-int32_t ICACHE_RAM_ATTR HandleFreqCorr(bool value, SX12XX_Radio_Number_t radio)
+int32_t ICACHE_RAM_ATTR HandleFreqCorr(int32_t error, SX12XX_Radio_Number_t radio)
 {
-    int32_t tempFC = FreqCorrection;
     if (radio == SX12XX_Radio_2)
     {
-        tempFC = FreqCorrection_2;
-    }
-
-    if (value)
-    {
-        if (tempFC > FreqCorrectionMin)
-        {
-            tempFC--; // FREQ_STEP units
-            if (tempFC == FreqCorrectionMin)
-            {
-                DBGLN("Max -FreqCorrection reached!");
-            }
-        }
-    }
-    else
-    {
-        if (tempFC < FreqCorrectionMax)
-        {
-            tempFC++; // FREQ_STEP units
-            if (tempFC == FreqCorrectionMax)
-            {
-                DBGLN("Max +FreqCorrection reached!");
-            }
-        }
-    }
-
-    if (radio == SX12XX_Radio_1)
-    {
-        FreqCorrection = tempFC;
+        FreqCorrection_2 = freqCorrector2.update(error);
+        return FreqCorrection_2;
     }
-    else
-    {
-        FreqCorrection_2 = tempFC;
-    }
-
-    return tempFC;
+    FreqCorrection = freqCorrector1.update(error);
+    return FreqCorrection;
 }
 
 void ICACHE_RAM_ATTR updatePhaseLock()
 {
-    if (connectionState != disconnected && PFDloop.hasResult())
+    if (connectionState != disconnected)
     {
-        int32_t RawOffset = PFDloop.calcResult();
-        int32_t Offset = LPF_Offset.update(RawOffset);
-        int32_t OffsetDx = LPF_OffsetDx.update(RawOffset - PfdPrevRawOffset);
-        PfdPrevRawOffset = RawOffset;
-
-        if (RXtimerState == tim_locked)
+        // Only correct the frequency once the link is good, a tentative link may not be our TX
+        const bool tracking = connectionState == connected;
+        if (PFDloop.hasResult())
         {
-            // limit rate of freq offset adjustment
-            if (OtaNonce % 8 == 0)
-            {
-                if (Offset > 0)
-                {
-                    hwTimer::incFreqOffset();
-                }
-                else if (Offset < 0)
-                {
-                    hwTimer::decFreqOffset();
-                }
-            }
-        }
+            int32_t RawOffset = PFDloop.calcResult();
+            // The filtered offsets are only used to detect the lock
+            int32_t Offset = LPF_Offset.update(RawOffset);
+            int32_t OffsetDx = LPF_OffsetDx.update(RawOffset - PfdPrevRawOffset);
+            PfdPrevRawOffset = RawOffset;
 
-        if (connectionState != connected)
-        {
-            hwTimer::phaseShift(RawOffset >> 1);
+            phaseLock.update(RawOffset, tracking);
+
+            DBGVLN("%d:%d:%d:%d:%d:%d", Offset, RawOffset, OffsetDx, phaseLock.phaseError(), phaseLock.freqOffset(), uplinkLQ);
+            UNUSED(Offset);
+            UNUSED(OffsetDx); // complier warning if no debug
         }
         else
         {
-            hwTimer::phaseShift(Offset >> 2);
+            phaseLock.missed(tracking);
         }
 
-        DBGVLN("%d:%d:%d:%d:%d", Offset, RawOffset, OffsetDx, hwTimer::getFreqOffset(), uplinkLQ);
-        UNUSED(OffsetDx); // complier warning if no debug
+        hwTimer::phaseShift(phaseLock.phaseShift());
+        hwTimer::setFreqOffset(phaseLock.freqOffset());
     }
 
     PFDloop.reset();
@@ -742,6 +840,8 @@ void ICACHE_RAM_ATTR updatePhaseLock()
 
 void ICACHE_RAM_ATTR HWtimerCallbackTick() // this is 180 out of phase with the other callback, occurs mid-packet reception
 {
+    PROFILE_SCOPE(PROFILE_TIMER_TICK);
+
     if (ExpressLRS_currAirRate_Modparams->numOfSends == 1)
     {
         // Save the LQ value before the inc() reduces it by 1
@@ -851,6 +951,8 @@ static void ICACHE_RAM_ATTR updateDiversity()
 
 void ICACHE_RAM_ATTR HWtimerCallbackTock()
 {
+    PROFILE_SCOPE(PROFILE_TIMER_TOCK);
+
     PFDloop.intEvent(micros()); // our internal osc just fired
 
     if (ExpressLRS_currAirRate_Modparams->numOfSends > 1 && !(OtaNonce % ExpressLRS_currAirRate_Modparams->numOfSends))
@@ -878,7 +980,10 @@ void ICACHE_RAM_ATTR HWtimerCallbackTock()
     sendImmediateRC();
 
     OtaNonce++;
-    HandleFHSS();
+    if (rateSwitchIndex != OTA_RATE_SWITCH_NONE && OtaNonce == rateSwitchNonce)
+        ApplyRateSwitch();
+    else
+        HandleFHSS();
     updateDiversity();
     tlmSent = HandleSendTelemetryResponse();
     updatePhaseLock();
@@ -898,7 +1003,9 @@ void LostConnection(bool resumeRx)
 
     setConnectionState(disconnected); //set lost connection
     RXtimerState = tim_disconnected;
+    rateSwitchIndex = OTA_RATE_SWITCH_NONE;
     hwTimer::resetFreqOffset();
+    phaseLock.reset();
     PfdPrevRawOffset = 0;
     GotConnectionMillis = 0;
     uplinkLQ = 0;
@@ -927,6 +1034,7 @@ void LostConnection(bool resumeRx)
 void ICACHE_RAM_ATTR TentativeConnection(unsigned long now)
 {
     PFDloop.reset();
+    phaseLock.reset();
     setConnectionState(tentative);
     connectionHasModelMatch = false;
     RXtimerState = tim_disconnected;
@@ -1140,8 +1248,21 @@ static bool ICACHE_RAM_ATTR ProcessRfPacket_SYNC(uint32_t const now, OTA_Sync_s
         config.SetAntennaMode(otaSync->geminiMode);
     }
 
-    // Will change the packet air rate in loop() if this changes
-    ExpressLRS_nextAirRateIndex = enumRatetoIndex((expresslrs_RFrates_e)otaSync->rfRateEnum);
+    const uint8_t rateIndex = enumRatetoIndex((expresslrs_RFrates_e)otaSync->rfRateEnum);
+    if (otaSync->rateSwitch)
+    {
+        // Announced change, made in the timer on the nonce the TX changes on
+        if (connectionState == connected && isRateSwitchCompatible(ExpressLRS_currAirRate_Modparams->index, rateIndex))
+        {
+            rateSwitchNonce = OtaRateSwitchNonce(otaSync->nonce);
+            rateSwitchIndex = rateIndex;
+        }
+    }
+    else
+    {
+        // Will change the packet air rate in loop() if this changes
+        ExpressLRS_nextAirRateIndex = rateIndex;
+    }
     updateSwitchModePendingFromOta(otaSync->switchEncMode);
 
     // Update TLM ratio, should never be TLM_RATIO_STD/DISARMED, the TX calculates the correct value for the RX
@@ -1197,7 +1318,7 @@ bool ICACHE_RAM_ATTR ProcessRFPacket(SX12xxDriverCommon::rx_status const status)
     anti_jamming_register_packet(crcGood ? 1 : 0, millis());
     #endif
 
-    if (!OtaValidatePacketCrc(otaPktPtr))
+    if (!crcGood)
     {
         DBGVLN("CRC error");
         #if defined(DEBUG_RX_SCOREBOARD)
@@ -1206,6 +1327,15 @@ bool ICACHE_RAM_ATTR ProcessRFPacket(SX12xxDriverCommon::rx_status const status)
         return false;
     }
 
+    if (rateScanRadio2 != RATE_SCAN_NONE && Radio.GetProcessingPacketRadio() == SX12XX_Radio_2)
+    {
+        // Radio 2 heard the TX on the rate it was scanning. Radio 1 and the timer are still on the
+        // other rate, so only note it here and let the loop move both radios, see RateScanHit().
+        if (otaPktPtr->std.type == PACKET_TYPE_SYNC)
+            rateScanHit = rateScanRadio2;
+        return false;
+    }
+
     // The extEvent defines where TOCK timer ISR is to be synced to, i.e. where the packet period begins.
     // For rates where the TOA is longer than half the packet period schedule the TOCK for rougly 1x TOA before
     // the TX's end of the period so telemetry is received by the TX in the correct period. For all others,
@@ -1258,26 +1388,16 @@ bool ICACHE_RAM_ATTR ProcessRFPacket(SX12xxDriverCommon::rx_status const status)
     // Adjusts FreqCorrection for RX freq offset
     if (Radio.FrequencyErrorAvailable())
     {
-    #if defined(RADIO_SX127X)
-        int32_t tempFreqCorrection = HandleFreqCorr(Radio.GetFrequencyErrorbool(Radio.GetProcessingPacketRadio()), Radio.GetProcessingPacketRadio());
-        // Teamp900 also needs to adjust its demood PPM
+        int32_t tempFreqCorrection = HandleFreqCorr(Radio.GetFrequencyError(Radio.GetProcessingPacketRadio()), Radio.GetProcessingPacketRadio());
+        // Teamp900 also needs to adjust its demood PPM, the other chips ignore it
         Radio.SetPPMoffsetReg(tempFreqCorrection, Radio.GetProcessingPacketRadio());
 
         if (Radio.hasSecondRadioGotData)
         {
             SX12XX_Radio_Number_t secondRadio = Radio.GetProcessingPacketRadio() == SX12XX_Radio_1 ? SX12XX_Radio_2 : SX12XX_Radio_1;
-            tempFreqCorrection = HandleFreqCorr(Radio.GetFrequencyErrorbool(secondRadio), secondRadio);
+            tempFreqCorrection = HandleFreqCorr(Radio.GetFrequencyError(secondRadio), secondRadio);
             Radio.SetPPMoffsetReg(tempFreqCorrection, secondRadio);
         }
-    #else
-        HandleFreqCorr(Radio.GetFrequencyErrorbool(Radio.GetProcessingPacketRadio()), Radio.GetProcessingPacketRadio());
-
-        if (Radio.hasSecondRadioGotData)
-        {
-            SX12XX_Radio_Number_t secondRadio = Radio.GetProcessingPacketRadio() == SX12XX_Radio_1 ? SX12XX_Radio_2 : SX12XX_Radio_1;
-            HandleFreqCorr(Radio.GetFrequencyErrorbool(secondRadio), secondRadio);
-        }
-    #endif
     }
 
     // Received a packet, that's the definition of LQ
@@ -1295,6 +1415,8 @@ bool ICACHE_RAM_ATTR ProcessRFPacket(SX12xxDriverCommon::rx_status const status)
 
 bool ICACHE_RAM_ATTR RXdoneISR(SX12xxDriverCommon::rx_status const status)
 {
+    PROFILE_SCOPE(PROFILE_RX_DONE);
+
     if (LQCalc.currentIsSet() && connectionState == connected)
     {
         return false; // Already received a packet, do not run ProcessRFPacket() again.
@@ -1315,6 +1437,7 @@ bool ICACHE_RAM_ATTR RXdoneISR(SX12xxDriverCommon::rx_status const status)
 
 void ICACHE_RAM_ATTR TXdoneISR()
 {
+    PROFILE_SCOPE(PROFILE_TX_DONE);
     Radio.RXnb();
     LbtCcaTimerStart();
 #if defined(DEBUG_RX_SCOREBOARD)
@@ -1373,9 +1496,9 @@ static void setupSerial()
         SerialLogger = &Serial;
         #endif
         #else
-        SerialLogger = new NullStream();
+        SerialLogger = &nullLogger;
         #endif
-        serialIO = new SerialNOOP();
+        serialIO = serialSlot.create<SerialNOOP>();
         return;
     }
     if (config.GetSerialProtocol() == PROTOCOL_CRSF || config.GetSerialProtocol() == PROTOCOL_INVERTED_CRSF || firmwareOptions.is_airport)
@@ -1452,15 +1575,15 @@ static void setupSerial()
 
     if (firmwareOptions.is_airport)
     {
-        serialIO = new SerialAirPort(SERIAL_PROTOCOL_TX, SERIAL_PROTOCOL_RX);
+        serialIO = serialSlot.create<SerialAirPort>(SERIAL_PROTOCOL_TX, SERIAL_PROTOCOL_RX);
     }
     else if (sbusSerialOutput)
     {
-        serialIO = new SerialSBUS(SERIAL_PROTOCOL_TX, SERIAL_PROTOCOL_RX);
+        serialIO = serialSlot.create<SerialSBUS>(SERIAL_PROTOCOL_TX, SERIAL_PROTOCOL_RX);
     }
     else if (sumdSerialOutput)
     {
-        serialIO = new SerialSUMD(SERIAL_PROTOCOL_TX, SERIAL_PROTOCOL_RX);
+        serialIO = serialSlot.create<SerialSUMD>(SERIAL_PROTOCOL_TX, SERIAL_PROTOCOL_RX);
     }
     else if (mavlinkSerialOutput)
     {
@@ -1468,19 +1591,19 @@ static void setupSerial()
     }
     else if (config.GetSerialProtocol() == PROTOCOL_MSP_DISPLAYPORT)
     {
-        serialIO = new SerialDisplayport(SERIAL_PROTOCOL_TX, SERIAL_PROTOCOL_RX);
+        serialIO = serialSlot.create<SerialDisplayport>(SERIAL_PROTOCOL_TX, SERIAL_PROTOCOL_RX);
     }
     else if (config.GetSerialProtocol() == PROTOCOL_GPS)
     {
-        serialIO = new SerialGPS(SERIAL_PROTOCOL_TX, SERIAL_PROTOCOL_RX);
+        serialIO = serialSlot.create<SerialGPS>(SERIAL_PROTOCOL_TX, SERIAL_PROTOCOL_RX);
     }
     else if (hottTlmSerial)
     {
-        serialIO = new SerialHoTT_TLM(SERIAL_PROTOCOL_TX, SERIAL_PROTOCOL_RX);
+        serialIO = serialSlot.create<SerialHoTT_TLM>(SERIAL_PROTOCOL_TX, SERIAL_PROTOCOL_RX);
     }
     else
     {
-        serialIO = new SerialCRSF(SERIAL_PROTOCOL_TX, SERIAL_PROTOCOL_RX);
+        serialIO = serialSlot.create<SerialCRSF>(SERIAL_PROTOCOL_TX, SERIAL_PROTOCOL_RX);
     }
 
 #if defined(DEBUG_ENABLED)
@@ -1491,7 +1614,7 @@ static void setupSerial()
     SerialLogger = &Serial;
 #endif
 #else
-    SerialLogger = new NullStream();
+    SerialLogger = &nullLogger;
 #endif
 }
 
@@ -1501,7 +1624,7 @@ static void serial1Shutdown()
     if(serial1IO != nullptr)
     {
         Serial1.end();
-        delete serial1IO;
+        serial1Slot.destroy();
         serial1IO = nullptr;
     }
 }
@@ -1539,44 +1662,44 @@ static void setupSerial1()
             break;
         case PROTOCOL_SERIAL1_CRSF:
             Serial1.begin(firmwareOptions.uart_baud, SERIAL_8N1, serial1RXpin, serial1TXpin, false);
-            serial1IO = new SerialCRSF(SERIAL1_PROTOCOL_TX, SERIAL1_PROTOCOL_RX);
+            serial1IO = serial1Slot.create<SerialCRSF>(SERIAL1_PROTOCOL_TX, SERIAL1_PROTOCOL_RX);
             break;
         case PROTOCOL_SERIAL1_INVERTED_CRSF:
             Serial1.begin(firmwareOptions.uart_baud, SERIAL_8N1, serial1RXpin, serial1TXpin, true);
-            serial1IO = new SerialCRSF(SERIAL1_PROTOCOL_TX, SERIAL1_PROTOCOL_RX);
+            serial1IO = serial1Slot.create<SerialCRSF>(SERIAL1_PROTOCOL_TX, SERIAL1_PROTOCOL_RX);
             break;
         case PROTOCOL_SERIAL1_SBUS:
         case PROTOCOL_SERIAL1_DJI_RS_PRO:
             Serial1.begin(100000, SERIAL_8E2, UNDEF_PIN, serial1TXpin, true);
-            serial1IO = new SerialSBUS(SERIAL1_PROTOCOL_TX, SERIAL1_PROTOCOL_RX);
+            serial1IO = serial1Slot.create<SerialSBUS>(SERIAL1_PROTOCOL_TX, SERIAL1_PROTOCOL_RX);
             break;
         case PROTOCOL_SERIAL1_INVERTED_SBUS:
             Serial1.begin(100000, SERIAL_8E2, UNDEF_PIN, serial1TXpin, false);
-            serial1IO = new SerialSBUS(SERIAL1_PROTOCOL_TX, SERIAL1_PROTOCOL_RX);
+            serial1IO = serial1Slot.create<SerialSBUS>(SERIAL1_PROTOCOL_TX, SERIAL1_PROTOCOL_RX);
             break;
         case PROTOCOL_SERIAL1_SUMD:
             Serial1.begin(115200, SERIAL_8N1, UNDEF_PIN, serial1TXpin, false);
-            serial1IO = new SerialSUMD(SERIAL1_PROTOCOL_TX, SERIAL1_PROTOCOL_RX);
+            serial1IO = serial1Slot.create<SerialSUMD>(SERIAL1_PROTOCOL_TX, SERIAL1_PROTOCOL_RX);
             break;
         case PROTOCOL_SERIAL1_HOTT_TLM:
             Serial1.begin(19200, SERIAL_8N2, serial1RXpin, serial1TXpin, false);
-            serial1IO = new SerialHoTT_TLM(SERIAL1_PROTOCOL_TX, SERIAL1_PROTOCOL_RX, serial1TXpin);
+            serial1IO = serial1Slot.create<SerialHoTT_TLM>(SERIAL1_PROTOCOL_TX, SERIAL1_PROTOCOL_RX, serial1TXpin);
             break;
         case PROTOCOL_SERIAL1_TRAMP:
             Serial1.begin(9600, SERIAL_8N1, UNDEF_PIN, serial1TXpin, false);
-            serial1IO = new SerialTramp(SERIAL1_PROTOCOL_TX, SERIAL1_PROTOCOL_RX, serial1TXpin);
+            serial1IO = serial1Slot.create<SerialTramp>(SERIAL1_PROTOCOL_TX, SERIAL1_PROTOCOL_RX, serial1TXpin);
             break;
         case PROTOCOL_SERIAL1_SMARTAUDIO:
             Serial1.begin(4800, SERIAL_8N2, UNDEF_PIN, serial1TXpin, false);
-            serial1IO = new SerialSmartAudio(SERIAL1_PROTOCOL_TX, SERIAL1_PROTOCOL_RX, serial1TXpin);
+            serial1IO = serial1Slot.create<SerialSmartAudio>(SERIAL1_PROTOCOL_TX, SERIAL1_PROTOCOL_RX, serial1TXpin);
             break;
         case PROTOCOL_SERIAL1_MSP_DISPLAYPORT:
             Serial1.begin(115200, SERIAL_8N1, UNDEF_PIN, serial1TXpin, false);
-            serial1IO = new SerialDisplayport(SERIAL1_PROTOCOL_TX, SERIAL1_PROTOCOL_RX);
+            serial1IO = serial1Slot.create<SerialDisplayport>(SERIAL1_PROTOCOL_TX, SERIAL1_PROTOCOL_RX);
             break;
         case PROTOCOL_SERIAL1_GPS:
             Serial1.begin(115200, SERIAL_8N1, serial1RXpin, serial1TXpin, false);
-            serial1IO = new SerialGPS(SERIAL1_PROTOCOL_TX, SERIAL1_PROTOCOL_RX);
+            serial1IO = serial1Slot.create<SerialGPS>(SERIAL1_PROTOCOL_TX, SERIAL1_PROTOCOL_RX);
             break;
     }
 }
@@ -1593,11 +1716,18 @@ void reconfigureSerial1()
 
 static void serialShutdown()
 {
-    SerialLogger = new NullStream();
+    SerialLogger = &nullLogger;
     if(serialIO != nullptr)
     {
         Serial.end();
-        delete serialIO;
+        if (serialIO == serialSlot.get())
+        {
+            serialSlot.destroy();
+        }
+        else
+        {
+            delete serialIO;
+        }
         serialIO = nullptr;
     }
 }
@@ -1662,6 +1792,66 @@ static void setupBindingFromConfig()
     OtaUpdateCrcInitFromUid();
 }
 
+static void RateScanBegin(uint8_t start)
+{
+    uint8_t groups[RATE_MAX];
+    for (uint8_t i = 0; i < RATE_MAX; i++)
+    {
+        const expresslrs_mod_settings_s *const ModParams = get_elrs_airRateConfig(i);
+        if (!isSupportedRFRate(i))
+            groups[i] = RATE_SCAN_NONE;
+        else if (ModParams->radio_type == RADIO_TYPE_LR1121_LORA_DUAL)
+            groups[i] = RATE_SCAN_SOLO;
+        else
+            groups[i] = ModParams->radio_type * 2 + (ModParams->PayloadLength == OTA8_PACKET_SIZE);
+    }
+#if defined(RADIO_SX127X)
+    // The SX127x driver keeps one set of modem settings for both radios
+    rateScan.begin(groups, RATE_MAX, start, false);
+#else
+    rateScan.begin(groups, RATE_MAX, start, isDualRadio());
+#endif
+}
+
+#if !defined(RADIO_SX127X)
+/**
+ * Listen on a second rate with radio 2. SetRFLinkRate() has set up radio 1 on a rate of the same
+ * group, so the payload length and band the radios share are already right.
+ */
+static void SetScanRadio2Rate(uint8_t index)
+{
+    const expresslrs_mod_settings_s *const ModParams = get_elrs_airRateConfig(index);
+    const bool invertIQ = UID[5] & 0x01;
+
+    Radio.Config(ModParams->bw, ModParams->sf, ModParams->cr, RadioFreq(FHSSgetInitialFreq(), SX12XX_Radio_2),
+                 ModParams->PreambleLen, invertIQ, ModParams->PayloadLength
+#if defined(RADIO_SX128X)
+                 , uidMacSeedGet(), OtaCrcInitializer, (ModParams->radio_type == RADIO_TYPE_SX128x_FLRC), SX12XX_Radio_2
+#endif
+#if defined(RADIO_LR1121)
+                 , ModParams->radio_type == RADIO_TYPE_LR1121_GFSK_900 || ModParams->radio_type == RADIO_TYPE_LR1121_GFSK_2G4, (uint8_t)UID[5], (uint8_t)UID[4], SX12XX_Radio_2
+#endif
+                 );
+
+    // Wait for the slower of the two rates to cycle through the FHSS table
+    const uint32_t radio2CycleInterval = ((uint32_t)11U * FHSSgetChannelCount() * ModParams->FHSShopInterval * ModParams->interval) / (10U * 1000U);
+    if (radio2CycleInterval > cycleInterval)
+        cycleInterval = radio2CycleInterval;
+    rateScanRadio2 = index;
+}
+#endif
+
+// Set up the radio(s) for the next rate(s) to scan
+static void SetScanRates()
+{
+    uint8_t rate2;
+    SetRFLinkRate(rateScan.next(rate2), false);
+#if !defined(RADIO_SX127X)
+    if (rate2 != RATE_SCAN_NONE)
+        SetScanRadio2Rate(rate2);
+#endif
+}
+
 static void setupRadio()
 {
     Radio.currFreq = FHSSgetInitialFreq();
@@ -1682,16 +1872,8 @@ static void setupRadio()
     Radio.RXdoneCallback = &RXdoneISR;
     Radio.TXdoneCallback = &TXdoneISR;
 
-    scanIndex = config.GetRateInitialIdx();
-    for (int i=0 ; i<RATE_MAX ; i++)
-    {
-        if (isSupportedRFRate(scanIndex))
-        {
-            break;
-        }
-        scanIndex = (scanIndex + 1) % RATE_MAX;
-    }
-    SetRFLinkRate(scanIndex, false);
+    RateScanBegin(config.GetRateInitialIdx());
+    SetScanRates();
     // Start slow on the selected rate to give it the best chance
     // to connect before beginning rate cycling
     RFmodeCycleMultiplier = RFmodeCycleMultiplierSlow / 2;
@@ -1718,26 +1900,35 @@ static void cycleRfMode(unsigned long now)
     if (connectionState == connected || connectionState == wifiUpdate || InBindingMode)
         return;
 
+    // Radio 2 found the TX, the next sync packet comes in on both radios
+    const uint8_t hit = rateScanHit;
+    if (hit != RATE_SCAN_NONE)
+    {
+        rateScanHit = RATE_SCAN_NONE;
+        // Unless radio 1 got a sync of its own in the meantime
+        if (connectionState == disconnected && hit == rateScanRadio2)
+        {
+            RFmodeLastCycled = now;
+            LastSyncPacket = now;
+            SetRFLinkRate(hit, false);
+            Radio.RXnb();
+            DBGLN("scan hit %u", ExpressLRS_currAirRate_Modparams->interval);
+            return;
+        }
+    }
+
     // Actually cycle the RF mode if not LOCK_ON_FIRST_CONNECTION
     if (LockRFmode == false && (now - RFmodeLastCycled) > (cycleInterval * RFmodeCycleMultiplier))
     {
         RFmodeLastCycled = now;
         LastSyncPacket = now;           // reset this variable
         SendLinkStatstoFCForcedSends = 2;
-        SetRFLinkRate(scanIndex % RATE_MAX, false); // switch between rates
+        SetScanRates(); // switch between rates
         LQCalc.reset100();
         LQCalcDVDA.reset100();
         // Display the current air rate to the user as an indicator something is happening
-        scanIndex++;
         Radio.RXnb();
-        DBGLN("%u", ExpressLRS_currAirRate_Modparams->interval);
-
-        // Skip unsupported modes for hardware with only a single LR1121 or with a single RF path
-        while (!isSupportedRFRate(scanIndex % RATE_MAX))
-        {
-            DBGLN("Skip %u", get_elrs_airRateConfig(scanIndex % RATE_MAX)->interval);
-            scanIndex++;
-        }
+        DBGLN("%u %u", ExpressLRS_currAirRate_Modparams->interval, rateScanRadio2);
 
         // Switch to FAST_SYNC if not already in it (won't be if was just connected)
         RFmodeCycleMultiplier = 1;
@@ -1797,7 +1988,7 @@ static void ExitBindingMode()
     webserverPreventAutoStart = true;
 
     // Force RF cycling to start at the beginning immediately
-    scanIndex = RATE_MAX;
+    RateScanBegin(0);
     RFmodeLastCycled = 0;
     LockRFmode = false;
     LostConnection(false);
@@ -2059,11 +2250,13 @@ void resetConfigAndReboot()
 
 void setup()
 {
+    PROFILE_INIT();
+
     if (!options_init())
     {
         // In the failure case we set the logging to the null logger so nothing crashes
         // if it decides to log something
-        SerialLogger = new NullStream();
+        SerialLogger = &nullLogger;
 
         // Register the WiFi with the framework
         static device_affinity_t wifi_device[] = {
@@ -2093,7 +2286,7 @@ void setup()
         Serial.begin(serialBaud);
         SerialLogger = &Serial;
         #else
-        SerialLogger = new NullStream();
+        SerialLogger = &nullLogger;
         #endif
 
         // Init EEPROM and load config, checking powerup count
@@ -2141,7 +2334,8 @@ void setup()
             aj_cfg.allow_group_switch_suggestions = 1;
             
             size_t aj_size = aj_context_size_bytes(&aj_cfg);
-            static uint8_t aj_buffer[512]; // Static buffer
+            // Sized for the 100 packet window, word aligned as the context is accessed through it
+            static WORD_ALIGNED_ATTR uint8_t aj_buffer[1024];
             
             if (aj_size <= sizeof(aj_buffer)) {
                 aj_ctx_t* ctx = anti_jamming_init_with_buffer(aj_buffer, sizeof(aj_buffer), &aj_cfg);
@@ -2176,6 +2370,8 @@ void setup()
     // setup() eats up some of this time, which can cause the first mode connection to fail.
     // Resetting the time here give the first mode a better chance of connection.
     RFmodeLastCycled = millis();
+
+    AllocTracker::markSetupComplete();
 }
 
 #if defined(PLATFORM_ESP32_C3)
@@ -2239,6 +2435,7 @@ void loop()
         LastSyncPacket = now;
     }
 
+    RateSwitchComplete();
     cycleRfMode(now);
 
     uint32_t localLastValidPacket = LastValidPacket; // Required to prevent race condition due to LastValidPacket getting updated from ISR
@@ -5,6 +5,7 @@
 #include "dynpower.h"
 #include "msp.h"
 #include "msptypes.h"
+#include "profiler.h"
 #include "stubborn_receiver.h"
 #include "stubborn_sender.h"
 
@@ -32,7 +33,9 @@ void sendMAVLinkTelemetryToBackpack(uint8_t *) {}
 #include "CRSFRouter.h"
 #include "TXModuleEndpoint.h"
 #include "TXOTAConnector.h"
+#include "alloc_tracker.h"
 #include "MAVLink.h"
+#include "RateAdapt.h"
 
 #if defined(PLATFORM_ESP32_S3) || defined(PLATFORM_ESP32_C3)
 #include "USB.h"
@@ -84,6 +87,19 @@ uint32_t SyncPacketLastSent = 0;
 static enum { stbIdle, stbRequested, stbBoosting } syncTelemBoostState = stbIdle;
 ////////////////////////////////////////////////
 
+/// link rate adaptation vars ///
+#define RATE_SWITCH_MIN_LEAD 24         // nonces between deciding on a rate switch and making it
+#define RATE_SWITCH_ANNOUNCE_COUNT 6    // sync packets announcing the switch
+static RateAdaptPolicy rateAdapt;
+static volatile bool rateAdaptStatsUpdated;
+static volatile int8_t rateAdaptSnrScaled;
+static uint32_t rateAdaptLastStatsMs;
+static volatile uint8_t rateSwitchIndex = OTA_RATE_SWITCH_NONE;
+static volatile uint8_t rateSwitchNonce;
+static volatile uint8_t rateSwitchAnnounceCount;
+static volatile bool rateSwitchApplied;     // by the timer ISR, RateSwitchComplete() does the rest
+////////////////////////////////////////////////
+
 volatile uint32_t LastTLMpacketRecvMillis = 0;
 uint32_t TLMpacketReported = 0;
 static bool commitInProgress = false;
@@ -162,6 +178,8 @@ void ICACHE_RAM_ATTR LinkStatsFromOta(OTA_LinkStats_s * const ls)
 #endif
   linkStats.active_antenna = ls->antenna;
   connectionHasModelMatch = ls->modelMatch;
+  rateAdaptSnrScaled = snrScaled;
+  rateAdaptStatsUpdated = true;
   // -- downlink_SNR / downlink_RSSI is updated for any packet received, not just Linkstats
   // -- uplink_TX_Power is updated when sending to the handset, so it updates when missing telemetry
   // -- rf_mode is updated when we change rates
@@ -382,8 +400,10 @@ bool ICACHE_RAM_ATTR ProcessTLMpacket(SX12xxDriverCommon::rx_status const status
 expresslrs_tlm_ratio_e ICACHE_RAM_ATTR UpdateTlmRatioEffective()
 {
   expresslrs_tlm_ratio_e ratioConfigured = (expresslrs_tlm_ratio_e)config.GetTlm();
-  // default is suggested rate for TLM_RATIO_STD/TLM_RATIO_DISARMED
-  expresslrs_tlm_ratio_e retVal = ExpressLRS_currAirRate_Modparams->TLMinterval;
+  // default is suggested rate for TLM_RATIO_STD/TLM_RATIO_DISARMED, less often if the rate adaptation
+  // has run out of slower rates
+  expresslrs_tlm_ratio_e retVal = (expresslrs_tlm_ratio_e)std::max((int)TLM_RATIO_1_128,
+    (int)ExpressLRS_currAirRate_Modparams->TLMinterval - rateAdapt.tlmShift());
   bool updateTelemDenom = true;
 
   // TLM ratio is boosted until there is one complete sync cycle with no BoostRequest
@@ -425,13 +445,34 @@ expresslrs_tlm_ratio_e ICACHE_RAM_ATTR UpdateTlmRatioEffective()
   return retVal;
 }
 
+/**
+ * The rate the sync spam points the RX at. While the rate adaptation is running the current rate
+ * is kept, only a config change goes back to the configured rate.
+ */
+static uint8_t ICACHE_RAM_ATTR TargetRateIndex()
+{
+  if (rateAdapt.active() && !config.IsModified() && !ModelUpdatePending)
+    return ExpressLRS_currAirRate_Modparams->index;
+  return config.GetRate();
+}
+
+static bool ICACHE_RAM_ATTR RateSwitchAnnouncing()
+{
+  return rateSwitchAnnounceCount && rateSwitchIndex != OTA_RATE_SWITCH_NONE
+    && OtaRateSwitchNonce(OtaNonce) == rateSwitchNonce;
+}
+
 void ICACHE_RAM_ATTR GenerateSyncPacketData(OTA_Sync_s * const syncPtr)
 {
   const uint8_t SwitchEncMode = config.GetSwitchMode();
-  const uint8_t Index = (syncSpamCounter) ? config.GetRate() : ExpressLRS_currAirRate_Modparams->index;
+  const bool rateSwitch = rateSwitchIndex != OTA_RATE_SWITCH_NONE && OtaRateSwitchNonce(OtaNonce) == rateSwitchNonce;
+  const uint8_t Index = rateSwitch ? rateSwitchIndex :
+    (syncSpamCounter) ? TargetRateIndex() : ExpressLRS_currAirRate_Modparams->index;
 
   if (syncSpamCounter)
     --syncSpamCounter;
+  if (rateSwitch && rateSwitchAnnounceCount)
+    --rateSwitchAnnounceCount;
 
   if (syncSpamCounterAfterRateChange && Index == ExpressLRS_currAirRate_Modparams->index)
   {
@@ -451,6 +492,7 @@ void ICACHE_RAM_ATTR GenerateSyncPacketData(OTA_Sync_s * const syncPtr)
   syncPtr->newTlmRatio = newTlmRatio - TLM_RATIO_NO_TLM;
   syncPtr->geminiMode = isDualRadio() && config.GetAntennaMode() == TX_RADIO_MODE_GEMINI;
   syncPtr->otaProtocol = config.GetLinkMode();
+  syncPtr->rateSwitch = rateSwitch;
   syncPtr->UID4 = UID[4];
   syncPtr->UID5 = UID[5];
 
@@ -477,8 +519,8 @@ uint8_t adjustSwitchModeForAirRate(OtaSwitchMode_e eSwitchMode, uint8_t packetSi
 
 void SetRFLinkRate(uint8_t index) // Set speed of RF link
 {
-  expresslrs_mod_settings_s *const ModParams = get_elrs_airRateConfig(index);
-  expresslrs_rf_pref_params_s *const RFperf = get_elrs_RFperfParams(index);
+  const expresslrs_mod_settings_s *const ModParams = get_elrs_airRateConfig(index);
+  const expresslrs_rf_pref_params_s *const RFperf = get_elrs_RFperfParams(index);
   // Binding always uses invertIQ
   bool invertIQ = InBindingMode || (UID[5] & 0x01);
   OtaSwitchMode_e newSwitchMode = (OtaSwitchMode_e)config.GetSwitchMode();
@@ -504,6 +546,7 @@ void SetRFLinkRate(uint8_t index) // Set speed of RF link
   interval = interval * 12 / 10; // increase the packet interval by 20% to allow adding packet header
 #endif
   hwTimer::updateInterval(interval);
+  PROFILE_SET_INTERVAL(interval);
 
   FHSSusePrimaryFreqBand = !(ModParams->radio_type == RADIO_TYPE_LR1121_LORA_2G4) && !(ModParams->radio_type == RADIO_TYPE_LR1121_GFSK_2G4);
   FHSSuseDualBand = ModParams->radio_type == RADIO_TYPE_LR1121_LORA_DUAL;
@@ -530,10 +573,12 @@ void SetRFLinkRate(uint8_t index) // Set speed of RF link
 
   Radio.FuzzySNRThreshold = (RFperf->DynpowerSnrThreshUp == DYNPOWER_SNR_THRESH_NONE) ? 0 : (RFperf->DynpowerSnrThreshUp - RFperf->DynpowerSnrThreshDn);
 
-  if ((isDualRadio() && config.GetAntennaMode() == TX_RADIO_MODE_GEMINI) || FHSSuseDualBand) // Gemini mode
+  const bool gemini = (isDualRadio() && config.GetAntennaMode() == TX_RADIO_MODE_GEMINI) || FHSSuseDualBand;
+  if (gemini) // Gemini mode
   {
     Radio.SetFrequencyReg(FHSSgetInitialGeminiFreq(), SX12XX_Radio_2, false);
   }
+  LbtSetInitialChannels(gemini);
 
   // InitialFreq has been set, so lets also reset the FHSS Idx and Nonce.
   FHSSsetCurrIndex(0);
@@ -552,8 +597,72 @@ void SetRFLinkRate(uint8_t index) // Set speed of RF link
   rfModeLastChangedMS = millis();
 }
 
+/**
+ * The part of an announced rate switch that has to happen on the nonce, from the timer ISR: the
+ * modulation, the timer interval and the FHSS. The nonce is kept, the RX changes on the same one.
+ * isRateSwitchCompatible() keeps the packet format, so the serializers stay as they are.
+ */
+static void ICACHE_RAM_ATTR ApplyRateSwitch()
+{
+  const expresslrs_mod_settings_s *const ModParams = get_elrs_airRateConfig(rateSwitchIndex);
+  uint32_t interval = ModParams->interval;
+#if defined(DEBUG_FREQ_CORRECTION) && defined(RADIO_SX128X)
+  interval = interval * 12 / 10; // increase the packet interval by 20% to allow adding packet header
+#endif
+  hwTimer::updateInterval(interval);
+
+#if defined(RADIO_LR1121)
+  if (FHSSuseDualBand)
+  {
+    Radio.SetModulation(ModParams->bw, ModParams->sf, ModParams->cr, ModParams->PreambleLen, SX12XX_Radio_1);
+    Radio.SetModulation(ModParams->bw2, ModParams->sf2, ModParams->cr2, ModParams->PreambleLen2, SX12XX_Radio_2);
+  }
+  else
+#endif
+  {
+    Radio.SetModulation(ModParams->bw, ModParams->sf, ModParams->cr, ModParams->PreambleLen, SX12XX_Radio_All);
+  }
+
+  Radio.SetFrequencyReg(FHSSgetInitialFreq(), SX12XX_Radio_All, false);
+  const bool gemini = (isDualRadio() && config.GetAntennaMode() == TX_RADIO_MODE_GEMINI) || FHSSuseDualBand;
+  if (gemini) // Gemini mode
+  {
+    Radio.SetFrequencyReg(FHSSgetInitialGeminiFreq(), SX12XX_Radio_2, false);
+  }
+  LbtSetInitialChannels(gemini);
+  FHSSsetCurrIndex(0);
+
+  ExpressLRS_currAirRate_Modparams = ModParams;
+  ExpressLRS_currAirRate_RFperfParams = get_elrs_RFperfParams(rateSwitchIndex);
+  rateSwitchApplied = true;
+  rateSwitchIndex = OTA_RATE_SWITCH_NONE;
+}
+
+// The rest of an announced rate switch, from the loop
+static void RateSwitchComplete()
+{
+  if (!rateSwitchApplied)
+    return;
+  rateSwitchApplied = false;
+
+  const expresslrs_mod_settings_s *const ModParams = ExpressLRS_currAirRate_Modparams;
+  const expresslrs_rf_pref_params_s *const RFperf = ExpressLRS_currAirRate_RFperfParams;
+  DBGLN("rate switch %u", ModParams->index);
+  uint32_t interval = ModParams->interval;
+#if defined(DEBUG_FREQ_CORRECTION) && defined(RADIO_SX128X)
+  interval = interval * 12 / 10;
+#endif
+  PROFILE_SET_INTERVAL(interval);
+  Radio.FuzzySNRThreshold = (RFperf->DynpowerSnrThreshUp == DYNPOWER_SNR_THRESH_NONE) ? 0 : (RFperf->DynpowerSnrThreshUp - RFperf->DynpowerSnrThreshDn);
+  linkStats.rf_Mode = ModParams->enum_rate;
+  handset->setPacketInterval(interval * ModParams->numOfSends);
+  LbtEnableIfRequired();
+}
+
 void ICACHE_RAM_ATTR SendRCdataToRF()
 {
+  PROFILE_SCOPE(PROFILE_SEND_RC);
+
   // Do not send a stale channels packet to the RX if one has not been received from the handset
   // *Do* send data if a packet has never been received from handset and the timer is running
   // this is the case when bench testing and TXing without a handset
@@ -589,7 +698,7 @@ void ICACHE_RAM_ATTR SendRCdataToRF()
   uint8_t NonceFHSSresult = OtaNonce % ExpressLRS_currAirRate_Modparams->FHSShopInterval;
 
   // Sync spam only happens on slot 1 and 2 and can't be disabled
-  if ((syncSpamCounter || (syncSpamCounterAfterRateChange && FHSSonSyncChannel())) && (NonceFHSSresult == 1 || NonceFHSSresult == 2))
+  if ((syncSpamCounter || RateSwitchAnnouncing() || (syncSpamCounterAfterRateChange && FHSSonSyncChannel())) && (NonceFHSSresult == 1 || NonceFHSSresult == 2))
   {
     otaPkt.std.type = PACKET_TYPE_SYNC;
     GenerateSyncPacketData(OtaIsFullRes ? &otaPkt.full.sync.sync : &otaPkt.std.sync);
@@ -704,6 +813,8 @@ void ICACHE_RAM_ATTR nonceAdvance()
  */
 void ICACHE_RAM_ATTR timerCallback()
 {
+  PROFILE_SCOPE(PROFILE_TIMER_TOCK);
+
   /* If we are busy writing to EEPROM (committing config changes) then we just advance the nonces, i.e. no SPI traffic */
   if (commitInProgress)
   {
@@ -733,6 +844,10 @@ void ICACHE_RAM_ATTR timerCallback()
   if (!InBindingMode)
     OtaNonce++;
 
+  // Announced rate switch, the RX changes on the same nonce
+  if (rateSwitchIndex != OTA_RATE_SWITCH_NONE && OtaNonce == rateSwitchNonce)
+    ApplyRateSwitch();
+
   // If HandleTLM has started Receive mode, TLM packet reception should begin shortly
   // Skip transmitting on this slot
   if (TelemetryRcvPhase == ttrpPreReceiveGap)
@@ -806,11 +921,48 @@ void ResetPower()
   // TLM interval is set on the next SYNC packet
 }
 
+/**
+ * Build the rate adaptation ladder from the configured rate down. Only rates that can be switched
+ * to in place are used, see isRateSwitchCompatible().
+ */
+static void RateAdaptBegin()
+{
+  rateSwitchIndex = OTA_RATE_SWITCH_NONE;
+  rateSwitchAnnounceCount = 0;
+  if (!firmwareOptions.rate_adapt)
+  {
+    rateAdapt.begin(nullptr, 0, millis());
+    return;
+  }
+
+  const expresslrs_mod_settings_s *const configured = get_elrs_airRateConfig(config.GetRate());
+  rateAdaptRate_t rates[RATE_ADAPT_MAX_RATES];
+  uint8_t count = 0;
+  for (uint8_t index = 0; index < RATE_MAX && count < RATE_ADAPT_MAX_RATES; index++)
+  {
+    const expresslrs_mod_settings_s *const ModParams = get_elrs_airRateConfig(index);
+    if (ModParams->interval < configured->interval || !isRateSwitchCompatible(config.GetRate(), index))
+      continue;
+
+    // Insert by interval, fastest first
+    const expresslrs_rf_pref_params_s *const RFperf = get_elrs_RFperfParams(index);
+    uint8_t pos = count++;
+    for (; pos > 0 && get_elrs_airRateConfig(rates[pos - 1].index)->interval > ModParams->interval; pos--)
+      rates[pos] = rates[pos - 1];
+    rates[pos].index = index;
+    rates[pos].sensitivity = RFperf->RXsensitivity;
+    rates[pos].snrThreshold = RFperf->DynpowerSnrThreshUp;
+  }
+  rateAdapt.begin(rates, count, millis());
+  DBGLN("rate adapt: %u rates", count);
+}
+
 static void ChangeRadioParams()
 {
   ModelUpdatePending = false;
   ResetPower(); // Call before SetRFLinkRate(). The LR1121 Radio lib can now set the correct output power in Config().
   SetRFLinkRate(config.GetRate());
+  RateAdaptBegin();
   LbtEnableIfRequired();
 }
 
@@ -851,6 +1003,57 @@ static void ConfigChangeCommit()
   devicesTriggerEvent(changes);
 }
 
+static void RateAdapt_Update(uint32_t now)
+{
+  if (!rateAdapt.active() || connectionState != connected || config.IsModified() || ModelUpdatePending
+    || rateSwitchIndex != OTA_RATE_SWITCH_NONE)
+  {
+    rateAdaptStatsUpdated = false;
+    rateAdaptLastStatsMs = now;
+    return;
+  }
+
+  bool changed;
+  if (rateAdaptStatsUpdated)
+  {
+    rateAdaptStatsUpdated = false;
+    rateAdaptLastStatsMs = now;
+    rateAdaptSample_t sample;
+    sample.lq = linkStats.uplink_Link_quality;
+    sample.rssi = linkStats.active_antenna ? linkStats.uplink_RSSI_2 : linkStats.uplink_RSSI_1;
+    sample.snr = rateAdaptSnrScaled;
+    changed = rateAdapt.update(now, sample);
+  }
+  else
+  {
+    // The link statistics come in a few telemetry slots, allow for the slowest telemetry ratio
+    const uint32_t msStatsTimeout = std::max((uint32_t)512U,
+      (uint32_t)ExpressLRS_currTlmDenom * ExpressLRS_currAirRate_Modparams->interval / (1000U / 4U));
+    if (now - rateAdaptLastStatsMs <= msStatsTimeout)
+      return;
+    rateAdaptLastStatsMs = now;
+    changed = rateAdapt.missed(now);
+  }
+
+  if (!changed)
+    return;
+  DBGLN("rate adapt: level %u", rateAdapt.level());
+  // A telemetry ratio change goes out in the next sync packet
+  const uint8_t index = rateAdapt.rateIndex();
+  if (index == ExpressLRS_currAirRate_Modparams->index)
+    return;
+
+  // Switch at the end of the nonce block, or the next one if there is not enough time to announce it
+  const uint8_t nonce = OtaNonce;
+  uint8_t switchNonce = OtaRateSwitchNonce(nonce);
+  if ((uint8_t)(switchNonce - nonce) < RATE_SWITCH_MIN_LEAD)
+    switchNonce += OTA_RATE_SWITCH_BLOCK;
+  rateSwitchNonce = switchNonce;
+  rateSwitchAnnounceCount = RATE_SWITCH_ANNOUNCE_COUNT;
+  // Set last, the timer ISR acts on it
+  rateSwitchIndex = index;
+}
+
 static void CheckConfigChangePending()
 {
   if (config.IsModified() || ModelUpdatePending)
@@ -858,6 +1061,9 @@ static void CheckConfigChangePending()
     // Keep transmitting sync packets until the spam counter runs out
     if (syncSpamCounter > 0)
       return;
+    // Let an announced rate switch happen first, the RX is expecting it
+    if (rateSwitchIndex != OTA_RATE_SWITCH_NONE)
+      return;
 
     // wait until no longer transmitting
     while (busyTransmitting);
@@ -878,6 +1084,8 @@ static void CheckConfigChangePending()
 
 bool ICACHE_RAM_ATTR RXdoneISR(SX12xxDriverCommon::rx_status const status)
 {
+  PROFILE_SCOPE(PROFILE_RX_DONE);
+
   // busyTransmitting is required here to prevent accidental rxdone IRQs due to interference triggering RXdoneISR.
   if (LQCalc.currentIsSet() || busyTransmitting)
   {
@@ -891,6 +1099,8 @@ bool ICACHE_RAM_ATTR RXdoneISR(SX12xxDriverCommon::rx_status const status)
 
 void ICACHE_RAM_ATTR TXdoneISR()
 {
+  PROFILE_SCOPE(PROFILE_TX_DONE);
+
   if (!busyTransmitting)
   {
     return; // Already finished transmission and do not call HandleFHSS() a second time, which may hop the frequency!
@@ -923,10 +1133,12 @@ void ICACHE_RAM_ATTR TXdoneISR()
           Radio.SetFrequencyReg(FHSSgetNextFreq(), SX12XX_Radio_1, doRx);
           Radio.SetFrequencyReg(FHSSgetGeminiFreq(), SX12XX_Radio_2, doRx);
         }
+        LbtSetChannels(FHSSgetCurrChannel(), FHSSgetCurrGeminiChannel());
       }
       else
       {
         Radio.SetFrequencyReg(FHSSgetNextFreq(), SX12XX_Radio_All, doRx);
+        LbtSetChannels(FHSSgetCurrChannel(), FHSSgetCurrChannel());
       }
     }
     else if (doRx)
@@ -1092,6 +1304,7 @@ static void ExitBindingMode()
   UARTconnected();
 
   SetRFLinkRate(config.GetRate()); //return to original rate
+  RateAdaptBegin();
 
   DBGLN("Exiting binding mode");
 }
@@ -1124,7 +1337,7 @@ void ProcessMSPPacket(uint32_t now, mspPacket_t *packet)
       break;
     }
   }
-  else if (packet->function == MSP_SET_VTX_CONFIG)
+  else if (packet->function == MSP_SET_VTX_CONFIG && packet->payloadSize >= 1)
   {
     if (packet->payload[0] < 48) // Standard 48 channel VTx table size e.g. A, B, E, F, R, L
     {
@@ -1141,7 +1354,7 @@ void ProcessMSPPacket(uint32_t now, mspPacket_t *packet)
   {
     processPanTiltRollPacket(now, packet);
   }
-  if (packet->function == MSP_ELRS_GET_BACKPACK_VERSION)
+  if (packet->function == MSP_ELRS_GET_BACKPACK_VERSION && packet->payloadSize > 0)
   {
     memset(backpackVersion, 0, sizeof(backpackVersion));
     memcpy(backpackVersion, packet->payload, min((size_t)packet->payloadSize, sizeof(backpackVersion)-1));
@@ -1410,6 +1623,8 @@ static void cyclePower()
 
 void setup()
 {
+  PROFILE_INIT();
+
   if (setupHardwareFromOptions())
   {
     setupTarget();
@@ -1495,6 +1710,8 @@ void setup()
     config.SetMotionMode(0); // Ensure motion detection is off
     UARTconnected();
   }
+
+  AllocTracker::markSetupComplete();
 }
 
 void loop()
@@ -1538,6 +1755,8 @@ void loop()
   CheckReadyToSend();
   CheckConfigChangePending();
   DynamicPower_Update(now);
+  RateSwitchComplete();
+  RateAdapt_Update(now);
   VtxPitmodeSwitchUpdate();
 
   /* Send TLM updates to handset if connected + reporting period
@@ -0,0 +1,76 @@
+#include <unity.h>
+#include "AcceptEncoding.h"
+
+/*
+ * The same headers give the same answer from python/web_assets.py accepts_brotli()
+ */
+
+typedef struct {
+    const char *header;
+    bool brotli;
+} acceptEncodingCase_t;
+
+static const acceptEncodingCase_t cases[] = {
+    {"", false},
+    {"gzip, deflate", false},
+    {"gzip, deflate, br", true},
+    {"gzip, deflate, br, zstd", true},
+    {"br", true},
+    {"BR", true},
+    {" br ", true},
+    {"gzip,br", true},
+    {"br;q=1", true},
+    {"br;q=0.5", true},
+    {"br ; q = 0.001", true},
+    {"br;Q=1.000", true},
+    {"br;q=0", false},
+    {"br;q=0.0", false},
+    {"br;q=0.000", false},
+    {"br; q=0 ", false},
+    {"gzip;q=1.0, br;q=0", false},
+    // malformed qvalues
+    {"br;q=", false},
+    {"br;q=2", false},
+    {"br;q=1.5", false},
+    {"br;q=0.0001", false},
+    {"br;q=.5", false},
+    {"br;q=abc", false},
+    // other parameters and codings that only contain br
+    {"br;level=0", true},
+    {"br;level=1;q=0", false},
+    {"br;q=0.5;q=0", true},
+    {"brotli", false},
+    {"xbr, gzip", false},
+    {"gzip;q=br", false},
+    {"*", false},
+    // the first br counts
+    {"br;q=0, br", false},
+    {"br, br;q=0", true},
+};
+
+void test_accept_encoding()
+{
+    for (const auto &c : cases)
+    {
+        TEST_ASSERT_EQUAL(c.brotli, acceptsBrotli(c.header));
+    }
+}
+
+void test_no_header()
+{
+    TEST_ASSERT_FALSE(acceptsBrotli(nullptr));
+}
+
+// Unity setup/teardown
+void setUp() {}
+void tearDown() {}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_accept_encoding);
+    RUN_TEST(test_no_header);
+    UNITY_END();
+
+    return 0;
+}
@@ -0,0 +1,72 @@
+// The LR1121's rows have the second band, for this file only
+#define RADIO_LR1121 1
+
+#include <cstdint>
+#include <unity.h>
+#include "test_airtime.h"
+#include "common.h"
+#include "helpers.h"
+// LR1121Driver is not built natively, only its register values are used here
+#include "../../lib/LR1121Driver/LR1121_Regs.h"
+#include "AirRatesLR1121.h"
+
+#define NF AIRTIME_NOISE_FIGURE_DB
+#define NF2G4 AIRTIME_NOISE_FIGURE_2G4_DB
+
+static const airRateCase_t lr1121Rates[] = {
+    {AIRRATE_MEASURED, 0,      0, 0, false, 16, PL8, 0,    658},
+    {AIRRATE_LORA,     5, 500000, 8, false,  8, PL4, NF,  2960},
+    {AIRRATE_LORA,     5, 500000, 7, false,  8, PL8, NF,  3664},
+    {AIRRATE_LORA,     6, 500000, 7, false,  8, PL4, NF,  4640},
+    {AIRRATE_LORA,     6, 500000, 8, false,  8, PL8, NF,  6944},
+    {AIRRATE_LORA,     7, 500000, 7, false,  8, PL4, NF,  8768},
+    {AIRRATE_LORA,     8, 500000, 7, false, 10, PL4, NF, 18560},
+    {AIRRATE_LORA,     9, 500000, 7, false, 10, PL4, NF, 29952},
+    {AIRRATE_LORA,     6, 500000, 7, false,  8, PL4, NF,  4640},
+    {AIRRATE_MEASURED, 0,      0, 0, false, 16, PL4, 0,    690},
+    {AIRRATE_MEASURED, 0,      0, 0, false, 16, PL4, 0,    690},
+    {AIRRATE_MEASURED, 0,      0, 0, false, 16, PL4, 0,    690},
+    {AIRRATE_LORA,     5, 812500, 6, true,  12, PL4, NF2G4, 1507},
+    {AIRRATE_LORA,     5, 812500, 8, true,  12, PL8, NF2G4, 2373},
+    {AIRRATE_LORA,     6, 812500, 8, true,  14, PL4, NF2G4, 3328},
+    {AIRRATE_LORA,     7, 812500, 8, true,  12, PL4, NF2G4, 5869},
+    {AIRRATE_LORA,     7, 812500, 8, true,  12, PL8, NF2G4, 7602},
+    {AIRRATE_LORA,     8, 812500, 8, true,  12, PL4, NF2G4, 10792},
+};
+
+// The dual band rows, the sub-GHz band then the 2.4GHz one
+static const airRateCase_t lr1121DualRates[][2] = {
+    {{AIRRATE_LORA, 6, 500000, 8, false, 12, PL4, NF, 5408}, {AIRRATE_LORA, 7, 812500, 6, true, 12, PL4, NF2G4, 5081}},
+    {{AIRRATE_LORA, 6, 500000, 8, false, 18, PL8, NF, 8224}, {AIRRATE_LORA, 7, 812500, 8, true, 14, PL8, NF2G4, 7917}},
+};
+
+void test_lr1121_table(void)
+{
+    const uint8_t single = ARRAY_SIZE(lr1121Rates);
+    TEST_ASSERT_EQUAL(single + ARRAY_SIZE(lr1121DualRates), ARRAY_SIZE(ExpressLRS_AirRateConfig));
+    TEST_ASSERT_EQUAL(single + ARRAY_SIZE(lr1121DualRates), ARRAY_SIZE(ExpressLRS_AirRateRFperf));
+    for (uint8_t i = 0; i < single; i++)
+        checkAirRate(lr1121Rates[i], AIRTIME_LORA_SX126X, ExpressLRS_AirRateConfig[i], ExpressLRS_AirRateRFperf[i]);
+
+    // Both radios send at once, the packet takes as long as the slower band and is only received
+    // as well as on the less sensitive one
+    for (uint8_t i = 0; i < ARRAY_SIZE(lr1121DualRates); i++)
+    {
+        const airRateCase_t &band1 = lr1121DualRates[i][0];
+        const airRateCase_t &band2 = lr1121DualRates[i][1];
+        const expresslrs_mod_settings_s &config = ExpressLRS_AirRateConfig[single + i];
+        const expresslrs_rf_pref_params_s &perf = ExpressLRS_AirRateRFperf[single + i];
+        TEST_ASSERT_EQUAL(band1.toa, airRateCaseToaUs(band1, AIRTIME_LORA_SX126X));
+        TEST_ASSERT_EQUAL(band2.toa, airRateCaseToaUs(band2, AIRTIME_LORA_SX126X));
+        TEST_ASSERT_EQUAL(band1.preamble, config.PreambleLen);
+        TEST_ASSERT_EQUAL(band2.preamble, config.PreambleLen2);
+        TEST_ASSERT_EQUAL(band1.payloadLen, config.PayloadLength);
+        TEST_ASSERT_EQUAL(band1.toa > band2.toa ? band1.toa : band2.toa, perf.TOA);
+        const double worse = std::max(airRateCaseSensitivityDbm(band1), airRateCaseSensitivityDbm(band2));
+        TEST_ASSERT_EQUAL(AirTimeSensitivityDbm(worse), perf.RXsensitivity);
+        TEST_ASSERT_TRUE(config.interval >= (int32_t)AirTimeMinIntervalUs(perf.TOA));
+    }
+    // SF5 in 500kHz: -174 + 10log10(500k) + 6 + 2.5, SF5 in 812.5kHz: -174 + 10log10(812.5k) + 10 + 2.5
+    TEST_ASSERT_EQUAL(-113, ExpressLRS_AirRateRFperf[1].RXsensitivity);
+    TEST_ASSERT_EQUAL(-107, ExpressLRS_AirRateRFperf[12].RXsensitivity);
+}
@@ -0,0 +1,30 @@
+#include <cstdint>
+#include <unity.h>
+#include "test_airtime.h"
+#include "common.h"
+#include "helpers.h"
+// SX127xDriver is not built natively, only its register values are used here
+#include "../../lib/SX127xDriver/SX127xRegs.h"
+#include "AirRatesSX127x.h"
+
+#define NF AIRTIME_NOISE_FIGURE_DB
+
+static const airRateCase_t sx127xRates[] = {
+    {AIRRATE_LORA, 6, 500000, 7, false,  8, PL4, NF,  4384},
+    {AIRRATE_LORA, 6, 500000, 8, false,  8, PL8, NF,  6688},
+    {AIRRATE_LORA, 7, 500000, 7, false,  8, PL4, NF,  8768},
+    {AIRRATE_LORA, 8, 500000, 7, false, 10, PL4, NF, 18560},
+    {AIRRATE_LORA, 9, 500000, 7, false, 10, PL4, NF, 29952},
+    {AIRRATE_LORA, 6, 500000, 7, false,  8, PL4, NF,  4384},
+};
+
+void test_sx127x_table(void)
+{
+    TEST_ASSERT_EQUAL(ARRAY_SIZE(sx127xRates), ARRAY_SIZE(ExpressLRS_AirRateConfig));
+    TEST_ASSERT_EQUAL(ARRAY_SIZE(sx127xRates), ARRAY_SIZE(ExpressLRS_AirRateRFperf));
+    for (uint8_t i = 0; i < ARRAY_SIZE(sx127xRates); i++)
+        checkAirRate(sx127xRates[i], AIRTIME_LORA_SX127X, ExpressLRS_AirRateConfig[i], ExpressLRS_AirRateRFperf[i]);
+    // -174 + 10log10(500k) + 6 - 2.5 * (sf - 4), whole dB towards 0
+    TEST_ASSERT_EQUAL(-116, ExpressLRS_AirRateRFperf[0].RXsensitivity);
+    TEST_ASSERT_EQUAL(-123, ExpressLRS_AirRateRFperf[4].RXsensitivity);
+}
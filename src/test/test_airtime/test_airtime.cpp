@@ -0,0 +1,102 @@
+#include <cstdint>
+#include <unity.h>
+#include "test_airtime.h"
+#include "common.h"
+#include "helpers.h"
+#include "SX1280_Regs.h"
+#include "AirRatesSX128x.h"
+
+#define NF2G4 AIRTIME_NOISE_FIGURE_2G4_DB
+
+static const airRateCase_t sx128xRates[] = {
+    {AIRRATE_FLRC, 0, 650000, 2, false, 32, PL4, NF2G4,   388},
+    {AIRRATE_FLRC, 0, 650000, 2, false, 32, PL4, NF2G4,   388},
+    {AIRRATE_FLRC, 0, 650000, 2, false, 32, PL4, NF2G4,   388},
+    {AIRRATE_FLRC, 0, 650000, 2, false, 32, PL4, NF2G4,   388},
+    {AIRRATE_LORA, 5, 812500, 6, true,  12, PL4, NF2G4,  1507},
+    {AIRRATE_LORA, 5, 812500, 8, true,  12, PL8, NF2G4,  2373},
+    {AIRRATE_LORA, 6, 812500, 8, true,  14, PL4, NF2G4,  3328},
+    {AIRRATE_LORA, 7, 812500, 8, true,  12, PL4, NF2G4,  5869},
+    {AIRRATE_LORA, 7, 812500, 8, true,  12, PL8, NF2G4,  7602},
+    {AIRRATE_LORA, 8, 812500, 8, true,  12, PL4, NF2G4, 10792},
+};
+
+void test_sx128x_table(void)
+{
+    TEST_ASSERT_EQUAL(ARRAY_SIZE(sx128xRates), ARRAY_SIZE(ExpressLRS_AirRateConfig));
+    TEST_ASSERT_EQUAL(ARRAY_SIZE(sx128xRates), ARRAY_SIZE(ExpressLRS_AirRateRFperf));
+    for (uint8_t i = 0; i < ARRAY_SIZE(sx128xRates); i++)
+        checkAirRate(sx128xRates[i], AIRTIME_LORA_SX126X, ExpressLRS_AirRateConfig[i], ExpressLRS_AirRateRFperf[i]);
+    // FLRC -174 + 10log10(650k) + 10 + 2, LoRa -174 + 10log10(812.5k) + 10 - 2.5 * (sf - 4)
+    TEST_ASSERT_EQUAL(-103, ExpressLRS_AirRateRFperf[0].RXsensitivity);
+    TEST_ASSERT_EQUAL(-107, ExpressLRS_AirRateRFperf[4].RXsensitivity);
+    TEST_ASSERT_EQUAL(-114, ExpressLRS_AirRateRFperf[9].RXsensitivity);
+}
+
+void test_min_interval(void)
+{
+    // The packet and the turnaround
+    TEST_ASSERT_EQUAL(4384 + AIRTIME_TURNAROUND_US, AirTimeMinIntervalUs(4384));
+    TEST_ASSERT_TRUE(5000 >= AirTimeMinIntervalUs(AirTimeLoRaUs(AIRTIME_LORA_SX127X, 6, 500000, 7, false, 8, PL4)));
+    TEST_ASSERT_FALSE(4000 >= AirTimeMinIntervalUs(AirTimeLoRaUs(AIRTIME_LORA_SX127X, 6, 500000, 7, false, 8, PL4)));
+}
+
+void test_lora_reference(void)
+{
+    // SF12 125kHz sets the low data rate optimisation, a symbol is 32.768ms. The 8 byte payload
+    // fits in the first 8 symbols and one more block of 5: 12.25 + 8 + 5 symbols
+    TEST_ASSERT_TRUE(AirTime::lowDataRate(12, 125000));
+    TEST_ASSERT_FALSE(AirTime::lowDataRate(10, 125000));
+    TEST_ASSERT_EQUAL(827392, AirTimeLoRaUs(AIRTIME_LORA_SX127X, 12, 125000, 5, false, 8, 8));
+    // More payload or preamble never takes less time
+    uint32_t last = 0;
+    for (uint8_t len = 1; len < 64; len++)
+    {
+        const uint32_t toa = AirTimeLoRaUs(AIRTIME_LORA_SX126X, 7, 812500, 8, true, 12, len);
+        TEST_ASSERT_TRUE(toa >= last);
+        last = toa;
+    }
+    TEST_ASSERT_TRUE(AirTimeLoRaUs(AIRTIME_LORA_SX126X, 7, 500000, 7, false, 12, 8) > AirTimeLoRaUs(AIRTIME_LORA_SX126X, 7, 500000, 7, false, 8, 8));
+}
+
+void test_flrc_toa(void)
+{
+    // 650kbps CR 1/2, 32 bit preamble, 3 byte CRC
+    TEST_ASSERT_EQUAL(388, AirTimeFlrcUs(650000, 1, 2, 32, PL4, 3));
+    TEST_ASSERT_TRUE(1000 >= AirTimeMinIntervalUs(AirTimeFlrcUs(650000, 1, 2, 32, PL4, 3)));
+    // Uncoded has no tail
+    TEST_ASSERT_EQUAL(117, AirTimeFlrcUs(1300000, 1, 1, 32, PL4, 3));
+}
+
+void test_sensitivity(void)
+{
+    // -174 + 10log10(500k) = -117, SF7 demodulates at -7.5dB
+    TEST_ASSERT_FLOAT_WITHIN(0.05, -124.5 + 6, LoRaSensitivityDbm(7, 500000, 6));
+    TEST_ASSERT_FLOAT_WITHIN(0.05, -174 + 59.1 - 2.5, LoRaSensitivityDbm(5, 812500, 0));
+    // Each SF step is 2.5dB
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 2.5, LoRaSensitivityDbm(8, 500000, 6) - LoRaSensitivityDbm(9, 500000, 6));
+}
+
+// Evaluated by the compiler, as the tables use them
+static_assert(AirTimeLoRaUs(AIRTIME_LORA_SX127X, 6, 500000, 7, false, 8, PL4) == 4384, "constexpr LoRa airtime");
+static_assert(AirTimeFlrcUs(650000, 1, 2, 32, PL4, 3) == 388, "constexpr FLRC airtime");
+static_assert(LoRaSensitivityDbm(9, 500000, 6) < -123, "constexpr sensitivity");
+
+// Unity setup/teardown
+void setUp() {}
+void tearDown() {}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_sx127x_table);
+    RUN_TEST(test_lr1121_table);
+    RUN_TEST(test_sx128x_table);
+    RUN_TEST(test_min_interval);
+    RUN_TEST(test_lora_reference);
+    RUN_TEST(test_flrc_toa);
+    RUN_TEST(test_sensitivity);
+    UNITY_END();
+
+    return 0;
+}
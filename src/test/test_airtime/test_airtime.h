@@ -0,0 +1,68 @@
+#pragma once
+
+#include <stdint.h>
+#include <unity.h>
+#include "AirTime.h"
+
+/*
+ * Each radio's air rate table is checked row by row in its own file: the tables have the same
+ * names, and the LR1121's rows have a second band. For each row the case below has the modulation
+ * and the time on air worked out by hand from the datasheet formulas.
+ */
+
+// The radio drivers are not included for the tables, they all have this scale
+#define RADIO_SNR_SCALE 4
+
+// The payload sizes from OTA.h
+#define PL4 8
+#define PL8 13
+
+typedef enum : uint8_t {
+    AIRRATE_LORA,
+    AIRRATE_FLRC,
+    AIRRATE_MEASURED,   // GFSK, the time on air and the sensitivity are measured
+} airRateKind_e;
+
+typedef struct {
+    airRateKind_e kind;
+    uint8_t sf;
+    uint32_t bw;            // Hz, or the bitrate for FLRC
+    uint8_t crDen;          // FLRC is CR 1/crDen
+    bool li;
+    uint8_t preamble;       // symbols, or bits for FLRC
+    uint8_t payloadLen;
+    uint8_t noiseFigureDb;
+    uint32_t toa;           // expected
+} airRateCase_t;
+
+static uint32_t airRateCaseToaUs(const airRateCase_t &c, airtimeLoRaFamily_e family)
+{
+    return c.kind == AIRRATE_FLRC ? AirTimeFlrcUs(c.bw, 1, c.crDen, c.preamble, c.payloadLen, 3)
+         : AirTimeLoRaUs(family, c.sf, c.bw, c.crDen, c.li, c.preamble, c.payloadLen);
+}
+
+static double airRateCaseSensitivityDbm(const airRateCase_t &c)
+{
+    return c.kind == AIRRATE_FLRC ? FlrcSensitivityDbm(c.bw, c.noiseFigureDb)
+         : LoRaSensitivityDbm(c.sf, c.bw, c.noiseFigureDb);
+}
+
+// The row has the time on air and the sensitivity the calculator gives for its case
+template <typename Config, typename Perf>
+static void checkAirRate(const airRateCase_t &c, airtimeLoRaFamily_e family, const Config &config, const Perf &perf)
+{
+    TEST_ASSERT_EQUAL(c.payloadLen, config.PayloadLength);
+    TEST_ASSERT_EQUAL(c.toa, perf.TOA);
+    if (c.kind != AIRRATE_MEASURED)
+    {
+        TEST_ASSERT_EQUAL(c.preamble, config.PreambleLen);
+        TEST_ASSERT_EQUAL(c.toa, airRateCaseToaUs(c, family));
+        TEST_ASSERT_EQUAL(AirTimeSensitivityDbm(airRateCaseSensitivityDbm(c)), perf.RXsensitivity);
+    }
+    // The packet and the turnaround fit the interval
+    TEST_ASSERT_TRUE(config.interval >= (int32_t)AirTimeMinIntervalUs(perf.TOA));
+}
+
+void test_sx127x_table(void);
+void test_lr1121_table(void);
+void test_sx128x_table(void);
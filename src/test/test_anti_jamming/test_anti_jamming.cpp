@@ -0,0 +1,325 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <SX1280_Regs.h>
+#include <FHSS.h>
+#include <unity.h>
+#include "anti_jamming.h"
+#include "aj_switch.h"
+
+/*
+ * Deterministic replay of packet and switch traces through the anti-jamming integration layer.
+ *
+ * A trace is a list of timestamped events: packet good/bad from the radio, and CH5 (enable)
+ * or CH7 (mode) switch positions. Events are fed to anti_jamming_register_packet() and the
+ * aj_switch API with anti_jamming_service_tick() called in between, as the RX main loop does.
+ * Hops are counted through FHSSSyncEpoch, which FHSSBeginHopCycle() increments.
+ *
+ * Set AJ_REPLAY_TRACE to the path of a recorded trace ("t_ms,event,value" per line, events
+ * P = packet good(1)/bad(0), E = CH5 enable(0/1), M = CH7 mode(0 auto, 1 low, 2 high)) to
+ * print the metrics of every configuration in the matrix for offline tuning.
+ */
+
+enum traceEvent_e : uint8_t
+{
+    TRACE_PACKET,
+    TRACE_SWITCH_ENABLE,
+    TRACE_SWITCH_MODE,
+};
+
+struct traceEvent_t
+{
+    uint32_t t_ms;
+    traceEvent_e event;
+    uint8_t value;
+};
+
+struct replayResult_t
+{
+    uint32_t packets;
+    uint32_t hops;
+    uint32_t hopsBeforeOnset;           // false positives, onset is the start of the jam (if any)
+    int32_t detectionLatencyMs;         // first hop at or after onset - onset, -1 if never detected
+    double nsPerPacket;
+};
+
+// Large enough for the biggest window in the matrix
+static uint32_t ajBuffer[1024];
+
+static const uint32_t SERVICE_TICK_MS = 1;
+static const uint32_t PACKET_INTERVAL_MS = 4;   // 250Hz
+static const uint32_t NO_ONSET = UINT32_MAX;
+
+static aj_config_t defaultConfig()
+{
+    // Same as rx_main
+    aj_config_t cfg = {0};
+    cfg.window_size_packets = 100;
+    cfg.window_duration_ms = 1000;
+    cfg.window_mode = AJ_WINDOW_BY_COUNT;
+    cfg.jam_threshold_percent = 30;
+    cfg.min_bad_packets = 5;
+    cfg.consecutive_windows_to_jam = 2;
+    cfg.jam_state_hold_time_ms = 2000;
+    cfg.min_time_between_reco_ms = 500;
+    cfg.allow_group_switch_suggestions = 1;
+    return cfg;
+}
+
+// Small LCG so traces are identical on every run and platform
+static uint32_t traceRandomState;
+static uint32_t traceRandom()
+{
+    traceRandomState = traceRandomState * 1664525UL + 1013904223UL;
+    return traceRandomState >> 8;
+}
+
+/*
+ * Switch on at t=0, packets every PACKET_INTERVAL_MS for durationMs with cleanLossPct random loss,
+ * and jamLossPct random loss from onsetMs on.
+ */
+static std::vector<traceEvent_t> makeTrace(uint32_t durationMs, uint8_t cleanLossPct, uint32_t onsetMs, uint8_t jamLossPct, uint32_t seed)
+{
+    std::vector<traceEvent_t> trace;
+    traceRandomState = seed;
+
+    trace.push_back({0, TRACE_SWITCH_ENABLE, 1});
+    for (uint32_t t = PACKET_INTERVAL_MS; t < durationMs; t += PACKET_INTERVAL_MS)
+    {
+        const uint8_t lossPct = t >= onsetMs ? jamLossPct : cleanLossPct;
+        trace.push_back({t, TRACE_PACKET, (uint8_t)(traceRandom() % 100 >= lossPct)});
+    }
+    return trace;
+}
+
+static bool loadTrace(const char *path, std::vector<traceEvent_t> &trace)
+{
+    FILE *f = fopen(path, "r");
+    if (!f)
+        return false;
+
+    unsigned long t;
+    char event;
+    unsigned value;
+    while (fscanf(f, " %lu , %c , %u", &t, &event, &value) == 3)
+    {
+        switch (event)
+        {
+        case 'P':
+            trace.push_back({(uint32_t)t, TRACE_PACKET, (uint8_t)value});
+            break;
+        case 'E':
+            trace.push_back({(uint32_t)t, TRACE_SWITCH_ENABLE, (uint8_t)value});
+            break;
+        case 'M':
+            trace.push_back({(uint32_t)t, TRACE_SWITCH_MODE, (uint8_t)value});
+            break;
+        }
+    }
+    fclose(f);
+    return true;
+}
+
+static replayResult_t replay(const aj_config_t &cfg, const std::vector<traceEvent_t> &trace, uint32_t onsetMs)
+{
+    replayResult_t result = {0, 0, 0, -1, 0.0};
+
+    FHSSrandomiseFHSSsequence(0x01020304L);
+    TEST_ASSERT_NOT_NULL(anti_jamming_init_with_buffer(ajBuffer, sizeof(ajBuffer), &cfg));
+    anti_jamming_switch_init();
+    aj_switch_ctx_t *sw = anti_jamming_get_switch();
+    TEST_ASSERT_NOT_NULL(sw);
+
+    const uint32_t startEpoch = FHSSSyncEpoch;
+    std::chrono::nanoseconds packetTime(0);
+    uint32_t now = 0;
+
+    for (const traceEvent_t &e : trace)
+    {
+        // service the main loop up to the event
+        for (; now + SERVICE_TICK_MS <= e.t_ms; now += SERVICE_TICK_MS)
+        {
+            anti_jamming_service_tick(now);
+        }
+        now = e.t_ms;
+
+        const uint32_t epoch = FHSSSyncEpoch;
+        switch (e.event)
+        {
+        case TRACE_PACKET:
+        {
+            const auto start = std::chrono::steady_clock::now();
+            anti_jamming_register_packet(e.value, e.t_ms);
+            packetTime += std::chrono::steady_clock::now() - start;
+            result.packets++;
+            break;
+        }
+        case TRACE_SWITCH_ENABLE:
+            aj_switch_set_enabled(sw, e.value, e.t_ms);
+            break;
+        case TRACE_SWITCH_MODE:
+            aj_switch_set_mode_local(sw, (aj_switch_mode_t)e.value, e.t_ms);
+            break;
+        }
+
+        if (FHSSSyncEpoch != epoch)
+        {
+            if (e.t_ms < onsetMs)
+            {
+                result.hopsBeforeOnset++;
+            }
+            else if (result.detectionLatencyMs < 0)
+            {
+                result.detectionLatencyMs = e.t_ms - onsetMs;
+            }
+        }
+    }
+
+    result.hops = FHSSSyncEpoch - startEpoch;
+    result.nsPerPacket = result.packets ? (double)packetTime.count() / result.packets : 0.0;
+    return result;
+}
+
+static void printResult(const char *name, const aj_config_t &cfg, const replayResult_t &r)
+{
+    printf("%-8s mode=%s thr=%3u%% windows=%u: hops=%3u false=%3u latency=%5ldms cpu=%.0fns/pkt\n",
+           name, cfg.window_mode == AJ_WINDOW_BY_TIME ? "time " : "count",
+           (unsigned)cfg.jam_threshold_percent, (unsigned)cfg.consecutive_windows_to_jam,
+           (unsigned)r.hops, (unsigned)r.hopsBeforeOnset, (long)r.detectionLatencyMs, r.nsPerPacket);
+}
+
+void test_aj_default_config_fits_rx_buffer(void)
+{
+    // rx_main allocates a 1024 byte buffer for the default configuration
+    aj_config_t cfg = defaultConfig();
+    TEST_ASSERT_LESS_OR_EQUAL(1024, aj_context_size_bytes(&cfg));
+}
+
+void test_aj_clean_link_does_not_hop(void)
+{
+    // 60s with 5% random loss must never hop
+    auto trace = makeTrace(60000, 5, NO_ONSET, 0, 1);
+    replayResult_t r = replay(defaultConfig(), trace, NO_ONSET);
+
+    TEST_ASSERT_EQUAL(0, r.hops);
+}
+
+void test_aj_detects_jamming(void)
+{
+    // 60% loss from 10s on is detected within two 100 packet windows plus one for the onset
+    const uint32_t onset = 10000;
+    auto trace = makeTrace(20000, 2, onset, 60, 2);
+    replayResult_t r = replay(defaultConfig(), trace, onset);
+
+    TEST_ASSERT_EQUAL(0, r.hopsBeforeOnset);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, r.detectionLatencyMs);
+    TEST_ASSERT_LESS_OR_EQUAL(3 * 100 * PACKET_INTERVAL_MS, (uint32_t)r.detectionLatencyMs);
+    TEST_ASSERT_TRUE(r.hops > 0);
+}
+
+void test_aj_switch_off_blocks_hops(void)
+{
+    // the same jam with CH5 switched off before the onset must not hop
+    const uint32_t onset = 10000;
+    auto trace = makeTrace(20000, 2, onset, 60, 2);
+    const uint32_t off = 5000;
+    auto it = trace.begin();
+    while (it->t_ms < off)
+        ++it;
+    trace.insert(it, {off, TRACE_SWITCH_ENABLE, 0});
+    replayResult_t r = replay(defaultConfig(), trace, onset);
+
+    TEST_ASSERT_EQUAL(0, r.hops);
+}
+
+void test_aj_replay_is_deterministic(void)
+{
+    const uint32_t onset = 5000;
+    auto trace = makeTrace(15000, 10, onset, 45, 3);
+    replayResult_t a = replay(defaultConfig(), trace, onset);
+    replayResult_t b = replay(defaultConfig(), trace, onset);
+
+    TEST_ASSERT_EQUAL(a.hops, b.hops);
+    TEST_ASSERT_EQUAL(a.hopsBeforeOnset, b.hopsBeforeOnset);
+    TEST_ASSERT_EQUAL(a.detectionLatencyMs, b.detectionLatencyMs);
+}
+
+void test_aj_mode_switch_controller_only(void)
+{
+    aj_config_t cfg = defaultConfig();
+    TEST_ASSERT_NOT_NULL(anti_jamming_init_with_buffer(ajBuffer, sizeof(ajBuffer), &cfg));
+    anti_jamming_switch_init();
+    aj_switch_ctx_t *sw = anti_jamming_get_switch();
+
+    // CH7 is ignored while the controller holds the mode
+    aj_switch_set_controller_only(sw, 1);
+    TEST_ASSERT_EQUAL(AJ_SW_RET_DENIED, aj_switch_set_mode_local(sw, AJ_SWITCH_MODE_HIGH, 10));
+    TEST_ASSERT_EQUAL(AJ_SWITCH_MODE_AUTO, aj_switch_get_mode(sw));
+    TEST_ASSERT_EQUAL(AJ_SW_RET_OK, aj_switch_set_mode_from_controller(sw, AJ_SWITCH_MODE_LOW, 20));
+    TEST_ASSERT_EQUAL(AJ_SWITCH_MODE_LOW, aj_switch_get_mode(sw));
+}
+
+void test_aj_config_matrix(void)
+{
+    // Metrics for the configurations worth tuning between, against a synthetic trace
+    // or the recorded trace in AJ_REPLAY_TRACE
+    std::vector<traceEvent_t> trace;
+    uint32_t onset = 20000;
+    const char *path = getenv("AJ_REPLAY_TRACE");
+    if (path)
+    {
+        TEST_ASSERT_TRUE_MESSAGE(loadTrace(path, trace), "Unable to read AJ_REPLAY_TRACE");
+        const char *onsetEnv = getenv("AJ_REPLAY_ONSET_MS");
+        onset = onsetEnv ? strtoul(onsetEnv, nullptr, 10) : NO_ONSET;
+    }
+    else
+    {
+        trace = makeTrace(40000, 8, onset, 40, 4);
+    }
+
+    const aj_window_mode_t modes[] = {AJ_WINDOW_BY_COUNT, AJ_WINDOW_BY_TIME};
+    const uint8_t thresholds[] = {20, 30, 50};
+    const uint8_t windows[] = {1, 2, 3};
+
+    for (const aj_window_mode_t mode : modes)
+    {
+        for (const uint8_t threshold : thresholds)
+        {
+            for (const uint8_t consecutive : windows)
+            {
+                aj_config_t cfg = defaultConfig();
+                cfg.window_mode = mode;
+                cfg.jam_threshold_percent = threshold;
+                cfg.consecutive_windows_to_jam = consecutive;
+
+                replayResult_t r = replay(cfg, trace, onset);
+                printResult(path ? "recorded" : "synth", cfg, r);
+                if (!path)
+                {
+                    TEST_ASSERT_EQUAL(trace.size() - 1, r.packets);
+                }
+            }
+        }
+    }
+}
+
+// Unity setup/teardown
+void setUp() {}
+void tearDown() {}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_aj_default_config_fits_rx_buffer);
+    RUN_TEST(test_aj_clean_link_does_not_hop);
+    RUN_TEST(test_aj_detects_jamming);
+    RUN_TEST(test_aj_switch_off_blocks_hops);
+    RUN_TEST(test_aj_replay_is_deterministic);
+    RUN_TEST(test_aj_mode_switch_controller_only);
+    RUN_TEST(test_aj_config_matrix);
+    UNITY_END();
+
+    return 0;
+}
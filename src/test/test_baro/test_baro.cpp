@@ -0,0 +1,157 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <unity.h>
+#include "baro_altitude.h"
+
+static double referenceAltitude(uint32_t pressuredPa)
+{
+    // The pow() conversion the lookup table replaces
+    return 4433000 * (1.0 - pow(pressuredPa / 1013250.0, 0.1903));
+}
+
+// Uniform noise of +/- amplitude cm
+static int32_t noise(int32_t amplitude)
+{
+    return rand() % (2 * amplitude + 1) - amplitude;
+}
+
+void test_altitude_matches_reference(void)
+{
+    // Interpolation error grows with altitude as the curve gets steeper
+    double maxErrorLow = 0;
+    double maxErrorHigh = 0;
+    for (uint32_t p = 250000; p <= 1150000; p++)
+    {
+        const double error = fabs(baroPressureToAltitude(p) - referenceAltitude(p));
+        if (p >= 700000)
+            maxErrorLow = fmax(maxErrorLow, error);
+        else
+            maxErrorHigh = fmax(maxErrorHigh, error);
+    }
+    // below ~3000m, within 4cm; up to ~10000m, within 20cm
+    TEST_ASSERT_LESS_THAN(4, maxErrorLow);
+    TEST_ASSERT_LESS_THAN(20, maxErrorHigh);
+}
+
+void test_altitude_monotonic(void)
+{
+    int32_t last = baroPressureToAltitude(250000);
+    for (uint32_t p = 250001; p <= 1150000; p++)
+    {
+        const int32_t altitude = baroPressureToAltitude(p);
+        TEST_ASSERT_TRUE(altitude <= last);
+        last = altitude;
+    }
+}
+
+void test_altitude_out_of_range(void)
+{
+    TEST_ASSERT_EQUAL(0, baroPressureToAltitude(1013250) / 10);
+    // clamped to the ends of the table
+    TEST_ASSERT_EQUAL(baroPressureToAltitude(249856), baroPressureToAltitude(0));
+    TEST_ASSERT_EQUAL(baroPressureToAltitude(249856), baroPressureToAltitude(100000));
+    TEST_ASSERT_EQUAL(baroPressureToAltitude(1150976), baroPressureToAltitude(1200000));
+    TEST_ASSERT_EQUAL(baroPressureToAltitude(1150976), baroPressureToAltitude(0xFFFFFFFF));
+}
+
+void test_filter_first_sample(void)
+{
+    BaroAltitudeFilter filter;
+    TEST_ASSERT_FALSE(filter.isValid());
+    filter.update(12345, 1000);
+    TEST_ASSERT_TRUE(filter.isValid());
+    TEST_ASSERT_EQUAL(12345, filter.getAltitude());
+    TEST_ASSERT_EQUAL(0, filter.getVerticalSpeed());
+
+    // starts over after a long gap
+    filter.update(-500, 3000);
+    TEST_ASSERT_EQUAL(-500, filter.getAltitude());
+    TEST_ASSERT_EQUAL(0, filter.getVerticalSpeed());
+
+    filter.reset();
+    TEST_ASSERT_FALSE(filter.isValid());
+}
+
+void test_filter_noise(void)
+{
+    // Hovering with +/-30cm of sensor noise, a sample every 40ms
+    BaroAltitudeFilter filter;
+    srand(1);
+    uint32_t now = 0;
+    for (int i = 0; i < 250; i++, now += 40)
+        filter.update(10000 + noise(30), now);
+
+    int32_t maxVspd = 0;
+    int32_t maxAltError = 0;
+    for (int i = 0; i < 1500; i++, now += 40)
+    {
+        filter.update(10000 + noise(30), now);
+        maxVspd = std::max(maxVspd, (int32_t)abs(filter.getVerticalSpeed()));
+        maxAltError = std::max(maxAltError, abs(filter.getAltitude() - 10000));
+    }
+    // A single sample difference would be up to 60cm / 40ms = 1500cm/s
+    TEST_ASSERT_LESS_THAN(40, maxVspd);
+    TEST_ASSERT_LESS_THAN(25, maxAltError);
+}
+
+void test_filter_climb(void)
+{
+    // Start climbing at 2m/s after hovering
+    BaroAltitudeFilter filter;
+    srand(2);
+    uint32_t now = 0;
+    for (int i = 0; i < 100; i++, now += 40)
+        filter.update(noise(30), now);
+
+    int32_t altitude = 0;
+    for (int i = 0; i < 250; i++, now += 40)
+    {
+        altitude += 8;
+        filter.update(altitude + noise(30), now);
+        // within 3 seconds the vario reads the climb
+        if (i >= 75)
+        {
+            TEST_ASSERT_INT_WITHIN(50, 200, filter.getVerticalSpeed());
+            TEST_ASSERT_INT_WITHIN(40, altitude, filter.getAltitude());
+        }
+    }
+}
+
+void test_filter_irregular_interval(void)
+{
+    // Sample timing jitters with the sensor state machine, the speed must not depend on it
+    BaroAltitudeFilter filter;
+    srand(3);
+    uint32_t now = 0;
+    int32_t altitude = 0;
+    for (int i = 0; i < 500; i++)
+    {
+        const uint32_t dT = 20 * (1 + rand() % 4);
+        now += dT;
+        altitude -= 3 * dT / 20;  // descending 150cm/s
+        filter.update(altitude, now);
+    }
+    TEST_ASSERT_INT_WITHIN(10, -150, filter.getVerticalSpeed());
+    TEST_ASSERT_INT_WITHIN(10, altitude, filter.getAltitude());
+}
+
+// Unity setup/teardown
+void setUp() {}
+void tearDown() {}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_altitude_matches_reference);
+    RUN_TEST(test_altitude_monotonic);
+    RUN_TEST(test_altitude_out_of_range);
+    RUN_TEST(test_filter_first_sample);
+    RUN_TEST(test_filter_noise);
+    RUN_TEST(test_filter_climb);
+    RUN_TEST(test_filter_irregular_interval);
+    UNITY_END();
+
+    return 0;
+}
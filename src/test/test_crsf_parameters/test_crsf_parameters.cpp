@@ -0,0 +1,216 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <unity.h>
+
+#include "CRSFRouter.h"
+
+CRSFRouter crsfRouter;
+
+static char strRates[] = "25Hz(-123dbm);50Hz(-120dbm);100Hz(-117dbm);100Hz Full(-112dbm);150Hz(-112dbm);200Hz(-112dbm);250Hz(-108dbm);333Hz Full(-105dbm);500Hz(-105dbm);D250(-104dbm);D500(-104dbm);F500(-104dbm);F1000(-104dbm)";
+static char strPower[] = "10;25;50;100;250;500;1000;2000";
+
+static selectionParameter luaRate = {
+    {"Packet Rate", CRSF_TEXT_SELECTION},
+    0, // value
+    strRates,
+    "Hz"
+};
+static selectionParameter luaRatio = {
+    {"Telem Ratio", CRSF_TEXT_SELECTION},
+    0, // value
+    "Std;Off;1:128;1:64;1:32;1:16;1:8;1:4;1:2;Race",
+    STR_EMPTYSPACE
+};
+static folderParameter luaPowerFolder = {
+    {"TX Power", CRSF_FOLDER},
+};
+static selectionParameter luaPower = {
+    {"Max Power", CRSF_TEXT_SELECTION},
+    0, // value
+    strPower,
+    "mW"
+};
+static int8Parameter luaModelId = {
+    {"Model Id", CRSF_UINT8},
+    {
+        {
+            (uint8_t)0,
+            (uint8_t)0,
+            (uint8_t)63,
+        }
+    },
+    STR_EMPTYSPACE
+};
+static stringParameter luaInfo = {
+    {"Firmware Version and Build Information", CRSF_INFO},
+    "3.5.0 ISM2G4 d5e3f1a"
+};
+static commandParameter luaBind = {
+    {"Bind", CRSF_COMMAND},
+    lcsIdle, // step
+    STR_EMPTYSPACE
+};
+
+class MockEndpoint : public CRSFEndpoint
+{
+public:
+    MockEndpoint() : CRSFEndpoint(CRSF_ADDRESS_CRSF_TRANSMITTER) {}
+    void handleMessage(const crsf_header_t *message) override {}
+
+    void registerParameters() override
+    {
+        registerParameter(&luaRate);
+        registerParameter(&luaRatio);
+        registerParameter(&luaPowerFolder);
+        registerParameter(&luaPower, nullptr, luaPowerFolder.common.id);
+        registerParameter(&luaModelId);
+        registerParameter(&luaInfo);
+        registerParameter(&luaBind);
+    }
+
+    void readParameter(uint8_t id, uint8_t chunk)
+    {
+        parameterUpdateReq(CRSF_ADDRESS_RADIO_TRANSMITTER, false, CRSF_FRAMETYPE_PARAMETER_READ, id, chunk);
+    }
+    void setRate(uint8_t value) { setTextSelectionValue(&luaRate, value); }
+} endpoint;
+
+class MockConnector : public CRSFConnector
+{
+public:
+    void forwardMessage(const crsf_header_t *message) override
+    {
+        memcpy(last, message, message->frame_size + CRSF_FRAME_NOT_COUNTED_BYTES);
+    }
+    uint8_t GetMaxPacketBytes() const override { return maxPacketBytes; }
+
+    uint8_t maxPacketBytes = CRSF_MAX_PACKET_LEN;
+    uint8_t last[CRSF_MAX_PACKET_LEN];
+
+    // The chunk header and data of the last message
+    const uint8_t *chunk() const { return last + sizeof(crsf_ext_header_t); }
+    uint8_t chunkLen() const { return last[1] - CRSF_FRAME_LENGTH_EXT_TYPE_CRC - 2; }
+} connector;
+
+#define PARAMETER_COUNT 7
+
+typedef struct {
+    uint8_t image[PARAMETER_COUNT + 1][256];
+    uint8_t size[PARAMETER_COUNT + 1];
+    uint32_t chunks;
+    uint32_t sentBytes;             // chunk data sent to the handset
+    uint32_t serializedBefore;      // bytes serialized when every chunk serialized the whole parameter
+    uint32_t serializedAfter;       // bytes serialized when the chunks after the first are cached
+} menuLoad_t;
+
+// Read every parameter the way the Lua does, chunk by chunk, putting the images back together
+static void loadMenu(uint8_t maxPacketBytes, menuLoad_t &load)
+{
+    memset(&load, 0, sizeof(load));
+    connector.maxPacketBytes = maxPacketBytes;
+    for (uint8_t id = 1; id <= PARAMETER_COUNT; id++)
+    {
+        uint8_t chunk = 0;
+        uint8_t remaining;
+        do
+        {
+            endpoint.readParameter(id, chunk++);
+            TEST_ASSERT_EQUAL(id, connector.chunk()[0]);
+            remaining = connector.chunk()[1];
+            memcpy(&load.image[id][load.size[id]], &connector.chunk()[2], connector.chunkLen());
+            load.size[id] += connector.chunkLen();
+            load.chunks++;
+        } while (remaining != 0);
+        load.sentBytes += load.size[id];
+        load.serializedBefore += chunk * load.size[id];
+        load.serializedAfter += load.size[id];
+    }
+}
+
+void test_chunks_match_whole_parameter(void)
+{
+    // The image is the same however it is chunked
+    static menuLoad_t whole, chunked;
+    loadMenu(CRSF_MAX_PACKET_LEN, whole);
+    loadMenu(24, chunked);
+    TEST_ASSERT_TRUE(chunked.chunks > whole.chunks);
+    for (uint8_t id = 1; id <= PARAMETER_COUNT; id++)
+    {
+        TEST_ASSERT_EQUAL(whole.size[id], chunked.size[id]);
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(whole.image[id], chunked.image[id], whole.size[id]);
+    }
+
+    // Parent, type, name, options
+    TEST_ASSERT_EQUAL(0, whole.image[1][0]);
+    TEST_ASSERT_EQUAL(CRSF_TEXT_SELECTION, whole.image[1][1]);
+    TEST_ASSERT_EQUAL_STRING("Packet Rate", (const char *)&whole.image[1][2]);
+    TEST_ASSERT_EQUAL_STRING(strRates, (const char *)&whole.image[1][2 + sizeof("Packet Rate")]);
+    TEST_ASSERT_EQUAL(luaPowerFolder.common.id, whole.image[4][0]);
+}
+
+void test_chunks_from_cache(void)
+{
+    connector.maxPacketBytes = 24;
+    const uint8_t id = luaRate.common.id;
+
+    // A change the endpoint is not told about is not seen until the next read
+    endpoint.readParameter(id, 0);
+    const uint8_t valueOffset = 2 + sizeof("Packet Rate") + sizeof(strRates);
+    const uint8_t chunkMax = connector.chunkLen();
+    luaRate.value = 5;
+    const uint8_t chunk = valueOffset / chunkMax;
+    endpoint.readParameter(id, chunk);
+    TEST_ASSERT_EQUAL(0, connector.chunk()[2 + valueOffset % chunkMax]);
+
+    // A change through a setter is
+    endpoint.setRate(6);
+    endpoint.readParameter(id, chunk);
+    TEST_ASSERT_EQUAL(6, connector.chunk()[2 + valueOffset % chunkMax]);
+
+    // And every read starts fresh
+    luaRate.value = 7;
+    endpoint.readParameter(id, 0);
+    endpoint.readParameter(id, chunk);
+    TEST_ASSERT_EQUAL(7, connector.chunk()[2 + valueOffset % chunkMax]);
+    luaRate.value = 0;
+}
+
+void test_menu_load_bytes(void)
+{
+    // Full speed and a slow handset link, e.g. 115200 baud at 250Hz
+    static const uint8_t packetSizes[] = {CRSF_MAX_PACKET_LEN, 40, 24};
+    printf("\n");
+    for (uint8_t maxPacketBytes : packetSizes)
+    {
+        static menuLoad_t load;
+        loadMenu(maxPacketBytes, load);
+        printf("  %3u byte packets: %3u chunks, %4u bytes sent, %5u bytes processed before, %4u after\n",
+               maxPacketBytes, load.chunks, load.sentBytes, load.serializedBefore + load.sentBytes, load.serializedAfter + load.sentBytes);
+        TEST_ASSERT_TRUE(load.serializedAfter <= load.serializedBefore);
+        if (maxPacketBytes == 24)
+        {
+            TEST_ASSERT_TRUE(load.serializedAfter * 3 < load.serializedBefore);
+        }
+    }
+}
+
+// Unity setup/teardown
+void setUp() {}
+void tearDown() {}
+
+int main(int argc, char **argv)
+{
+    connector.addDevice(CRSF_ADDRESS_RADIO_TRANSMITTER);
+    crsfRouter.addConnector(&connector);
+    crsfRouter.addEndpoint(&endpoint);
+    endpoint.registerParameters();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_chunks_match_whole_parameter);
+    RUN_TEST(test_chunks_from_cache);
+    RUN_TEST(test_menu_load_bytes);
+    UNITY_END();
+
+    return 0;
+}
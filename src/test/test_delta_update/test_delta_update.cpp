@@ -0,0 +1,361 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <unity.h>
+#include "delta_patch.h"
+
+typedef std::vector<uint8_t> bytes_t;
+
+class MemorySource : public DeltaSource
+{
+public:
+    explicit MemorySource(const bytes_t &data) : data(data) {}
+    uint32_t size() override { return data.size(); }
+    bool read(uint32_t offset, uint8_t *buf, uint32_t len) override
+    {
+        if (offset + len > data.size())
+            return false;
+        memcpy(buf, &data[offset], len);
+        return true;
+    }
+    const bytes_t &data;
+};
+
+class MemorySink : public DeltaSink
+{
+public:
+    bool begin(uint32_t size) override
+    {
+        began = true;
+        expected = size;
+        return true;
+    }
+    bool write(const uint8_t *buf, uint32_t len) override
+    {
+        if (len > largestWrite)
+            largestWrite = len;
+        data.insert(data.end(), buf, buf + len);
+        return true;
+    }
+    bytes_t data;
+    bool began = false;
+    uint32_t expected = 0;
+    uint32_t largestWrite = 0;
+};
+
+class FileSource : public DeltaSource
+{
+public:
+    explicit FileSource(FILE *f) : f(f) {}
+    uint32_t size() override
+    {
+        fseek(f, 0, SEEK_END);
+        return ftell(f);
+    }
+    bool read(uint32_t offset, uint8_t *buf, uint32_t len) override
+    {
+        return fseek(f, offset, SEEK_SET) == 0 && fread(buf, 1, len, f) == len;
+    }
+    FILE *f;
+};
+
+class FileSink : public DeltaSink
+{
+public:
+    explicit FileSink(FILE *f) : f(f) {}
+    bool begin(uint32_t size) override { return true; }
+    bool write(const uint8_t *buf, uint32_t len) override { return fwrite(buf, 1, len, f) == len; }
+    FILE *f;
+};
+
+static uint32_t lcgState;
+static uint8_t nextByte()
+{
+    lcgState = lcgState * 1103515245 + 12345;
+    return (lcgState >> 16) & 0xFF;
+}
+
+// Same data python/delta_patch.py was run on to create pythonPatch
+static void makeImages(bytes_t &source, bytes_t &target)
+{
+    lcgState = 0x1234567;
+    source.clear();
+    for (int i = 0; i < 2048; i++)
+        source.push_back(nextByte());
+
+    target = source;
+    for (uint8_t i = 0; i < 16; i++)
+        target.insert(target.begin() + 100 + i, i);
+    target.erase(target.begin() + 1500, target.begin() + 1564);
+    for (size_t i = 0; i < target.size(); i += 256)
+        target[i]++;
+}
+
+// python/delta_patch.py output for makeImages()
+static const uint8_t pythonPatch[] = {
+    0x45, 0x4c, 0x52, 0x53, 0x44, 0x4c, 0x54, 0x31, 0x00, 0x08, 0x00, 0x00, 0x91, 0x84, 0x94, 0x4f,
+    0xab, 0x16, 0xeb, 0x3d, 0xbf, 0x28, 0xfd, 0x62, 0x0d, 0x59, 0xd3, 0x6d, 0xd0, 0x07, 0x00, 0x00,
+    0x58, 0xcd, 0xa2, 0x42, 0x19, 0x55, 0x2f, 0x92, 0x6a, 0xb7, 0x16, 0x36, 0xed, 0x6b, 0x0f, 0xd0,
+    0x49, 0x01, 0xd5, 0x41, 0x02, 0x63, 0x63, 0x00, 0x49, 0x10, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05,
+    0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x41, 0x00, 0xe8, 0x0a, 0x8c, 0x01,
+    0x01, 0x01, 0xff, 0x01, 0x01, 0x01, 0xff, 0x01, 0x01, 0x01, 0xff, 0x01, 0x01, 0x01, 0xff, 0x01,
+    0x01, 0x01, 0xdb, 0x01, 0x00, 0x41, 0x80, 0x01, 0xf4, 0x03, 0x24, 0x01, 0x01, 0xff, 0x01, 0x01,
+    0x01, 0xcf, 0x01, 0x00, 0x45,
+};
+
+static void putVarint(bytes_t &out, uint32_t value)
+{
+    while (value >= 0x80)
+    {
+        out.push_back((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    out.push_back(value);
+}
+
+static void putMD5(bytes_t &out, const bytes_t &data)
+{
+    DeltaMD5 md5;
+    md5.begin();
+    md5.add(data.data(), data.size());
+    md5.calculate();
+    uint8_t digest[DELTA_MD5_LEN];
+    md5.getBytes(digest);
+    out.insert(out.end(), digest, digest + DELTA_MD5_LEN);
+}
+
+static void putU32(bytes_t &out, uint32_t value)
+{
+    for (int i = 0; i < 4; i++)
+        out.push_back(value >> (i * 8));
+}
+
+static bytes_t makeHeader(const bytes_t &source, const bytes_t &target)
+{
+    bytes_t out(DELTA_MAGIC, DELTA_MAGIC + DELTA_MAGIC_LEN);
+    putU32(out, source.size());
+    putMD5(out, source);
+    putU32(out, target.size());
+    putMD5(out, target);
+    return out;
+}
+
+/*
+ * Hand built patch: target = source[0..512) with one byte changed, 3 inserted bytes,
+ * then source[600..1024) moved back to 200 and copied unmodified
+ */
+static void makeSimplePatch(const bytes_t &source, bytes_t &target, bytes_t &patch)
+{
+    target.assign(source.begin(), source.begin() + 512);
+    target[10] += 5;
+    target.push_back(0xAA);
+    target.push_back(0xBB);
+    target.push_back(0xCC);
+    target.insert(target.end(), source.begin() + 600, source.begin() + 1024);
+
+    patch = makeHeader(source, target);
+    patch.push_back('A');
+    putVarint(patch, 0);        // source 0
+    putVarint(patch, 512);
+    putVarint(patch, 10);       // skip
+    putVarint(patch, 1);        // count
+    patch.push_back(5);
+    putVarint(patch, 501);
+    putVarint(patch, 0);
+    patch.push_back('I');
+    putVarint(patch, 3);
+    patch.push_back(0xAA);
+    patch.push_back(0xBB);
+    patch.push_back(0xCC);
+    patch.push_back('A');
+    putVarint(patch, 88 << 1);  // 600 - 512, zigzag
+    putVarint(patch, 424);
+    putVarint(patch, 424);
+    putVarint(patch, 0);
+    patch.push_back('E');
+}
+
+static deltaStatus_e applyPatch(const bytes_t &source, const uint8_t *patch, size_t len, size_t chunk, MemorySink &sink)
+{
+    MemorySource src(source);
+    DeltaPatcher patcher(src, sink);
+    deltaStatus_e status = DELTA_IN_PROGRESS;
+    for (size_t pos = 0; pos < len; pos += chunk)
+    {
+        status = patcher.write(patch + pos, (len - pos) < chunk ? (len - pos) : chunk);
+    }
+    return status;
+}
+
+void test_delta_md5(void)
+{
+    static const uint8_t expected[DELTA_MD5_LEN] = {
+        0x90, 0x01, 0x50, 0x98, 0x3c, 0xd2, 0x4f, 0xb0, 0xd6, 0x96, 0x3f, 0x7d, 0x28, 0xe1, 0x7f, 0x72};
+    DeltaMD5 md5;
+    md5.begin();
+    md5.add((const uint8_t *)"a", 1);
+    md5.add((const uint8_t *)"bc", 2);
+    md5.calculate();
+    uint8_t digest[DELTA_MD5_LEN];
+    md5.getBytes(digest);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, digest, DELTA_MD5_LEN);
+}
+
+void test_delta_is_delta(void)
+{
+    bytes_t source, target, patch;
+    makeImages(source, target);
+    TEST_ASSERT_TRUE(DeltaPatcher::isDelta(pythonPatch, sizeof(pythonPatch)));
+    TEST_ASSERT_FALSE(DeltaPatcher::isDelta(pythonPatch, DELTA_MAGIC_LEN - 1));
+    TEST_ASSERT_FALSE(DeltaPatcher::isDelta(source.data(), source.size()));
+}
+
+void test_delta_python_patch(void)
+{
+    bytes_t source, target;
+    makeImages(source, target);
+
+    MemorySink sink;
+    TEST_ASSERT_EQUAL(DELTA_OK, applyPatch(source, pythonPatch, sizeof(pythonPatch), sizeof(pythonPatch), sink));
+    TEST_ASSERT_EQUAL(target.size(), sink.expected);
+    TEST_ASSERT_EQUAL(target.size(), sink.data.size());
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(target.data(), sink.data.data(), target.size());
+}
+
+void test_delta_any_chunk_size(void)
+{
+    bytes_t source, target, patch;
+    makeImages(source, target);
+    makeSimplePatch(source, target, patch);
+
+    for (size_t chunk = 1; chunk <= patch.size(); chunk++)
+    {
+        MemorySink sink;
+        TEST_ASSERT_EQUAL(DELTA_OK, applyPatch(source, patch.data(), patch.size(), chunk, sink));
+        TEST_ASSERT_EQUAL(target.size(), sink.data.size());
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(target.data(), sink.data.data(), target.size());
+        TEST_ASSERT_LESS_OR_EQUAL(DELTA_BUFFER_SIZE, sink.largestWrite);
+    }
+}
+
+void test_delta_wrong_source(void)
+{
+    bytes_t source, target;
+    makeImages(source, target);
+    source[2000] ^= 1;
+
+    MemorySink sink;
+    TEST_ASSERT_EQUAL(DELTA_ERR_SOURCE, applyPatch(source, pythonPatch, sizeof(pythonPatch), 64, sink));
+    // nothing may be written to the update partition
+    TEST_ASSERT_FALSE(sink.began);
+    TEST_ASSERT_EQUAL(0, sink.data.size());
+
+    source.resize(1024);
+    MemorySink shortSink;
+    TEST_ASSERT_EQUAL(DELTA_ERR_SOURCE, applyPatch(source, pythonPatch, sizeof(pythonPatch), 64, shortSink));
+}
+
+void test_delta_corrupt_patch(void)
+{
+    bytes_t source, target, patch;
+    makeImages(source, target);
+    makeSimplePatch(source, target, patch);
+    const size_t diffPos = DELTA_HEADER_LEN + 6;
+    TEST_ASSERT_EQUAL(5, patch[diffPos]);
+
+    // a changed diff byte produces the right size but the wrong content
+    bytes_t bad = patch;
+    bad[diffPos]++;
+    MemorySink sink;
+    TEST_ASSERT_EQUAL(DELTA_ERR_HASH, applyPatch(source, bad.data(), bad.size(), 7, sink));
+
+    // an unknown op
+    bad = patch;
+    bad[DELTA_HEADER_LEN] = 'X';
+    MemorySink sink2;
+    TEST_ASSERT_EQUAL(DELTA_ERR_FORMAT, applyPatch(source, bad.data(), bad.size(), 7, sink2));
+
+    // a bad magic
+    bad = patch;
+    bad[0] = 'X';
+    MemorySink sink3;
+    TEST_ASSERT_EQUAL(DELTA_ERR_FORMAT, applyPatch(source, bad.data(), bad.size(), 7, sink3));
+
+    // a truncated patch never completes
+    MemorySink sink4;
+    TEST_ASSERT_EQUAL(DELTA_IN_PROGRESS, applyPatch(source, patch.data(), patch.size() - 1, 7, sink4));
+
+    // reading before the start of the source
+    bad = makeHeader(source, target);
+    bad.push_back('A');
+    putVarint(bad, (10 << 1) - 1);      // -10
+    putVarint(bad, 16);
+    putVarint(bad, 16);
+    putVarint(bad, 0);
+    bad.push_back('E');
+    MemorySink sink5;
+    TEST_ASSERT_EQUAL(DELTA_ERR_FORMAT, applyPatch(source, bad.data(), bad.size(), 7, sink5));
+
+    // writing more than the target size
+    target.resize(1000);
+    bad = makeHeader(source, target);
+    bad.push_back('A');
+    putVarint(bad, 0);
+    putVarint(bad, 2048);
+    putVarint(bad, 2048);
+    putVarint(bad, 0);
+    bad.push_back('E');
+    MemorySink sink6;
+    TEST_ASSERT_EQUAL(DELTA_ERR_SIZE, applyPatch(source, bad.data(), bad.size(), 7, sink6));
+}
+
+void test_delta_files(void)
+{
+    bytes_t source, target;
+    makeImages(source, target);
+
+    FILE *oldFile = tmpfile();
+    FILE *newFile = tmpfile();
+    TEST_ASSERT_NOT_NULL(oldFile);
+    TEST_ASSERT_NOT_NULL(newFile);
+    fwrite(source.data(), 1, source.size(), oldFile);
+
+    FileSource src(oldFile);
+    FileSink sink(newFile);
+    DeltaPatcher patcher(src, sink);
+    deltaStatus_e status = DELTA_IN_PROGRESS;
+    for (size_t pos = 0; pos < sizeof(pythonPatch); pos += 13)
+    {
+        status = patcher.write(pythonPatch + pos, (sizeof(pythonPatch) - pos) < 13 ? (sizeof(pythonPatch) - pos) : 13);
+    }
+    TEST_ASSERT_EQUAL(DELTA_OK, status);
+    TEST_ASSERT_EQUAL(target.size(), patcher.written());
+
+    bytes_t result(target.size());
+    fseek(newFile, 0, SEEK_SET);
+    TEST_ASSERT_EQUAL(target.size(), fread(result.data(), 1, result.size(), newFile));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(target.data(), result.data(), target.size());
+
+    fclose(oldFile);
+    fclose(newFile);
+}
+
+// Unity setup/teardown
+void setUp() {}
+void tearDown() {}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_delta_md5);
+    RUN_TEST(test_delta_is_delta);
+    RUN_TEST(test_delta_python_patch);
+    RUN_TEST(test_delta_any_chunk_size);
+    RUN_TEST(test_delta_wrong_source);
+    RUN_TEST(test_delta_corrupt_patch);
+    RUN_TEST(test_delta_files);
+    UNITY_END();
+
+    return 0;
+}
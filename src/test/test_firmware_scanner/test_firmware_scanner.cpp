@@ -0,0 +1,224 @@
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <unity.h>
+#include "FirmwareScanner.h"
+
+typedef std::vector<uint8_t> bytes_t;
+
+static void putU32(bytes_t &out, uint32_t value)
+{
+    for (int i = 0; i < 4; i++)
+        out.push_back(value >> (i * 8));
+}
+
+static void putString(bytes_t &out, const char *s, size_t len)
+{
+    for (size_t i = 0; i < len; i++)
+        out.push_back(i < strlen(s) ? s[i] : 0);
+}
+
+static void putSegment(bytes_t &out, const bytes_t &data)
+{
+    putU32(out, 0x3F400000);
+    putU32(out, data.size());
+    out.insert(out.end(), data.begin(), data.end());
+}
+
+static bytes_t targetString(const char *name, const char *prefix = "\xBE\xEF\xCA\xFE")
+{
+    bytes_t out(prefix, prefix + strlen(prefix));
+    out.insert(out.end(), name, name + strlen(name) + 1);
+    return out;
+}
+
+// Append the configurator trailer, as appendToFirmware() in UnifiedConfiguration.py
+static void putTrailer(bytes_t &image, uint32_t end, const char *options, const char *hardware)
+{
+    image.resize(end, 0xAA);
+    putString(image, "Generic ESP32 2.4GHz RX", ELRSOPTS_PRODUCTNAME_SIZE);
+    putString(image, "Generic RX", ELRSOPTS_DEVICENAME_SIZE);
+    putString(image, options, ELRSOPTS_OPTIONS_SIZE);
+    putString(image, hardware, ELRSOPTS_HARDWARE_SIZE);
+}
+
+/*
+ * ESP32 image with 3 segments, the second one contains the target name after bytes that
+ * start the magic twice, which a restart-on-mismatch matcher misses
+ */
+static bytes_t makeEsp32Image(const char *name, uint32_t &end)
+{
+    bytes_t image = {0xE9, 3, 2, 0x20};
+    putU32(image, 0x40080000);
+    image.resize(24, 0);
+
+    putSegment(image, bytes_t(100, 0x11));
+    bytes_t rodata(37, 0x22);
+    rodata.push_back(0xBE);
+    const bytes_t target = targetString(name);
+    rodata.insert(rodata.end(), target.begin(), target.end());
+    rodata.resize(300, 0x33);
+    putSegment(image, rodata);
+    putSegment(image, bytes_t(1000, 0x44));
+
+    end = ((image.size() + 16) & ~15) + 32;
+    putTrailer(image, end, "{\"uid\":[1,2,3,4,5,6]}", "{\"serial_rx\":3}");
+    return image;
+}
+
+static bytes_t makeEsp8266Image(uint32_t &end)
+{
+    bytes_t image = {0xE9, 2, 2, 0x20};
+    putU32(image, 0x40100000);
+    image.resize(0x1000, 0xFF);
+    image.insert(image.end(), {0xE9, 2, 0, 0});
+    putU32(image, 0x40100000);
+    putSegment(image, targetString("UNIFIED_ESP8285_2400_RX"));
+    putSegment(image, bytes_t(777, 0x55));
+
+    end = (image.size() + 16) & ~15;
+    putTrailer(image, end, "{\"domain\":1}", "");
+    return image;
+}
+
+static void scanChunks(FirmwareScanner &scanner, const bytes_t &image, uint32_t maxChunk)
+{
+    scanner.reset();
+    size_t pos = 0;
+    while (pos < image.size())
+    {
+        size_t n = 1 + rand() % maxChunk;
+        if (n > image.size() - pos)
+            n = image.size() - pos;
+        scanner.scan(&image[pos], n);
+        pos += n;
+    }
+}
+
+void test_scanner_esp32_image(void)
+{
+    uint32_t end;
+    const bytes_t image = makeEsp32Image("UNIFIED_ESP32_2400_RX", end);
+    FirmwareScanner scanner("UNIFIED_ESP32_2400_RX");
+    scanner.scan(image.data(), image.size());
+
+    TEST_ASSERT_FALSE(scanner.isCompressed());
+    TEST_ASSERT_TRUE(scanner.targetMatched());
+    TEST_ASSERT_EQUAL_STRING("UNIFIED_ESP32_2400_RX", scanner.targetName());
+    TEST_ASSERT_EQUAL(end, scanner.firmwareEnd());
+    TEST_ASSERT_EQUAL(end + 144, scanner.optionsOffset());
+    TEST_ASSERT_EQUAL(end + 656, scanner.hardwareOffset());
+    TEST_ASSERT_TRUE(scanner.hasOptions());
+    TEST_ASSERT_TRUE(scanner.hasHardware());
+    TEST_ASSERT_EQUAL_STRING("Generic ESP32 2.4GHz RX", scanner.productName());
+    TEST_ASSERT_EQUAL_STRING("Generic RX", scanner.deviceName());
+    TEST_ASSERT_EQUAL(image.size(), scanner.size());
+}
+
+void test_scanner_esp8266_image(void)
+{
+    uint32_t end;
+    const bytes_t image = makeEsp8266Image(end);
+    FirmwareScanner scanner("UNIFIED_ESP8285_2400_RX");
+    scanner.scan(image.data(), image.size());
+
+    TEST_ASSERT_TRUE(scanner.targetMatched());
+    TEST_ASSERT_EQUAL(end, scanner.firmwareEnd());
+    TEST_ASSERT_TRUE(scanner.hasOptions());
+    TEST_ASSERT_FALSE(scanner.hasHardware());
+    TEST_ASSERT_EQUAL_STRING("Generic RX", scanner.deviceName());
+}
+
+void test_scanner_other_target(void)
+{
+    uint32_t end;
+    bytes_t image = makeEsp32Image("UNIFIED_ESP32_900_RX", end);
+    FirmwareScanner scanner("UNIFIED_ESP32_2400_RX");
+    scanner.scan(image.data(), image.size());
+    TEST_ASSERT_FALSE(scanner.targetMatched());
+    TEST_ASSERT_EQUAL_STRING("UNIFIED_ESP32_900_RX", scanner.targetName());
+
+    // the configurator appends the prior target name of renamed targets
+    const bytes_t prior = targetString("UNIFIED_ESP32_2400_RX");
+    image.insert(image.end(), prior.begin(), prior.end());
+    scanner.reset();
+    scanner.scan(image.data(), image.size());
+    TEST_ASSERT_TRUE(scanner.targetMatched());
+    TEST_ASSERT_EQUAL_STRING("UNIFIED_ESP32_900_RX", scanner.targetName());
+}
+
+void test_scanner_rejects_partial_names(void)
+{
+    // a longer name that starts with the expected one, a name that is not terminated, and garbage after the magic
+    bytes_t data = targetString("UNIFIED_ESP32_2400_RX_EXTRA");
+    const bytes_t garbage = targetString("\x01\x02");
+    data.insert(data.end(), garbage.begin(), garbage.end());
+    data.insert(data.end(), {0xBE, 0xEF, 0xCA, 0xFE});
+    data.insert(data.end(), 100, 'A');
+    data.push_back(0);
+
+    FirmwareScanner scanner("UNIFIED_ESP32_2400_RX");
+    scanner.scan(data.data(), data.size());
+    TEST_ASSERT_FALSE(scanner.targetMatched());
+    TEST_ASSERT_EQUAL_STRING("UNIFIED_ESP32_2400_RX_EXTRA", scanner.targetName());
+    TEST_ASSERT_EQUAL(FIRMWARE_OFFSET_UNKNOWN, scanner.firmwareEnd());
+    TEST_ASSERT_EQUAL(FIRMWARE_OFFSET_UNKNOWN, scanner.optionsOffset());
+}
+
+void test_scanner_compressed(void)
+{
+    const bytes_t image = {0x1F, 0x8B, 0x08, 0x00, 0xBE, 0xEF, 0xCA, 0xFE, 'X', 0};
+    FirmwareScanner scanner("X");
+    scanner.scan(image.data(), image.size());
+    TEST_ASSERT_TRUE(scanner.isCompressed());
+    TEST_ASSERT_FALSE(scanner.targetMatched());
+}
+
+void test_scanner_random_chunks(void)
+{
+    uint32_t end32, end;
+    const bytes_t esp32 = makeEsp32Image("UNIFIED_ESP32_2400_RX", end32);
+    const bytes_t esp8266 = makeEsp8266Image(end);
+    FirmwareScanner scanner("UNIFIED_ESP32_2400_RX");
+    FirmwareScanner scanner8266("UNIFIED_ESP8285_2400_RX");
+
+    srand(1);
+    for (int i = 0; i < 500; i++)
+    {
+        const uint32_t maxChunk = 1 + (i % 5 == 0 ? 1 : rand() % 1500);
+
+        scanChunks(scanner, esp32, maxChunk);
+        TEST_ASSERT_TRUE(scanner.targetMatched());
+        TEST_ASSERT_EQUAL_STRING("UNIFIED_ESP32_2400_RX", scanner.targetName());
+        TEST_ASSERT_EQUAL(end32, scanner.firmwareEnd());
+        TEST_ASSERT_TRUE(scanner.hasOptions());
+        TEST_ASSERT_TRUE(scanner.hasHardware());
+        TEST_ASSERT_EQUAL_STRING("Generic ESP32 2.4GHz RX", scanner.productName());
+        TEST_ASSERT_EQUAL_STRING("Generic RX", scanner.deviceName());
+
+        scanChunks(scanner8266, esp8266, maxChunk);
+        TEST_ASSERT_TRUE(scanner8266.targetMatched());
+        TEST_ASSERT_EQUAL(end, scanner8266.firmwareEnd());
+        TEST_ASSERT_TRUE(scanner8266.hasOptions());
+    }
+}
+
+// Unity setup/teardown
+void setUp() {}
+void tearDown() {}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_scanner_esp32_image);
+    RUN_TEST(test_scanner_esp8266_image);
+    RUN_TEST(test_scanner_other_target);
+    RUN_TEST(test_scanner_rejects_partial_names);
+    RUN_TEST(test_scanner_compressed);
+    RUN_TEST(test_scanner_random_chunks);
+    UNITY_END();
+
+    return 0;
+}
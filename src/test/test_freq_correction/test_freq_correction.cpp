@@ -0,0 +1,202 @@
+#include <cstdint>
+#include <cstdio>
+#include <cmath>
+#include <cstdlib>
+#include <unity.h>
+#include "FreqCorrection.h"
+
+/*
+ * Simulation harness: a TX and a receiver with two radios on 915MHz, each with its own crystal
+ * error that drifts as the receiver warms up. Each radio measures its frequency error on every
+ * packet it gets, with noise and the odd wild estimate, and its FreqCorrector steers it.
+ */
+
+#define SIM_STEPS_PER_PPM 15.0f     // 915MHz in 61Hz FREQ_STEPs
+#define SIM_LIMIT 1638              // FreqCorrectionMax on 900MHz
+#define SIM_CAPTURE 512             // largest error a packet is received with, a quarter of 125kHz
+#define SIM_PACKETS 20000
+#define SIM_SETTLE_PACKETS 300
+
+typedef struct {
+    float ppm;          // at the start
+    float ppmPerC;      // temperature drift
+} simCrystal_t;
+
+typedef struct {
+    float noise;        // standard deviation of the error estimate, FREQ_STEP
+    float outlierRate;  // 0 to 1, estimates anywhere in the capture range
+    float lossRate;     // 0 to 1
+} simParams_t;
+
+typedef struct {
+    float rms;          // once settled, FREQ_STEP
+    float max;
+    int32_t lastResidual;
+    uint32_t lost;      // packets that were not received for the frequency error
+} simResult_t;
+
+static uint32_t rngState;
+
+static float uniform()
+{
+    rngState = rngState * 1664525 + 1013904223;
+    return (rngState >> 8) / 16777216.0f;
+}
+
+static float gaussian()
+{
+    // Irwin-Hall, close enough
+    float sum = 0;
+    for (int i = 0; i < 12; i++)
+        sum += uniform();
+    return sum - 6.0f;
+}
+
+static const simCrystal_t txCrystal = {2.0f, 0.0f};
+
+// The TX is still, the receiver goes from 25C to 65C
+static float temperatureAt(uint32_t packet)
+{
+    return 25.0f + 40.0f * packet / SIM_PACKETS;
+}
+
+static void simulate(const simCrystal_t crystals[2], const simParams_t &params,
+                     const freqCorrectionConfig_t &config, simResult_t results[2])
+{
+    FreqCorrector correctors[2] = {FreqCorrector(SIM_LIMIT, config), FreqCorrector(SIM_LIMIT, config)};
+    float sumSq[2] = {0, 0};
+    rngState = 1;
+    for (uint8_t r = 0; r < 2; r++)
+        results[r] = simResult_t{0, 0, 0, 0};
+
+    for (uint32_t packet = 0; packet < SIM_PACKETS; packet++)
+    {
+        const float dT = temperatureAt(packet) - 25.0f;
+        for (uint8_t r = 0; r < 2; r++)
+        {
+            // The radio is tuned to the TX's frequency less its correction
+            const float ppm = crystals[r].ppm + crystals[r].ppmPerC * dT - txCrystal.ppm;
+            const float residual = ppm * SIM_STEPS_PER_PPM - correctors[r].correction();
+            results[r].lastResidual = lroundf(residual);
+            if (packet >= SIM_SETTLE_PACKETS)
+            {
+                sumSq[r] += residual * residual;
+                if (fabsf(residual) > results[r].max)
+                    results[r].max = fabsf(residual);
+            }
+
+            if (fabsf(residual) > SIM_CAPTURE)
+            {
+                results[r].lost++;
+                continue;
+            }
+            if (uniform() < params.lossRate)
+                continue;
+            const float estimate = uniform() < params.outlierRate
+                ? (uniform() * 2 - 1) * SIM_CAPTURE
+                : residual + gaussian() * params.noise;
+            correctors[r].update(lroundf(estimate));
+        }
+    }
+
+    for (uint8_t r = 0; r < 2; r++)
+        results[r].rms = sqrtf(sumSq[r] / (SIM_PACKETS - SIM_SETTLE_PACKETS));
+}
+
+// Crystals out in opposite directions that drift apart as they warm up
+static const simCrystal_t rxCrystals[2] = {{18.0f, 0.25f}, {-12.0f, -0.15f}};
+
+void test_both_radios_stay_centred(void)
+{
+    const simParams_t params = {2.0f, 0.02f, 0.1f};
+    simResult_t results[2];
+    simulate(rxCrystals, params, FreqCorrectionDefaultConfig, results);
+
+    printf("\n");
+    for (uint8_t r = 0; r < 2; r++)
+    {
+        printf("  radio %u: rms %.2f max %.1f steps, ended %d steps out\n",
+               r + 1, results[r].rms, results[r].max, results[r].lastResidual);
+        TEST_ASSERT_EQUAL(0, results[r].lost);
+        TEST_ASSERT_TRUE(results[r].rms < 3.0f);
+        // An outlier only moves it by maxStep, a few in a row by a few times that
+        TEST_ASSERT_TRUE(results[r].max < 3 * FreqCorrectionDefaultConfig.maxStep);
+        TEST_ASSERT_INT_WITHIN(3, 0, results[r].lastResidual);
+    }
+}
+
+void test_step_bound(void)
+{
+    // Without the bound the outliers throw it far
+    const simParams_t params = {2.0f, 0.02f, 0.1f};
+    const freqCorrectionConfig_t unbounded = {FreqCorrectionDefaultConfig.gainQ8, 0xFFFF};
+    simResult_t bounded[2], results[2];
+    simulate(rxCrystals, params, FreqCorrectionDefaultConfig, bounded);
+    simulate(rxCrystals, params, unbounded, results);
+    printf("\n  unbounded: rms %.2f max %.1f steps\n", results[0].rms, results[0].max);
+    TEST_ASSERT_TRUE(results[0].max > 4 * bounded[0].max);
+
+    FreqCorrector corrector(SIM_LIMIT);
+    TEST_ASSERT_EQUAL(FreqCorrectionDefaultConfig.maxStep, corrector.update(100000));
+    TEST_ASSERT_EQUAL(0, corrector.update(-100000));
+}
+
+void test_limit(void)
+{
+    FreqCorrector corrector(SIM_LIMIT);
+    for (int i = 0; i < 1000; i++)
+        corrector.update(-SIM_CAPTURE);
+    TEST_ASSERT_EQUAL(-SIM_LIMIT, corrector.correction());
+    TEST_ASSERT_TRUE(corrector.atLimit());
+    corrector.update(4);
+    TEST_ASSERT_FALSE(corrector.atLimit());
+    corrector.reset();
+    TEST_ASSERT_EQUAL(0, corrector.correction());
+}
+
+void test_direction_only(void)
+{
+    // Chips that only give the sign of the error walk to the TX and dither around it
+    FreqCorrector corrector(SIM_LIMIT);
+    const int32_t offset = 200;
+    int32_t maxAfter = 0;
+    for (int i = 0; i < 2000; i++)
+    {
+        const int32_t residual = offset - corrector.correction();
+        if (i > 1000 && abs(residual) > maxAfter)
+            maxAfter = abs(residual);
+        corrector.update(residual > 0 ? 1 : -1);
+    }
+    TEST_ASSERT_TRUE(maxAfter <= 1);
+}
+
+void test_fixed_point_rounding(void)
+{
+    // A quarter step at a time
+    FreqCorrector corrector(SIM_LIMIT);
+    TEST_ASSERT_EQUAL(0, corrector.update(1));
+    TEST_ASSERT_EQUAL(1, corrector.update(1));
+    TEST_ASSERT_EQUAL(1, corrector.update(1));
+    TEST_ASSERT_EQUAL(0, corrector.update(-2));
+    TEST_ASSERT_EQUAL(0, corrector.update(-1));
+    TEST_ASSERT_EQUAL(0, corrector.update(-1));
+    TEST_ASSERT_EQUAL(0, corrector.update(-1));
+    TEST_ASSERT_EQUAL(-1, corrector.update(-1));
+}
+
+// Unity setup/teardown
+void setUp() {}
+void tearDown() {}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_both_radios_stay_centred);
+    RUN_TEST(test_step_bound);
+    RUN_TEST(test_limit);
+    RUN_TEST(test_direction_only);
+    RUN_TEST(test_fixed_point_rounding);
+    UNITY_END();
+
+    return 0;
+}
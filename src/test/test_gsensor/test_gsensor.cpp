@@ -0,0 +1,178 @@
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+#include <unity.h>
+#include "motion_detector.h"
+
+static std::vector<Motion_Event_t> events;
+
+static void recordEvent(Motion_Event_t event)
+{
+    events.push_back(event);
+}
+
+static int16_t noise(int16_t amplitude)
+{
+    return rand() % (2 * amplitude + 1) - amplitude;
+}
+
+void test_axis_stats_matches_full_pass(void)
+{
+    // The running sums must give the same result as averaging the whole window each time
+    MotionAxisStats stats;
+    const uint8_t window = 20;
+    stats.reset(window);
+    std::vector<int16_t> samples;
+    srand(1);
+    for (int i = 0; i < 1000; i++)
+    {
+        const int16_t sample = (i < 500 ? 0 : -1000) + noise(300);
+        samples.push_back(sample);
+        stats.add(sample);
+
+        const size_t n = samples.size() < window ? samples.size() : window;
+        double mean = 0;
+        for (size_t j = samples.size() - n; j < samples.size(); j++)
+            mean += samples[j];
+        mean /= n;
+        double variance = 0;
+        for (size_t j = samples.size() - n; j < samples.size(); j++)
+            variance += (samples[j] - mean) * (samples[j] - mean);
+        variance /= n;
+
+        TEST_ASSERT_EQUAL(n == window, stats.isFull());
+        TEST_ASSERT_INT_WITHIN(1, (int)mean, stats.getMean());
+        TEST_ASSERT_UINT32_WITHIN(1, (uint32_t)variance, stats.getVariance());
+    }
+}
+
+void test_axis_stats_extremes(void)
+{
+    // Full scale samples over the largest window must not overflow
+    MotionAxisStats stats;
+    stats.reset(MOTION_WINDOW_MAX);
+    double mean = 0;
+    for (int i = 0; i < MOTION_WINDOW_MAX; i++)
+    {
+        const int16_t sample = i & 1 ? INT16_MAX : INT16_MIN;
+        stats.add(sample);
+        mean += sample;
+    }
+    mean /= MOTION_WINDOW_MAX;
+    double variance = 0;
+    for (int i = 0; i < MOTION_WINDOW_MAX; i++)
+    {
+        const double d = (i & 1 ? INT16_MAX : INT16_MIN) - mean;
+        variance += d * d;
+    }
+    variance /= MOTION_WINDOW_MAX;
+    TEST_ASSERT_INT_WITHIN(1, (int)mean, stats.getMean());
+    TEST_ASSERT_UINT32_WITHIN(1, (uint32_t)variance, stats.getVariance());
+}
+
+void test_detector_still_and_moving(void)
+{
+    MotionDetector motion(20);
+    events.clear();
+    motion.setEventCallback(recordEvent);
+    srand(2);
+
+    // resting flat, only sensor noise
+    for (int i = 0; i < 19; i++)
+        motion.update(noise(5), noise(5), -1000 + noise(5));
+    TEST_ASSERT_FALSE(motion.isStill());
+    motion.update(noise(5), noise(5), -1000 + noise(5));
+    TEST_ASSERT_TRUE(motion.isStill());
+    TEST_ASSERT_EQUAL(1, events.size());
+    TEST_ASSERT_EQUAL(MOTION_EVENT_STILL, events[0]);
+
+    // no repeated events while still
+    for (int i = 0; i < 100; i++)
+        motion.update(noise(5), noise(5), -1000 + noise(5));
+    TEST_ASSERT_EQUAL(1, events.size());
+
+    // picked up
+    motion.update(60, 0, -1000);
+    TEST_ASSERT_FALSE(motion.isStill());
+    TEST_ASSERT_EQUAL(2, events.size());
+    TEST_ASSERT_EQUAL(MOTION_EVENT_MOVING, events[1]);
+
+    // needs a full window (starting with the sample that moved) before being still again
+    for (int i = 0; i < 18; i++)
+        motion.update(60 + noise(5), noise(5), -1000 + noise(5));
+    TEST_ASSERT_FALSE(motion.isStill());
+    motion.update(60 + noise(5), noise(5), -1000 + noise(5));
+    TEST_ASSERT_TRUE(motion.isStill());
+    TEST_ASSERT_EQUAL(3, events.size());
+}
+
+void test_detector_shaking_is_not_still(void)
+{
+    MotionDetector motion(20);
+    events.clear();
+    motion.setEventCallback(recordEvent);
+    srand(3);
+    for (int i = 0; i < 500; i++)
+        motion.update(noise(100), noise(100), -1000 + noise(100));
+    TEST_ASSERT_FALSE(motion.isStill());
+    TEST_ASSERT_EQUAL(0, events.size());
+}
+
+void test_detector_flipped(void)
+{
+    MotionDetector motion(20);
+    events.clear();
+    motion.setEventCallback(recordEvent);
+
+    motion.update(0, 0, -1000);
+    TEST_ASSERT_FALSE(motion.isFlipped());
+    TEST_ASSERT_EQUAL(0, events.size());
+
+    motion.update(0, 0, 1000);
+    TEST_ASSERT_TRUE(motion.isFlipped());
+    motion.update(0, 0, 900);
+    TEST_ASSERT_EQUAL(1, events.size());
+    TEST_ASSERT_EQUAL(MOTION_EVENT_FLIPPED, events[0]);
+
+    motion.update(0, 0, 100);
+    TEST_ASSERT_FALSE(motion.isFlipped());
+    TEST_ASSERT_EQUAL(2, events.size());
+    TEST_ASSERT_EQUAL(MOTION_EVENT_UPRIGHT, events[1]);
+}
+
+void test_detector_window(void)
+{
+    MotionDetector motion(20);
+    motion.setWindow(200);
+    for (int i = 0; i < 199; i++)
+        motion.update(0, 0, -1000);
+    TEST_ASSERT_FALSE(motion.isStill());
+    motion.update(0, 0, -1000);
+    TEST_ASSERT_TRUE(motion.isStill());
+
+    // changing the window starts over
+    motion.setWindow(5);
+    TEST_ASSERT_FALSE(motion.isStill());
+    for (int i = 0; i < 5; i++)
+        motion.update(0, 0, -1000);
+    TEST_ASSERT_TRUE(motion.isStill());
+}
+
+// Unity setup/teardown
+void setUp() {}
+void tearDown() {}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_axis_stats_matches_full_pass);
+    RUN_TEST(test_axis_stats_extremes);
+    RUN_TEST(test_detector_still_and_moving);
+    RUN_TEST(test_detector_shaking_is_not_still);
+    RUN_TEST(test_detector_flipped);
+    RUN_TEST(test_detector_window);
+    UNITY_END();
+
+    return 0;
+}
@@ -0,0 +1,329 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <unity.h>
+#include "HandsetBaud.h"
+#include "crc.h"
+#include "crsf_protocol.h"
+
+/*
+ * The handset sends RC frames on the line bit by bit. A UART model decodes the line at whatever
+ * baud the TX has picked, and a model of the edge interrupt feeds HandsetBaud the edge times in ns. The TX's UART
+ * watchdog switches baud until the decoded frames pass their CRC.
+ */
+
+static const int32_t bauds[] = {400000, 115200, 5250000, 3750000, 1870000, 921600, 2250000};
+#define BAUD_COUNT (sizeof(bauds) / sizeof(bauds[0]))
+
+#define FRAME_LEN 26            // RC channels frame
+#define FRAME_INTERVAL_US 4000  // 250Hz, the fastest 115200 allows
+#define WDT_MS 1000             // UART watchdog interval
+#define WDT_SWITCHED_MS 250     // watchdog interval after switching baud
+
+static GENERIC_CRC8 crsf_crc(CRSF_CRC_POLY);
+static uint32_t rngState;
+
+static uint32_t rng()
+{
+    rngState = rngState * 1664525 + 1013904223;
+    return rngState >> 8;
+}
+
+typedef struct {
+    uint8_t bits[FRAME_LEN * 10];
+    uint16_t count;
+} lineBits_t;
+
+// An RC frame as it goes on the wire, 8N1 LSB first
+static void makeFrame(uint8_t syncByte, lineBits_t &line)
+{
+    uint8_t frame[FRAME_LEN];
+    frame[0] = syncByte;
+    frame[1] = FRAME_LEN - 2;
+    frame[2] = CRSF_FRAMETYPE_RC_CHANNELS_PACKED;
+    for (uint8_t i = 3; i < FRAME_LEN - 1; i++)
+        frame[i] = rng();
+    frame[FRAME_LEN - 1] = crsf_crc.calc(&frame[2], FRAME_LEN - 3);
+
+    line.count = 0;
+    for (uint8_t i = 0; i < FRAME_LEN; i++)
+    {
+        line.bits[line.count++] = 0;
+        for (uint8_t b = 0; b < 8; b++)
+            line.bits[line.count++] = (frame[i] >> b) & 1;
+        line.bits[line.count++] = 1;
+    }
+}
+
+static uint8_t level(const lineBits_t &line, int32_t baud, double t)
+{
+    const int32_t bit = (int32_t)(t * baud);
+    return (t < 0 || bit >= line.count) ? 1 : line.bits[bit];
+}
+
+// First falling edge at or after t, -1 if there is none
+static double nextFallingEdge(const lineBits_t &line, int32_t baud, double t)
+{
+    for (int32_t k = t <= 0 ? 0 : (int32_t)(t * baud - 1e-9) + 1; k < line.count; k++)
+    {
+        if (line.bits[k] == 0 && (k == 0 || line.bits[k - 1] == 1))
+            return (double)k / baud;
+    }
+    return -1;
+}
+
+// What a UART at uartBaud makes of the frame, returns true if it is received with a good CRC
+static bool uartReceive(const lineBits_t &line, int32_t lineBaud, int32_t uartBaud)
+{
+    uint8_t rx[64];
+    uint8_t count = 0;
+    double t = 0;
+    while (count < sizeof(rx))
+    {
+        const double start = nextFallingEdge(line, lineBaud, t);
+        if (start < 0)
+            break;
+        uint8_t value = 0;
+        for (uint8_t b = 0; b < 8; b++)
+            value |= level(line, lineBaud, start + (b + 1.5) / uartBaud) << b;
+        // Framing errors are dropped
+        if (level(line, lineBaud, start + 9.5 / uartBaud))
+            rx[count++] = value;
+        t = start + 9.5 / uartBaud;
+    }
+    return count == FRAME_LEN && (rx[0] == CRSF_SYNC_BYTE || rx[0] == CRSF_ADDRESS_CRSF_TRANSMITTER) &&
+           rx[1] == FRAME_LEN - 2 && crsf_crc.calc(&rx[2], FRAME_LEN - 3) == rx[FRAME_LEN - 1];
+}
+
+// The edge interrupt: a fixed latency with some jitter, and an edge that comes in while the ISR
+// is still running is only seen when it returns
+static void edgeInterrupts(const lineBits_t &line, int32_t baud, uint32_t frameStartNs, HandsetBaud &detect)
+{
+    uint32_t busyUntil = 0;
+    double t = 0;
+    double edge;
+    while ((edge = nextFallingEdge(line, baud, t)) >= 0)
+    {
+        uint32_t seen = frameStartNs + (uint32_t)(edge * 1e9) + 1500 + rng() % 200;
+        if (busyUntil - seen < 0x80000000)
+            seen = busyUntil;
+        detect.fallingEdge(seen);
+        busyUntil = seen + 1000;
+        t = edge + 0.5 / baud;
+    }
+}
+
+/**
+ * Time for the TX to lock on to a handset at handsetBaud, in ms, starting from startIdx.
+ * Without the edge interrupt it can only cycle through the bauds.
+ */
+static uint32_t lockTimeMs(int32_t handsetBaud, uint8_t startIdx, bool measure, uint8_t syncByte)
+{
+    HandsetBaud detect(bauds, BAUD_COUNT, startIdx);
+    detect.begin(1000);
+    rngState = 1;
+    int32_t uartBaud = bauds[startIdx];
+    uint32_t elapsedMs = 0;
+    uint32_t windowMs = WDT_MS;
+    lineBits_t line;
+
+    while (elapsedMs < 20000)
+    {
+        uint32_t good = 0, bad = 0;
+        for (uint32_t us = 0; us < windowMs * 1000; us += FRAME_INTERVAL_US)
+        {
+            makeFrame(syncByte, line);
+            if (measure)
+                edgeInterrupts(line, handsetBaud, (elapsedMs * 1000 + us) * 1000, detect);
+            if (uartReceive(line, handsetBaud, uartBaud))
+                good++;
+            else
+                bad++;
+        }
+        elapsedMs += windowMs;
+        if (good > bad)
+            return elapsedMs;
+        uartBaud = detect.next();
+        windowMs = WDT_SWITCHED_MS;
+    }
+    return elapsedMs;
+}
+
+void test_mismatched_baud_no_frames(void)
+{
+    // Only the right baud gets frames through
+    lineBits_t line;
+    rngState = 1;
+    for (int32_t lineBaud : bauds)
+    {
+        for (int32_t uartBaud : bauds)
+        {
+            for (uint8_t i = 0; i < 10; i++)
+            {
+                makeFrame(CRSF_ADDRESS_CRSF_TRANSMITTER, line);
+                TEST_ASSERT_EQUAL(lineBaud == uartBaud, uartReceive(line, lineBaud, uartBaud));
+            }
+        }
+    }
+}
+
+void test_measure_sync_byte(void)
+{
+    // Both sync bytes give the baud, at any baud an interrupt can time
+    static const uint8_t syncBytes[] = {CRSF_SYNC_BYTE, CRSF_ADDRESS_CRSF_TRANSMITTER};
+    lineBits_t line;
+    for (uint8_t syncByte : syncBytes)
+    {
+        for (int32_t baud : {115200, 400000})
+        {
+            HandsetBaud detect(bauds, BAUD_COUNT, 0);
+            detect.begin(1000);
+            for (uint8_t i = 0; i < HANDSET_BAUD_VOTES; i++)
+            {
+                TEST_ASSERT_EQUAL(0, detect.measured());
+                makeFrame(syncByte, line);
+                edgeInterrupts(line, baud, i * FRAME_INTERVAL_US * 1000, detect);
+            }
+            TEST_ASSERT_EQUAL(baud, detect.measured());
+        }
+    }
+}
+
+void test_too_fast_not_measured(void)
+{
+    // A sync byte shorter than the interrupt can time is not taken for any baud, even timed exactly
+    HandsetBaud detect(bauds, BAUD_COUNT, 0);
+    detect.begin(1000);
+    uint32_t now = 0;
+    for (int32_t baud : {921600, 1870000, 2250000, 3750000, 5250000})
+    {
+        for (uint8_t i = 0; i < HANDSET_BAUD_VOTES; i++)
+        {
+            now += 1000000;
+            detect.fallingEdge(now);
+            detect.fallingEdge(now + HANDSET_BAUD_SYNC_BITS * 1000000000ULL / baud);
+        }
+        TEST_ASSERT_EQUAL(0, detect.measured());
+    }
+}
+
+// Sync bytes that agree on baud, as noise on the line could
+static void injectSyncBytes(HandsetBaud &detect, uint32_t &now, int32_t baud)
+{
+    for (uint8_t i = 0; i < HANDSET_BAUD_VOTES; i++)
+    {
+        now += 1000000;
+        detect.fallingEdge(now);
+        detect.fallingEdge(now + HANDSET_BAUD_SYNC_BITS * 1000000000ULL / baud);
+    }
+}
+
+void test_failed_measurement_cycles(void)
+{
+    // The sync bytes keep pointing at a baud that does not work, every baud must still be tried
+    HandsetBaud detect(bauds, BAUD_COUNT, BAUD_COUNT - 1);
+    detect.begin(1000);
+    uint32_t now = 0;
+    uint8_t tried = 0;
+    for (uint8_t i = 0; i < BAUD_COUNT + 1; i++)
+    {
+        injectSyncBytes(detect, now, 400000);
+        const uint32_t baud = detect.next();
+        for (uint8_t b = 0; b < BAUD_COUNT; b++)
+        {
+            if (bauds[b] == (int32_t)baud)
+                tried |= 1 << b;
+        }
+    }
+    TEST_ASSERT_EQUAL((1 << BAUD_COUNT) - 1, tried);
+
+    // Once connected at another baud the measurement is trusted again
+    TEST_ASSERT_EQUAL(115200, detect.next());
+    detect.connected();
+    injectSyncBytes(detect, now, 400000);
+    TEST_ASSERT_EQUAL(400000, detect.next());
+}
+
+void test_measure_rejects_noise(void)
+{
+    HandsetBaud detect(bauds, BAUD_COUNT, 0);
+    detect.begin(1000);
+    uint32_t now = 0;
+    // Pairs of edges that are no baud's sync byte
+    for (uint8_t i = 0; i < 10; i++)
+    {
+        now += 1000000;
+        detect.fallingEdge(now);
+        detect.fallingEdge(now + 30000);
+    }
+    TEST_ASSERT_EQUAL(0, detect.measured());
+
+    // A bad measurement starts the count again
+    const uint32_t sync400k = HANDSET_BAUD_SYNC_BITS * 1000000000ULL / 400000;
+    for (uint8_t i = 0; i < HANDSET_BAUD_VOTES; i++)
+    {
+        now += 1000000;
+        detect.fallingEdge(now);
+        detect.fallingEdge(now + (i == 1 ? 30000 : sync400k));
+    }
+    TEST_ASSERT_EQUAL(0, detect.measured());
+    for (uint8_t i = 0; i < HANDSET_BAUD_VOTES - 1; i++)
+    {
+        now += 1000000;
+        detect.fallingEdge(now);
+        detect.fallingEdge(now + sync400k);
+    }
+    TEST_ASSERT_EQUAL(400000, detect.measured());
+}
+
+void test_fallback_cycles(void)
+{
+    // With nothing measured every baud is tried in turn
+    HandsetBaud detect(bauds, BAUD_COUNT, BAUD_COUNT - 1);
+    detect.begin(1000);
+    for (uint8_t i = 0; i < 2 * BAUD_COUNT; i++)
+        TEST_ASSERT_EQUAL(bauds[i % BAUD_COUNT], detect.next());
+}
+
+void test_lock_time(void)
+{
+    printf("\n");
+    for (int32_t handsetBaud : bauds)
+    {
+        uint32_t worstCycling = 0;
+        uint32_t worstMeasured = 0;
+        for (uint8_t start = 0; start < BAUD_COUNT; start++)
+        {
+            const uint32_t cycling = lockTimeMs(handsetBaud, start, false, CRSF_ADDRESS_CRSF_TRANSMITTER);
+            const uint32_t measured = lockTimeMs(handsetBaud, start, true, CRSF_ADDRESS_CRSF_TRANSMITTER);
+            if (cycling > worstCycling)
+                worstCycling = cycling;
+            if (measured > worstMeasured)
+                worstMeasured = measured;
+            TEST_ASSERT_TRUE(measured <= cycling);
+        }
+        printf("  handset %7u baud: worst lock %4ums cycling, %4ums measured\n", handsetBaud, worstCycling, worstMeasured);
+        // Where the interrupt can time the sync byte it locks on the first switch
+        if (HANDSET_BAUD_SYNC_BITS * 1000000LL >= HANDSET_BAUD_MIN_SYNC_US * (int64_t)handsetBaud)
+            TEST_ASSERT_EQUAL(WDT_MS + WDT_SWITCHED_MS, worstMeasured);
+    }
+}
+
+// Unity setup/teardown
+void setUp() {}
+void tearDown() {}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_mismatched_baud_no_frames);
+    RUN_TEST(test_measure_sync_byte);
+    RUN_TEST(test_too_fast_not_measured);
+    RUN_TEST(test_measure_rejects_noise);
+    RUN_TEST(test_failed_measurement_cycles);
+    RUN_TEST(test_fallback_cycles);
+    RUN_TEST(test_lock_time);
+    UNITY_END();
+
+    return 0;
+}
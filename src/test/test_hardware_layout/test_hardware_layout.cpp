@@ -0,0 +1,140 @@
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <unity.h>
+#include "HardwareLayout.h"
+
+// hardware_layout.encode({'serial_rx': 3, 'serial_tx': 1, 'radio_dcdc': True,
+//                         'power_values': [10, 20, -5], 'power_pdet_slope': 0.5})
+// with the zero padding to the slot size removed
+static const uint8_t layout[] = {
+    0x45, 0x4c, 0x48, 0x57, 0x01, 0x71, 0x03, 0x00, 0xdf, 0xd1, 0x3f, 0x9a, 0xd9, 0x52, 0x49, 0x58,
+    0x03, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff,
+    0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x3f, 0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff,
+    0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff,
+    0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff,
+    0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0x0a, 0x00, 0x14, 0x00, 0xfb, 0xff,};
+
+// From python/hardware_layout.py, test_schema checks they match the C++ field table
+static constexpr uint8_t FIELD_COUNT = 113;
+static constexpr uint32_t SCHEMA = 0x9a3fd1df;
+
+static int32_t value(const uint8_t *blob, int field)
+{
+    int32_t v;
+    memcpy(&v, blob + sizeof(hardwareLayoutHeader_t) + field * sizeof(int32_t), sizeof(v));
+    return v;
+}
+
+void test_crc32(void)
+{
+    TEST_ASSERT_EQUAL_HEX32(0xCBF43926, hardwareLayout_Crc32("123456789", 9));
+    // can be computed in pieces
+    TEST_ASSERT_EQUAL_HEX32(0xCBF43926, hardwareLayout_Crc32("6789", 4, hardwareLayout_Crc32("12345", 5)));
+}
+
+void test_schema(void)
+{
+    TEST_ASSERT_EQUAL(HARDWARE_LAST, FIELD_COUNT);
+    TEST_ASSERT_EQUAL_HEX32(SCHEMA, hardwareLayout_Schema());
+    for (uint8_t i = 0; i < HARDWARE_LAST; i++)
+    {
+        TEST_ASSERT_EQUAL(i, hardwareFields[i].position);
+    }
+}
+
+void test_layout_valid(void)
+{
+    TEST_ASSERT_EQUAL(sizeof(layout), hardwareLayout_Check(layout, sizeof(layout), FIELD_COUNT, SCHEMA));
+    // the slot is padded, extra bytes are ignored
+    std::vector<uint8_t> slot(layout, layout + sizeof(layout));
+    slot.resize(1024, 0);
+    TEST_ASSERT_EQUAL(sizeof(layout), hardwareLayout_Check(slot.data(), slot.size(), FIELD_COUNT, SCHEMA));
+
+    TEST_ASSERT_EQUAL(3, value(layout, 0));     // serial_rx
+    TEST_ASSERT_EQUAL(1, value(layout, 1));     // serial_tx
+    TEST_ASSERT_EQUAL(1, value(layout, 17));    // radio_dcdc
+    TEST_ASSERT_EQUAL(0, value(layout, 38));    // power_values, index into the pool
+    TEST_ASSERT_EQUAL(3, value(layout, 39));    // power_values count
+    TEST_ASSERT_EQUAL(-1, value(layout, 40));   // power_values2 unset
+
+    const int32_t slopeBits = value(layout, 36);
+    float slope;
+    memcpy(&slope, &slopeBits, sizeof(slope));
+    TEST_ASSERT_EQUAL_FLOAT(0.5f, slope);
+
+    int16_t pool[3];
+    memcpy(pool, layout + sizeof(hardwareLayoutHeader_t) + FIELD_COUNT * sizeof(int32_t), sizeof(pool));
+    TEST_ASSERT_EQUAL(10, pool[0]);
+    TEST_ASSERT_EQUAL(20, pool[1]);
+    TEST_ASSERT_EQUAL(-5, pool[2]);
+}
+
+void test_layout_rejected(void)
+{
+    std::vector<uint8_t> blob(layout, layout + sizeof(layout));
+
+    // made for a different field table
+    TEST_ASSERT_EQUAL(0, hardwareLayout_Check(blob.data(), blob.size(), FIELD_COUNT, SCHEMA ^ 1));
+    TEST_ASSERT_EQUAL(0, hardwareLayout_Check(blob.data(), blob.size(), FIELD_COUNT - 1, SCHEMA));
+
+    // truncated
+    TEST_ASSERT_EQUAL(0, hardwareLayout_Check(blob.data(), blob.size() - 1, FIELD_COUNT, SCHEMA));
+    TEST_ASSERT_EQUAL(0, hardwareLayout_Check(blob.data(), sizeof(hardwareLayoutHeader_t) - 1, FIELD_COUNT, SCHEMA));
+
+    // corrupted value
+    blob[sizeof(hardwareLayoutHeader_t) + 5] ^= 0x10;
+    TEST_ASSERT_EQUAL(0, hardwareLayout_Check(blob.data(), blob.size(), FIELD_COUNT, SCHEMA));
+    blob[sizeof(hardwareLayoutHeader_t) + 5] ^= 0x10;
+
+    // other version
+    blob[4]++;
+    TEST_ASSERT_EQUAL(0, hardwareLayout_Check(blob.data(), blob.size(), FIELD_COUNT, SCHEMA));
+    blob[4]--;
+
+    // erased flash
+    std::vector<uint8_t> erased(1024, 0xFF);
+    TEST_ASSERT_EQUAL(0, hardwareLayout_Check(erased.data(), erased.size(), FIELD_COUNT, SCHEMA));
+
+    TEST_ASSERT_EQUAL(sizeof(layout), hardwareLayout_Check(blob.data(), blob.size(), FIELD_COUNT, SCHEMA));
+}
+
+// Unity setup/teardown
+void setUp() {}
+void tearDown() {}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_crc32);
+    RUN_TEST(test_schema);
+    RUN_TEST(test_layout_valid);
+    RUN_TEST(test_layout_rejected);
+    UNITY_END();
+
+    return 0;
+}
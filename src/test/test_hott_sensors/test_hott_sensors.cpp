@@ -0,0 +1,540 @@
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <unity.h>
+#include "HoTTSensors.h"
+#include "CRSFRouter.h"
+
+/*
+ * The sensor map against the getHoTT*() accessors and sendCRSF*() builders SerialHoTT_TLM had
+ * before, for the same HoTT frames. Fields are filled with pseudo random bytes so every field
+ * goes through the scaling, and the CRSF frames have to match byte for byte.
+ */
+
+CRSFRouter crsfRouter;
+
+#define TEST_ITERATIONS 200
+
+typedef std::vector<uint8_t> frame_t;
+
+// The devices seen and their last frame, as SerialHoTT_TLM kept them before
+typedef struct {
+    bool present[LAST_DEVICE];
+    GPSPacket_t gps;
+    ElectricAirPacket_t eam;
+    GeneralAirPacket_t gam;
+    AirESCPacket_t esc;
+    VarioPacket_t vario;
+} refSensors_t;
+
+static const uint8_t DegMinScale = 100;
+static const uint8_t SecScale = 100;
+static const uint8_t MinDivide = 6;
+static const int32_t MinScale = 1000000L;
+static const int32_t DegScale = 10000000L;
+
+static uint32_t seed;
+
+static uint8_t nextRandom()
+{
+    seed = seed * 1103515245 + 12345;
+    return seed >> 16;
+}
+
+static void fillRandom(void *packet, size_t len)
+{
+    uint8_t *bytes = (uint8_t *)packet;
+    for (size_t i = 0; i < len; i++)
+    {
+        bytes[i] = nextRandom();
+    }
+}
+
+static uint32_t refHtobe24(uint32_t val)
+{
+    uint8_t *ptrByte = (uint8_t *)&val;
+
+    uint8_t swp = ptrByte[0];
+    ptrByte[0] = ptrByte[2];
+    ptrByte[2] = swp;
+
+    return val;
+}
+
+static frame_t toFrame(void *crsf, crsf_frame_type_e type, uint8_t payloadSize)
+{
+    crsf_header_t *header = (crsf_header_t *)crsf;
+    crsfRouter.SetHeaderAndCrc(header, type, CRSF_FRAME_SIZE(payloadSize), CRSF_ADDRESS_RADIO_TRANSMITTER);
+    return frame_t((uint8_t *)crsf, (uint8_t *)crsf + header->frame_size + CRSF_FRAME_NOT_COUNTED_BYTES);
+}
+
+// getHoTT*() before
+static uint16_t refVoltage(const refSensors_t &s)
+{
+    if (s.present[EAM])
+        return s.eam.mainVoltage;
+    if (s.present[GAM])
+        return s.gam.inputVoltage;
+    if (s.present[ESC])
+        return s.esc.inputVoltage;
+    return 0;
+}
+
+static uint16_t refCurrent(const refSensors_t &s)
+{
+    if (s.present[EAM])
+        return s.eam.current;
+    if (s.present[GAM])
+        return s.gam.current;
+    if (s.present[ESC])
+        return s.esc.current;
+    return 0;
+}
+
+static uint32_t refCapacity(const refSensors_t &s)
+{
+    if (s.present[EAM])
+        return s.eam.capacity;
+    if (s.present[GAM])
+        return s.gam.capacity;
+    if (s.present[ESC])
+        return s.esc.capacity;
+    return 0;
+}
+
+static int16_t refAltitude(const refSensors_t &s)
+{
+    if (s.present[VARIO])
+        return s.vario.altitude;
+    if (s.present[GPS])
+        return s.gps.altitude;
+    if (s.present[EAM])
+        return s.eam.altitude;
+    if (s.present[GAM])
+        return s.gam.altitude;
+    return 0;
+}
+
+static int16_t refVv(const refSensors_t &s)
+{
+    if (s.present[VARIO])
+        return s.vario.mPerSec;
+    if (s.present[GPS])
+        return s.gps.mPerSec;
+    if (s.present[EAM])
+        return s.eam.mPerSec;
+    if (s.present[GAM])
+        return s.gam.mPerSec;
+    return 0;
+}
+
+static int32_t refCoordinate(uint8_t hemisphere, uint16_t degMin, uint16_t sec)
+{
+    uint8_t deg = degMin / DegMinScale;
+
+    int32_t coord = deg * DegScale +
+                    ((degMin - (deg * DegMinScale)) * MinScale) / MinDivide +
+                    (sec * SecScale) / MinDivide;
+
+    return hemisphere != 0 ? -coord : coord;
+}
+
+static uint16_t refHeading(const refSensors_t &s)
+{
+    uint16_t heading = s.gps.direction * 2;
+
+    if (heading > 180)
+        heading -= 360;
+
+    return heading;
+}
+
+// sendCRSF*() before, an empty frame where nothing was sent
+static frame_t refVario(const refSensors_t &s)
+{
+    if (!(s.present[VARIO] || s.present[GPS] || s.present[GAM] || s.present[EAM]))
+        return frame_t();
+
+    CRSF_MK_FRAME_T(crsf_sensor_baro_vario_t) crsfBaro = {0};
+    crsfBaro.p.altitude = htobe16(refAltitude(s) * 10 + 5000); // Hott 500 = 0m, ELRS 10000 = 0.0m
+    crsfBaro.p.verticalspd = htobe16(refVv(s) - HOTT_VSPD_OFFSET);
+    return toFrame(&crsfBaro, CRSF_FRAMETYPE_BARO_ALTITUDE, sizeof(crsf_sensor_baro_vario_t));
+}
+
+static frame_t refGps(const refSensors_t &s)
+{
+    if (!s.present[GPS])
+        return frame_t();
+
+    CRSF_MK_FRAME_T(crsf_sensor_gps_t) crsfGPS = {0};
+    crsfGPS.p.latitude = htobe32(refCoordinate(s.gps.latNS, s.gps.latDegMin, s.gps.latSec));
+    crsfGPS.p.longitude = htobe32(refCoordinate(s.gps.lonEW, s.gps.lonDegMin, s.gps.lonSec));
+    crsfGPS.p.groundspeed = htobe16(s.gps.speed * 10);
+    crsfGPS.p.gps_heading = htobe16(refHeading(s) * 100);
+    crsfGPS.p.altitude = htobe16(s.gps.mslAltitude + 1000);
+    crsfGPS.p.satellites_in_use = s.gps.satellites;
+    return toFrame(&crsfGPS, CRSF_FRAMETYPE_GPS, sizeof(crsf_sensor_gps_t));
+}
+
+static bool refBatteryDevice(const refSensors_t &s)
+{
+    return s.present[GAM] || s.present[EAM] || s.present[ESC];
+}
+
+static HoTTDevices refDeviceToUse(const refSensors_t &s)
+{
+    if (s.present[EAM])
+        return EAM;
+    if (s.present[ESC])
+        return ESC;
+    return GAM;
+}
+
+static frame_t refBattery(const refSensors_t &s)
+{
+    if (!refBatteryDevice(s))
+        return frame_t();
+
+    CRSF_MK_FRAME_T(crsf_sensor_battery_t) crsfBatt = {0};
+    crsfBatt.p.voltage = htobe16(refVoltage(s));
+    crsfBatt.p.current = htobe16(refCurrent(s));
+    crsfBatt.p.capacity = refHtobe24(refCapacity(s) * 10);
+    crsfBatt.p.remaining = s.present[GAM] ? s.gam.fuelScale : 0;
+    return toFrame(&crsfBatt, CRSF_FRAMETYPE_BATTERY_SENSOR, sizeof(crsf_sensor_battery_t));
+}
+
+static frame_t refRpm(const refSensors_t &s)
+{
+    if (!refBatteryDevice(s))
+        return frame_t();
+
+    const HoTTDevices device = refDeviceToUse(s);
+    CRSF_MK_FRAME_T(crsf_sensor_rpm_t) crsfRpm = {0};
+    crsfRpm.p.source_id = device;
+    uint8_t payloadSize = 1 + 2 * 3;
+
+    if (device == EAM)
+    {
+        crsfRpm.p.rpm0 = refHtobe24(s.eam.rpm * HOTT_RPM_SCALE);
+        payloadSize = 1 + 3;
+    }
+    else if (device == GAM)
+    {
+        crsfRpm.p.rpm0 = refHtobe24(s.gam.rpm1 * HOTT_RPM_SCALE);
+        crsfRpm.p.rpm1 = refHtobe24(s.gam.rpm2 * HOTT_RPM_SCALE);
+    }
+    else
+    {
+        crsfRpm.p.rpm0 = refHtobe24(s.esc.rpm * HOTT_RPM_SCALE);
+        crsfRpm.p.rpm1 = refHtobe24(s.esc.rpmMax * HOTT_RPM_SCALE);
+    }
+    return toFrame(&crsfRpm, CRSF_FRAMETYPE_RPM, payloadSize);
+}
+
+static frame_t refTemp(const refSensors_t &s)
+{
+    if (!refBatteryDevice(s))
+        return frame_t();
+
+    const HoTTDevices device = refDeviceToUse(s);
+    CRSF_MK_FRAME_T(crsf_sensor_temp_t) crsfTemp = {0};
+    crsfTemp.p.source_id = device;
+    uint8_t payloadSize = 1 + 2 * 2;
+
+    if (device == EAM)
+    {
+        crsfTemp.p.temperature[0] = htobe16((s.eam.temp1 - HOTT_TEMP_OFFSET) * HOTT_TEMP_SCALE);
+        crsfTemp.p.temperature[1] = htobe16((s.eam.temp2 - HOTT_TEMP_OFFSET) * HOTT_TEMP_SCALE);
+    }
+    else if (device == GAM)
+    {
+        crsfTemp.p.temperature[0] = htobe16((s.gam.temperature1 - HOTT_TEMP_OFFSET) * HOTT_TEMP_SCALE);
+        crsfTemp.p.temperature[1] = htobe16((s.gam.temperature2 - HOTT_TEMP_OFFSET) * HOTT_TEMP_SCALE);
+    }
+    else
+    {
+        crsfTemp.p.temperature[0] = htobe16((s.esc.escTemp - HOTT_TEMP_OFFSET) * HOTT_TEMP_SCALE);
+        crsfTemp.p.temperature[1] = htobe16((s.esc.becTemp - HOTT_TEMP_OFFSET) * HOTT_TEMP_SCALE);
+        crsfTemp.p.temperature[2] = htobe16((s.esc.motorTemp - HOTT_TEMP_OFFSET) * HOTT_TEMP_SCALE);
+        crsfTemp.p.temperature[3] = htobe16((s.esc.pumpTemp - HOTT_TEMP_OFFSET) * HOTT_TEMP_SCALE);
+        crsfTemp.p.temperature[4] = htobe16((s.esc.auxTemp - HOTT_TEMP_OFFSET) * HOTT_TEMP_SCALE);
+        payloadSize = 1 + 2 * 5;
+    }
+    return toFrame(&crsfTemp, CRSF_FRAMETYPE_TEMP, payloadSize);
+}
+
+static frame_t refCells(const refSensors_t &s)
+{
+    const HoTTDevices device = refDeviceToUse(s);
+    if (!refBatteryDevice(s) || device == ESC)
+        return frame_t();
+
+    CRSF_MK_FRAME_T(crsf_sensor_cells_t) crsfCells = {0};
+    crsfCells.p.source_id = device;
+    uint8_t payloadSize = 1 + 14 * 2;
+
+    if (device == EAM)
+    {
+        // cell 6 went into the slot of cell 5 before, the sensor map fixed that
+        for (int i = 0; i < 7; i++)
+        {
+            crsfCells.p.cell[i] = htobe16(s.eam.cellL[i] * HOTT_CELL_SCALE);
+            crsfCells.p.cell[7 + i] = htobe16(s.eam.cellH[i] * HOTT_CELL_SCALE);
+        }
+    }
+    else
+    {
+        crsfCells.p.cell[0] = htobe16(s.gam.voltageCell1 * HOTT_CELL_SCALE);
+        crsfCells.p.cell[1] = htobe16(s.gam.voltageCell2 * HOTT_CELL_SCALE);
+        crsfCells.p.cell[2] = htobe16(s.gam.voltageCell3 * HOTT_CELL_SCALE);
+        crsfCells.p.cell[3] = htobe16(s.gam.voltageCell4 * HOTT_CELL_SCALE);
+        crsfCells.p.cell[4] = htobe16(s.gam.voltageCell5 * HOTT_CELL_SCALE);
+        crsfCells.p.cell[5] = htobe16(s.gam.voltageCell6 * HOTT_CELL_SCALE);
+        payloadSize = 1 + 6 * 2;
+    }
+    return toFrame(&crsfCells, CRSF_FRAMETYPE_CELLS, payloadSize);
+}
+
+static frame_t refVolt(const refSensors_t &s)
+{
+    if (!refBatteryDevice(s))
+        return frame_t();
+
+    const HoTTDevices device = refDeviceToUse(s);
+    CRSF_MK_FRAME_T(crsf_sensor_cells_t) crsfVolt = {0};
+    crsfVolt.p.source_id = 128 + device;
+    uint8_t payloadSize = 1 + 2 * 3;
+
+    if (device == EAM)
+    {
+        crsfVolt.p.cell[0] = htobe16(s.eam.battVoltage1 * HOTT_VOLT_SCALE);
+        crsfVolt.p.cell[1] = htobe16(s.eam.battVoltage2 * HOTT_VOLT_SCALE);
+        crsfVolt.p.cell[2] = htobe16(s.eam.mainVoltage * HOTT_VOLT_SCALE);
+    }
+    else if (device == GAM)
+    {
+        crsfVolt.p.cell[0] = htobe16(s.gam.battery1 * HOTT_VOLT_SCALE);
+        crsfVolt.p.cell[1] = htobe16(s.gam.battery2 * HOTT_VOLT_SCALE);
+        crsfVolt.p.cell[2] = htobe16(s.gam.inputVoltage * HOTT_VOLT_SCALE);
+    }
+    else
+    {
+        crsfVolt.p.cell[0] = htobe16(s.esc.inputVoltage * HOTT_VOLT_SCALE);
+        crsfVolt.p.cell[1] = htobe16(s.esc.becVoltage * HOTT_VOLT_SCALE);
+        payloadSize = 1 + 2 * 2;
+    }
+    return toFrame(&crsfVolt, CRSF_FRAMETYPE_CELLS, payloadSize);
+}
+
+static frame_t refAirspeed(const refSensors_t &s)
+{
+    if (!refBatteryDevice(s))
+        return frame_t();
+
+    const HoTTDevices device = refDeviceToUse(s);
+    CRSF_MK_FRAME_T(crsf_sensor_airspeed_t) crsfAirspeed = {0};
+
+    if (device == EAM)
+        crsfAirspeed.p.speed = htobe16(s.eam.speed * HOTT_SPEED_SCALE_EAM);
+    else if (device == GAM)
+        crsfAirspeed.p.speed = htobe16(s.gam.speed * HOTT_SPEED_SCALE_GAM);
+    else
+        crsfAirspeed.p.speed = htobe16(s.esc.speed * HOTT_SPEED_SCALE_EAM);
+    return toFrame(&crsfAirspeed, CRSF_FRAMETYPE_AIRSPEED, sizeof(crsf_sensor_airspeed_t));
+}
+
+static frame_t refFrame(const refSensors_t &s, hottCrsfFrame_e frame)
+{
+    switch (frame)
+    {
+    case HOTT_CRSF_VARIO: return refVario(s);
+    case HOTT_CRSF_GPS: return refGps(s);
+    case HOTT_CRSF_BATTERY: return refBattery(s);
+    case HOTT_CRSF_RPM: return refRpm(s);
+    case HOTT_CRSF_TEMP: return refTemp(s);
+    case HOTT_CRSF_CELLS: return refCells(s);
+    case HOTT_CRSF_VOLT: return refVolt(s);
+    default: return refAirspeed(s);
+    }
+}
+
+static const void *refPacket(const refSensors_t &s, uint8_t device)
+{
+    switch (device)
+    {
+    case GPS: return &s.gps;
+    case EAM: return &s.eam;
+    case GAM: return &s.gam;
+    case ESC: return &s.esc;
+    default: return &s.vario;
+    }
+}
+
+static frame_t buildFrame(HoTTSensors &sensors, hottCrsfFrame_e frame)
+{
+    uint8_t buffer[CRSF_MAX_PACKET_LEN];
+    const uint8_t frameSize = sensors.buildCRSFframe(frame, buffer);
+    if (frameSize == 0)
+        return frame_t();
+    return frame_t(buffer, buffer + frameSize + CRSF_FRAME_NOT_COUNTED_BYTES);
+}
+
+static void assertFrame(const frame_t &expected, const frame_t &actual)
+{
+    TEST_ASSERT_EQUAL(expected.size(), actual.size());
+    if (!expected.empty())
+    {
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(expected.data(), actual.data(), expected.size());
+    }
+}
+
+// Random frames from the given devices, decoded in list order and in reverse, against the code before
+static void checkDevices(const std::vector<uint8_t> &devices, uint32_t excludeFrames = 0)
+{
+    for (int i = 0; i < TEST_ITERATIONS; i++)
+    {
+        refSensors_t ref {};
+        fillRandom(&ref.gps, sizeof(ref.gps));
+        fillRandom(&ref.eam, sizeof(ref.eam));
+        fillRandom(&ref.gam, sizeof(ref.gam));
+        fillRandom(&ref.esc, sizeof(ref.esc));
+        fillRandom(&ref.vario, sizeof(ref.vario));
+        for (const uint8_t device : devices)
+        {
+            ref.present[device] = true;
+        }
+
+        HoTTSensors forward;
+        HoTTSensors reverse;
+        for (size_t d = 0; d < devices.size(); d++)
+        {
+            forward.decodeFrame(devices[d], (const uint8_t *)refPacket(ref, devices[d]));
+            const uint8_t last = devices[devices.size() - 1 - d];
+            reverse.decodeFrame(last, (const uint8_t *)refPacket(ref, last));
+        }
+
+        for (uint8_t frame = 0; frame < HOTT_CRSF_FRAME_COUNT; frame++)
+        {
+            if (excludeFrames & (1 << frame))
+                continue;
+            const frame_t expected = refFrame(ref, (hottCrsfFrame_e)frame);
+            assertFrame(expected, buildFrame(forward, (hottCrsfFrame_e)frame));
+            assertFrame(expected, buildFrame(reverse, (hottCrsfFrame_e)frame));
+        }
+    }
+}
+
+void test_vario()
+{
+    checkDevices({VARIO});
+}
+
+void test_gps()
+{
+    checkDevices({GPS});
+}
+
+void test_eam()
+{
+    checkDevices({EAM});
+}
+
+void test_gam()
+{
+    checkDevices({GAM});
+}
+
+void test_esc()
+{
+    checkDevices({ESC});
+}
+
+void test_device_priorities()
+{
+    checkDevices({GPS, EAM, GAM, ESC, VARIO});
+    checkDevices({VARIO, GPS});
+    checkDevices({GPS, GAM});
+    checkDevices({EAM, GAM});
+    checkDevices({EAM, ESC});
+    checkDevices({GPS, EAM, GAM});
+}
+
+// With a GAM and an ESC the ESC was used for everything but the battery before, so no cells were
+// sent. The sensor map takes the cells from the GAM as the ESC has none.
+void test_esc_gam_cells()
+{
+    checkDevices({GAM, ESC}, 1 << HOTT_CRSF_CELLS);
+
+    refSensors_t ref {};
+    fillRandom(&ref.gam, sizeof(ref.gam));
+    fillRandom(&ref.esc, sizeof(ref.esc));
+    ref.present[GAM] = true;
+
+    HoTTSensors sensors;
+    sensors.decodeFrame(ESC, (const uint8_t *)&ref.esc);
+    sensors.decodeFrame(GAM, (const uint8_t *)&ref.gam);
+    assertFrame(refCells(ref), buildFrame(sensors, HOTT_CRSF_CELLS));
+}
+
+// The scaling of some known values, as the HoTT frame comments give them
+void test_known_values()
+{
+    HoTTSensors sensors;
+    TEST_ASSERT_FALSE(sensors.hasValue(HOTT_ALTITUDE));
+    TEST_ASSERT_EQUAL(0, buildFrame(sensors, HOTT_CRSF_VARIO).size());
+
+    GPSPacket_t gps;
+    gps.altitude = 500 + 123;                   // 123m
+    gps.mPerSec = 30000 - 250;                  // -2.5m/s
+    gps.latNS = 0;                              // N48D39'0988''
+    gps.latDegMin = 4839;
+    gps.latSec = 988;
+    gps.lonEW = 1;                              // W09D25'9360''
+    gps.lonDegMin = 925;
+    gps.lonSec = 9360;
+    gps.direction = 135;                        // 270 degrees
+    gps.speed = 54;                             // 54km/h
+    sensors.decodeFrame(GPS, (const uint8_t *)&gps);
+
+    TEST_ASSERT_EQUAL(1230, sensors.getValue(HOTT_ALTITUDE));
+    TEST_ASSERT_EQUAL(-250, sensors.getValue(HOTT_VSPD));
+    TEST_ASSERT_EQUAL(486516466, sensors.getValue(HOTT_LATITUDE));
+    TEST_ASSERT_EQUAL(-94322666, sensors.getValue(HOTT_LONGITUDE));
+    TEST_ASSERT_EQUAL(270, sensors.getValue(HOTT_HEADING));
+    TEST_ASSERT_EQUAL(540, sensors.getValue(HOTT_GROUNDSPEED));
+
+    GeneralAirPacket_t gam;
+    gam.voltageCell1 = 124;                     // 2.48V
+    gam.temperature1 = 46;                      // 26C
+    gam.inputVoltage = 166;                     // 16.6V
+    gam.capacity = 150;                         // 1500mAh
+    gam.speed = 30;                             // 60km/h
+    sensors.decodeFrame(GAM, (const uint8_t *)&gam);
+
+    TEST_ASSERT_EQUAL(1230, sensors.getValue(HOTT_ALTITUDE));   // the GPS ranks over the GAM
+    TEST_ASSERT_EQUAL(2480, sensors.getValue(HOTT_CELL_FIRST));
+    TEST_ASSERT_EQUAL(260, sensors.getValue(HOTT_TEMP_FIRST));
+    TEST_ASSERT_EQUAL(166, sensors.getValue(HOTT_VOLTAGE));
+    TEST_ASSERT_EQUAL(1500, sensors.getValue(HOTT_CAPACITY));
+    TEST_ASSERT_EQUAL(600, sensors.getValue(HOTT_AIRSPEED));
+}
+
+// Unity setup/teardown
+void setUp() {}
+void tearDown() {}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_vario);
+    RUN_TEST(test_gps);
+    RUN_TEST(test_eam);
+    RUN_TEST(test_gam);
+    RUN_TEST(test_esc);
+    RUN_TEST(test_device_priorities);
+    RUN_TEST(test_esc_gam_cells);
+    RUN_TEST(test_known_values);
+    UNITY_END();
+
+    return 0;
+}
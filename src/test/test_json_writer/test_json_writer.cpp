@@ -0,0 +1,191 @@
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <unity.h>
+#include "JsonWriter.h"
+#include "WebJson.h"
+
+static char buffer[1024];
+
+static void writeSample(JsonWriter &json)
+{
+    json.beginObject();
+    json.member("name", "elrs");
+    json.member("rate", 500);
+    json.member("offset", -12);
+    json.member("armed", false);
+    json.key("uid");
+    json.beginArray();
+    for (int i = 1; i <= 6; i++)
+        json.value(i);
+    json.endArray();
+    json.key("empty");
+    json.beginArray();
+    json.endArray();
+    json.key("nested");
+    json.beginObject();
+    json.key("list");
+    json.beginArray();
+    json.beginObject();
+    json.member("a", 1U);
+    json.endObject();
+    json.beginObject();
+    json.endObject();
+    json.null();
+    json.endArray();
+    json.endObject();
+    json.key("options");
+    json.raw("{\"domain\":1}");
+    json.endObject();
+}
+
+static const char *sampleJson =
+    "{\"name\":\"elrs\",\"rate\":500,\"offset\":-12,\"armed\":false,\"uid\":[1,2,3,4,5,6],\"empty\":[],"
+    "\"nested\":{\"list\":[{\"a\":1},{},null]},\"options\":{\"domain\":1}}";
+
+static std::string writeAll(void (*generate)(JsonWriter &json))
+{
+    JsonWriter json(buffer, sizeof(buffer));
+    generate(json);
+    TEST_ASSERT_FALSE(json.full());
+    TEST_ASSERT_EQUAL(json.total(), json.length());
+    return std::string(buffer, json.length());
+}
+
+void test_nesting(void)
+{
+    TEST_ASSERT_EQUAL_STRING(sampleJson, writeAll(writeSample).c_str());
+}
+
+static void writeEscapes(JsonWriter &json)
+{
+    json.beginArray();
+    json.value("quote\" backslash\\ slash/");
+    json.value("\b\f\n\r\t");
+    json.value("\x01\x1f\x7f \xc3\xa9");
+    json.value((const char *)nullptr);
+    json.value("abc\0def", 7);
+    json.endArray();
+}
+
+void test_escapes(void)
+{
+    TEST_ASSERT_EQUAL_STRING(
+        "[\"quote\\\" backslash\\\\ slash/\",\"\\b\\f\\n\\r\\t\",\"\\u0001\\u001f\x7f \xc3\xa9\",null,\"abc\\u0000def\"]",
+        writeAll(writeEscapes).c_str());
+}
+
+static void writeNumbers(JsonWriter &json)
+{
+    json.beginArray();
+    json.value(0);
+    json.value(INT32_MIN);
+    json.value(INT32_MAX);
+    json.value(UINT32_MAX);
+    json.value((uint8_t)255);
+    json.value((int8_t)-128);
+    json.value(true);
+    json.endArray();
+}
+
+void test_numbers(void)
+{
+    TEST_ASSERT_EQUAL_STRING("[0,-2147483648,2147483647,4294967295,255,-128,true]", writeAll(writeNumbers).c_str());
+}
+
+void test_chunks(void)
+{
+    // Any chunk size must give the same output as one pass, like a chunked response would send it
+    const size_t total = strlen(sampleJson);
+    for (size_t chunk = 1; chunk <= total + 1; chunk++)
+    {
+        std::string out;
+        size_t index = 0;
+        for (;;)
+        {
+            memset(buffer, '#', sizeof(buffer));
+            JsonWriter json(buffer, chunk, index);
+            writeSample(json);
+            TEST_ASSERT_EQUAL(total, json.total());
+            TEST_ASSERT_EQUAL('#', buffer[chunk]);  // nothing written outside the chunk
+            if (json.length() == 0)
+                break;
+            TEST_ASSERT_EQUAL(json.length() == chunk, json.full());
+            out.append(buffer, json.length());
+            index += json.length();
+        }
+        TEST_ASSERT_EQUAL_STRING(sampleJson, out.c_str());
+    }
+}
+
+static void writeTarget(JsonWriter &json)
+{
+    const web_target_info_t info = {
+        "UNIFIED_ESP32_2400_TX", "3.5.0 (abcdef)", "Generic \"ESP32\" TX", "ELRS 2400TX",
+        "ISM2G4", "abcdef", "TX", "SX128X", false};
+    writeTargetJson(json, info);
+}
+
+void test_target_golden(void)
+{
+    TEST_ASSERT_EQUAL_STRING(
+        "{\"target\":\"UNIFIED_ESP32_2400_TX\",\"version\":\"3.5.0 (abcdef)\",\"product_name\":\"Generic \\\"ESP32\\\" TX\","
+        "\"lua_name\":\"ELRS 2400TX\",\"reg_domain\":\"ISM2G4\",\"git-commit\":\"abcdef\",\"module-type\":\"TX\","
+        "\"radio-type\":\"SX128X\",\"has-sub-ghz\":false}",
+        writeAll(writeTarget).c_str());
+}
+
+// 32 character SSIDs fill the scan record and are not NUL terminated
+static const char ssids[][32] = {
+    {'H', 'o', 'm', 'e'},
+    {},
+    {'C', 'a', 'f', '\xc3', '\xa9', ' ', '"', '5', 'G', '"'},
+    {'H', 'o', 'm', 'e'},
+    {'0', '1', '2', '3', '4', '5', '6', '7', '8', '9', '0', '1', '2', '3', '4', '5',
+     '6', '7', '8', '9', '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', '0', '1'},
+    {'H', 'o', 'm', 'e', '2'},
+    {'0', '1', '2', '3', '4', '5', '6', '7', '8', '9', '0', '1', '2', '3', '4', '5',
+     '6', '7', '8', '9', '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', '0', '1'},
+};
+
+static const char *getSsid(uint8_t index, uint8_t &len)
+{
+    len = strnlen(ssids[index], sizeof(ssids[index]));
+    return ssids[index];
+}
+
+static void writeNetworks(JsonWriter &json)
+{
+    writeNetworksJson(json, sizeof(ssids) / sizeof(ssids[0]), getSsid);
+}
+
+static void writeNoNetworks(JsonWriter &json)
+{
+    writeNetworksJson(json, 0, getSsid);
+}
+
+void test_networks_golden(void)
+{
+    TEST_ASSERT_EQUAL_STRING(
+        "[\"Home\",\"Caf\xc3\xa9 \\\"5G\\\"\",\"01234567890123456789012345678901\",\"Home2\"]",
+        writeAll(writeNetworks).c_str());
+    TEST_ASSERT_EQUAL_STRING("[]", writeAll(writeNoNetworks).c_str());
+}
+
+// Unity setup/teardown
+void setUp() {}
+void tearDown() {}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_nesting);
+    RUN_TEST(test_escapes);
+    RUN_TEST(test_numbers);
+    RUN_TEST(test_chunks);
+    RUN_TEST(test_target_golden);
+    RUN_TEST(test_networks_golden);
+    UNITY_END();
+
+    return 0;
+}
@@ -0,0 +1,218 @@
+#include <cstdint>
+#include <cstdio>
+#include <unity.h>
+#include "LbtThreshold.h"
+
+/*
+ * Simulation harness: a TX hopping over the channels and doing a CCA before each packet. Every
+ * channel has its noise floor, some have another user that is on the air part of the time.
+ */
+
+#define SIM_CHANNELS 40
+#define SIM_HOPS 40000
+#define SIM_LIMIT -71       // EN 300 328 for 100mW on the SX1280
+
+typedef struct {
+    int8_t floorDbm;
+    int8_t userDbm;     // the other user's level, 0 for none
+    uint8_t userDuty;   // % of the time the other user is on the air
+} simChannel_t;
+
+typedef struct {
+    uint32_t sentIntoUser;  // packets sent over the other user
+    uint32_t userSlots;
+    uint32_t deferredFree;  // packets held back with nobody else on the air
+    uint32_t freeSlots;
+} simResult_t;
+
+static uint32_t rngState;
+
+static uint32_t rand32()
+{
+    rngState = rngState * 1664525 + 1013904223;
+    return rngState >> 8;
+}
+
+// Instant RSSI wanders a few dB
+static int8_t reading(int8_t level)
+{
+    return level + (int8_t)(rand32() % 5) - 2;
+}
+
+static void simulate(const simChannel_t *channels, bool adaptive, simResult_t &result)
+{
+    LbtThreshold lbt;
+    rngState = 1;
+    result = simResult_t{0, 0, 0, 0};
+    for (uint32_t hop = 0; hop < SIM_HOPS; hop++)
+    {
+        const uint8_t ch = (hop * 7) % SIM_CHANNELS;
+        const bool userOn = channels[ch].userDbm != 0 && rand32() % 100 < channels[ch].userDuty;
+        const int8_t rssi = reading(userOn ? channels[ch].userDbm : channels[ch].floorDbm);
+        const bool send = adaptive ? lbt.check(0, ch, rssi, SIM_LIMIT) != LBT_BUSY : rssi < SIM_LIMIT;
+
+        if (userOn)
+        {
+            result.userSlots++;
+            result.sentIntoUser += send;
+        }
+        else
+        {
+            result.freeSlots++;
+            result.deferredFree += !send;
+        }
+    }
+}
+
+void test_crowded_band(void)
+{
+    // Quiet channels, channels with a weak user under the limit, a strong one over it, and
+    // channels with a noise floor close to the limit
+    simChannel_t channels[SIM_CHANNELS];
+    for (uint8_t ch = 0; ch < SIM_CHANNELS; ch++)
+    {
+        switch (ch % 4)
+        {
+        case 0: channels[ch] = simChannel_t{-100, 0, 0}; break;
+        case 1: channels[ch] = simChannel_t{-98, -80, 30}; break;
+        case 2: channels[ch] = simChannel_t{-97, -55, 20}; break;
+        case 3: channels[ch] = simChannel_t{-76, 0, 0}; break;
+        }
+    }
+
+    simResult_t fixed, adaptive;
+    simulate(channels, false, fixed);
+    simulate(channels, true, adaptive);
+    printf("\n  fixed:    sent into another user %5.1f%%, held back on a free channel %4.1f%%\n",
+           100.0f * fixed.sentIntoUser / fixed.userSlots, 100.0f * fixed.deferredFree / fixed.freeSlots);
+    printf("  adaptive: sent into another user %5.1f%%, held back on a free channel %4.1f%%\n",
+           100.0f * adaptive.sentIntoUser / adaptive.userSlots, 100.0f * adaptive.deferredFree / adaptive.freeSlots);
+
+    // The weak user is heard, the limit still stops the strong one
+    TEST_ASSERT_TRUE(adaptive.sentIntoUser * 2 < fixed.sentIntoUser);
+    // and the free channels, noisy ones included, are not held back any more than before
+    TEST_ASSERT_TRUE(adaptive.deferredFree <= fixed.deferredFree + fixed.freeSlots / 100);
+}
+
+void test_floor_follows_quiet_level(void)
+{
+    // A user on the air 30% of the time hardly moves the floor
+    LbtThreshold lbt;
+    rngState = 1;
+    for (int i = 0; i < 500; i++)
+        lbt.check(0, 3, reading(rand32() % 100 < 30 ? -60 : -95), SIM_LIMIT);
+    TEST_ASSERT_INT_WITHIN(3, -95, lbt.noiseFloor(3));
+    TEST_ASSERT_INT_WITHIN(3, -85, lbt.threshold(3, SIM_LIMIT));
+
+    // Each channel has its own
+    TEST_ASSERT_EQUAL(LBT_NO_FLOOR, lbt.noiseFloor(4));
+    TEST_ASSERT_EQUAL(SIM_LIMIT, lbt.threshold(4, SIM_LIMIT));
+    for (int i = 0; i < 50; i++)
+        lbt.check(0, 4, -104, SIM_LIMIT);
+    TEST_ASSERT_EQUAL(-104, lbt.noiseFloor(4));
+    TEST_ASSERT_INT_WITHIN(3, -95, lbt.noiseFloor(3));
+
+    // A quieter level takes over quickly
+    for (int i = 0; i < 10; i++)
+        lbt.check(0, 3, -104, SIM_LIMIT);
+    TEST_ASSERT_INT_WITHIN(1, -104, lbt.noiseFloor(3));
+
+    lbt.reset();
+    TEST_ASSERT_EQUAL(LBT_NO_FLOOR, lbt.noiseFloor(3));
+}
+
+void test_never_over_the_limit(void)
+{
+    // A channel that has only ever been busy moves its floor up to the user, the threshold stays
+    // at the regulatory limit and a reading over it is always busy
+    LbtThreshold lbt;
+    for (int i = 0; i < 2000; i++)
+    {
+        TEST_ASSERT_EQUAL(LBT_BUSY, lbt.check(0, 0, -50, SIM_LIMIT));
+        TEST_ASSERT_TRUE(lbt.threshold(0, SIM_LIMIT) <= SIM_LIMIT);
+    }
+    TEST_ASSERT_EQUAL(LBT_CLEAR, lbt.check(0, 0, SIM_LIMIT - 1, SIM_LIMIT));
+}
+
+void test_forced_after_deferrals(void)
+{
+    LbtThreshold lbt;
+    for (int i = 0; i < 20; i++)
+        lbt.check(0, 0, -100, SIM_LIMIT);
+    TEST_ASSERT_EQUAL(-90, lbt.threshold(0, SIM_LIMIT));
+
+    // Under the limit but over the adaptive threshold: held back a few times, then sent
+    for (uint8_t i = 0; i < LbtThresholdDefaultConfig.maxDeferrals; i++)
+        TEST_ASSERT_EQUAL(LBT_BUSY, lbt.check(0, 0, -80, SIM_LIMIT));
+    TEST_ASSERT_EQUAL(LBT_FORCED, lbt.check(0, 0, -80, SIM_LIMIT));
+    TEST_ASSERT_EQUAL(LBT_BUSY, lbt.check(0, 0, -80, SIM_LIMIT));
+
+    // A clear channel starts the count again
+    TEST_ASSERT_EQUAL(LBT_CLEAR, lbt.check(0, 0, -100, SIM_LIMIT));
+    TEST_ASSERT_EQUAL(LBT_BUSY, lbt.check(0, 0, -80, SIM_LIMIT));
+    // Never over the limit, however many deferrals
+    for (int i = 0; i < 10; i++)
+        TEST_ASSERT_EQUAL(LBT_BUSY, lbt.check(0, 0, SIM_LIMIT, SIM_LIMIT));
+}
+
+void test_deferrals_per_radio_and_channel(void)
+{
+    LbtThreshold lbt;
+    for (int i = 0; i < 20; i++)
+    {
+        lbt.check(0, 0, -100, SIM_LIMIT);
+        lbt.check(0, 1, -100, SIM_LIMIT);
+    }
+
+    // Deferring channel 0 on radio 0 does not use up the deferrals of the other radio or channel
+    for (uint8_t i = 0; i < LbtThresholdDefaultConfig.maxDeferrals; i++)
+        TEST_ASSERT_EQUAL(LBT_BUSY, lbt.check(0, 0, -80, SIM_LIMIT));
+    TEST_ASSERT_EQUAL(LBT_BUSY, lbt.check(1, 0, -80, SIM_LIMIT));
+    TEST_ASSERT_EQUAL(LBT_BUSY, lbt.check(0, 1, -80, SIM_LIMIT));
+
+    // And a clear reading on channel 1 does not start channel 0's count again
+    TEST_ASSERT_EQUAL(LBT_CLEAR, lbt.check(0, 1, -100, SIM_LIMIT));
+    TEST_ASSERT_EQUAL(LBT_FORCED, lbt.check(0, 0, -80, SIM_LIMIT));
+}
+
+void test_audit_log(void)
+{
+    LbtAuditLog audit;
+    TEST_ASSERT_EQUAL(0, audit.count());
+    for (uint32_t i = 0; i < LBT_AUDIT_SIZE + 5; i++)
+        audit.add(1000 + i, i % 4 == 3 ? LBT_FORCED : LBT_BUSY, i % 2, i, -80, -90);
+
+    TEST_ASSERT_EQUAL(LBT_AUDIT_SIZE, audit.count());
+    TEST_ASSERT_EQUAL(1005, audit.get(0).timeMs);
+    TEST_ASSERT_EQUAL(5, audit.get(0).channel);
+    TEST_ASSERT_EQUAL(1, audit.get(0).radio);
+    TEST_ASSERT_EQUAL(1000 + LBT_AUDIT_SIZE + 4, audit.get(LBT_AUDIT_SIZE - 1).timeMs);
+    TEST_ASSERT_EQUAL(LBT_FORCED, audit.get(LBT_AUDIT_SIZE - 2).result);
+    TEST_ASSERT_EQUAL(-80, audit.get(1).rssi);
+    TEST_ASSERT_EQUAL(-90, audit.get(1).threshold);
+    // The totals count the ones that have been overwritten
+    TEST_ASSERT_EQUAL(9, audit.forced());
+    TEST_ASSERT_EQUAL(LBT_AUDIT_SIZE + 5 - 9, audit.deferred());
+
+    audit.clear();
+    TEST_ASSERT_EQUAL(0, audit.count());
+    TEST_ASSERT_EQUAL(0, audit.forced());
+}
+
+// Unity setup/teardown
+void setUp() {}
+void tearDown() {}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_crowded_band);
+    RUN_TEST(test_floor_follows_quiet_level);
+    RUN_TEST(test_never_over_the_limit);
+    RUN_TEST(test_forced_after_deferrals);
+    RUN_TEST(test_deferrals_per_radio_and_channel);
+    RUN_TEST(test_audit_log);
+    UNITY_END();
+
+    return 0;
+}
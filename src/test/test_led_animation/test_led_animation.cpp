@@ -0,0 +1,196 @@
+#include <cstdint>
+#include <cstdlib>
+#include <unity.h>
+#include "led_animation.h"
+
+static const ledKeyframe_t blink[] = {
+    {10, 255, 255, 0, 100},
+    {10, 255, 0, 0, 300},
+};
+
+static const ledKeyframe_t breathe[] = {
+    {0, 255, 255, LED_KEYFRAME_FADE | LED_KEYFRAME_BASE_HUE, 1000},
+    {0, 255, 0, LED_KEYFRAME_FADE | LED_KEYFRAME_BASE_HUE, 1000},
+};
+
+static const ledKeyframe_t rainbow[] = {
+    {0, 255, 255, 0, 0},
+    {255, 255, 255, LED_KEYFRAME_FADE, 2550},
+    {255, 255, 0, LED_KEYFRAME_FADE, 300},
+};
+
+static int channel(uint32_t rgb, int shift)
+{
+    return (rgb >> shift) & 0xFF;
+}
+
+static void assertColorWithin(int delta, uint32_t expected, uint32_t actual)
+{
+    TEST_ASSERT_INT_WITHIN(delta, channel(expected, 16), channel(actual, 16));
+    TEST_ASSERT_INT_WITHIN(delta, channel(expected, 8), channel(actual, 8));
+    TEST_ASSERT_INT_WITHIN(delta, channel(expected, 0), channel(actual, 0));
+}
+
+void test_gamma(void)
+{
+    TEST_ASSERT_EQUAL_HEX32(0x000000, GammaCorrect(0x000000));
+    TEST_ASSERT_EQUAL_HEX32(0xFFFFFF, GammaCorrect(0xFFFFFF));
+    // half perceived brightness is about a fifth of the power
+    TEST_ASSERT_EQUAL_HEX32(0x383838, GammaCorrect(0x808080));
+    uint32_t last = 0;
+    for (uint32_t i = 0; i < 256; i++)
+    {
+        const uint32_t c = GammaCorrect(i);
+        TEST_ASSERT_TRUE(c >= last);
+        last = c;
+    }
+}
+
+void test_hold_only_changes_on_steps(void)
+{
+    LedAnimation animation;
+    const ledEffect_t effect = LED_EFFECT(blink, true);
+    const uint32_t on = GammaCorrect(HsvToRgb({10, 255, 255}));
+
+    animation.start(effect, 0, 1000);
+    TEST_ASSERT_TRUE(animation.update(1000));
+    TEST_ASSERT_EQUAL_HEX32(on, animation.getColor());
+    TEST_ASSERT_EQUAL(100, animation.nextUpdate(1000));
+
+    TEST_ASSERT_FALSE(animation.update(1050));
+    TEST_ASSERT_EQUAL(50, animation.nextUpdate(1050));
+
+    TEST_ASSERT_TRUE(animation.update(1100));
+    TEST_ASSERT_EQUAL_HEX32(0, animation.getColor());
+    TEST_ASSERT_EQUAL(300, animation.nextUpdate(1100));
+
+    TEST_ASSERT_TRUE(animation.update(1400));
+    TEST_ASSERT_EQUAL_HEX32(on, animation.getColor());
+
+    // late by several loops, still in step
+    TEST_ASSERT_TRUE(animation.update(1400 + 10 * 400 + 150));
+    TEST_ASSERT_EQUAL_HEX32(0, animation.getColor());
+    TEST_ASSERT_EQUAL(250, animation.nextUpdate(1400 + 10 * 400 + 150));
+    TEST_ASSERT_FALSE(animation.isDone());
+}
+
+void test_fade(void)
+{
+    LedAnimation animation;
+    const ledEffect_t effect = LED_EFFECT(breathe, true);
+
+    // fades up from the end of the loop using the base hue
+    animation.start(effect, 170, 0);
+    animation.update(0);
+    TEST_ASSERT_EQUAL_HEX32(0, animation.getColor());
+    TEST_ASSERT_EQUAL(LED_ANIMATION_TICK, animation.nextUpdate(0));
+
+    animation.update(500);
+    const uint32_t half = GammaCorrect(HsvToRgb({170, 255, 127}));
+    assertColorWithin(2, half, animation.getColor());
+
+    animation.update(1000);
+    TEST_ASSERT_EQUAL_HEX32(GammaCorrect(HsvToRgb({170, 255, 255})), animation.getColor());
+
+    // then back down
+    animation.update(1990);
+    TEST_ASSERT_EQUAL(10, animation.nextUpdate(1990));
+    animation.update(2000);
+    TEST_ASSERT_EQUAL_HEX32(0, animation.getColor());
+
+    // brightness is monotonic through the fade
+    uint32_t last = 0;
+    for (uint32_t now = 2000; now < 3000; now += LED_ANIMATION_TICK)
+    {
+        animation.update(now);
+        TEST_ASSERT_TRUE(channel(animation.getColor(), 0) >= channel(last, 0));
+        last = animation.getColor();
+    }
+}
+
+void test_hue_fade_follows_wheel(void)
+{
+    LedAnimation animation;
+    const ledEffect_t effect = LED_EFFECT(rainbow, false);
+    animation.start(effect, 0, 0);
+
+    // A plain RGB fade from red to red would stay red, it must go around the colour wheel
+    for (uint32_t now = 0; now < 2550; now += 10)
+    {
+        animation.update(now);
+        const uint8_t hue = now / 10;
+        assertColorWithin(10, GammaCorrect(HsvToRgb({hue, 255, 255})), animation.getColor());
+    }
+}
+
+void test_done(void)
+{
+    LedAnimation animation;
+    const ledEffect_t effect = LED_EFFECT(rainbow, false);
+    animation.start(effect, 0, 0);
+    animation.update(2700);
+    TEST_ASSERT_FALSE(animation.isDone());
+    TEST_ASSERT_TRUE(animation.update(2850));
+    TEST_ASSERT_TRUE(animation.isDone());
+    TEST_ASSERT_EQUAL_HEX32(0, animation.getColor());
+    TEST_ASSERT_EQUAL(LED_ANIMATION_IDLE, animation.nextUpdate(2850));
+    TEST_ASSERT_FALSE(animation.update(10000));
+
+    // other LEDs ahead in the effect
+    animation.start(effect, 0, 0);
+    assertColorWithin(10, GammaCorrect(HsvToRgb({100, 255, 255})), animation.getColorAt(0, 1000));
+    TEST_ASSERT_EQUAL_HEX32(0, animation.getColorAt(2000, 1000));
+}
+
+void test_set_color(void)
+{
+    LedAnimation animation;
+    animation.setColor({85, 255, 128}, 0);
+    TEST_ASSERT_TRUE(animation.update(0));
+    TEST_ASSERT_EQUAL_HEX32(GammaCorrect(HsvToRgb({85, 255, 128})), animation.getColor());
+    TEST_ASSERT_TRUE(animation.isDone());
+    TEST_ASSERT_EQUAL(LED_ANIMATION_IDLE, animation.nextUpdate(0));
+
+    // setting the same colour again is not a change
+    animation.setColor({85, 255, 128}, 100);
+    TEST_ASSERT_FALSE(animation.update(100));
+}
+
+void test_step_limit(void)
+{
+    // several turns around the colour wheel fit in the step table
+    static const ledKeyframe_t spin[] = {
+        {0, 255, 255, 0, 0},
+        {255, 255, 255, LED_KEYFRAME_FADE, 1000},
+        {0, 255, 255, LED_KEYFRAME_FADE, 1000},
+        {255, 255, 255, LED_KEYFRAME_FADE, 1000},
+        {0, 255, 255, LED_KEYFRAME_FADE, 1000},
+    };
+    LedAnimation animation;
+    const ledEffect_t effect = LED_EFFECT(spin, true);
+    animation.start(effect, 0, 0);
+    for (uint32_t now = 0; now < 10000; now += LED_ANIMATION_TICK)
+    {
+        animation.update(now);
+        TEST_ASSERT_TRUE(animation.nextUpdate(now) <= LED_ANIMATION_TICK);
+    }
+}
+
+// Unity setup/teardown
+void setUp() {}
+void tearDown() {}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_gamma);
+    RUN_TEST(test_hold_only_changes_on_steps);
+    RUN_TEST(test_fade);
+    RUN_TEST(test_hue_fade_follows_wheel);
+    RUN_TEST(test_done);
+    RUN_TEST(test_set_color);
+    RUN_TEST(test_step_limit);
+    UNITY_END();
+
+    return 0;
+}
@@ -0,0 +1,329 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <unity.h>
+#include "LR1121Update.h"
+// LR1121Driver is not built natively, only its firmware image is used here
+#include "../../lib/LR1121Driver/lr1121_transceiver_F30104.h"
+
+/*
+ * A model of the LR1121 bootloader. The flash is NOR, programming can only clear bits so writing
+ * the same data again changes nothing. The image runs after a reboot only if the flash holds the
+ * whole of it. The power can be cut after a number of writes, then nothing answers until it is
+ * cycled, and the progress store (SPIFFS on the real thing) keeps what was saved before.
+ *
+ * The updates flash a made up image that ends part way through a block like the real one does. The
+ * real one is only checked for the id and size the driver flashes it with.
+ */
+
+#define IMAGE_WORDS 8200
+#define IMAGE_BYTES (IMAGE_WORDS * 4)
+#define IMAGE_BLOCKS ((IMAGE_BYTES + LR1121_UPDATE_BLOCK_SIZE - 1) / LR1121_UPDATE_BLOCK_SIZE)
+#define LR1121_FIRMWARE_TYPE 0xF3
+#define IMAGE_VERSION 0x0104
+#define DRIVER_IMAGE_ID 0xE79ABD5A      // LR1121_FIRMWARE_IMAGE_ID in LR1121.cpp
+#define DRIVER_IMAGE_WORDS 16912
+
+static uint32_t image[IMAGE_WORDS];
+static uint8_t imageBytes[IMAGE_BYTES];
+static uint32_t imageId;
+static const firmware_version_t newVersion = {0x22, LR1121_FIRMWARE_TYPE, IMAGE_VERSION};
+
+class MockBootloader : public LR1121Bootloader
+{
+public:
+    uint8_t flashMem[IMAGE_BYTES];
+    bool inBootloader = false;
+    bool powered = true;
+    bool sequential = false;        // only takes the block after the last, since the erase or power up
+    firmware_version_t running = {0x22, LR1121_FIRMWARE_TYPE, 0x0103};
+    int32_t powerFailAfter = -1;    // writes before the power goes
+    uint16_t rejectBlock = 0;
+    uint8_t rejections = 0;         // times rejectBlock is refused
+    lr1121UpdateProgress_t stored = {};
+    uint32_t writes = 0;
+    uint32_t erases = 0;
+    uint32_t nextOffset = 0;
+
+    MockBootloader() { memcpy(flashMem, imageBytes, sizeof(flashMem)); }
+
+    firmware_version_t getVersion() override
+    {
+        if (!powered)
+            return {0, 0, 0};
+        if (inBootloader)
+            return {0x22, LR1121_BOOTLOADER_TYPE, 0x0100};
+        return running;
+    }
+
+    void enterBootloader() override
+    {
+        if (powered)
+            inBootloader = true;
+    }
+
+    bool erase() override
+    {
+        if (!powered || !inBootloader)
+            return false;
+        memset(flashMem, 0xff, sizeof(flashMem));
+        nextOffset = 0;
+        erases++;
+        return true;
+    }
+
+    bool writeBlock(uint32_t offset, const uint8_t *data, uint16_t size) override
+    {
+        if (!powered || !inBootloader || offset % 4 || size % 4 || size > LR1121_UPDATE_BLOCK_SIZE || offset + size > sizeof(flashMem))
+            return false;
+        if (sequential && offset != nextOffset)
+            return false;
+        if (rejections && offset == (uint32_t)rejectBlock * LR1121_UPDATE_BLOCK_SIZE)
+        {
+            rejections--;
+            return false;
+        }
+        for (uint16_t i = 0; i < size; i++)
+            flashMem[offset + i] &= data[i];
+        nextOffset = offset + size;
+        if (++writes == (uint32_t)powerFailAfter)
+            powered = false;
+        return true;
+    }
+
+    void reboot() override
+    {
+        if (!powered)
+            return;
+        inBootloader = memcmp(flashMem, imageBytes, sizeof(flashMem)) != 0;
+        if (!inBootloader)
+            running = newVersion;
+    }
+
+    void powerCycle()
+    {
+        powered = true;
+        powerFailAfter = -1;
+        nextOffset = 0;
+        inBootloader = false;
+        reboot();
+    }
+
+    bool loadProgress(lr1121UpdateProgress_t &progress) override
+    {
+        progress = stored;
+        return stored.imageId != 0;
+    }
+
+    void saveProgress(const lr1121UpdateProgress_t &progress) override
+    {
+        if (powered)
+            stored = progress;
+    }
+};
+
+static lr1121UpdateResult_e stream(LR1121Update &update, const uint8_t *bytes, uint32_t size, uint32_t chunk)
+{
+    lr1121UpdateResult_e result = LR1121_UPDATE_OK;
+    for (uint32_t pos = 0; pos < size && result == LR1121_UPDATE_OK; pos += chunk)
+        result = update.write(bytes + pos, size - pos < chunk ? size - pos : chunk);
+    return result;
+}
+
+void test_image_id(void)
+{
+    // The image in the driver is the one it was released with
+    TEST_ASSERT_EQUAL(DRIVER_IMAGE_WORDS, LR11XX_FIRMWARE_IMAGE_SIZE);
+    TEST_ASSERT_EQUAL(DRIVER_IMAGE_WORDS * 4, sizeof(lr11xx_firmware_image));
+    TEST_ASSERT_EQUAL(IMAGE_VERSION, LR11XX_FIRMWARE_VERSION);
+    TEST_ASSERT_EQUAL_HEX32(DRIVER_IMAGE_ID, lr1121ImageId(lr11xx_firmware_image, 0, LR11XX_FIRMWARE_IMAGE_SIZE));
+
+    // Any change to the words, their order or the length gives a different id
+    static const uint32_t words[] = {0x01020304, 0x05060708, 0x090a0b0c, 0};
+    static const uint32_t changed[] = {0x01020304, 0x05060709, 0x090a0b0c, 0};
+    static const uint32_t swapped[] = {0x05060708, 0x01020304, 0x090a0b0c, 0};
+    const uint32_t id = lr1121ImageId(words, 0, 3);
+    TEST_ASSERT_NOT_EQUAL(id, lr1121ImageId(changed, 0, 3));
+    TEST_ASSERT_NOT_EQUAL(id, lr1121ImageId(swapped, 0, 3));
+    TEST_ASSERT_NOT_EQUAL(id, lr1121ImageId(words, 0, 2));
+    TEST_ASSERT_NOT_EQUAL(id, lr1121ImageId(words, 0, 4) + 1);
+}
+
+void test_full_update(void)
+{
+    static MockBootloader radio;
+    LR1121Update update(radio);
+    TEST_ASSERT_EQUAL(LR1121_UPDATE_OK, update.flash(image, IMAGE_WORDS, imageId, newVersion));
+    TEST_ASSERT_FALSE(update.resumed());
+    TEST_ASSERT_EQUAL(IMAGE_BLOCKS, update.blocksWritten());
+    TEST_ASSERT_EQUAL(1, radio.erases);
+    TEST_ASSERT_FALSE(radio.inBootloader);
+    TEST_ASSERT_EQUAL(IMAGE_VERSION, radio.running.version);
+    // Nothing left to resume
+    TEST_ASSERT_EQUAL(0, radio.stored.imageId);
+}
+
+void test_streamed_update(void)
+{
+    // An upload comes in whatever pieces the web server gives it
+    static MockBootloader radio;
+    LR1121Update update(radio);
+    TEST_ASSERT_EQUAL(LR1121_UPDATE_NOT_STARTED, update.write(imageBytes, 4));
+    TEST_ASSERT_EQUAL(LR1121_UPDATE_OK, update.begin(IMAGE_BYTES));
+    TEST_ASSERT_EQUAL(LR1121_UPDATE_OK, stream(update, imageBytes, IMAGE_BYTES, 100));
+    TEST_ASSERT_EQUAL(LR1121_UPDATE_OK, update.end());
+    TEST_ASSERT_FALSE(radio.inBootloader);
+    TEST_ASSERT_EQUAL(LR1121_UPDATE_NOT_STARTED, update.end());
+
+    // Short, long and part word uploads leave the radio in the bootloader
+    TEST_ASSERT_EQUAL(LR1121_UPDATE_OK, update.begin(IMAGE_BYTES));
+    stream(update, imageBytes, IMAGE_BYTES - 4, 1000);
+    TEST_ASSERT_EQUAL(LR1121_UPDATE_SIZE_MISMATCH, update.end());
+    TEST_ASSERT_TRUE(radio.inBootloader);
+    TEST_ASSERT_EQUAL(LR1121_UPDATE_OK, update.begin(IMAGE_BYTES - 4));
+    TEST_ASSERT_EQUAL(LR1121_UPDATE_SIZE_MISMATCH, stream(update, imageBytes, IMAGE_BYTES, 1000));
+    TEST_ASSERT_EQUAL(LR1121_UPDATE_SIZE_MISMATCH, update.end());
+    TEST_ASSERT_EQUAL(LR1121_UPDATE_SIZE_MISMATCH, update.begin(IMAGE_BYTES - 2));
+    update.end();
+    TEST_ASSERT_TRUE(radio.inBootloader);
+}
+
+void test_block_retry(void)
+{
+    // A block that is refused is sent again
+    static MockBootloader radio;
+    radio.rejectBlock = 10;
+    radio.rejections = LR1121_UPDATE_BLOCK_RETRIES - 1;
+    LR1121Update update(radio);
+    TEST_ASSERT_EQUAL(LR1121_UPDATE_OK, update.flash(image, IMAGE_WORDS, imageId, newVersion));
+    TEST_ASSERT_EQUAL(IMAGE_BLOCKS, radio.writes);
+
+    // Up to a point
+    static MockBootloader refused;
+    refused.rejectBlock = 10;
+    refused.rejections = LR1121_UPDATE_BLOCK_RETRIES;
+    LR1121Update failed(refused);
+    TEST_ASSERT_EQUAL(LR1121_UPDATE_WRITE_FAILED, failed.flash(image, IMAGE_WORDS, imageId, newVersion));
+    TEST_ASSERT_EQUAL(10, refused.writes);
+    TEST_ASSERT_TRUE(refused.inBootloader);
+}
+
+void test_power_loss_resume(void)
+{
+    printf("\n");
+    for (int32_t cut : {1, 7, 8, 100, IMAGE_BLOCKS - 1})
+    {
+        static MockBootloader radio;
+        radio = MockBootloader();
+        radio.powerFailAfter = cut;
+        LR1121Update update(radio);
+        TEST_ASSERT_NOT_EQUAL(LR1121_UPDATE_OK, update.flash(image, IMAGE_WORDS, imageId, newVersion));
+
+        // It comes back up in the bootloader, and carries on from the last saved block
+        radio.powerCycle();
+        TEST_ASSERT_TRUE(radio.inBootloader);
+        // The save after the block the power went on never happened
+        const uint16_t saved = radio.stored.blocks;
+        TEST_ASSERT_EQUAL((cut - 1) / LR1121_UPDATE_PROGRESS_BLOCKS * LR1121_UPDATE_PROGRESS_BLOCKS, saved);
+        LR1121Update again(radio);
+        TEST_ASSERT_EQUAL(LR1121_UPDATE_OK, again.flash(image, IMAGE_WORDS, imageId, newVersion));
+        TEST_ASSERT_EQUAL(saved != 0, again.resumed());
+        TEST_ASSERT_EQUAL(IMAGE_BLOCKS - saved, again.blocksWritten());
+        TEST_ASSERT_EQUAL(saved != 0 ? 1 : 2, radio.erases);
+        TEST_ASSERT_FALSE(radio.inBootloader);
+        printf("  power lost after %3d of %u blocks: %3u blocks written again\n", cut, IMAGE_BLOCKS, again.blocksWritten());
+    }
+}
+
+void test_resume_fallback(void)
+{
+    // A bootloader that will not carry on where it stopped gets a full update
+    static MockBootloader radio;
+    radio.sequential = true;
+    radio.powerFailAfter = 100;
+    LR1121Update update(radio);
+    update.flash(image, IMAGE_WORDS, imageId, newVersion);
+    radio.powerCycle();
+    TEST_ASSERT_EQUAL(LR1121_UPDATE_OK, update.flash(image, IMAGE_WORDS, imageId, newVersion));
+    TEST_ASSERT_FALSE(update.resumed());
+    TEST_ASSERT_EQUAL(IMAGE_BLOCKS, update.blocksWritten());
+    TEST_ASSERT_EQUAL(2, radio.erases);
+
+    // So does saved progress that does not match the image
+    static MockBootloader corrupt;
+    corrupt.powerFailAfter = 100;
+    LR1121Update corruptUpdate(corrupt);
+    corruptUpdate.flash(image, IMAGE_WORDS, imageId, newVersion);
+    corrupt.powerCycle();
+    corrupt.stored.crc ^= 1;
+    TEST_ASSERT_EQUAL(LR1121_UPDATE_OK, corruptUpdate.flash(image, IMAGE_WORDS, imageId, newVersion));
+    TEST_ASSERT_EQUAL(IMAGE_BLOCKS, corruptUpdate.blocksWritten());
+    TEST_ASSERT_EQUAL(2, corrupt.erases);
+
+    // And an upload without an id is never resumed
+    static MockBootloader upload;
+    upload.powerFailAfter = 100;
+    LR1121Update uploadUpdate(upload);
+    uploadUpdate.flash(image, IMAGE_WORDS, imageId, newVersion);
+    upload.powerCycle();
+    TEST_ASSERT_EQUAL(LR1121_UPDATE_OK, uploadUpdate.begin(IMAGE_BYTES));
+    TEST_ASSERT_FALSE(uploadUpdate.resumed());
+    TEST_ASSERT_EQUAL(2, upload.erases);
+}
+
+void test_verify(void)
+{
+    // An image the bootloader does not accept
+    static uint8_t bad[IMAGE_BYTES];
+    memcpy(bad, imageBytes, sizeof(bad));
+    bad[1000] ^= 0x10;
+    static MockBootloader radio;
+    LR1121Update update(radio);
+    update.begin(IMAGE_BYTES);
+    stream(update, bad, IMAGE_BYTES, 256);
+    TEST_ASSERT_EQUAL(LR1121_UPDATE_REJECTED, update.end());
+    TEST_ASSERT_TRUE(radio.inBootloader);
+
+    // One that runs, but is not the version expected
+    firmware_version_t other = newVersion;
+    other.version++;
+    TEST_ASSERT_EQUAL(LR1121_UPDATE_WRONG_VERSION, update.flash(image, IMAGE_WORDS, imageId, other));
+
+    // A radio that never reaches the bootloader
+    static MockBootloader dead;
+    dead.powered = false;
+    LR1121Update deadUpdate(dead);
+    TEST_ASSERT_EQUAL(LR1121_UPDATE_NO_BOOTLOADER, deadUpdate.flash(image, IMAGE_WORDS, imageId, newVersion));
+    TEST_ASSERT_EQUAL_STRING("Radio did not enter the bootloader", LR1121Update::errorString(LR1121_UPDATE_NO_BOOTLOADER));
+}
+
+// Unity setup/teardown
+void setUp() {}
+void tearDown() {}
+
+int main(int argc, char **argv)
+{
+    uint32_t word = 1;
+    for (uint32_t i = 0; i < IMAGE_WORDS; i++)
+    {
+        word = word * 1664525 + 1013904223;
+        image[i] = word;
+        imageBytes[i * 4] = word >> 24;
+        imageBytes[i * 4 + 1] = word >> 16;
+        imageBytes[i * 4 + 2] = word >> 8;
+        imageBytes[i * 4 + 3] = word;
+    }
+    imageId = lr1121ImageId(image, 0, IMAGE_WORDS);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_image_id);
+    RUN_TEST(test_full_update);
+    RUN_TEST(test_streamed_update);
+    RUN_TEST(test_block_retry);
+    RUN_TEST(test_power_loss_resume);
+    RUN_TEST(test_resume_fallback);
+    RUN_TEST(test_verify);
+    UNITY_END();
+
+    return 0;
+}
@@ -0,0 +1,220 @@
+#include <cstdint>
+#include <cstring>
+#include <unity.h>
+#include "alloc_tracker.h"
+#include "arena.h"
+#include "fixed_set.h"
+#include "pool.h"
+#include "CRSFRouter.h"
+
+static int liveObjects;
+
+class Base
+{
+public:
+    explicit Base(int id) : id(id) { liveObjects++; }
+    virtual ~Base() { liveObjects--; }
+    virtual int size() const { return sizeof(*this); }
+    int id;
+};
+
+class Large : public Base
+{
+public:
+    explicit Large(int id) : Base(id) { memset(data, id, sizeof(data)); }
+    int size() const override { return sizeof(*this); }
+    uint8_t data[40];
+};
+
+void test_object_pool(void)
+{
+    ObjectPool<Large, 3> pool;
+    Large *a = pool.create(1);
+    Large *b = pool.create(2);
+    Large *c = pool.create(3);
+    TEST_ASSERT_NOT_NULL(a);
+    TEST_ASSERT_NOT_NULL(c);
+    TEST_ASSERT_NULL(pool.create(4));
+    TEST_ASSERT_EQUAL(3, pool.used());
+    TEST_ASSERT_EQUAL(3, liveObjects);
+    TEST_ASSERT_TRUE(pool.owns(b));
+    TEST_ASSERT_EQUAL(2, b->data[39]);
+
+    pool.destroy(b);
+    TEST_ASSERT_EQUAL(2, liveObjects);
+    Large *d = pool.create(5);
+    TEST_ASSERT_EQUAL_PTR(b, d);
+    TEST_ASSERT_EQUAL(5, d->id);
+
+    pool.destroy(a);
+    pool.destroy(c);
+    pool.destroy(d);
+    TEST_ASSERT_EQUAL(0, pool.used());
+    TEST_ASSERT_EQUAL(0, liveObjects);
+}
+
+void test_object_slot(void)
+{
+    {
+        ObjectSlot<Base, MaxSizeOf<Base, Large>::value> slot;
+        TEST_ASSERT_NULL(slot.get());
+        slot.create<Base>(1);
+        TEST_ASSERT_EQUAL((int)sizeof(Base), slot.get()->size());
+        // replacing destroys the previous object
+        slot.create<Large>(2);
+        TEST_ASSERT_EQUAL(1, liveObjects);
+        TEST_ASSERT_EQUAL((int)sizeof(Large), slot.get()->size());
+        TEST_ASSERT_EQUAL(2, slot.get()->id);
+        slot.destroy();
+        TEST_ASSERT_NULL(slot.get());
+        TEST_ASSERT_EQUAL(0, liveObjects);
+        slot.create<Large>(3);
+    }
+    // and so does going out of scope
+    TEST_ASSERT_EQUAL(0, liveObjects);
+}
+
+void test_arena(void)
+{
+    StaticArena<64> arena;
+    uint8_t *bytes = arena.createArray<uint8_t>(3);
+    TEST_ASSERT_NOT_NULL(bytes);
+    TEST_ASSERT_EQUAL(0, bytes[0] | bytes[1] | bytes[2]);
+    TEST_ASSERT_EQUAL(3, arena.used());
+
+    uint32_t *word = arena.create<uint32_t>(0x12345678U);
+    TEST_ASSERT_EQUAL(0, (uintptr_t)word % alignof(uint32_t));
+    TEST_ASSERT_EQUAL_HEX32(0x12345678, *word);
+    TEST_ASSERT_EQUAL(8, arena.used());
+
+    TEST_ASSERT_NULL(arena.alloc(57));
+    TEST_ASSERT_NOT_NULL(arena.alloc(56, 1));
+    TEST_ASSERT_EQUAL(64, arena.used());
+    TEST_ASSERT_NULL(arena.alloc(1, 1));
+
+    arena.reset();
+    TEST_ASSERT_EQUAL(0, arena.used());
+}
+
+void test_setup_array_falls_back_to_heap(void)
+{
+    uint8_t *small = newSetupArray<uint8_t>(16);
+    TEST_ASSERT_TRUE(setupArena.used() >= 16);
+    uint8_t *big = newSetupArray<uint8_t>(SETUP_ARENA_SIZE + 1);
+    TEST_ASSERT_NOT_NULL(big);
+    TEST_ASSERT_EQUAL(0, big[SETUP_ARENA_SIZE]);
+    small[15] = 1;
+    delete[] big;
+}
+
+void test_fixed_set(void)
+{
+    FixedSet<int, 3> set;
+    TEST_ASSERT_TRUE(set.empty());
+    TEST_ASSERT_TRUE(set.insert(1));
+    TEST_ASSERT_TRUE(set.insert(2));
+    TEST_ASSERT_TRUE(set.insert(2));
+    TEST_ASSERT_TRUE(set.insert(3));
+    TEST_ASSERT_FALSE(set.insert(4));
+    TEST_ASSERT_EQUAL(3, set.size());
+    TEST_ASSERT_TRUE(set.contains(2));
+    TEST_ASSERT_FALSE(set.contains(4));
+
+    set.erase(2);
+    set.erase(5);
+    TEST_ASSERT_EQUAL(2, set.size());
+    int sum = 0;
+    for (const int value : set)
+        sum = sum * 10 + value;
+    // insertion order is kept
+    TEST_ASSERT_EQUAL(13, sum);
+}
+
+static size_t lastReported;
+static void recordAllocation(size_t size)
+{
+    lastReported = size;
+}
+
+void test_tracker_counts_after_setup(void)
+{
+    AllocTracker::reset();
+    AllocTracker::setReporter(recordAllocation);
+    delete new int(1);
+    TEST_ASSERT_EQUAL(0, AllocTracker::steadyStateAllocations());
+
+    AllocTracker::markSetupComplete();
+    delete new uint64_t(1);
+    TEST_ASSERT_EQUAL(1, AllocTracker::steadyStateAllocations());
+    TEST_ASSERT_EQUAL(sizeof(uint64_t), AllocTracker::steadyStateBytes());
+    TEST_ASSERT_EQUAL(sizeof(uint64_t), lastReported);
+
+    AllocTracker::reset();
+    AllocTracker::setReporter(nullptr);
+}
+
+class MockConnector final : public CRSFConnector
+{
+public:
+    explicit MockConnector(crsf_addr_e addr) { addDevice(addr); }
+    void forwardMessage(const crsf_header_t *message) override { forwarded++; }
+    int forwarded = 0;
+};
+
+void test_routing_does_not_allocate(void)
+{
+    CRSFRouter router;
+    MockConnector fc(CRSF_ADDRESS_FLIGHT_CONTROLLER);
+    MockConnector radio(CRSF_ADDRESS_CRSF_TRANSMITTER);
+    MockConnector other(CRSF_ADDRESS_ELRS_LUA);
+    router.addConnector(&fc);
+    router.addConnector(&radio);
+    router.addConnector(&other);
+
+    uint8_t frame[CRSF_MAX_PACKET_LEN] = {};
+    crsf_ext_header_t *header = (crsf_ext_header_t *)frame;
+    header->device_addr = CRSF_ADDRESS_CRSF_RECEIVER;
+    header->frame_size = 6;
+    header->type = CRSF_FRAMETYPE_DEVICE_PING;
+    header->dest_addr = CRSF_ADDRESS_FLIGHT_CONTROLLER;
+    header->orig_addr = CRSF_ADDRESS_CRSF_TRANSMITTER;
+
+    AllocTracker::reset();
+    AllocTracker::markSetupComplete();
+    for (int i = 0; i < 100; i++)
+    {
+        router.deliverMessage(&radio, (crsf_header_t *)frame);
+        header->dest_addr = CRSF_ADDRESS_BROADCAST;
+        router.deliverMessage(&radio, (crsf_header_t *)frame);
+        header->dest_addr = CRSF_ADDRESS_FLIGHT_CONTROLLER;
+    }
+    TEST_ASSERT_EQUAL(0, AllocTracker::steadyStateAllocations());
+    AllocTracker::reset();
+
+    TEST_ASSERT_EQUAL(200, fc.forwarded);
+    TEST_ASSERT_EQUAL(0, radio.forwarded);
+    TEST_ASSERT_EQUAL(100, other.forwarded);
+
+    router.removeConnector(&other);
+    router.deliverMessage(&radio, (crsf_header_t *)frame);
+    TEST_ASSERT_EQUAL(100, other.forwarded);
+}
+
+// Unity setup/teardown
+void setUp() {}
+void tearDown() {}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_object_pool);
+    RUN_TEST(test_object_slot);
+    RUN_TEST(test_arena);
+    RUN_TEST(test_setup_array_falls_back_to_heap);
+    RUN_TEST(test_fixed_set);
+    RUN_TEST(test_tracker_counts_after_setup);
+    RUN_TEST(test_routing_does_not_allocate);
+    UNITY_END();
+
+    return 0;
+}
@@ -0,0 +1,320 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <unity.h>
+#include "MockRadio.h"
+#include "FreqCorrection.h"
+
+#define FREQ 100000
+#define PAYLOAD_LEN 8
+
+static MockRadioDriver *tx;
+static MockRadioDriver *rx;
+static uint32_t rxCount;
+static uint32_t rxAt;
+static SX12xxDriverCommon::rx_status lastStatus;
+static uint32_t txDoneCount;
+static uint32_t txDoneAt;
+
+static bool rxDone(SX12xxDriverCommon::rx_status status)
+{
+    rxCount++;
+    rxAt = MockRadioDriver::now();
+    lastStatus = status;
+    return true;
+}
+
+static void txDone()
+{
+    txDoneCount++;
+    txDoneAt = MockRadioDriver::now();
+}
+
+static void begin(MockRadioDriver &radio)
+{
+    TEST_ASSERT_TRUE(radio.Begin(0, 0));
+    radio.Config(0, 0, 0, FREQ, 8, false, PAYLOAD_LEN);
+    radio.RXdoneCallback = &rxDone;
+    radio.TXdoneCallback = &txDone;
+}
+
+void setUp()
+{
+    tx = new MockRadioDriver();
+    rx = new MockRadioDriver();
+    begin(*tx);
+    begin(*rx);
+    MockRadioDriver::setPathLoss(80);
+    // Let the Config commands finish
+    MockRadioDriver::advance(1000);
+    tx->busyWaitUs = rx->busyWaitUs = 0;
+    rxCount = 0;
+    txDoneCount = 0;
+}
+
+void tearDown()
+{
+    delete tx;
+    delete rx;
+}
+
+void test_packet_exchange(void)
+{
+    uint8_t data[PAYLOAD_LEN] = {1, 2, 3, 4, 5, 6, 7, 8};
+    rx->RXnb();
+    const uint32_t start = MockRadioDriver::now();
+    tx->TXnb(data, false, nullptr, SX12XX_Radio_1);
+    TEST_ASSERT_EQUAL(MOCK_RADIO_TX, tx->mode());
+
+    // Both IRQs come after the mode change, the TX delay, the packet and the IRQ latency
+    const mockRadioConfig_t &c = MockRadioDefaultConfig;
+    const uint32_t irqAt = start + c.modeBusyUs + c.txDelayUs + c.timeOnAirUs + c.irqLatencyUs;
+    MockRadioDriver::advance(irqAt - start - 1);
+    TEST_ASSERT_EQUAL(0, rxCount);
+    TEST_ASSERT_EQUAL(0, txDoneCount);
+    MockRadioDriver::advance(1);
+    TEST_ASSERT_EQUAL(1, rxCount);
+    TEST_ASSERT_EQUAL(1, txDoneCount);
+    TEST_ASSERT_EQUAL(irqAt, rxAt);
+    TEST_ASSERT_EQUAL(SX12xxDriverCommon::SX12XX_RX_OK, lastStatus);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(data, rx->RXdataBuffer, PAYLOAD_LEN);
+    TEST_ASSERT_EQUAL(MOCK_RADIO_FS, tx->mode());
+    TEST_ASSERT_EQUAL(MOCK_RADIO_RX, rx->mode());
+
+    rx->GetLastPacketStats();
+    TEST_ASSERT_EQUAL(10 - 80, rx->LastPacketRSSI);
+    TEST_ASSERT_EQUAL(MOCK_RADIO_SNR_MAX_DB * RADIO_SNR_SCALE, rx->LastPacketSNRRaw);
+    MockRadioDriver::setPathLoss(110);
+    tx->TXnb(data, false, nullptr, SX12XX_Radio_1);
+    MockRadioDriver::advance(2000);
+    rx->GetLastPacketStats();
+    TEST_ASSERT_EQUAL(-100, rx->LastPacketRSSI);
+    TEST_ASSERT_EQUAL(10 * RADIO_SNR_SCALE, rx->LastPacketSNRRaw);
+}
+
+void test_busy_line(void)
+{
+    // A command right after another waits for BUSY, and so does everything after it
+    uint8_t data[PAYLOAD_LEN] = {};
+    const mockRadioConfig_t &c = MockRadioDefaultConfig;
+    rx->RXnb();
+    tx->SetFrequencyReg(FREQ, SX12XX_Radio_1);
+    TEST_ASSERT_TRUE(tx->isBusy());
+    const uint32_t start = MockRadioDriver::now();
+    tx->TXnb(data, false, nullptr, SX12XX_Radio_1);
+    TEST_ASSERT_EQUAL(c.commandBusyUs, tx->busyWaitUs);
+    MockRadioDriver::advance(c.commandBusyUs + c.modeBusyUs);
+    TEST_ASSERT_FALSE(tx->isBusy());
+    MockRadioDriver::advance(5000);
+    TEST_ASSERT_EQUAL(start + c.commandBusyUs + c.modeBusyUs + c.txDelayUs + c.timeOnAirUs + c.irqLatencyUs, txDoneAt);
+}
+
+void test_not_received(void)
+{
+    uint8_t data[PAYLOAD_LEN] = {};
+    const mockRadioConfig_t &c = MockRadioDefaultConfig;
+
+    // Another channel
+    rx->SetFrequencyReg(FREQ + c.captureRange + 1, SX12XX_Radio_1, true);
+    tx->TXnb(data, false, nullptr, SX12XX_Radio_1);
+    MockRadioDriver::advance(2000);
+    TEST_ASSERT_EQUAL(0, rxCount);
+    // Inverted IQ, another packet length
+    rx->Config(0, 0, 0, FREQ, 8, true, PAYLOAD_LEN);
+    rx->RXnb();
+    tx->TXnb(data, false, nullptr, SX12XX_Radio_1);
+    MockRadioDriver::advance(2000);
+    rx->Config(0, 0, 0, FREQ, 8, false, PAYLOAD_LEN + 2);
+    rx->RXnb();
+    tx->TXnb(data, false, nullptr, SX12XX_Radio_1);
+    MockRadioDriver::advance(2000);
+    TEST_ASSERT_EQUAL(0, rxCount);
+    // Listening after the packet started
+    rx->Config(0, 0, 0, FREQ, 8, false, PAYLOAD_LEN);
+    tx->TXnb(data, false, nullptr, SX12XX_Radio_1);
+    MockRadioDriver::advance(c.modeBusyUs + c.txDelayUs + 10);
+    rx->RXnb();
+    MockRadioDriver::advance(2000);
+    TEST_ASSERT_EQUAL(0, rxCount);
+    // Too weak
+    MockRadioDriver::setPathLoss(10 - c.sensitivityDbm + 1);
+    tx->TXnb(data, false, nullptr, SX12XX_Radio_1);
+    MockRadioDriver::advance(2000);
+    TEST_ASSERT_EQUAL(0, rxCount);
+    MockRadioDriver::setPathLoss(10 - c.sensitivityDbm);
+    tx->TXnb(data, false, nullptr, SX12XX_Radio_1);
+    MockRadioDriver::advance(2000);
+    TEST_ASSERT_EQUAL(1, rxCount);
+}
+
+void test_collision(void)
+{
+    // Two packets that overlap on the air, neither gets through
+    MockRadioDriver other;
+    begin(other);
+    MockRadioDriver::advance(1000);
+    uint8_t data[PAYLOAD_LEN] = {};
+    rx->RXnb();
+    tx->TXnb(data, false, nullptr, SX12XX_Radio_1);
+    MockRadioDriver::advance(500);
+    other.TXnb(data, false, nullptr, SX12XX_Radio_1);
+    MockRadioDriver::advance(3000);
+    TEST_ASSERT_EQUAL(2, rxCount);
+    TEST_ASSERT_EQUAL(2, rx->crcErrors);
+    TEST_ASSERT_EQUAL(0, rx->packetsReceived);
+    TEST_ASSERT_EQUAL(SX12xxDriverCommon::SX12XX_RX_CRC_FAIL, lastStatus);
+
+    // A TX started before the last one finished times out
+    tx->TXnb(data, false, nullptr, SX12XX_Radio_1);
+    MockRadioDriver::advance(500);
+    txDoneCount = 0;
+    tx->TXnb(data, false, nullptr, SX12XX_Radio_1);
+    TEST_ASSERT_EQUAL(1, txDoneCount);
+    MockRadioDriver::advance(3000);
+    TEST_ASSERT_EQUAL(2, rxCount);
+}
+
+void test_frequency_correction(void)
+{
+    // The receiver's crystal is off, the FreqCorrection loop rx_main runs brings it back
+    uint8_t data[PAYLOAD_LEN] = {};
+    rx->setFrequencyOffset(300);
+    rx->RXnb();
+    FreqCorrector corrector(1000);
+    int32_t correction = 0;
+    for (int i = 0; i < 400; i++)
+    {
+        tx->TXnb(data, false, nullptr, SX12XX_Radio_1);
+        MockRadioDriver::advance(2000);
+        rx->GetLastPacketStats();
+        if (rx->FrequencyErrorAvailable())
+        {
+            correction = corrector.update(rx->GetFrequencyError(SX12XX_Radio_1));
+            rx->SetPPMoffsetReg(correction, SX12XX_Radio_1);
+        }
+        rx->SetFrequencyReg(FREQ - correction, SX12XX_Radio_1);
+    }
+    TEST_ASSERT_EQUAL(400, rx->packetsReceived);
+    TEST_ASSERT_INT_WITHIN(1, 300, correction);
+    TEST_ASSERT_INT_WITHIN(1, 0, rx->lastFreqError);
+    TEST_ASSERT_EQUAL(correction, rx->ppmOffset);
+}
+
+void test_cw_and_rssi(void)
+{
+    rx->RXnb();
+    rx->StartRssiInst(SX12XX_Radio_1);
+    TEST_ASSERT_EQUAL(MOCK_RADIO_NOISE_FLOOR_DBM, rx->GetRssiInst(SX12XX_Radio_1));
+    tx->startCWTest(FREQ, SX12XX_Radio_1);
+    tx->cwRepeat(SX12XX_Radio_1);
+    TEST_ASSERT_EQUAL(10 - 80, rx->GetRssiInst(SX12XX_Radio_1));
+    tx->SetOutputPower(20);
+    TEST_ASSERT_EQUAL(20 - 80, rx->GetRssiInst(SX12XX_Radio_1));
+    tx->SetTxIdleMode();
+    TEST_ASSERT_EQUAL(MOCK_RADIO_NOISE_FLOOR_DBM, rx->GetRssiInst(SX12XX_Radio_1));
+}
+
+/*
+ * A link with telemetry the way ExpressLRS runs it: the TX sends a packet every interval, except
+ * one in four where it listens for the telemetry the RX sends back.
+ */
+#define LINK_INTERVAL_US 2000
+#define LINK_TLM_RATIO 4
+
+static uint32_t uplink;
+static uint32_t downlink;
+static bool rxTlmDue;
+
+static bool linkRxDone(SX12xxDriverCommon::rx_status status)
+{
+    if (status == SX12xxDriverCommon::SX12XX_RX_OK)
+    {
+        uplink++;
+        rxTlmDue = rx->RXdataBuffer[0] % LINK_TLM_RATIO == LINK_TLM_RATIO - 2;
+    }
+    return true;
+}
+
+static bool linkTlmDone(SX12xxDriverCommon::rx_status status)
+{
+    if (status == SX12xxDriverCommon::SX12XX_RX_OK)
+        downlink++;
+    return true;
+}
+
+static void linkRxTxDone()
+{
+    rx->RXnb();
+}
+
+static void runLink(uint32_t packets)
+{
+    uplink = downlink = 0;
+    tx->busyWaitUs = 0;
+    rxTlmDue = false;
+    rx->RXdoneCallback = &linkRxDone;
+    rx->TXdoneCallback = &linkRxTxDone;
+    tx->RXdoneCallback = &linkTlmDone;
+    tx->TXdoneCallback = []() {};
+    rx->RXnb();
+    uint8_t data[PAYLOAD_LEN] = {};
+    for (uint32_t n = 0; n < packets; n++)
+    {
+        // The RX answers on the tick after the packet that says telemetry is next
+        if (rxTlmDue)
+        {
+            rxTlmDue = false;
+            rx->TXnb(data, false, nullptr, SX12XX_Radio_1);
+        }
+        if (n % LINK_TLM_RATIO == LINK_TLM_RATIO - 1)
+        {
+            tx->RXnb();
+        }
+        else
+        {
+            data[0] = n;
+            tx->TXnb(data, false, nullptr, SX12XX_Radio_1);
+        }
+        MockRadioDriver::advance(LINK_INTERVAL_US);
+    }
+}
+
+void test_link(void)
+{
+    static const uint8_t losses[] = {80, 110, 117, 119};
+    const uint32_t packets = 400;
+    printf("\n");
+    for (uint8_t loss : losses)
+    {
+        MockRadioDriver::setPathLoss(loss);
+        runLink(packets);
+        printf("  path loss %3udB: uplink %3u/%u, downlink %3u/%u\n", loss,
+               uplink, packets * 3 / 4, downlink, packets / 4);
+        if (10 - loss >= MockRadioDefaultConfig.sensitivityDbm)
+        {
+            TEST_ASSERT_EQUAL(packets * 3 / 4, uplink);
+            TEST_ASSERT_EQUAL(packets / 4, downlink);
+        }
+        else
+        {
+            TEST_ASSERT_EQUAL(0, uplink);
+            TEST_ASSERT_EQUAL(0, downlink);
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_packet_exchange);
+    RUN_TEST(test_busy_line);
+    RUN_TEST(test_not_received);
+    RUN_TEST(test_collision);
+    RUN_TEST(test_frequency_correction);
+    RUN_TEST(test_cw_and_rssi);
+    RUN_TEST(test_link);
+    UNITY_END();
+
+    return 0;
+}
@@ -33,7 +33,7 @@ void test_encapsulated_msp_send(void)
     router.addConnector(&connector);
 
     // Build an MSP packet with the MSP_SET_VTX_CONFIG cmd
-    mspPacket_t packet;
+    mspPacketBuffer_t<> packet;
     packet.reset();
     packet.makeCommand();
     packet.flags = 0;
@@ -84,7 +84,7 @@ void test_encapsulated_msp_send_too_long(void)
     router.addConnector(&connector);
 
     // Build an MSP packet with a payload that is too long to send (>4 bytes)
-    mspPacket_t packet;
+    mspPacketBuffer_t<> packet;
     packet.reset();
     packet.makeCommand();
     packet.flags = 0;
@@ -1,6 +1,9 @@
+#include <chrono>
 #include <cstdint>
 #include <iostream>
+#include <vector>
 #include <unity.h>
+#include "crc.h"
 #include "msp.h"
 #include "common.h"
 #include "mock_serial.h"
@@ -77,7 +80,7 @@ void test_msp_send(void)
     // AND the return value will be true
 
     // Build an MSP reply packet
-    mspPacket_t packet;
+    mspPacketBuffer_t<> packet;
     packet.reset();
     packet.makeResponse();
     packet.flags = 0;
@@ -105,6 +108,158 @@ void test_msp_send(void)
     TEST_ASSERT_EQUAL(224, (uint8_t)buf[9]);     // crc
 }
 
+// Build a complete MSPv2 frame with a payload of `len` bytes of a known pattern
+static std::vector<uint8_t> buildFrame(uint16_t function, uint16_t len)
+{
+    GENERIC_CRC8 crc8(0xD5);
+    std::vector<uint8_t> frame = {'$', 'X', '>', 0, (uint8_t)(function & 0xFF), (uint8_t)(function >> 8), (uint8_t)(len & 0xFF), (uint8_t)(len >> 8)};
+    for (uint16_t i = 0; i < len; i++)
+    {
+        frame.push_back((uint8_t)(i * 7 + 3));
+    }
+    frame.push_back(crc8.calc(&frame[3], frame.size() - 3));
+    return frame;
+}
+
+static bool feed(MSP &msp, const std::vector<uint8_t> &frame)
+{
+    bool complete = false;
+    for (const uint8_t c : frame)
+    {
+        complete = msp.processReceivedByte(c);
+    }
+    return complete;
+}
+
+void test_msp_receive_large(void)
+{
+    // GIVEN a payload larger than the old 64 byte inline buffer but smaller than a pool block
+    // THEN the whole payload is available in the received packet
+    MSP msp;
+    const uint8_t freeBlocks = mspBufferPool.available();
+    const uint16_t len = 300;
+    auto frame = buildFrame(0x1234, len);
+
+    TEST_ASSERT_TRUE(feed(msp, frame));
+    mspPacket_t *packet = msp.getReceivedPacket();
+    TEST_ASSERT_EQUAL(0x1234, packet->function);
+    TEST_ASSERT_EQUAL(len, packet->payloadSize);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(&frame[8], packet->payload, len);
+
+    // AND the payload block is returned to the pool once the packet has been processed
+    TEST_ASSERT_EQUAL(freeBlocks - 1, mspBufferPool.available());
+    msp.markPacketReceived();
+    TEST_ASSERT_EQUAL(freeBlocks, mspBufferPool.available());
+}
+
+static std::vector<uint8_t> streamed;
+static uint16_t streamedChunks;
+static bool streamedComplete;
+static bool streamedCrcError;
+
+static void chunkHandler(const mspPacket_t *packet, uint16_t offset, const uint8_t *data, uint16_t len)
+{
+    if (len == 0)
+    {
+        streamedComplete = true;
+        streamedCrcError = packet->readError;
+        return;
+    }
+    TEST_ASSERT_EQUAL(streamed.size(), offset);
+    streamed.insert(streamed.end(), data, data + len);
+    streamedChunks++;
+}
+
+void test_msp_receive_streamed(void)
+{
+    // GIVEN a payload larger than a pool block and a chunk handler
+    // THEN the payload is delivered to the handler in block sized chunks followed by the completion call
+    MSP msp;
+    msp.setPayloadChunkHandler(chunkHandler);
+    const uint8_t freeBlocks = mspBufferPool.available();
+    streamed.clear();
+    streamedChunks = 0;
+    streamedComplete = false;
+    const uint16_t len = MSP_POOL_BLOCK_SIZE * 3 + 10;
+    auto frame = buildFrame(0x300, len);
+
+    // streamed packets are not returned via getReceivedPacket()
+    TEST_ASSERT_FALSE(feed(msp, frame));
+    TEST_ASSERT_TRUE(streamedComplete);
+    TEST_ASSERT_FALSE(streamedCrcError);
+    TEST_ASSERT_EQUAL(4, streamedChunks);
+    TEST_ASSERT_EQUAL(len, streamed.size());
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(&frame[8], streamed.data(), len);
+    TEST_ASSERT_EQUAL(freeBlocks, mspBufferPool.available());
+
+    // AND a bad checksum is reported to the handler
+    streamed.clear();
+    streamedComplete = false;
+    frame.back() ^= 0xFF;
+    feed(msp, frame);
+    TEST_ASSERT_TRUE(streamedComplete);
+    TEST_ASSERT_TRUE(streamedCrcError);
+}
+
+void test_msp_receive_oversize_dropped(void)
+{
+    // GIVEN a payload larger than a pool block and no chunk handler
+    // THEN the packet is dropped without overrunning any buffer and the next packet is received
+    MSP msp;
+    auto big = buildFrame(0x300, MSP_POOL_BLOCK_SIZE + 1);
+    auto small = buildFrame(0x301, 4);
+
+    TEST_ASSERT_FALSE(feed(msp, big));
+    TEST_ASSERT_EQUAL(1, msp.getDroppedCount());
+    TEST_ASSERT_TRUE(feed(msp, small));
+    TEST_ASSERT_EQUAL(0x301, msp.getReceivedPacket()->function);
+    msp.markPacketReceived();
+}
+
+void test_msp_build_overflow(void)
+{
+    // GIVEN a packet buffer that is too small for the bytes added
+    // THEN the packet is flagged and will not be sent
+    mspPacketBuffer_t<2> packet;
+    packet.reset();
+    packet.makeCommand();
+    packet.addByte(1);
+    packet.addByte(2);
+    TEST_ASSERT_FALSE(packet.writeError);
+    packet.addByte(3);
+    TEST_ASSERT_TRUE(packet.writeError);
+    TEST_ASSERT_EQUAL(2, packet.payloadSize);
+
+    std::string buf;
+    StringStream ss(buf);
+    TEST_ASSERT_FALSE(MSP::sendPacket(&packet, &ss));
+    TEST_ASSERT_EQUAL(0, buf.length());
+}
+
+void test_msp_benchmark_large(void)
+{
+    // Parse a stream of large frames and report the throughput
+    MSP msp;
+    auto frame = buildFrame(0x1234, 500);
+    const int iterations = 2000;
+    uint32_t received = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+    {
+        if (feed(msp, frame))
+        {
+            received += msp.getReceivedPacket()->payloadSize;
+            msp.markPacketReceived();
+        }
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+    TEST_ASSERT_EQUAL(iterations * 500, received);
+    std::cout << "MSP parse " << iterations << " x " << frame.size() << " byte frames: "
+              << elapsed << "us (" << (elapsed ? (uint64_t)iterations * frame.size() / elapsed : 0) << " bytes/us)" << std::endl;
+}
+
 extern void test_encapsulated_msp_send(void);
 extern void test_encapsulated_msp_send_too_long(void);
 
@@ -117,6 +272,11 @@ int main(int argc, char **argv)
     UNITY_BEGIN();
     RUN_TEST(test_msp_receive);
     RUN_TEST(test_msp_send);
+    RUN_TEST(test_msp_receive_large);
+    RUN_TEST(test_msp_receive_streamed);
+    RUN_TEST(test_msp_receive_oversize_dropped);
+    RUN_TEST(test_msp_build_overflow);
+    RUN_TEST(test_msp_benchmark_large);
 
     RUN_TEST(test_encapsulated_msp_send);
     RUN_TEST(test_encapsulated_msp_send_too_long);
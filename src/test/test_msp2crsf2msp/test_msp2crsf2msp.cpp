@@ -2,8 +2,10 @@
 #include "common.h"
 #include "crsf2msp.h"
 #include "msp2crsf.h"
+#include <chrono>
 #include <cstdint>
 #include <iostream>
+#include <vector>
 #include <unity.h>
 
 using namespace std;
@@ -59,6 +61,18 @@ void printFIFOhex()
     }
 }
 
+// Drain the reassembled MSP byte stream, large frames arrive as several segments
+static void popMSPStream(vector<uint8_t> &stream)
+{
+    while (crsf2msp.FIFOout.peekSize() > 0)
+    {
+        const uint16_t len = crsf2msp.FIFOout.popSize();
+        const size_t start = stream.size();
+        stream.resize(start + len);
+        crsf2msp.FIFOout.popBytes(&stream[start], len);
+    }
+}
+
 void runTest(const uint8_t *frame, int frameLen)
 {
     cout << "MSP In Len: " << dec << (int)frameLen << endl;
@@ -71,25 +85,31 @@ void runTest(const uint8_t *frame, int frameLen)
     // printFIFOhex();
 
     msp2crsf.parse(frame, frameLen); // do again cause we pop'd the buffer
+    vector<uint8_t> out;
     while (msp2crsf.FIFOout.peek() > 0)
     {
         uint8_t sizeOut = msp2crsf.FIFOout.pop();
         uint8_t crsfFrame[64];
         msp2crsf.FIFOout.popBytes(crsfFrame, sizeOut);
         crsf2msp.parse(crsfFrame);
+        // drained as it is produced, like TCPSOCKET::pumpData()
+        popMSPStream(out);
     }
 
     // if (crsf2msp.isFrameReady())
     // {
     //     cout << "CRSF^-1(CRSF(MSP())) ";
-    //     printBufferhex(crsf2msp.getFrame(), crsf2msp.getFrameLen());
+    //     printBufferhex(out.data(), crsf2msp.getFrameLen());
     // }
     // else
     // {
     //     cout << "Frame not ready\n";
     // }
     cout << "MSP Out Len: " << dec << (int)crsf2msp.getFrameLen() << endl;
-    TEST_ASSERT_EQUAL_HEX8_ARRAY(frame, crsf2msp.getFrame(), frameLen);
+    TEST_ASSERT_TRUE(out.size() >= (size_t)frameLen);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(frame, out.data(), frameLen);
+    // the pool block is only held while a frame is being reassembled
+    TEST_ASSERT_EQUAL(MSP_POOL_BLOCK_COUNT, mspBufferPool.available());
 }
 
 void MSP_IDENT_TEST()
@@ -155,6 +175,110 @@ void MSPV2_SERIAL_SETTINGS_TEST()
     // cout << endl;
 }
 
+// Build an MSPv2 response frame with a payload of `len` bytes of a known pattern
+static vector<uint8_t> buildMSPV2Frame(uint16_t len)
+{
+    GENERIC_CRC8 crc8(0xD5);
+    vector<uint8_t> frame = {'$', 'X', '>', 0, 0x34, 0x12, (uint8_t)(len & 0xFF), (uint8_t)(len >> 8)};
+    for (uint16_t i = 0; i < len; i++)
+    {
+        frame.push_back((uint8_t)(i * 13 + 1));
+    }
+    frame.push_back(crc8.calc(&frame[3], frame.size() - 3));
+    return frame;
+}
+
+void MSPV2_LARGE_TEST()
+{
+    // Payload well beyond the old 64 byte MSP_PORT_INBUF_SIZE, reassembled in a pool block
+    auto frame = buildMSPV2Frame(300);
+    runTest(frame.data(), frame.size());
+}
+
+void MSPV2_STREAMED_TEST()
+{
+    // Payload bigger than a pool block, streamed out chunk by chunk instead of being dropped
+    auto frame = buildMSPV2Frame(MSP_POOL_BLOCK_SIZE + 88);
+    runTest(frame.data(), frame.size());
+    TEST_ASSERT_TRUE(crsf2msp.isFrameReady());
+    TEST_ASSERT_EQUAL(frame.size(), crsf2msp.getFrameLen());
+    TEST_ASSERT_EQUAL(0, crsf2msp.getDroppedCount());
+}
+
+void MSPV2_STREAMED_ABORTED_TEST()
+{
+    // A sequence error part way through a streamed frame abandons it, the next frame still gets through
+    auto large = buildMSPV2Frame(MSP_POOL_BLOCK_SIZE + 88);
+    msp2crsf.parse(large.data(), large.size());
+    int chunks = 0;
+    while (msp2crsf.FIFOout.peek() > 0)
+    {
+        uint8_t sizeOut = msp2crsf.FIFOout.pop();
+        uint8_t crsfFrame[64];
+        msp2crsf.FIFOout.popBytes(crsfFrame, sizeOut);
+        if (chunks++ != 3) // lose a chunk
+        {
+            crsf2msp.parse(crsfFrame);
+        }
+    }
+    TEST_ASSERT_FALSE(crsf2msp.isFrameReady());
+    crsf2msp.FIFOout.flush();
+
+    runTest(MSPV2_HELLO_WORLD, sizeof(MSPV2_HELLO_WORLD));
+}
+
+void MSPV2_EXACT_CHUNKS_TEST()
+{
+    // Frame is an exact multiple of the chunk payload, there must be no empty trailing chunk
+    auto frame = buildMSPV2Frame(57 * 3 - 9);
+    msp2crsf.parse(frame.data(), frame.size());
+    int chunks = 0;
+    while (msp2crsf.FIFOout.peek() > 0)
+    {
+        uint8_t sizeOut = msp2crsf.FIFOout.pop();
+        uint8_t crsfFrame[64];
+        msp2crsf.FIFOout.popBytes(crsfFrame, sizeOut);
+        crsf2msp.parse(crsfFrame);
+        chunks++;
+    }
+    TEST_ASSERT_EQUAL(3, chunks);
+    TEST_ASSERT_TRUE(crsf2msp.isFrameReady());
+    TEST_ASSERT_EQUAL(frame.size(), crsf2msp.getFrameLen());
+    vector<uint8_t> out;
+    popMSPStream(out);
+    TEST_ASSERT_EQUAL(frame.size(), out.size());
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(frame.data(), out.data(), frame.size());
+}
+
+void MSPV2_BENCHMARK_TEST()
+{
+    auto frame = buildMSPV2Frame(300);
+    const int iterations = 2000;
+    int complete = 0;
+
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+    {
+        msp2crsf.parse(frame.data(), frame.size());
+        while (msp2crsf.FIFOout.peek() > 0)
+        {
+            uint8_t sizeOut = msp2crsf.FIFOout.pop();
+            uint8_t crsfFrame[64];
+            msp2crsf.FIFOout.popBytes(crsfFrame, sizeOut);
+            crsf2msp.parse(crsfFrame);
+        }
+        if (crsf2msp.isFrameReady())
+        {
+            complete++;
+        }
+        crsf2msp.FIFOout.flush();
+    }
+    auto elapsed = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count();
+
+    TEST_ASSERT_EQUAL(iterations, complete);
+    cout << "MSP->CRSF->MSP " << dec << iterations << " x " << frame.size() << " byte frames: " << elapsed << "us" << endl;
+}
+
 // Unity setup/teardown
 void setUp()
 {
@@ -175,6 +299,11 @@ int main(int argc, char **argv)
     RUN_TEST(MSPV1_JUMBO_289_TEST);
     RUN_TEST(MSP_BOARD_INFO_81_TEST);
     RUN_TEST(MSPV2_SERIAL_SETTINGS_TEST);
+    RUN_TEST(MSPV2_LARGE_TEST);
+    RUN_TEST(MSPV2_STREAMED_TEST);
+    RUN_TEST(MSPV2_STREAMED_ABORTED_TEST);
+    RUN_TEST(MSPV2_EXACT_CHUNKS_TEST);
+    RUN_TEST(MSPV2_BENCHMARK_TEST);
 
     UNITY_END();
 
@@ -0,0 +1,239 @@
+#include <cstdint>
+#include <cstdio>
+#include <cmath>
+#include <unity.h>
+#include "PhaseLock.h"
+
+/*
+ * Simulation harness: a TX sending every intervalUs, an RX timer running ppm fast and the
+ * PhaseLock steering it. Packets are lost at random and their timestamps have some jitter.
+ */
+
+typedef struct {
+    uint32_t intervalUs;
+    float ppm;              // RX crystal error, positive is fast
+    float lossRate;         // 0 to 1
+    float jitterUs;         // standard deviation of the PFD offset
+    int32_t initialOffsetUs;
+    bool kalman;
+} simParams_t;
+
+typedef struct {
+    int32_t lockPeriod;     // first period the phase error stays within SIM_LOCK_US, -1 if never
+    float jitterUs;         // RMS phase error once locked
+    float maxErrorUs;       // largest phase error once locked
+} simResult_t;
+
+#define SIM_PERIODS 4000
+#define SIM_ACQUIRE_PERIODS 50  // tentative before the connection is good
+#define SIM_LOCK_US 10
+
+static uint32_t rngState;
+
+static float uniform()
+{
+    rngState = rngState * 1664525 + 1013904223;
+    return (rngState >> 8) / 16777216.0f;
+}
+
+static float gaussian()
+{
+    // Box-Muller
+    const float u1 = uniform() + 1e-7f;
+    const float u2 = uniform();
+    return sqrtf(-2 * logf(u1)) * cosf(2 * (float)M_PI * u2);
+}
+
+static simResult_t simulate(const simParams_t &p)
+{
+    PhaseLock pll;
+    phaseLockConfig_t config = PhaseLockDefaultConfig;
+    config.kalman = p.kalman;
+    pll.begin(p.intervalUs, config);
+    rngState = 12345;
+
+    // The TX period less the RX period, in us per period, before any correction
+    const float drift = p.intervalUs * p.ppm / 1e6f;
+    float error = p.initialOffsetUs;
+    float errors[SIM_PERIODS];
+
+    for (int k = 0; k < SIM_PERIODS; k++)
+    {
+        errors[k] = error;
+        const bool tracking = k >= SIM_ACQUIRE_PERIODS;
+        if (uniform() >= p.lossRate)
+            pll.update((int32_t)lroundf(error + gaussian() * p.jitterUs), tracking);
+        else
+            pll.missed(tracking);
+
+        // The frequency offset is in ticks on each half period
+        const float correction = 2.0f * pll.freqOffset() / config.ticksPerUs;
+        error += drift - correction - pll.phaseShift();
+    }
+
+    simResult_t result = {-1, 0, 0};
+    for (int k = SIM_PERIODS - 1; k >= 0 && fabsf(errors[k]) <= SIM_LOCK_US; k--)
+        result.lockPeriod = k;
+    if (result.lockPeriod < 0)
+        return result;
+    float sumSq = 0;
+    for (int k = result.lockPeriod; k < SIM_PERIODS; k++)
+    {
+        sumSq += errors[k] * errors[k];
+        if (fabsf(errors[k]) > result.maxErrorUs)
+            result.maxErrorUs = fabsf(errors[k]);
+    }
+    result.jitterUs = sqrtf(sumSq / (SIM_PERIODS - result.lockPeriod));
+    return result;
+}
+
+static simResult_t report(const simParams_t &p)
+{
+    const simResult_t r = simulate(p);
+    printf("  %-6s %5uus %+4.0fppm %3.0f%% loss: lock %4d periods, jitter %.1fus, max %.1fus\n",
+           p.kalman ? "kalman" : "pi", p.intervalUs, p.ppm, p.lossRate * 100, r.lockPeriod, r.jitterUs, r.maxErrorUs);
+    return r;
+}
+
+void test_static(void)
+{
+    // No error in, nothing out
+    PhaseLock pll;
+    pll.begin(2000);
+    for (int i = 0; i < 100; i++)
+        pll.update(0, true);
+    TEST_ASSERT_EQUAL(0, pll.phaseShift());
+    TEST_ASSERT_EQUAL(0, pll.freqOffset());
+}
+
+void test_phase_step(void)
+{
+    // A phase step with no drift is taken out with the acquire gain, the frequency left alone
+    for (uint8_t kalman = 0; kalman < 2; kalman++)
+    {
+        PhaseLock pll;
+        phaseLockConfig_t config = PhaseLockDefaultConfig;
+        config.kalman = kalman;
+        pll.begin(4000, config);
+        pll.update(400, false);
+        TEST_ASSERT_INT_WITHIN(1, 200, pll.phaseShift());
+        TEST_ASSERT_EQUAL(0, pll.freqOffset());
+        // Never more than a quarter period
+        pll.update(4000, false);
+        TEST_ASSERT_TRUE(pll.phaseShift() <= 1000);
+    }
+}
+
+void test_missed_samples(void)
+{
+    // PI does nothing without a sample, Kalman keeps correcting the drift it has learned
+    for (uint8_t kalman = 0; kalman < 2; kalman++)
+    {
+        PhaseLock pll;
+        phaseLockConfig_t config = PhaseLockDefaultConfig;
+        config.kalman = kalman;
+        pll.begin(1000, config);
+        pll.update(50, true);
+        pll.missed(true);
+        if (kalman)
+            TEST_ASSERT_NOT_EQUAL(0, pll.phaseShift());
+        else
+            TEST_ASSERT_EQUAL(0, pll.phaseShift());
+    }
+}
+
+void test_initial_covariance(void)
+{
+    // 100ppm of the interval, in us per period << 12, squared
+    static const uint32_t intervals[] = {1000, 5000, 10000, 20000, 40000};
+    for (uint32_t interval : intervals)
+    {
+        PhaseLock pll;
+        pll.begin(interval);
+        const int64_t maxFreq = (int64_t)interval * 4096 / 10000;
+        TEST_ASSERT_TRUE(pll.freqVariance() > 0);
+        TEST_ASSERT_TRUE(pll.freqVariance() == maxFreq * maxFreq);
+    }
+    PhaseLock pll;
+    pll.begin(10000);
+    TEST_ASSERT_TRUE(pll.freqVariance() == 16777216);
+}
+
+void test_interval_change(void)
+{
+    // A rate switch keeps the crystal error learned at the old interval, the phase stays locked
+    const float ppm = 80;
+    uint32_t interval = 10000;
+    PhaseLock pll;
+    pll.begin(interval);
+    rngState = 12345;
+
+    float error = 0;
+    float maxErrorUs = 0;
+    for (int k = 0; k < 2000; k++)
+    {
+        if (k == 1000)
+        {
+            const int32_t freqOffset = pll.freqOffset();
+            interval = 40000;
+            pll.setInterval(interval);
+            TEST_ASSERT_INT_WITHIN(1, freqOffset * 4, pll.freqOffset());
+            TEST_ASSERT_TRUE(pll.freqVariance() > 0);
+        }
+        pll.update((int32_t)lroundf(error + gaussian() * 3), true);
+        error += interval * ppm / 1e6f - 2.0f * pll.freqOffset() / PhaseLockDefaultConfig.ticksPerUs - pll.phaseShift();
+        if (k >= 1000 && fabsf(error) > maxErrorUs)
+            maxErrorUs = fabsf(error);
+    }
+    printf("  10000us to 40000us at %+.0fppm: max %.1fus\n", ppm, maxErrorUs);
+    // Starting the frequency again from nothing takes it out to about 8us
+    TEST_ASSERT_TRUE(maxErrorUs <= SIM_LOCK_US / 2);
+}
+
+void test_lock_and_jitter(void)
+{
+    static const uint32_t intervals[] = {1000, 2000, 4000, 20000, 40000};
+    static const float ppms[] = {-50, 20, 50};
+    static const float losses[] = {0, 0.3, 0.7};
+
+    printf("\n");
+    for (uint32_t interval : intervals)
+    {
+        for (float ppm : ppms)
+        {
+            for (float loss : losses)
+            {
+                simParams_t p = {interval, ppm, loss, 3, (int32_t)interval / 5, false};
+                const simResult_t pi = report(p);
+                p.kalman = true;
+                const simResult_t kalman = report(p);
+
+                // Both lock, within a second of tracking at 1000Hz, and hold the phase
+                TEST_ASSERT_TRUE(pi.lockPeriod >= 0);
+                TEST_ASSERT_TRUE(kalman.lockPeriod >= 0);
+                TEST_ASSERT_TRUE(kalman.lockPeriod < SIM_ACQUIRE_PERIODS + 1000);
+                TEST_ASSERT_TRUE(kalman.jitterUs < 5);
+                // The estimator does no worse than the raw offsets
+                TEST_ASSERT_TRUE(kalman.jitterUs <= pi.jitterUs + 0.5f);
+            }
+        }
+    }
+}
+
+// Unity setup/teardown
+void setUp() {}
+void tearDown() {}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_static);
+    RUN_TEST(test_phase_step);
+    RUN_TEST(test_missed_samples);
+    RUN_TEST(test_initial_covariance);
+    RUN_TEST(test_interval_change);
+    RUN_TEST(test_lock_and_jitter);
+    UNITY_END();
+
+    return 0;
+}
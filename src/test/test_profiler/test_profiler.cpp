@@ -0,0 +1,96 @@
+#include <cstdint>
+#include <unity.h>
+#include "profiler.h"
+
+void test_profiler_empty(void)
+{
+    ProfileProbeStats stats;
+
+    TEST_ASSERT_EQUAL(0, stats.count());
+    TEST_ASSERT_EQUAL(0, stats.min());
+    TEST_ASSERT_EQUAL(0, stats.max());
+    TEST_ASSERT_EQUAL(0, stats.mean());
+    TEST_ASSERT_EQUAL(0, stats.maxPercentOf(4000));
+}
+
+void test_profiler_min_max_mean(void)
+{
+    ProfileProbeStats stats;
+
+    stats.add(10);
+    stats.add(30);
+    stats.add(20);
+
+    TEST_ASSERT_EQUAL(3, stats.count());
+    TEST_ASSERT_EQUAL(10, stats.min());
+    TEST_ASSERT_EQUAL(30, stats.max());
+    TEST_ASSERT_EQUAL(20, stats.mean());
+}
+
+void test_profiler_histogram(void)
+{
+    ProfileProbeStats stats;
+
+    // bucket 0 is below BUCKET0_US, each following bucket doubles the limit
+    stats.add(0);
+    stats.add(ProfileProbeStats::BUCKET0_US - 1);
+    stats.add(ProfileProbeStats::BUCKET0_US);
+    stats.add(ProfileProbeStats::BUCKET0_US * 2 - 1);
+    stats.add(ProfileProbeStats::BUCKET0_US * 4);
+    // anything too large ends up in the last bucket
+    stats.add(1000000);
+
+    TEST_ASSERT_EQUAL(2, stats.bucket(0));
+    TEST_ASSERT_EQUAL(2, stats.bucket(1));
+    TEST_ASSERT_EQUAL(0, stats.bucket(2));
+    TEST_ASSERT_EQUAL(1, stats.bucket(3));
+    TEST_ASSERT_EQUAL(1, stats.bucket(ProfileProbeStats::BUCKETS - 1));
+    TEST_ASSERT_EQUAL(0, stats.bucket(ProfileProbeStats::BUCKETS));
+}
+
+void test_profiler_interval_percent(void)
+{
+    ProfileProbeStats stats;
+
+    stats.add(100);
+    stats.add(500);
+
+    TEST_ASSERT_EQUAL(25, stats.maxPercentOf(2000));
+    TEST_ASSERT_EQUAL(125, stats.maxPercentOf(400));
+    TEST_ASSERT_EQUAL(0, stats.maxPercentOf(0));
+}
+
+void test_profiler_reset(void)
+{
+    ProfileProbeStats stats;
+
+    stats.add(50);
+    stats.reset();
+
+    TEST_ASSERT_EQUAL(0, stats.count());
+    TEST_ASSERT_EQUAL(0, stats.max());
+    for (uint8_t i = 0; i < ProfileProbeStats::BUCKETS; i++)
+    {
+        TEST_ASSERT_EQUAL(0, stats.bucket(i));
+    }
+
+    stats.add(7);
+    TEST_ASSERT_EQUAL(7, stats.min());
+}
+
+// Unity setup/teardown
+void setUp() {}
+void tearDown() {}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_profiler_empty);
+    RUN_TEST(test_profiler_min_max_mean);
+    RUN_TEST(test_profiler_histogram);
+    RUN_TEST(test_profiler_interval_percent);
+    RUN_TEST(test_profiler_reset);
+    UNITY_END();
+
+    return 0;
+}
@@ -0,0 +1,227 @@
+#include <cstdint>
+#include <unity.h>
+#include "RateAdapt.h"
+
+// 2.4GHz LoRa 500/250/150/50Hz, SNR thresholds scaled by 4
+static const rateAdaptRate_t ladder[] = {
+    {4, -105, 20},
+    {5, -108, 12},
+    {6, -112, 0},
+    {7, -115, -4},
+};
+
+static const rateAdaptSample_t strong = {100, -60, 40};
+static const rateAdaptSample_t weakLq = {60, -60, 40};
+static const rateAdaptSample_t edge = {90, -90, 24};    // neither poor nor good at 500Hz
+
+static RateAdaptPolicy policy;
+static uint32_t now;
+
+// Feed a sample every 100ms, returns the number of changes
+static int feed(const rateAdaptSample_t &sample, int count)
+{
+    int changes = 0;
+    for (int i = 0; i < count; i++)
+    {
+        now += 100;
+        changes += policy.update(now, sample);
+    }
+    return changes;
+}
+
+static void start()
+{
+    now = 0;
+    policy.begin(ladder, sizeof(ladder) / sizeof(ladder[0]), now);
+}
+
+void test_starts_fastest(void)
+{
+    start();
+    TEST_ASSERT_TRUE(policy.active());
+    TEST_ASSERT_EQUAL(4, policy.rateIndex());
+    TEST_ASSERT_EQUAL(0, policy.tlmShift());
+    TEST_ASSERT_EQUAL(0, feed(strong, 100));
+    TEST_ASSERT_EQUAL(0, policy.level());
+}
+
+void test_steps_down_on_poor_lq(void)
+{
+    start();
+    // hold time after starting
+    TEST_ASSERT_EQUAL(0, feed(weakLq, 9));
+    TEST_ASSERT_EQUAL(1, feed(weakLq, 1));
+    TEST_ASSERT_EQUAL(5, policy.rateIndex());
+    // consecutive samples are needed, one good sample in between resets the run
+    now += 1000;
+    TEST_ASSERT_EQUAL(0, feed(weakLq, 2));
+    TEST_ASSERT_EQUAL(0, feed(strong, 1));
+    TEST_ASSERT_EQUAL(0, feed(weakLq, 2));
+    TEST_ASSERT_EQUAL(1, feed(weakLq, 1));
+    TEST_ASSERT_EQUAL(6, policy.rateIndex());
+}
+
+void test_steps_down_on_margin(void)
+{
+    const rateAdaptSample_t lowRssi = {100, -100, 40};
+    const rateAdaptSample_t lowSnr = {100, -60, 19};
+    start();
+    now += 1000;
+    TEST_ASSERT_EQUAL(1, feed(lowRssi, 3));
+    TEST_ASSERT_EQUAL(1, policy.level());
+    start();
+    now += 1000;
+    TEST_ASSERT_EQUAL(1, feed(lowSnr, 3));
+    TEST_ASSERT_EQUAL(1, policy.level());
+}
+
+void test_hysteresis(void)
+{
+    start();
+    TEST_ASSERT_EQUAL(0, feed(edge, 200));
+    TEST_ASSERT_EQUAL(0, policy.level());
+
+    // one step down, the same edge signal is not good enough to come back up
+    TEST_ASSERT_EQUAL(1, feed(weakLq, 3));
+    TEST_ASSERT_EQUAL(0, feed(edge, 200));
+    TEST_ASSERT_EQUAL(1, policy.level());
+
+    // clear margin on the faster rate for long enough
+    TEST_ASSERT_EQUAL(1, feed(strong, 200));
+    TEST_ASSERT_EQUAL(0, policy.level());
+}
+
+void test_step_up_needs_hold_and_run(void)
+{
+    start();
+    now += 1000;
+    feed(weakLq, 3);
+    TEST_ASSERT_EQUAL(1, policy.level());
+    // 10 good samples in one second is not past the 5s hold
+    TEST_ASSERT_EQUAL(0, feed(strong, 49));
+    TEST_ASSERT_EQUAL(1, feed(strong, 1));
+    TEST_ASSERT_EQUAL(0, policy.level());
+}
+
+void test_telemetry_below_slowest_rate(void)
+{
+    start();
+    for (int i = 0; i < 5; i++)
+    {
+        now += 1000;
+        feed(weakLq, 3);
+    }
+    TEST_ASSERT_EQUAL(7, policy.rateIndex());
+    TEST_ASSERT_EQUAL(2, policy.tlmShift());
+    // bottom of the ladder
+    now += 1000;
+    TEST_ASSERT_EQUAL(0, feed(weakLq, 10));
+    TEST_ASSERT_EQUAL(2, policy.tlmShift());
+
+    // the telemetry ratio comes back before the rate does
+    TEST_ASSERT_EQUAL(1, feed(strong, 50));
+    TEST_ASSERT_EQUAL(7, policy.rateIndex());
+    TEST_ASSERT_EQUAL(1, policy.tlmShift());
+    TEST_ASSERT_EQUAL(1, feed(strong, 50));
+    TEST_ASSERT_EQUAL(7, policy.rateIndex());
+    TEST_ASSERT_EQUAL(0, policy.tlmShift());
+    TEST_ASSERT_EQUAL(1, feed(strong, 50));
+    TEST_ASSERT_EQUAL(6, policy.rateIndex());
+}
+
+void test_failed_up_step_backs_off(void)
+{
+    start();
+    now += 1000;
+    feed(weakLq, 3);
+    feed(strong, 50);
+    TEST_ASSERT_EQUAL(0, policy.level());
+    // the faster rate does not hold, straight back down
+    now += 1000;
+    feed(weakLq, 3);
+    TEST_ASSERT_EQUAL(1, policy.level());
+    // now needs 10s before the next attempt
+    TEST_ASSERT_EQUAL(0, feed(strong, 99));
+    TEST_ASSERT_EQUAL(1, feed(strong, 1));
+    now += 1000;
+    feed(weakLq, 3);
+    TEST_ASSERT_EQUAL(0, feed(strong, 199));
+    TEST_ASSERT_EQUAL(1, feed(strong, 1));
+    TEST_ASSERT_EQUAL(0, policy.level());
+
+    // staying up long enough resets the backoff
+    feed(strong, 400);
+    now += 1000;
+    feed(weakLq, 3);
+    TEST_ASSERT_EQUAL(1, policy.level());
+    TEST_ASSERT_EQUAL(1, feed(strong, 50));
+}
+
+void test_missed_telemetry(void)
+{
+    start();
+    now += 1000;
+    TEST_ASSERT_FALSE(policy.missed(now));
+    TEST_ASSERT_FALSE(policy.missed(now));
+    TEST_ASSERT_TRUE(policy.missed(now));
+    TEST_ASSERT_EQUAL(1, policy.level());
+}
+
+// Recorded uplink stats from flying out past the 500Hz range and back, one report every 100ms
+// {lq, rssi, snr} per 1s segment
+static const rateAdaptSample_t flight[] = {
+    {100, -62, 40}, {100, -70, 40}, {100, -78, 36}, {99, -84, 30}, {97, -90, 26},
+    {92, -96, 22}, {80, -99, 17}, {71, -101, 14}, {62, -103, 9}, {58, -104, 6},
+    {66, -104, 5}, {60, -103, 7}, {74, -101, 12}, {88, -97, 20}, {96, -92, 25},
+    {100, -86, 32}, {100, -80, 38}, {100, -72, 40}, {100, -66, 40}, {100, -62, 40},
+};
+
+void test_recorded_flight(void)
+{
+    start();
+    int changes = 0;
+    uint8_t deepest = 0;
+    for (const rateAdaptSample_t &segment : flight)
+    {
+        for (int i = 0; i < 10; i++)
+        {
+            now += 100;
+            rateAdaptSample_t sample = segment;
+            // telemetry is lost now and then at the far end
+            if (segment.lq < 70 && i % 3 == 0)
+                changes += policy.missed(now);
+            else
+                changes += policy.update(now, sample);
+            if (policy.level() > deepest)
+                deepest = policy.level();
+        }
+    }
+    // Out to the most robust rate (and slower telemetry, the LQ is recorded so does not improve)
+    // then back in, without bouncing on the way
+    TEST_ASSERT_TRUE(deepest >= 3);
+    TEST_ASSERT_EQUAL(2 * deepest, changes + policy.level());
+    // and back to the fastest rate once the link stays strong
+    feed(flight[19], 300);
+    TEST_ASSERT_EQUAL(0, policy.level());
+}
+
+// Unity setup/teardown
+void setUp() {}
+void tearDown() {}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_starts_fastest);
+    RUN_TEST(test_steps_down_on_poor_lq);
+    RUN_TEST(test_steps_down_on_margin);
+    RUN_TEST(test_hysteresis);
+    RUN_TEST(test_step_up_needs_hold_and_run);
+    RUN_TEST(test_telemetry_below_slowest_rate);
+    RUN_TEST(test_failed_up_step_backs_off);
+    RUN_TEST(test_missed_telemetry);
+    RUN_TEST(test_recorded_flight);
+    UNITY_END();
+
+    return 0;
+}
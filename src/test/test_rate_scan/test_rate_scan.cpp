@@ -0,0 +1,188 @@
+#include <cstdint>
+#include <unity.h>
+#include "RateScan.h"
+
+typedef struct {
+    uint8_t group;
+    uint8_t hopInterval;
+    uint32_t interval;      // us
+} scanRate_t;
+
+// The 2.4GHz rates: FLRC, LoRa 4 byte and LoRa 8 byte payloads
+static const scanRate_t sx128xRates[] = {
+    {0, 2,  1000}, {0, 2,  2000}, {0, 2, 1000}, {0, 2, 1000}, {1, 4,  2000},
+    {2, 4,  3003}, {1, 4,  4000}, {1, 4, 6666}, {2, 4, 10000}, {1, 2, 20000},
+};
+// LR1121: GFSK, 900 LoRa, 2.4 LoRa and the two dual band rates
+static const scanRate_t lr1121Rates[] = {
+    {0, 2, 1000}, {1, 4, 4000}, {2, 4, 5000}, {1, 4, 5000}, {2, 4, 10000},
+    {1, 4, 10000}, {1, 4, 20000}, {1, 2, 40000}, {1, 4, 5000}, {3, 2, 1000},
+    {3, 2, 1000}, {3, 2, 1000}, {4, 4, 2000}, {5, 4, 3003}, {4, 4, 4000},
+    {4, 4, 6666}, {5, 4, 10000}, {4, 2, 20000}, {RATE_SCAN_SOLO, 4, 6666}, {RATE_SCAN_SOLO, 4, 10000},
+};
+
+#define CHANNEL_COUNT 80
+
+// Time for the sync channel to come round once, the receiver listens for 110% of it
+static uint32_t syncCycleMs(const scanRate_t &rate)
+{
+    return CHANNEL_COUNT * rate.hopInterval * rate.interval / 1000;
+}
+
+static uint32_t dwellMs(const scanRate_t &rate)
+{
+    return 11 * syncCycleMs(rate) / 10;
+}
+
+static void loadGroups(const scanRate_t *rates, uint8_t count, uint8_t *groups)
+{
+    for (uint8_t i = 0; i < count; i++)
+        groups[i] = rates[i].group;
+}
+
+void test_single_radio_order(void)
+{
+    const uint8_t groups[] = {0, RATE_SCAN_NONE, 1, 0, RATE_SCAN_SOLO};
+    RateScan scan;
+    scan.begin(groups, sizeof(groups), 3, false);
+    TEST_ASSERT_EQUAL(4, scan.turnsPerSweep());
+
+    // Every rate in turn from the start, skipping the unsupported one, on the first radio only
+    const uint8_t expected[] = {3, 4, 0, 2, 3, 4, 0};
+    for (uint8_t i = 0; i < sizeof(expected); i++)
+    {
+        uint8_t rate2 = 0;
+        TEST_ASSERT_EQUAL(expected[i], scan.next(rate2));
+        TEST_ASSERT_EQUAL(RATE_SCAN_NONE, rate2);
+    }
+}
+
+void test_dual_radio_pairs(void)
+{
+    uint8_t groups[sizeof(lr1121Rates) / sizeof(lr1121Rates[0])];
+    const uint8_t count = sizeof(groups);
+    loadGroups(lr1121Rates, count, groups);
+    groups[2] = RATE_SCAN_NONE;
+
+    for (uint8_t start = 0; start < count; start++)
+    {
+        RateScan scan;
+        scan.begin(groups, count, start, true);
+        const uint8_t turns = scan.turnsPerSweep();
+
+        // Each sweep gives every supported rate exactly one turn, paired only within its group
+        for (uint8_t sweep = 0; sweep < 3; sweep++)
+        {
+            uint8_t seen[RATE_SCAN_MAX_RATES] = {0};
+            for (uint8_t turn = 0; turn < turns; turn++)
+            {
+                uint8_t rate2;
+                const uint8_t rate1 = scan.next(rate2);
+                TEST_ASSERT_TRUE(rate1 < count);
+                seen[rate1]++;
+                if (rate2 != RATE_SCAN_NONE)
+                {
+                    TEST_ASSERT_NOT_EQUAL(rate1, rate2);
+                    TEST_ASSERT_EQUAL(groups[rate1], groups[rate2]);
+                    TEST_ASSERT_NOT_EQUAL(RATE_SCAN_SOLO, groups[rate2]);
+                    seen[rate2]++;
+                }
+            }
+            for (uint8_t i = 0; i < count; i++)
+                TEST_ASSERT_EQUAL(groups[i] == RATE_SCAN_NONE ? 0 : 1, seen[i]);
+        }
+    }
+}
+
+void test_nothing_to_scan(void)
+{
+    const uint8_t groups[] = {RATE_SCAN_NONE, RATE_SCAN_NONE};
+    RateScan scan;
+    uint8_t rate2;
+    TEST_ASSERT_EQUAL(RATE_SCAN_NONE, scan.next(rate2));
+    scan.begin(groups, sizeof(groups), 0, true);
+    TEST_ASSERT_EQUAL(RATE_SCAN_NONE, scan.next(rate2));
+    TEST_ASSERT_EQUAL(RATE_SCAN_NONE, rate2);
+    TEST_ASSERT_EQUAL(0, scan.turnsPerSweep());
+}
+
+/**
+ * Worst case time from the receiver starting to scan until it has heard a sync from the TX, over
+ * every TX rate and every rate the receiver could start on. A turn lasts for the longest dwell of
+ * its rates, the sync is heard at the latest one sync cycle into the turn with the TX rate.
+ */
+static uint32_t worstAcquisitionMs(const scanRate_t *rates, uint8_t count, bool dualRadio)
+{
+    uint8_t groups[RATE_SCAN_MAX_RATES];
+    loadGroups(rates, count, groups);
+
+    uint32_t worst = 0;
+    for (uint8_t start = 0; start < count; start++)
+    {
+        for (uint8_t tx = 0; tx < count; tx++)
+        {
+            RateScan scan;
+            scan.begin(groups, count, start, dualRadio);
+            uint32_t elapsed = 0;
+            for (;;)
+            {
+                uint8_t rate2;
+                const uint8_t rate1 = scan.next(rate2);
+                if (rate1 == tx || rate2 == tx)
+                {
+                    elapsed += syncCycleMs(rates[tx]);
+                    break;
+                }
+                uint32_t turn = dwellMs(rates[rate1]);
+                if (rate2 != RATE_SCAN_NONE && dwellMs(rates[rate2]) > turn)
+                    turn = dwellMs(rates[rate2]);
+                elapsed += turn;
+            }
+            if (elapsed > worst)
+                worst = elapsed;
+        }
+    }
+    return worst;
+}
+
+static void checkAcquisition(const scanRate_t *rates, uint8_t count)
+{
+    const uint32_t single = worstAcquisitionMs(rates, count, false);
+    const uint32_t dual = worstAcquisitionMs(rates, count, true);
+
+    // Single radio: the slowest rate can have to wait for every other rate first
+    uint32_t sweep = 0;
+    for (uint8_t i = 0; i < count; i++)
+        sweep += dwellMs(rates[i]);
+    TEST_ASSERT_TRUE(single <= sweep);
+
+    // Listening on two rates at once takes no more than 3/4 of the time
+    TEST_ASSERT_TRUE(dual * 4 <= single * 3);
+}
+
+void test_acquisition_sx128x(void)
+{
+    checkAcquisition(sx128xRates, sizeof(sx128xRates) / sizeof(sx128xRates[0]));
+}
+
+void test_acquisition_lr1121(void)
+{
+    checkAcquisition(lr1121Rates, sizeof(lr1121Rates) / sizeof(lr1121Rates[0]));
+}
+
+// Unity setup/teardown
+void setUp() {}
+void tearDown() {}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_single_radio_order);
+    RUN_TEST(test_dual_radio_pairs);
+    RUN_TEST(test_nothing_to_scan);
+    RUN_TEST(test_acquisition_sx128x);
+    RUN_TEST(test_acquisition_lr1121);
+    UNITY_END();
+
+    return 0;
+}
@@ -0,0 +1,181 @@
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <unity.h>
+#include "dirtytiles.h"
+
+// 128x64 monochrome in the u8g2 full buffer layout
+#define WIDTH 128
+#define HEIGHT 64
+#define TILES_X (WIDTH / 8)
+#define TILES_Y (HEIGHT / 8)
+
+struct area_t
+{
+    uint8_t tx, ty, tw, th;
+};
+
+static uint8_t frame[WIDTH * HEIGHT / 8];
+static uint8_t screen[WIDTH * HEIGHT / 8];
+static std::vector<area_t> areas;
+
+static void pushArea(uint8_t tx, uint8_t ty, uint8_t tw, uint8_t th)
+{
+    // What u8g2 updateDisplayArea() does, copy the tiles in the area to the screen
+    areas.push_back({tx, ty, tw, th});
+    for (uint8_t y = ty; y < ty + th; y++)
+    {
+        memcpy(&screen[(y * TILES_X + tx) * 8], &frame[(y * TILES_X + tx) * 8], tw * 8);
+    }
+}
+
+static void setPixel(int x, int y, bool on)
+{
+    uint8_t &b = frame[(y / 8) * WIDTH + x];
+    if (on)
+        b |= 1 << (y % 8);
+    else
+        b &= ~(1 << (y % 8));
+}
+
+static void fillRect(int x, int y, int w, int h, bool on)
+{
+    for (int i = x; i < x + w; i++)
+        for (int j = y; j < y + h; j++)
+            setPixel(i, j, on);
+}
+
+// Stand in for a line of text, one 6x8 block per digit so the width changes with the value
+static void drawNumber(int x, int y, int value)
+{
+    fillRect(x, y, 60, 8, false);
+    for (int i = 0; value > 0 || i == 0; i++, value /= 10)
+        fillRect(x + i * 6, y + (value % 10) % 3, 5, 6, true);
+}
+
+static void renderLinkstats(int lq, int rssi, int snr)
+{
+    // Redrawn from scratch every time, like displayLinkstats()
+    memset(frame, 0, sizeof(frame));
+    fillRect(0, 16, 20, 6, true);   // "LQ"
+    fillRect(0, 32, 24, 6, true);   // "RSSI"
+    fillRect(0, 48, 18, 6, true);   // "SNR"
+    drawNumber(32, 16, lq);
+    drawNumber(32, 32, -rssi);
+    drawNumber(32, 48, snr);
+}
+
+void setUp()
+{
+    memset(frame, 0, sizeof(frame));
+    memset(screen, 0xAA, sizeof(screen));
+    areas.clear();
+}
+
+void tearDown() {}
+
+void test_first_push_sends_everything(void)
+{
+    DirtyTiles tiles;
+    tiles.begin(TILES_X, TILES_Y);
+    TEST_ASSERT_EQUAL(sizeof(frame), tiles.push(frame, pushArea));
+    TEST_ASSERT_EQUAL(1, areas.size());
+    TEST_ASSERT_EQUAL_MEMORY(frame, screen, sizeof(frame));
+
+    // nothing changed
+    TEST_ASSERT_EQUAL(0, tiles.push(frame, pushArea));
+    TEST_ASSERT_EQUAL(1, areas.size());
+    TEST_ASSERT_EQUAL(sizeof(frame), tiles.getBytesPushed());
+}
+
+void test_single_pixel(void)
+{
+    DirtyTiles tiles;
+    tiles.begin(TILES_X, TILES_Y);
+    tiles.push(frame, pushArea);
+    areas.clear();
+
+    setPixel(100, 50, true);
+    TEST_ASSERT_EQUAL(8, tiles.push(frame, pushArea));
+    TEST_ASSERT_EQUAL(1, areas.size());
+    TEST_ASSERT_EQUAL(100 / 8, areas[0].tx);
+    TEST_ASSERT_EQUAL(50 / 8, areas[0].ty);
+    TEST_ASSERT_EQUAL(1, areas[0].tw);
+    TEST_ASSERT_EQUAL(1, areas[0].th);
+    TEST_ASSERT_EQUAL_MEMORY(frame, screen, sizeof(frame));
+}
+
+void test_areas_merge_rows(void)
+{
+    DirtyTiles tiles;
+    tiles.begin(TILES_X, TILES_Y);
+    tiles.push(frame, pushArea);
+    areas.clear();
+
+    // a block over 3 tile rows and 2 tile columns is one area
+    fillRect(20, 10, 10, 20, true);
+    TEST_ASSERT_EQUAL(3 * 2 * 8, tiles.push(frame, pushArea));
+    TEST_ASSERT_EQUAL(1, areas.size());
+    TEST_ASSERT_EQUAL(2, areas[0].tx);
+    TEST_ASSERT_EQUAL(1, areas[0].ty);
+    TEST_ASSERT_EQUAL(2, areas[0].tw);
+    TEST_ASSERT_EQUAL(3, areas[0].th);
+    areas.clear();
+
+    // two separate rows are sent separately, the span covers the unchanged tiles between
+    setPixel(0, 0, true);
+    setPixel(127, 0, true);
+    setPixel(64, 63, true);
+    TEST_ASSERT_EQUAL((TILES_X + 1) * 8, tiles.push(frame, pushArea));
+    TEST_ASSERT_EQUAL(2, areas.size());
+    TEST_ASSERT_EQUAL(TILES_X, areas[0].tw);
+    TEST_ASSERT_EQUAL_MEMORY(frame, screen, sizeof(frame));
+}
+
+void test_invalidate(void)
+{
+    DirtyTiles tiles;
+    tiles.begin(TILES_X, TILES_Y);
+    tiles.push(frame, pushArea);
+
+    // screen was cleared behind our back
+    memset(screen, 0, sizeof(screen));
+    tiles.invalidate();
+    fillRect(0, 0, 8, 8, true);
+    TEST_ASSERT_EQUAL(sizeof(frame), tiles.push(frame, pushArea));
+    TEST_ASSERT_EQUAL_MEMORY(frame, screen, sizeof(frame));
+}
+
+void test_linkstats_updates(void)
+{
+    DirtyTiles tiles;
+    tiles.begin(TILES_X, TILES_Y);
+    renderLinkstats(100, -60, 10);
+    tiles.push(frame, pushArea);
+
+    // Only the values that changed are sent, the labels and empty space are not
+    uint32_t total = 0;
+    for (int i = 0; i < 100; i++)
+    {
+        renderLinkstats(100 - (i % 3 == 0), -60 - (i % 7) , 10);
+        const uint16_t pushed = tiles.push(frame, pushArea);
+        TEST_ASSERT_LESS_OR_EQUAL(2 * 8 * 8, pushed);
+        total += pushed;
+        TEST_ASSERT_EQUAL_MEMORY(frame, screen, sizeof(frame));
+    }
+    // a full redraw each time would be 100KB
+    TEST_ASSERT_LESS_THAN(100 * sizeof(frame) / 10, total);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_first_push_sends_everything);
+    RUN_TEST(test_single_pixel);
+    RUN_TEST(test_areas_merge_rows);
+    RUN_TEST(test_invalidate);
+    RUN_TEST(test_linkstats_updates);
+    UNITY_END();
+
+    return 0;
+}
@@ -0,0 +1,273 @@
+#include <cstdint>
+#include <cstdio>
+#include <chrono>
+#include <unity.h>
+#include "ServoPipeline.h"
+
+/*
+ * The pipeline against the way devServoOutput and DShotRMT worked it out on every packet before
+ * it, for every channel value and config, and the time both take for a frame of 16 outputs.
+ */
+
+#define BENCH_OUTPUTS 16
+#define BENCH_FRAMES 200000
+
+// The config bits as rx_config_pwm_t holds them
+typedef struct {
+    uint8_t inputChannel;
+    eServoOutputMode mode;
+    bool inverted;
+    bool narrow;
+    eServoOutputFailsafeMode failsafeMode;
+    uint16_t failsafe;
+} refConfig_t;
+
+// RMT item timings of DSHOT300, as DShotRMT::begin() sets them
+static const uint16_t ticksZeroHigh = 12;
+static const uint16_t ticksZeroLow = 20;
+static const uint16_t ticksOneHigh = 24;
+static const uint16_t ticksOneLow = 8;
+
+// servosUpdate() and servoWrite() before, what the output was written with
+static uint16_t refOutputFromUs(const refConfig_t &cfg, uint16_t us)
+{
+    if (cfg.mode == somDShot)
+        return fmap(constrain(us, 1000, 2000), 1000, 2000, DSHOT_THROTTLE_MIN, DSHOT_THROTTLE_MAX);
+    if (cfg.mode == somOnOff)
+        return us > 1500;
+    if (cfg.mode == som10KHzDuty)
+        return constrain(us, 1000, 2000) - 1000;
+    return us / (cfg.narrow + 1);
+}
+
+static uint16_t refOutputFromCrsf(const refConfig_t &cfg, uint16_t crsfVal)
+{
+    uint16_t us = CRSF_to_US(crsfVal);
+    if (cfg.inverted)
+        us = 3000U - us;
+    return refOutputFromUs(cfg, us);
+}
+
+// DShotRMT::calc_dshot_chksum(), prepare_rmt_data() and encode_dshot_to_rmt() before
+static uint16_t refChecksum(uint16_t throttle, bool telemetry, bool bidirectional)
+{
+    uint16_t packet = (throttle << 1) | telemetry;
+    if (bidirectional)
+        return (~(packet ^ (packet >> 4) ^ (packet >> 8))) & 0x0F;
+    return (packet ^ (packet >> 4) ^ (packet >> 8)) & 0x0F;
+}
+
+static uint16_t refFrame(uint16_t throttle, bool telemetry, bool bidirectional)
+{
+    if (throttle == DSHOT_THROTTLE_MIN)
+        throttle = 0;
+    throttle &= 0x7FF;
+    // send_dshot_value() put the checksum in the packet, prepare_rmt_data() worked it out again
+    volatile uint16_t unused = refChecksum(throttle, telemetry, bidirectional);
+    (void)unused;
+    const uint16_t checksum = refChecksum(throttle, telemetry, bidirectional);
+    return (((throttle << 1) | telemetry) << 4) | checksum;
+}
+
+static void refEncode(uint32_t items[DSHOT_FRAME_BITS], uint16_t frame, bool bidirectional)
+{
+    for (int i = 0; i < DSHOT_FRAME_BITS; i++, frame <<= 1)
+    {
+        const bool one = frame & 0x8000;
+        if (bidirectional)
+            items[i] = one ? dshotRmtItem(ticksOneLow, 0, ticksOneHigh, 1) : dshotRmtItem(ticksZeroLow, 0, ticksZeroHigh, 1);
+        else
+            items[i] = one ? dshotRmtItem(ticksOneHigh, 1, ticksOneLow, 0) : dshotRmtItem(ticksZeroHigh, 1, ticksZeroLow, 0);
+    }
+}
+
+static void compile(servoOutputDesc_t &desc, const refConfig_t &cfg)
+{
+    servoOutputCompile(desc, cfg.inputChannel, cfg.mode, cfg.inverted, cfg.narrow, cfg.failsafeMode, cfg.failsafe);
+}
+
+static void buildTable(uint32_t table[16][4], bool bidirectional)
+{
+    if (bidirectional)
+        dshotBuildNibbleTable(table, dshotRmtItem(ticksZeroLow, 0, ticksZeroHigh, 1), dshotRmtItem(ticksOneLow, 0, ticksOneHigh, 1));
+    else
+        dshotBuildNibbleTable(table, dshotRmtItem(ticksZeroHigh, 1, ticksZeroLow, 0), dshotRmtItem(ticksOneHigh, 1, ticksOneLow, 0));
+}
+
+static const eServoOutputMode outputModes[] = {
+    som50Hz, som60Hz, som100Hz, som160Hz, som333Hz, som400Hz, som10KHzDuty, somOnOff, somDShot
+};
+
+void test_outputs_match(void)
+{
+    for (eServoOutputMode mode : outputModes)
+    {
+        for (uint8_t flags = 0; flags < 4; flags++)
+        {
+            const refConfig_t cfg = {3, mode, (flags & 1) != 0, (flags & 2) != 0, PWMFAILSAFE_SET_POSITION, 512};
+            servoOutputDesc_t desc;
+            compile(desc, cfg);
+            TEST_ASSERT_EQUAL(3, desc.inputChannel);
+            // Every 11 bit value, E.Limits takes the channels past 172-1811
+            for (uint16_t crsfVal = 1; crsfVal < 2048; crsfVal++)
+            {
+                TEST_ASSERT_EQUAL(refOutputFromCrsf(cfg, crsfVal), servoOutputFromCrsf(desc, crsfVal));
+            }
+        }
+    }
+}
+
+void test_failsafe_outputs_match(void)
+{
+    for (eServoOutputMode mode : outputModes)
+    {
+        for (uint16_t failsafe = 0; failsafe < 1024; failsafe++)
+        {
+            // Inverted, which failsafe positions do not follow
+            const refConfig_t cfg = {0, mode, true, (failsafe & 1) != 0, PWMFAILSAFE_SET_POSITION, failsafe};
+            servoOutputDesc_t desc;
+            compile(desc, cfg);
+            TEST_ASSERT_EQUAL(refOutputFromUs(cfg, failsafe + 988), desc.failsafeOutput);
+            TEST_ASSERT_EQUAL(refOutputFromUs(cfg, 0), desc.stopOutput);
+        }
+    }
+
+    servoOutputDesc_t desc;
+    compile(desc, refConfig_t{0, som50Hz, false, false, PWMFAILSAFE_NO_PULSES, 512});
+    TEST_ASSERT_EQUAL(PWMFAILSAFE_NO_PULSES, desc.failsafeMode);
+    TEST_ASSERT_EQUAL(0, desc.stopOutput);
+    TEST_ASSERT_EQUAL(1500, desc.failsafeOutput);
+    compile(desc, refConfig_t{0, somDShot, false, false, PWMFAILSAFE_NO_PULSES, 512});
+    TEST_ASSERT_EQUAL(DSHOT_THROTTLE_MIN, desc.stopOutput);
+}
+
+void test_no_output_modes(void)
+{
+    servoOutputDesc_t desc;
+    compile(desc, refConfig_t{0, somSerial, false, false, PWMFAILSAFE_SET_POSITION, 512});
+    TEST_ASSERT_EQUAL(SERVO_OUT_NONE, desc.kind);
+    compile(desc, refConfig_t{0, somSDA, false, false, PWMFAILSAFE_SET_POSITION, 512});
+    TEST_ASSERT_EQUAL(SERVO_OUT_NONE, desc.kind);
+    compile(desc, refConfig_t{0, som400Hz, false, false, PWMFAILSAFE_SET_POSITION, 512});
+    TEST_ASSERT_EQUAL(SERVO_OUT_PWM, desc.kind);
+}
+
+void test_dshot_frames_match(void)
+{
+    for (uint8_t bidirectional = 0; bidirectional < 2; bidirectional++)
+    {
+        uint32_t table[16][4];
+        buildTable(table, bidirectional);
+        for (uint16_t throttle = 0; throttle <= DSHOT_THROTTLE_MAX; throttle++)
+        {
+            for (uint8_t telemetry = 0; telemetry < 2; telemetry++)
+            {
+                const uint16_t frame = dshotFrame(throttle, telemetry, bidirectional);
+                TEST_ASSERT_EQUAL_HEX16(refFrame(throttle, telemetry, bidirectional), frame);
+
+                uint32_t expected[DSHOT_FRAME_BITS], items[DSHOT_FRAME_BITS];
+                refEncode(expected, frame, bidirectional);
+                dshotEncode(items, table, frame);
+                TEST_ASSERT_EQUAL_HEX32_ARRAY(expected, items, DSHOT_FRAME_BITS);
+            }
+        }
+    }
+}
+
+void test_dshot_known_frames(void)
+{
+    // Throttle 1046 without telemetry is 0x82C, checksum 0x6, from the DShot spec examples
+    TEST_ASSERT_EQUAL_HEX16(0x82C6, dshotFrame(1046, false, false));
+    // The minimum is the stop command
+    TEST_ASSERT_EQUAL_HEX16(0x0000, dshotFrame(DSHOT_THROTTLE_MIN, false, false));
+    TEST_ASSERT_EQUAL_HEX16(0x000F, dshotFrame(DSHOT_THROTTLE_MIN, false, true));
+    // rmt_item32_t: duration0:15, level0:1, duration1:15, level1:1
+    TEST_ASSERT_EQUAL_HEX32(0x00148000 | 12, dshotRmtItem(12, 1, 20, 0));
+    TEST_ASSERT_EQUAL_HEX32(0x80180000 | 8, dshotRmtItem(8, 0, 24, 1));
+}
+
+// Keeps the compiler from dropping the work being timed
+static volatile uint32_t benchSink;
+
+void test_frame_cost(void)
+{
+    refConfig_t configs[BENCH_OUTPUTS];
+    servoOutputDesc_t descs[BENCH_OUTPUTS];
+    for (uint8_t ch = 0; ch < BENCH_OUTPUTS; ch++)
+    {
+        // A quad's worth of DShot, the rest servos and switches
+        const eServoOutputMode mode = ch < 4 ? somDShot : outputModes[ch % 8];
+        configs[ch] = refConfig_t{ch, mode, (ch % 3) == 0, (ch % 5) == 0, PWMFAILSAFE_SET_POSITION, 512};
+        compile(descs[ch], configs[ch]);
+    }
+    uint32_t table[16][4];
+    buildTable(table, false);
+
+    uint16_t channels[BENCH_OUTPUTS];
+    uint32_t items[DSHOT_FRAME_BITS];
+    uint32_t sink = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t frame = 0; frame < BENCH_FRAMES; frame++)
+    {
+        for (uint8_t ch = 0; ch < BENCH_OUTPUTS; ch++)
+            channels[ch] = 172 + (frame * 7 + ch * 101) % 1640;
+        for (uint8_t ch = 0; ch < BENCH_OUTPUTS; ch++)
+        {
+            const refConfig_t &cfg = configs[ch];
+            const uint16_t out = refOutputFromCrsf(cfg, channels[cfg.inputChannel]);
+            if (cfg.mode == somDShot)
+            {
+                refEncode(items, refFrame(out, false, false), false);
+                sink += items[frame & 15];
+            }
+            else
+                sink += out;
+        }
+    }
+    const double refNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    for (uint32_t frame = 0; frame < BENCH_FRAMES; frame++)
+    {
+        for (uint8_t ch = 0; ch < BENCH_OUTPUTS; ch++)
+            channels[ch] = 172 + (frame * 7 + ch * 101) % 1640;
+        for (uint8_t ch = 0; ch < BENCH_OUTPUTS; ch++)
+        {
+            const servoOutputDesc_t &desc = descs[ch];
+            const uint16_t out = servoOutputFromCrsf(desc, channels[desc.inputChannel]);
+            if (desc.kind == SERVO_OUT_DSHOT)
+            {
+                dshotEncode(items, table, dshotFrame(out, false, false));
+                sink += items[frame & 15];
+            }
+            else
+                sink += out;
+        }
+    }
+    const double pipelineNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    benchSink = sink;
+
+    printf("\n  %d outputs: per packet %.0fns before, %.0fns with the pipeline\n",
+           BENCH_OUTPUTS, refNs / BENCH_FRAMES, pipelineNs / BENCH_FRAMES);
+    // Only that it is no slower, timing on the build host says little about the RX
+    TEST_ASSERT_TRUE(pipelineNs < refNs * 1.5);
+}
+
+// Unity setup/teardown
+void setUp() {}
+void tearDown() {}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_outputs_match);
+    RUN_TEST(test_failsafe_outputs_match);
+    RUN_TEST(test_no_output_modes);
+    RUN_TEST(test_dshot_frames_match);
+    RUN_TEST(test_dshot_known_frames);
+    RUN_TEST(test_frame_cost);
+    UNITY_END();
+
+    return 0;
+}